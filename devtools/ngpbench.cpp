@@ -18,165 +18,796 @@
 
 ***************************************************************************/
 
-/* ngpcore benchmark utility (based on ngpshot.c code) */
+/* ngpcore benchmark utility */
+
+/* Every model is loaded and generated phase by phase (branch counting,  */
+/* bounding box, per-attribute fill, index fill and complete indexed     */
+/* generation) for each seed, then complete generation is repeated on    */
+/* several threads at once. Results are written in JSON so that they can */
+/* be compared between releases by scripts.                              */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <new>
-/*
-#include <stdlib.h>
-
 #include <string>
-#include <map>
-*/
+#include <vector>
+#include <algorithm>
+
+#ifdef _WIN32
+ #define WIN32_LEAN_AND_MEAN 1
+ #include <windows.h>
+#else
+ #include <sys/time.h>
+ #include <dirent.h>
+#endif
 
 #include <ngpcore/p3dhli.h>
 
-static void        RenderBranchGroup  (P3DHLIPlantTemplate*PlantTemplate,
-                                       P3DHLIPlantInstance*PlantInstance,
-                                       unsigned int        GroupIndex)
+#include <ngput/p3dospath.h>
+#include <ngput/p3dthread.h>
+
+#define NGPBENCH_FORMAT_VERSION (1)
+#define NGPBENCH_SAMPLES_DIR    "samples"
+#define NGPBENCH_MODEL_EXT      ".ngp"
+
+/* Allocation counting. Global new/delete are replaced so that number of  */
+/* allocations made by ngpcore during each phase can be reported. Counters */
+/* are not thread-safe, so counting is disabled during multi-threaded runs */
+
+/* GCC 11+ sees free() of operator new result once replaced operators */
+/* are inlined and warns, though they are paired correctly here        */
+
+#if defined(__GNUC__) && (__GNUC__ >= 11)
+ #pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static bool                  AllocCountEnabled = true;
+static unsigned long         AllocCount        = 0;
+static unsigned long         AllocBytes        = 0;
+
+static void       *CountedAlloc       (size_t              Size)
+ {
+  if (AllocCountEnabled)
+   {
+    AllocCount++;
+    AllocBytes += (unsigned long)Size;
+   }
+
+  return(malloc(Size > 0 ? Size : 1));
+ }
+
+void              *operator new       (size_t              Size)
  {
-  unsigned int                         BranchIndex;
-  unsigned int                         BranchCount;
-  const P3DMaterialDef                *MaterialDef;
+  void                                *Result;
 
-  BranchCount = PlantInstance->GetBranchCount(GroupIndex);
+  Result = CountedAlloc(Size);
 
-  if (BranchCount == 0)
+  if (Result == 0)
    {
-    return;
+    throw std::bad_alloc();
    }
 
-  MaterialDef = PlantTemplate->GetMaterial(GroupIndex);
+  return(Result);
+ }
+
+void              *operator new[]     (size_t              Size)
+ {
+  return(operator new(Size));
+ }
+
+void              *operator new       (size_t              Size,
+                                       const std::nothrow_t&)
+ {
+  return(CountedAlloc(Size));
+ }
+
+void              *operator new[]     (size_t              Size,
+                                       const std::nothrow_t&)
+ {
+  return(CountedAlloc(Size));
+ }
+
+void               operator delete    (void               *Ptr)
+ {
+  free(Ptr);
+ }
+
+void               operator delete[]  (void               *Ptr)
+ {
+  free(Ptr);
+ }
+
+void               operator delete    (void               *Ptr,
+                                       const std::nothrow_t&)
+ {
+  free(Ptr);
+ }
+
+void               operator delete[]  (void               *Ptr,
+                                       const std::nothrow_t&)
+ {
+  free(Ptr);
+ }
+
+#if defined(__cpp_sized_deallocation)
+void               operator delete    (void               *Ptr,
+                                       size_t)
+ {
+  operator delete(Ptr);
+ }
+
+void               operator delete[]  (void               *Ptr,
+                                       size_t)
+ {
+  operator delete[](Ptr);
+ }
+#endif
+
+/* wall-clock time in seconds, clock() can't be used since it sums */
+/* CPU time of all threads                                          */
+
+static double      GetWallTime        ()
+ {
+  #ifdef _WIN32
+  LARGE_INTEGER                        Frequency;
+  LARGE_INTEGER                        Counter;
+
+  QueryPerformanceFrequency(&Frequency);
+  QueryPerformanceCounter(&Counter);
 
-  unsigned int     BranchVAttrCount;
-  unsigned int     BranchIndexCount;
-  unsigned int     TotalVAttrCount;
-  unsigned int     TotalIndexCount;
+  return((double)Counter.QuadPart / (double)Frequency.QuadPart);
+  #else
+  struct timeval                       Time;
 
-  BranchVAttrCount = PlantTemplate->GetVAttrCountI(GroupIndex);
-  BranchIndexCount = PlantTemplate->GetIndexCount(GroupIndex,P3D_TRIANGLE_LIST);
+  gettimeofday(&Time,NULL);
 
-  TotalVAttrCount = BranchVAttrCount * BranchCount;
-  TotalIndexCount = BranchIndexCount * BranchCount;
+  return((double)Time.tv_sec + (double)Time.tv_usec * 1.0e-6);
+  #endif
+ }
 
-  float           *PosBuffer      = 0;
-  float           *NormalBuffer   = 0;
-  float           *BiNormalBuffer = 0;
-  float           *TexCoordBuffer = 0;
-  unsigned int    *IndexBuffer    = 0;
+class NGPBenchTimer
+ {
+  public           :
 
-  PosBuffer      = new(std::nothrow) float[3 * TotalVAttrCount];
-  NormalBuffer   = new(std::nothrow) float[3 * TotalVAttrCount];
-  TexCoordBuffer = new(std::nothrow) float[2 * TotalVAttrCount];
-  IndexBuffer    = new(std::nothrow) unsigned int[TotalIndexCount];
-  BiNormalBuffer = new(std::nothrow) float[3 * TotalVAttrCount];
+                   NGPBenchTimer      ()
+   {
+    Count      = 0;
+    MinTime    = 0.0;
+    TotalTime  = 0.0;
+    Allocs     = 0;
+    AllocSize  = 0;
+   }
 
-  if ((PosBuffer != 0) && (NormalBuffer != 0) &&
-      (TexCoordBuffer != 0) && (IndexBuffer != 0) &&
-      (BiNormalBuffer != 0))
+  void             Start              ()
    {
-    P3DHLIVAttrBuffers                 VAttrBuffers;
+    StartAllocs    = AllocCount;
+    StartAllocSize = AllocBytes;
+    StartTime      = GetWallTime();
+   }
 
-    if (MaterialDef->IsBillboard())
+  void             Stop               ()
+   {
+    double                             Time;
+
+    Time = GetWallTime() - StartTime;
+
+    /* allocation pattern does not depend on repetition, */
+    /* so first one is recorded                          */
+
+    if (Count == 0)
      {
-      VAttrBuffers.AddAttr(P3D_ATTR_BILLBOARD_POS,PosBuffer,0,sizeof(float) * 3);
+      MinTime   = Time;
+      Allocs    = AllocCount - StartAllocs;
+      AllocSize = AllocBytes - StartAllocSize;
      }
-    else
+    else if (Time < MinTime)
      {
-      VAttrBuffers.AddAttr(P3D_ATTR_VERTEX,PosBuffer,0,sizeof(float) * 3);
+      MinTime = Time;
      }
 
-    VAttrBuffers.AddAttr(P3D_ATTR_NORMAL,NormalBuffer,0,sizeof(float) * 3);
-    VAttrBuffers.AddAttr(P3D_ATTR_TEXCOORD0,TexCoordBuffer,0,sizeof(float) * 2);
+    TotalTime += Time;
+    Count++;
+   }
 
-    if (BiNormalBuffer != 0)
-     {
-      VAttrBuffers.AddAttr(P3D_ATTR_BINORMAL,BiNormalBuffer,0,sizeof(float) * 3);
-     }
+  double           GetMinTime         () const
+   {
+    return(MinTime);
+   }
 
-    PlantInstance->FillVAttrBuffersI(&VAttrBuffers,GroupIndex);
+  double           GetMeanTime        () const
+   {
+    return(Count > 0 ? TotalTime / Count : 0.0);
+   }
+
+  unsigned long    GetAllocCount      () const
+   {
+    return(Allocs);
+   }
+
+  unsigned long    GetAllocBytes      () const
+   {
+    return(AllocSize);
+   }
+
+  private          :
+
+  unsigned int                         Count;
+  double                               MinTime;
+  double                               TotalTime;
+  unsigned long                        Allocs;
+  unsigned long                        AllocSize;
+
+  double                               StartTime;
+  unsigned long                        StartAllocs;
+  unsigned long                        StartAllocSize;
+ };
+
+/* buffers are sized once per instance, so generation phases */
+/* measure geometry generation only                           */
+
+typedef struct
+ {
+  std::vector<float>                   Attr;
+  std::vector<float>                   Pos;
+  std::vector<float>                   Normal;
+  std::vector<float>                   TexCoord;
+  std::vector<float>                   Tangent;
+  std::vector<float>                   BiNormal;
+  std::vector<unsigned int>            Index;
+  std::vector<unsigned int>            BranchCounts;
+ } NGPBenchBuffers;
+
+static const unsigned int              BenchAttrs[] =
+ {
+  P3D_ATTR_VERTEX,
+  P3D_ATTR_NORMAL,
+  P3D_ATTR_TEXCOORD0,
+  P3D_ATTR_TANGENT,
+  P3D_ATTR_BINORMAL
+ };
+
+static const char                     *BenchAttrNames[] =
+ {
+  "attr_vertex",
+  "attr_normal",
+  "attr_texcoord0",
+  "attr_tangent",
+  "attr_binormal"
+ };
+
+#define NGPBENCH_ATTR_COUNT (sizeof(BenchAttrs) / sizeof(BenchAttrs[0]))
 
-    if (MaterialDef->IsBillboard())
+typedef struct
+ {
+  unsigned int                         Branches;
+  unsigned int                         Vertices;
+  unsigned int                         Indices;
+  unsigned int                         AttrVertices[NGPBENCH_ATTR_COUNT];
+ } NGPBenchCounts;
+
+static void        PrepareBuffers     (NGPBenchBuffers    *Buffers,
+                                       NGPBenchCounts     *Counts,
+                                       const P3DHLIPlantTemplate
+                                                          *PlantTemplate,
+                                       const P3DHLIPlantInstance
+                                                          *PlantInstance)
+ {
+  unsigned int                         GroupCount;
+  size_t                               MaxAttrCount;
+  size_t                               MaxVAttrCountI;
+  size_t                               MaxIndexCount;
+
+  GroupCount = PlantTemplate->GetGroupCount();
+
+  Counts->Branches = 0;
+  Counts->Vertices = 0;
+  Counts->Indices  = 0;
+
+  for (unsigned int AttrIndex = 0; AttrIndex < NGPBENCH_ATTR_COUNT; AttrIndex++)
+   {
+    Counts->AttrVertices[AttrIndex] = 0;
+   }
+
+  MaxAttrCount   = 0;
+  MaxVAttrCountI = 0;
+  MaxIndexCount  = 0;
+
+  for (unsigned int GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
+   {
+    unsigned int                       BranchCount;
+    unsigned int                       VAttrCountI;
+    unsigned int                       IndexCount;
+
+    BranchCount = PlantInstance->GetBranchCount(GroupIndex);
+    VAttrCountI = PlantTemplate->GetVAttrCountI(GroupIndex) * BranchCount;
+    IndexCount  = PlantTemplate->GetIndexCount(GroupIndex,P3D_TRIANGLE_LIST) * BranchCount;
+
+    for (unsigned int AttrIndex = 0; AttrIndex < NGPBENCH_ATTR_COUNT; AttrIndex++)
      {
-      float        BillboardWidth;
-      float        BillboardHeight;
+      unsigned int                     AttrCount;
 
-      PlantTemplate->GetBillboardSize(&BillboardWidth,&BillboardHeight,GroupIndex);
+      AttrCount = PlantTemplate->GetVAttrCount(GroupIndex,BenchAttrs[AttrIndex]) * BranchCount;
+
+      MaxAttrCount = std::max(MaxAttrCount,(size_t)AttrCount);
+
+      Counts->AttrVertices[AttrIndex] += AttrCount;
      }
 
-    for (BranchIndex = 0; BranchIndex < BranchCount; BranchIndex++)
+    MaxVAttrCountI = std::max(MaxVAttrCountI,(size_t)VAttrCountI);
+    MaxIndexCount  = std::max(MaxIndexCount,(size_t)IndexCount);
+
+    Counts->Branches += BranchCount;
+    Counts->Vertices += VAttrCountI;
+    Counts->Indices  += IndexCount;
+   }
+
+  /* resize() never shrinks capacity, so reused buffers stop */
+  /* allocating once they have grown to the largest instance */
+
+  Buffers->Attr.resize(MaxAttrCount * 3 + 1);
+  Buffers->Pos.resize(MaxVAttrCountI * 3 + 1);
+  Buffers->Normal.resize(MaxVAttrCountI * 3 + 1);
+  Buffers->TexCoord.resize(MaxVAttrCountI * 2 + 1);
+  Buffers->Tangent.resize(MaxVAttrCountI * 3 + 1);
+  Buffers->BiNormal.resize(MaxVAttrCountI * 3 + 1);
+  Buffers->Index.resize(MaxIndexCount + 1);
+  Buffers->BranchCounts.resize(GroupCount + 1);
+ }
+
+static void        CountBranches      (NGPBenchBuffers    *Buffers,
+                                       const P3DHLIPlantInstance
+                                                          *PlantInstance)
+ {
+  PlantInstance->GetBranchCountMulti(&Buffers->BranchCounts[0]);
+ }
+
+static void        FillAttr           (NGPBenchBuffers    *Buffers,
+                                       const P3DHLIPlantTemplate
+                                                          *PlantTemplate,
+                                       const P3DHLIPlantInstance
+                                                          *PlantInstance,
+                                       unsigned int        Attr)
+ {
+  unsigned int                         GroupCount;
+
+  GroupCount = PlantTemplate->GetGroupCount();
+
+  for (unsigned int GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
+   {
+    PlantInstance->FillVAttrBuffer(&Buffers->Attr[0],GroupIndex,Attr);
+   }
+ }
+
+static void        FillIndices        (NGPBenchBuffers    *Buffers,
+                                       const P3DHLIPlantTemplate
+                                                          *PlantTemplate,
+                                       const P3DHLIPlantInstance
+                                                          *PlantInstance)
+ {
+  unsigned int                         GroupCount;
+
+  GroupCount = PlantTemplate->GetGroupCount();
+
+  for (unsigned int GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
+   {
+    unsigned int                       BranchCount;
+    unsigned int                       BranchVAttrCount;
+    unsigned int                       BranchIndexCount;
+
+    BranchCount      = PlantInstance->GetBranchCount(GroupIndex);
+    BranchVAttrCount = PlantTemplate->GetVAttrCountI(GroupIndex);
+    BranchIndexCount = PlantTemplate->GetIndexCount(GroupIndex,P3D_TRIANGLE_LIST);
+
+    for (unsigned int BranchIndex = 0; BranchIndex < BranchCount; BranchIndex++)
      {
       PlantTemplate->FillIndexBuffer
-       (&IndexBuffer[BranchIndex * BranchIndexCount],
+       (&Buffers->Index[BranchIndex * BranchIndexCount],
          GroupIndex,
          P3D_TRIANGLE_LIST,
          P3D_UNSIGNED_INT,
          BranchVAttrCount * BranchIndex);
      }
    }
-  else
-   {
-    fprintf(stderr,"error: out of memory\n");
-   }
-
-  delete[] IndexBuffer;
-  delete[] TexCoordBuffer;
-  delete[] BiNormalBuffer;
-  delete[] NormalBuffer;
-  delete[] PosBuffer;
  }
 
-static void        Render             (P3DHLIPlantTemplate*PlantTemplate,
-                                       P3DHLIPlantInstance*PlantInstance)
+/* complete indexed-mode generation, as done by viewers and exporters */
+
+static void        Generate           (NGPBenchBuffers    *Buffers,
+                                       const P3DHLIPlantTemplate
+                                                          *PlantTemplate,
+                                       const P3DHLIPlantInstance
+                                                          *PlantInstance)
  {
   P3DVector3f                          BBoxMin;
   P3DVector3f                          BBoxMax;
-  unsigned int                         GroupIndex;
   unsigned int                         GroupCount;
 
   PlantInstance->GetBoundingBox(BBoxMin.v,BBoxMax.v);
 
   GroupCount = PlantTemplate->GetGroupCount();
 
-  for (GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
+  for (unsigned int GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
+   {
+    P3DHLIVAttrBuffers                 VAttrBuffers;
+
+    if (PlantInstance->GetBranchCount(GroupIndex) == 0)
+     {
+      continue;
+     }
+
+    if (PlantTemplate->GetMaterial(GroupIndex)->IsBillboard())
+     {
+      VAttrBuffers.AddAttr(P3D_ATTR_BILLBOARD_POS,&Buffers->Pos[0],0,sizeof(float) * 3);
+     }
+    else
+     {
+      VAttrBuffers.AddAttr(P3D_ATTR_VERTEX,&Buffers->Pos[0],0,sizeof(float) * 3);
+     }
+
+    VAttrBuffers.AddAttr(P3D_ATTR_NORMAL,&Buffers->Normal[0],0,sizeof(float) * 3);
+    VAttrBuffers.AddAttr(P3D_ATTR_TEXCOORD0,&Buffers->TexCoord[0],0,sizeof(float) * 2);
+    VAttrBuffers.AddAttr(P3D_ATTR_TANGENT,&Buffers->Tangent[0],0,sizeof(float) * 3);
+    VAttrBuffers.AddAttr(P3D_ATTR_BINORMAL,&Buffers->BiNormal[0],0,sizeof(float) * 3);
+
+    PlantInstance->FillVAttrBuffersI(&VAttrBuffers,GroupIndex);
+   }
+
+  FillIndices(Buffers,PlantTemplate,PlantInstance);
+ }
+
+/* JSON output helpers */
+
+static void        WriteJSONString    (FILE               *Out,
+                                       const char         *Str)
+ {
+  fputc('"',Out);
+
+  for (; *Str != 0; Str++)
+   {
+    if      ((*Str == '"') || (*Str == '\\'))
+     {
+      fprintf(Out,"\\%c",*Str);
+     }
+    else if ((unsigned char)(*Str) < 0x20)
+     {
+      fprintf(Out,"\\u%04x",(unsigned int)(unsigned char)(*Str));
+     }
+    else
+     {
+      fputc(*Str,Out);
+     }
+   }
+
+  fputc('"',Out);
+ }
+
+static double      Rate               (double              Amount,
+                                       double              Time)
+ {
+  return(Time > 0.0 ? Amount / Time : 0.0);
+ }
+
+static void        WriteTimer         (FILE               *Out,
+                                       const char         *Name,
+                                       const NGPBenchTimer&Timer,
+                                       const char         *RateName,
+                                       double              Amount,
+                                       bool                Last)
+ {
+  fprintf(Out,"          \"%s\": {\"time_min_s\": %.9f, \"time_mean_s\": %.9f, "
+              "\"allocs\": %lu, \"alloc_bytes\": %lu",
+          Name,
+          Timer.GetMinTime(),
+          Timer.GetMeanTime(),
+          Timer.GetAllocCount(),
+          Timer.GetAllocBytes());
+
+  if (RateName != 0)
    {
-    RenderBranchGroup(PlantTemplate,PlantInstance,GroupIndex);
+    fprintf(Out,", \"%s\": %.1f",RateName,Rate(Amount,Timer.GetMinTime()));
    }
+
+  fprintf(Out,"}%s\n",Last ? "" : ",");
  }
 
-static bool        MakeShot           (const char         *ModelFileName,
-                                       unsigned int        RepeatCount)
+/* Benchmark settings */
+
+typedef struct
+ {
+  std::vector<std::string>             ModelFileNames;
+  std::vector<unsigned int>            Seeds;
+  std::vector<unsigned int>            ThreadCounts;
+  unsigned int                         RepeatCount;
+  std::string                          SamplesDir;
+  bool                                 UseSamples;
+  const char                          *OutputFileName;
+  bool                                 ShowHelp;
+ } NGPBenchOptions;
+
+/* Multi-threaded generation: each thread generates all seeds on its own */
+
+typedef struct
  {
+  const P3DHLIPlantTemplate           *PlantTemplate;
+  const NGPBenchOptions               *Options;
   bool                                 Result;
-  P3DInputStringStreamFile             SourceStream;
-  P3DHLIPlantTemplate                 *PlantTemplate;
-  P3DHLIPlantInstance                 *PlantInstance;
+ } NGPBenchThreadTask;
+
+static void        GenerateThreadFunc (void               *Arg)
+ {
+  NGPBenchThreadTask                  *Task;
+  NGPBenchBuffers                      Buffers;
+  NGPBenchCounts                       Counts;
+
+  Task = (NGPBenchThreadTask*)Arg;
+
+  try
+   {
+    for (unsigned int Index = 0; Index < Task->Options->RepeatCount; Index++)
+     {
+      for (unsigned int SeedIndex = 0; SeedIndex < Task->Options->Seeds.size(); SeedIndex++)
+       {
+        P3DHLIPlantInstance           *PlantInstance;
+
+        PlantInstance = Task->PlantTemplate->CreateInstance(Task->Options->Seeds[SeedIndex]);
+
+        PrepareBuffers(&Buffers,&Counts,Task->PlantTemplate,PlantInstance);
+        Generate(&Buffers,Task->PlantTemplate,PlantInstance);
+
+        delete PlantInstance;
+       }
+     }
+   }
+  catch (...)
+   {
+    Task->Result = false;
+   }
+ }
+
+static bool        RunThreaded        (double             *Time,
+                                       const P3DHLIPlantTemplate
+                                                          *PlantTemplate,
+                                       const NGPBenchOptions
+                                                          *Options,
+                                       unsigned int        ThreadCount)
+ {
+  std::vector<NGPBenchThreadTask>      Tasks(ThreadCount);
+  std::vector<P3DThread*>              Threads(ThreadCount);
+  bool                                 Result;
+  double                               StartTime;
 
   Result = true;
 
+  for (unsigned int Index = 0; Index < ThreadCount; Index++)
+   {
+    Tasks[Index].PlantTemplate = PlantTemplate;
+    Tasks[Index].Options       = Options;
+    Tasks[Index].Result        = true;
+
+    Threads[Index] = new P3DThread();
+   }
+
+  AllocCountEnabled = false;
+
+  StartTime = GetWallTime();
+
+  for (unsigned int Index = 0; Index < ThreadCount; Index++)
+   {
+    if (!Threads[Index]->Start(GenerateThreadFunc,&Tasks[Index]))
+     {
+      /* run it here, so that timing still reflects full workload */
+
+      GenerateThreadFunc(&Tasks[Index]);
+     }
+   }
+
+  for (unsigned int Index = 0; Index < ThreadCount; Index++)
+   {
+    Threads[Index]->Join();
+   }
+
+  *Time = GetWallTime() - StartTime;
+
+  AllocCountEnabled = true;
+
+  for (unsigned int Index = 0; Index < ThreadCount; Index++)
+   {
+    if (!Tasks[Index].Result)
+     {
+      Result = false;
+     }
+
+    delete Threads[Index];
+   }
+
+  return(Result);
+ }
+
+static bool        BenchmarkModel     (FILE               *Out,
+                                       const char         *ModelFileName,
+                                       const NGPBenchOptions
+                                                          *Options,
+                                       bool                First)
+ {
+  bool                                 Result;
+  P3DHLIPlantTemplate                 *PlantTemplate;
+  P3DHLIPlantInstance                 *PlantInstance;
+  NGPBenchTimer                        LoadTimer;
+  NGPBenchBuffers                      Buffers;
+
+  Result        = true;
   PlantTemplate = 0;
   PlantInstance = 0;
 
   try
    {
-    SourceStream.Open(ModelFileName);
+    for (unsigned int Index = 0; Index < Options->RepeatCount; Index++)
+     {
+      P3DInputStringStreamFile         SourceStream;
+
+      delete PlantTemplate;
+
+      PlantTemplate = 0;
+
+      LoadTimer.Start();
+
+      SourceStream.Open(ModelFileName);
+
+      PlantTemplate = new P3DHLIPlantTemplate(&SourceStream);
+
+      SourceStream.Close();
+
+      LoadTimer.Stop();
+     }
+
+    fprintf(Out,"%s    {\n",First ? "" : ",\n");
+    fprintf(Out,"      \"file\": ");
+    WriteJSONString(Out,ModelFileName);
+    fprintf(Out,",\n");
+    fprintf(Out,"      \"groups\": %u,\n",PlantTemplate->GetGroupCount());
+    fprintf(Out,"      \"load\": {\"time_min_s\": %.9f, \"time_mean_s\": %.9f, "
+                "\"allocs\": %lu, \"alloc_bytes\": %lu},\n",
+            LoadTimer.GetMinTime(),
+            LoadTimer.GetMeanTime(),
+            LoadTimer.GetAllocCount(),
+            LoadTimer.GetAllocBytes());
+    fprintf(Out,"      \"seeds\": [\n");
+
+    NGPBenchCounts                     TotalCounts;
+
+    TotalCounts.Branches = 0;
+    TotalCounts.Vertices = 0;
+    TotalCounts.Indices  = 0;
+
+    for (unsigned int SeedIndex = 0; SeedIndex < Options->Seeds.size(); SeedIndex++)
+     {
+      NGPBenchCounts                   Counts;
+      NGPBenchTimer                    CreateTimer;
+      NGPBenchTimer                    BranchCountTimer;
+      NGPBenchTimer                    BBoxTimer;
+      NGPBenchTimer                    AttrTimers[NGPBENCH_ATTR_COUNT];
+      NGPBenchTimer                    IndexTimer;
+      NGPBenchTimer                    GenerateTimer;
+      P3DVector3f                      BBoxMin;
+      P3DVector3f                      BBoxMax;
+
+      for (unsigned int Index = 0; Index < Options->RepeatCount; Index++)
+       {
+        delete PlantInstance;
+
+        PlantInstance = 0;
+
+        CreateTimer.Start();
+        PlantInstance = PlantTemplate->CreateInstance(Options->Seeds[SeedIndex]);
+        CreateTimer.Stop();
+       }
+
+      PrepareBuffers(&Buffers,&Counts,PlantTemplate,PlantInstance);
+
+      for (unsigned int Index = 0; Index < Options->RepeatCount; Index++)
+       {
+        BranchCountTimer.Start();
+        CountBranches(&Buffers,PlantInstance);
+        BranchCountTimer.Stop();
+
+        BBoxTimer.Start();
+        PlantInstance->GetBoundingBox(BBoxMin.v,BBoxMax.v);
+        BBoxTimer.Stop();
+
+        for (unsigned int AttrIndex = 0; AttrIndex < NGPBENCH_ATTR_COUNT; AttrIndex++)
+         {
+          AttrTimers[AttrIndex].Start();
+          FillAttr(&Buffers,PlantTemplate,PlantInstance,BenchAttrs[AttrIndex]);
+          AttrTimers[AttrIndex].Stop();
+         }
+
+        IndexTimer.Start();
+        FillIndices(&Buffers,PlantTemplate,PlantInstance);
+        IndexTimer.Stop();
+
+        GenerateTimer.Start();
+        Generate(&Buffers,PlantTemplate,PlantInstance);
+        GenerateTimer.Stop();
+       }
+
+      TotalCounts.Branches += Counts.Branches;
+      TotalCounts.Vertices += Counts.Vertices;
+      TotalCounts.Indices  += Counts.Indices;
+
+      fprintf(Out,"        {\n");
+      fprintf(Out,"          \"seed\": %u,\n",Options->Seeds[SeedIndex]);
+      fprintf(Out,"          \"branches\": %u,\n",Counts.Branches);
+      fprintf(Out,"          \"vertices\": %u,\n",Counts.Vertices);
+      fprintf(Out,"          \"indices\": %u,\n",Counts.Indices);
+      fprintf(Out,"          \"bbox\": [%g, %g, %g, %g, %g, %g],\n",
+              BBoxMin.X(),BBoxMin.Y(),BBoxMin.Z(),
+              BBoxMax.X(),BBoxMax.Y(),BBoxMax.Z());
+
+      WriteTimer(Out,"create_instance",CreateTimer,0,0.0,false);
+      WriteTimer(Out,"branch_count",BranchCountTimer,"branches_per_s",Counts.Branches,false);
+      WriteTimer(Out,"bounding_box",BBoxTimer,"branches_per_s",Counts.Branches,false);
 
-    PlantTemplate = new P3DHLIPlantTemplate(&SourceStream);
+      for (unsigned int AttrIndex = 0; AttrIndex < NGPBENCH_ATTR_COUNT; AttrIndex++)
+       {
+        WriteTimer(Out,BenchAttrNames[AttrIndex],AttrTimers[AttrIndex],
+                   "vertices_per_s",Counts.AttrVertices[AttrIndex],false);
+       }
 
-    SourceStream.Close();
+      WriteTimer(Out,"index_fill",IndexTimer,"indices_per_s",Counts.Indices,false);
+      WriteTimer(Out,"generate",GenerateTimer,"vertices_per_s",Counts.Vertices,false);
 
-    PlantInstance = PlantTemplate->CreateInstance();
+      fprintf(Out,"          \"generate_branches_per_s\": %.1f\n",
+              Rate(Counts.Branches,GenerateTimer.GetMinTime()));
+      fprintf(Out,"        }%s\n",SeedIndex + 1 < Options->Seeds.size() ? "," : "");
 
-    for (unsigned int Index = 0; Index < RepeatCount; Index++)
+      delete PlantInstance;
+
+      PlantInstance = 0;
+     }
+
+    fprintf(Out,"      ],\n");
+    fprintf(Out,"      \"threads\": [\n");
+
+    for (unsigned int Index = 0; Index < Options->ThreadCounts.size(); Index++)
      {
-      Render(PlantTemplate,PlantInstance);
+      unsigned int                     ThreadCount;
+      double                           Time;
+      double                           Work;
+
+      ThreadCount = Options->ThreadCounts[Index];
+
+      if (!RunThreaded(&Time,PlantTemplate,Options,ThreadCount))
+       {
+        fprintf(stderr,"error: %s: multi-threaded generation failed\n",ModelFileName);
+
+        Result = false;
+       }
+
+      Work = (double)ThreadCount * Options->RepeatCount;
+
+      fprintf(Out,"        {\"threads\": %u, \"time_s\": %.9f, "
+                  "\"vertices_per_s\": %.1f, \"branches_per_s\": %.1f}%s\n",
+              ThreadCount,
+              Time,
+              Rate(Work * TotalCounts.Vertices,Time),
+              Rate(Work * TotalCounts.Branches,Time),
+              Index + 1 < Options->ThreadCounts.size() ? "," : "");
      }
+
+    fprintf(Out,"      ]\n");
+    fprintf(Out,"    }");
    }
   catch (const P3DException &Exception)
    {
-    fprintf(stderr,"error: %s\n",Exception.GetMessage());
+    fprintf(stderr,"error: %s: %s\n",ModelFileName,Exception.GetMessage());
+
+    Result = false;
+   }
+  catch (const std::bad_alloc &)
+   {
+    fprintf(stderr,"error: %s: out of memory\n",ModelFileName);
 
     Result = false;
    }
@@ -187,111 +818,344 @@ static bool        MakeShot           (const char         *ModelFileName,
   return(Result);
  }
 
+static bool        HasModelExtension  (const char         *FileName)
+ {
+  size_t                               NameLen;
+  size_t                               ExtLen;
+
+  NameLen = strlen(FileName);
+  ExtLen  = strlen(NGPBENCH_MODEL_EXT);
+
+  return((NameLen > ExtLen) &&
+         (strcmp(&FileName[NameLen - ExtLen],NGPBENCH_MODEL_EXT) == 0));
+ }
+
+static void        ListSampleModels   (std::vector<std::string>
+                                                          &FileNames,
+                                       const std::string  &SamplesDir)
+ {
+  std::vector<std::string>             Names;
+
+  #ifdef _WIN32
+  WIN32_FIND_DATAA                     FindData;
+  HANDLE                               FindHandle;
+  std::string                          Pattern;
+
+  Pattern = P3DPathName::JoinPaths(SamplesDir.c_str(),"*" NGPBENCH_MODEL_EXT);
+
+  FindHandle = FindFirstFileA(Pattern.c_str(),&FindData);
+
+  if (FindHandle != INVALID_HANDLE_VALUE)
+   {
+    do
+     {
+      if (HasModelExtension(FindData.cFileName))
+       {
+        Names.push_back(FindData.cFileName);
+       }
+     } while (FindNextFileA(FindHandle,&FindData));
+
+    FindClose(FindHandle);
+   }
+  #else
+  DIR                                 *Dir;
+  struct dirent                       *DirEntry;
+
+  Dir = opendir(SamplesDir.c_str());
+
+  if (Dir != NULL)
+   {
+    while ((DirEntry = readdir(Dir)) != NULL)
+     {
+      if (HasModelExtension(DirEntry->d_name))
+       {
+        Names.push_back(DirEntry->d_name);
+       }
+     }
+
+    closedir(Dir);
+   }
+  #endif
+
+  /* stable order makes reports of different runs comparable */
+
+  std::sort(Names.begin(),Names.end());
+
+  for (unsigned int Index = 0; Index < Names.size(); Index++)
+   {
+    FileNames.push_back(P3DPathName::JoinPaths(SamplesDir.c_str(),Names[Index].c_str()));
+   }
+ }
+
+static bool        RunBenchmark       (const NGPBenchOptions
+                                                          *Options)
+ {
+  bool                                 Result;
+  std::vector<std::string>             ModelFileNames;
+  FILE                                *Out;
+
+  Result = true;
+
+  if (Options->UseSamples)
+   {
+    ListSampleModels(ModelFileNames,Options->SamplesDir);
+   }
+
+  ModelFileNames.insert(ModelFileNames.end(),
+                        Options->ModelFileNames.begin(),
+                        Options->ModelFileNames.end());
+
+  if (ModelFileNames.empty())
+   {
+    fprintf(stderr,"error: no models found\n");
+
+    return(false);
+   }
+
+  if (Options->OutputFileName != 0)
+   {
+    Out = fopen(Options->OutputFileName,"w");
+
+    if (Out == 0)
+     {
+      fprintf(stderr,"error: unable to create output file (%s)\n",Options->OutputFileName);
+
+      return(false);
+     }
+   }
+  else
+   {
+    Out = stdout;
+   }
+
+  fprintf(Out,"{\n");
+  fprintf(Out,"  \"format\": %u,\n",NGPBENCH_FORMAT_VERSION);
+  fprintf(Out,"  \"repeat\": %u,\n",Options->RepeatCount);
+  fprintf(Out,"  \"cpus\": %u,\n",P3DThread::GetCPUCount());
+  fprintf(Out,"  \"models\": [\n");
+
+  bool                                 First;
+
+  First = true;
+
+  for (unsigned int Index = 0; Index < ModelFileNames.size(); Index++)
+   {
+    if (BenchmarkModel(Out,ModelFileNames[Index].c_str(),Options,First))
+     {
+      First = false;
+     }
+    else
+     {
+      Result = false;
+     }
+   }
+
+  fprintf(Out,"\n  ]\n");
+  fprintf(Out,"}\n");
+
+  if (Out != stdout)
+   {
+    if (fclose(Out) != 0)
+     {
+      fprintf(stderr,"error: unable to write output file (%s)\n",Options->OutputFileName);
+
+      Result = false;
+     }
+   }
+
+  return(Result);
+ }
+
 static void        ShowHelpMessage    ()
  {
-  printf("Usage: ngpbench [options] modelfile\n");
+  printf("Usage: ngpbench [options] [modelfile ...]\n");
   printf("Options:\n");
   printf("  -h            Display this information\n");
-  printf("  -r <count>    Repeat <count> times (1 by default)\n");
+  printf("  -r <count>    Repeat each measurement <count> times (3 by default)\n");
+  printf("  -s <list>     Comma-separated list of seeds (0,1,2 by default)\n");
+  printf("  -t <list>     Comma-separated list of thread counts\n");
+  printf("                (1 and number of CPUs by default)\n");
+  printf("  -d <dir>      Directory with sample models (\"%s\" by default)\n",NGPBENCH_SAMPLES_DIR);
+  printf("  -n            Do not benchmark sample models\n");
+  printf("  -o <file>     Write JSON report to <file> instead of stdout\n");
  }
 
-static bool        ParseArgs          (char              **ModelFileName,
-                                       unsigned int       *RepeatCount,
-                                       bool               *ShowHelp,
+static bool        ParseUIntList      (std::vector<unsigned int>
+                                                          &Values,
+                                       const char         *Str,
+                                       bool                AllowZero)
+ {
+  Values.clear();
+
+  while (true)
+   {
+    unsigned int                       Value;
+    char                              *End;
+
+    if ((*Str < '0') || (*Str > '9'))
+     {
+      return(false);
+     }
+
+    Value = (unsigned int)strtoul(Str,&End,10);
+
+    if ((Value == 0) && (!AllowZero))
+     {
+      return(false);
+     }
+
+    Values.push_back(Value);
+
+    if      (*End == 0)
+     {
+      return(true);
+     }
+    else if (*End == ',')
+     {
+      Str = End + 1;
+     }
+    else
+     {
+      return(false);
+     }
+   }
+ }
+
+static const char *GetOptionValue     (unsigned int       *ArgIndex,
+                                       unsigned int        ArgCount,
+                                       char               *ArgValues[])
+ {
+  (*ArgIndex)++;
+
+  if ((*ArgIndex) < ArgCount)
+   {
+    return(ArgValues[*ArgIndex]);
+   }
+
+  fprintf(stderr,"error: option \"%s\" requires a value\n",ArgValues[(*ArgIndex) - 1]);
+
+  return(0);
+ }
+
+static bool        ParseArgs          (NGPBenchOptions    *Options,
                                        unsigned int        ArgCount,
                                        char               *ArgValues[])
  {
   bool                                 Result;
   unsigned int                         ArgIndex;
-  char                                *ArgStr;
-  unsigned int                         ArgStrLen;
+  const char                          *ArgStr;
+  const char                          *Value;
+  unsigned int                         CPUCount;
 
   Result = true;
 
-  *ModelFileName = 0;
-  *RepeatCount   = 1;
-  *ShowHelp      = false;
+  Options->RepeatCount    = 3;
+  Options->SamplesDir     = NGPBENCH_SAMPLES_DIR;
+  Options->UseSamples     = true;
+  Options->OutputFileName = 0;
+  Options->ShowHelp       = false;
+
+  Options->Seeds.push_back(0);
+  Options->Seeds.push_back(1);
+  Options->Seeds.push_back(2);
+
+  CPUCount = P3DThread::GetCPUCount();
+
+  Options->ThreadCounts.push_back(1);
+
+  if (CPUCount > 1)
+   {
+    Options->ThreadCounts.push_back(CPUCount);
+   }
 
   ArgIndex = 1;
 
   while ((ArgIndex < ArgCount) && (Result))
    {
-    ArgStr    = ArgValues[ArgIndex];
-    ArgStrLen = strlen(ArgStr);
+    ArgStr = ArgValues[ArgIndex];
 
-    if (ArgStrLen > 0)
+    if      (strcmp(ArgStr,"-h") == 0)
+     {
+      Options->ShowHelp = true;
+     }
+    else if (strcmp(ArgStr,"-n") == 0)
+     {
+      Options->UseSamples = false;
+     }
+    else if (strcmp(ArgStr,"-r") == 0)
      {
-      if (ArgStr[0] == '-')
+      if ((Value = GetOptionValue(&ArgIndex,ArgCount,ArgValues)) == 0)
        {
-        if      (strcmp(ArgStr,"-h") == 0)
-         {
-          *ShowHelp = true;
-         }
-        else if (strcmp(ArgStr,"-r") == 0)
-         {
-          ArgIndex++;
-
-          if (ArgIndex < ArgCount)
-           {
-            if (sscanf(ArgValues[ArgIndex],"%u",RepeatCount) == 1)
-             {
-              if ((*RepeatCount) > 0)
-               {
-               }
-              else
-               {
-                Result = false;
-
-                fprintf(stderr,"error: repeat count must be greater than zero\n");
-               }
-             }
-            else
-             {
-              Result = false;
-
-              fprintf(stderr,"error: invalid repeat count (%s)\n",ArgValues[ArgIndex]);
-             }
-           }
-          else
-           {
-            Result = false;
-
-            fprintf(stderr,"error: image size required\n");
-           }
-         }
-        else
-         {
-          Result = false;
-
-          fprintf(stderr,"error: invalid option \"%s\"\n",ArgStr);
-         }
+        Result = false;
        }
-      else
+      else if ((sscanf(Value,"%u",&Options->RepeatCount) != 1) ||
+               (Options->RepeatCount == 0))
        {
-        if      ((*ModelFileName) == 0)
-         {
-          *ModelFileName = ArgStr;
-         }
-        else
-         {
-          Result = false;
+        Result = false;
 
-          fprintf(stderr,"error: extra argument passed\n");
-         }
+        fprintf(stderr,"error: invalid repeat count (%s)\n",Value);
        }
      }
+    else if (strcmp(ArgStr,"-s") == 0)
+     {
+      if ((Value = GetOptionValue(&ArgIndex,ArgCount,ArgValues)) == 0)
+       {
+        Result = false;
+       }
+      else if (!ParseUIntList(Options->Seeds,Value,true))
+       {
+        Result = false;
 
-    ArgIndex++;
-   }
+        fprintf(stderr,"error: invalid seed list (%s)\n",Value);
+       }
+     }
+    else if (strcmp(ArgStr,"-t") == 0)
+     {
+      if ((Value = GetOptionValue(&ArgIndex,ArgCount,ArgValues)) == 0)
+       {
+        Result = false;
+       }
+      else if (!ParseUIntList(Options->ThreadCounts,Value,false))
+       {
+        Result = false;
 
-  if (!(*ShowHelp))
-   {
-    if ((*ModelFileName) == 0)
+        fprintf(stderr,"error: invalid thread count list (%s)\n",Value);
+       }
+     }
+    else if (strcmp(ArgStr,"-d") == 0)
+     {
+      if ((Value = GetOptionValue(&ArgIndex,ArgCount,ArgValues)) == 0)
+       {
+        Result = false;
+       }
+      else
+       {
+        Options->SamplesDir = Value;
+       }
+     }
+    else if (strcmp(ArgStr,"-o") == 0)
+     {
+      if ((Value = GetOptionValue(&ArgIndex,ArgCount,ArgValues)) == 0)
+       {
+        Result = false;
+       }
+      else
+       {
+        Options->OutputFileName = Value;
+       }
+     }
+    else if ((ArgStr[0] == '-') && (ArgStr[1] != 0))
      {
       Result = false;
 
-      fprintf(stderr,"error: model file name required\n");
+      fprintf(stderr,"error: invalid option \"%s\"\n",ArgStr);
      }
+    else
+     {
+      Options->ModelFileNames.push_back(ArgStr);
+     }
+
+    ArgIndex++;
    }
 
   return(Result);
@@ -301,21 +1165,19 @@ int                main               (int                 argc,
                                        char               *argv[])
  {
   bool                                 Result;
-  char                                *ModelFileName;
-  unsigned int                         RepeatCount;
-  bool                                 ShowHelp;
+  NGPBenchOptions                      Options;
 
-  Result = ParseArgs(&ModelFileName,&RepeatCount,&ShowHelp,argc,argv);
+  Result = ParseArgs(&Options,argc,argv);
 
   if (Result)
    {
-    if (ShowHelp)
+    if (Options.ShowHelp)
      {
       ShowHelpMessage();
      }
     else
      {
-      Result = MakeShot(ModelFileName,RepeatCount);
+      Result = RunBenchmark(&Options);
      }
    }
 
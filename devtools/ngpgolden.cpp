@@ -0,0 +1,1451 @@
+/***************************************************************************
+
+ Copyright (C) 2008  Sergey Prokhorchuk
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***************************************************************************/
+
+/* Golden geometry checker */
+
+/* Every model is generated for several seeds with dummies enabled and    */
+/* disabled, using reference path (per-group indexed fill, per-attribute  */
+/* fill and index fill). Geometry of each group is quantized and hashed,  */
+/* digests are compared against golden digest file. Faster paths          */
+/* (GetBranchCountMulti, FillVAttrBuffersIMulti and cached geometry       */
+/* layout) are compared with reference path within the same run, and     */
+/* first diverging group, branch and vertex is reported.                  */
+/*                                                                        */
+/* Full reference geometry may also be dumped to directory (-w) and       */
+/* compared later (-c) to locate divergence found by digest mismatch.     */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#ifdef _WIN32
+ #define WIN32_LEAN_AND_MEAN 1
+ #include <windows.h>
+#else
+ #include <dirent.h>
+#endif
+
+#include <ngpcore/p3dhli.h>
+#include <ngpcore/p3dhash.h>
+
+#include <ngput/p3dospath.h>
+#include <ngput/p3dgeomcache.h>
+
+#define NGPGOLDEN_SAMPLES_DIR   "samples"
+#define NGPGOLDEN_GOLDEN_FILE   "devtools/ngpgolden.txt"
+#define NGPGOLDEN_MODEL_EXT     ".ngp"
+#define NGPGOLDEN_DUMP_EXT      ".dmp"
+
+#define NGPGOLDEN_DEF_QSTEP     (1.0e-4f)
+#define NGPGOLDEN_DEF_TOLERANCE (1.0e-5f)
+
+#define NGPGOLDEN_DUMP_MAGIC    (0x44475047U) /* "GPGD" */
+
+static const unsigned int              GoldenAttrs[] =
+ {
+  P3D_ATTR_VERTEX,
+  P3D_ATTR_NORMAL,
+  P3D_ATTR_TEXCOORD0,
+  P3D_ATTR_TANGENT,
+  P3D_ATTR_BINORMAL,
+  P3D_ATTR_BILLBOARD_POS
+ };
+
+static const char                     *GoldenAttrNames[P3D_MAX_ATTRS] =
+ {
+  "vertex",
+  "normal",
+  "texcoord0",
+  "tangent",
+  "binormal",
+  "billboard_pos"
+ };
+
+#define NGPGOLDEN_ATTR_COUNT (sizeof(GoldenAttrs) / sizeof(GoldenAttrs[0]))
+
+static unsigned int GetAttrSize       (unsigned int        Attr)
+ {
+  return(Attr == P3D_ATTR_TEXCOORD0 ? 2 : 3);
+ }
+
+/* Generated geometry of one branch group */
+
+typedef struct
+ {
+  unsigned int                         BranchCount;
+  bool                                 Billboard;
+
+  /* indexed mode, all branches */
+  unsigned int                         VAttrCountI; /* per branch */
+  unsigned int                         IndexCount;  /* per branch */
+  std::vector<float>                   VAttrsI[P3D_MAX_ATTRS];
+  std::vector<unsigned int>            IndicesI;
+
+  /* per-attribute mode, indices are the same for all branches */
+  /* (except base), so they are stored for the first one only  */
+  unsigned int                         VAttrCount[P3D_MAX_ATTRS]; /* per branch */
+  std::vector<float>                   VAttrs[P3D_MAX_ATTRS];
+  std::vector<unsigned int>            VAttrIndices[P3D_MAX_ATTRS];
+ } NGPGoldenGroup;
+
+typedef struct
+ {
+  float                                BBox[6];
+  std::vector<NGPGoldenGroup>          Groups;
+ } NGPGoldenPlant;
+
+static bool        IsAttrUsed         (const NGPGoldenGroup
+                                                          *Group,
+                                       unsigned int        Attr)
+ {
+  /* billboard position is meaningful for billboard groups only */
+
+  return((Attr != P3D_ATTR_BILLBOARD_POS) || (Group->Billboard));
+ }
+
+/* Reference path - per-group and per-attribute calls, as simple as possible */
+
+static void        GenerateReference  (NGPGoldenPlant     *Plant,
+                                       const P3DHLIPlantTemplate
+                                                          *PlantTemplate,
+                                       const P3DHLIPlantInstance
+                                                          *PlantInstance)
+ {
+  unsigned int                         GroupCount;
+
+  GroupCount = PlantTemplate->GetGroupCount();
+
+  PlantInstance->GetBoundingBox(&Plant->BBox[0],&Plant->BBox[3]);
+
+  Plant->Groups.clear();
+  Plant->Groups.resize(GroupCount);
+
+  for (unsigned int GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
+   {
+    NGPGoldenGroup                    *Group;
+    P3DHLIVAttrBuffers                 VAttrBuffers;
+    unsigned int                       BranchCount;
+    unsigned int                       PrimitiveCount;
+    unsigned int                       VAttrIndexCount;
+
+    Group       = &Plant->Groups[GroupIndex];
+    BranchCount = PlantInstance->GetBranchCount(GroupIndex);
+
+    Group->BranchCount = BranchCount;
+    Group->Billboard   = PlantTemplate->GetMaterial(GroupIndex)->IsBillboard();
+    Group->VAttrCountI = PlantTemplate->GetVAttrCountI(GroupIndex);
+    Group->IndexCount  = PlantTemplate->GetIndexCount(GroupIndex,P3D_TRIANGLE_LIST);
+
+    for (unsigned int AttrIndex = 0; AttrIndex < NGPGOLDEN_ATTR_COUNT; AttrIndex++)
+     {
+      unsigned int                     Attr = GoldenAttrs[AttrIndex];
+
+      Group->VAttrCount[Attr] = 0;
+
+      if (IsAttrUsed(Group,Attr))
+       {
+        Group->VAttrsI[Attr].resize(Group->VAttrCountI * BranchCount * GetAttrSize(Attr) + 1);
+
+        VAttrBuffers.AddAttr(Attr,&Group->VAttrsI[Attr][0],0,sizeof(float) * GetAttrSize(Attr));
+
+        Group->VAttrsI[Attr].pop_back();
+       }
+     }
+
+    if (BranchCount > 0)
+     {
+      PlantInstance->FillVAttrBuffersI(&VAttrBuffers,GroupIndex);
+     }
+
+    Group->IndicesI.resize(Group->IndexCount * BranchCount);
+
+    for (unsigned int BranchIndex = 0; BranchIndex < BranchCount; BranchIndex++)
+     {
+      PlantTemplate->FillIndexBuffer(&Group->IndicesI[BranchIndex * Group->IndexCount],
+                                     GroupIndex,
+                                     P3D_TRIANGLE_LIST,
+                                     P3D_UNSIGNED_INT,
+                                     Group->VAttrCountI * BranchIndex);
+     }
+
+    PrimitiveCount  = PlantTemplate->GetPrimitiveCount(GroupIndex);
+    VAttrIndexCount = 0;
+
+    for (unsigned int PrimitiveIndex = 0; PrimitiveIndex < PrimitiveCount; PrimitiveIndex++)
+     {
+      VAttrIndexCount += PlantTemplate->GetPrimitiveType(GroupIndex,PrimitiveIndex) == P3D_QUAD ? 4 : 3;
+     }
+
+    for (unsigned int AttrIndex = 0; AttrIndex < NGPGOLDEN_ATTR_COUNT; AttrIndex++)
+     {
+      unsigned int                     Attr = GoldenAttrs[AttrIndex];
+
+      if (!IsAttrUsed(Group,Attr))
+       {
+        continue;
+       }
+
+      Group->VAttrCount[Attr] = PlantTemplate->GetVAttrCount(GroupIndex,Attr);
+
+      Group->VAttrs[Attr].resize(Group->VAttrCount[Attr] * BranchCount * GetAttrSize(Attr) + 1);
+      Group->VAttrIndices[Attr].resize(VAttrIndexCount + 1);
+
+      if (BranchCount > 0)
+       {
+        PlantInstance->FillVAttrBuffer(&Group->VAttrs[Attr][0],GroupIndex,Attr);
+       }
+
+      PlantTemplate->FillVAttrIndexBuffer(&Group->VAttrIndices[Attr][0],
+                                          GroupIndex,
+                                          Attr,
+                                          P3D_UNSIGNED_INT,
+                                          0);
+
+      Group->VAttrs[Attr].pop_back();
+      Group->VAttrIndices[Attr].pop_back();
+     }
+   }
+ }
+
+/* Tolerance-aware hashing: values are rounded to multiple of quantization */
+/* step, so that differences in last bits do not change digest. Negative   */
+/* zero is folded into zero.                                               */
+
+static void        AddQuantized       (P3DHash            *Hash,
+                                       const std::vector<float>
+                                                          &Values,
+                                       float               Step)
+ {
+  Hash->AddUInt((P3Duint32)Values.size());
+
+  for (unsigned int Index = 0; Index < Values.size(); Index++)
+   {
+    double                             Quantized;
+
+    Quantized = floor((double)Values[Index] / Step + 0.5);
+
+    Hash->AddUInt64((P3Duint64)(P3Dint64)(Quantized == 0.0 ? 0.0 : Quantized));
+   }
+ }
+
+static void        AddUInts           (P3DHash            *Hash,
+                                       const std::vector<unsigned int>
+                                                          &Values)
+ {
+  Hash->AddUInt((P3Duint32)Values.size());
+
+  if (!Values.empty())
+   {
+    Hash->AddUIntArray(&Values[0],(unsigned int)Values.size());
+   }
+ }
+
+static P3Duint64   CalcGroupDigest    (const NGPGoldenGroup
+                                                          *Group,
+                                       float               Step)
+ {
+  P3DHash                              Hash;
+
+  Hash.AddUInt(Group->BranchCount);
+  Hash.AddUInt(Group->VAttrCountI);
+  Hash.AddUInt(Group->IndexCount);
+
+  for (unsigned int AttrIndex = 0; AttrIndex < NGPGOLDEN_ATTR_COUNT; AttrIndex++)
+   {
+    unsigned int                       Attr = GoldenAttrs[AttrIndex];
+
+    Hash.AddUInt(Group->VAttrCount[Attr]);
+
+    AddQuantized(&Hash,Group->VAttrsI[Attr],Step);
+    AddQuantized(&Hash,Group->VAttrs[Attr],Step);
+    AddUInts(&Hash,Group->VAttrIndices[Attr]);
+   }
+
+  AddUInts(&Hash,Group->IndicesI);
+
+  return(Hash.GetValue());
+ }
+
+static P3Duint64   CalcBBoxDigest     (const NGPGoldenPlant
+                                                          *Plant,
+                                       float               Step)
+ {
+  P3DHash                              Hash;
+  std::vector<float>                   BBox(Plant->BBox,Plant->BBox + 6);
+
+  AddQuantized(&Hash,BBox,Step);
+
+  return(Hash.GetValue());
+ }
+
+/* Comparison with tolerance, reports first difference */
+
+static bool        IsEqualFloat       (float               a,
+                                       float               b,
+                                       float               Tolerance)
+ {
+  float                                Scale;
+
+  Scale = std::max(1.0f,std::max((float)fabs(a),(float)fabs(b)));
+
+  return(fabs(a - b) <= Tolerance * Scale);
+ }
+
+static bool        CompareFloats      (const char         *CaseName,
+                                       const char         *PathName,
+                                       unsigned int        GroupIndex,
+                                       const char         *What,
+                                       const std::vector<float>
+                                                          &Ref,
+                                       const std::vector<float>
+                                                          &Test,
+                                       unsigned int        ElemSize,
+                                       unsigned int        BranchVAttrCount,
+                                       float               Tolerance)
+ {
+  if (Ref.size() != Test.size())
+   {
+    fprintf(stderr,"%s: %s: group %u: %s: size differs (%u != %u)\n",
+            CaseName,PathName,GroupIndex,What,
+            (unsigned int)Test.size(),(unsigned int)Ref.size());
+
+    return(false);
+   }
+
+  for (unsigned int Index = 0; Index < Ref.size(); Index++)
+   {
+    if (!IsEqualFloat(Ref[Index],Test[Index],Tolerance))
+     {
+      unsigned int                     Vertex;
+
+      Vertex = Index / ElemSize;
+
+      fprintf(stderr,"%s: %s: group %u, branch %u, vertex %u: %s[%u] differs (%.9g != %.9g)\n",
+              CaseName,PathName,GroupIndex,
+              BranchVAttrCount > 0 ? Vertex / BranchVAttrCount : 0,
+              BranchVAttrCount > 0 ? Vertex % BranchVAttrCount : Vertex,
+              What,Index % ElemSize,
+              Test[Index],Ref[Index]);
+
+      return(false);
+     }
+   }
+
+  return(true);
+ }
+
+static bool        CompareUInts       (const char         *CaseName,
+                                       const char         *PathName,
+                                       unsigned int        GroupIndex,
+                                       const char         *What,
+                                       const std::vector<unsigned int>
+                                                          &Ref,
+                                       const std::vector<unsigned int>
+                                                          &Test,
+                                       unsigned int        BranchCount)
+ {
+  if (Ref.size() != Test.size())
+   {
+    fprintf(stderr,"%s: %s: group %u: %s: size differs (%u != %u)\n",
+            CaseName,PathName,GroupIndex,What,
+            (unsigned int)Test.size(),(unsigned int)Ref.size());
+
+    return(false);
+   }
+
+  for (unsigned int Index = 0; Index < Ref.size(); Index++)
+   {
+    if (Ref[Index] != Test[Index])
+     {
+      unsigned int                     PerBranch;
+
+      PerBranch = BranchCount > 0 ? (unsigned int)Ref.size() / BranchCount : 0;
+
+      fprintf(stderr,"%s: %s: group %u, branch %u: %s[%u] differs (%u != %u)\n",
+              CaseName,PathName,GroupIndex,
+              PerBranch > 0 ? Index / PerBranch : 0,
+              What,
+              PerBranch > 0 ? Index % PerBranch : Index,
+              Test[Index],Ref[Index]);
+
+      return(false);
+     }
+   }
+
+  return(true);
+ }
+
+/* compares indexed-mode data always, per-attribute mode data only */
+/* if present in tested geometry                                    */
+
+static bool        ComparePlants      (const char         *CaseName,
+                                       const char         *PathName,
+                                       const NGPGoldenPlant
+                                                          *Ref,
+                                       const NGPGoldenPlant
+                                                          *Test,
+                                       float               Tolerance)
+ {
+  if (Ref->Groups.size() != Test->Groups.size())
+   {
+    fprintf(stderr,"%s: %s: group count differs (%u != %u)\n",
+            CaseName,PathName,
+            (unsigned int)Test->Groups.size(),(unsigned int)Ref->Groups.size());
+
+    return(false);
+   }
+
+  for (unsigned int GroupIndex = 0; GroupIndex < Ref->Groups.size(); GroupIndex++)
+   {
+    const NGPGoldenGroup              *RefGroup  = &Ref->Groups[GroupIndex];
+    const NGPGoldenGroup              *TestGroup = &Test->Groups[GroupIndex];
+
+    if ((RefGroup->BranchCount != TestGroup->BranchCount) ||
+        (RefGroup->VAttrCountI != TestGroup->VAttrCountI) ||
+        (RefGroup->IndexCount  != TestGroup->IndexCount))
+     {
+      fprintf(stderr,"%s: %s: group %u: counts differ "
+                     "(branches %u/%u, vertices %u/%u, indices %u/%u)\n",
+              CaseName,PathName,GroupIndex,
+              TestGroup->BranchCount,RefGroup->BranchCount,
+              TestGroup->VAttrCountI,RefGroup->VAttrCountI,
+              TestGroup->IndexCount,RefGroup->IndexCount);
+
+      return(false);
+     }
+
+    for (unsigned int AttrIndex = 0; AttrIndex < NGPGOLDEN_ATTR_COUNT; AttrIndex++)
+     {
+      unsigned int                     Attr = GoldenAttrs[AttrIndex];
+      std::string                      What;
+
+      What = std::string(GoldenAttrNames[Attr]) + " (indexed)";
+
+      if (!CompareFloats(CaseName,PathName,GroupIndex,What.c_str(),
+                         RefGroup->VAttrsI[Attr],TestGroup->VAttrsI[Attr],
+                         GetAttrSize(Attr),RefGroup->VAttrCountI,Tolerance))
+       {
+        return(false);
+       }
+
+      if (TestGroup->VAttrs[Attr].empty() && TestGroup->VAttrIndices[Attr].empty())
+       {
+        continue;
+       }
+
+      What = GoldenAttrNames[Attr];
+
+      if (!CompareFloats(CaseName,PathName,GroupIndex,What.c_str(),
+                         RefGroup->VAttrs[Attr],TestGroup->VAttrs[Attr],
+                         GetAttrSize(Attr),RefGroup->VAttrCount[Attr],Tolerance))
+       {
+        return(false);
+       }
+
+      What += " index";
+
+      if (!CompareUInts(CaseName,PathName,GroupIndex,What.c_str(),
+                        RefGroup->VAttrIndices[Attr],TestGroup->VAttrIndices[Attr],1))
+       {
+        return(false);
+       }
+     }
+
+    if (!CompareUInts(CaseName,PathName,GroupIndex,"index",
+                      RefGroup->IndicesI,TestGroup->IndicesI,RefGroup->BranchCount))
+     {
+      return(false);
+     }
+   }
+
+  for (unsigned int Index = 0; Index < 6; Index++)
+   {
+    if (!IsEqualFloat(Ref->BBox[Index],Test->BBox[Index],Tolerance))
+     {
+      fprintf(stderr,"%s: %s: bounding box differs\n",CaseName,PathName);
+
+      return(false);
+     }
+   }
+
+  return(true);
+ }
+
+/* Faster paths, compared against reference within the same run */
+
+static bool        CheckBranchCountMulti
+                                      (const char         *CaseName,
+                                       const NGPGoldenPlant
+                                                          *Ref,
+                                       const P3DHLIPlantInstance
+                                                          *PlantInstance)
+ {
+  std::vector<unsigned int>            BranchCounts(Ref->Groups.size() + 1);
+
+  PlantInstance->GetBranchCountMulti(&BranchCounts[0]);
+
+  for (unsigned int GroupIndex = 0; GroupIndex < Ref->Groups.size(); GroupIndex++)
+   {
+    if (BranchCounts[GroupIndex] != Ref->Groups[GroupIndex].BranchCount)
+     {
+      fprintf(stderr,"%s: GetBranchCountMulti: group %u: branch count differs (%u != %u)\n",
+              CaseName,GroupIndex,
+              BranchCounts[GroupIndex],Ref->Groups[GroupIndex].BranchCount);
+
+      return(false);
+     }
+   }
+
+  return(true);
+ }
+
+static bool        CheckFillMulti     (const char         *CaseName,
+                                       const NGPGoldenPlant
+                                                          *Ref,
+                                       const P3DHLIPlantInstance
+                                                          *PlantInstance,
+                                       float               Tolerance)
+ {
+  NGPGoldenPlant                       Test;
+  std::vector<P3DHLIVAttrBufferSet>    BufferSets(Ref->Groups.size() + 1);
+
+  memcpy(Test.BBox,Ref->BBox,sizeof(Test.BBox));
+
+  Test.Groups.resize(Ref->Groups.size());
+
+  for (unsigned int GroupIndex = 0; GroupIndex < Ref->Groups.size(); GroupIndex++)
+   {
+    const NGPGoldenGroup              *RefGroup  = &Ref->Groups[GroupIndex];
+    NGPGoldenGroup                    *TestGroup = &Test.Groups[GroupIndex];
+
+    TestGroup->BranchCount = RefGroup->BranchCount;
+    TestGroup->VAttrCountI = RefGroup->VAttrCountI;
+    TestGroup->IndexCount  = RefGroup->IndexCount;
+    TestGroup->IndicesI    = RefGroup->IndicesI;
+
+    for (unsigned int Attr = 0; Attr < P3D_MAX_ATTRS; Attr++)
+     {
+      BufferSets[GroupIndex][Attr] = 0;
+     }
+
+    for (unsigned int AttrIndex = 0; AttrIndex < NGPGOLDEN_ATTR_COUNT; AttrIndex++)
+     {
+      unsigned int                     Attr = GoldenAttrs[AttrIndex];
+
+      if (IsAttrUsed(RefGroup,Attr))
+       {
+        TestGroup->VAttrsI[Attr].resize(RefGroup->VAttrsI[Attr].size() + 1);
+
+        BufferSets[GroupIndex][Attr] = &TestGroup->VAttrsI[Attr][0];
+       }
+     }
+   }
+
+  PlantInstance->FillVAttrBuffersIMulti(&BufferSets[0]);
+
+  for (unsigned int GroupIndex = 0; GroupIndex < Test.Groups.size(); GroupIndex++)
+   {
+    for (unsigned int Attr = 0; Attr < P3D_MAX_ATTRS; Attr++)
+     {
+      if (!Test.Groups[GroupIndex].VAttrsI[Attr].empty())
+       {
+        Test.Groups[GroupIndex].VAttrsI[Attr].pop_back();
+       }
+     }
+   }
+
+  return(ComparePlants(CaseName,"FillVAttrBuffersIMulti",Ref,&Test,Tolerance));
+ }
+
+static bool        CheckCachedGeometry(const char         *CaseName,
+                                       const NGPGoldenPlant
+                                                          *Ref,
+                                       const P3DHLIPlantTemplate
+                                                          *PlantTemplate,
+                                       const P3DHLIPlantInstance
+                                                          *PlantInstance,
+                                       float               Tolerance)
+ {
+  P3DCachedPlantGeometry              *Geometry;
+  NGPGoldenPlant                       Test;
+
+  Geometry = P3DCachedPlantGeometry::Generate(PlantTemplate,PlantInstance);
+
+  Geometry->GetBoundingBox(&Test.BBox[0],&Test.BBox[3]);
+
+  Test.Groups.resize(Geometry->GetGroupCount());
+
+  for (unsigned int GroupIndex = 0; GroupIndex < Test.Groups.size(); GroupIndex++)
+   {
+    NGPGoldenGroup                    *TestGroup = &Test.Groups[GroupIndex];
+    unsigned int                       VAttrTotal;
+
+    TestGroup->BranchCount = Geometry->GetBranchCount(GroupIndex);
+    TestGroup->VAttrCountI = Geometry->GetVAttrCountI(GroupIndex);
+    TestGroup->IndexCount  = Geometry->GetIndexCount(GroupIndex);
+
+    VAttrTotal = TestGroup->VAttrCountI * TestGroup->BranchCount;
+
+    for (unsigned int AttrIndex = 0; AttrIndex < NGPGOLDEN_ATTR_COUNT; AttrIndex++)
+     {
+      unsigned int                     Attr = GoldenAttrs[AttrIndex];
+
+      /* cache stores attributes which are used by material only */
+
+      if ((GroupIndex < Ref->Groups.size()) &&
+          (!Ref->Groups[GroupIndex].VAttrsI[Attr].empty()) &&
+          (Geometry->HasAttr(GroupIndex,Attr)))
+       {
+        const float                   *Values;
+
+        Values = Geometry->GetVAttrBufferI(GroupIndex,Attr);
+
+        TestGroup->VAttrsI[Attr].assign(Values,Values + VAttrTotal * GetAttrSize(Attr));
+       }
+      else if (GroupIndex < Ref->Groups.size())
+       {
+        TestGroup->VAttrsI[Attr] = Ref->Groups[GroupIndex].VAttrsI[Attr];
+       }
+     }
+
+    TestGroup->IndicesI.resize(TestGroup->IndexCount * TestGroup->BranchCount + 1);
+
+    Geometry->FillIndexBuffer(&TestGroup->IndicesI[0],GroupIndex,P3D_UNSIGNED_INT);
+
+    TestGroup->IndicesI.pop_back();
+   }
+
+  delete Geometry;
+
+  return(ComparePlants(CaseName,"P3DCachedPlantGeometry",Ref,&Test,Tolerance));
+ }
+
+/* Reference dumps, written in native byte order */
+
+static void        WriteUInt          (FILE               *File,
+                                       unsigned int        Value)
+ {
+  fwrite(&Value,sizeof(Value),1,File);
+ }
+
+static bool        ReadUInt           (FILE               *File,
+                                       unsigned int       *Value)
+ {
+  return(fread(Value,sizeof(*Value),1,File) == 1);
+ }
+
+template<typename T> static void WriteArray
+                                      (FILE               *File,
+                                       const std::vector<T>
+                                                          &Values)
+ {
+  WriteUInt(File,(unsigned int)Values.size());
+
+  if (!Values.empty())
+   {
+    fwrite(&Values[0],sizeof(T),Values.size(),File);
+   }
+ }
+
+template<typename T> static bool ReadArray
+                                      (FILE               *File,
+                                       std::vector<T>     &Values)
+ {
+  unsigned int                         Size;
+
+  if (!ReadUInt(File,&Size))
+   {
+    return(false);
+   }
+
+  Values.resize(Size);
+
+  return((Size == 0) || (fread(&Values[0],sizeof(T),Size,File) == Size));
+ }
+
+static bool        WriteDump          (const char         *FileName,
+                                       const NGPGoldenPlant
+                                                          *Plant)
+ {
+  FILE                                *File;
+
+  File = fopen(FileName,"wb");
+
+  if (File == 0)
+   {
+    return(false);
+   }
+
+  WriteUInt(File,NGPGOLDEN_DUMP_MAGIC);
+  fwrite(Plant->BBox,sizeof(float),6,File);
+  WriteUInt(File,(unsigned int)Plant->Groups.size());
+
+  for (unsigned int GroupIndex = 0; GroupIndex < Plant->Groups.size(); GroupIndex++)
+   {
+    const NGPGoldenGroup              *Group = &Plant->Groups[GroupIndex];
+
+    WriteUInt(File,Group->BranchCount);
+    WriteUInt(File,Group->Billboard ? 1 : 0);
+    WriteUInt(File,Group->VAttrCountI);
+    WriteUInt(File,Group->IndexCount);
+    WriteArray(File,Group->IndicesI);
+
+    for (unsigned int Attr = 0; Attr < P3D_MAX_ATTRS; Attr++)
+     {
+      WriteUInt(File,Group->VAttrCount[Attr]);
+      WriteArray(File,Group->VAttrsI[Attr]);
+      WriteArray(File,Group->VAttrs[Attr]);
+      WriteArray(File,Group->VAttrIndices[Attr]);
+     }
+   }
+
+  return(fclose(File) == 0);
+ }
+
+static bool        ReadDump           (NGPGoldenPlant     *Plant,
+                                       const char         *FileName)
+ {
+  FILE                                *File;
+  unsigned int                         Magic;
+  unsigned int                         GroupCount;
+  bool                                 Result;
+
+  File = fopen(FileName,"rb");
+
+  if (File == 0)
+   {
+    return(false);
+   }
+
+  Result = ReadUInt(File,&Magic) && (Magic == NGPGOLDEN_DUMP_MAGIC) &&
+           (fread(Plant->BBox,sizeof(float),6,File) == 6) &&
+           ReadUInt(File,&GroupCount);
+
+  if (Result)
+   {
+    Plant->Groups.resize(GroupCount);
+   }
+
+  for (unsigned int GroupIndex = 0; (GroupIndex < Plant->Groups.size()) && Result; GroupIndex++)
+   {
+    NGPGoldenGroup                    *Group = &Plant->Groups[GroupIndex];
+    unsigned int                       Billboard;
+
+    Result = ReadUInt(File,&Group->BranchCount) &&
+             ReadUInt(File,&Billboard) &&
+             ReadUInt(File,&Group->VAttrCountI) &&
+             ReadUInt(File,&Group->IndexCount) &&
+             ReadArray(File,Group->IndicesI);
+
+    Group->Billboard = Billboard != 0;
+
+    for (unsigned int Attr = 0; (Attr < P3D_MAX_ATTRS) && Result; Attr++)
+     {
+      Result = ReadUInt(File,&Group->VAttrCount[Attr]) &&
+               ReadArray(File,Group->VAttrsI[Attr]) &&
+               ReadArray(File,Group->VAttrs[Attr]) &&
+               ReadArray(File,Group->VAttrIndices[Attr]);
+     }
+   }
+
+  fclose(File);
+
+  return(Result);
+ }
+
+/* Golden digest file. Each line is                          */
+/* <model> <seed> <dummies> <group|bbox> <branches> <digest> */
+
+typedef std::map<std::string,std::string> NGPGoldenDigests;
+
+static bool        LoadGoldenFile     (NGPGoldenDigests   &Digests,
+                                       const char         *FileName)
+ {
+  FILE                                *File;
+  char                                 Line[1024];
+
+  File = fopen(FileName,"r");
+
+  if (File == 0)
+   {
+    return(false);
+   }
+
+  while (fgets(Line,sizeof(Line),File) != 0)
+   {
+    char                               Model[512];
+    char                               Where[32];
+    unsigned int                       Seed;
+    unsigned int                       Dummies;
+    char                               Rest[256];
+    std::string                        Key;
+
+    if ((Line[0] == '#') || (Line[0] == '\n'))
+     {
+      continue;
+     }
+
+    if (sscanf(Line,"%511s %u %u %31s %255[^\n]",Model,&Seed,&Dummies,Where,Rest) == 5)
+     {
+      char                             KeyStr[600];
+
+      sprintf(KeyStr,"%s %u %u %s",Model,Seed,Dummies,Where);
+
+      Digests[KeyStr] = Rest;
+     }
+   }
+
+  fclose(File);
+
+  return(true);
+ }
+
+/* Options and main loop */
+
+typedef struct
+ {
+  std::vector<std::string>             ModelFileNames;
+  std::vector<unsigned int>            Seeds;
+  std::string                          SamplesDir;
+  bool                                 UseSamples;
+  std::string                          GoldenFileName;
+  bool                                 UpdateGolden;
+  const char                          *WriteDumpDir;
+  const char                          *CompareDumpDir;
+  float                                QuantStep;
+  float                                Tolerance;
+  bool                                 ShowHelp;
+ } NGPGoldenOptions;
+
+typedef struct
+ {
+  unsigned int                         CaseCount;
+  unsigned int                         FailCount;
+ } NGPGoldenStats;
+
+static bool        CheckCase          (FILE               *GoldenOut,
+                                       const NGPGoldenDigests
+                                                          &Golden,
+                                       const NGPGoldenOptions
+                                                          *Options,
+                                       const char         *ModelName,
+                                       P3DHLIPlantTemplate*PlantTemplate,
+                                       unsigned int        Seed,
+                                       bool                Dummies)
+ {
+  bool                                 Result;
+  P3DHLIPlantInstance                 *PlantInstance;
+  NGPGoldenPlant                       Plant;
+  char                                 CaseName[600];
+  char                                 Line[700];
+
+  Result = true;
+
+  sprintf(CaseName,"%s %u %u",ModelName,Seed,Dummies ? 1 : 0);
+
+  PlantTemplate->SetDummiesEnabled(Dummies);
+
+  PlantInstance = PlantTemplate->CreateInstance(Seed);
+
+  GenerateReference(&Plant,PlantTemplate,PlantInstance);
+
+  /* digests */
+
+  for (unsigned int GroupIndex = 0; GroupIndex <= Plant.Groups.size(); GroupIndex++)
+   {
+    std::string                        Key;
+    char                               Where[32];
+
+    if (GroupIndex < Plant.Groups.size())
+     {
+      sprintf(Where,"%u",GroupIndex);
+      sprintf(Line,"%u %016llx",
+              Plant.Groups[GroupIndex].BranchCount,
+              (unsigned long long)CalcGroupDigest(&Plant.Groups[GroupIndex],Options->QuantStep));
+     }
+    else
+     {
+      strcpy(Where,"bbox");
+      sprintf(Line,"- %016llx",(unsigned long long)CalcBBoxDigest(&Plant,Options->QuantStep));
+     }
+
+    Key = std::string(CaseName) + " " + Where;
+
+    if (GoldenOut != 0)
+     {
+      fprintf(GoldenOut,"%s %s\n",Key.c_str(),Line);
+     }
+    else if (Result)
+     {
+      NGPGoldenDigests::const_iterator Iter;
+
+      Iter = Golden.find(Key);
+
+      if      (Iter == Golden.end())
+       {
+        fprintf(stderr,"%s: no golden digest for %s%s\n",
+                CaseName,
+                GroupIndex < Plant.Groups.size() ? "group " : "",
+                Where);
+
+        Result = false;
+       }
+      else if (Iter->second != Line)
+       {
+        /* groups are checked in order, so this is the first diverging one */
+
+        fprintf(stderr,"%s: digest mismatch in %s%s (got \"%s\", expected \"%s\")\n",
+                CaseName,
+                GroupIndex < Plant.Groups.size() ? "group " : "",
+                Where,Line,Iter->second.c_str());
+
+        Result = false;
+       }
+     }
+   }
+
+  /* faster paths */
+
+  if (!CheckBranchCountMulti(CaseName,&Plant,PlantInstance))
+   {
+    Result = false;
+   }
+
+  if (!CheckFillMulti(CaseName,&Plant,PlantInstance,Options->Tolerance))
+   {
+    Result = false;
+   }
+
+  if (!CheckCachedGeometry(CaseName,&Plant,PlantTemplate,PlantInstance,Options->Tolerance))
+   {
+    Result = false;
+   }
+
+  /* reference dumps */
+
+  if ((Options->WriteDumpDir != 0) || (Options->CompareDumpDir != 0))
+   {
+    char                               DumpName[700];
+    std::string                        DumpFileName;
+
+    sprintf(DumpName,"%s-%u-%u" NGPGOLDEN_DUMP_EXT,ModelName,Seed,Dummies ? 1 : 0);
+
+    if (Options->WriteDumpDir != 0)
+     {
+      DumpFileName = P3DPathName::JoinPaths(Options->WriteDumpDir,DumpName);
+
+      if (!WriteDump(DumpFileName.c_str(),&Plant))
+       {
+        fprintf(stderr,"%s: unable to write dump (%s)\n",CaseName,DumpFileName.c_str());
+
+        Result = false;
+       }
+     }
+
+    if (Options->CompareDumpDir != 0)
+     {
+      NGPGoldenPlant                   DumpPlant;
+
+      DumpFileName = P3DPathName::JoinPaths(Options->CompareDumpDir,DumpName);
+
+      if (!ReadDump(&DumpPlant,DumpFileName.c_str()))
+       {
+        fprintf(stderr,"%s: unable to read dump (%s)\n",CaseName,DumpFileName.c_str());
+
+        Result = false;
+       }
+      else if (!ComparePlants(CaseName,"reference dump",&DumpPlant,&Plant,Options->Tolerance))
+       {
+        Result = false;
+       }
+     }
+   }
+
+  delete PlantInstance;
+
+  return(Result);
+ }
+
+static bool        CheckModel         (NGPGoldenStats     *Stats,
+                                       FILE               *GoldenOut,
+                                       const NGPGoldenDigests
+                                                          &Golden,
+                                       const NGPGoldenOptions
+                                                          *Options,
+                                       const char         *ModelFileName)
+ {
+  bool                                 Result;
+  P3DHLIPlantTemplate                 *PlantTemplate;
+  std::string                          ModelName;
+
+  Result        = true;
+  PlantTemplate = 0;
+  ModelName     = P3DPathName::BaseName(ModelFileName);
+
+  try
+   {
+    P3DInputStringStreamFile           SourceStream;
+
+    SourceStream.Open(ModelFileName);
+
+    PlantTemplate = new P3DHLIPlantTemplate(&SourceStream);
+
+    SourceStream.Close();
+
+    for (unsigned int SeedIndex = 0; SeedIndex < Options->Seeds.size(); SeedIndex++)
+     {
+      for (unsigned int Dummies = 0; Dummies < 2; Dummies++)
+       {
+        Stats->CaseCount++;
+
+        if (!CheckCase(GoldenOut,Golden,Options,ModelName.c_str(),PlantTemplate,
+                       Options->Seeds[SeedIndex],Dummies != 0))
+         {
+          Stats->FailCount++;
+
+          Result = false;
+         }
+       }
+     }
+   }
+  catch (const P3DException &Exception)
+   {
+    fprintf(stderr,"error: %s: %s\n",ModelFileName,Exception.GetMessage());
+
+    Result = false;
+   }
+
+  delete PlantTemplate;
+
+  return(Result);
+ }
+
+/* Clone transforms are converted to quaternions, rotations near 180   */
+/* degrees are checked explicitly since samples seldom produce them    */
+
+static bool        CheckQuaternionFromMatrix
+                                      (NGPGoldenStats     *Stats,
+                                       float               Tolerance)
+ {
+  static const double                  Axes[][3] =
+   {
+    { 1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, 0.0, 1.0 },
+    { 1.0, 2.0, 3.0 }, { -3.0, 1.0, 2.0 }, { 1.0, -1.0, 1.0e-3 }
+   };
+  static const double                  Deltas[] =
+   {
+    2.0, 0.5, 1.0e-2, 2.0e-4, 4.0e-7, 0.0
+   };
+  bool                                 Result;
+
+  Result = true;
+
+  for (unsigned int AxisIndex = 0; AxisIndex < sizeof(Axes) / sizeof(Axes[0]); AxisIndex++)
+   {
+    for (unsigned int DeltaIndex = 0; DeltaIndex < sizeof(Deltas) / sizeof(Deltas[0]); DeltaIndex++)
+     {
+      const double                    *Axis;
+      double                           Length;
+      double                           Angle;
+      P3DQuaternionf                   Ref;
+      P3DQuaternionf                   Test;
+      float                            Matrix[16];
+      float                            Sign;
+      float                            Error;
+
+      Axis   = Axes[AxisIndex];
+      Length = sqrt(Axis[0] * Axis[0] + Axis[1] * Axis[1] + Axis[2] * Axis[2]);
+      Angle  = P3DMATH_PI - Deltas[DeltaIndex];
+
+      Ref.Set((float)(Axis[0] / Length * sin(Angle * 0.5)),
+              (float)(Axis[1] / Length * sin(Angle * 0.5)),
+              (float)(Axis[2] / Length * sin(Angle * 0.5)),
+              (float)(cos(Angle * 0.5)));
+
+      Ref.ToMatrix(Matrix);
+      Test.FromMatrix(Matrix);
+
+      Sign  = (Ref.q[0] * Test.q[0] + Ref.q[1] * Test.q[1] +
+               Ref.q[2] * Test.q[2] + Ref.q[3] * Test.q[3]) < 0.0f ? -1.0f : 1.0f;
+      Error = 0.0f;
+
+      for (unsigned int Index = 0; Index < 4; Index++)
+       {
+        Error = std::max(Error,(float)fabs(Ref.q[Index] - Sign * Test.q[Index]));
+       }
+
+      Stats->CaseCount++;
+
+      if (Error > Tolerance)
+       {
+        fprintf(stderr,"error: quaternion from matrix: axis (%g,%g,%g), angle pi-%g: error %g\n",
+                Axis[0],Axis[1],Axis[2],Deltas[DeltaIndex],Error);
+
+        Stats->FailCount++;
+
+        Result = false;
+       }
+     }
+   }
+
+  return(Result);
+ }
+
+static bool        HasModelExtension  (const char         *FileName)
+ {
+  size_t                               NameLen;
+  size_t                               ExtLen;
+
+  NameLen = strlen(FileName);
+  ExtLen  = strlen(NGPGOLDEN_MODEL_EXT);
+
+  return((NameLen > ExtLen) &&
+         (strcmp(&FileName[NameLen - ExtLen],NGPGOLDEN_MODEL_EXT) == 0));
+ }
+
+static void        ListSampleModels   (std::vector<std::string>
+                                                          &FileNames,
+                                       const std::string  &SamplesDir)
+ {
+  std::vector<std::string>             Names;
+
+  #ifdef _WIN32
+  WIN32_FIND_DATAA                     FindData;
+  HANDLE                               FindHandle;
+  std::string                          Pattern;
+
+  Pattern = P3DPathName::JoinPaths(SamplesDir.c_str(),"*" NGPGOLDEN_MODEL_EXT);
+
+  FindHandle = FindFirstFileA(Pattern.c_str(),&FindData);
+
+  if (FindHandle != INVALID_HANDLE_VALUE)
+   {
+    do
+     {
+      if (HasModelExtension(FindData.cFileName))
+       {
+        Names.push_back(FindData.cFileName);
+       }
+     } while (FindNextFileA(FindHandle,&FindData));
+
+    FindClose(FindHandle);
+   }
+  #else
+  DIR                                 *Dir;
+  struct dirent                       *DirEntry;
+
+  Dir = opendir(SamplesDir.c_str());
+
+  if (Dir != NULL)
+   {
+    while ((DirEntry = readdir(Dir)) != NULL)
+     {
+      if (HasModelExtension(DirEntry->d_name))
+       {
+        Names.push_back(DirEntry->d_name);
+       }
+     }
+
+    closedir(Dir);
+   }
+  #endif
+
+  std::sort(Names.begin(),Names.end());
+
+  for (unsigned int Index = 0; Index < Names.size(); Index++)
+   {
+    FileNames.push_back(P3DPathName::JoinPaths(SamplesDir.c_str(),Names[Index].c_str()));
+   }
+ }
+
+static bool        RunChecks          (const NGPGoldenOptions
+                                                          *Options)
+ {
+  bool                                 Result;
+  std::vector<std::string>             ModelFileNames;
+  NGPGoldenDigests                     Golden;
+  FILE                                *GoldenOut;
+  NGPGoldenStats                       Stats;
+
+  Result    = true;
+  GoldenOut = 0;
+
+  Stats.CaseCount = 0;
+  Stats.FailCount = 0;
+
+  if (Options->UseSamples)
+   {
+    ListSampleModels(ModelFileNames,Options->SamplesDir);
+   }
+
+  ModelFileNames.insert(ModelFileNames.end(),
+                        Options->ModelFileNames.begin(),
+                        Options->ModelFileNames.end());
+
+  if (ModelFileNames.empty())
+   {
+    fprintf(stderr,"error: no models found\n");
+
+    return(false);
+   }
+
+  if (Options->UpdateGolden)
+   {
+    GoldenOut = fopen(Options->GoldenFileName.c_str(),"w");
+
+    if (GoldenOut == 0)
+     {
+      fprintf(stderr,"error: unable to create golden file (%s)\n",Options->GoldenFileName.c_str());
+
+      return(false);
+     }
+
+    fprintf(GoldenOut,"# ngpgolden digests, quantization step %g\n",Options->QuantStep);
+    fprintf(GoldenOut,"# <model> <seed> <dummies> <group|bbox> <branches> <digest>\n");
+   }
+  else if (!LoadGoldenFile(Golden,Options->GoldenFileName.c_str()))
+   {
+    fprintf(stderr,"error: unable to read golden file (%s)\n",Options->GoldenFileName.c_str());
+
+    return(false);
+   }
+
+  if (!CheckQuaternionFromMatrix(&Stats,Options->Tolerance))
+   {
+    Result = false;
+   }
+
+  for (unsigned int Index = 0; Index < ModelFileNames.size(); Index++)
+   {
+    if (!CheckModel(&Stats,GoldenOut,Golden,Options,ModelFileNames[Index].c_str()))
+     {
+      Result = false;
+     }
+   }
+
+  if (GoldenOut != 0)
+   {
+    if (fclose(GoldenOut) != 0)
+     {
+      fprintf(stderr,"error: unable to write golden file (%s)\n",Options->GoldenFileName.c_str());
+
+      Result = false;
+     }
+   }
+
+  printf("%u of %u cases passed\n",Stats.CaseCount - Stats.FailCount,Stats.CaseCount);
+
+  return(Result);
+ }
+
+static void        ShowHelpMessage    ()
+ {
+  printf("Usage: ngpgolden [options] [modelfile ...]\n");
+  printf("Options:\n");
+  printf("  -h            Display this information\n");
+  printf("  -g <file>     Golden digest file (\"%s\" by default)\n",NGPGOLDEN_GOLDEN_FILE);
+  printf("  -u            Update golden digest file instead of checking it\n");
+  printf("  -s <list>     Comma-separated list of seeds (0,1,42 by default)\n");
+  printf("  -d <dir>      Directory with sample models (\"%s\" by default)\n",NGPGOLDEN_SAMPLES_DIR);
+  printf("  -n            Do not check sample models\n");
+  printf("  -q <step>     Quantization step used for digests (%g by default)\n",NGPGOLDEN_DEF_QSTEP);
+  printf("  -t <tol>      Relative tolerance for comparisons (%g by default)\n",NGPGOLDEN_DEF_TOLERANCE);
+  printf("  -w <dir>      Write reference geometry dumps to <dir>\n");
+  printf("  -c <dir>      Compare with reference geometry dumps from <dir>\n");
+ }
+
+static bool        ParseSeedList      (std::vector<unsigned int>
+                                                          &Seeds,
+                                       const char         *Str)
+ {
+  Seeds.clear();
+
+  while (true)
+   {
+    char                              *End;
+
+    if ((*Str < '0') || (*Str > '9'))
+     {
+      return(false);
+     }
+
+    Seeds.push_back((unsigned int)strtoul(Str,&End,10));
+
+    if      (*End == 0)
+     {
+      return(true);
+     }
+    else if (*End == ',')
+     {
+      Str = End + 1;
+     }
+    else
+     {
+      return(false);
+     }
+   }
+ }
+
+static bool        ParseArgs          (NGPGoldenOptions   *Options,
+                                       unsigned int        ArgCount,
+                                       char               *ArgValues[])
+ {
+  unsigned int                         ArgIndex;
+
+  Options->SamplesDir     = NGPGOLDEN_SAMPLES_DIR;
+  Options->UseSamples     = true;
+  Options->GoldenFileName = NGPGOLDEN_GOLDEN_FILE;
+  Options->UpdateGolden   = false;
+  Options->WriteDumpDir   = 0;
+  Options->CompareDumpDir = 0;
+  Options->QuantStep      = NGPGOLDEN_DEF_QSTEP;
+  Options->Tolerance      = NGPGOLDEN_DEF_TOLERANCE;
+  Options->ShowHelp       = false;
+
+  Options->Seeds.push_back(0);
+  Options->Seeds.push_back(1);
+  Options->Seeds.push_back(42);
+
+  for (ArgIndex = 1; ArgIndex < ArgCount; ArgIndex++)
+   {
+    const char                        *ArgStr = ArgValues[ArgIndex];
+    const char                        *Value  = 0;
+
+    if      (strcmp(ArgStr,"-h") == 0)
+     {
+      Options->ShowHelp = true;
+
+      continue;
+     }
+    else if (strcmp(ArgStr,"-u") == 0)
+     {
+      Options->UpdateGolden = true;
+
+      continue;
+     }
+    else if (strcmp(ArgStr,"-n") == 0)
+     {
+      Options->UseSamples = false;
+
+      continue;
+     }
+    else if ((ArgStr[0] != '-') || (ArgStr[1] == 0))
+     {
+      Options->ModelFileNames.push_back(ArgStr);
+
+      continue;
+     }
+
+    if ((strlen(ArgStr) != 2) || (strchr("gsdqtwc",ArgStr[1]) == 0))
+     {
+      fprintf(stderr,"error: invalid option \"%s\"\n",ArgStr);
+
+      return(false);
+     }
+
+    if (++ArgIndex >= ArgCount)
+     {
+      fprintf(stderr,"error: option \"%s\" requires a value\n",ArgStr);
+
+      return(false);
+     }
+
+    Value = ArgValues[ArgIndex];
+
+    switch (ArgStr[1])
+     {
+      case 'g' : Options->GoldenFileName = Value; break;
+      case 'd' : Options->SamplesDir     = Value; break;
+      case 'w' : Options->WriteDumpDir   = Value; break;
+      case 'c' : Options->CompareDumpDir = Value; break;
+
+      case 's' :
+       {
+        if (!ParseSeedList(Options->Seeds,Value))
+         {
+          fprintf(stderr,"error: invalid seed list (%s)\n",Value);
+
+          return(false);
+         }
+       } break;
+
+      case 'q' :
+      case 't' :
+       {
+        float                          FloatValue;
+
+        if ((sscanf(Value,"%f",&FloatValue) != 1) || (FloatValue <= 0.0f))
+         {
+          fprintf(stderr,"error: invalid value (%s) for option \"%s\"\n",Value,ArgStr);
+
+          return(false);
+         }
+
+        if (ArgStr[1] == 'q')
+         {
+          Options->QuantStep = FloatValue;
+         }
+        else
+         {
+          Options->Tolerance = FloatValue;
+         }
+       } break;
+     }
+   }
+
+  return(true);
+ }
+
+int                main               (int                 argc,
+                                       char               *argv[])
+ {
+  bool                                 Result;
+  NGPGoldenOptions                     Options;
+
+  Result = ParseArgs(&Options,argc,argv);
+
+  if (Result)
+   {
+    if (Options.ShowHelp)
+     {
+      ShowHelpMessage();
+     }
+    else
+     {
+      Result = RunChecks(&Options);
+     }
+   }
+
+  if (Result)
+   {
+    return(0);
+   }
+  else
+   {
+    return(1);
+   }
+ }
+
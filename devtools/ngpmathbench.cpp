@@ -0,0 +1,550 @@
+/***************************************************************************
+
+ Copyright (C) 2008  Sergey Prokhorchuk
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***************************************************************************/
+
+/* ngpcore math primitives microbenchmark */
+
+/* Each benchmark is calibrated so that one sample lasts at least a given */
+/* time, warmed up, and then sampled several times. Per-call time is      */
+/* reported as minimum, median, mean, standard deviation and 95%          */
+/* confidence interval of the mean, so that changes smaller than noise    */
+/* can be told apart. Alternative implementations (SIMD, approximations)  */
+/* are registered as separate variants of the same benchmark.             */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <vector>
+#include <algorithm>
+
+#ifdef _WIN32
+ #define WIN32_LEAN_AND_MEAN 1
+ #include <windows.h>
+#else
+ #include <sys/time.h>
+#endif
+
+#include <ngpcore/p3dmath.h>
+#include <ngpcore/p3dmathspline.h>
+
+#define MBENCH_DATA_SIZE        (1024) /* must be power of two */
+#define MBENCH_DATA_MASK        (MBENCH_DATA_SIZE - 1)
+
+#define MBENCH_DEF_SAMPLE_COUNT (21)
+#define MBENCH_DEF_SAMPLE_TIME  (0.01) /* seconds */
+
+/* Input data, generated once with fixed seed */
+
+static float       InQuat0[MBENCH_DATA_SIZE][4];
+static float       InQuat1[MBENCH_DATA_SIZE][4];
+static float       InVector[MBENCH_DATA_SIZE][3];
+static float       InMatrix[MBENCH_DATA_SIZE][16];
+static float       InScalar[MBENCH_DATA_SIZE]; /* in [0,1] range */
+static float       InAngle[MBENCH_DATA_SIZE];  /* in [-2PI,2PI] range */
+
+static P3DMathNaturalCubicSpline       InSpline;
+
+/* Results are stored to non-static arrays so that calls can't be */
+/* optimized away                                                  */
+
+float              OutQuat[MBENCH_DATA_SIZE][4];
+float              OutVector[MBENCH_DATA_SIZE][3];
+float              OutMatrix[MBENCH_DATA_SIZE][16];
+float              OutScalar[MBENCH_DATA_SIZE][2];
+
+static unsigned int RandState = 12345;
+
+static float       RandUnit           ()
+ {
+  RandState = RandState * 1103515245U + 12345U;
+
+  return((float)((RandState >> 8) & 0xFFFFFF) / (float)0x1000000);
+ }
+
+static float       RandRange          (float               Min,
+                                       float               Max)
+ {
+  return(Min + (Max - Min) * RandUnit());
+ }
+
+static void        RandQuaternion     (float              *q)
+ {
+  P3DQuaternionf                       Quat;
+
+  Quat.FromAxisAndAngle(RandRange(-1.0f,1.0f),
+                        RandRange(-1.0f,1.0f),
+                        RandRange(-1.0f,1.0f) + 2.0f, /* keep axis non-zero */
+                        RandRange(-P3DMATH_PI,P3DMATH_PI));
+
+  Quat.Normalize();
+
+  for (unsigned int i = 0; i < 4; i++)
+   {
+    q[i] = Quat.q[i];
+   }
+ }
+
+static void        InitData           ()
+ {
+  for (unsigned int Index = 0; Index < MBENCH_DATA_SIZE; Index++)
+   {
+    P3DQuaternionf                     Rotation;
+
+    RandQuaternion(InQuat0[Index]);
+    RandQuaternion(InQuat1[Index]);
+
+    for (unsigned int i = 0; i < 3; i++)
+     {
+      InVector[Index][i] = RandRange(-10.0f,10.0f);
+     }
+
+    Rotation.Set(InQuat0[Index]);
+    Rotation.ToMatrix(InMatrix[Index]);
+
+    InMatrix[Index][12] = RandRange(-10.0f,10.0f);
+    InMatrix[Index][13] = RandRange(-10.0f,10.0f);
+    InMatrix[Index][14] = RandRange(-10.0f,10.0f);
+
+    InScalar[Index] = RandUnit();
+    InAngle[Index]  = RandRange(-2.0f * P3DMATH_PI,2.0f * P3DMATH_PI);
+   }
+
+  /* typical profile curve as found in models */
+
+  InSpline.SetLinear(0.0f,1.0f,1.0f,0.2f);
+  InSpline.AddCP(0.25f,0.9f);
+  InSpline.AddCP(0.5f,0.4f);
+  InSpline.AddCP(0.75f,0.5f);
+ }
+
+/* Benchmark kernels, each one makes Count calls */
+
+static void        BenchQuatCrossProduct
+                                      (unsigned int        Count)
+ {
+  for (unsigned int Index = 0; Index < Count; Index++)
+   {
+    unsigned int                       i = Index & MBENCH_DATA_MASK;
+
+    P3DQuaternionf::CrossProduct(OutQuat[i],InQuat0[i],InQuat1[i]);
+   }
+ }
+
+static void        BenchQuatRotateVector
+                                      (unsigned int        Count)
+ {
+  for (unsigned int Index = 0; Index < Count; Index++)
+   {
+    unsigned int                       i = Index & MBENCH_DATA_MASK;
+
+    OutVector[i][0] = InVector[i][0];
+    OutVector[i][1] = InVector[i][1];
+    OutVector[i][2] = InVector[i][2];
+
+    P3DQuaternionf::RotateVector(OutVector[i],InQuat0[i]);
+   }
+ }
+
+static void        BenchQuatPower     (unsigned int        Count)
+ {
+  for (unsigned int Index = 0; Index < Count; Index++)
+   {
+    unsigned int                       i = Index & MBENCH_DATA_MASK;
+
+    OutQuat[i][0] = InQuat0[i][0];
+    OutQuat[i][1] = InQuat0[i][1];
+    OutQuat[i][2] = InQuat0[i][2];
+    OutQuat[i][3] = InQuat0[i][3];
+
+    P3DQuaternionf::Power(OutQuat[i],InScalar[i]);
+   }
+ }
+
+static void        BenchQuatSlerp     (unsigned int        Count)
+ {
+  for (unsigned int Index = 0; Index < Count; Index++)
+   {
+    unsigned int                       i = Index & MBENCH_DATA_MASK;
+
+    P3DQuaternionf::Slerp(OutQuat[i],InQuat0[i],InQuat1[i],InScalar[i]);
+   }
+ }
+
+static void        BenchQuatSlerp2    (unsigned int        Count)
+ {
+  for (unsigned int Index = 0; Index < Count; Index++)
+   {
+    unsigned int                       i = Index & MBENCH_DATA_MASK;
+
+    P3DQuaternionf::Slerp2(OutQuat[i],InQuat0[i],InQuat1[i],InScalar[i]);
+   }
+ }
+
+static void        BenchVectorMultMatrix
+                                      (unsigned int        Count)
+ {
+  for (unsigned int Index = 0; Index < Count; Index++)
+   {
+    unsigned int                       i = Index & MBENCH_DATA_MASK;
+
+    P3DVector3f::MultMatrix(OutVector[i],(const P3DMatrix4x4f*)InMatrix[i],InVector[i]);
+   }
+ }
+
+static void        BenchMatrixGetRotationOnly
+                                      (unsigned int        Count)
+ {
+  for (unsigned int Index = 0; Index < Count; Index++)
+   {
+    unsigned int                       i = Index & MBENCH_DATA_MASK;
+
+    P3DMatrix4x4f::GetRotationOnly(OutMatrix[i],InMatrix[i]);
+   }
+ }
+
+static void        BenchSinCosf       (unsigned int        Count)
+ {
+  for (unsigned int Index = 0; Index < Count; Index++)
+   {
+    unsigned int                       i = Index & MBENCH_DATA_MASK;
+
+    P3DMath::SinCosf(&OutScalar[i][0],&OutScalar[i][1],InAngle[i]);
+   }
+ }
+
+static void        BenchSplineGetValue(unsigned int        Count)
+ {
+  for (unsigned int Index = 0; Index < Count; Index++)
+   {
+    unsigned int                       i = Index & MBENCH_DATA_MASK;
+
+    OutScalar[i][0] = InSpline.GetValue(InScalar[i]);
+   }
+ }
+
+typedef void     (*MBenchFunc)        (unsigned int        Count);
+
+typedef struct
+ {
+  const char                          *Name;
+  const char                          *Variant;
+  MBenchFunc                           Func;
+ } MBenchInfo;
+
+static const MBenchInfo                Benchmarks[] =
+ {
+  { "quat_cross_product"    , "scalar", BenchQuatCrossProduct      },
+  { "quat_rotate_vector"    , "scalar", BenchQuatRotateVector      },
+  { "quat_power"            , "scalar", BenchQuatPower             },
+  { "quat_slerp"            , "scalar", BenchQuatSlerp             },
+  { "quat_slerp"            , "slerp2", BenchQuatSlerp2            },
+  { "vec3_mult_matrix"      , "scalar", BenchVectorMultMatrix      },
+  { "mat4_get_rotation_only", "scalar", BenchMatrixGetRotationOnly },
+  { "math_sincosf"          , "scalar", BenchSinCosf               },
+  { "spline_get_value"      , "scalar", BenchSplineGetValue        }
+ };
+
+#define MBENCH_COUNT (sizeof(Benchmarks) / sizeof(Benchmarks[0]))
+
+static double      GetWallTime        ()
+ {
+  #ifdef _WIN32
+  LARGE_INTEGER                        Frequency;
+  LARGE_INTEGER                        Counter;
+
+  QueryPerformanceFrequency(&Frequency);
+  QueryPerformanceCounter(&Counter);
+
+  return((double)Counter.QuadPart / (double)Frequency.QuadPart);
+  #else
+  struct timeval                       Time;
+
+  gettimeofday(&Time,NULL);
+
+  return((double)Time.tv_sec + (double)Time.tv_usec * 1.0e-6);
+  #endif
+ }
+
+static double      MeasureOnce        (MBenchFunc          Func,
+                                       unsigned int        Count)
+ {
+  double                               StartTime;
+
+  StartTime = GetWallTime();
+
+  Func(Count);
+
+  return(GetWallTime() - StartTime);
+ }
+
+typedef struct
+ {
+  unsigned int                         CallsPerSample;
+  double                               Min;    /* all times are ns per call */
+  double                               Median;
+  double                               Mean;
+  double                               StdDev;
+  double                               CI95;   /* half-width of interval */
+ } MBenchStats;
+
+static void        RunBenchmark       (MBenchStats        *Stats,
+                                       MBenchFunc          Func,
+                                       unsigned int        SampleCount,
+                                       double              SampleTime)
+ {
+  unsigned int                         Count;
+  std::vector<double>                  Samples(SampleCount);
+
+  /* calibrate: grow call count until sample is long enough */
+  /* for timer resolution not to matter                     */
+
+  Count = MBENCH_DATA_SIZE;
+
+  while ((MeasureOnce(Func,Count) < SampleTime) && (Count < 0x40000000U))
+   {
+    Count *= 2;
+   }
+
+  MeasureOnce(Func,Count); /* warm-up */
+
+  for (unsigned int Index = 0; Index < SampleCount; Index++)
+   {
+    Samples[Index] = MeasureOnce(Func,Count) * 1.0e9 / Count;
+   }
+
+  std::sort(Samples.begin(),Samples.end());
+
+  double                               Sum;
+  double                               SqSum;
+
+  Sum = 0.0;
+
+  for (unsigned int Index = 0; Index < SampleCount; Index++)
+   {
+    Sum += Samples[Index];
+   }
+
+  Stats->CallsPerSample = Count;
+  Stats->Min            = Samples[0];
+  Stats->Mean           = Sum / SampleCount;
+
+  if (SampleCount % 2 == 1)
+   {
+    Stats->Median = Samples[SampleCount / 2];
+   }
+  else
+   {
+    Stats->Median = (Samples[SampleCount / 2 - 1] + Samples[SampleCount / 2]) * 0.5;
+   }
+
+  SqSum = 0.0;
+
+  for (unsigned int Index = 0; Index < SampleCount; Index++)
+   {
+    SqSum += (Samples[Index] - Stats->Mean) * (Samples[Index] - Stats->Mean);
+   }
+
+  if (SampleCount > 1)
+   {
+    Stats->StdDev = sqrt(SqSum / (SampleCount - 1));
+    Stats->CI95   = 1.96 * Stats->StdDev / sqrt((double)SampleCount);
+   }
+  else
+   {
+    Stats->StdDev = 0.0;
+    Stats->CI95   = 0.0;
+   }
+ }
+
+static void        ShowHelpMessage    ()
+ {
+  printf("Usage: ngpmathbench [options]\n");
+  printf("Options:\n");
+  printf("  -h            Display this information\n");
+  printf("  -l            List benchmarks\n");
+  printf("  -b <name>     Run only benchmarks whose name contains <name>\n");
+  printf("  -n <count>    Number of samples (%u by default)\n",MBENCH_DEF_SAMPLE_COUNT);
+  printf("  -t <ms>       Minimal sample duration in milliseconds (%u by default)\n",
+         (unsigned int)(MBENCH_DEF_SAMPLE_TIME * 1000.0));
+  printf("  -j            Write results in JSON format\n");
+ }
+
+int                main               (int                 argc,
+                                       char               *argv[])
+ {
+  const char                          *Filter;
+  unsigned int                         SampleCount;
+  unsigned int                         SampleTimeMS;
+  bool                                 JSONOutput;
+  bool                                 ListOnly;
+
+  Filter       = 0;
+  SampleCount  = MBENCH_DEF_SAMPLE_COUNT;
+  SampleTimeMS = (unsigned int)(MBENCH_DEF_SAMPLE_TIME * 1000.0);
+  JSONOutput   = false;
+  ListOnly     = false;
+
+  for (int ArgIndex = 1; ArgIndex < argc; ArgIndex++)
+   {
+    const char                        *ArgStr = argv[ArgIndex];
+
+    if      (strcmp(ArgStr,"-h") == 0)
+     {
+      ShowHelpMessage();
+
+      return(0);
+     }
+    else if (strcmp(ArgStr,"-l") == 0)
+     {
+      ListOnly = true;
+     }
+    else if (strcmp(ArgStr,"-j") == 0)
+     {
+      JSONOutput = true;
+     }
+    else if ((strcmp(ArgStr,"-b") == 0) ||
+             (strcmp(ArgStr,"-n") == 0) ||
+             (strcmp(ArgStr,"-t") == 0))
+     {
+      const char                      *Value;
+
+      if (++ArgIndex >= argc)
+       {
+        fprintf(stderr,"error: option \"%s\" requires a value\n",ArgStr);
+
+        return(1);
+       }
+
+      Value = argv[ArgIndex];
+
+      if      (ArgStr[1] == 'b')
+       {
+        Filter = Value;
+       }
+      else if (ArgStr[1] == 'n')
+       {
+        if ((sscanf(Value,"%u",&SampleCount) != 1) || (SampleCount == 0))
+         {
+          fprintf(stderr,"error: invalid sample count (%s)\n",Value);
+
+          return(1);
+         }
+       }
+      else
+       {
+        if ((sscanf(Value,"%u",&SampleTimeMS) != 1) || (SampleTimeMS == 0))
+         {
+          fprintf(stderr,"error: invalid sample duration (%s)\n",Value);
+
+          return(1);
+         }
+       }
+     }
+    else
+     {
+      fprintf(stderr,"error: invalid option \"%s\"\n",ArgStr);
+
+      return(1);
+     }
+   }
+
+  if (ListOnly)
+   {
+    for (unsigned int Index = 0; Index < MBENCH_COUNT; Index++)
+     {
+      printf("%s (%s)\n",Benchmarks[Index].Name,Benchmarks[Index].Variant);
+     }
+
+    return(0);
+   }
+
+  InitData();
+
+  if (JSONOutput)
+   {
+    printf("{\n");
+    printf("  \"samples\": %u,\n",SampleCount);
+    printf("  \"sample_time_ms\": %u,\n",SampleTimeMS);
+    printf("  \"benchmarks\": [");
+   }
+  else
+   {
+    printf("%-24s %-8s %10s %10s %10s %10s %10s\n",
+           "benchmark","variant","min,ns","median,ns","mean,ns","stddev","ci95");
+   }
+
+  bool                                 First;
+
+  First = true;
+
+  for (unsigned int Index = 0; Index < MBENCH_COUNT; Index++)
+   {
+    MBenchStats                        Stats;
+    const MBenchInfo                  *Info;
+
+    Info = &Benchmarks[Index];
+
+    if ((Filter != 0) && (strstr(Info->Name,Filter) == 0))
+     {
+      continue;
+     }
+
+    RunBenchmark(&Stats,Info->Func,SampleCount,SampleTimeMS / 1000.0);
+
+    if (JSONOutput)
+     {
+      printf("%s\n    {\"name\": \"%s\", \"variant\": \"%s\", \"calls_per_sample\": %u, "
+             "\"min_ns\": %.4f, \"median_ns\": %.4f, \"mean_ns\": %.4f, "
+             "\"stddev_ns\": %.4f, \"ci95_ns\": %.4f}",
+             First ? "" : ",",
+             Info->Name,
+             Info->Variant,
+             Stats.CallsPerSample,
+             Stats.Min,
+             Stats.Median,
+             Stats.Mean,
+             Stats.StdDev,
+             Stats.CI95);
+     }
+    else
+     {
+      printf("%-24s %-8s %10.3f %10.3f %10.3f %10.3f %10.3f\n",
+             Info->Name,
+             Info->Variant,
+             Stats.Min,
+             Stats.Median,
+             Stats.Mean,
+             Stats.StdDev,
+             Stats.CI95);
+     }
+
+    First = false;
+   }
+
+  if (JSONOutput)
+   {
+    printf("\n  ]\n");
+    printf("}\n");
+   }
+
+  return(0);
+ }
+
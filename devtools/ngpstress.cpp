@@ -0,0 +1,776 @@
+/***************************************************************************
+
+ Copyright (C) 2008  Sergey Prokhorchuk
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***************************************************************************/
+
+/* Synthetic stress model generator */
+
+/* Builds plant model with tube trunk and <depth> levels of tube branches. */
+/* Every non-terminal branch group has <fanout> sub-branch groups (up to  */
+/* P3DBranchModelSubBranchMaxCount), every group spawns exactly <count>   */
+/* branches on each parent branch. Terminal branch groups carry quad      */
+/* leaves and grid GMesh branches. Model is saved as .ngp file, so it may */
+/* be used by ngpbench, ngpgolden and ngplant itself.                     */
+/*                                                                        */
+/* Resulting group, branch, vertex and triangle counts are printed. With  */
+/* -t option branch count per parent is chosen automatically to reach     */
+/* requested vertex count, which allows sweeps like 1k ... 10M vertices.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <vector>
+
+#include <ngpcore/p3dhli.h>
+#include <ngpcore/p3dmodel.h>
+#include <ngpcore/p3dmodelstemtube.h>
+#include <ngpcore/p3dmodelstemquad.h>
+#include <ngpcore/p3dmodelstemgmesh.h>
+#include <ngpcore/p3dbalgbase.h>
+#include <ngpcore/p3dbalgstd.h>
+#include <ngpcore/p3diostream.h>
+
+#define NGPSTRESS_MAX_DEPTH        (8)
+#define NGPSTRESS_MAX_BRANCH_COUNT (4096)
+#define NGPSTRESS_MAX_GRID_SIZE    (1024)
+#define NGPSTRESS_MAX_GROUP_COUNT  (100000)
+
+#define NGPSTRESS_TRUNK_LENGTH     (15.0f)
+#define NGPSTRESS_TRUNK_SCALE      (0.5f)
+#define NGPSTRESS_LENGTH_FACTOR    (0.6f)
+#define NGPSTRESS_SCALE_FACTOR     (0.5f)
+#define NGPSTRESS_GOLDEN_ANGLE     (2.39996323f) /* 137.5 degrees */
+
+typedef struct
+ {
+  unsigned int                         Depth;
+  unsigned int                         FanOut;
+  unsigned int                         BranchCount;
+  unsigned int                         AxisResolution;
+  unsigned int                         ProfileResolution;
+  unsigned int                         LeafCount;
+  unsigned int                         LeafSections;
+  unsigned int                         MeshCount;
+  unsigned int                         MeshGridSize;
+  unsigned int                         Seed;
+  double                               TargetVertices;
+  const char                          *OutputFileName;
+  bool                                 ShowHelp;
+ } NGPStressOptions;
+
+typedef struct
+ {
+  unsigned int                         GroupCount;
+  double                               BranchCount;
+  double                               VertexCount;
+  double                               TriangleCount;
+ } NGPStressStats;
+
+class NGPStressMaterial : public P3DMaterialInstance
+ {
+  public           :
+
+                   NGPStressMaterial  (const P3DMaterialDef
+                                                          &MaterialDef)
+                   : MatDef(MaterialDef)
+   {
+   }
+
+  virtual
+  const
+  P3DMaterialDef  *GetMaterialDef     () const
+   {
+    return(&MatDef);
+   }
+
+  virtual
+  P3DMaterialInstance
+                  *CreateCopy         () const
+   {
+    return(new NGPStressMaterial(MatDef));
+   }
+
+  private          :
+
+  P3DMaterialDef                       MatDef;
+ };
+
+class NGPStressMaterialSaver : public P3DMaterialSaver
+ {
+  public           :
+
+  virtual void     Save               (P3DOutputStringStream
+                                                          *TargetStream,
+                                       const P3DMaterialInstance
+                                                          *Material) const
+   {
+    Material->GetMaterialDef()->Save(TargetStream);
+   }
+ };
+
+/* Model construction */
+
+static P3DMaterialInstance
+                  *CreateMaterial     (float               R,
+                                       float               G,
+                                       float               B,
+                                       bool                DoubleSided)
+ {
+  P3DMaterialDef                       MaterialDef;
+
+  MaterialDef.SetColor(R,G,B);
+  MaterialDef.SetDoubleSided(DoubleSided);
+
+  return(new NGPStressMaterial(MaterialDef));
+ }
+
+static P3DBranchingAlgStd
+                  *CreateBranchingAlg (unsigned int        BranchCount,
+                                       float               MinOffset,
+                                       float               StartRevAngle)
+ {
+  P3DBranchingAlgStd                  *BranchingAlg;
+
+  /* zero density and equal min/max limits give exact branch count */
+
+  BranchingAlg = new P3DBranchingAlgStd();
+
+  BranchingAlg->SetDensity(0.0f);
+  BranchingAlg->SetMinNumber(BranchCount);
+  BranchingAlg->SetMaxLimitEnabled(true);
+  BranchingAlg->SetMaxNumber(BranchCount);
+  BranchingAlg->SetMinOffset(MinOffset);
+  BranchingAlg->SetMaxOffset(0.95f);
+  BranchingAlg->SetStartRevAngle(StartRevAngle);
+  BranchingAlg->SetRevAngle(NGPSTRESS_GOLDEN_ANGLE);
+
+  return(BranchingAlg);
+ }
+
+static P3DStemModelTube
+                  *CreateTubeStem     (const NGPStressOptions
+                                                          *Options,
+                                       unsigned int        Level)
+ {
+  P3DStemModelTube                    *StemModel;
+  P3DMathNaturalCubicSpline            ScaleCurve;
+
+  StemModel = new P3DStemModelTube();
+
+  StemModel->SetLength(NGPSTRESS_TRUNK_LENGTH * powf(NGPSTRESS_LENGTH_FACTOR,(float)Level));
+  StemModel->SetProfileScaleBase(NGPSTRESS_TRUNK_SCALE * powf(NGPSTRESS_SCALE_FACTOR,(float)Level));
+  StemModel->SetAxisResolution(Options->AxisResolution);
+  StemModel->SetProfileResolution(Options->ProfileResolution);
+
+  ScaleCurve.SetLinear(0.0f,1.0f,1.0f,0.1f);
+
+  StemModel->SetProfileScaleCurve(&ScaleCurve);
+
+  return(StemModel);
+ }
+
+static P3DGMeshData
+                  *CreateGridMeshData (unsigned int        GridSize)
+ {
+  P3DGMeshData                        *MeshData;
+  unsigned int                         VAttrCount[P3D_GMESH_MAX_ATTRS];
+  unsigned int                         RowSize;
+  unsigned int                         VertexCount;
+  unsigned int                         QuadCount;
+
+  /* GridSize x GridSize quads in XY plane, flat normal, tangent and */
+  /* binormal are shared by all vertices in per-attribute mode       */
+
+  RowSize     = GridSize + 1;
+  VertexCount = RowSize * RowSize;
+  QuadCount   = GridSize * GridSize;
+
+  VAttrCount[P3D_ATTR_VERTEX]    = VertexCount;
+  VAttrCount[P3D_ATTR_NORMAL]    = 1;
+  VAttrCount[P3D_ATTR_TEXCOORD0] = VertexCount;
+  VAttrCount[P3D_ATTR_TANGENT]   = 1;
+  VAttrCount[P3D_ATTR_BINORMAL]  = 1;
+
+  MeshData = new P3DGMeshData(VAttrCount,QuadCount,QuadCount * 4,VertexCount,QuadCount * 6);
+
+  float                               *Vertices  = MeshData->GetVAttrBuffer(P3D_ATTR_VERTEX);
+  float                               *TexCoords = MeshData->GetVAttrBuffer(P3D_ATTR_TEXCOORD0);
+  float                               *VerticesI[P3D_GMESH_MAX_ATTRS];
+
+  for (unsigned int Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    VerticesI[Attr] = MeshData->GetVAttrBufferI(Attr);
+   }
+
+  for (unsigned int Row = 0; Row < RowSize; Row++)
+   {
+    for (unsigned int Column = 0; Column < RowSize; Column++)
+     {
+      float                            U,V;
+
+      U = (float)Column / GridSize;
+      V = (float)Row    / GridSize;
+
+      *Vertices++  = U - 0.5f;
+      *Vertices++  = V;
+      *Vertices++  = 0.0f;
+      *TexCoords++ = U;
+      *TexCoords++ = V;
+
+      *VerticesI[P3D_ATTR_VERTEX]++    = U - 0.5f;
+      *VerticesI[P3D_ATTR_VERTEX]++    = V;
+      *VerticesI[P3D_ATTR_VERTEX]++    = 0.0f;
+      *VerticesI[P3D_ATTR_NORMAL]++    = 0.0f;
+      *VerticesI[P3D_ATTR_NORMAL]++    = 0.0f;
+      *VerticesI[P3D_ATTR_NORMAL]++    = 1.0f;
+      *VerticesI[P3D_ATTR_TEXCOORD0]++ = U;
+      *VerticesI[P3D_ATTR_TEXCOORD0]++ = V;
+      *VerticesI[P3D_ATTR_TANGENT]++   = 1.0f;
+      *VerticesI[P3D_ATTR_TANGENT]++   = 0.0f;
+      *VerticesI[P3D_ATTR_TANGENT]++   = 0.0f;
+      *VerticesI[P3D_ATTR_BINORMAL]++  = 0.0f;
+      *VerticesI[P3D_ATTR_BINORMAL]++  = 1.0f;
+      *VerticesI[P3D_ATTR_BINORMAL]++  = 0.0f;
+     }
+   }
+
+  float                               *Normals   = MeshData->GetVAttrBuffer(P3D_ATTR_NORMAL);
+  float                               *Tangents  = MeshData->GetVAttrBuffer(P3D_ATTR_TANGENT);
+  float                               *Binormals = MeshData->GetVAttrBuffer(P3D_ATTR_BINORMAL);
+
+  Normals[0]   = 0.0f; Normals[1]   = 0.0f; Normals[2]   = 1.0f;
+  Tangents[0]  = 1.0f; Tangents[1]  = 0.0f; Tangents[2]  = 0.0f;
+  Binormals[0] = 0.0f; Binormals[1] = 1.0f; Binormals[2] = 0.0f;
+
+  unsigned int                        *Primitives = MeshData->GetPrimitiveBuffer();
+  unsigned int                        *Indices[P3D_GMESH_MAX_ATTRS];
+  unsigned int                        *IndicesI   = MeshData->GetIndexBufferI();
+
+  for (unsigned int Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    Indices[Attr] = MeshData->GetIndexBuffer(Attr);
+   }
+
+  for (unsigned int Row = 0; Row < GridSize; Row++)
+   {
+    for (unsigned int Column = 0; Column < GridSize; Column++)
+     {
+      unsigned int                     Corners[4];
+
+      Corners[0] = Row * RowSize + Column;
+      Corners[1] = Corners[0] + 1;
+      Corners[2] = Corners[1] + RowSize;
+      Corners[3] = Corners[0] + RowSize;
+
+      *Primitives++ = P3D_QUAD;
+
+      for (unsigned int Corner = 0; Corner < 4; Corner++)
+       {
+        *Indices[P3D_ATTR_VERTEX]++    = Corners[Corner];
+        *Indices[P3D_ATTR_NORMAL]++    = 0;
+        *Indices[P3D_ATTR_TEXCOORD0]++ = Corners[Corner];
+        *Indices[P3D_ATTR_TANGENT]++   = 0;
+        *Indices[P3D_ATTR_BINORMAL]++  = 0;
+       }
+
+      *IndicesI++ = Corners[0];
+      *IndicesI++ = Corners[1];
+      *IndicesI++ = Corners[2];
+      *IndicesI++ = Corners[0];
+      *IndicesI++ = Corners[2];
+      *IndicesI++ = Corners[3];
+     }
+   }
+
+  return(MeshData);
+ }
+
+static void        AppendTerminalGroups
+                                      (P3DBranchModel     *ParentModel,
+                                       const NGPStressOptions
+                                                          *Options)
+ {
+  char                                 Name[256];
+
+  if (Options->LeafCount > 0)
+   {
+    P3DBranchModel                    *LeafModel;
+    P3DStemModelQuad                  *LeafStem;
+
+    LeafModel = new P3DBranchModel();
+    LeafStem  = new P3DStemModelQuad();
+
+    LeafStem->SetLength(1.0f);
+    LeafStem->SetWidth(0.5f);
+    LeafStem->SetSectionCount(Options->LeafSections);
+
+    sprintf(Name,"%s-leaves",ParentModel->GetName());
+
+    LeafModel->SetName(Name);
+    LeafModel->SetStemModel(LeafStem);
+    LeafModel->SetBranchingAlg(CreateBranchingAlg(Options->LeafCount,0.3f,0.0f));
+    LeafModel->SetMaterialInstance(CreateMaterial(0.2f,0.6f,0.1f,true));
+
+    ParentModel->AppendSubBranch(LeafModel);
+   }
+
+  if (Options->MeshCount > 0)
+   {
+    P3DBranchModel                    *MeshModel;
+    P3DStemModelGMesh                 *MeshStem;
+
+    MeshModel = new P3DBranchModel();
+    MeshStem  = new P3DStemModelGMesh();
+
+    MeshStem->SetMeshData(CreateGridMeshData(Options->MeshGridSize));
+
+    sprintf(Name,"%s-meshes",ParentModel->GetName());
+
+    MeshModel->SetName(Name);
+    MeshModel->SetStemModel(MeshStem);
+    MeshModel->SetBranchingAlg(CreateBranchingAlg(Options->MeshCount,0.5f,P3DMATH_PI));
+    MeshModel->SetMaterialInstance(CreateMaterial(0.8f,0.3f,0.3f,true));
+
+    ParentModel->AppendSubBranch(MeshModel);
+   }
+ }
+
+static void        AppendBranchGroups (P3DBranchModel     *ParentModel,
+                                       const NGPStressOptions
+                                                          *Options,
+                                       unsigned int        Level)
+ {
+  if (Level > Options->Depth)
+   {
+    AppendTerminalGroups(ParentModel,Options);
+
+    return;
+   }
+
+  for (unsigned int Index = 0; Index < Options->FanOut; Index++)
+   {
+    P3DBranchModel                    *BranchModel;
+    char                               Name[256];
+
+    BranchModel = new P3DBranchModel();
+
+    sprintf(Name,"%s-%u",ParentModel->GetName(),Index + 1);
+
+    BranchModel->SetName(Name);
+    BranchModel->SetStemModel(CreateTubeStem(Options,Level));
+    BranchModel->SetBranchingAlg
+     (CreateBranchingAlg(Options->BranchCount,0.2f,
+                         2.0f * P3DMATH_PI * Index / Options->FanOut));
+    BranchModel->SetMaterialInstance(CreateMaterial(0.5f,0.4f,0.3f,false));
+
+    ParentModel->AppendSubBranch(BranchModel);
+
+    AppendBranchGroups(BranchModel,Options,Level + 1);
+   }
+ }
+
+static P3DPlantModel
+                  *CreateStressModel  (const NGPStressOptions
+                                                          *Options)
+ {
+  P3DPlantModel                       *PlantModel;
+  P3DBranchModel                      *TrunkModel;
+
+  PlantModel = new P3DPlantModel();
+
+  PlantModel->SetBaseSeed(Options->Seed);
+  PlantModel->GetPlantBase()->SetName("Plant");
+
+  TrunkModel = new P3DBranchModel();
+
+  TrunkModel->SetName("Branch");
+  TrunkModel->SetStemModel(CreateTubeStem(Options,0));
+  TrunkModel->SetBranchingAlg(new P3DBranchingAlgBase());
+  TrunkModel->SetMaterialInstance(CreateMaterial(0.5f,0.4f,0.3f,false));
+
+  PlantModel->GetPlantBase()->AppendSubBranch(TrunkModel);
+
+  AppendBranchGroups(TrunkModel,Options,1);
+
+  return(PlantModel);
+ }
+
+/* Statistics */
+
+static void        CalcStats          (NGPStressStats     *Stats,
+                                       const P3DPlantModel*PlantModel)
+ {
+  P3DHLIPlantTemplate                  PlantTemplate(PlantModel);
+  P3DHLIPlantInstance                 *PlantInstance;
+  std::vector<unsigned int>            BranchCounts;
+
+  Stats->GroupCount    = PlantTemplate.GetGroupCount();
+  Stats->BranchCount   = 0.0;
+  Stats->VertexCount   = 0.0;
+  Stats->TriangleCount = 0.0;
+
+  PlantInstance = PlantTemplate.CreateInstance(PlantModel->GetBaseSeed());
+
+  BranchCounts.resize(Stats->GroupCount);
+
+  PlantInstance->GetBranchCountMulti(&BranchCounts[0]);
+
+  for (unsigned int GroupIndex = 0; GroupIndex < Stats->GroupCount; GroupIndex++)
+   {
+    double                             BranchCount;
+
+    BranchCount = BranchCounts[GroupIndex];
+
+    Stats->BranchCount   += BranchCount;
+    Stats->VertexCount   += BranchCount * PlantTemplate.GetVAttrCountI(GroupIndex);
+    Stats->TriangleCount += BranchCount * (PlantTemplate.GetIndexCount(GroupIndex,P3D_TRIANGLE) / 3);
+   }
+
+  delete PlantInstance;
+ }
+
+static bool        FitBranchCount     (NGPStressOptions   *Options)
+ {
+  unsigned int                         Lower;
+  unsigned int                         Upper;
+  NGPStressStats                       Stats;
+
+  /* vertex count grows monotonically with branch count, so find     */
+  /* upper bound by doubling and then bisect down to smallest count  */
+
+  Lower = 0;
+  Upper = 1;
+
+  while (true)
+   {
+    P3DPlantModel                     *PlantModel;
+
+    Options->BranchCount = Upper;
+
+    PlantModel = CreateStressModel(Options);
+
+    CalcStats(&Stats,PlantModel);
+
+    delete PlantModel;
+
+    if (Stats.VertexCount >= Options->TargetVertices)
+     {
+      break;
+     }
+
+    if (Upper >= NGPSTRESS_MAX_BRANCH_COUNT)
+     {
+      fprintf(stderr,"error: target vertex count is not reachable with other options\n");
+
+      return(false);
+     }
+
+    Lower = Upper;
+    Upper = Upper * 2 < NGPSTRESS_MAX_BRANCH_COUNT ? Upper * 2 : NGPSTRESS_MAX_BRANCH_COUNT;
+   }
+
+  while (Upper - Lower > 1)
+   {
+    unsigned int                       Middle;
+    P3DPlantModel                     *PlantModel;
+
+    Middle = (Lower + Upper) / 2;
+
+    Options->BranchCount = Middle;
+
+    PlantModel = CreateStressModel(Options);
+
+    CalcStats(&Stats,PlantModel);
+
+    delete PlantModel;
+
+    if (Stats.VertexCount >= Options->TargetVertices)
+     {
+      Upper = Middle;
+     }
+    else
+     {
+      Lower = Middle;
+     }
+   }
+
+  Options->BranchCount = Upper;
+
+  return(true);
+ }
+
+static bool        RunGenerator       (NGPStressOptions   *Options)
+ {
+  bool                                 Result;
+  P3DPlantModel                       *PlantModel;
+  NGPStressStats                       Stats;
+
+  Result     = true;
+  PlantModel = 0;
+
+  try
+   {
+    if (Options->TargetVertices > 0.0)
+     {
+      if (!FitBranchCount(Options))
+       {
+        return(false);
+       }
+     }
+
+    PlantModel = CreateStressModel(Options);
+
+    if (Options->OutputFileName != 0)
+     {
+      P3DOutputStringStreamFile        TargetStream;
+      NGPStressMaterialSaver           MaterialSaver;
+
+      TargetStream.Open(Options->OutputFileName);
+
+      PlantModel->Save(&TargetStream,&MaterialSaver);
+
+      TargetStream.Close();
+     }
+
+    CalcStats(&Stats,PlantModel);
+
+    printf("depth          : %u\n",Options->Depth);
+    printf("fanout         : %u\n",Options->FanOut);
+    printf("branches/parent: %u\n",Options->BranchCount);
+    printf("groups         : %u\n",Stats.GroupCount);
+    printf("branches       : %.0f\n",Stats.BranchCount);
+    printf("vertices       : %.0f\n",Stats.VertexCount);
+    printf("triangles      : %.0f\n",Stats.TriangleCount);
+   }
+  catch (const P3DException &Exception)
+   {
+    fprintf(stderr,"error: %s\n",Exception.GetMessage());
+
+    Result = false;
+   }
+  catch (...)
+   {
+    fprintf(stderr,"error: unable to create model (out of memory?)\n");
+
+    Result = false;
+   }
+
+  delete PlantModel;
+
+  return(Result);
+ }
+
+/* Options and main loop */
+
+static void        ShowHelpMessage    ()
+ {
+  printf("Usage: ngpstress [options]\n");
+  printf("Options:\n");
+  printf("  -h            Display this information\n");
+  printf("  -o <file>     Save generated model to <file>\n");
+  printf("  -d <depth>    Levels of branches below trunk, 0..%u (2 by default)\n",NGPSTRESS_MAX_DEPTH);
+  printf("  -f <count>    Sub-branch groups per branch group, 1..%u (2 by default)\n",P3DBranchModelSubBranchMaxCount);
+  printf("  -n <count>    Branches per parent branch in every group (4 by default)\n");
+  printf("  -t <count>    Choose branches per parent to reach <count> vertices\n");
+  printf("  -a <res>      Tube axis resolution (8 by default)\n");
+  printf("  -p <res>      Tube profile resolution (8 by default)\n");
+  printf("  -l <count>    Leaves per terminal branch, 0 disables (8 by default)\n");
+  printf("  -q <count>    Sections per leaf (1 by default)\n");
+  printf("  -m <count>    GMesh branches per terminal branch, 0 disables (0 by default)\n");
+  printf("  -g <size>     GMesh grid size in quads per side (4 by default)\n");
+  printf("  -s <seed>     Model base seed (123 by default)\n");
+ }
+
+static bool        ParseArgs          (NGPStressOptions   *Options,
+                                       unsigned int        ArgCount,
+                                       char               *ArgValues[])
+ {
+  unsigned int                         ArgIndex;
+
+  Options->Depth             = 2;
+  Options->FanOut            = 2;
+  Options->BranchCount       = 4;
+  Options->AxisResolution    = 8;
+  Options->ProfileResolution = 8;
+  Options->LeafCount         = 8;
+  Options->LeafSections      = 1;
+  Options->MeshCount         = 0;
+  Options->MeshGridSize      = 4;
+  Options->Seed              = 123;
+  Options->TargetVertices    = 0.0;
+  Options->OutputFileName    = 0;
+  Options->ShowHelp          = false;
+
+  for (ArgIndex = 1; ArgIndex < ArgCount; ArgIndex++)
+   {
+    const char                        *ArgStr = ArgValues[ArgIndex];
+    const char                        *Value  = 0;
+    unsigned int                       IntValue;
+    unsigned int                       MinValue;
+    unsigned int                       MaxValue;
+
+    if (strcmp(ArgStr,"-h") == 0)
+     {
+      Options->ShowHelp = true;
+
+      continue;
+     }
+
+    if ((strlen(ArgStr) != 2) || (ArgStr[0] != '-') ||
+        (strchr("odfntaplqmgs",ArgStr[1]) == 0))
+     {
+      fprintf(stderr,"error: invalid option \"%s\"\n",ArgStr);
+
+      return(false);
+     }
+
+    if (++ArgIndex >= ArgCount)
+     {
+      fprintf(stderr,"error: option \"%s\" requires a value\n",ArgStr);
+
+      return(false);
+     }
+
+    Value = ArgValues[ArgIndex];
+
+    if (ArgStr[1] == 'o')
+     {
+      Options->OutputFileName = Value;
+
+      continue;
+     }
+
+    if (ArgStr[1] == 't')
+     {
+      double                           DoubleValue;
+
+      if ((sscanf(Value,"%lf",&DoubleValue) != 1) || (DoubleValue < 1.0))
+       {
+        fprintf(stderr,"error: invalid value (%s) for option \"%s\"\n",Value,ArgStr);
+
+        return(false);
+       }
+
+      Options->TargetVertices = DoubleValue;
+
+      continue;
+     }
+
+    switch (ArgStr[1])
+     {
+      case 'd' : MinValue = 0; MaxValue = NGPSTRESS_MAX_DEPTH;             break;
+      case 'f' : MinValue = 1; MaxValue = P3DBranchModelSubBranchMaxCount; break;
+      case 'n' : MinValue = 1; MaxValue = NGPSTRESS_MAX_BRANCH_COUNT;      break;
+      case 'a' : MinValue = 1; MaxValue = 1024;                            break;
+      case 'p' : MinValue = 3; MaxValue = 1024;                            break;
+      case 'l' : MinValue = 0; MaxValue = NGPSTRESS_MAX_BRANCH_COUNT;      break;
+      case 'q' : MinValue = 1; MaxValue = 1024;                            break;
+      case 'm' : MinValue = 0; MaxValue = NGPSTRESS_MAX_BRANCH_COUNT;      break;
+      case 'g' : MinValue = 1; MaxValue = NGPSTRESS_MAX_GRID_SIZE;         break;
+      default  : MinValue = 0; MaxValue = 0xFFFFFFFFU;                     break;
+     }
+
+    if ((sscanf(Value,"%u",&IntValue) != 1) ||
+        (IntValue < MinValue) || (IntValue > MaxValue))
+     {
+      fprintf(stderr,"error: invalid value (%s) for option \"%s\"\n",Value,ArgStr);
+
+      return(false);
+     }
+
+    switch (ArgStr[1])
+     {
+      case 'd' : Options->Depth             = IntValue; break;
+      case 'f' : Options->FanOut            = IntValue; break;
+      case 'n' : Options->BranchCount       = IntValue; break;
+      case 'a' : Options->AxisResolution    = IntValue; break;
+      case 'p' : Options->ProfileResolution = IntValue; break;
+      case 'l' : Options->LeafCount         = IntValue; break;
+      case 'q' : Options->LeafSections      = IntValue; break;
+      case 'm' : Options->MeshCount         = IntValue; break;
+      case 'g' : Options->MeshGridSize      = IntValue; break;
+      case 's' : Options->Seed              = IntValue; break;
+     }
+   }
+
+  /* group count grows as fanout^depth, limit it before building anything */
+
+  double                               LevelGroupCount;
+  double                               GroupCount;
+
+  LevelGroupCount = 1.0;
+  GroupCount      = 1.0;
+
+  for (unsigned int Level = 1; Level <= Options->Depth; Level++)
+   {
+    LevelGroupCount *= Options->FanOut;
+    GroupCount      += LevelGroupCount;
+   }
+
+  GroupCount += LevelGroupCount * ((Options->LeafCount > 0 ? 1 : 0) +
+                                   (Options->MeshCount > 0 ? 1 : 0));
+
+  if (GroupCount > NGPSTRESS_MAX_GROUP_COUNT)
+   {
+    fprintf(stderr,"error: too many branch groups (%.0f), reduce depth or fanout\n",GroupCount);
+
+    return(false);
+   }
+
+  if ((Options->TargetVertices > 0.0) && (Options->Depth == 0))
+   {
+    fprintf(stderr,"error: target vertex count requires non-zero depth\n");
+
+    return(false);
+   }
+
+  return(true);
+ }
+
+int                main               (int                 argc,
+                                       char               *argv[])
+ {
+  bool                                 Result;
+  NGPStressOptions                     Options;
+
+  Result = ParseArgs(&Options,argc,argv);
+
+  if (Result)
+   {
+    if (Options.ShowHelp)
+     {
+      ShowHelpMessage();
+     }
+    else
+     {
+      Result = RunGenerator(&Options);
+     }
+   }
+
+  if (Result)
+   {
+    return(0);
+   }
+  else
+   {
+    return(1);
+   }
+ }
+
@@ -0,0 +1,599 @@
+/***************************************************************************
+
+ Copyright (C) 2008  Sergey Prokhorchuk
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***************************************************************************/
+
+/* zipstore CRC32 benchmark utility */
+
+/* With zlib (WITH_ZLIB) deflated entry is also written to archive in   */
+/* memory and read back in chunks of different sizes to check inflate.  */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#if defined(WITH_ZLIB)
+ #include <zlib.h>
+#endif
+
+#include <zipstore/zipstore.h>
+
+#define ZSBENCH_BUFFER_SIZE  (4 * 1024 * 1024)
+#define ZSBENCH_CRC_POLY     (0xEDB88320U)
+#define ZSBENCH_ENTRY_SIZE   (3000000)
+#define ZSBENCH_PLAIN_ENTRY_SIZE (1000000)
+
+#define ZSBENCH_ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+/* byte-at-a-time CRC32, used as a reference for correctness and speed */
+
+static unsigned int RefCRC32Table[256];
+
+static void        RefCRC32Init       ()
+ {
+  for (unsigned int Index = 0; Index < 256; Index++)
+   {
+    unsigned int                       Value;
+
+    Value = Index;
+
+    for (unsigned int Bit = 0; Bit < 8; Bit++)
+     {
+      Value = (Value & 1) ? (Value >> 1) ^ ZSBENCH_CRC_POLY : Value >> 1;
+     }
+
+    RefCRC32Table[Index] = Value;
+   }
+ }
+
+static unsigned int RefCRC32          (const unsigned char*Data,
+                                       size_t              Size)
+ {
+  unsigned int                         CRC;
+
+  CRC = 0xFFFFFFFFU;
+
+  for (size_t Index = 0; Index < Size; Index++)
+   {
+    CRC = RefCRC32Table[(CRC ^ Data[Index]) & 0xFF] ^ (CRC >> 8);
+   }
+
+  return(CRC ^ 0xFFFFFFFFU);
+ }
+
+static unsigned int ZSCRC32           (const unsigned char*Data,
+                                       size_t              Size)
+ {
+  ZS::CRC32                            CRC;
+
+  CRC.Update(Data,Size);
+
+  return(CRC.GetCRC32());
+ }
+
+static bool        CheckCRC32         (const unsigned char*Data,
+                                       size_t              Size)
+ {
+  /* odd sizes and offsets exercise unaligned heads and tails */
+
+  for (size_t Offset = 0; Offset < 8; Offset++)
+   {
+    for (size_t Length = 0; Length < 200; Length++)
+     {
+      if (ZSCRC32(&Data[Offset],Length) != RefCRC32(&Data[Offset],Length))
+       {
+        fprintf(stderr,"error: CRC32 mismatch (offset %u, size %u)\n",
+                (unsigned int)Offset,(unsigned int)Length);
+
+        return(false);
+       }
+     }
+   }
+
+  unsigned int                         Whole;
+
+  Whole = RefCRC32(Data,Size);
+
+  for (size_t Split = 0; Split <= Size; Split += Size / 7 + 1)
+   {
+    unsigned int                       Combined;
+
+    Combined = ZS::CRC32::Combine(ZSCRC32(Data,Split),
+                                  ZSCRC32(&Data[Split],Size - Split),
+                                  Size - Split);
+
+    if (Combined != Whole)
+     {
+      fprintf(stderr,"error: CRC32 combine mismatch (split at %u)\n",
+              (unsigned int)Split);
+
+      return(false);
+     }
+   }
+
+  return(true);
+ }
+
+#if defined(WITH_ZLIB)
+/* Memory-backed streams. InStream does not provide GetData, so reader */
+/* inflates entry from its own input buffer like for file streams.    */
+
+class ZSBenchOutStream : public ZS::OutStream
+ {
+  public           :
+
+                   ZSBenchOutStream   (std::vector<unsigned char>
+                                                          &Buffer)
+                   : Buffer(Buffer),Pos(0)
+   {
+   }
+
+  virtual void     Write              (const void         *Data,
+                                       size_t              Size)
+   {
+    if (Pos + Size > Buffer.size())
+     {
+      Buffer.resize(Pos + Size);
+     }
+
+    memcpy(&Buffer[Pos],Data,Size);
+
+    Pos += Size;
+   }
+
+  virtual unsigned long      GetPos   () const
+   {
+    return(Pos);
+   }
+
+  virtual void               Seek     (unsigned long       Pos)
+   {
+    this->Pos = Pos;
+   }
+
+  private          :
+
+  std::vector<unsigned char>          &Buffer;
+  size_t                               Pos;
+ };
+
+class ZSBenchInStream : public ZS::InStream
+ {
+  public           :
+
+                   ZSBenchInStream    (const std::vector<unsigned char>
+                                                          &Buffer)
+                   : Buffer(Buffer),Pos(0)
+   {
+   }
+
+  virtual void     Read               (void               *Dest,
+                                       size_t              Size)
+   {
+    if (Pos + Size > Buffer.size())
+     {
+      throw ZS::Error(ZS::Error::NO_MORE_DATA);
+     }
+
+    memcpy(Dest,&Buffer[Pos],Size);
+
+    Pos += Size;
+   }
+
+  virtual unsigned long      GetSize  () const
+   {
+    return(Buffer.size());
+   }
+
+  virtual unsigned long      GetPos   () const
+   {
+    return(Pos);
+   }
+
+  virtual void               Seek     (unsigned long       Pos)
+   {
+    this->Pos = Pos;
+   }
+
+  private          :
+
+  const std::vector<unsigned char>    &Buffer;
+  size_t                               Pos;
+ };
+
+static void        PutWord            (std::vector<unsigned char>
+                                                          &Buffer,
+                                       unsigned int        Value)
+ {
+  Buffer.push_back((unsigned char)(Value & 0xFF));
+  Buffer.push_back((unsigned char)((Value >> 8) & 0xFF));
+ }
+
+static void        PutLongWord        (std::vector<unsigned char>
+                                                          &Buffer,
+                                       unsigned int        Value)
+ {
+  PutWord(Buffer,Value & 0xFFFF);
+  PutWord(Buffer,Value >> 16);
+ }
+
+/* Single entry archive with entry deflated as one zlib stream, as other */
+/* zip tools write it. Unlike ZS::Writer output (sync flush followed by  */
+/* empty final block) stream ends right after last match, so inflater   */
+/* still holds pending output when all input is consumed.                */
+
+static bool        MakePlainArchive   (std::vector<unsigned char>
+                                                          &Archive,
+                                       const unsigned char*Data,
+                                       size_t              Size)
+ {
+  static const char                    Name[] = "entry.bin";
+  std::vector<unsigned char>           Deflated(compressBound(Size));
+  z_stream                             Stream;
+  size_t                               DeflatedSize;
+  unsigned int                         CRC;
+  size_t                               CentralDirOffset;
+
+  CentralDirOffset = 0;
+
+  memset(&Stream,0,sizeof(Stream));
+
+  if (deflateInit2(&Stream,Z_DEFAULT_COMPRESSION,Z_DEFLATED,-MAX_WBITS,8,Z_DEFAULT_STRATEGY) != Z_OK)
+   {
+    return(false);
+   }
+
+  Stream.next_in   = (Bytef*)Data;
+  Stream.avail_in  = Size;
+  Stream.next_out  = &Deflated[0];
+  Stream.avail_out = Deflated.size();
+
+  int Result = deflate(&Stream,Z_FINISH);
+
+  DeflatedSize = Stream.total_out;
+
+  deflateEnd(&Stream);
+
+  if (Result != Z_STREAM_END)
+   {
+    return(false);
+   }
+
+  CRC = RefCRC32(Data,Size);
+
+  Archive.clear();
+
+  for (unsigned int Pass = 0; Pass < 2; Pass++)
+   {
+    /* local file header, then central directory header */
+
+    if (Pass == 0)
+     {
+      PutLongWord(Archive,0x04034B50);
+     }
+    else
+     {
+      CentralDirOffset = Archive.size();
+
+      PutLongWord(Archive,0x02014B50);
+      PutWord(Archive,20);
+     }
+
+    PutWord(Archive,20);
+    PutWord(Archive,0);
+    PutWord(Archive,8);
+    PutWord(Archive,0);
+    PutWord(Archive,0x21);
+    PutLongWord(Archive,CRC);
+    PutLongWord(Archive,DeflatedSize);
+    PutLongWord(Archive,Size);
+    PutWord(Archive,sizeof(Name) - 1);
+    PutWord(Archive,0);
+
+    if (Pass == 1)
+     {
+      PutWord(Archive,0);
+      PutWord(Archive,0);
+      PutWord(Archive,0);
+      PutLongWord(Archive,0);
+      PutLongWord(Archive,0);
+     }
+
+    Archive.insert(Archive.end(),Name,Name + sizeof(Name) - 1);
+
+    if (Pass == 0)
+     {
+      Archive.insert(Archive.end(),&Deflated[0],&Deflated[0] + DeflatedSize);
+     }
+   }
+
+  /* end of central directory record */
+
+  PutLongWord(Archive,0x06054B50);
+  PutWord(Archive,0);
+  PutWord(Archive,0);
+  PutWord(Archive,1);
+  PutWord(Archive,1);
+  PutLongWord(Archive,Archive.size() - CentralDirOffset - 12);
+  PutLongWord(Archive,CentralDirOffset);
+  PutWord(Archive,0);
+
+  return(true);
+ }
+
+static bool        CheckChunkedRead   (const std::vector<unsigned char>
+                                                          &Archive,
+                                       const char         *ArchiveName,
+                                       const unsigned char*Data,
+                                       size_t              Size,
+                                       size_t              ChunkSize)
+ {
+  std::vector<unsigned char>           Chunk(ChunkSize);
+  size_t                               Offset;
+
+  Offset = 0;
+
+  try
+   {
+    ZSBenchInStream                    InStream(Archive);
+    ZS::Reader                         Reader(InStream);
+    ZS::Reader::File                   Entry(Reader.GetFile());
+
+    while (Offset < Size)
+     {
+      size_t                           ReadSize;
+
+      ReadSize = Size - Offset < ChunkSize ? Size - Offset : ChunkSize;
+
+      Entry.Read(&Chunk[0],ReadSize);
+
+      if (memcmp(&Chunk[0],&Data[Offset],ReadSize) != 0)
+       {
+        fprintf(stderr,"error: %s archive: inflated data mismatch (chunk size %u, offset %u)\n",
+                ArchiveName,(unsigned int)ChunkSize,(unsigned int)Offset);
+
+        return(false);
+       }
+
+      Offset += ReadSize;
+     }
+   }
+  catch (const ZS::Error &Error)
+   {
+    fprintf(stderr,"error: %s archive: %s (chunk size %u, offset %u)\n",
+            ArchiveName,Error.GetMessage(),(unsigned int)ChunkSize,(unsigned int)Offset);
+
+    return(false);
+   }
+
+  return(true);
+ }
+
+static bool        CheckRoundTrip     ()
+ {
+  static const size_t                  ChunkSizes[] = { 1, 100, 777, 4096, 65536 };
+  static const char                   *ArchiveNames[2] = { "zipstore", "plain" };
+  std::vector<unsigned char>           Data[2];
+  std::vector<unsigned char>           Archives[2];
+
+  RefCRC32Init();
+
+  /* compressible data with some noise for ZS::Writer archive, so entry */
+  /* is deflated (in several chunks)                                    */
+
+  Data[0].resize(ZSBENCH_ENTRY_SIZE);
+
+  for (size_t Index = 0; Index < Data[0].size(); Index++)
+   {
+    Data[0][Index] = (unsigned char)('a' + (Index % 23) + ((rand() & 0x3F) == 0));
+   }
+
+  /* whether last input byte is consumed before all output is produced */
+  /* depends on data; with this pattern it happens for small chunks    */
+
+  Data[1].resize(ZSBENCH_PLAIN_ENTRY_SIZE);
+
+  for (size_t Index = 0; Index < Data[1].size(); Index++)
+   {
+    Data[1][Index] = (unsigned char)('a' + (Index * Index / 7) % 11);
+   }
+
+  try
+   {
+    ZSBenchOutStream                   OutStream(Archives[0]);
+    ZS::Writer                         Writer(OutStream,ZS::Writer::DEFAULT_COMPRESSION);
+
+    Writer.BeginFile("entry.bin",time(0));
+    Writer.WriteData(&Data[0][0],Data[0].size());
+    Writer.Close();
+   }
+  catch (const ZS::Error &Error)
+   {
+    fprintf(stderr,"error: %s\n",Error.GetMessage());
+
+    return(false);
+   }
+
+  if (!MakePlainArchive(Archives[1],&Data[1][0],Data[1].size()))
+   {
+    fprintf(stderr,"error: unable to deflate test data\n");
+
+    return(false);
+   }
+
+  for (unsigned int ArchiveIndex = 0; ArchiveIndex < 2; ArchiveIndex++)
+   {
+    for (unsigned int Index = 0; Index < ZSBENCH_ARRAY_SIZE(ChunkSizes); Index++)
+     {
+      if (!CheckChunkedRead(Archives[ArchiveIndex],ArchiveNames[ArchiveIndex],
+                            &Data[ArchiveIndex][0],Data[ArchiveIndex].size(),
+                            ChunkSizes[Index]))
+       {
+        return(false);
+       }
+     }
+   }
+
+  printf("inflate round trip: ok\n");
+
+  return(true);
+ }
+#endif
+
+static double      Throughput         (clock_t             Start,
+                                       clock_t             Finish,
+                                       unsigned int        RepeatCount)
+ {
+  double                               Seconds;
+
+  Seconds = (double)(Finish - Start) / CLOCKS_PER_SEC;
+
+  if (Seconds <= 0.0)
+   {
+    return(0.0);
+   }
+
+  return((double)ZSBENCH_BUFFER_SIZE * RepeatCount / (1024.0 * 1024.0) / Seconds);
+ }
+
+static bool        RunBenchmark       (unsigned int        RepeatCount)
+ {
+  unsigned char                       *Data;
+  clock_t                              Start;
+  unsigned int                         RefSum;
+  unsigned int                         ZSSum;
+  double                               RefSpeed;
+  double                               ZSSpeed;
+
+  Data = (unsigned char*)malloc(ZSBENCH_BUFFER_SIZE);
+
+  if (Data == 0)
+   {
+    fprintf(stderr,"error: out of memory\n");
+
+    return(false);
+   }
+
+  srand(1);
+
+  for (size_t Index = 0; Index < ZSBENCH_BUFFER_SIZE; Index++)
+   {
+    Data[Index] = (unsigned char)(rand() & 0xFF);
+   }
+
+  RefCRC32Init();
+
+  if (!CheckCRC32(Data,ZSBENCH_BUFFER_SIZE))
+   {
+    free(Data);
+
+    return(false);
+   }
+
+  /* sums are printed so that loops can't be optimized away */
+
+  RefSum = 0;
+  Start  = clock();
+
+  for (unsigned int Index = 0; Index < RepeatCount; Index++)
+   {
+    RefSum += RefCRC32(Data,ZSBENCH_BUFFER_SIZE);
+   }
+
+  RefSpeed = Throughput(Start,clock(),RepeatCount);
+
+  ZSSum = 0;
+  Start = clock();
+
+  for (unsigned int Index = 0; Index < RepeatCount; Index++)
+   {
+    ZSSum += ZSCRC32(Data,ZSBENCH_BUFFER_SIZE);
+   }
+
+  ZSSpeed = Throughput(Start,clock(),RepeatCount);
+
+  printf("bytewise CRC32    : %8.1f MB/s (%08x)\n",RefSpeed,RefSum);
+  printf("zipstore CRC32    : %8.1f MB/s (%08x)\n",ZSSpeed,ZSSum);
+
+  if (RefSpeed > 0.0)
+   {
+    printf("speedup           : %8.2fx\n",ZSSpeed / RefSpeed);
+   }
+
+  free(Data);
+
+  return(true);
+ }
+
+static void        ShowHelpMessage    ()
+ {
+  printf("Usage: zsbench [options]\n");
+  printf("Options:\n");
+  printf("  -h            Display this information\n");
+  printf("  -r <count>    Checksum 4MB buffer <count> times (64 by default)\n");
+ }
+
+int                main               (int                 argc,
+                                       char               *argv[])
+ {
+  unsigned int                         RepeatCount;
+
+  RepeatCount = 64;
+
+  for (int ArgIndex = 1; ArgIndex < argc; ArgIndex++)
+   {
+    if      (strcmp(argv[ArgIndex],"-h") == 0)
+     {
+      ShowHelpMessage();
+
+      return(0);
+     }
+    else if (strcmp(argv[ArgIndex],"-r") == 0)
+     {
+      ArgIndex++;
+
+      if ((ArgIndex >= argc) ||
+          (sscanf(argv[ArgIndex],"%u",&RepeatCount) != 1) ||
+          (RepeatCount == 0))
+       {
+        fprintf(stderr,"error: invalid repeat count\n");
+
+        return(1);
+       }
+     }
+    else
+     {
+      fprintf(stderr,"error: invalid option \"%s\"\n",argv[ArgIndex]);
+
+      return(1);
+     }
+   }
+
+  #if defined(WITH_ZLIB)
+  if (!CheckRoundTrip())
+   {
+    return(1);
+   }
+  #endif
+
+  return(RunBenchmark(RepeatCount) ? 0 : 1);
+ }
+
@@ -425,6 +425,27 @@ void               P3DBranchingAlgBase::Save
   FmtStream.WriteString("sf","RotAngle",Rotation);
  }
 
+void               P3DBranchingAlgBase::UpdateHash
+                                      (P3DHash            *Hash) const
+ {
+  Hash->AddString("Base");
+
+  Hash->AddUInt(Shape);
+  Hash->AddFloat(Spread);
+
+  Hash->AddFloat(Density);
+  Hash->AddFloat(DensityV);
+
+  Hash->AddUInt(MinNumber);
+  Hash->AddBool(MaxLimitEnabled);
+  Hash->AddUInt(MaxNumber);
+
+  Hash->AddFloat(DeclFactor);
+  Hash->AddFloat(DeclFactorV);
+
+  Hash->AddFloat(Rotation);
+ }
+
 void               P3DBranchingAlgBase::Load
                                       (P3DInputStringFmtStream
                                                           *SourceStream,
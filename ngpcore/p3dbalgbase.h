@@ -86,6 +86,8 @@ class P3DBranchingAlgBase : public P3DBranchingAlg
                                        const P3DFileVersion
                                                           *Version);
 
+  virtual void     UpdateHash         (P3DHash            *Hash) const;
+
   static void      MakeBranchWorldMatrix
                                       (float                        *WorldTransform,
                                        const P3DVector3f            *Offset,
@@ -408,6 +408,33 @@ void               P3DBranchingAlgStd::Save
   FmtStream.WriteString("sf","DeclinationV",DeclinationV);
  }
 
+void               P3DBranchingAlgStd::UpdateHash
+                                      (P3DHash            *Hash) const
+ {
+  Hash->AddString("Std");
+
+  Hash->AddFloat(Density);
+  Hash->AddFloat(DensityV);
+
+  Hash->AddUInt(MinNumber);
+  Hash->AddBool(MaxLimitEnabled);
+  Hash->AddUInt(MaxNumber);
+
+  Hash->AddUInt(Multiplicity);
+
+  Hash->AddFloat(StartRevAngle);
+  Hash->AddFloat(RevAngle);
+  Hash->AddFloat(RevAngleV);
+
+  Hash->AddFloat(Rotation);
+
+  Hash->AddFloat(MinOffset);
+  Hash->AddFloat(MaxOffset);
+
+  P3DHashSplineCurve(Hash,&DeclinationCurve);
+  Hash->AddFloat(DeclinationV);
+ }
+
 void               P3DBranchingAlgStd::Load
                                       (P3DInputStringFmtStream
                                                           *SourceStream,
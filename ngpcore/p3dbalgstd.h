@@ -101,6 +101,8 @@ class P3DBranchingAlgStd : public P3DBranchingAlg
                                        const P3DFileVersion
                                                           *Version);
 
+  virtual void     UpdateHash         (P3DHash            *Hash) const;
+
   static void      MakeDefaultDeclinationCurve
                                       (P3DMathNaturalCubicSpline
                                                           &Curve);
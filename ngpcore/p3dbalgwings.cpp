@@ -85,6 +85,14 @@ void               P3DBranchingAlgWings::Save
   FmtStream.WriteString("sf","RotAngle",Rotation);
  }
 
+void               P3DBranchingAlgWings::UpdateHash
+                                      (P3DHash            *Hash) const
+ {
+  Hash->AddString("Wings");
+
+  Hash->AddFloat(Rotation);
+ }
+
 void               P3DBranchingAlgWings::Load
                                       (P3DInputStringFmtStream
                                                           *SourceStream,
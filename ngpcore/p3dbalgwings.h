@@ -59,6 +59,8 @@ class P3DBranchingAlgWings : public P3DBranchingAlg
                                        const P3DFileVersion
                                                           *Version);
 
+  virtual void     UpdateHash         (P3DHash            *Hash) const;
+
   private          :
 
   float                                Rotation; /* branch rotation around its parent Y axis */
@@ -99,13 +99,13 @@
    {
     for (Index = 0; Index < P3D_GMESH_MAX_ATTRS; Index++)
      {
-      delete VAttrValues[Index];
-      delete VAttrValueIndices[Index];
-      delete VAttrBuffersI[Index];
+      delete[] VAttrValues[Index];
+      delete[] VAttrValueIndices[Index];
+      delete[] VAttrBuffersI[Index];
      }
 
-    delete PrimitiveTypes;
-    delete IndexBufferI;
+    delete[] PrimitiveTypes;
+    delete[] IndexBufferI;
 
     throw;
    }
@@ -118,13 +118,13 @@
 
   for (Index = 0; Index < P3D_GMESH_MAX_ATTRS; Index++)
    {
-    delete VAttrValues[Index];
-    delete VAttrValueIndices[Index];
-    delete VAttrBuffersI[Index];
+    delete[] VAttrValues[Index];
+    delete[] VAttrValueIndices[Index];
+    delete[] VAttrBuffersI[Index];
    }
 
-  delete PrimitiveTypes;
-  delete IndexBufferI;
+  delete[] PrimitiveTypes;
+  delete[] IndexBufferI;
  }
 
 unsigned int       P3DGMeshData::GetVAttrCount
@@ -0,0 +1,156 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#include <string.h>
+
+#include <ngpcore/p3dhash.h>
+
+#define P3DHashFNVOffsetBasis (0xCBF29CE484222325ULL)
+#define P3DHashFNVPrime       (0x100000001B3ULL)
+
+                   P3DHash::P3DHash   ()
+ {
+  Value = P3DHashFNVOffsetBasis;
+ }
+
+void               P3DHash::AddBytes  (const void         *Data,
+                                       unsigned int        Size)
+ {
+  const unsigned char                 *Bytes;
+  P3Duint64                            Hash;
+
+  Bytes = (const unsigned char*)Data;
+  Hash  = Value;
+
+  while (Size > 0)
+   {
+    Hash ^= *Bytes++;
+    Hash *= P3DHashFNVPrime;
+
+    Size--;
+   }
+
+  Value = Hash;
+ }
+
+void               P3DHash::AddUInt   (P3Duint32           Value)
+ {
+  unsigned char                        Bytes[4];
+
+  Bytes[0] = (unsigned char)(Value & 0xFF);
+  Bytes[1] = (unsigned char)((Value >> 8) & 0xFF);
+  Bytes[2] = (unsigned char)((Value >> 16) & 0xFF);
+  Bytes[3] = (unsigned char)((Value >> 24) & 0xFF);
+
+  AddBytes(Bytes,sizeof(Bytes));
+ }
+
+void               P3DHash::AddUInt64 (P3Duint64           Value)
+ {
+  AddUInt((P3Duint32)(Value & 0xFFFFFFFF));
+  AddUInt((P3Duint32)(Value >> 32));
+ }
+
+void               P3DHash::AddBool   (bool                Value)
+ {
+  unsigned char                        Byte;
+
+  Byte = Value ? 1 : 0;
+
+  AddBytes(&Byte,1);
+ }
+
+void               P3DHash::AddFloat  (float               Value)
+ {
+  P3Duint32                            Bits;
+
+  if      (Value == 0.0f)
+   {
+    Bits = 0; /* +0.0 and -0.0 are equal */
+   }
+  else if (Value != Value)
+   {
+    Bits = 0x7FC00000; /* canonical NaN */
+   }
+  else
+   {
+    memcpy(&Bits,&Value,sizeof(Bits));
+   }
+
+  AddUInt(Bits);
+ }
+
+void               P3DHash::AddString (const char         *Value)
+ {
+  if (Value == 0)
+   {
+    AddUInt(0);
+   }
+  else
+   {
+    unsigned int                       Length;
+
+    Length = strlen(Value);
+
+    AddUInt(Length + 1);
+    AddBytes(Value,Length);
+   }
+ }
+
+void               P3DHash::AddUIntArray
+                                      (const unsigned int *Values,
+                                       unsigned int        Count)
+ {
+  AddUInt(Count);
+
+  for (unsigned int Index = 0; Index < Count; Index++)
+   {
+    AddUInt(Values[Index]);
+   }
+ }
+
+void               P3DHash::AddFloatArray
+                                      (const float        *Values,
+                                       unsigned int        Count)
+ {
+  AddUInt(Count);
+
+  for (unsigned int Index = 0; Index < Count; Index++)
+   {
+    AddFloat(Values[Index]);
+   }
+ }
+
+P3Duint64          P3DHash::GetValue  () const
+ {
+  return(Value);
+ }
+
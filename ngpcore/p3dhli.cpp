@@ -775,11 +775,11 @@ class P3DHLIFillVAttrBuffersIHelper : public P3DBranchingFactory
   void                               **DataBuffers;
  };
 
-class P3DHLIFillVAttrBuffersIMultiHelper : public P3DBranchingFactory
+class P3DHLIVisitBranchesHelper : public P3DBranchingFactory
  {
   public           :
 
-                   P3DHLIFillVAttrBuffersIMultiHelper
+                   P3DHLIVisitBranchesHelper
                                       (P3DMathRNG         *RNG,
                                        const P3DBranchModel
                                                           *BranchModel,
@@ -787,15 +787,14 @@ class P3DHLIFillVAttrBuffersIMultiHelper : public P3DBranchingFactory
                                                           *Parent,
                                        unsigned int        GroupIndex,
                                        bool                DummiesEnabled,
-                                       P3DHLIVAttrBufferSet
-                                                          *VAttrBufferSetArray)
+                                       P3DHLIBranchVisitor*Visitor)
    {
-    this->RNG                 = RNG;
-    this->BranchModel         = BranchModel;
-    this->Parent              = Parent;
-    this->GroupIndex          = GroupIndex;
-    this->DummiesEnabled      = DummiesEnabled;
-    this->VAttrBufferSetArray = VAttrBufferSetArray;
+    this->RNG            = RNG;
+    this->BranchModel    = BranchModel;
+    this->Parent         = Parent;
+    this->GroupIndex     = GroupIndex;
+    this->DummiesEnabled = DummiesEnabled;
+    this->Visitor        = Visitor;
    }
 
   virtual void     GenerateBranch     (const P3DVector3f  *Offset,
@@ -818,73 +817,7 @@ class P3DHLIFillVAttrBuffersIMultiHelper : public P3DBranchingFactory
 
     if (Instance != 0 && (DummiesEnabled || !BranchModel->IsDummy()))
      {
-      unsigned int                     VAttrIndex;
-      unsigned int                     VAttrCount;
-
-      VAttrCount = Instance->GetVAttrCountI();
-
-      for (VAttrIndex = 0; VAttrIndex < VAttrCount; VAttrIndex++)
-       {
-        if (VAttrBufferSetArray[GroupIndex][P3D_ATTR_VERTEX] != 0)
-         {
-          Instance->GetVAttrValueI
-           (VAttrBufferSetArray[GroupIndex][P3D_ATTR_VERTEX],
-            P3D_ATTR_VERTEX,
-            VAttrIndex);
-
-          VAttrBufferSetArray[GroupIndex][P3D_ATTR_VERTEX] += 3;
-         }
-
-        if (VAttrBufferSetArray[GroupIndex][P3D_ATTR_NORMAL] != 0)
-         {
-          Instance->GetVAttrValueI
-           (VAttrBufferSetArray[GroupIndex][P3D_ATTR_NORMAL],
-            P3D_ATTR_NORMAL,
-            VAttrIndex);
-
-          VAttrBufferSetArray[GroupIndex][P3D_ATTR_NORMAL] += 3;
-         }
-
-        if (VAttrBufferSetArray[GroupIndex][P3D_ATTR_TEXCOORD0] != 0)
-         {
-          Instance->GetVAttrValueI
-           (VAttrBufferSetArray[GroupIndex][P3D_ATTR_TEXCOORD0],
-            P3D_ATTR_TEXCOORD0,
-            VAttrIndex);
-
-          VAttrBufferSetArray[GroupIndex][P3D_ATTR_TEXCOORD0] += 2;
-         }
-
-        if (VAttrBufferSetArray[GroupIndex][P3D_ATTR_TANGENT] != 0)
-         {
-          Instance->GetVAttrValueI
-           (VAttrBufferSetArray[GroupIndex][P3D_ATTR_TANGENT],
-            P3D_ATTR_TANGENT,
-            VAttrIndex);
-
-          VAttrBufferSetArray[GroupIndex][P3D_ATTR_TANGENT] += 3;
-         }
-
-        if (VAttrBufferSetArray[GroupIndex][P3D_ATTR_BINORMAL] != 0)
-         {
-          Instance->GetVAttrValueI
-           (VAttrBufferSetArray[GroupIndex][P3D_ATTR_BINORMAL],
-            P3D_ATTR_BINORMAL,
-            VAttrIndex);
-
-          VAttrBufferSetArray[GroupIndex][P3D_ATTR_BINORMAL] += 3;
-         }
-
-        if (VAttrBufferSetArray[GroupIndex][P3D_ATTR_BILLBOARD_POS] != 0)
-         {
-          Instance->GetVAttrValueI
-           (VAttrBufferSetArray[GroupIndex][P3D_ATTR_BILLBOARD_POS],
-            P3D_ATTR_BILLBOARD_POS,
-            VAttrIndex);
-
-          VAttrBufferSetArray[GroupIndex][P3D_ATTR_BILLBOARD_POS] += 3;
-         }
-       }
+      Visitor->VisitBranch(GroupIndex,Instance);
      }
 
     unsigned int                     SubBranchIndex;
@@ -911,13 +844,12 @@ class P3DHLIFillVAttrBuffersIMultiHelper : public P3DBranchingFactory
 
     for (SubBranchIndex = 0; SubBranchIndex < SubBranchCount; SubBranchIndex++)
      {
-      P3DHLIFillVAttrBuffersIMultiHelper
-                                       Helper(RNG,
+      P3DHLIVisitBranchesHelper        Helper(RNG,
                                               BranchModel->GetSubBranchModel(SubBranchIndex),
                                               Instance,
                                               SubGroupIndex,
                                               DummiesEnabled,
-                                              VAttrBufferSetArray);
+                                              Visitor);
 
       const_cast<P3DBranchingAlg*>(BranchModel->GetSubBranchModel(SubBranchIndex)->GetBranchingAlg())
        ->CreateBranches(&Helper,Instance,RNG);
@@ -939,6 +871,95 @@ class P3DHLIFillVAttrBuffersIMultiHelper : public P3DBranchingFactory
   const P3DStemModelInstance          *Parent;
   unsigned int                         GroupIndex;
   bool                                 DummiesEnabled;
+  P3DHLIBranchVisitor                 *Visitor;
+ };
+
+class P3DHLIFillVAttrBuffersIMultiVisitor : public P3DHLIBranchVisitor
+ {
+  public           :
+
+                   P3DHLIFillVAttrBuffersIMultiVisitor
+                                      (P3DHLIVAttrBufferSet
+                                                          *VAttrBufferSetArray)
+   {
+    this->VAttrBufferSetArray = VAttrBufferSetArray;
+   }
+
+  virtual void     VisitBranch        (unsigned int        GroupIndex,
+                                       const P3DStemModelInstance
+                                                          *Instance)
+   {
+    unsigned int                       VAttrIndex;
+    unsigned int                       VAttrCount;
+
+    VAttrCount = Instance->GetVAttrCountI();
+
+    for (VAttrIndex = 0; VAttrIndex < VAttrCount; VAttrIndex++)
+     {
+      if (VAttrBufferSetArray[GroupIndex][P3D_ATTR_VERTEX] != 0)
+       {
+        Instance->GetVAttrValueI
+         (VAttrBufferSetArray[GroupIndex][P3D_ATTR_VERTEX],
+          P3D_ATTR_VERTEX,
+          VAttrIndex);
+
+        VAttrBufferSetArray[GroupIndex][P3D_ATTR_VERTEX] += 3;
+       }
+
+      if (VAttrBufferSetArray[GroupIndex][P3D_ATTR_NORMAL] != 0)
+       {
+        Instance->GetVAttrValueI
+         (VAttrBufferSetArray[GroupIndex][P3D_ATTR_NORMAL],
+          P3D_ATTR_NORMAL,
+          VAttrIndex);
+
+        VAttrBufferSetArray[GroupIndex][P3D_ATTR_NORMAL] += 3;
+       }
+
+      if (VAttrBufferSetArray[GroupIndex][P3D_ATTR_TEXCOORD0] != 0)
+       {
+        Instance->GetVAttrValueI
+         (VAttrBufferSetArray[GroupIndex][P3D_ATTR_TEXCOORD0],
+          P3D_ATTR_TEXCOORD0,
+          VAttrIndex);
+
+        VAttrBufferSetArray[GroupIndex][P3D_ATTR_TEXCOORD0] += 2;
+       }
+
+      if (VAttrBufferSetArray[GroupIndex][P3D_ATTR_TANGENT] != 0)
+       {
+        Instance->GetVAttrValueI
+         (VAttrBufferSetArray[GroupIndex][P3D_ATTR_TANGENT],
+          P3D_ATTR_TANGENT,
+          VAttrIndex);
+
+        VAttrBufferSetArray[GroupIndex][P3D_ATTR_TANGENT] += 3;
+       }
+
+      if (VAttrBufferSetArray[GroupIndex][P3D_ATTR_BINORMAL] != 0)
+       {
+        Instance->GetVAttrValueI
+         (VAttrBufferSetArray[GroupIndex][P3D_ATTR_BINORMAL],
+          P3D_ATTR_BINORMAL,
+          VAttrIndex);
+
+        VAttrBufferSetArray[GroupIndex][P3D_ATTR_BINORMAL] += 3;
+       }
+
+      if (VAttrBufferSetArray[GroupIndex][P3D_ATTR_BILLBOARD_POS] != 0)
+       {
+        Instance->GetVAttrValueI
+         (VAttrBufferSetArray[GroupIndex][P3D_ATTR_BILLBOARD_POS],
+          P3D_ATTR_BILLBOARD_POS,
+          VAttrIndex);
+
+        VAttrBufferSetArray[GroupIndex][P3D_ATTR_BILLBOARD_POS] += 3;
+       }
+     }
+   }
+
+  private          :
+
   P3DHLIVAttrBufferSet                *VAttrBufferSetArray;
  };
 
@@ -1149,6 +1170,13 @@ P3DModelMetaInfo  *P3DHLIPlantTemplate::GetMetaInfo
   return Model->GetMetaInfo();
  }
 
+const
+P3DPlantModel     *P3DHLIPlantTemplate::GetModel
+                                      () const
+ {
+  return(Model);
+ }
+
 unsigned int       P3DHLIPlantTemplate::GetGroupCount
                                       () const
  {
@@ -1395,7 +1423,7 @@ void               P3DHLIPlantInstance::GetBranchCountMulti
     BranchCounts[GroupIndex] = 0;
    }
 
-  P3DMathRNGSimple                     RNG(Model->GetBaseSeed());
+  P3DMathRNGSimple                     RNG(BaseSeed);
 
   P3DHLIBranchCalculatorMulti Calculator(IsRandomnessEnabled() ? &RNG : 0,
                                           Model->GetPlantBase(),
@@ -1690,20 +1718,28 @@ void               P3DHLIPlantInstance::FillVAttrBuffersIMulti
        }
      }
 
-    P3DMathRNGSimple                     RNG(Model->GetBaseSeed());
-    P3DHLIFillVAttrBuffersIMultiHelper   Helper(IsRandomnessEnabled() ? &RNG : 0,
-                                                 Model->GetPlantBase(),
-                                                 0,
-                                                 0,
-                                                 DummiesEnabled,
-                                                 TempVAttrBufferSet);
+    P3DHLIFillVAttrBuffersIMultiVisitor  Visitor(TempVAttrBufferSet);
 
-    Helper.GenerateBranch(0,0);
+    VisitBranches(&Visitor);
 
     delete[] TempVAttrBufferSet;
    }
  }
 
+void               P3DHLIPlantInstance::VisitBranches
+                                      (P3DHLIBranchVisitor*Visitor) const
+ {
+  P3DMathRNGSimple                     RNG(BaseSeed);
+  P3DHLIVisitBranchesHelper            Helper(IsRandomnessEnabled() ? &RNG : 0,
+                                              Model->GetPlantBase(),
+                                              0,
+                                              0,
+                                              DummiesEnabled,
+                                              Visitor);
+
+  Helper.GenerateBranch(0,0);
+ }
+
 bool               P3DHLIPlantInstance::IsRandomnessEnabled() const
  {
   return (Model->GetFlags() & P3D_MODEL_FLAG_NO_RANDOMNESS) == 0;
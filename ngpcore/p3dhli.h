@@ -90,6 +90,20 @@ class P3D_DLL_ENTRY P3DHLIVAttrFormat
   unsigned int     Stride;
  };
 
+/* Receives instances of all (non-dummy, unless dummies are enabled)      */
+/* branches in the same order as FillVAttrBuffersIMulti fills them, so    */
+/* geometry can be collected without knowing branch counts in advance     */
+class P3D_DLL_ENTRY P3DHLIBranchVisitor
+ {
+  public           :
+
+  virtual         ~P3DHLIBranchVisitor() {};
+
+  virtual void     VisitBranch        (unsigned int        GroupIndex,
+                                       const P3DStemModelInstance
+                                                          *Instance) = 0;
+ };
+
 class P3DHLIPlantInstance;
 
 class P3D_DLL_ENTRY P3DHLIPlantTemplate
@@ -103,6 +117,9 @@ class P3D_DLL_ENTRY P3DHLIPlantTemplate
   const
   P3DModelMetaInfo*GetMetaInfo        () const;
 
+  const
+  P3DPlantModel   *GetModel           () const;
+
   unsigned int     GetGroupCount      () const;
 
   const char      *GetGroupName       (unsigned int        GroupIndex) const;
@@ -230,6 +247,9 @@ class P3D_DLL_ENTRY P3DHLIPlantInstance
                                       (P3DHLIVAttrBufferSet
                                                           *VAttrBufferSet) const;
 
+  /* single traversal, instances are valid only inside VisitBranch call */
+  void             VisitBranches      (P3DHLIBranchVisitor*Visitor) const;
+
   private          :
 
   bool             IsRandomnessEnabled() const;
@@ -125,6 +125,7 @@ const char        *P3DExceptionIO::GetMessage
  {
   this->SourceStream         = SourceStream;
   this->HandleEscapedStrings = true;
+  this->HasPendingString     = false;
  }
 
 void               P3DInputStringFmtStream::EnableEscapeChars
@@ -176,6 +177,27 @@ static bool        GetWordInfoFirst   (P3DWordInfo        *WordInfo,
   return(GetWordInfoNext(WordInfo,Str));
  }
 
+bool               P3DInputStringFmtStream::IsNextStringTagged
+                                      (const char         *Tag)
+ {
+  P3DWordInfo                          WordInfo;
+
+  if (!HasPendingString)
+   {
+    SourceStream->ReadString(PendingString,sizeof(PendingString));
+
+    HasPendingString = true;
+   }
+
+  if (!GetWordInfoFirst(&WordInfo,PendingString))
+   {
+    return(false);
+   }
+
+  return((strlen(Tag) == WordInfo.Length) &&
+         (memcmp(Tag,&PendingString[WordInfo.Start],WordInfo.Length) == 0));
+ }
+
 void               P3DInputStringFmtStream::ScanStringSafe
                                       (char               *DestBuffer,
                                        unsigned int        DestSize,
@@ -384,7 +406,21 @@ void               P3DInputStringFmtStream::ReadDataString
                                        unsigned int        BufferSize)
  {
   /*FIXME: skip empty lines here */
-  SourceStream->ReadString(Buffer,BufferSize);
+  if (HasPendingString)
+   {
+    if (strlen(PendingString) >= BufferSize)
+     {
+      throw P3DExceptionGeneric("string is too long in data file");
+     }
+
+    strcpy(Buffer,PendingString);
+
+    HasPendingString = false;
+   }
+  else
+   {
+    SourceStream->ReadString(Buffer,BufferSize);
+   }
  }
 
                    P3DInputStringStreamFile::P3DInputStringStreamFile
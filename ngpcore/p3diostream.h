@@ -97,6 +97,9 @@ class P3DInputStringFmtStream
 
   void             EnableEscapeChars  (bool                Enable);
 
+  /* checks tag of the next string without consuming it */
+  bool             IsNextStringTagged (const char         *Tag);
+
   private          :
 
   void             ReadDataString     (char               *Buffer,
@@ -110,6 +113,8 @@ class P3DInputStringFmtStream
 
   P3DInputStringStream                *SourceStream;
   bool                                 HandleEscapedStrings;
+  char                                 PendingString[1024];
+  bool                                 HasPendingString;
  };
 
 class P3DOutputStringStream
@@ -29,8 +29,19 @@
 
 ***************************************************************************/
 
+#include <stdlib.h>
 #include <string.h>
 
+#ifdef _WIN32
+ #include <windows.h>
+#else
+ #include <sys/types.h>
+ #include <sys/stat.h>
+ #include <sys/mman.h>
+ #include <fcntl.h>
+ #include <unistd.h>
+#endif
+
 #include <ngpcore/p3diostream.h>
 #include <ngpcore/p3diostreamadd.h>
 
@@ -122,3 +133,423 @@ bool               P3DInputStringStreamString::Eof
  }
 
 
+
+                   P3DInputStringStreamMemory::P3DInputStringStreamMemory
+                                      (const void         *Data,
+                                       unsigned int        DataSize)
+ {
+  SetSource(Data,DataSize);
+ }
+
+                   P3DInputStringStreamMemory::P3DInputStringStreamMemory
+                                      ()
+ {
+  SetSource(NULL,0);
+ }
+
+void               P3DInputStringStreamMemory::SetSource
+                                      (const void         *Data,
+                                       unsigned int        DataSize)
+ {
+  this->Data     = (const char*)Data;
+  this->DataSize = Data != NULL ? DataSize : 0;
+  this->Pos      = 0;
+ }
+
+void               P3DInputStringStreamMemory::Rewind
+                                      ()
+ {
+  Pos = 0;
+ }
+
+bool               P3DInputStringStreamMemory::ReadLine
+                                      (const char        **Line,
+                                       unsigned int       *Length)
+ {
+  const char                          *Start;
+  const char                          *End;
+  unsigned int                         Avail;
+
+  if (Pos >= DataSize)
+   {
+    *Line   = NULL;
+    *Length = 0;
+
+    return(false);
+   }
+
+  Start = &Data[Pos];
+  Avail = DataSize - Pos;
+  End   = (const char*)memchr(Start,'\n',Avail);
+
+  if (End != NULL)
+   {
+    Pos += (unsigned int)(End - Start) + 1;
+   }
+  else
+   {
+    End  = Start + Avail;
+    Pos  = DataSize;
+   }
+
+  if ((End > Start) && (End[-1] == '\r'))
+   {
+    End--;
+   }
+
+  *Line   = Start;
+  *Length = (unsigned int)(End - Start);
+
+  return(true);
+ }
+
+void               P3DInputStringStreamMemory::ReadString
+                                      (char               *Buffer,
+                                       unsigned int        BufferSize)
+ {
+  const char                          *Start;
+  const char                          *End;
+  unsigned int                         Avail;
+  unsigned int                         Length;
+  unsigned int                         Next;
+
+  if (BufferSize < 2)
+   {
+    throw P3DExceptionAssert();
+   }
+
+  if (Pos >= DataSize)
+   {
+    Buffer[0] = 0;
+
+    return;
+   }
+
+  Start = &Data[Pos];
+  Avail = DataSize - Pos;
+  End   = (const char*)memchr(Start,'\n',Avail);
+
+  if (End != NULL)
+   {
+    Next = Pos + (unsigned int)(End - Start) + 1;
+   }
+  else
+   {
+    End  = Start + Avail;
+    Next = DataSize;
+   }
+
+  Length = (unsigned int)(End - Start);
+
+  if ((Length > 0) && (End[-1] == '\r'))
+   {
+    Length--;
+   }
+
+  /* too long lines are split in the same way as file stream does */
+  if (Length > BufferSize - 1)
+   {
+    Length = BufferSize - 1;
+    Next   = Pos + Length;
+   }
+
+  memcpy(Buffer,Start,Length);
+
+  Buffer[Length] = 0;
+
+  Pos = Next;
+ }
+
+bool               P3DInputStringStreamMemory::Eof
+                                      () const
+ {
+  return(Pos >= DataSize);
+ }
+
+                   P3DInputStringStreamMMap::P3DInputStringStreamMMap
+                                      ()
+ {
+  MapBase    = NULL;
+  MapSize    = 0;
+  #ifdef _WIN32
+  FileHandle = INVALID_HANDLE_VALUE;
+  MapHandle  = NULL;
+  #endif
+ }
+
+                   P3DInputStringStreamMMap::~P3DInputStringStreamMMap
+                                      ()
+ {
+  Close();
+ }
+
+#ifdef _WIN32
+void               P3DInputStringStreamMMap::Open
+                                      (const char         *FileName)
+ {
+  LARGE_INTEGER                        FileSize;
+
+  Close();
+
+  FileHandle = CreateFileA(FileName,GENERIC_READ,FILE_SHARE_READ,NULL,
+                           OPEN_EXISTING,FILE_FLAG_SEQUENTIAL_SCAN,NULL);
+
+  if (FileHandle == INVALID_HANDLE_VALUE)
+   {
+    throw P3DExceptionIO();
+   }
+
+  if ((!GetFileSizeEx(FileHandle,&FileSize)) || (FileSize.HighPart != 0))
+   {
+    Close();
+
+    throw P3DExceptionIO();
+   }
+
+  MapSize = FileSize.LowPart;
+
+  if (MapSize > 0)
+   {
+    MapHandle = CreateFileMappingA(FileHandle,NULL,PAGE_READONLY,0,0,NULL);
+
+    if (MapHandle != NULL)
+     {
+      MapBase = MapViewOfFile(MapHandle,FILE_MAP_READ,0,0,0);
+     }
+
+    if (MapBase == NULL)
+     {
+      Close();
+
+      throw P3DExceptionIO();
+     }
+   }
+
+  SetSource(MapBase,MapSize);
+ }
+
+void               P3DInputStringStreamMMap::Close
+                                      ()
+ {
+  if (MapBase != NULL)
+   {
+    UnmapViewOfFile(MapBase);
+   }
+
+  if (MapHandle != NULL)
+   {
+    CloseHandle(MapHandle);
+   }
+
+  if (FileHandle != INVALID_HANDLE_VALUE)
+   {
+    CloseHandle(FileHandle);
+   }
+
+  MapBase    = NULL;
+  MapSize    = 0;
+  MapHandle  = NULL;
+  FileHandle = INVALID_HANDLE_VALUE;
+
+  SetSource(NULL,0);
+ }
+#else
+void               P3DInputStringStreamMMap::Open
+                                      (const char         *FileName)
+ {
+  int                                  FileDesc;
+  struct stat                          FileStat;
+
+  Close();
+
+  FileDesc = open(FileName,O_RDONLY);
+
+  if (FileDesc < 0)
+   {
+    throw P3DExceptionIO();
+   }
+
+  if ((fstat(FileDesc,&FileStat) != 0) ||
+      ((unsigned long long)FileStat.st_size > 0xFFFFFFFFULL))
+   {
+    close(FileDesc);
+
+    throw P3DExceptionIO();
+   }
+
+  MapSize = (unsigned int)FileStat.st_size;
+
+  if (MapSize > 0)
+   {
+    MapBase = mmap(NULL,MapSize,PROT_READ,MAP_PRIVATE,FileDesc,0);
+
+    if (MapBase == MAP_FAILED)
+     {
+      MapBase = NULL;
+      MapSize = 0;
+
+      close(FileDesc);
+
+      throw P3DExceptionIO();
+     }
+
+    #if defined(MADV_SEQUENTIAL)
+    madvise(MapBase,MapSize,MADV_SEQUENTIAL);
+    #endif
+   }
+
+  /* mapping stays valid after descriptor is closed */
+  close(FileDesc);
+
+  SetSource(MapBase,MapSize);
+ }
+
+void               P3DInputStringStreamMMap::Close
+                                      ()
+ {
+  if (MapBase != NULL)
+   {
+    munmap(MapBase,MapSize);
+   }
+
+  MapBase = NULL;
+  MapSize = 0;
+
+  SetSource(NULL,0);
+ }
+#endif
+
+const void        *P3DInputStringStreamMMap::GetData
+                                      () const
+ {
+  return(MapBase);
+ }
+
+unsigned int       P3DInputStringStreamMMap::GetSize
+                                      () const
+ {
+  return(MapSize);
+ }
+
+                   P3DOutputStringStreamMemory::P3DOutputStringStreamMemory
+                                      (unsigned int        InitialCapacity)
+ {
+  Data     = NULL;
+  Size     = 0;
+  Capacity = 0;
+  AutoLn   = true;
+
+  if (InitialCapacity > 0)
+   {
+    Data = (char*)malloc(InitialCapacity + 1);
+
+    if (Data == NULL)
+     {
+      throw P3DExceptionIO();
+     }
+
+    Data[0]  = 0;
+    Capacity = InitialCapacity;
+   }
+ }
+
+                   P3DOutputStringStreamMemory::~P3DOutputStringStreamMemory
+                                      ()
+ {
+  free(Data);
+ }
+
+void               P3DOutputStringStreamMemory::Append
+                                      (const char         *Str,
+                                       unsigned int        Length)
+ {
+  if (Size + Length > Capacity)
+   {
+    unsigned int                       NewCapacity;
+    char                              *NewData;
+
+    NewCapacity = Capacity > 0 ? Capacity : 256;
+
+    while (NewCapacity < Size + Length)
+     {
+      NewCapacity *= 2;
+     }
+
+    NewData = (char*)realloc(Data,NewCapacity + 1);
+
+    if (NewData == NULL)
+     {
+      throw P3DExceptionIO();
+     }
+
+    Data     = NewData;
+    Capacity = NewCapacity;
+   }
+
+  memcpy(&Data[Size],Str,Length);
+
+  Size += Length;
+
+  Data[Size] = 0;
+ }
+
+void               P3DOutputStringStreamMemory::WriteString
+                                      (const char         *Buffer)
+ {
+  Append(Buffer,strlen(Buffer));
+
+  if (AutoLn)
+   {
+    Append("\n",1);
+   }
+ }
+
+void               P3DOutputStringStreamMemory::AutoLnEnable
+                                      ()
+ {
+  AutoLn = true;
+ }
+
+void               P3DOutputStringStreamMemory::AutoLnDisable
+                                      ()
+ {
+  AutoLn = false;
+ }
+
+const char        *P3DOutputStringStreamMemory::GetData
+                                      () const
+ {
+  return(Data != NULL ? Data : "");
+ }
+
+unsigned int       P3DOutputStringStreamMemory::GetSize
+                                      () const
+ {
+  return(Size);
+ }
+
+void               P3DOutputStringStreamMemory::Clear
+                                      ()
+ {
+  Size = 0;
+
+  if (Data != NULL)
+   {
+    Data[0] = 0;
+   }
+ }
+
+char              *P3DOutputStringStreamMemory::Release
+                                      ()
+ {
+  char                                *Result;
+
+  Result = Data;
+
+  Data     = NULL;
+  Size     = 0;
+  Capacity = 0;
+
+  return(Result);
+ }
+
@@ -56,5 +56,106 @@ class P3DInputStringStreamString : public P3DInputStringStream
   unsigned int     Pos;
  };
 
+/* Input stream over caller-supplied memory. Memory is not copied and */
+/* must stay valid while stream is in use.                            */
+
+class P3D_DLL_ENTRY P3DInputStringStreamMemory : public P3DInputStringStream
+ {
+  public           :
+
+                   P3DInputStringStreamMemory
+                                      (const void         *Data,
+                                       unsigned int        DataSize);
+
+  virtual
+  void             ReadString         (char               *Buffer,
+                                       unsigned int        BufferSize);
+
+  virtual bool     Eof                () const;
+
+  /* Zero-copy line access: Line points directly into source memory, */
+  /* line terminator is not included and Line is not zero-terminated  */
+  bool             ReadLine           (const char        **Line,
+                                       unsigned int       *Length);
+
+  void             Rewind             ();
+
+  protected        :
+
+                   P3DInputStringStreamMemory
+                                      ();
+
+  void             SetSource          (const void         *Data,
+                                       unsigned int        DataSize);
+
+  private          :
+
+  const char      *Data;
+  unsigned int     DataSize;
+  unsigned int     Pos;
+ };
+
+/* Input stream over memory-mapped file */
+
+class P3D_DLL_ENTRY P3DInputStringStreamMMap : public P3DInputStringStreamMemory
+ {
+  public           :
+
+                   P3DInputStringStreamMMap
+                                      ();
+  virtual         ~P3DInputStringStreamMMap
+                                      ();
+
+  void             Open               (const char         *FileName);
+  void             Close              ();
+
+  const void      *GetData            () const;
+  unsigned int     GetSize            () const;
+
+  private          :
+
+  void            *MapBase;
+  unsigned int     MapSize;
+  #ifdef _WIN32
+  void            *FileHandle;
+  void            *MapHandle;
+  #endif
+ };
+
+/* Output stream which appends data into growable memory buffer */
+
+class P3D_DLL_ENTRY P3DOutputStringStreamMemory : public P3DOutputStringStream
+ {
+  public           :
+
+                   P3DOutputStringStreamMemory
+                                      (unsigned int        InitialCapacity = 0);
+  virtual         ~P3DOutputStringStreamMemory
+                                      ();
+
+  virtual void     WriteString        (const char         *Buffer);
+  virtual void     AutoLnEnable       ();
+  virtual void     AutoLnDisable      ();
+
+  /* Buffer is always zero-terminated, terminator is not counted in size */
+  const char      *GetData            () const;
+  unsigned int     GetSize            () const;
+
+  void             Clear              ();
+
+  /* Pass buffer ownership to caller (buffer must be freed with free()) */
+  char            *Release            ();
+
+  private          :
+
+  void             Append             (const char         *Str,
+                                       unsigned int        Length);
+
+  char            *Data;
+  unsigned int     Size;
+  unsigned int     Capacity;
+  bool             AutoLn;
+ };
+
 #endif
 
@@ -281,7 +281,9 @@ void               P3DQuaternionf::FromMatrix
 
   T = m[0] + m[5] + m[10] + 1.0f;
 
-  if (T > 0.0f)
+  /* trace branch loses precision when w is small (rotations near 180 */
+  /* degrees), so it is used for positive trace only                  */
+  if (T > 1.0f)
    {
     S = 0.5f / sqrtf(T);
 
@@ -300,10 +302,10 @@ void               P3DQuaternionf::FromMatrix
        {
         S = sqrtf(1.0f + m[0] - m[5] - m[10]) * 2.0f;
 
-        q[0] = 0.5f / S;
+        q[0] = 0.25f * S;
         q[1] = (m[1] + m[4]) / S;
         q[2] = (m[2] + m[8]) / S;
-        q[3] = (m[6] + m[9]) / S;
+        q[3] = (m[6] - m[9]) / S;
        }
       else
        {
@@ -317,9 +319,9 @@ void               P3DQuaternionf::FromMatrix
         S = sqrtf(1.0f + m[5] - m[0] - m[10]) * 2.0f;
 
         q[0] = (m[1] + m[4]) / S;
-        q[1] = 0.5f / S;
+        q[1] = 0.25f * S;
         q[2] = (m[6] + m[9]) / S;
-        q[3] = (m[2] + m[8]) / S;
+        q[3] = (m[8] - m[2]) / S;
        }
       else
        {
@@ -333,8 +335,8 @@ void               P3DQuaternionf::FromMatrix
 
       q[0] = (m[2] + m[8]) / S;
       q[1] = (m[6] + m[9]) / S;
-      q[2] = 0.5f / S;
-      q[3] = (m[1] + m[4]) / S;
+      q[2] = 0.25f * S;
+      q[3] = (m[1] - m[4]) / S;
      }
    }
  }
@@ -108,6 +108,14 @@ void               P3DVisRangeState::Save
   FmtStream.WriteString("sff","VisRange",Range.Min,Range.Max);
  }
 
+void               P3DVisRangeState::UpdateHash
+                                      (P3DHash            *Hash) const
+ {
+  Hash->AddBool(Enabled);
+  Hash->AddFloat(Range.Min);
+  Hash->AddFloat(Range.Max);
+ }
+
 void               P3DVisRangeState::Load
                                       (P3DInputStringFmtStream
                                                           *SourceStream,
@@ -276,6 +284,27 @@ void               P3DMaterialDef::Save
   FmtStream.WriteString("sf","AlphaFadeOut",AlphaFadeOut);
  }
 
+void               P3DMaterialDef::UpdateHash
+                                      (P3DHash            *Hash) const
+ {
+  Hash->AddFloat(R);
+  Hash->AddFloat(G);
+  Hash->AddFloat(B);
+
+  for (unsigned int Layer = 0; Layer < P3D_MAX_TEX_LAYERS; Layer++)
+   {
+    Hash->AddString(TexNames[Layer]);
+   }
+
+  Hash->AddBool(DoubleSided);
+  Hash->AddBool(Transparent);
+  Hash->AddUInt(BillboardMode);
+
+  Hash->AddBool(AlphaCtrlEnabled);
+  Hash->AddFloat(AlphaFadeIn);
+  Hash->AddFloat(AlphaFadeOut);
+ }
+
 void               P3DMaterialDef::Load
                                       (P3DInputStringFmtStream
                                                           *SourceStream,
@@ -554,6 +583,22 @@ void               P3DStemModelInstance::GetBoundBox
    }
  }
 
+void               P3DStemModelInstance::FillVAttrBufferI
+                                      (float              *Buffer,
+                                       unsigned int        Attr) const
+ {
+  unsigned int     VAttrCount;
+  unsigned int     ComponentCount;
+
+  VAttrCount     = GetVAttrCountI();
+  ComponentCount = Attr == P3D_ATTR_TEXCOORD0 ? 2 : 3;
+
+  for (unsigned int VAttrIndex = 0; VAttrIndex < VAttrCount; VAttrIndex++)
+   {
+    GetVAttrValueI(&Buffer[VAttrIndex * ComponentCount],Attr,VAttrIndex);
+   }
+ }
+
                    P3DBranchModel::P3DBranchModel
                                       ()
  {
@@ -878,6 +923,58 @@ void               P3DBranchModel::Save
    }
  }
 
+P3Duint64          P3DBranchModel::ComputeHash
+                                      () const
+ {
+  P3DHash                              Hash;
+
+  Hash.AddBool(Dummy);
+
+  if (BranchingAlg != 0)
+   {
+    Hash.AddBool(true);
+
+    BranchingAlg->UpdateHash(&Hash);
+   }
+  else
+   {
+    Hash.AddBool(false);
+   }
+
+  if (StemModel != 0)
+   {
+    Hash.AddBool(true);
+
+    StemModel->UpdateHash(&Hash);
+   }
+  else
+   {
+    Hash.AddBool(false);
+   }
+
+  if (MaterialInstance != 0)
+   {
+    Hash.AddBool(true);
+
+    MaterialInstance->GetMaterialDef()->UpdateHash(&Hash);
+   }
+  else
+   {
+    Hash.AddBool(false);
+   }
+
+  VisRangeState.UpdateHash(&Hash);
+
+  Hash.AddUInt(SubBranchCount);
+
+  for (unsigned int SubBranchIndex = 0; SubBranchIndex < SubBranchCount; SubBranchIndex++)
+   {
+    Hash.AddUInt64(SubBranches[SubBranchIndex]->ComputeHash());
+   }
+
+  return(Hash.GetValue());
+ }
+
 void               P3DBranchModel::Load
                                       (P3DInputStringFmtStream
                                                           *SourceStream,
@@ -1246,22 +1343,68 @@ void               P3DPlantModel::SetFlags
   this->Flags = Flags;
  }
 
-#define P3D_VERSION_MINOR (14)
+#define P3D_VERSION_MINOR (15)
 #define P3D_VERSION_MAJOR (0)
 
+/* 0.15 only adds g-mesh data encoding, so models without base64-encoded */
+/* g-mesh data are saved as 0.14 to keep them readable by older versions  */
+#define P3D_VERSION_MINOR_COMPAT (14)
+
+static bool        HasBase64GMeshData (const P3DBranchModel
+                                                          *BranchModel)
+ {
+  const P3DStemModelGMesh             *StemModelGMesh;
+  unsigned int                         SubBranchIndex;
+
+  StemModelGMesh = dynamic_cast<const P3DStemModelGMesh*>(BranchModel->GetStemModel());
+
+  if ((StemModelGMesh != 0) &&
+      (StemModelGMesh->GetStorageMode() == P3DGMeshStorageBase64))
+   {
+    return(true);
+   }
+
+  for (SubBranchIndex = 0;
+       SubBranchIndex < BranchModel->GetSubBranchCount();
+       SubBranchIndex++)
+   {
+    if (HasBase64GMeshData(BranchModel->GetSubBranchModel(SubBranchIndex)))
+     {
+      return(true);
+     }
+   }
+
+  return(false);
+ }
+
 void               P3DPlantModel::Save(P3DOutputStringStream
                                                           *TargetStream,
                                        P3DMaterialSaver   *MaterialSaver) const
  {
   P3DOutputStringFmtStream             FmtStream(TargetStream);
 
-  FmtStream.WriteString("suu","P3D",(unsigned int)P3D_VERSION_MAJOR,(unsigned int)P3D_VERSION_MINOR);
+  FmtStream.WriteString("suu","P3D",(unsigned int)P3D_VERSION_MAJOR,
+                        HasBase64GMeshData(PlantBase) ?
+                         (unsigned int)P3D_VERSION_MINOR :
+                         (unsigned int)P3D_VERSION_MINOR_COMPAT);
   MetaInfo.Save(TargetStream);
   FmtStream.WriteString("su","BaseSeed",BaseSeed);
 
   PlantBase->Save(TargetStream,MaterialSaver);
  }
 
+P3Duint64          P3DPlantModel::ComputeHash
+                                      () const
+ {
+  P3DHash                              Hash;
+
+  Hash.AddUInt(BaseSeed);
+  Hash.AddUInt(Flags);
+  Hash.AddUInt64(PlantBase->ComputeHash());
+
+  return(Hash.GetValue());
+ }
+
 static void        AutoGenerateBGroupNames
                                       (P3DPlantModel      *PlantModel)
  {
@@ -41,6 +41,7 @@
 #include <ngpcore/p3dplant.h>
 #include <ngpcore/p3dconststr.h>
 #include <ngpcore/p3diostream.h>
+#include <ngpcore/p3dhash.h>
 
 extern const char *P3D_LOCAL_TEXTURES_PATH;
 
@@ -81,6 +82,8 @@ class P3DVisRangeState
                                        const P3DFileVersion
                                                           *Version);
 
+  void             UpdateHash         (P3DHash            *Hash) const;
+
   private          :
 
   bool             Enabled;
@@ -107,6 +110,8 @@ class P3D_DLL_ENTRY P3DMaterialDef
                                        const P3DFileVersion
                                                           *Version);
 
+  void             UpdateHash         (P3DHash            *Hash) const;
+
   void             GetColor           (float              *R,
                                        float              *G,
                                        float              *B) const;
@@ -223,6 +228,12 @@ class P3DStemModelInstance
                                        unsigned int        Attr,
                                        unsigned int        Index) const = 0;
 
+  /* fill Buffer with values of all GetVAttrCountI() vertices. Generic */
+  /* implementation - calls GetVAttrValueI for each vertex, can be     */
+  /* overrided by models, which can avoid per-vertex index decoding    */
+  virtual void     FillVAttrBufferI   (float              *Buffer,
+                                       unsigned int        Attr) const;
+
   /* Bound-box information */
 
   /* generic implementation - do not take into account billboard mode, */
@@ -314,6 +325,9 @@ class P3DStemModel
                                                           *SourceStream,
                                        const P3DFileVersion
                                                           *Version) = 0;
+
+  /* Must cover all parameters which affect generated geometry */
+  virtual void     UpdateHash         (P3DHash            *Hash) const = 0;
  };
 
 class P3DBranchingFactory
@@ -347,6 +361,9 @@ class P3DBranchingAlg
                                                           *SourceStream,
                                        const P3DFileVersion
                                                           *Version) = 0;
+
+  /* Must cover all parameters which affect generated geometry */
+  virtual void     UpdateHash         (P3DHash            *Hash) const = 0;
  };
 
 #define P3DBranchModelSubBranchMaxCount (8)
@@ -407,6 +424,9 @@ class P3DBranchModel
                                        const P3DFileVersion
                                                           *Version);
 
+  /* Hash of branch and all its sub-branches. Names are not included */
+  P3Duint64        ComputeHash        () const;
+
   private          :
 
   char                                *Name;
@@ -499,6 +519,9 @@ class P3D_DLL_ENTRY P3DPlantModel
                                                           *SourceStream,
                                        P3DMaterialFactory *MaterialFactory);
 
+  /* Stable content hash (meta info and branch names are not included) */
+  P3Duint64        ComputeHash        () const;
+
   static const P3DBranchModel
                   *GetBranchModelByIndex
                                       (const P3DPlantModel*Model,
@@ -29,6 +29,8 @@
 
 ***************************************************************************/
 
+#include <string.h>
+
 #include <ngpcore/p3dmodel.h>
 
 #include <ngpcore/p3dbalgbase.h>
@@ -325,7 +327,14 @@ void               P3DStemModelGMeshInstance::GetAxisOrientationAt
                    P3DStemModelGMesh::P3DStemModelGMesh
                                       ()
  {
-  MeshData = 0;
+  MeshData    = 0;
+  StorageMode = P3DGMeshStorageBase64;
+ }
+
+                   P3DStemModelGMesh::~P3DStemModelGMesh
+                                      ()
+ {
+  delete MeshData;
  }
 
 P3DStemModelInstance
@@ -413,6 +422,8 @@ P3DStemModel      *P3DStemModelGMesh::CreateCopy
 
   Result = new P3DStemModelGMesh();
 
+  Result->SetStorageMode(StorageMode);
+
   if (MeshData != 0)
    {
     Result->SetMeshData(MeshData->CreateCopy());
@@ -760,37 +771,507 @@ static void        LoadVAttrI         (P3DInputStringFmtStream
    }
  }
 
-void               P3DStemModelGMesh::Save
-                                      (P3DOutputStringStream
-                                                          *TargetStream) const
+static void        SaveDataText       (P3DOutputStringFmtStream
+                                                          *FmtStream,
+                                       const P3DGMeshData *MeshData)
  {
-  P3DOutputStringFmtStream             FmtStream(TargetStream);
   unsigned int                         PrimitiveIndex;
   unsigned int                         PrimitiveCount;
   const unsigned int                  *PrimitiveBuffer;
   const unsigned int                  *IndexBuffer[P3D_GMESH_MAX_ATTRS];
 
+  PrimitiveCount = MeshData->GetPrimitiveCount();
+
+  SaveVAttr(FmtStream,MeshData,P3D_ATTR_VERTEX,"Vertex");
+  SaveVAttr(FmtStream,MeshData,P3D_ATTR_NORMAL,"Normal");
+  SaveVAttr(FmtStream,MeshData,P3D_ATTR_TEXCOORD0,"TexCoord0");
+  SaveVAttr(FmtStream,MeshData,P3D_ATTR_TANGENT,"Tangent");
+  SaveVAttr(FmtStream,MeshData,P3D_ATTR_BINORMAL,"Binormal");
+
+  PrimitiveBuffer = MeshData->GetPrimitiveBuffer();
+
+  IndexBuffer[P3D_ATTR_VERTEX]    = MeshData->GetIndexBuffer(P3D_ATTR_VERTEX);
+  IndexBuffer[P3D_ATTR_NORMAL]    = MeshData->GetIndexBuffer(P3D_ATTR_NORMAL);
+  IndexBuffer[P3D_ATTR_TEXCOORD0] = MeshData->GetIndexBuffer(P3D_ATTR_TEXCOORD0);
+  IndexBuffer[P3D_ATTR_TANGENT]   = MeshData->GetIndexBuffer(P3D_ATTR_TANGENT);
+  IndexBuffer[P3D_ATTR_BINORMAL]  = MeshData->GetIndexBuffer(P3D_ATTR_BINORMAL);
+
+  for (PrimitiveIndex = 0; PrimitiveIndex < PrimitiveCount; PrimitiveIndex++)
+   {
+    FmtStream->WriteString("su","PrimType",PrimitiveBuffer[PrimitiveIndex]);
+
+    FmtStream->WriteString("suuuuu","PrimVert",IndexBuffer[P3D_ATTR_VERTEX][0],
+                                               IndexBuffer[P3D_ATTR_NORMAL][0],
+                                               IndexBuffer[P3D_ATTR_TEXCOORD0][0],
+                                               IndexBuffer[P3D_ATTR_TANGENT][0],
+                                               IndexBuffer[P3D_ATTR_BINORMAL][0]);
+
+    FmtStream->WriteString("suuuuu","PrimVert",IndexBuffer[P3D_ATTR_VERTEX][1],
+                                               IndexBuffer[P3D_ATTR_NORMAL][1],
+                                               IndexBuffer[P3D_ATTR_TEXCOORD0][1],
+                                               IndexBuffer[P3D_ATTR_TANGENT][1],
+                                               IndexBuffer[P3D_ATTR_BINORMAL][1]);
+
+    FmtStream->WriteString("suuuuu","PrimVert",IndexBuffer[P3D_ATTR_VERTEX][2],
+                                               IndexBuffer[P3D_ATTR_NORMAL][2],
+                                               IndexBuffer[P3D_ATTR_TEXCOORD0][2],
+                                               IndexBuffer[P3D_ATTR_TANGENT][2],
+                                               IndexBuffer[P3D_ATTR_BINORMAL][2]);
+
+    if (PrimitiveBuffer[PrimitiveIndex] == P3D_QUAD)
+     {
+      FmtStream->WriteString("suuuuu","PrimVert",IndexBuffer[P3D_ATTR_VERTEX][3],
+                                                 IndexBuffer[P3D_ATTR_NORMAL][3],
+                                                 IndexBuffer[P3D_ATTR_TEXCOORD0][3],
+                                                 IndexBuffer[P3D_ATTR_TANGENT][3],
+                                                 IndexBuffer[P3D_ATTR_BINORMAL][3]);
+
+      IndexBuffer[P3D_ATTR_VERTEX]    += 4;
+      IndexBuffer[P3D_ATTR_NORMAL]    += 4;
+      IndexBuffer[P3D_ATTR_TEXCOORD0] += 4;
+      IndexBuffer[P3D_ATTR_TANGENT]   += 4;
+      IndexBuffer[P3D_ATTR_BINORMAL]  += 4;
+     }
+    else
+     {
+      IndexBuffer[P3D_ATTR_VERTEX]    += 3;
+      IndexBuffer[P3D_ATTR_NORMAL]    += 3;
+      IndexBuffer[P3D_ATTR_TEXCOORD0] += 3;
+      IndexBuffer[P3D_ATTR_TANGENT]   += 3;
+      IndexBuffer[P3D_ATTR_BINORMAL]  += 3;
+     }
+   }
+
+  SaveVAttrI(FmtStream,MeshData,P3D_ATTR_VERTEX,"Vertex");
+  SaveVAttrI(FmtStream,MeshData,P3D_ATTR_NORMAL,"Normal");
+  SaveVAttrI(FmtStream,MeshData,P3D_ATTR_TEXCOORD0,"TexCoord0");
+  SaveVAttrI(FmtStream,MeshData,P3D_ATTR_TANGENT,"Tangent");
+  SaveVAttrI(FmtStream,MeshData,P3D_ATTR_BINORMAL,"Binormal");
+
+  PrimitiveCount = MeshData->GetIndexCountI() / 3;
+  IndexBuffer[0] = MeshData->GetIndexBufferI();
+
+  for (PrimitiveIndex = 0; PrimitiveIndex < PrimitiveCount; PrimitiveIndex++)
+   {
+    FmtStream->WriteString("suuu","PrimVert",IndexBuffer[0][0],
+                                             IndexBuffer[0][1],
+                                             IndexBuffer[0][2]);
+
+    IndexBuffer[0] += 3;
+   }
+ }
+
+/* Base64 block encoding. All g-mesh arrays consist of 32-bit words (floats */
+/* and unsigned ints), so block is just a sequence of little-endian words   */
+/* split into "Data" lines of fixed size.                                   */
+
+#define P3D_GMESH_B64_LINE_BYTES (576) /* must be a multiple of 3 */
+#define P3D_GMESH_B64_LINE_CHARS (P3D_GMESH_B64_LINE_BYTES / 3 * 4)
+
+static const char  P3DBase64Chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static int         GetBase64Value     (char                Ch)
+ {
+  if      ((Ch >= 'A') && (Ch <= 'Z'))
+   {
+    return(Ch - 'A');
+   }
+  else if ((Ch >= 'a') && (Ch <= 'z'))
+   {
+    return(Ch - 'a' + 26);
+   }
+  else if ((Ch >= '0') && (Ch <= '9'))
+   {
+    return(Ch - '0' + 52);
+   }
+  else if (Ch == '+')
+   {
+    return(62);
+   }
+  else if (Ch == '/')
+   {
+    return(63);
+   }
+  else
+   {
+    return(-1);
+   }
+ }
+
+static void        CopyWordsLE        (unsigned char      *Target,
+                                       const unsigned char*Source,
+                                       unsigned int        WordCount)
+ {
+  #if defined(P3D_BIG_ENDIAN)
+  for (unsigned int WordIndex = 0; WordIndex < WordCount; WordIndex++)
+   {
+    Target[0] = Source[3];
+    Target[1] = Source[2];
+    Target[2] = Source[1];
+    Target[3] = Source[0];
+
+    Target += 4;
+    Source += 4;
+   }
+  #else
+  memcpy(Target,Source,WordCount * 4);
+  #endif
+ }
+
+class P3DGMeshBlockWriter
+ {
+  public           :
+
+                   P3DGMeshBlockWriter(P3DOutputStringFmtStream
+                                                          *FmtStream)
+   {
+    this->FmtStream = FmtStream;
+    this->Size      = 0;
+   }
+
+  void             WriteWords         (const void         *Data,
+                                       unsigned int        WordCount)
+   {
+    const unsigned char               *Source;
+    unsigned int                       ChunkWords;
+
+    Source = (const unsigned char*)Data;
+
+    while (WordCount > 0)
+     {
+      ChunkWords = (P3D_GMESH_B64_LINE_BYTES - Size) / 4;
+
+      if (ChunkWords > WordCount)
+       {
+        ChunkWords = WordCount;
+       }
+
+      CopyWordsLE(&Buffer[Size],Source,ChunkWords);
+
+      Size      += ChunkWords * 4;
+      Source    += ChunkWords * 4;
+      WordCount -= ChunkWords;
+
+      if (Size == P3D_GMESH_B64_LINE_BYTES)
+       {
+        Flush();
+       }
+     }
+   }
+
+  void             Flush              ()
+   {
+    char                               Line[P3D_GMESH_B64_LINE_CHARS + 1];
+    char                              *Target;
+    unsigned int                       Index;
+    unsigned int                       Value;
+
+    if (Size == 0)
+     {
+      return;
+     }
+
+    Target = Line;
+
+    for (Index = 0; Index < Size; Index += 3)
+     {
+      Value = Buffer[Index] << 16;
+
+      if (Index + 1 < Size) Value |= Buffer[Index + 1] << 8;
+      if (Index + 2 < Size) Value |= Buffer[Index + 2];
+
+      *Target++ = P3DBase64Chars[(Value >> 18) & 0x3F];
+      *Target++ = P3DBase64Chars[(Value >> 12) & 0x3F];
+      *Target++ = Index + 1 < Size ? P3DBase64Chars[(Value >> 6) & 0x3F] : '=';
+      *Target++ = Index + 2 < Size ? P3DBase64Chars[Value & 0x3F] : '=';
+     }
+
+    *Target = 0;
+
+    FmtStream->WriteString("ss","Data",Line);
+
+    Size = 0;
+   }
+
+  private          :
+
+  P3DOutputStringFmtStream            *FmtStream;
+  unsigned char                        Buffer[P3D_GMESH_B64_LINE_BYTES];
+  unsigned int                         Size;
+ };
+
+class P3DGMeshBlockReader
+ {
+  public           :
+
+                   P3DGMeshBlockReader(P3DInputStringFmtStream
+                                                          *FmtStream)
+   {
+    this->FmtStream = FmtStream;
+    this->Size      = 0;
+    this->Pos       = 0;
+   }
+
+  void             ReadWords          (void               *Data,
+                                       unsigned int        WordCount)
+   {
+    unsigned char                     *Target;
+    unsigned int                       ChunkWords;
+
+    Target = (unsigned char*)Data;
+
+    while (WordCount > 0)
+     {
+      if (Pos == Size)
+       {
+        ReadLine();
+       }
+
+      ChunkWords = (Size - Pos) / 4;
+
+      if (ChunkWords == 0)
+       {
+        throw P3DExceptionGeneric("misaligned g-mesh data block");
+       }
+
+      if (ChunkWords > WordCount)
+       {
+        ChunkWords = WordCount;
+       }
+
+      CopyWordsLE(Target,&Buffer[Pos],ChunkWords);
+
+      Pos       += ChunkWords * 4;
+      Target    += ChunkWords * 4;
+      WordCount -= ChunkWords;
+     }
+   }
+
+  bool             IsConsumed         () const
+   {
+    return(Pos == Size);
+   }
+
+  private          :
+
+  void             ReadLine           ()
+   {
+    char                               Line[P3D_GMESH_B64_LINE_CHARS + 1];
+    unsigned int                       Length;
+    unsigned int                       Index;
+    int                                Values[4];
+    unsigned int                       ValueIndex;
+
+    FmtStream->ReadFmtStringTagged("Data","s",Line,(unsigned int)sizeof(Line));
+
+    Length = strlen(Line);
+
+    if ((Length == 0) || ((Length % 4) != 0))
+     {
+      throw P3DExceptionGeneric("invalid g-mesh data block line length");
+     }
+
+    Size = 0;
+    Pos  = 0;
+
+    for (Index = 0; Index < Length; Index += 4)
+     {
+      for (ValueIndex = 0; ValueIndex < 4; ValueIndex++)
+       {
+        Values[ValueIndex] = GetBase64Value(Line[Index + ValueIndex]);
+       }
+
+      if ((Values[0] < 0) || (Values[1] < 0))
+       {
+        throw P3DExceptionGeneric("invalid character in g-mesh data block");
+       }
+
+      Buffer[Size++] = (unsigned char)((Values[0] << 2) | (Values[1] >> 4));
+
+      if (Line[Index + 2] != '=')
+       {
+        if (Values[2] < 0)
+         {
+          throw P3DExceptionGeneric("invalid character in g-mesh data block");
+         }
+
+        Buffer[Size++] = (unsigned char)(((Values[1] & 0x0F) << 4) | (Values[2] >> 2));
+
+        if (Line[Index + 3] != '=')
+         {
+          if (Values[3] < 0)
+           {
+            throw P3DExceptionGeneric("invalid character in g-mesh data block");
+           }
+
+          Buffer[Size++] = (unsigned char)(((Values[2] & 0x03) << 6) | Values[3]);
+         }
+       }
+     }
+   }
+
+  P3DInputStringFmtStream             *FmtStream;
+  unsigned char                        Buffer[P3D_GMESH_B64_LINE_BYTES];
+  unsigned int                         Size;
+  unsigned int                         Pos;
+ };
+
+static unsigned int GetVAttrComponentCount
+                                      (unsigned int        Attr)
+ {
+  return(Attr == P3D_ATTR_TEXCOORD0 ? 2 : 3);
+ }
+
+static unsigned int CalcDataBlockWordCount
+                                      (unsigned int        PrimitiveCount,
+                                       unsigned int        IndexCount,
+                                       unsigned int        VAttrCountI,
+                                       unsigned int        IndexCountI,
+                                       const unsigned int *VAttrCounts)
+ {
+  unsigned int                         Result;
+  unsigned int                         Attr;
+
+  Result = PrimitiveCount + IndexCountI;
+
+  for (Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    Result += VAttrCounts[Attr] * GetVAttrComponentCount(Attr);
+    Result += IndexCount;
+    Result += VAttrCountI * GetVAttrComponentCount(Attr);
+   }
+
+  return(Result);
+ }
+
+static void        SaveDataBase64     (P3DOutputStringFmtStream
+                                                          *FmtStream,
+                                       const P3DGMeshData *MeshData)
+ {
+  P3DGMeshBlockWriter                  Writer(FmtStream);
+  unsigned int                         VAttrCounts[P3D_GMESH_MAX_ATTRS];
+  unsigned int                         Attr;
+
+  for (Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    VAttrCounts[Attr] = MeshData->GetVAttrCount(Attr);
+   }
+
+  FmtStream->WriteString("su","DataSize",
+                         CalcDataBlockWordCount(MeshData->GetPrimitiveCount(),
+                                                MeshData->GetIndexCount(),
+                                                MeshData->GetVAttrCountI(),
+                                                MeshData->GetIndexCountI(),
+                                                VAttrCounts) * 4);
+
+  for (Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    Writer.WriteWords(MeshData->GetVAttrBuffer(Attr),
+                      VAttrCounts[Attr] * GetVAttrComponentCount(Attr));
+   }
+
+  Writer.WriteWords(MeshData->GetPrimitiveBuffer(),MeshData->GetPrimitiveCount());
+
+  for (Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    Writer.WriteWords(MeshData->GetIndexBuffer(Attr),MeshData->GetIndexCount());
+   }
+
+  for (Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    Writer.WriteWords(MeshData->GetVAttrBufferI(Attr),
+                      MeshData->GetVAttrCountI() * GetVAttrComponentCount(Attr));
+   }
+
+  Writer.WriteWords(MeshData->GetIndexBufferI(),MeshData->GetIndexCountI());
+
+  Writer.Flush();
+ }
+
+void               P3DStemModelGMesh::Save
+                                      (P3DOutputStringStream
+                                                          *TargetStream) const
+ {
+  P3DOutputStringFmtStream             FmtStream(TargetStream);
+
   FmtStream.WriteString("ss","StemModel","GMesh");
 
+  /* text-encoded data is written without encoding tag to stay 0.14-compatible */
+  if (StorageMode == P3DGMeshStorageBase64)
+   {
+    FmtStream.WriteString("ss","Encoding","Base64");
+   }
+
   FmtStream.WriteString("su","VAttrVertexCount",MeshData->GetVAttrCount(P3D_ATTR_VERTEX));
   FmtStream.WriteString("su","VAttrNormalCount",MeshData->GetVAttrCount(P3D_ATTR_NORMAL));
   FmtStream.WriteString("su","VAttrTexCoord0Count",MeshData->GetVAttrCount(P3D_ATTR_TEXCOORD0));
   FmtStream.WriteString("su","VAttrTangentCount",MeshData->GetVAttrCount(P3D_ATTR_TANGENT));
   FmtStream.WriteString("su","VAttrBinormalCount",MeshData->GetVAttrCount(P3D_ATTR_BINORMAL));
 
-  PrimitiveCount = MeshData->GetPrimitiveCount();
-
-  FmtStream.WriteString("su","PrimitiveCount",PrimitiveCount);
+  FmtStream.WriteString("su","PrimitiveCount",MeshData->GetPrimitiveCount());
   FmtStream.WriteString("su","IndexCount",MeshData->GetIndexCount());
 
   FmtStream.WriteString("su","VAttrCountI",MeshData->GetVAttrCountI());
   FmtStream.WriteString("su","IndexCountI",MeshData->GetIndexCountI());
 
-  SaveVAttr(&FmtStream,MeshData,P3D_ATTR_VERTEX,"Vertex");
-  SaveVAttr(&FmtStream,MeshData,P3D_ATTR_NORMAL,"Normal");
-  SaveVAttr(&FmtStream,MeshData,P3D_ATTR_TEXCOORD0,"TexCoord0");
-  SaveVAttr(&FmtStream,MeshData,P3D_ATTR_TANGENT,"Tangent");
-  SaveVAttr(&FmtStream,MeshData,P3D_ATTR_BINORMAL,"Binormal");
+  if (StorageMode == P3DGMeshStorageBase64)
+   {
+    SaveDataBase64(&FmtStream,MeshData);
+   }
+  else
+   {
+    SaveDataText(&FmtStream,MeshData);
+   }
+ }
+
+void               P3DStemModelGMesh::UpdateHash
+                                      (P3DHash            *Hash) const
+ {
+  unsigned int                         Attr;
+
+  Hash->AddString("GMesh");
+
+  for (Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    Hash->AddFloatArray(MeshData->GetVAttrBuffer(Attr),
+                        MeshData->GetVAttrCount(Attr) * GetVAttrComponentCount(Attr));
+   }
+
+  Hash->AddUIntArray(MeshData->GetPrimitiveBuffer(),MeshData->GetPrimitiveCount());
+
+  for (Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    Hash->AddUIntArray(MeshData->GetIndexBuffer(Attr),MeshData->GetIndexCount());
+   }
+
+  for (Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    Hash->AddFloatArray(MeshData->GetVAttrBufferI(Attr),
+                        MeshData->GetVAttrCountI() * GetVAttrComponentCount(Attr));
+   }
+
+  Hash->AddUIntArray(MeshData->GetIndexBufferI(),MeshData->GetIndexCountI());
+ }
+
+static void        LoadDataText       (P3DInputStringFmtStream
+                                                          *FmtStream,
+                                       P3DGMeshData       *MeshData)
+ {
+  unsigned int                         PrimitiveIndex;
+  unsigned int                         PrimitiveCount;
+  unsigned int                         IndexCount;
+  unsigned int                         IndexCounter;
+  unsigned int                        *PrimitiveBuffer;
+  unsigned int                        *IndexBuffer[P3D_GMESH_MAX_ATTRS];
+
+  PrimitiveCount = MeshData->GetPrimitiveCount();
+  IndexCount     = MeshData->GetIndexCount();
+
+  LoadVAttr(FmtStream,MeshData,P3D_ATTR_VERTEX,"Vertex");
+  LoadVAttr(FmtStream,MeshData,P3D_ATTR_NORMAL,"Normal");
+  LoadVAttr(FmtStream,MeshData,P3D_ATTR_TEXCOORD0,"TexCoord0");
+  LoadVAttr(FmtStream,MeshData,P3D_ATTR_TANGENT,"Tangent");
+  LoadVAttr(FmtStream,MeshData,P3D_ATTR_BINORMAL,"Binormal");
 
   PrimitiveBuffer = MeshData->GetPrimitiveBuffer();
 
@@ -800,35 +1281,59 @@ void               P3DStemModelGMesh::Save
   IndexBuffer[P3D_ATTR_TANGENT]   = MeshData->GetIndexBuffer(P3D_ATTR_TANGENT);
   IndexBuffer[P3D_ATTR_BINORMAL]  = MeshData->GetIndexBuffer(P3D_ATTR_BINORMAL);
 
+  IndexCounter = 0;
+
   for (PrimitiveIndex = 0; PrimitiveIndex < PrimitiveCount; PrimitiveIndex++)
    {
-    FmtStream.WriteString("su","PrimType",PrimitiveBuffer[PrimitiveIndex]);
+    FmtStream->ReadFmtStringTagged("PrimType","u",&PrimitiveBuffer[PrimitiveIndex]);
 
-    FmtStream.WriteString("suuuuu","PrimVert",IndexBuffer[P3D_ATTR_VERTEX][0],
-                                              IndexBuffer[P3D_ATTR_NORMAL][0],
-                                              IndexBuffer[P3D_ATTR_TEXCOORD0][0],
-                                              IndexBuffer[P3D_ATTR_TANGENT][0],
-                                              IndexBuffer[P3D_ATTR_BINORMAL][0]);
+    if      (PrimitiveBuffer[PrimitiveIndex] == P3D_TRIANGLE)
+     {
+      IndexCounter += 3;
+     }
+    else if (PrimitiveBuffer[PrimitiveIndex] == P3D_QUAD)
+     {
+      IndexCounter += 4;
+     }
+    else
+     {
+      throw P3DExceptionGeneric("invalid primitive type in g-mesh data");
+     }
 
-    FmtStream.WriteString("suuuuu","PrimVert",IndexBuffer[P3D_ATTR_VERTEX][1],
-                                              IndexBuffer[P3D_ATTR_NORMAL][1],
-                                              IndexBuffer[P3D_ATTR_TEXCOORD0][1],
-                                              IndexBuffer[P3D_ATTR_TANGENT][1],
-                                              IndexBuffer[P3D_ATTR_BINORMAL][1]);
+    if (IndexCounter > IndexCount)
+     {
+      throw P3DExceptionGeneric("primitive types/index count inconsistency found in g-mesh data");
+     }
 
-    FmtStream.WriteString("suuuuu","PrimVert",IndexBuffer[P3D_ATTR_VERTEX][2],
-                                              IndexBuffer[P3D_ATTR_NORMAL][2],
-                                              IndexBuffer[P3D_ATTR_TEXCOORD0][2],
-                                              IndexBuffer[P3D_ATTR_TANGENT][2],
-                                              IndexBuffer[P3D_ATTR_BINORMAL][2]);
+    FmtStream->ReadFmtStringTagged("PrimVert","uuuuu",
+                                   &IndexBuffer[P3D_ATTR_VERTEX][0],
+                                   &IndexBuffer[P3D_ATTR_NORMAL][0],
+                                   &IndexBuffer[P3D_ATTR_TEXCOORD0][0],
+                                   &IndexBuffer[P3D_ATTR_TANGENT][0],
+                                   &IndexBuffer[P3D_ATTR_BINORMAL][0]);
+
+    FmtStream->ReadFmtStringTagged("PrimVert","uuuuu",
+                                   &IndexBuffer[P3D_ATTR_VERTEX][1],
+                                   &IndexBuffer[P3D_ATTR_NORMAL][1],
+                                   &IndexBuffer[P3D_ATTR_TEXCOORD0][1],
+                                   &IndexBuffer[P3D_ATTR_TANGENT][1],
+                                   &IndexBuffer[P3D_ATTR_BINORMAL][1]);
+
+    FmtStream->ReadFmtStringTagged("PrimVert","uuuuu",
+                                   &IndexBuffer[P3D_ATTR_VERTEX][2],
+                                   &IndexBuffer[P3D_ATTR_NORMAL][2],
+                                   &IndexBuffer[P3D_ATTR_TEXCOORD0][2],
+                                   &IndexBuffer[P3D_ATTR_TANGENT][2],
+                                   &IndexBuffer[P3D_ATTR_BINORMAL][2]);
 
     if (PrimitiveBuffer[PrimitiveIndex] == P3D_QUAD)
      {
-      FmtStream.WriteString("suuuuu","PrimVert",IndexBuffer[P3D_ATTR_VERTEX][3],
-                                                IndexBuffer[P3D_ATTR_NORMAL][3],
-                                                IndexBuffer[P3D_ATTR_TEXCOORD0][3],
-                                                IndexBuffer[P3D_ATTR_TANGENT][3],
-                                                IndexBuffer[P3D_ATTR_BINORMAL][3]);
+      FmtStream->ReadFmtStringTagged("PrimVert","uuuuu",
+                                     &IndexBuffer[P3D_ATTR_VERTEX][3],
+                                     &IndexBuffer[P3D_ATTR_NORMAL][3],
+                                     &IndexBuffer[P3D_ATTR_TEXCOORD0][3],
+                                     &IndexBuffer[P3D_ATTR_TANGENT][3],
+                                     &IndexBuffer[P3D_ATTR_BINORMAL][3]);
 
       IndexBuffer[P3D_ATTR_VERTEX]    += 4;
       IndexBuffer[P3D_ATTR_NORMAL]    += 4;
@@ -846,46 +1351,142 @@ void               P3DStemModelGMesh::Save
      }
    }
 
-  SaveVAttrI(&FmtStream,MeshData,P3D_ATTR_VERTEX,"Vertex");
-  SaveVAttrI(&FmtStream,MeshData,P3D_ATTR_NORMAL,"Normal");
-  SaveVAttrI(&FmtStream,MeshData,P3D_ATTR_TEXCOORD0,"TexCoord0");
-  SaveVAttrI(&FmtStream,MeshData,P3D_ATTR_TANGENT,"Tangent");
-  SaveVAttrI(&FmtStream,MeshData,P3D_ATTR_BINORMAL,"Binormal");
+  LoadVAttrI(FmtStream,MeshData,P3D_ATTR_VERTEX,"Vertex");
+  LoadVAttrI(FmtStream,MeshData,P3D_ATTR_NORMAL,"Normal");
+  LoadVAttrI(FmtStream,MeshData,P3D_ATTR_TEXCOORD0,"TexCoord0");
+  LoadVAttrI(FmtStream,MeshData,P3D_ATTR_TANGENT,"Tangent");
+  LoadVAttrI(FmtStream,MeshData,P3D_ATTR_BINORMAL,"Binormal");
 
   PrimitiveCount = MeshData->GetIndexCountI() / 3;
   IndexBuffer[0] = MeshData->GetIndexBufferI();
 
   for (PrimitiveIndex = 0; PrimitiveIndex < PrimitiveCount; PrimitiveIndex++)
    {
-    FmtStream.WriteString("suuu","PrimVert",IndexBuffer[0][0],
-                                            IndexBuffer[0][1],
-                                            IndexBuffer[0][2]);
+    FmtStream->ReadFmtStringTagged("PrimVert","uuu",
+                                   &IndexBuffer[0][0],
+                                   &IndexBuffer[0][1],
+                                   &IndexBuffer[0][2]);
 
     IndexBuffer[0] += 3;
    }
  }
 
+static void        LoadDataBase64     (P3DInputStringFmtStream
+                                                          *FmtStream,
+                                       P3DGMeshData       *MeshData)
+ {
+  P3DGMeshBlockReader                  Reader(FmtStream);
+  unsigned int                         VAttrCounts[P3D_GMESH_MAX_ATTRS];
+  unsigned int                         Attr;
+  unsigned int                         DataSize;
+  unsigned int                         PrimitiveIndex;
+  unsigned int                         PrimitiveCount;
+  unsigned int                         IndexCounter;
+  const unsigned int                  *PrimitiveBuffer;
+
+  for (Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    VAttrCounts[Attr] = MeshData->GetVAttrCount(Attr);
+   }
+
+  FmtStream->ReadFmtStringTagged("DataSize","u",&DataSize);
+
+  if (DataSize != CalcDataBlockWordCount(MeshData->GetPrimitiveCount(),
+                                         MeshData->GetIndexCount(),
+                                         MeshData->GetVAttrCountI(),
+                                         MeshData->GetIndexCountI(),
+                                         VAttrCounts) * 4)
+   {
+    throw P3DExceptionGeneric("g-mesh data block size mismatch");
+   }
+
+  for (Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    Reader.ReadWords(MeshData->GetVAttrBuffer(Attr),
+                     VAttrCounts[Attr] * GetVAttrComponentCount(Attr));
+   }
+
+  Reader.ReadWords(MeshData->GetPrimitiveBuffer(),MeshData->GetPrimitiveCount());
+
+  PrimitiveCount  = MeshData->GetPrimitiveCount();
+  PrimitiveBuffer = MeshData->GetPrimitiveBuffer();
+  IndexCounter    = 0;
+
+  for (PrimitiveIndex = 0; PrimitiveIndex < PrimitiveCount; PrimitiveIndex++)
+   {
+    if      (PrimitiveBuffer[PrimitiveIndex] == P3D_TRIANGLE)
+     {
+      IndexCounter += 3;
+     }
+    else if (PrimitiveBuffer[PrimitiveIndex] == P3D_QUAD)
+     {
+      IndexCounter += 4;
+     }
+    else
+     {
+      throw P3DExceptionGeneric("invalid primitive type in g-mesh data");
+     }
+   }
+
+  if (IndexCounter > MeshData->GetIndexCount())
+   {
+    throw P3DExceptionGeneric("primitive types/index count inconsistency found in g-mesh data");
+   }
+
+  for (Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    Reader.ReadWords(MeshData->GetIndexBuffer(Attr),MeshData->GetIndexCount());
+   }
+
+  for (Attr = 0; Attr < P3D_GMESH_MAX_ATTRS; Attr++)
+   {
+    Reader.ReadWords(MeshData->GetVAttrBufferI(Attr),
+                     MeshData->GetVAttrCountI() * GetVAttrComponentCount(Attr));
+   }
+
+  Reader.ReadWords(MeshData->GetIndexBufferI(),MeshData->GetIndexCountI());
+
+  if (!Reader.IsConsumed())
+   {
+    throw P3DExceptionGeneric("extra data found in g-mesh data block");
+   }
+ }
+
 void               P3DStemModelGMesh::Load
                                       (P3DInputStringFmtStream
                                                           *SourceStream,
                                        const P3DFileVersion
-                                                          *Version P3D_UNUSED_ATTR)
+                                                          *Version)
  {
   P3DGMeshData                        *NewMeshData;
   unsigned int                         VAttrCounts[P3D_GMESH_MAX_ATTRS];
-  unsigned int                         PrimitiveIndex;
   unsigned int                         PrimitiveCount;
   unsigned int                         IndexCount;
   unsigned int                         VAttrCountI;
   unsigned int                         IndexCountI;
-  unsigned int                         IndexCounter;
-  unsigned int                        *PrimitiveBuffer;
-  unsigned int                        *IndexBuffer[P3D_GMESH_MAX_ATTRS];
+  unsigned int                         NewStorageMode;
+  char                                 EncodingName[64];
 
-  NewMeshData = 0;
+  NewMeshData    = 0;
+  NewStorageMode = P3DGMeshStorageText;
 
   try
    {
+    if (((Version->Major > 0) || (Version->Minor > 14)) &&
+        (SourceStream->IsNextStringTagged("Encoding")))
+     {
+      SourceStream->ReadFmtStringTagged("Encoding","s",EncodingName,sizeof(EncodingName));
+
+      if      (strcmp(EncodingName,"Base64") == 0)
+       {
+        NewStorageMode = P3DGMeshStorageBase64;
+       }
+      else if (strcmp(EncodingName,"Text") != 0)
+       {
+        throw P3DExceptionGeneric("unsupported g-mesh data encoding");
+       }
+     }
+
     SourceStream->ReadFmtStringTagged("VAttrVertexCount","u",&VAttrCounts[P3D_ATTR_VERTEX]);
     SourceStream->ReadFmtStringTagged("VAttrNormalCount","u",&VAttrCounts[P3D_ATTR_NORMAL]);
     SourceStream->ReadFmtStringTagged("VAttrTexCoord0Count","u",&VAttrCounts[P3D_ATTR_TEXCOORD0]);
@@ -919,107 +1520,13 @@ void               P3DStemModelGMesh::Load
 
     NewMeshData = new P3DGMeshData(VAttrCounts,PrimitiveCount,IndexCount,VAttrCountI,IndexCountI);
 
-    LoadVAttr(SourceStream,NewMeshData,P3D_ATTR_VERTEX,"Vertex");
-    LoadVAttr(SourceStream,NewMeshData,P3D_ATTR_NORMAL,"Normal");
-    LoadVAttr(SourceStream,NewMeshData,P3D_ATTR_TEXCOORD0,"TexCoord0");
-    LoadVAttr(SourceStream,NewMeshData,P3D_ATTR_TANGENT,"Tangent");
-    LoadVAttr(SourceStream,NewMeshData,P3D_ATTR_BINORMAL,"Binormal");
-
-    PrimitiveBuffer = NewMeshData->GetPrimitiveBuffer();
-
-    IndexBuffer[P3D_ATTR_VERTEX]    = NewMeshData->GetIndexBuffer(P3D_ATTR_VERTEX);
-    IndexBuffer[P3D_ATTR_NORMAL]    = NewMeshData->GetIndexBuffer(P3D_ATTR_NORMAL);
-    IndexBuffer[P3D_ATTR_TEXCOORD0] = NewMeshData->GetIndexBuffer(P3D_ATTR_TEXCOORD0);
-    IndexBuffer[P3D_ATTR_TANGENT]   = NewMeshData->GetIndexBuffer(P3D_ATTR_TANGENT);
-    IndexBuffer[P3D_ATTR_BINORMAL]  = NewMeshData->GetIndexBuffer(P3D_ATTR_BINORMAL);
-
-    IndexCounter = 0;
-
-    for (PrimitiveIndex = 0; PrimitiveIndex < PrimitiveCount; PrimitiveIndex++)
+    if (NewStorageMode == P3DGMeshStorageBase64)
      {
-      SourceStream->ReadFmtStringTagged("PrimType","u",&PrimitiveBuffer[PrimitiveIndex]);
-
-      if      (PrimitiveBuffer[PrimitiveIndex] == P3D_TRIANGLE)
-       {
-        IndexCounter += 3;
-       }
-      else if (PrimitiveBuffer[PrimitiveIndex] == P3D_QUAD)
-       {
-        IndexCounter += 4;
-       }
-      else
-       {
-        throw P3DExceptionGeneric("invalid primitive type in g-mesh data");
-       }
-
-      if (IndexCounter > IndexCount)
-       {
-        throw P3DExceptionGeneric("primitive types/index count inconsistency found in g-mesh data");
-       }
-
-      SourceStream->ReadFmtStringTagged("PrimVert","uuuuu",
-                                        &IndexBuffer[P3D_ATTR_VERTEX][0],
-                                        &IndexBuffer[P3D_ATTR_NORMAL][0],
-                                        &IndexBuffer[P3D_ATTR_TEXCOORD0][0],
-                                        &IndexBuffer[P3D_ATTR_TANGENT][0],
-                                        &IndexBuffer[P3D_ATTR_BINORMAL][0]);
-
-      SourceStream->ReadFmtStringTagged("PrimVert","uuuuu",
-                                        &IndexBuffer[P3D_ATTR_VERTEX][1],
-                                        &IndexBuffer[P3D_ATTR_NORMAL][1],
-                                        &IndexBuffer[P3D_ATTR_TEXCOORD0][1],
-                                        &IndexBuffer[P3D_ATTR_TANGENT][1],
-                                        &IndexBuffer[P3D_ATTR_BINORMAL][1]);
-
-      SourceStream->ReadFmtStringTagged("PrimVert","uuuuu",
-                                        &IndexBuffer[P3D_ATTR_VERTEX][2],
-                                        &IndexBuffer[P3D_ATTR_NORMAL][2],
-                                        &IndexBuffer[P3D_ATTR_TEXCOORD0][2],
-                                        &IndexBuffer[P3D_ATTR_TANGENT][2],
-                                        &IndexBuffer[P3D_ATTR_BINORMAL][2]);
-
-      if (PrimitiveBuffer[PrimitiveIndex] == P3D_QUAD)
-       {
-        SourceStream->ReadFmtStringTagged("PrimVert","uuuuu",
-                                          &IndexBuffer[P3D_ATTR_VERTEX][3],
-                                          &IndexBuffer[P3D_ATTR_NORMAL][3],
-                                          &IndexBuffer[P3D_ATTR_TEXCOORD0][3],
-                                          &IndexBuffer[P3D_ATTR_TANGENT][3],
-                                          &IndexBuffer[P3D_ATTR_BINORMAL][3]);
-
-        IndexBuffer[P3D_ATTR_VERTEX]    += 4;
-        IndexBuffer[P3D_ATTR_NORMAL]    += 4;
-        IndexBuffer[P3D_ATTR_TEXCOORD0] += 4;
-        IndexBuffer[P3D_ATTR_TANGENT]   += 4;
-        IndexBuffer[P3D_ATTR_BINORMAL]  += 4;
-       }
-      else
-       {
-        IndexBuffer[P3D_ATTR_VERTEX]    += 3;
-        IndexBuffer[P3D_ATTR_NORMAL]    += 3;
-        IndexBuffer[P3D_ATTR_TEXCOORD0] += 3;
-        IndexBuffer[P3D_ATTR_TANGENT]   += 3;
-        IndexBuffer[P3D_ATTR_BINORMAL]  += 3;
-       }
+      LoadDataBase64(SourceStream,NewMeshData);
      }
-
-    LoadVAttrI(SourceStream,NewMeshData,P3D_ATTR_VERTEX,"Vertex");
-    LoadVAttrI(SourceStream,NewMeshData,P3D_ATTR_NORMAL,"Normal");
-    LoadVAttrI(SourceStream,NewMeshData,P3D_ATTR_TEXCOORD0,"TexCoord0");
-    LoadVAttrI(SourceStream,NewMeshData,P3D_ATTR_TANGENT,"Tangent");
-    LoadVAttrI(SourceStream,NewMeshData,P3D_ATTR_BINORMAL,"Binormal");
-
-    PrimitiveCount = IndexCountI / 3;
-    IndexBuffer[0] = NewMeshData->GetIndexBufferI();
-
-    for (PrimitiveIndex = 0; PrimitiveIndex < PrimitiveCount; PrimitiveIndex++)
+    else
      {
-      SourceStream->ReadFmtStringTagged("PrimVert","uuu",
-                                        &IndexBuffer[0][0],
-                                        &IndexBuffer[0][1],
-                                        &IndexBuffer[0][2]);
-
-      IndexBuffer[0] += 3;
+      LoadDataText(SourceStream,NewMeshData);
      }
    }
   catch (...)
@@ -1030,6 +1537,8 @@ void               P3DStemModelGMesh::Load
    }
 
   SetMeshData(NewMeshData);
+
+  StorageMode = NewStorageMode;
  }
 
 void               P3DStemModelGMesh::SetMeshData
@@ -1040,3 +1549,16 @@ void               P3DStemModelGMesh::SetMeshData
   this->MeshData = MeshData;
  }
 
+
+unsigned int       P3DStemModelGMesh::GetStorageMode
+                                      () const
+ {
+  return(StorageMode);
+ }
+
+void               P3DStemModelGMesh::SetStorageMode
+                                      (unsigned int        Mode)
+ {
+  StorageMode = Mode;
+ }
+
@@ -36,11 +36,18 @@
 
 #include <ngpcore/p3dgmeshdata.h>
 
+enum
+ {
+  P3DGMeshStorageText,   /* one tagged text line per value (pre-0.15 format) */
+  P3DGMeshStorageBase64  /* raw little-endian arrays in base64-encoded block */
+ };
+
 class P3DStemModelGMesh : public P3DStemModel
  {
   public           :
 
                    P3DStemModelGMesh  ();
+  virtual         ~P3DStemModelGMesh  ();
 
   virtual P3DStemModelInstance
                   *CreateInstance     (P3DMathRNG         *RNG,
@@ -104,8 +111,13 @@ class P3DStemModelGMesh : public P3DStemModel
                                        const P3DFileVersion
                                                           *Version);
 
+  virtual void     UpdateHash         (P3DHash            *Hash) const;
+
   void             SetMeshData        (P3DGMeshData       *MeshData);
 
+  unsigned int     GetStorageMode     () const;
+  void             SetStorageMode     (unsigned int        Mode);
+
   static void      FillIndexArray     (unsigned short     *Target,
                                        const unsigned int *Source,
                                        unsigned int        Count,
@@ -118,6 +130,7 @@ class P3DStemModelGMesh : public P3DStemModel
   private          :
 
   P3DGMeshData    *MeshData;
+  unsigned int     StorageMode;
  };
 
 #endif
@@ -1055,6 +1055,21 @@ void               P3DStemModelQuad::Save
   FmtStream.WriteString("sf","Thickness",Thickness);
  }
 
+void               P3DStemModelQuad::UpdateHash
+                                      (P3DHash            *Hash) const
+ {
+  Hash->AddString("Quad");
+
+  Hash->AddFloat(Length);
+  Hash->AddFloat(Width);
+  Hash->AddFloat(OriginOffsetX);
+  Hash->AddFloat(OriginOffsetY);
+  P3DHashSplineCurve(Hash,&ScalingCurve);
+  Hash->AddUInt(SectionCount);
+  P3DHashSplineCurve(Hash,&Curvature);
+  Hash->AddFloat(Thickness);
+ }
+
 void               P3DStemModelQuad::Load
                                       (P3DInputStringFmtStream
                                                           *SourceStream,
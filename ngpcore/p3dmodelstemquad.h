@@ -104,6 +104,8 @@ class P3DStemModelQuad : public P3DStemModel
                                        const P3DFileVersion
                                                           *Version);
 
+  virtual void     UpdateHash         (P3DHash            *Hash) const;
+
   void             SetLength          (float               Length);
   float            GetLength          () const;
   void             SetWidth           (float               Width);
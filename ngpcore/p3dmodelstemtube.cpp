@@ -46,6 +46,17 @@
 #include <ngpcore/p3dbalgbase.h>
 #include <ngpcore/p3dmodelstemtube.h>
 
+/* cached data layout: per-ring blocks followed by per-profile point blocks */
+#define P3DTubeRingOrientation   (0)
+#define P3DTubeRingAxisPoint     (4)
+#define P3DTubeRingScale         (7)
+#define P3DTubeRingTangent       (8)
+#define P3DTubeRingDataSize      (9)
+
+#define P3DTubeProfilePoint      (0)
+#define P3DTubeProfileNormal     (2)
+#define P3DTubeProfileDataSize   (4)
+
 enum /* These constants are needed for pre-0.9.3 compatibility only */
  {
   P3DPhototropismModePositive,
@@ -84,6 +95,127 @@ enum /* These constants are needed for pre-0.9.3 compatibility only */
   this->UScale = UScale;
   this->VMode  = VMode;
   this->VScale = VScale;
+
+  CachedData = 0;
+ }
+
+                   P3DStemModelTubeInstance::~P3DStemModelTubeInstance
+                                      ()
+ {
+  delete[] CachedData;
+ }
+
+void               P3DStemModelTubeInstance::CalcCachedData
+                                      () const
+ {
+  unsigned int                         AxisResolution;
+  unsigned int                         ProfileResolution;
+  float                               *Data;
+  P3DQuaternionf                       Accumulated;
+
+  AxisResolution    = Axis.GetResolution();
+  ProfileResolution = Profile.GetResolution();
+
+  CachedData = new float[(AxisResolution + 1) * P3DTubeRingDataSize +
+                         ProfileResolution * P3DTubeProfileDataSize];
+
+  /* Same as Axis.GetOrientationAt(SegIndex), but segment orientations */
+  /* product is accumulated from the axis base instead of being        */
+  /* recalculated for every ring                                       */
+  Accumulated.MakeIdentity();
+
+  for (unsigned int SegIndex = 0; SegIndex <= AxisResolution; SegIndex++)
+   {
+    float                             *Orientation;
+
+    Orientation = &CachedData[(AxisResolution - SegIndex) * P3DTubeRingDataSize +
+                              P3DTubeRingOrientation];
+
+    if (SegIndex == 0)
+     {
+      P3DQuaternionf::MakeIdentity(Orientation);
+     }
+    else
+     {
+      const float                     *SegOrientation;
+
+      SegOrientation = Axis.GetSegOrientation(SegIndex - 1);
+
+      if (SegIndex < AxisResolution)
+       {
+        P3DQuaternionf                 Half;
+
+        Half.q[0] = SegOrientation[0];
+        Half.q[1] = SegOrientation[1];
+        Half.q[2] = SegOrientation[2];
+        Half.q[3] = SegOrientation[3];
+
+        P3DQuaternionf::Power(Half.q,0.5f);
+
+        Half.Normalize();
+
+        P3DQuaternionf::CrossProduct(Orientation,Accumulated.q,Half.q);
+
+        P3DQuaternionf::CrossProduct(Half.q,Accumulated.q,SegOrientation);
+
+        Accumulated = Half;
+       }
+      else
+       {
+        Orientation[0] = Accumulated.q[0];
+        Orientation[1] = Accumulated.q[1];
+        Orientation[2] = Accumulated.q[2];
+        Orientation[3] = Accumulated.q[3];
+       }
+     }
+   }
+
+  Data = CachedData;
+
+  for (unsigned int SegIndex = 0; SegIndex <= AxisResolution; SegIndex++)
+   {
+    float                              HeightFraction;
+
+    HeightFraction = ((float)(AxisResolution - SegIndex)) / AxisResolution;
+
+    Axis.GetPointAt(&Data[P3DTubeRingAxisPoint],HeightFraction);
+
+    Data[P3DTubeRingScale]   = ProfileScale.GetScale(HeightFraction);
+    Data[P3DTubeRingTangent] = ProfileScale.GetTangent(HeightFraction);
+
+    Data += P3DTubeRingDataSize;
+   }
+
+  for (unsigned int PointIndex = 0; PointIndex < ProfileResolution; PointIndex++)
+   {
+    Profile.GetPoint(Data[P3DTubeProfilePoint],Data[P3DTubeProfilePoint + 1],PointIndex);
+    Profile.GetNormal(Data[P3DTubeProfileNormal],Data[P3DTubeProfileNormal + 1],PointIndex);
+
+    Data += P3DTubeProfileDataSize;
+   }
+ }
+
+const float       *P3DStemModelTubeInstance::GetRingData
+                                      (unsigned int        SegIndex) const
+ {
+  if (CachedData == 0)
+   {
+    CalcCachedData();
+   }
+
+  return(&CachedData[SegIndex * P3DTubeRingDataSize]);
+ }
+
+const float       *P3DStemModelTubeInstance::GetProfileData
+                                      (unsigned int        PointIndex) const
+ {
+  if (CachedData == 0)
+   {
+    CalcCachedData();
+   }
+
+  return(&CachedData[(Axis.GetResolution() + 1) * P3DTubeRingDataSize +
+                     PointIndex * P3DTubeProfileDataSize]);
  }
 
 unsigned int       P3DStemModelTubeInstance::GetVAttrCount
@@ -135,11 +267,8 @@ void               P3DStemModelTubeInstance::CalcVertexPos
                                        unsigned int        VertexIndex) const
  {
   unsigned int                         SegIndex;
-  float                                HeightFraction;
-  float                                PScale;
-  P3DQuaternionf                       SegOrient;
-  P3DVector3f                          VertexPoint;
-  P3DVector3f                          AxisPoint;
+  const float                         *RingData;
+  const float                         *ProfileData;
 
   SegIndex = VertexIndex / Profile.GetResolution();
 
@@ -152,21 +281,26 @@ void               P3DStemModelTubeInstance::CalcVertexPos
     return;
    }
 
-  Profile.GetPoint(VertexPoint.X(),VertexPoint.Z(),VertexIndex % Profile.GetResolution());
+  RingData    = GetRingData(SegIndex);
+  ProfileData = GetProfileData(VertexIndex % Profile.GetResolution());
 
-  HeightFraction = ((float)(Axis.GetResolution() - SegIndex)) / Axis.GetResolution();
-  PScale         = ProfileScale.GetScale(HeightFraction);
+  CalcVertexPosAt(Pos,RingData,ProfileData);
+ }
 
-  VertexPoint.X() *= PScale;
-  VertexPoint.Y()  = 0.0f;
-  VertexPoint.Z() *= PScale;
+void               P3DStemModelTubeInstance::CalcVertexPosAt
+                                      (float              *Pos,
+                                       const float        *RingData,
+                                       const float        *ProfileData) const
+ {
+  P3DVector3f                          VertexPoint;
 
-  Axis.GetOrientationAt(SegOrient.q,Axis.GetResolution() - SegIndex);
+  VertexPoint.X() = ProfileData[P3DTubeProfilePoint]     * RingData[P3DTubeRingScale];
+  VertexPoint.Y() = 0.0f;
+  VertexPoint.Z() = ProfileData[P3DTubeProfilePoint + 1] * RingData[P3DTubeRingScale];
 
-  P3DQuaternionf::RotateVector(VertexPoint.v,SegOrient.q);
+  P3DQuaternionf::RotateVector(VertexPoint.v,&RingData[P3DTubeRingOrientation]);
 
-  Axis.GetPointAt(AxisPoint.v,HeightFraction);
-  VertexPoint.Add(AxisPoint.v);
+  VertexPoint.Add(&RingData[P3DTubeRingAxisPoint]);
 
   P3DVector3f::MultMatrix(Pos,&WorldTransform,VertexPoint.v);
  }
@@ -176,9 +310,8 @@ void               P3DStemModelTubeInstance::CalcVertexNormal
                                        unsigned int        VertexIndex) const
  {
   unsigned int                         SegIndex;
-  float                                HeightFraction;
-  P3DQuaternionf                       SegOrient;
-  P3DVector3f                          VertexNormal;
+  const float                         *RingData;
+  const float                         *ProfileData;
   P3DMatrix4x4f                        Rotation;
 
   P3DMatrix4x4f::GetRotationOnly(Rotation.m,WorldTransform.m);
@@ -194,16 +327,26 @@ void               P3DStemModelTubeInstance::CalcVertexNormal
     return;
    }
 
-  HeightFraction = ((float)(Axis.GetResolution() - SegIndex)) / Axis.GetResolution();
+  RingData    = GetRingData(SegIndex);
+  ProfileData = GetProfileData(VertexIndex % Profile.GetResolution());
 
-  Axis.GetOrientationAt(SegOrient.q,Axis.GetResolution() - SegIndex);
+  CalcVertexNormalAt(Normal,RingData,ProfileData,&Rotation);
+ }
 
-  Profile.GetNormal(VertexNormal.X(),VertexNormal.Z(),VertexIndex % Profile.GetResolution());
+void               P3DStemModelTubeInstance::CalcVertexNormalAt
+                                      (float              *Normal,
+                                       const float        *RingData,
+                                       const float        *ProfileData,
+                                       const P3DMatrix4x4f*Rotation) const
+ {
+  P3DVector3f                          VertexNormal;
 
-  VertexNormal.Y() = -ProfileScale.GetTangent(HeightFraction);
+  VertexNormal.X() =  ProfileData[P3DTubeProfileNormal];
+  VertexNormal.Y() = -RingData[P3DTubeRingTangent];
+  VertexNormal.Z() =  ProfileData[P3DTubeProfileNormal + 1];
   VertexNormal.Normalize();
-  P3DQuaternionf::RotateVector(VertexNormal.v,SegOrient.q);
-  VertexNormal.MultMatrix(&Rotation);
+  P3DQuaternionf::RotateVector(VertexNormal.v,&RingData[P3DTubeRingOrientation]);
+  VertexNormal.MultMatrix(Rotation);
   VertexNormal.Normalize();
 
   Normal[0] = VertexNormal.X();
@@ -216,7 +359,6 @@ void               P3DStemModelTubeInstance::CalcVertexBiNormal
                                        unsigned int        VertexIndex) const
  {
   unsigned int                         SegIndex;
-  P3DQuaternionf                       SegOrient;
   P3DVector3f                          VertexBiNormal(0.0f,1.0f,0.0f);
   P3DMatrix4x4f                        Rotation;
 
@@ -226,9 +368,8 @@ void               P3DStemModelTubeInstance::CalcVertexBiNormal
 
   if (SegIndex <= Axis.GetResolution())
    {
-    Axis.GetOrientationAt(SegOrient.q,Axis.GetResolution() - SegIndex);
-
-    P3DQuaternionf::RotateVector(VertexBiNormal.v,SegOrient.q);
+    P3DQuaternionf::RotateVector(VertexBiNormal.v,
+                                 &GetRingData(SegIndex)[P3DTubeRingOrientation]);
    }
   else
    {
@@ -262,7 +403,6 @@ void               P3DStemModelTubeInstance::CalcVertexTexCoord
                                        unsigned int        VertexIndex) const
  {
   unsigned int                         SegIndex;
-  float                                HeightFraction;
 
   SegIndex = VertexIndex / (Profile.GetResolution() + 1);
 
@@ -275,6 +415,16 @@ void               P3DStemModelTubeInstance::CalcVertexTexCoord
     return;
    }
 
+  CalcVertexTexCoordAt(TexCoord,SegIndex,VertexIndex % (Profile.GetResolution() + 1));
+ }
+
+void               P3DStemModelTubeInstance::CalcVertexTexCoordAt
+                                      (float              *TexCoord,
+                                       unsigned int        SegIndex,
+                                       unsigned int        PointIndex) const
+ {
+  float                                HeightFraction;
+
   HeightFraction = ((float)(Axis.GetResolution() - SegIndex)) / Axis.GetResolution();
 
   if (VMode == P3DTexCoordModeRelative)
@@ -286,7 +436,7 @@ void               P3DStemModelTubeInstance::CalcVertexTexCoord
     TexCoord[1] = HeightFraction * Axis.GetLength() / Axis.GetResolution() * VScale;
    }
 
-  TexCoord[0] = ((float)(VertexIndex % (Profile.GetResolution() + 1))) / (Profile.GetResolution()) * UScale;
+  TexCoord[0] = ((float)PointIndex) / (Profile.GetResolution()) * UScale;
  }
 
 unsigned int       P3DStemModelTubeInstance::GetVAttrCountI
@@ -338,6 +488,64 @@ void               P3DStemModelTubeInstance::GetVAttrValueI
    }
  }
 
+/* ring and profile data are looked up once per vertex instead of */
+/* decoding them from vertex index                                 */
+void               P3DStemModelTubeInstance::FillVAttrBufferI
+                                      (float              *Buffer,
+                                       unsigned int        Attr) const
+ {
+  unsigned int                         AxisResolution;
+  unsigned int                         ProfileResolution;
+  P3DMatrix4x4f                        Rotation;
+
+  if ((Attr != P3D_ATTR_VERTEX) &&
+      (Attr != P3D_ATTR_NORMAL) &&
+      (Attr != P3D_ATTR_TEXCOORD0))
+   {
+    P3DStemModelInstance::FillVAttrBufferI(Buffer,Attr);
+
+    return;
+   }
+
+  AxisResolution    = Axis.GetResolution();
+  ProfileResolution = Profile.GetResolution();
+
+  P3DMatrix4x4f::GetRotationOnly(Rotation.m,WorldTransform.m);
+
+  for (unsigned int SegIndex = 0; SegIndex <= AxisResolution; SegIndex++)
+   {
+    for (unsigned int PointIndex = 0; PointIndex <= ProfileResolution; PointIndex++)
+     {
+      if (Attr == P3D_ATTR_TEXCOORD0)
+       {
+        CalcVertexTexCoordAt(Buffer,SegIndex,PointIndex);
+
+        Buffer += 2;
+       }
+      else
+       {
+        const float                   *RingData;
+        const float                   *ProfileData;
+
+        /* last vertex of each ring duplicates the first one */
+        RingData    = GetRingData(SegIndex);
+        ProfileData = GetProfileData(PointIndex < ProfileResolution ? PointIndex : 0);
+
+        if (Attr == P3D_ATTR_VERTEX)
+         {
+          CalcVertexPosAt(Buffer,RingData,ProfileData);
+         }
+        else
+         {
+          CalcVertexNormalAt(Buffer,RingData,ProfileData,&Rotation);
+         }
+
+        Buffer += 3;
+       }
+     }
+   }
+ }
+
 unsigned int       P3DStemModelTubeInstance::GetPrimitiveCount
                                       () const
  {
@@ -407,6 +615,10 @@ void               P3DStemModelTubeInstance::SetSegOrientation
                                        float              *Orientation)
  {
   Axis.SetSegOrientation(SegIndex,Orientation);
+
+  delete[] CachedData;
+
+  CachedData = 0;
  }
 
 float              P3DStemModelTubeInstance::GetLengthScaleFactor
@@ -514,7 +726,10 @@ static void        ApplyPhototropismToSegment
     return; // nothing to do, SegmentY already points in DestVector direction
    }
 
-  float Angle = P3DMath::ACosf(CosA);
+  // CosA may slightly exceed -1 because of rounding when SegmentY
+  // points exactly against DestVector
+
+  float Angle = P3DMath::ACosf(P3DMath::Clampf(-1.0f,1.0f,CosA));
 
   P3DVector3f Axis;
 
@@ -1011,6 +1226,30 @@ void               P3DStemModelTube::Save
   FmtStream.WriteString("sf","BaseTexVScale",VScale);
  }
 
+void               P3DStemModelTube::UpdateHash
+                                      (P3DHash            *Hash) const
+ {
+  Hash->AddString("Tube");
+
+  Hash->AddFloat(Length);
+  Hash->AddFloat(LengthV);
+  P3DHashSplineCurve(Hash,&LengthOffsetInfluenceCurve);
+
+  Hash->AddFloat(AxisVariation);
+  Hash->AddUInt(AxisResolution);
+
+  Hash->AddFloat(ProfileScaleBase);
+  P3DHashSplineCurve(Hash,&ProfileScaleCurve);
+  Hash->AddUInt(ProfileResolution);
+
+  P3DHashSplineCurve(Hash,&PhototropismCurve);
+
+  Hash->AddUInt(UMode);
+  Hash->AddFloat(UScale);
+  Hash->AddUInt(VMode);
+  Hash->AddFloat(VScale);
+ }
+
 void               P3DStemModelTube::Load
                                       (P3DInputStringFmtStream
                                                           *SourceStream,
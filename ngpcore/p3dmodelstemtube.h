@@ -60,6 +60,9 @@ class P3DStemModelTubeInstance : public P3DStemModelInstance
                                        float               LengthScaleFactor,
                                        const P3DMatrix4x4f*Transform);
 
+  virtual         ~P3DStemModelTubeInstance
+                                      ();
+
   virtual
   unsigned int     GetVAttrCount      (unsigned int        Attr) const;
   virtual void     GetVAttrValue      (float              *Value,
@@ -78,6 +81,9 @@ class P3DStemModelTubeInstance : public P3DStemModelInstance
                                        unsigned int        Attr,
                                        unsigned int        Index) const;
 
+  virtual void     FillVAttrBufferI   (float              *Buffer,
+                                       unsigned int        Attr) const;
+
   virtual float    GetLength          () const;
   virtual float    GetMinRadiusAt     (float               Offset) const;
   virtual float    GetScale           () const;
@@ -118,6 +124,33 @@ class P3DStemModelTubeInstance : public P3DStemModelInstance
   void             CalcVertexTexCoord (float              *TexCoord,
                                        unsigned int        VertexIndex) const;
 
+  void             CalcVertexPosAt    (float              *Pos,
+                                       const float        *RingData,
+                                       const float        *ProfileData) const;
+
+  void             CalcVertexNormalAt (float              *Normal,
+                                       const float        *RingData,
+                                       const float        *ProfileData,
+                                       const P3DMatrix4x4f*Rotation) const;
+
+  void             CalcVertexTexCoordAt
+                                      (float              *TexCoord,
+                                       unsigned int        SegIndex,
+                                       unsigned int        PointIndex) const;
+
+  /* Axis orientation and position are calculated by walking along all   */
+  /* preceding segments, so they are cached for each cross-section ring, */
+  /* together with profile points, on the first vertex request           */
+  const float     *GetRingData        (unsigned int        SegIndex) const;
+  const float     *GetProfileData     (unsigned int        PointIndex) const;
+  void             CalcCachedData     () const;
+
+                   P3DStemModelTubeInstance
+                                      (const P3DStemModelTubeInstance
+                                                          &);
+  void             operator =         (const P3DStemModelTubeInstance
+                                                          &);
+
   P3DMatrix4x4f                        WorldTransform;
   P3DTubeAxisSegLine                   Axis;
   P3DTubeProfileCircle                 Profile;
@@ -127,6 +160,7 @@ class P3DStemModelTubeInstance : public P3DStemModelInstance
   float                                UScale;
   unsigned int                         VMode;
   float                                VScale;
+  mutable float                       *CachedData;
  };
 
 class P3DStemModelTube : public P3DStemModel
@@ -198,6 +232,8 @@ class P3DStemModelTube : public P3DStemModel
                                        const P3DFileVersion
                                                           *Version);
 
+  virtual void     UpdateHash         (P3DHash            *Hash) const;
+
   void             SetLength          (float               Length);
   float            GetLength          () const;
 
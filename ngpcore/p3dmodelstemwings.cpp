@@ -37,6 +37,17 @@
 #include <ngpcore/p3dmodelstemtube.h>
 #include <ngpcore/p3dmodelstemwings.h>
 
+/* cached data layout: per-row parent axis orientation and point, */
+/* followed by per-column rotated local position and normals       */
+#define P3DWingsRowOrientation   (0)
+#define P3DWingsRowAxisPoint     (4)
+#define P3DWingsRowDataSize      (7)
+
+#define P3DWingsColumnPos        (0)
+#define P3DWingsColumnNormal     (3)
+#define P3DWingsColumnNormalOpp  (6)
+#define P3DWingsColumnDataSize   (9)
+
 class P3DStemModelWingsInstance : public P3DStemModelInstance
  {
   public           :
@@ -55,6 +66,9 @@ class P3DStemModelWingsInstance : public P3DStemModelInstance
                                        const P3DQuaternionf
                                                           *Rotation);
 
+  virtual         ~P3DStemModelWingsInstance
+                                      ();
+
   /* Per-attribute information */
 
   virtual
@@ -76,6 +90,9 @@ class P3DStemModelWingsInstance : public P3DStemModelInstance
                                        unsigned int        Attr,
                                        unsigned int        Index) const;
 
+  virtual void     FillVAttrBufferI   (float              *Buffer,
+                                       unsigned int        Attr) const;
+
   virtual float    GetLength          () const;
   virtual float    GetMinRadiusAt     (float               Offset) const;
   virtual float    GetScale           () const;
@@ -98,6 +115,12 @@ class P3DStemModelWingsInstance : public P3DStemModelInstance
                                        int                 YSect,
                                        bool                Opposite) const;
 
+  void             CalcVertexNormalAt (float              *Normal,
+                                       int                 XSect,
+                                       int                 YSect,
+                                       bool                Opposite,
+                                       const P3DMatrix4x4f*WorldRotation) const;
+
   void             CalcVertexBiNormalAt
                                       (float              *BiNormal,
                                        int                 YSect) const;
@@ -112,6 +135,19 @@ class P3DStemModelWingsInstance : public P3DStemModelInstance
                                        int                 XSect,
                                        int                 YSect) const;
 
+  /* Parent axis orientation and position are the same for all vertices */
+  /* of a row, and curvature depends on column only, so they are cached  */
+  /* on the first vertex request                                         */
+  const float     *GetRowData         (int                 YSect) const;
+  const float     *GetColumnData      (int                 XSect) const;
+  void             CalcCachedData     () const;
+
+                   P3DStemModelWingsInstance
+                                      (const P3DStemModelWingsInstance
+                                                          &);
+  void             operator =         (const P3DStemModelWingsInstance
+                                                          &);
+
   const P3DStemModelTube              *ParentStemModel;
   const P3DStemModelTubeInstance      *ParentInstance;
   unsigned int                         SectionCount;
@@ -120,6 +156,7 @@ class P3DStemModelWingsInstance : public P3DStemModelInstance
   float                                Thickness;
   P3DMatrix4x4f                        WorldTransform;
   P3DQuaternionf                       Rotation;
+  mutable float                       *CachedData;
  };
 
                    P3DStemModelWingsInstance::P3DStemModelWingsInstance
@@ -155,6 +192,109 @@ class P3DStemModelWingsInstance : public P3DStemModelInstance
    {
     WorldTransform = *Transform;
    }
+
+  CachedData = 0;
+ }
+
+                   P3DStemModelWingsInstance::~P3DStemModelWingsInstance
+                                      ()
+ {
+  delete[] CachedData;
+ }
+
+void               P3DStemModelWingsInstance::CalcCachedData
+                                      () const
+ {
+  unsigned int                         AxisResolution;
+  float                               *Data;
+
+  AxisResolution = ParentStemModel->GetAxisResolution();
+
+  CachedData = new float[(AxisResolution + 1) * P3DWingsRowDataSize +
+                         (SectionCount * 2 + 1) * P3DWingsColumnDataSize];
+
+  Data = CachedData;
+
+  for (unsigned int RowIndex = 0; RowIndex <= AxisResolution; RowIndex++)
+   {
+    float                              YFraction;
+
+    YFraction = (float)RowIndex / AxisResolution;
+
+    ParentInstance->GetAxisOrientationAt(&Data[P3DWingsRowOrientation],YFraction);
+    ParentInstance->GetAxisPointAt(&Data[P3DWingsRowAxisPoint],YFraction);
+
+    Data += P3DWingsRowDataSize;
+   }
+
+  for (int XSect = -(int)SectionCount; XSect <= (int)SectionCount; XSect++)
+   {
+    float                              XFraction;
+    float                              Tangent;
+    P3DVector3f                        TempPos;
+    P3DVector3f                        Normal(0.0f,0.0f,1.0f);
+    P3DVector3f                        NormalOpp(0.0f,0.0f,1.0f);
+
+    XFraction = (float)XSect / SectionCount;
+
+    TempPos.X() = Width * XFraction;
+    TempPos.Y() = 0.0f;
+
+    if (XFraction < 0.0f)
+     {
+      TempPos.Z() = (Curvature->GetValue(-XFraction) - 0.5f) * Thickness;
+     }
+    else
+     {
+      TempPos.Z() = (Curvature->GetValue(XFraction) - 0.5f) * Thickness;
+     }
+
+    P3DQuaternionf::RotateVector(TempPos.v,Rotation.q);
+
+    XFraction = (float)(XSect < 0 ? -XSect : XSect) / SectionCount;
+    Tangent   = Curvature->GetTangent(XFraction);
+
+    Normal.X()    = -Tangent;
+    NormalOpp.X() =  Tangent;
+
+    Normal.Normalize();
+    NormalOpp.Normalize();
+
+    P3DQuaternionf::RotateVector(Normal.v,Rotation.q);
+    P3DQuaternionf::RotateVector(NormalOpp.v,Rotation.q);
+
+    for (unsigned int Index = 0; Index < 3; Index++)
+     {
+      Data[P3DWingsColumnPos + Index]       = TempPos.v[Index];
+      Data[P3DWingsColumnNormal + Index]    = Normal.v[Index];
+      Data[P3DWingsColumnNormalOpp + Index] = NormalOpp.v[Index];
+     }
+
+    Data += P3DWingsColumnDataSize;
+   }
+ }
+
+const float       *P3DStemModelWingsInstance::GetRowData
+                                      (int                 YSect) const
+ {
+  if (CachedData == 0)
+   {
+    CalcCachedData();
+   }
+
+  return(&CachedData[YSect * P3DWingsRowDataSize]);
+ }
+
+const float       *P3DStemModelWingsInstance::GetColumnData
+                                      (int                 XSect) const
+ {
+  if (CachedData == 0)
+   {
+    CalcCachedData();
+   }
+
+  return(&CachedData[(ParentStemModel->GetAxisResolution() + 1) * P3DWingsRowDataSize +
+                     (XSect + (int)SectionCount) * P3DWingsColumnDataSize]);
  }
 
 unsigned int       P3DStemModelWingsInstance::GetVAttrCount
@@ -305,6 +445,70 @@ void               P3DStemModelWingsInstance::GetVAttrValueI
    }
  }
 
+/* vertices are produced row by row in GetVAttrValueI order, so */
+/* section index is not decoded for every vertex                 */
+void               P3DStemModelWingsInstance::FillVAttrBufferI
+                                      (float              *Buffer,
+                                       unsigned int        Attr) const
+ {
+  unsigned int                         AxisResolution;
+  int                                  HalfRowSize;
+  P3DMatrix4x4f                        WorldRotation;
+
+  if ((Attr != P3D_ATTR_VERTEX) &&
+      (Attr != P3D_ATTR_NORMAL) &&
+      (Attr != P3D_ATTR_TEXCOORD0))
+   {
+    P3DStemModelInstance::FillVAttrBufferI(Buffer,Attr);
+
+    return;
+   }
+
+  AxisResolution = ParentStemModel->GetAxisResolution();
+  HalfRowSize    = (int)SectionCount + 1;
+
+  P3DMatrix4x4f::GetRotationOnly(WorldRotation.m,WorldTransform.m);
+
+  for (int YSect = 0; YSect <= (int)AxisResolution; YSect++)
+   {
+    for (int Column = 0; Column < HalfRowSize * 2; Column++)
+     {
+      int                              XSect;
+      bool                             Opposite;
+
+      if (Column < HalfRowSize)
+       {
+        XSect    = HalfRowSize - Column - 1;
+        Opposite = false;
+       }
+      else
+       {
+        XSect    = HalfRowSize - Column;
+        Opposite = true;
+       }
+
+      if      (Attr == P3D_ATTR_VERTEX)
+       {
+        CalcVertexPosAt(Buffer,XSect,YSect);
+
+        Buffer += 3;
+       }
+      else if (Attr == P3D_ATTR_NORMAL)
+       {
+        CalcVertexNormalAt(Buffer,XSect,YSect,Opposite,&WorldRotation);
+
+        Buffer += 3;
+       }
+      else
+       {
+        CalcVertexTexCoord0At(Buffer,XSect,YSect);
+
+        Buffer += 2;
+       }
+     }
+   }
+ }
+
 unsigned int       P3DStemModelWingsInstance::GetPrimitiveCount
                                       () const
  {
@@ -365,34 +569,21 @@ void               P3DStemModelWingsInstance::CalcVertexPosAt
                                        int                 XSect,
                                        int                 YSect) const
  {
-  P3DVector3f                          AxisPoint;
-  P3DQuaternionf                       AxisOrientation;
+  const float                         *ColumnData;
+  const float                         *RowData;
   P3DVector3f                          TempPos;
-  float                                XFraction;
-  float                                YFraction;
 
-  XFraction = (float)XSect / SectionCount;
-  YFraction = (float)YSect / ParentStemModel->GetAxisResolution();
+  ColumnData = GetColumnData(XSect);
 
-  TempPos.X() = Width * XFraction;
-  TempPos.Y() = 0.0f;
-
-  if (XFraction < 0.0f)
-   {
-    TempPos.Z() = (Curvature->GetValue(-XFraction) - 0.5f) * Thickness;
-   }
-  else
-   {
-    TempPos.Z() = (Curvature->GetValue(XFraction) - 0.5f) * Thickness;
-   }
+  TempPos.Set(ColumnData[P3DWingsColumnPos],
+              ColumnData[P3DWingsColumnPos + 1],
+              ColumnData[P3DWingsColumnPos + 2]);
 
-  ParentInstance->GetAxisOrientationAt(AxisOrientation.q,YFraction);
-  ParentInstance->GetAxisPointAt(AxisPoint.v,YFraction);
+  RowData = GetRowData(YSect);
 
-  P3DQuaternionf::RotateVector(TempPos.v,Rotation.q);
-  P3DQuaternionf::RotateVector(TempPos.v,AxisOrientation.q);
+  P3DQuaternionf::RotateVector(TempPos.v,&RowData[P3DWingsRowOrientation]);
 
-  TempPos += AxisPoint;
+  TempPos.Add(&RowData[P3DWingsRowAxisPoint]);
 
   P3DVector3f::MultMatrix(Pos,&WorldTransform,TempPos.v);
  }
@@ -403,37 +594,38 @@ void               P3DStemModelWingsInstance::CalcVertexNormalAt
                                        int                 YSect,
                                        bool                Opposite) const
  {
-  P3DQuaternionf                       AxisOrientation;
-  float                                XFraction;
-  float                                YFraction;
-  P3DVector3f                          VertexNormal(0.0f,0.0f,1.0f);
   P3DMatrix4x4f                        WorldRotation;
 
-  if (XSect < 0)
-   {
-    XSect = -XSect;
-   }
+  P3DMatrix4x4f::GetRotationOnly(WorldRotation.m,WorldTransform.m);
 
-  XFraction = (float)XSect / SectionCount;
-  YFraction = (float)YSect / ParentStemModel->GetAxisResolution();
+  CalcVertexNormalAt(Normal,XSect,YSect,Opposite,&WorldRotation);
+ }
 
-  VertexNormal.X() = Curvature->GetTangent(XFraction);
+void               P3DStemModelWingsInstance::CalcVertexNormalAt
+                                      (float              *Normal,
+                                       int                 XSect,
+                                       int                 YSect,
+                                       bool                Opposite,
+                                       const P3DMatrix4x4f*WorldRotation) const
+ {
+  const float                         *ColumnNormal;
+  P3DVector3f                          VertexNormal;
 
-  if (!Opposite)
+  if (Opposite)
    {
-    VertexNormal.X() = -VertexNormal.X();
+    ColumnNormal = &GetColumnData(XSect)[P3DWingsColumnNormalOpp];
+   }
+  else
+   {
+    ColumnNormal = &GetColumnData(XSect)[P3DWingsColumnNormal];
    }
 
-  VertexNormal.Normalize();
-
-  ParentInstance->GetAxisOrientationAt(AxisOrientation.q,YFraction);
-
-  P3DQuaternionf::RotateVector(VertexNormal.v,Rotation.q);
-  P3DQuaternionf::RotateVector(VertexNormal.v,AxisOrientation.q);
+  VertexNormal.Set(ColumnNormal[0],ColumnNormal[1],ColumnNormal[2]);
 
-  P3DMatrix4x4f::GetRotationOnly(WorldRotation.m,WorldTransform.m);
+  P3DQuaternionf::RotateVector(VertexNormal.v,
+                               &GetRowData(YSect)[P3DWingsRowOrientation]);
 
-  VertexNormal.MultMatrix(&WorldRotation);
+  VertexNormal.MultMatrix(WorldRotation);
   VertexNormal.Normalize();
 
   Normal[0] = VertexNormal.X();
@@ -445,16 +637,11 @@ void               P3DStemModelWingsInstance::CalcVertexBiNormalAt
                                       (float              *BiNormal,
                                        int                 YSect) const
  {
-  P3DQuaternionf                       AxisOrientation;
-  float                                YFraction;
   P3DVector3f                          VertexBiNormal(0.0f,1.0f,0.0f);
   P3DMatrix4x4f                        WorldRotation;
 
-  YFraction = (float)YSect / ParentStemModel->GetAxisResolution();
-
-  ParentInstance->GetAxisOrientationAt(AxisOrientation.q,YFraction);
-
-  P3DQuaternionf::RotateVector(VertexBiNormal.v,AxisOrientation.q);
+  P3DQuaternionf::RotateVector(VertexBiNormal.v,
+                               &GetRowData(YSect)[P3DWingsRowOrientation]);
 
   P3DMatrix4x4f::GetRotationOnly(WorldRotation.m,WorldTransform.m);
 
@@ -826,6 +1013,19 @@ void               P3DStemModelWings::Save
   FmtStream.WriteString("sb","WidthThicknessScaling",WidthScalingEnabled);
  }
 
+void               P3DStemModelWings::UpdateHash
+                                      (P3DHash            *Hash) const
+ {
+  Hash->AddString("Wings");
+
+  Hash->AddFloat(WingsAngle);
+  Hash->AddFloat(Width);
+  Hash->AddUInt(SectionCount);
+  P3DHashSplineCurve(Hash,&Curvature);
+  Hash->AddFloat(Thickness);
+  Hash->AddBool(WidthScalingEnabled);
+ }
+
 void               P3DStemModelWings::Load
                                       (P3DInputStringFmtStream
                                                           *SourceStream,
@@ -113,6 +113,8 @@ class P3DStemModelWings : public P3DStemModel
                                        const P3DFileVersion
                                                           *Version);
 
+  virtual void     UpdateHash         (P3DHash            *Hash) const;
+
   void             SetWingsAngle      (float               Angle);
   float            GetWingsAngle      () const;
 
@@ -33,6 +33,7 @@
 
 #include <ngpcore/p3ddefs.h>
 #include <ngpcore/p3diostream.h>
+#include <ngpcore/p3dhash.h>
 #include <ngpcore/p3dmathspline.h>
 #include <ngpcore/p3dsplineio.h>
 
@@ -57,6 +58,24 @@ void               P3DSaveSplineCurve (P3DOutputStringFmtStream
    }
  }
 
+void               P3DHashSplineCurve (P3DHash            *Hash,
+                                       const P3DMathNaturalCubicSpline
+                                                          *Spline)
+ {
+  unsigned int                         CPCount;
+  unsigned int                         CPIndex;
+
+  CPCount = Spline->GetCPCount();
+
+  Hash->AddUInt(CPCount);
+
+  for (CPIndex = 0; CPIndex < CPCount; CPIndex++)
+   {
+    Hash->AddFloat(Spline->GetCPX(CPIndex));
+    Hash->AddFloat(Spline->GetCPY(CPIndex));
+   }
+ }
+
 void               P3DLoadSplineCurve (P3DMathNaturalCubicSpline
                                                           *Spline,
                                        P3DInputStringFmtStream
@@ -34,6 +34,7 @@
 
 #include <ngpcore/p3ddefs.h>
 #include <ngpcore/p3diostream.h>
+#include <ngpcore/p3dhash.h>
 #include <ngpcore/p3dmathspline.h>
 
 extern void        P3DSaveSplineCurve (P3DOutputStringFmtStream
@@ -42,6 +43,10 @@ extern void        P3DSaveSplineCurve (P3DOutputStringFmtStream
                                                           *Spline);
 
 
+extern void        P3DHashSplineCurve (P3DHash            *Hash,
+                                       const P3DMathNaturalCubicSpline
+                                                          *Spline);
+
 extern void        P3DLoadSplineCurve (P3DMathNaturalCubicSpline
                                                           *Spline,
                                        P3DInputStringFmtStream
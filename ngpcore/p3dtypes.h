@@ -37,11 +37,17 @@
 
  typedef uint8_t        P3Duint8;
  typedef uint16_t       P3Duint16;
+ typedef uint32_t       P3Duint32;
+ typedef uint64_t       P3Duint64;
+ typedef int64_t        P3Dint64;
 #else
 /*FIXME: Assuming 32-bit platform*/
 
- typedef unsigned char  P3Duint8;
- typedef unsigned short P3Duint16;
+ typedef unsigned char      P3Duint8;
+ typedef unsigned short     P3Duint16;
+ typedef unsigned int       P3Duint32;
+ typedef unsigned long long P3Duint64;
+ typedef long long          P3Dint64;
 #endif
 
 typedef P3Duint8  P3DByte;
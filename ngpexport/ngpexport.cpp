@@ -0,0 +1,732 @@
+/***************************************************************************
+
+ Copyright (C) 2006  Sergey Prokhorchuk
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <new>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+/* includes windows.h, so must be placed before GetMessage cleanup */
+#include <ngput/p3dthread.h>
+
+#if defined(_WIN32)
+ #if defined(GetMessage)
+  #undef GetMessage
+ #endif
+#endif
+
+#include <ngpcore/p3dhli.h>
+
+#include <ngput/p3dospath.h>
+#include <ngput/p3dgeomcache.h>
+#include <ngput/p3dexport.h>
+#include <ngput/p3dimagetga.h>
+
+#ifdef WITH_LIBPNG
+ #include <ngput/p3dimagepng.h>
+#endif
+#ifdef WITH_LIBJPEG
+ #include <ngput/p3dimagejpg.h>
+#endif
+
+#include <ngput/p3dtexprep.h>
+#include <ngput/p3dtexcomp.h>
+
+enum
+ {
+  NGPExportFormatAuto,
+  NGPExportFormatOBJ,
+  NGPExportFormatGLTF
+ };
+
+enum
+ {
+  NGPExportTexCompNone,
+  NGPExportTexCompAuto,
+  NGPExportTexCompBC1,
+  NGPExportTexCompBC1A,
+  NGPExportTexCompBC3
+ };
+
+#define NGPExportCacheMaxSize ((P3Duint64)1024 * 1024 * 1024)
+#define NGPExportTexMaxSize   (16384)
+
+/* writes block-compressed copies of all model textures into output */
+/* file directory, container extension is appended to texture name  */
+/* (leaf.tga -> leaf.tga.dds)                                        */
+static bool        ExportTextures     (const char         *ModelFileName,
+                                       const char         *OutputFileName,
+                                       const P3DHLIPlantTemplate
+                                                          *PlantTemplate,
+                                       const char         *TexPath,
+                                       unsigned int        TexComp,
+                                       unsigned int        TexContainer,
+                                       unsigned int        ThreadCount)
+ {
+  bool                                 Result;
+  P3DImageFmtHandlerComposite          ImageFmtHandler;
+  std::vector<std::string>             TexNames;
+  std::string                          ModelTexPath;
+  std::string                          OutputDir;
+
+  ImageFmtHandler.AddHandler(new P3DImageFmtHandlerTGA());
+  #ifdef WITH_LIBPNG
+  ImageFmtHandler.AddHandler(new P3DImageFmtHandlerPNG());
+  #endif
+  #ifdef WITH_LIBJPEG
+  ImageFmtHandler.AddHandler(new P3DImageFmtHandlerJPG());
+  #endif
+
+  P3DTexPrepQueue                      Queue(&ImageFmtHandler);
+
+  ModelTexPath = P3DPathName::JoinPaths(P3DPathName::DirName(ModelFileName).c_str(),
+                                        P3D_LOCAL_TEXTURES_PATH);
+  OutputDir    = P3DPathName::DirName(OutputFileName);
+
+  for (unsigned int GroupIndex = 0; GroupIndex < PlantTemplate->GetGroupCount(); GroupIndex++)
+   {
+    const P3DMaterialDef              *MaterialDef;
+
+    MaterialDef = PlantTemplate->GetMaterial(GroupIndex);
+
+    for (unsigned int TexLayer = 0; TexLayer < P3D_MAX_TEX_LAYERS; TexLayer++)
+     {
+      const char  *TexName = MaterialDef->GetTexName(TexLayer);
+
+      if ((TexName != 0) &&
+          (std::find(TexNames.begin(),TexNames.end(),std::string(TexName)) == TexNames.end()))
+       {
+        TexNames.push_back(TexName);
+
+        Queue.Add(P3DPathName::JoinPaths(ModelTexPath.c_str(),TexName).c_str(),
+                  P3DPathName::JoinPaths(TexPath,TexName).c_str());
+       }
+     }
+   }
+
+  Queue.Run(ThreadCount,NGPExportTexMaxSize);
+
+  Result = true;
+
+  for (unsigned int Index = 0; Index < Queue.GetCount(); Index++)
+   {
+    const P3DTexImage                 *Image;
+    unsigned int                       Format;
+    P3DCompressedTexture               Texture;
+    std::string                        TargetName;
+
+    if (Queue.GetFileName(Index) == 0)
+     {
+      fprintf(stderr,"error: unable to load texture %s\n",TexNames[Index].c_str());
+
+      Result = false;
+
+      continue;
+     }
+
+    Image = Queue.GetImage(Index);
+
+    if      (TexComp == NGPExportTexCompBC1)
+     {
+      Format = P3D_TEXCOMP_BC1;
+     }
+    else if (TexComp == NGPExportTexCompBC1A)
+     {
+      Format = P3D_TEXCOMP_BC1A;
+     }
+    else if (TexComp == NGPExportTexCompBC3)
+     {
+      Format = P3D_TEXCOMP_BC3;
+     }
+    else
+     {
+      Format = P3DCompressedTexture::SelectFormat(Image->GetSourceImage());
+     }
+
+    Texture.Create(Image,Format,ThreadCount);
+
+    TargetName  = P3DPathName::BaseName(TexNames[Index].c_str());
+    TargetName += ".";
+    TargetName += P3DCompressedTexture::GetContainerExt(TexContainer);
+    TargetName  = P3DPathName::JoinPaths(OutputDir.c_str(),TargetName.c_str());
+
+    if (!Texture.Save(TargetName.c_str(),TexContainer))
+     {
+      fprintf(stderr,"error: unable to write texture file %s\n",TargetName.c_str());
+
+      Result = false;
+     }
+   }
+
+  return(Result);
+ }
+
+static bool        ExportModel        (const char         *ModelFileName,
+                                       const char         *OutputFileName,
+                                       unsigned int        Format,
+                                       unsigned int        Seed,
+                                       bool                DummiesEnabled,
+                                       const char         *CacheDir,
+                                       const P3DExportOptions
+                                                          *Options,
+                                       const char         *TexPath,
+                                       unsigned int        TexComp,
+                                       unsigned int        TexContainer,
+                                       unsigned int        ThreadCount)
+ {
+  bool                                 Result;
+  P3DInputStringStreamFile             SourceStream;
+  P3DHLIPlantTemplate                 *PlantTemplate;
+  P3DHLIPlantInstance                 *PlantInstance;
+  P3DCachedPlantGeometry              *Geometry;
+  P3DPlantExporter                    *Exporter;
+
+  Result = true;
+
+  PlantTemplate = 0;
+  PlantInstance = 0;
+  Geometry      = 0;
+
+  if (Format == NGPExportFormatOBJ)
+   {
+    Exporter = new P3DPlantExporterOBJ();
+   }
+  else
+   {
+    Exporter = new P3DPlantExporterGLTF();
+   }
+
+  Exporter->SetOptions(Options);
+
+  try
+   {
+    SourceStream.Open(ModelFileName);
+
+    PlantTemplate = new P3DHLIPlantTemplate(&SourceStream);
+
+    SourceStream.Close();
+
+    PlantTemplate->SetDummiesEnabled(DummiesEnabled);
+
+    /* instance is cheap to create and is needed for instanced export */
+    PlantInstance = PlantTemplate->CreateInstance(Seed);
+
+    if (CacheDir != 0)
+     {
+      P3DGeometryCache                 Cache(CacheDir,NGPExportCacheMaxSize);
+
+      Geometry = Cache.GetGeometry(PlantTemplate,Seed);
+     }
+
+    Result = Exporter->Export(OutputFileName,PlantTemplate,PlantInstance,Geometry);
+
+    if (!Result)
+     {
+      fprintf(stderr,"error: %s\n",Exporter->GetErrorMessage());
+     }
+    else if (TexComp != NGPExportTexCompNone)
+     {
+      Result = ExportTextures(ModelFileName,
+                              OutputFileName,
+                              PlantTemplate,
+                              TexPath,
+                              TexComp,
+                              TexContainer,
+                              ThreadCount);
+     }
+   }
+  catch (const P3DException &Exception)
+   {
+    fprintf(stderr,"error: %s\n",Exception.GetMessage());
+
+    Result = false;
+   }
+  catch (const std::bad_alloc &)
+   {
+    fprintf(stderr,"error: out of memory\n");
+
+    Result = false;
+   }
+
+  delete Geometry;
+  delete PlantInstance;
+  delete PlantTemplate;
+  delete Exporter;
+
+  return(Result);
+ }
+
+static void        ShowHelpMessage    ()
+ {
+  printf("Usage: ngpexport [options] modelfile outputfile\n");
+  printf("Options:\n");
+  printf("  -h            Display this information\n");
+  printf("  -f obj        Export to Wavefront OBJ (by default detected from file extension)\n");
+  printf("  -f glb        Export to binary glTF 2.0 (by default detected from file extension)\n");
+  printf("  -s <seed>     Use <seed> as base seed (model seed by default)\n");
+  printf("  -k <scale>    Scale vertex positions by <scale> (1.0 by default)\n");
+  printf("  -d            Export dummy branch groups (disabled by default)\n");
+  printf("  -nn           Do not export normals\n");
+  printf("  -nt           Do not export texture coordinates\n");
+  printf("  -c <dir>      Use <dir> as geometry cache directory (no cache by default)\n");
+  printf("  -i none       Export all branch groups as plain geometry\n");
+  printf("  -i rigid      Instance groups which are cloneable without scaling\n");
+  printf("  -i scaled     Instance all cloneable groups (default)\n");
+  printf("  -z bc1        Write BC1 compressed textures (<texture>.dds) next to outputfile\n");
+  printf("  -z bc1a       Write BC1 compressed textures with 1-bit alpha\n");
+  printf("  -z bc3        Write BC3 compressed textures\n");
+  printf("  -z auto       Select compression format by texture alpha channel\n");
+  printf("  -Z dds        Use DDS container for compressed textures (default)\n");
+  printf("  -Z ktx        Use KTX container for compressed textures\n");
+  printf("  -t <path>     Use <path> for texture search (current dir by default)\n");
+  printf("  -j <count>    Use <count> threads for texture compression (CPU count by default)\n");
+ }
+
+static unsigned int GetFormatByFileName
+                                      (const char         *FileName)
+ {
+  std::string                          Ext;
+
+  Ext = P3DPathName(FileName).GetExtension();
+
+  for (unsigned int Index = 0; Index < Ext.size(); Index++)
+   {
+    if ((Ext[Index] >= 'A') && (Ext[Index] <= 'Z'))
+     {
+      Ext[Index] = Ext[Index] - 'A' + 'a';
+     }
+   }
+
+  if      (Ext == "obj")
+   {
+    return(NGPExportFormatOBJ);
+   }
+  else if (Ext == "glb")
+   {
+    return(NGPExportFormatGLTF);
+   }
+  else
+   {
+    return(NGPExportFormatAuto);
+   }
+ }
+
+static bool        ParseArgs          (char              **ModelFileName,
+                                       char              **OutputFileName,
+                                       unsigned int       *Format,
+                                       unsigned int       *Seed,
+                                       bool               *DummiesEnabled,
+                                       char              **CacheDir,
+                                       P3DExportOptions   *Options,
+                                       char              **TexPath,
+                                       unsigned int       *TexComp,
+                                       unsigned int       *TexContainer,
+                                       unsigned int       *ThreadCount,
+                                       bool               *ShowHelp,
+                                       unsigned int        ArgCount,
+                                       char               *ArgValues[])
+ {
+  bool                                 Result;
+  unsigned int                         ArgIndex;
+  char                                *ArgStr;
+  unsigned int                         ArgStrLen;
+
+  Result = true;
+
+  *ModelFileName  = 0;
+  *OutputFileName = 0;
+  *Format         = NGPExportFormatAuto;
+  *Seed           = 0;
+  *DummiesEnabled = false;
+  *CacheDir       = 0;
+  *TexPath        = 0;
+  *TexComp        = NGPExportTexCompNone;
+  *TexContainer   = P3D_TEXCOMP_CONTAINER_DDS;
+  *ThreadCount    = P3DThread::GetCPUCount();
+  *ShowHelp       = false;
+
+  ArgIndex = 1;
+
+  while ((ArgIndex < ArgCount) && (Result))
+   {
+    ArgStr    = ArgValues[ArgIndex];
+    ArgStrLen = strlen(ArgStr);
+
+    if (ArgStrLen > 0)
+     {
+      if (ArgStr[0] == '-')
+       {
+        if      (strcmp(ArgStr,"-h") == 0)
+         {
+          *ShowHelp = true;
+         }
+        else if (strcmp(ArgStr,"-f") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            if      (strcmp(ArgValues[ArgIndex],"obj") == 0)
+             {
+              *Format = NGPExportFormatOBJ;
+             }
+            else if (strcmp(ArgValues[ArgIndex],"glb") == 0)
+             {
+              *Format = NGPExportFormatGLTF;
+             }
+            else
+             {
+              Result = false;
+
+              fprintf(stderr,"error: unknown output format (%s)\n",ArgValues[ArgIndex]);
+             }
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: output format required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-s") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            if (sscanf(ArgValues[ArgIndex],"%u",Seed) != 1)
+             {
+              Result = false;
+
+              fprintf(stderr,"error: invalid seed value (%s)\n",ArgValues[ArgIndex]);
+             }
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: seed required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-k") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            if (sscanf(ArgValues[ArgIndex],"%f",&Options->Scale) != 1)
+             {
+              Result = false;
+
+              fprintf(stderr,"error: invalid scale value (%s)\n",ArgValues[ArgIndex]);
+             }
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: scale required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-d") == 0)
+         {
+          *DummiesEnabled = true;
+         }
+        else if (strcmp(ArgStr,"-nn") == 0)
+         {
+          Options->ExportNormals = false;
+         }
+        else if (strcmp(ArgStr,"-nt") == 0)
+         {
+          Options->ExportTexCoords = false;
+         }
+        else if (strcmp(ArgStr,"-i") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            if      (strcmp(ArgValues[ArgIndex],"none") == 0)
+             {
+              Options->Instancing = P3D_EXPORT_INSTANCING_NONE;
+             }
+            else if (strcmp(ArgValues[ArgIndex],"rigid") == 0)
+             {
+              Options->Instancing = P3D_EXPORT_INSTANCING_RIGID;
+             }
+            else if (strcmp(ArgValues[ArgIndex],"scaled") == 0)
+             {
+              Options->Instancing = P3D_EXPORT_INSTANCING_SCALED;
+             }
+            else
+             {
+              Result = false;
+
+              fprintf(stderr,"error: unknown instancing mode (%s)\n",ArgValues[ArgIndex]);
+             }
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: instancing mode required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-c") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            *CacheDir = ArgValues[ArgIndex];
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: cache directory required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-z") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            if      (strcmp(ArgValues[ArgIndex],"bc1") == 0)
+             {
+              *TexComp = NGPExportTexCompBC1;
+             }
+            else if (strcmp(ArgValues[ArgIndex],"bc1a") == 0)
+             {
+              *TexComp = NGPExportTexCompBC1A;
+             }
+            else if (strcmp(ArgValues[ArgIndex],"bc3") == 0)
+             {
+              *TexComp = NGPExportTexCompBC3;
+             }
+            else if (strcmp(ArgValues[ArgIndex],"auto") == 0)
+             {
+              *TexComp = NGPExportTexCompAuto;
+             }
+            else
+             {
+              Result = false;
+
+              fprintf(stderr,"error: unknown texture compression format (%s)\n",ArgValues[ArgIndex]);
+             }
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: texture compression format required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-Z") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            if      (strcmp(ArgValues[ArgIndex],"dds") == 0)
+             {
+              *TexContainer = P3D_TEXCOMP_CONTAINER_DDS;
+             }
+            else if (strcmp(ArgValues[ArgIndex],"ktx") == 0)
+             {
+              *TexContainer = P3D_TEXCOMP_CONTAINER_KTX;
+             }
+            else
+             {
+              Result = false;
+
+              fprintf(stderr,"error: unknown texture container (%s)\n",ArgValues[ArgIndex]);
+             }
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: texture container required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-t") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            *TexPath = ArgValues[ArgIndex];
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: texture path required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-j") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            if ((sscanf(ArgValues[ArgIndex],"%u",ThreadCount) != 1) ||
+                (*ThreadCount == 0))
+             {
+              Result = false;
+
+              fprintf(stderr,"error: invalid thread count (%s)\n",ArgValues[ArgIndex]);
+             }
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: thread count required\n");
+           }
+         }
+        else
+         {
+          Result = false;
+
+          fprintf(stderr,"error: unknown option (%s)\n",ArgStr);
+         }
+       }
+      else
+       {
+        if      ((*ModelFileName) == 0)
+         {
+          *ModelFileName = ArgStr;
+         }
+        else if ((*OutputFileName) == 0)
+         {
+          *OutputFileName = ArgStr;
+         }
+        else
+         {
+          Result = false;
+
+          fprintf(stderr,"error: extra argument passed\n");
+         }
+       }
+     }
+
+    ArgIndex++;
+   }
+
+  if ((Result) && (!(*ShowHelp)))
+   {
+    if      ((*ModelFileName) == 0)
+     {
+      Result = false;
+
+      fprintf(stderr,"error: model file name required\n");
+     }
+    else if ((*OutputFileName) == 0)
+     {
+      Result = false;
+
+      fprintf(stderr,"error: output file name required\n");
+     }
+    else if ((*Format) == NGPExportFormatAuto)
+     {
+      *Format = GetFormatByFileName(*OutputFileName);
+
+      if ((*Format) == NGPExportFormatAuto)
+       {
+        Result = false;
+
+        fprintf(stderr,"error: unable to detect output format, use -f option\n");
+       }
+     }
+   }
+
+  return(Result);
+ }
+
+int                main               (int                 argc,
+                                       char               *argv[])
+ {
+  bool                                 Result;
+  char                                *ModelFileName;
+  char                                *OutputFileName;
+  unsigned int                         Format;
+  unsigned int                         Seed;
+  bool                                 DummiesEnabled;
+  char                                *CacheDir;
+  P3DExportOptions                     Options;
+  char                                *TexPath;
+  unsigned int                         TexComp;
+  unsigned int                         TexContainer;
+  unsigned int                         ThreadCount;
+  bool                                 ShowHelp;
+
+  Result = ParseArgs(&ModelFileName,
+                     &OutputFileName,
+                     &Format,
+                     &Seed,
+                     &DummiesEnabled,
+                     &CacheDir,
+                     &Options,
+                     &TexPath,
+                     &TexComp,
+                     &TexContainer,
+                     &ThreadCount,
+                     &ShowHelp,
+                      argc,argv);
+
+  if (Result)
+   {
+    if (ShowHelp)
+     {
+      ShowHelpMessage();
+     }
+    else
+     {
+      Result = ExportModel(ModelFileName,
+                           OutputFileName,
+                           Format,
+                           Seed,
+                           DummiesEnabled,
+                           CacheDir,
+                          &Options,
+                           TexPath != 0 ? TexPath : ".",
+                           TexComp,
+                           TexContainer,
+                           ThreadCount);
+     }
+   }
+
+  if (Result)
+   {
+    return(0);
+   }
+  else
+   {
+    return(1);
+   }
+ }
+
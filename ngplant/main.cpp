@@ -40,6 +40,7 @@
 #include <ngpcore/p3dbalgstd.h>
 #include <ngpcore/p3diostream.h>
 #include <ngpcore/p3dcompat.h>
+#include <ngpcore/p3dhli.h>
 
 #include <ngput/p3dospath.h>
 
@@ -485,19 +486,22 @@ void               P3DMainFrame::OnExportObjPlugin
 void               P3DMainFrame::OnImportNga
                                           (wxCommandEvent     &event)
  {
-  std::string NGPFileName = P3DNGAImport();
-
-  if (!NGPFileName.empty())
+  if (ApproveDataLoss())
    {
-    if (wxMessageBox(wxString("Import succeeded. Do you want to open model ",wxConvUTF8) +
-                     wxString(NGPFileName.c_str(),wxConvUTF8) + wxT(" now?"),
-                     wxT("Information"),
-                     wxYES_NO | wxICON_INFORMATION) == wxYES)
+    P3DPlantModel                     *NewModel;
+
+    NewModel = P3DNGAImport();
+
+    if (NewModel != 0)
      {
-      if (ApproveDataLoss())
-       {
-        OpenModelFile(wxString(NGPFileName.c_str(),wxConvUTF8));
-       }
+      EditPanel->HideAll();
+
+      P3DApp::GetApp()->SetModel(NewModel);
+
+      P3DApp::GetApp()->SetFileName("");
+      P3DApp::GetApp()->GetTexFS()->SetModelPath(0);
+
+      EditPanel->RestoreAll();
      }
    }
  }
@@ -579,6 +583,52 @@ void               P3DMainFrame::OnOpenRecent
    }
  }
 
+/* extra pass over model file to decode all its textures in parallel */
+/* before materials are created                                       */
+static void        PreloadModelTextures
+                                      (const wxString     &FileName)
+ {
+  std::vector<std::string>             FileNames;
+
+  try
+   {
+    P3DInputStringStreamFile           SourceStream;
+
+    SourceStream.Open(FileName.mb_str());
+
+    P3DHLIPlantTemplate                PlantTemplate(&SourceStream);
+
+    SourceStream.Close();
+
+    for (unsigned int GroupIndex = 0; GroupIndex < PlantTemplate.GetGroupCount(); GroupIndex++)
+     {
+      const P3DMaterialDef            *MaterialDef;
+
+      MaterialDef = PlantTemplate.GetMaterial(GroupIndex);
+
+      for (unsigned int TexLayer = 0; TexLayer < P3D_MAX_TEX_LAYERS; TexLayer++)
+       {
+        if (MaterialDef->GetTexName(TexLayer) != NULL)
+         {
+          std::string SystemName = P3DApp::GetApp()->GetTexFS()->Generic2System(MaterialDef->GetTexName(TexLayer));
+
+          if (SystemName.length() > 0)
+           {
+            FileNames.push_back(SystemName);
+           }
+         }
+       }
+     }
+   }
+  catch (...)
+   {
+    /* errors are reported when model is actually loaded */
+    return;
+   }
+
+  P3DApp::GetApp()->GetTexManager()->PreloadFiles(FileNames);
+ }
+
 bool               P3DMainFrame::OpenModelFile
                                       (const wxString     &FileName)
  {
@@ -598,6 +648,8 @@ bool               P3DMainFrame::OpenModelFile
 
     TextureFS->SetModelPath(NewModelPath.mb_str());
 
+    PreloadModelTextures(FileName);
+
     try
      {
       P3DInputStringStreamFile         SourceStream;
@@ -642,6 +694,8 @@ bool               P3DMainFrame::OpenModelFile
       ::wxMessageBox(wxT("Error while loading model"),wxT("Error"),wxOK | wxICON_ERROR);
      }
 
+    P3DApp::GetApp()->GetTexManager()->ClearPreloaded();
+
     delete NewModel;
    }
 
@@ -744,7 +798,9 @@ const P3DPlantObject
 
     try
      {
-      PlantObject      = new P3DPlantObject(PlantModel,RenderQuirks.UseColorArray);
+      PlantObject      = new P3DPlantObject(PlantModel,
+                                            RenderQuirks.UseColorArray,
+                                            RenderQuirks.UseCPUBillboards);
       PlantObjectDirty = false;
      }
     catch (...)
@@ -939,7 +995,9 @@ void               P3DApp::ForceUpdate()
 
     try
      {
-      PlantObject      = new P3DPlantObject(PlantModel,RenderQuirks.UseColorArray);
+      PlantObject      = new P3DPlantObject(PlantModel,
+                                            RenderQuirks.UseColorArray,
+                                            RenderQuirks.UseCPUBillboards);
       PlantObjectDirty = false;
      }
     catch (...)
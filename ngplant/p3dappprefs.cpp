@@ -278,6 +278,7 @@ void               P3DUIControlsPrefs::Save
  }
 
 static const wxChar    *RenderQuirksUseColorArrayPath  = wxT("/RenderQuirks/UseColorArray");
+static const wxChar    *RenderQuirksUseCPUBillboardsPath = wxT("/RenderQuirks/UseCPUBillboards");
 
                    P3DRenderQuirksPrefs::P3DRenderQuirksPrefs
                                       ()
@@ -296,18 +297,25 @@ void               P3DRenderQuirksPrefs::Read
    {
     UseColorArray = ParamInt;
    }
+
+  if (Config->Read(RenderQuirksUseCPUBillboardsPath,&ParamInt))
+   {
+    UseCPUBillboards = ParamInt;
+   }
  }
 
 void               P3DRenderQuirksPrefs::Save
                                       (wxConfigBase       *Config) const
  {
   wxConfigBaseWriteIntWrapper(Config,RenderQuirksUseColorArrayPath,UseColorArray ? 1 : 0);
+  wxConfigBaseWriteIntWrapper(Config,RenderQuirksUseCPUBillboardsPath,UseCPUBillboards ? 1 : 0);
  }
 
 void               P3DRenderQuirksPrefs::SetDefaults
                                       ()
  {
-  UseColorArray = false;
+  UseColorArray    = false;
+  UseCPUBillboards = false;
  }
 
 static const wxChar    *TubeCrossSectResolution0Path  = wxT("/Model/Tube/CrossResolution0");
@@ -118,6 +118,7 @@ struct P3DRenderQuirksPrefs
   void             Save               (wxConfigBase       *Config) const;
 
   bool                                 UseColorArray;
+  bool                                 UseCPUBillboards;
 
   private          :
 
@@ -19,6 +19,7 @@
 ***************************************************************************/
 
 #include "wx/wx.h"
+#include "wx/mstream.h"
 
 #include <ngpcore/p3ddefs.h>
 #include <ngpcore/p3dtypes.h>
@@ -42,53 +43,85 @@ const char        *P3DImageFmtHandlerWx::FormatExt
   return P3DImageFmtWxExts[FormatIndex < FormatCount() ? FormatIndex : 0];
  }
 
-bool               P3DImageFmtHandlerWx::LoadImageData
-                                      (P3DImageData       *ImageData,
-                                       const char         *FileName,
-                                       const char         *FileExt P3D_UNUSED_ATTR) const
+static bool        CopyImageData      (P3DImageData       *ImageData,
+                                       const wxImage      *Image)
  {
   bool                                 Result;
-  wxImage                             *Image;
   int                                  Width;
   int                                  Height;
   bool                                 HasAlpha;
 
-  Image  = new wxImage();
-  Result = Image->LoadFile(wxString(FileName,wxConvUTF8));
+  Width    = Image->GetWidth();
+  Height   = Image->GetHeight();
+  HasAlpha = Image->HasAlpha();
+
+  Result = ImageData->Create(Width,Height,HasAlpha ? 4 : 3,P3D_BYTE);
 
   if (Result)
    {
-    Width    = Image->GetWidth();
-    Height   = Image->GetHeight();
-    HasAlpha = Image->HasAlpha();
+    unsigned char *Ptr;
 
-    Result = ImageData->Create(Width,Height,HasAlpha ? 4 : 3,P3D_BYTE);
+    Ptr = (unsigned char*)ImageData->GetData();
 
-    if (Result)
+    for (int Y = Height - 1; Y >= 0; Y--)
      {
-      unsigned char *Ptr;
-
-      Ptr = (unsigned char*)ImageData->GetData();
-
-      for (int Y = Height - 1; Y >= 0; Y--)
+      for (int X = 0; X < Width; X++)
        {
-        for (int X = 0; X < Width; X++)
+        *Ptr++ = Image->GetRed(X,Y);
+        *Ptr++ = Image->GetGreen(X,Y);
+        *Ptr++ = Image->GetBlue(X,Y);
+
+        if (HasAlpha)
          {
-          *Ptr++ = Image->GetRed(X,Y);
-          *Ptr++ = Image->GetGreen(X,Y);
-          *Ptr++ = Image->GetBlue(X,Y);
-
-          if (HasAlpha)
-           {
-            *Ptr++ = Image->GetAlpha(X,Y);
-           }
+          *Ptr++ = Image->GetAlpha(X,Y);
          }
        }
      }
    }
 
+  return(Result);
+ }
+
+bool               P3DImageFmtHandlerWx::LoadImageData
+                                      (P3DImageData       *ImageData,
+                                       const char         *FileName,
+                                       const char         *FileExt P3D_UNUSED_ATTR) const
+ {
+  bool                                 Result;
+  wxImage                             *Image;
+
+  Image  = new wxImage();
+  Result = Image->LoadFile(wxString(FileName,wxConvUTF8));
+
+  if (Result)
+   {
+    Result = CopyImageData(ImageData,Image);
+   }
+
   delete Image;
 
   return(Result);
  }
 
+bool               P3DImageFmtHandlerWx::LoadImageDataMem
+                                      (P3DImageData       *ImageData,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       const char         *FileExt P3D_UNUSED_ATTR) const
+ {
+  bool                                 Result;
+  wxImage                             *Image;
+  wxMemoryInputStream                  Stream(Data,Size);
+
+  Image  = new wxImage();
+  Result = Image->LoadFile(Stream);
+
+  if (Result)
+   {
+    Result = CopyImageData(ImageData,Image);
+   }
+
+  delete Image;
+
+  return(Result);
+ }
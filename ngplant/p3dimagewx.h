@@ -39,6 +39,12 @@ class P3DImageFmtHandlerWx : public P3DImageFmtHandler
   bool             LoadImageData      (P3DImageData       *ImageData,
                                        const char         *FileName,
                                        const char         *FileExt) const;
+
+  virtual
+  bool             LoadImageDataMem   (P3DImageData       *ImageData,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       const char         *FileExt) const;
  };
 
 #endif
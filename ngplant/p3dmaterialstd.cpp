@@ -18,11 +18,13 @@
 
 ***************************************************************************/
 
+#include <stdio.h>
 #include <string.h>
 
 #include <string>
 
 #include <wx/wx.h>
+#include <wx/filename.h>
 
 #include <ngput/p3dglext.h>
 
@@ -75,13 +77,19 @@ P3DMaterialInstance
    {
     if (MatDef.GetTexName(TexLayer) != NULL)
      {
-      std::string SystemName = P3DApp::GetApp()->GetTexFS()->Generic2System(MatDef.GetTexName(TexLayer));
+      /* textures loaded from archive (.nga) have no system file */
+      TexHandles[TexLayer] = TexManager->GetMemoryTextureHandle(MatDef.GetTexName(TexLayer));
 
-      if (SystemName.length() > 0)
+      if (TexHandles[TexLayer] == P3DTexHandleNULL)
        {
-        wxString                       ErrorMessage;
+        std::string SystemName = P3DApp::GetApp()->GetTexFS()->Generic2System(MatDef.GetTexName(TexLayer));
+
+        if (SystemName.length() > 0)
+         {
+          wxString                     ErrorMessage;
 
-        TexHandles[TexLayer] = TexManager->LoadFromFile(SystemName.c_str(),ErrorMessage);
+          TexHandles[TexLayer] = TexManager->LoadFromFile(SystemName.c_str(),ErrorMessage);
+         }
        }
 
       if (TexHandles[TexLayer] == P3DTexHandleNULL)
@@ -94,7 +102,8 @@ P3DMaterialInstance
   ShaderHandle = ShaderManager->GenShader
                   (TexHandles[P3D_TEX_DIFFUSE] != P3DTexHandleNULL,
                    TexHandles[P3D_TEX_NORMAL_MAP] != P3DTexHandleNULL,
-                   MatDef.IsDoubleSided());
+                   MatDef.IsDoubleSided(),
+                   P3D_BILLBOARD_MODE_NONE);
  }
 
                    P3DMaterialInstanceSimple::~P3DMaterialInstanceSimple
@@ -191,7 +200,8 @@ void               P3DMaterialInstanceSimple::SetTexHandle
     ShaderHandle = ShaderManager->GenShader
                     (TexHandles[P3D_TEX_DIFFUSE] != P3DTexHandleNULL,
                      TexHandles[P3D_TEX_NORMAL_MAP] != P3DTexHandleNULL,
-                     MatDef.IsDoubleSided());
+                     MatDef.IsDoubleSided(),
+                     P3D_BILLBOARD_MODE_NONE);
    }
  }
 
@@ -208,6 +218,20 @@ const char        *P3DMaterialInstanceSimple::GetTexFileName
    }
  }
 
+const void        *P3DMaterialInstanceSimple::GetTexSourceData
+                                      (unsigned int        Layer,
+                                       unsigned int       *Size) const
+ {
+  if (TexHandles[Layer] == P3DTexHandleNULL)
+   {
+    return(0);
+   }
+  else
+   {
+    return(TexManager->GetTexSourceData(TexHandles[Layer],Size));
+   }
+ }
+
 bool               P3DMaterialInstanceSimple::IsDoubleSided
                                       () const
  {
@@ -229,7 +253,8 @@ void               P3DMaterialInstanceSimple::SetDoubleSided
     ShaderHandle = ShaderManager->GenShader
                     (TexHandles[P3D_TEX_DIFFUSE] != P3DTexHandleNULL,
                      TexHandles[P3D_TEX_NORMAL_MAP] != P3DTexHandleNULL,
-                     DoubleSided);
+                     DoubleSided,
+                     P3D_BILLBOARD_MODE_NONE);
    }
  }
 
@@ -329,12 +354,87 @@ void               P3DMaterialInstanceSimple::SetSelected
   this->Selected = Selected;
  }
 
+/* textures loaded from archive (.nga) have no file, so they are */
+/* written into model local textures directory, where they are   */
+/* found when saved model is loaded. Existing files are kept.    */
+static void        SaveMemoryTexture  (const char         *TexName,
+                                       const void         *Data,
+                                       unsigned int        Size)
+ {
+  const char                          *ModelPath;
+  wxFileName                           FileName;
+  FILE                                *File;
+  bool                                 Ok;
+
+  ModelPath = P3DApp::GetApp()->GetTexFS()->GetModelPath();
+
+  if (ModelPath == 0)
+   {
+    throw P3DExceptionGeneric("model path is not set");
+   }
+
+  FileName.Assign(wxString(ModelPath,wxConvUTF8) +
+                  wxFileName::GetPathSeparator() +
+                  wxString(TexName,wxConvUTF8));
+
+  if (FileName.FileExists())
+   {
+    return;
+   }
+
+  if (!wxFileName::Mkdir(FileName.GetPath(),0777,wxPATH_MKDIR_FULL))
+   {
+    throw P3DExceptionGeneric("unable to create textures directory");
+   }
+
+  File = fopen(FileName.GetFullPath().mb_str(),"wb");
+
+  if (File == NULL)
+   {
+    throw P3DExceptionGeneric("unable to create texture file");
+   }
+
+  Ok = fwrite(Data,1,Size,File) == Size;
+
+  if (fclose(File) != 0)
+   {
+    Ok = false;
+   }
+
+  if (!Ok)
+   {
+    throw P3DExceptionGeneric("unable to write texture file");
+   }
+ }
+
 void               P3DIDEMaterialSaver::Save
                                       (P3DOutputStringStream
                                                           *TargetStream,
                                        const P3DMaterialInstance
                                                           *Material) const
  {
-  ((P3DMaterialInstanceSimple*)Material)->GetMaterialDef()->Save(TargetStream);
+  const P3DMaterialInstanceSimple     *MaterialImpl;
+  const P3DMaterialDef                *MaterialDef;
+
+  MaterialImpl = (const P3DMaterialInstanceSimple*)Material;
+  MaterialDef  = MaterialImpl->GetMaterialDef();
+
+  for (unsigned int Layer = 0; Layer < P3D_MAX_TEX_LAYERS; Layer++)
+   {
+    const void                        *Data;
+    unsigned int                       Size;
+
+    if (MaterialDef->GetTexName(Layer) != 0)
+     {
+      Data = MaterialImpl->GetTexSourceData(Layer,&Size);
+
+      if (Data != 0)
+       {
+        SaveMemoryTexture(MaterialDef->GetTexName(Layer),Data,Size);
+       }
+     }
+   }
+
+  MaterialDef->Save(TargetStream);
  }
 
@@ -71,6 +71,9 @@ class P3DMaterialInstanceSimple : public P3DMaterialInstance
                                        P3DTexHandle        TexHandle);
 
   const char      *GetTexFileName     (unsigned int        Layer) const;
+  /* see P3DTexManagerGL::GetTexSourceData */
+  const void      *GetTexSourceData   (unsigned int        Layer,
+                                       unsigned int       *Size) const;
 
   bool             IsDoubleSided      () const;
   void             SetDoubleSided     (bool                DoubleSided);
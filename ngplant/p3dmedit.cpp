@@ -1503,6 +1503,13 @@ wxString           P3DPlantModelTreeCtrl::MakeTreeItemLabel
                 wxString::Format(wxT(" [%d/%d]"),
                                  PlantObject->GetTotalVertexCount(),
                                  PlantObject->GetTotalTriangleCount());
+
+      if (PlantObject->GetTotalBufferSize() > 0)
+       {
+        Result += wxString::Format(wxT(" [VBO %uK/%.1f ms]"),
+                                   (PlantObject->GetTotalBufferSize() + 1023) / 1024,
+                                   PlantObject->GetBufferUploadTime());
+       }
      }
     else
      {
@@ -18,29 +18,47 @@
 
 ***************************************************************************/
 
-#include <sys/types.h>
-#include <sys/stat.h>
 #include <stdio.h>
+#include <string.h>
 #include <time.h>
 
-#if defined(_MSC_VER)
- #include <direct.h>
-#else
- #include <unistd.h>
-#endif
-
 #include <string>
+#include <vector>
 #include <map>
 
 #include "zipstore/zipstore.h"
 
 #include <ngpcore/p3dcompat.h>
 #include <ngpcore/p3diostream.h>
+#include <ngpcore/p3diostreamadd.h>
 #include <ngput/p3dospath.h>
+#include <ngput/p3dthread.h>
+#include <ngput/p3dtexprep.h>
+#include <ngput/p3dtexcomp.h>
+
+#if defined(_WIN32)
+ #if defined(GetMessage)
+  #undef GetMessage
+ #endif
+#endif
 
 #include "p3dapp.h"
 #include "p3dnga.h"
 
+/* block-compressed texture copies added to bundle, stored as DDS */
+/* under source texture name with .dds appended                   */
+
+enum
+ {
+  NGATexCompNone,
+  NGATexCompAuto,
+  NGATexCompBC1,
+  NGATexCompBC1A,
+  NGATexCompBC3
+ };
+
+#define NGATexCompMaxSize (16384)
+
 static bool        IsValidFileNameChar(char                c)
  {
   return (c >= 'a' && c <= 'z') ||
@@ -81,14 +99,6 @@ static bool        IsValidFileName    (const char         *FileName)
   return true;
  }
 
-static bool        ShowConfirmationDialog
-                                      (const char         *Message)
- {
-  return wxMessageBox(wxString(Message,wxConvUTF8),
-                      wxT("Confirmation"),
-                       wxYES_NO | wxCANCEL) == wxYES;
- }
-
 static void       DisplayErrorMessage(const char          *Message)
  {
   ::wxMessageBox(wxString(Message,wxConvUTF8),wxT("Error"),wxOK | wxICON_ERROR);
@@ -212,25 +222,37 @@ class NGAMaterialSaver : public P3DMaterialSaver
                                                           *Material) const;
 
   void             SaveTextures       (ZS::Writer         &ZipWriter) const;
+  void             SaveCompressedTextures
+                                      (ZS::Writer         &ZipWriter,
+                                       unsigned int        TexComp) const;
 
   private          :
 
+  /* textures loaded from archive have no file, their image file */
+  /* contents are taken from texture manager instead             */
+  typedef struct
+   {
+    std::string    FileName;
+    const void    *Data;
+    unsigned int   Size;
+   } TextureSource;
+
   void             ProcessTextures    (const P3DMaterialInstanceSimple
                                                           *Material,
                                        P3DMaterialDef     *MaterialDef) const;
   void             ProcessTexture     (P3DMaterialDef     *MaterialDef,
                                        unsigned int        TexLayer,
                                        const char         *TexName,
-                                       const char         *FileName) const;
+                                       const TextureSource&Source) const;
 
   void             SaveTexture        (ZS::Writer         &ZipWriter,
                                        const char         *TexName,
-                                       const char         *FileName) const;
+                                       const TextureSource&Source) const;
 
   static
   std::string      TexName2NGATexName (const char         *TexName);
 
-  typedef std::map<std::string,std::string> TextureBindings;
+  typedef std::map<std::string,TextureSource> TextureBindings;
 
   mutable TextureBindings Textures;
  };
@@ -260,7 +282,6 @@ void               NGAMaterialSaver::SaveTextures
        ++Iter)
    {
     const char *TexName  = Iter->first.c_str();
-    const char *FileName = Iter->second.c_str();
 
     if (!IsValidFileName(TexName))
      {
@@ -269,7 +290,7 @@ void               NGAMaterialSaver::SaveTextures
       throw P3DExceptionGeneric(message.mb_str());
      }
 
-    SaveTexture(ZipWriter,TexName,FileName);
+    SaveTexture(ZipWriter,TexName,Iter->second);
    }
  }
 
@@ -277,11 +298,19 @@ void               NGAMaterialSaver::SaveTextures
 void               NGAMaterialSaver::SaveTexture
                                       (ZS::Writer         &ZipWriter,
                                        const char         *TexName,
-                                       const char         *FileName) const
+                                       const TextureSource&Source) const
  {
   FILE            *SrcFile;
 
-  SrcFile = fopen(FileName,"rb");
+  if (Source.Data != 0)
+   {
+    ZipWriter.BeginFile(TexName,time(NULL));
+    ZipWriter.WriteData(Source.Data,Source.Size);
+
+    return;
+   }
+
+  SrcFile = fopen(Source.FileName.c_str(),"rb");
 
   if (SrcFile == NULL)
    {
@@ -320,12 +349,95 @@ void               NGAMaterialSaver::SaveTexture
    }
  }
 
-class InFileStream : public ZS::InStream
+void               NGAMaterialSaver::SaveCompressedTextures
+                                      (ZS::Writer         &ZipWriter,
+                                       unsigned int        TexComp) const
+ {
+  P3DTexPrepQueue                      Queue(P3DApp::GetApp()->GetTexManager()->GetFmtHandler());
+  unsigned int                         ThreadCount;
+
+  ThreadCount = P3DThread::GetCPUCount();
+
+  for (TextureBindings::const_iterator Iter = Textures.begin();
+       Iter != Textures.end();
+       ++Iter)
+   {
+    if (Iter->second.Data == 0)
+     {
+      Queue.Add(Iter->second.FileName.c_str(),0);
+     }
+   }
+
+  Queue.Run(ThreadCount,NGATexCompMaxSize);
+
+  unsigned int QueueIndex = 0;
+
+  for (TextureBindings::const_iterator Iter = Textures.begin();
+       Iter != Textures.end();
+       ++Iter)
+   {
+    const P3DTexImage                 *Image;
+    P3DTexImage                        MemoryImage;
+    unsigned int                       Format;
+    P3DCompressedTexture               Texture;
+    std::vector<P3DByte>               Buffer;
+
+    if (Iter->second.Data != 0)
+     {
+      P3DPathName                      PathName(Iter->first.c_str());
+
+      if (!MemoryImage.LoadMem(P3DApp::GetApp()->GetTexManager()->GetFmtHandler(),
+                               Iter->second.Data,Iter->second.Size,
+                               PathName.GetExtension().c_str(),
+                               NGATexCompMaxSize))
+       {
+        throw P3DExceptionGeneric("Unable to load texture for compression");
+       }
+
+      Image = &MemoryImage;
+     }
+    else
+     {
+      if (Queue.GetFileName(QueueIndex) == 0)
+       {
+        throw P3DExceptionGeneric("Unable to load texture for compression");
+       }
+
+      Image = Queue.GetImage(QueueIndex++);
+     }
+
+    if      (TexComp == NGATexCompBC1)
+     {
+      Format = P3D_TEXCOMP_BC1;
+     }
+    else if (TexComp == NGATexCompBC1A)
+     {
+      Format = P3D_TEXCOMP_BC1A;
+     }
+    else if (TexComp == NGATexCompBC3)
+     {
+      Format = P3D_TEXCOMP_BC3;
+     }
+    else
+     {
+      Format = P3DCompressedTexture::SelectFormat(Image->GetSourceImage());
+     }
+
+    Texture.Create(Image,Format,ThreadCount);
+    Texture.MakeDDS(&Buffer);
+
+    ZipWriter.BeginFile((Iter->first + "." + P3DCompressedTexture::GetContainerExt(P3D_TEXCOMP_CONTAINER_DDS)).c_str(),
+                        time(NULL));
+    ZipWriter.WriteData(&Buffer[0],Buffer.size());
+   }
+ }
+
+// archive is mapped into memory, so entries can be accessed in place
+class InMappedStream : public ZS::InStream
  {
   public           :
 
-                   InFileStream       (const char         *fileName);
-  virtual         ~InFileStream       ();
+                   InMappedStream     (const char         *fileName);
 
   virtual void               Read     (void               *dest,
                                        size_t              size);
@@ -334,72 +446,62 @@ class InFileStream : public ZS::InStream
   virtual unsigned long      GetPos   () const;
   virtual void               Seek     (unsigned long       pos);
 
-  public           :
+  virtual const void        *GetData  () const;
 
-  FILE            *file;
+  private          :
+
+  P3DInputStringStreamMMap   mapping;
+  unsigned long              pos;
  };
 
-InFileStream::InFileStream            (const char         *fileName)
+InMappedStream::InMappedStream        (const char         *fileName)
  {
-  file = fopen(fileName,"rb");
+  mapping.Open(fileName);
 
-  if (file == NULL)
-   {
-    throw ZS::Error(ZS::Error::IO_ERROR);
-   }
- }
-
-InFileStream::~InFileStream           ()
- {
-  if (fclose(file) != 0)
-   {
-    throw ZS::Error(ZS::Error::IO_ERROR);
-   }
+  pos = 0;
  }
 
 void
-InFileStream::Read                    (void               *dest,
+InMappedStream::Read                  (void               *dest,
                                        size_t              size)
  {
-  if (fread(dest,1,size,file) != size)
+  if (size > GetSize() - pos)
    {
     throw ZS::Error(ZS::Error::IO_ERROR);
    }
+
+  memcpy(dest,(const char*)mapping.GetData() + pos,size);
+
+  pos += size;
  }
 
 unsigned long
-InFileStream::GetSize                 () const
+InMappedStream::GetSize               () const
  {
-  unsigned long currPos = GetPos();
-
-  if (fseek(file,0,SEEK_END) != 0)
-   {
-    throw ZS::Error(ZS::Error::IO_ERROR);
-   }
-
-  unsigned long size = GetPos();
-
-  if (fseek(file,currPos,SEEK_SET) != 0)
-   {
-    throw ZS::Error(ZS::Error::IO_ERROR);
-   }
-
-  return size;
+  return mapping.GetSize();
  }
 
 unsigned long
-InFileStream::GetPos                  () const
+InMappedStream::GetPos                () const
  {
-  return ftell(file);
+  return pos;
  }
 
 void
-InFileStream::Seek                    (unsigned long       pos)
+InMappedStream::Seek                  (unsigned long       pos)
  {
-  if (fseek(file,pos,SEEK_SET) != 0)
+  if (pos > GetSize())
    {
     throw ZS::Error(ZS::Error::IO_ERROR);
    }
+
+  this->pos = pos;
+ }
+
+const void*
+InMappedStream::GetData               () const
+ {
+  return mapping.GetData();
  }
 
 void               NGAMaterialSaver::ProcessTextures
@@ -413,11 +515,21 @@ void               NGAMaterialSaver::ProcessTextures
 
     if (TexName != 0)
      {
-      const char *FileName = Material->GetTexFileName(LayerIndex);
+      const char   *FileName = Material->GetTexFileName(LayerIndex);
+      TextureSource Source;
+
+      Source.Size = 0;
+      Source.Data = Material->GetTexSourceData(LayerIndex,&Source.Size);
 
-      if (FileName != 0)
+      if (Source.Data != 0)
        {
-        ProcessTexture(MaterialDef,LayerIndex,TexName,FileName);
+        ProcessTexture(MaterialDef,LayerIndex,TexName,Source);
+       }
+      else if (FileName != 0 && *FileName != '\0')
+       {
+        Source.FileName = FileName;
+
+        ProcessTexture(MaterialDef,LayerIndex,TexName,Source);
        }
      }
    }
@@ -427,17 +539,17 @@ void               NGAMaterialSaver::ProcessTexture
                                       (P3DMaterialDef     *MaterialDef,
                                        unsigned int        TexLayer,
                                        const char         *TexName,
-                                       const char         *FileName) const
+                                       const TextureSource&Source) const
  {
   std::string                     NGATexName = TexName2NGATexName(TexName);
   TextureBindings::const_iterator Entry      = Textures.find(NGATexName);
-  std::string                     FileNameStr(FileName);
 
   if      (Entry == Textures.end())
    {
-    Textures[NGATexName] = FileNameStr;
+    Textures[NGATexName] = Source;
    }
-  else if (Entry->second == FileNameStr)
+  else if ((Entry->second.Data == Source.Data) &&
+           (Entry->second.FileName == Source.FileName))
    {
     // Textures array already contains this texture
    }
@@ -483,20 +595,29 @@ static void        SaveTextures       (ZS::Writer          &ZipWriter,
   MaterialSaver.SaveTextures(ZipWriter);
  }
 
-static void        WriteNGPToNGA      (ZS::Writer          &ZipWriter)
+static void        WriteNGPToNGA      (ZS::Writer          &ZipWriter,
+                                       unsigned int         TexComp)
  {
   NGAMaterialSaver    MaterialSaver;
 
   SaveModel(ZipWriter,MaterialSaver);
   SaveTextures(ZipWriter,MaterialSaver);
+
+  if (TexComp != NGATexCompNone)
+   {
+    MaterialSaver.SaveCompressedTextures(ZipWriter,TexComp);
+   }
  }
 
-static void       ExportToFile        (const char          *FileName)
+static void       ExportToFile        (const char          *FileName,
+                                       unsigned int         TexComp)
  {
   OutFileStream   OutStream(FileName);
-  ZS::Writer      ZipWriter(OutStream);
+  ZS::Writer      ZipWriter(OutStream,
+                            ZS::Writer::DEFAULT_COMPRESSION,
+                            P3DThread::GetCPUCount());
 
-  WriteNGPToNGA(ZipWriter);
+  WriteNGPToNGA(ZipWriter,TexComp);
 
   ZipWriter.Close();
  }
@@ -514,9 +635,29 @@ void              P3DNGAExport       ()
 
   if (!FileName.empty())
    {
+    wxString       TexCompChoices[] =
+     {
+      wxT("None (source images only)"),
+      wxT("Auto (BC1, BC1 with 1-bit alpha or BC3)"),
+      wxT("BC1"),
+      wxT("BC1 with 1-bit alpha"),
+      wxT("BC3")
+     };
+    int            TexComp;
+
+    TexComp = ::wxGetSingleChoiceIndex(wxT("Add block-compressed (DDS) copies of textures:"),
+                                       wxT("Texture compression"),
+                                       sizeof(TexCompChoices) / sizeof(TexCompChoices[0]),
+                                       TexCompChoices);
+
+    if (TexComp < 0)
+     {
+      return;
+     }
+
     try
      {
-      ExportToFile(FileName.mb_str());
+      ExportToFile(FileName.mb_str(),TexComp);
      }
     catch (P3DException &e)
      {
@@ -529,216 +670,198 @@ void              P3DNGAExport       ()
    }
  }
 
-static bool        FileExists         (const char         *FileName)
+static bool        StrEqualIgnoreCase (const char          *S1,
+                                       const char          *S2)
  {
-  struct stat Info;
+  while (tolower(*S1) == tolower(*S2) && *S1 != '\0' && *S2 != '\0')
+   {
+    S1++;
+    S2++;
+   }
 
-  return stat(FileName,&Info) == 0;
+  return *S1 == *S2;
  }
 
-static void        MkDir              (const char         *DirName)
+static bool        IsNGPFile          (const char          *FileName)
  {
-  #if !defined(_WIN32)
-  if (mkdir(DirName,0777) != 0)
-  #else
-  if (mkdir(DirName) != 0)
-  #endif
-   {
-    throw P3DExceptionGeneric("unable to create directory");
-   }
+  P3DPathName      PathName(FileName);
+
+  return StrEqualIgnoreCase(PathName.GetExtension().c_str(),"ngp");
  }
 
-static void        MkDirIfNotExists   (const char         *DirName)
+// returns entry contents - in place if entry is stored, otherwise
+// it is decompressed into Buffer
+static const void *GetFileData        (ZS::Reader::File    &File,
+                                       std::vector<char>   &Buffer)
  {
-  if (!FileExists(DirName))
+  const void *Data = File.GetData();
+
+  if (Data == 0)
    {
-    MkDir(DirName);
+    // one extra byte keeps &Buffer[0] valid for empty entries
+    Buffer.resize(File.GetSize() + 1);
+
+    File.Read(&Buffer[0],File.GetSize());
+
+    Data = &Buffer[0];
    }
+
+  return Data;
  }
 
-static FILE       *CreateFileInDir    (const char         *FileName,
-                                       const char         *DirName)
- {
-  std::string DirPrefix(DirName);
+namespace {
 
-  const char *Ptr = strchr(FileName,'/');
+// keeps textures loaded from archive alive until model which uses
+// them is loaded
+class NGATextureSet
+ {
+  public           :
 
-  while (Ptr != NULL)
-   {
-    std::string PartDirName = DirPrefix + '/' + std::string(FileName,Ptr - FileName);
+                  ~NGATextureSet      ();
 
-    MkDirIfNotExists(PartDirName.c_str());
+  void             Load               (ZS::Reader::File    &File,
+                                       const char          *GenericName);
 
-    Ptr = strchr(Ptr + 1,'/');
-   }
+  private          :
 
-  std::string FullFileName(DirPrefix + '/' + FileName);
+  std::vector<P3DTexHandle> Handles;
+ };
 
-  if (FileExists(FullFileName.c_str()))
+                   NGATextureSet::~NGATextureSet
+                                      ()
+ {
+  for (unsigned int Index = 0; Index < Handles.size(); Index++)
    {
-    std::string ConfirmationMessage(std::string("Do you want to overwrite file ") + FullFileName + "?");
-
-    if (!ShowConfirmationDialog(ConfirmationMessage.c_str()))
-     {
-      throw P3DExceptionGeneric("Import cancelled");
-     }
+    P3DApp::GetApp()->GetTexManager()->FreeTexture(Handles[Index]);
    }
+ }
+
+void               NGATextureSet::Load(ZS::Reader::File    &File,
+                                       const char          *GenericName)
+ {
+  std::vector<char> Buffer;
+  wxString          ErrorMessage;
+  const void       *Data = GetFileData(File,Buffer);
 
-  FILE *DestFile = fopen(FullFileName.c_str(),"wb");
+  P3DTexHandle Handle = P3DApp::GetApp()->GetTexManager()->LoadFromMemory
+                         (GenericName,Data,File.GetSize(),ErrorMessage);
 
-  if (DestFile == NULL)
+  // unsupported and broken images are skipped, like missing
+  // textures are skipped when model is loaded from file
+  if (Handle != P3DTexHandleNULL)
    {
-    throw P3DExceptionGeneric("unable to create file");
+    Handles.push_back(Handle);
    }
-
-  return DestFile;
  }
+}
 
-static void        UnpackIntoFile     (FILE               *DestFile,
-                                       ZS::Reader::File   &SrcFile)
+static void        LoadTextures       (ZS::Reader          &Reader,
+                                       NGATextureSet       &Textures)
  {
-  char             Buffer[8 * 1024];
-  size_t           BytesToCopy;
-  size_t           BytesToRead;
+  std::string      Prefix(std::string(P3D_LOCAL_TEXTURES_PATH) + "/");
+  unsigned int     NGPCount = 0;
 
-  BytesToCopy = SrcFile.GetSize();
-  BytesToRead = sizeof(Buffer);
+  Reader.SeekFirst();
 
-  while (BytesToCopy > 0)
+  while (!Reader.IsEOF())
    {
-    if (BytesToRead > BytesToCopy)
+    ZS::Reader::File CurrFile = Reader.GetFile();
+    const char      *FileName = CurrFile.GetName();
+
+    if      (IsNGPFile(FileName))
      {
-      BytesToRead = BytesToCopy;
+      NGPCount++;
      }
-
-    SrcFile.Read(Buffer,BytesToRead);
-
-    if (fwrite(Buffer,1,BytesToRead,DestFile) != BytesToRead)
+    else if (strncmp(FileName,Prefix.c_str(),Prefix.length()) == 0)
      {
-      throw P3DExceptionGeneric("file write error");
+      Textures.Load(CurrFile,FileName + Prefix.length());
      }
 
-    BytesToCopy -= BytesToRead;
+    Reader.SeekNext();
    }
- }
-
-static void        UnpackFileFromZip  (const char         *DestDir,
-                                       ZS::Reader::File   &File)
- {
-  FILE       *DestFile;
-  const char *FileName;
-
-  FileName = File.GetName();
 
-  if (!IsValidFileName(FileName))
+  if      (NGPCount == 0)
    {
-    throw P3DExceptionGeneric("invalid filename inside .nga archive found");
+    throw P3DExceptionGeneric(".nga file is broken - it does not contain .ngp entry");
    }
-
-  DestFile = CreateFileInDir(FileName,DestDir);
-
-  UnpackIntoFile(DestFile,File);
-
-  if (fclose(DestFile) != 0)
+  else if (NGPCount > 1)
    {
-    throw P3DExceptionGeneric("error while unpacking file");
+    throw P3DExceptionGeneric(".nga file is broken - it contains more than one .ngp entry");
    }
  }
 
-static bool        StrEqualIgnoreCase (const char          *S1,
-                                       const char          *S2)
+static P3DPlantModel
+                  *LoadModel          (ZS::Reader          &Reader)
  {
-  while (tolower(*S1) == tolower(*S2) && *S1 != '\0' && *S2 != '\0')
+  Reader.SeekFirst();
+
+  while (!IsNGPFile(Reader.GetFile().GetName()))
    {
-    S1++;
-    S2++;
+    Reader.SeekNext();
    }
 
-  return *S1 == *S2;
- }
-
-static bool        IsNGPFile          (const char          *FileName)
- {
-  P3DPathName      PathName(FileName);
-
-  return StrEqualIgnoreCase(PathName.GetExtension().c_str(),"ngp");
- }
+  ZS::Reader::File  NGPFile = Reader.GetFile();
+  std::vector<char> Buffer;
+  const void       *Data    = GetFileData(NGPFile,Buffer);
 
-static std::string UnpackNGA          (const char          *DestDir,
-                                       ZS::Reader          &Reader)
- {
-  std::string      NGPFileName;
+  P3DInputStringStreamMemory       SourceStream(Data,NGPFile.GetSize());
+  P3DIDEMaterialFactory            MaterialFactory
+                                    (P3DApp::GetApp()->GetTexManager(),
+                                     P3DApp::GetApp()->GetShaderManager());
 
-  Reader.SeekFirst();
+  P3DPlantModel *Model = new P3DPlantModel();
 
-  while (!Reader.IsEOF())
+  try
    {
-    ZS::Reader::File CurrFile = Reader.GetFile();
-
-    if (IsNGPFile(CurrFile.GetName()))
-     {
-      if (NGPFileName.empty())
-       {
-        NGPFileName = CurrFile.GetName();
-       }
-      else
-       {
-        throw P3DExceptionGeneric(".nga file is broken - it contains more than one .ngp entry");
-       }
-     }
-
-    UnpackFileFromZip(DestDir,CurrFile);
-
-    Reader.SeekNext();
+    Model->Load(&SourceStream,&MaterialFactory);
    }
-
-  if (NGPFileName.empty())
+  catch (...)
    {
-    throw P3DExceptionGeneric(".nga file is broken - it does not contain .ngp entry");
+    delete Model;
+
+    throw;
    }
 
-  return std::string(DestDir) + '/' + NGPFileName;
+  return Model;
  }
 
-static std::string ImportFromFile     (const char          *DestDir,
-                                       const char          *FileName)
+static P3DPlantModel
+                  *ImportFromFile     (const char          *FileName)
  {
-  InFileStream     InStream(FileName);
+  InMappedStream   InStream(FileName);
   ZS::Reader       Reader(InStream);
+  NGATextureSet    Textures;
 
-  MkDirIfNotExists(DestDir);
+  LoadTextures(Reader,Textures);
 
-  return UnpackNGA(DestDir,Reader);
+  return LoadModel(Reader);
  }
 
-std::string        P3DNGAImport       ()
+P3DPlantModel     *P3DNGAImport       ()
  {
-  std::string      NGPFileName;
+  P3DPlantModel   *Model;
   wxString         FileName;
 
+  Model = 0;
+
   FileName = ::wxFileSelector(wxT("File name"),wxT(""),wxT(""),wxT(".nga"),wxT("*.nga"),wxFD_OPEN | wxFD_FILE_MUST_EXIST);
 
   if (!FileName.empty())
    {
-    wxString DestDir = ::wxDirSelector(wxT("Choose a folder to unpack .nga to"));
-
-    if (!DestDir.empty())
+    try
      {
-      try
-       {
-        NGPFileName = ImportFromFile(DestDir.mb_str(),FileName.mb_str());
-       }
-      catch (P3DException &e)
-       {
-        DisplayErrorMessage(e.GetMessage());
-       }
-      catch (ZS::Error &e)
-       {
-        DisplayErrorMessage(e.GetMessage());
-       }
+      Model = ImportFromFile(FileName.mb_str());
+     }
+    catch (P3DException &e)
+     {
+      DisplayErrorMessage(e.GetMessage());
+     }
+    catch (ZS::Error &e)
+     {
+      DisplayErrorMessage(e.GetMessage());
      }
    }
 
-  return NGPFileName;
+  return Model;
  }
 
@@ -21,10 +21,12 @@
 #ifndef __P3DNGA_H__
 #define __P3DNGA_H__
 
-#include <string>
+#include <ngpcore/p3dmodel.h>
 
 extern void        P3DNGAExport       ();
-extern std::string P3DNGAImport       ();
+/* loads model and its textures directly from .nga, returns 0 on failure */
+extern P3DPlantModel
+                  *P3DNGAImport       ();
 
 #endif
 
@@ -0,0 +1,845 @@
+/***************************************************************************
+
+ Copyright (C) 2007  Sergey Prokhorchuk
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***************************************************************************/
+
+#include <string.h>
+#include <stdio.h>
+#include <limits.h>
+
+extern "C"
+ {
+  #include <lua.h>
+  #include <lauxlib.h>
+  #include <lualib.h>
+ }
+
+#include <ngpcore/p3ddefs.h>
+#include <ngpcore/p3dcompat.h>
+
+#include <p3dplugluactl.h>
+#include <p3dplugluabuf.h>
+
+#ifndef LUA_FILEHANDLE
+ #define LUA_FILEHANDLE "FILE*"
+#endif
+
+#define StaticArraySize(Array) (sizeof(Array) / sizeof((Array)[0]))
+
+/* Buffer data is stored right after the header in the same userdata block, */
+/* so no __gc method is needed                                              */
+typedef struct
+ {
+  unsigned int                         ElemType;
+  unsigned int                         ElementCount;
+  unsigned int                         ComponentCount;
+  unsigned int                         Reserved; /* keeps data 8-byte aligned */
+ } NGPLUABuffer;
+
+#define NGPLUA_FORMAT_MAX_SPECS     (32)
+#define NGPLUA_FORMAT_MAX_NUM_WIDTH (2)
+#define NGPLUA_FORMAT_MAX_VALUE_LEN (256)
+
+typedef struct
+ {
+  const char                          *Text;        /* literal text preceding conversion */
+  unsigned int                         TextLength;
+  int                                  ScalarIndex; /* -1 if there is no conversion */
+  bool                                 IsInteger;
+  bool                                 IsSigned;
+  char                                 Conv[16];
+ } NGPLUAFormatSpec;
+
+static char        BufferMetaTableName[] = "NGPLUABuffer_MT";
+
+static char        ErrorMessageOutOfMemory[]  = "out of memory";
+static char        ErrorMessageClosedFile[]   = "attempt to use a closed file";
+static char        ErrorMessageWriteError[]   = "error writing to file";
+static char        ErrorMessageInvalidRange[] = "invalid buffer range";
+
+static void       *BufferGetData      (NGPLUABuffer       *Buffer)
+ {
+  return(Buffer + 1);
+ }
+
+static double      BufferGetScalar    (NGPLUABuffer       *Buffer,
+                                       unsigned int        Index)
+ {
+  if (Buffer->ElemType == P3D_FLOAT)
+   {
+    return(((const float*)BufferGetData(Buffer))[Index]);
+   }
+  else
+   {
+    return(((const unsigned int*)BufferGetData(Buffer))[Index]);
+   }
+ }
+
+static void        BufferPushScalar   (P3DPlugLUAControl  *Control,
+                                       NGPLUABuffer       *Buffer,
+                                       unsigned int        Index)
+ {
+  if (Buffer->ElemType == P3D_FLOAT)
+   {
+    Control->PushFloat(((const float*)BufferGetData(Buffer))[Index]);
+   }
+  else
+   {
+    Control->PushUInt(((const unsigned int*)BufferGetData(Buffer))[Index]);
+   }
+ }
+
+static void        BufferPushElement  (P3DPlugLUAControl  *Control,
+                                       NGPLUABuffer       *Buffer,
+                                       unsigned int        ElementIndex)
+ {
+  unsigned int                         ScalarIndex;
+
+  ScalarIndex = ElementIndex * Buffer->ComponentCount;
+
+  if (Buffer->ComponentCount == 1)
+   {
+    BufferPushScalar(Control,Buffer,ScalarIndex);
+   }
+  else
+   {
+    Control->PushNewTable();
+
+    for (unsigned int Component = 0; Component < Buffer->ComponentCount; Component++)
+     {
+      if (Buffer->ElemType == P3D_FLOAT)
+       {
+        Control->SetTableFloat
+         (Component + 1,((const float*)BufferGetData(Buffer))[ScalarIndex + Component]);
+       }
+      else
+       {
+        Control->SetTableUInt
+         (Component + 1,((const unsigned int*)BufferGetData(Buffer))[ScalarIndex + Component]);
+       }
+     }
+   }
+ }
+
+/* Parses optional First and Count arguments (in elements, First is 1-based) */
+static void        BufferGetArgRange  (P3DPlugLUAControl  *Control,
+                                       NGPLUABuffer       *Buffer,
+                                       unsigned int        FirstArgIndex,
+                                       unsigned int       *First,
+                                       unsigned int       *Count)
+ {
+  *First = Control->GetArgUIntOpt(FirstArgIndex,1);
+
+  if ((*First < 1) || (*First > Buffer->ElementCount + 1))
+   {
+    Control->RaiseError(ErrorMessageInvalidRange);
+
+    return;
+   }
+
+  *First -= 1;
+
+  *Count = Control->GetArgUIntOpt(FirstArgIndex + 1,Buffer->ElementCount - *First);
+
+  if (*Count > Buffer->ElementCount - *First)
+   {
+    Control->RaiseError(ErrorMessageInvalidRange);
+   }
+ }
+
+static FILE       *BufferGetArgFile   (P3DPlugLUAControl  *Control,
+                                       unsigned int        ArgIndex)
+ {
+  FILE                               **FileHandle;
+
+  FileHandle = (FILE**)Control->GetArgUserData(ArgIndex,LUA_FILEHANDLE);
+
+  if ((FileHandle != NULL) && (*FileHandle == NULL))
+   {
+    Control->RaiseError(ErrorMessageClosedFile);
+
+    return(NULL);
+   }
+
+  return(FileHandle != NULL ? *FileHandle : NULL);
+ }
+
+static bool        FormatAppendChar   (NGPLUAFormatSpec   *Spec,
+                                       unsigned int       *Length,
+                                       char                Char)
+ {
+  if (*Length + 3 >= sizeof(Spec->Conv)) /* reserve space for 'l', conversion and '\0' */
+   {
+    return(false);
+   }
+
+  Spec->Conv[(*Length)++] = Char;
+
+  return(true);
+ }
+
+static bool        FormatAppendNumber (NGPLUAFormatSpec   *Spec,
+                                       unsigned int       *Length,
+                                       const char        **Ptr)
+ {
+  unsigned int                         DigitCount;
+
+  DigitCount = 0;
+
+  while ((**Ptr >= '0') && (**Ptr <= '9'))
+   {
+    if ((DigitCount == NGPLUA_FORMAT_MAX_NUM_WIDTH) ||
+        (!FormatAppendChar(Spec,Length,**Ptr)))
+     {
+      return(false);
+     }
+
+    DigitCount++;
+    (*Ptr)++;
+   }
+
+  return(true);
+ }
+
+/* Splits printf-like format into literal text runs and single-value       */
+/* conversions. Supported conversions are f,e,E,g,G (floating point) and   */
+/* d,i,u,x,X,o (integer). Conversion may refer to record scalar explicitly */
+/* using "%N$" syntax, otherwise scalars are consumed sequentially         */
+static const char *FormatCompile      (NGPLUAFormatSpec   *Specs,
+                                       unsigned int       *SpecCount,
+                                       const char         *Format,
+                                       unsigned int        ScalarsPerRecord)
+ {
+  const char                          *Text;
+  const char                          *Ptr;
+  unsigned int                         NextScalar;
+
+  *SpecCount = 0;
+  NextScalar = 0;
+  Text       = Format;
+
+  while (true)
+   {
+    NGPLUAFormatSpec                  *Spec;
+    const char                        *Start;
+    unsigned int                       Position;
+    unsigned int                       Length;
+
+    if (*SpecCount == NGPLUA_FORMAT_MAX_SPECS)
+     {
+      return("format string is too complex");
+     }
+
+    Spec = &Specs[(*SpecCount)++];
+    Ptr  = Text;
+
+    while ((*Ptr != 0) && (*Ptr != '%'))
+     {
+      Ptr++;
+     }
+
+    Spec->Text        = Text;
+    Spec->TextLength  = Ptr - Text;
+    Spec->ScalarIndex = -1;
+
+    if (*Ptr == 0)
+     {
+      return(NULL);
+     }
+
+    Ptr++;
+
+    if (*Ptr == '%')
+     {
+      Spec->TextLength++; /* keep single '%' as a literal */
+
+      Text = Ptr + 1;
+
+      continue;
+     }
+
+    Start    = Ptr;
+    Position = 0;
+
+    while ((*Ptr >= '0') && (*Ptr <= '9') && (Position < 10000))
+     {
+      Position = Position * 10 + (*Ptr - '0');
+
+      Ptr++;
+     }
+
+    if ((*Ptr == '$') && (Ptr > Start))
+     {
+      if (Position == 0)
+       {
+        return("invalid scalar position in format string");
+       }
+
+      Spec->ScalarIndex = Position - 1;
+
+      Ptr++;
+     }
+    else
+     {
+      Spec->ScalarIndex = NextScalar++;
+
+      Ptr = Start;
+     }
+
+    if ((unsigned int)Spec->ScalarIndex >= ScalarsPerRecord)
+     {
+      return("format string refers to nonexistent record item");
+     }
+
+    Length = 0;
+
+    FormatAppendChar(Spec,&Length,'%');
+
+    while ((*Ptr != 0) && (strchr("-+ #0",*Ptr) != NULL))
+     {
+      if (!FormatAppendChar(Spec,&Length,*Ptr))
+       {
+        return("invalid format string");
+       }
+
+      Ptr++;
+     }
+
+    if (!FormatAppendNumber(Spec,&Length,&Ptr))
+     {
+      return("invalid format string");
+     }
+
+    if (*Ptr == '.')
+     {
+      FormatAppendChar(Spec,&Length,'.');
+
+      Ptr++;
+
+      if (!FormatAppendNumber(Spec,&Length,&Ptr))
+       {
+        return("invalid format string");
+       }
+     }
+
+    if ((*Ptr != 0) && (strchr("feEgG",*Ptr) != NULL))
+     {
+      Spec->IsInteger = false;
+      Spec->IsSigned  = true;
+     }
+    else if ((*Ptr != 0) && (strchr("di",*Ptr) != NULL))
+     {
+      Spec->IsInteger = true;
+      Spec->IsSigned  = true;
+     }
+    else if ((*Ptr != 0) && (strchr("uxXo",*Ptr) != NULL))
+     {
+      Spec->IsInteger = true;
+      Spec->IsSigned  = false;
+     }
+    else
+     {
+      return("invalid conversion in format string");
+     }
+
+    if (Spec->IsInteger)
+     {
+      Spec->Conv[Length++] = 'l';
+     }
+
+    Spec->Conv[Length++] = *Ptr;
+    Spec->Conv[Length]   = 0;
+
+    Text = Ptr + 1;
+   }
+ }
+
+class NGPLUAWriteBuffer
+ {
+  public           :
+
+                   NGPLUAWriteBuffer  (FILE               *File)
+   {
+    this->File = File;
+    Size       = 0;
+    Ok         = true;
+   }
+
+  void             Flush              ()
+   {
+    if ((Size > 0) && (Ok))
+     {
+      Ok = fwrite(Data,1,Size,File) == Size;
+     }
+
+    Size = 0;
+   }
+
+  void             Write              (const char         *Text,
+                                       unsigned int        Length)
+   {
+    if (Size + Length > sizeof(Data))
+     {
+      Flush();
+
+      if (Length > sizeof(Data))
+       {
+        if (Ok)
+         {
+          Ok = fwrite(Text,1,Length,File) == Length;
+         }
+
+        return;
+       }
+     }
+
+    memcpy(&Data[Size],Text,Length);
+
+    Size += Length;
+   }
+
+  char            *Reserve            (unsigned int        Length)
+   {
+    if (Size + Length > sizeof(Data))
+     {
+      Flush();
+     }
+
+    return(&Data[Size]);
+   }
+
+  void             Commit             (unsigned int        Length)
+   {
+    Size += Length;
+   }
+
+  bool             IsOk               () const
+   {
+    return(Ok);
+   }
+
+  private          :
+
+  FILE            *File;
+  char             Data[8192];
+  unsigned int     Size;
+  bool             Ok;
+ };
+
+static bool        FormatValue        (NGPLUAWriteBuffer  *Output,
+                                       const NGPLUAFormatSpec
+                                                          *Spec,
+                                       double              Value)
+ {
+  char                                *Dest;
+  int                                  Length;
+
+  Dest = Output->Reserve(NGPLUA_FORMAT_MAX_VALUE_LEN);
+
+  if      (!Spec->IsInteger)
+   {
+    Length = snprintf(Dest,NGPLUA_FORMAT_MAX_VALUE_LEN,Spec->Conv,Value);
+   }
+  else if (Spec->IsSigned)
+   {
+    Length = snprintf(Dest,NGPLUA_FORMAT_MAX_VALUE_LEN,Spec->Conv,(long)Value);
+   }
+  else
+   {
+    Length = snprintf(Dest,NGPLUA_FORMAT_MAX_VALUE_LEN,Spec->Conv,
+                      Value > 0.0 ? (unsigned long)Value : 0UL);
+   }
+
+  if ((Length < 0) || (Length >= NGPLUA_FORMAT_MAX_VALUE_LEN))
+   {
+    return(false);
+   }
+
+  Output->Commit(Length);
+
+  return(true);
+ }
+
+static bool        FormatWrite        (FILE               *File,
+                                       NGPLUABuffer       *Buffer,
+                                       const NGPLUAFormatSpec
+                                                          *Specs,
+                                       unsigned int        SpecCount,
+                                       unsigned int        FirstScalar,
+                                       unsigned int        RecordCount,
+                                       unsigned int        ScalarsPerRecord)
+ {
+  NGPLUAWriteBuffer                    Output(File);
+  unsigned int                         ScalarIndex;
+
+  ScalarIndex = FirstScalar;
+
+  for (unsigned int Record = 0; Record < RecordCount; Record++)
+   {
+    for (unsigned int SpecIndex = 0; SpecIndex < SpecCount; SpecIndex++)
+     {
+      if (Specs[SpecIndex].TextLength > 0)
+       {
+        Output.Write(Specs[SpecIndex].Text,Specs[SpecIndex].TextLength);
+       }
+
+      if (Specs[SpecIndex].ScalarIndex >= 0)
+       {
+        if (!FormatValue(&Output,&Specs[SpecIndex],
+                         BufferGetScalar(Buffer,ScalarIndex + Specs[SpecIndex].ScalarIndex)))
+         {
+          return(false);
+         }
+       }
+     }
+
+    ScalarIndex += ScalarsPerRecord;
+   }
+
+  Output.Flush();
+
+  return(Output.IsOk());
+ }
+
+static int         BufferGetElementCount
+                                      (lua_State          *State)
+ {
+  P3DPlugLUAControl                    Control(State);
+  NGPLUABuffer                        *Buffer;
+
+  Buffer = (NGPLUABuffer*)Control.GetArgUserData(1,BufferMetaTableName);
+
+  Control.Commit();
+
+  Control.PushUInt(Buffer->ElementCount);
+
+  Control.Commit();
+
+  return(1);
+ }
+
+static int         BufferGetComponentCount
+                                      (lua_State          *State)
+ {
+  P3DPlugLUAControl                    Control(State);
+  NGPLUABuffer                        *Buffer;
+
+  Buffer = (NGPLUABuffer*)Control.GetArgUserData(1,BufferMetaTableName);
+
+  Control.Commit();
+
+  Control.PushUInt(Buffer->ComponentCount);
+
+  Control.Commit();
+
+  return(1);
+ }
+
+static int         BufferGet          (lua_State          *State)
+ {
+  P3DPlugLUAControl                    Control(State);
+  NGPLUABuffer                        *Buffer;
+  unsigned int                         Index;
+  unsigned int                         Component;
+
+  Buffer    = (NGPLUABuffer*)Control.GetArgUserData(1,BufferMetaTableName);
+  Index     = Control.GetArgUInt(2);
+  Component = Control.GetArgUIntOpt(3,1);
+
+  Control.Commit();
+
+  if ((Index < 1) || (Index > Buffer->ElementCount) ||
+      (Component < 1) || (Component > Buffer->ComponentCount))
+   {
+    Control.RaiseError(ErrorMessageInvalidRange);
+    Control.Commit();
+   }
+
+  BufferPushScalar(&Control,Buffer,(Index - 1) * Buffer->ComponentCount + Component - 1);
+
+  Control.Commit();
+
+  return(1);
+ }
+
+static int         BufferScale        (lua_State          *State)
+ {
+  P3DPlugLUAControl                    Control(State);
+  NGPLUABuffer                        *Buffer;
+  float                                Factor;
+  float                               *Data;
+  unsigned int                         ScalarCount;
+
+  Buffer = (NGPLUABuffer*)Control.GetArgUserData(1,BufferMetaTableName);
+  Factor = Control.GetArgFloat(2);
+
+  Control.Commit();
+
+  if (Buffer->ElemType != P3D_FLOAT)
+   {
+    Control.RaiseError("only floating point buffers can be scaled");
+    Control.Commit();
+   }
+
+  Data        = (float*)BufferGetData(Buffer);
+  ScalarCount = Buffer->ElementCount * Buffer->ComponentCount;
+
+  for (unsigned int Index = 0; Index < ScalarCount; Index++)
+   {
+    Data[Index] *= Factor;
+   }
+
+  return(0);
+ }
+
+/* Buffer:WriteFormatted(File,Format[,First[,Count[,GroupSize]]]) */
+/* Format is applied to each group of GroupSize elements          */
+static int         BufferWriteFormatted
+                                      (lua_State          *State)
+ {
+  P3DPlugLUAControl                    Control(State);
+  NGPLUABuffer                        *Buffer;
+  FILE                                *File;
+  const char                          *Format;
+  const char                          *ErrorMessage;
+  unsigned int                         First;
+  unsigned int                         Count;
+  unsigned int                         GroupSize;
+  unsigned int                         ScalarsPerRecord;
+  unsigned int                         SpecCount;
+  NGPLUAFormatSpec                     Specs[NGPLUA_FORMAT_MAX_SPECS];
+
+  Buffer    = (NGPLUABuffer*)Control.GetArgUserData(1,BufferMetaTableName);
+  File      = BufferGetArgFile(&Control,2);
+  Format    = Control.GetArgString(3);
+
+  Control.Commit();
+
+  BufferGetArgRange(&Control,Buffer,4,&First,&Count);
+
+  GroupSize = Control.GetArgUIntOpt(6,1);
+
+  Control.Commit();
+
+  if ((GroupSize == 0) || ((Count % GroupSize) != 0))
+   {
+    Control.RaiseError("element count must be a multiple of group size");
+    Control.Commit();
+   }
+
+  ScalarsPerRecord = GroupSize * Buffer->ComponentCount;
+
+  ErrorMessage = FormatCompile(Specs,&SpecCount,Format,ScalarsPerRecord);
+
+  if (ErrorMessage != NULL)
+   {
+    Control.RaiseError("%s",ErrorMessage);
+    Control.Commit();
+   }
+
+  if (!FormatWrite(File,Buffer,Specs,SpecCount,First * Buffer->ComponentCount,
+                   Count / GroupSize,ScalarsPerRecord))
+   {
+    Control.RaiseError(ErrorMessageWriteError);
+    Control.Commit();
+   }
+
+  return(0);
+ }
+
+/* Buffer:WriteBinary(File[,First[,Count]]) - writes elements as 32-bit */
+/* little-endian floats or unsigned integers                            */
+static int         BufferWriteBinary  (lua_State          *State)
+ {
+  P3DPlugLUAControl                    Control(State);
+  NGPLUABuffer                        *Buffer;
+  FILE                                *File;
+  unsigned int                         First;
+  unsigned int                         Count;
+  const unsigned char                 *Data;
+  size_t                               Size;
+  bool                                 Ok;
+
+  Buffer    = (NGPLUABuffer*)Control.GetArgUserData(1,BufferMetaTableName);
+  File      = BufferGetArgFile(&Control,2);
+
+  Control.Commit();
+
+  BufferGetArgRange(&Control,Buffer,3,&First,&Count);
+
+  Control.Commit();
+
+  Data = (const unsigned char*)BufferGetData(Buffer) +
+          (size_t)First * Buffer->ComponentCount * 4;
+  Size = (size_t)Count * Buffer->ComponentCount * 4;
+
+  #if defined(P3D_BIG_ENDIAN)
+  {
+   unsigned char                       Swapped[4096];
+
+   Ok = true;
+
+   while ((Size > 0) && (Ok))
+    {
+     size_t                            ChunkSize;
+
+     ChunkSize = Size < sizeof(Swapped) ? Size : sizeof(Swapped);
+
+     for (size_t Index = 0; Index < ChunkSize; Index += 4)
+      {
+       Swapped[Index + 0] = Data[Index + 3];
+       Swapped[Index + 1] = Data[Index + 2];
+       Swapped[Index + 2] = Data[Index + 1];
+       Swapped[Index + 3] = Data[Index + 0];
+      }
+
+     Ok = fwrite(Swapped,1,ChunkSize,File) == ChunkSize;
+
+     Data += ChunkSize;
+     Size -= ChunkSize;
+    }
+  }
+  #else
+  Ok = (Size == 0) || (fwrite(Data,1,Size,File) == Size);
+  #endif
+
+  if (!Ok)
+   {
+    Control.RaiseError(ErrorMessageWriteError);
+    Control.Commit();
+   }
+
+  return(0);
+ }
+
+static luaL_reg   BufferMethods[] =
+ {
+  { "GetElementCount"  , BufferGetElementCount   },
+  { "GetComponentCount", BufferGetComponentCount },
+  { "Get"              , BufferGet               },
+  { "Scale"            , BufferScale             },
+  { "WriteFormatted"   , BufferWriteFormatted    },
+  { "WriteBinary"      , BufferWriteBinary       }
+ };
+
+/* Numeric keys provide table-like access to buffer elements - single */
+/* component elements are returned as numbers, others as tables       */
+static int         BufferMetaIndex    (lua_State          *State)
+ {
+  P3DPlugLUAControl                    Control(State);
+  NGPLUABuffer                        *Buffer;
+
+  Buffer = (NGPLUABuffer*)Control.GetArgUserData(1,BufferMetaTableName);
+
+  Control.Commit();
+
+  if (lua_type(State,2) == LUA_TNUMBER)
+   {
+    lua_Number                         Key;
+
+    Key = lua_tonumber(State,2);
+
+    if ((Key >= 1.0) && (Key <= (lua_Number)Buffer->ElementCount) &&
+        (Key == (lua_Number)((unsigned int)Key)))
+     {
+      BufferPushElement(&Control,Buffer,(unsigned int)Key - 1);
+     }
+    else
+     {
+      Control.PushNil();
+     }
+   }
+  else
+   {
+    const char                        *Key;
+    lua_CFunction                      Func;
+
+    Key = Control.GetArgString(2);
+
+    Control.Commit();
+
+    Func = NULL;
+
+    for (unsigned int Index = 0; (Index < StaticArraySize(BufferMethods)) && (Func == NULL); Index++)
+     {
+      if (strcmp(BufferMethods[Index].name,Key) == 0)
+       {
+        Func = BufferMethods[Index].func;
+       }
+     }
+
+    if (Func != NULL)
+     {
+      Control.PushCFunction(Func);
+     }
+    else
+     {
+      Control.RaiseError("undefined method '%s'",Key);
+     }
+   }
+
+  Control.Commit();
+
+  return(1);
+ }
+
+extern void        P3DPlugLuaRegisterBuffer
+                                      (lua_State          *State)
+ {
+  P3DPlugLUAControl                    Control(State);
+
+  Control.RegisterUserData(BufferMetaTableName);
+  Control.SetMetaMethod(BufferMetaTableName,"__index",BufferMetaIndex);
+  Control.SetMetaMethod(BufferMetaTableName,"__len",BufferGetElementCount);
+
+  Control.Commit();
+ }
+
+extern void       *P3DPlugLuaPushBuffer
+                                      (P3DPlugLUAControl  *Control,
+                                       unsigned int        ElemType,
+                                       unsigned int        ElementCount,
+                                       unsigned int        ComponentCount)
+ {
+  NGPLUABuffer                        *Buffer;
+
+  if ((ComponentCount > 0) &&
+      (ElementCount > (UINT_MAX - sizeof(NGPLUABuffer)) / 4 / ComponentCount))
+   {
+    Control->RaiseError(ErrorMessageOutOfMemory);
+
+    return(NULL);
+   }
+
+  Buffer = (NGPLUABuffer*)Control->CreateUserData
+            (BufferMetaTableName,
+             sizeof(NGPLUABuffer) + ElementCount * ComponentCount * 4);
+
+  if (Buffer == NULL)
+   {
+    return(NULL);
+   }
+
+  Buffer->ElemType       = ElemType;
+  Buffer->ElementCount   = ElementCount;
+  Buffer->ComponentCount = ComponentCount;
+  Buffer->Reserved       = 0;
+
+  return(BufferGetData(Buffer));
+ }
+
@@ -0,0 +1,38 @@
+/***************************************************************************
+
+ Copyright (C) 2007  Sergey Prokhorchuk
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***************************************************************************/
+
+#ifndef __P3DPLUGLUABUF_H__
+#define __P3DPLUGLUABUF_H__
+
+#include <p3dplugluactl.h>
+
+extern void        P3DPlugLuaRegisterBuffer
+                                      (lua_State          *State);
+
+/* Pushes new buffer userdata on the Lua stack and returns pointer to its */
+/* (uninitialized) data. ElemType must be P3D_FLOAT or P3D_UNSIGNED_INT   */
+extern void       *P3DPlugLuaPushBuffer
+                                      (P3DPlugLUAControl  *Control,
+                                       unsigned int        ElemType,
+                                       unsigned int        ElementCount,
+                                       unsigned int        ComponentCount);
+
+#endif
+
@@ -162,6 +162,28 @@ unsigned int       P3DPlugLUAControl::GetArgUIntOpt
    }
  }
 
+float              P3DPlugLUAControl::GetArgFloat
+                                      (unsigned int        ArgIndex)
+ {
+  if (!Ok)
+   {
+    return(0.0f);
+   }
+
+  if (lua_isnumber(State,ArgIndex))
+   {
+    return((float)lua_tonumber(State,ArgIndex));
+   }
+  else
+   {
+    Ok = false;
+
+    PushErrorString("%d argument must be a number",ArgIndex);
+
+    return(0.0f);
+   }
+ }
+
 bool               P3DPlugLUAControl::GetArgBoolOpt
                                       (unsigned int        ArgIndex,
                                        bool                DefValue)
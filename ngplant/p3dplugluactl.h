@@ -45,6 +45,8 @@ class P3DPlugLUAControl
   bool             GetArgBoolOpt      (unsigned int        ArgIndex,
                                        bool                DefValue);
 
+  float            GetArgFloat        (unsigned int        ArgIndex);
+
   void            *GetArgUserData     (unsigned int        ArgIndex,
                                        const char         *MetaTableName);
 
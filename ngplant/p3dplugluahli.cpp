@@ -37,6 +37,7 @@ extern "C"
 
 #include <p3dplugluactl.h>
 #include <p3dplugluahli.h>
+#include <p3dplugluabuf.h>
 
 #define StaticArraySize(Array) (sizeof(Array) / sizeof((Array)[0]))
 
@@ -913,18 +914,22 @@ static int         BranchGroupGetCloneTransformBuffer
   return(3);
  }
 
+/* Group:GetVAttrBuffer(Attr[,AsBuffer]) - if AsBuffer is true, buffer */
+/* userdata is returned instead of table of tables                     */
 static int         BranchGroupGetVAttrBuffer
                                       (lua_State          *State)
  {
   P3DPlugLUAControl                    Control(State);
   NGPLUABranchGroup                   *BranchGroup;
   unsigned int                         Attr;
+  bool                                 AsBuffer;
   unsigned int                         AttrItemCount;
   unsigned int                         TotalAttrCount;
   float                               *AttrBuffer;
 
   BranchGroup = (NGPLUABranchGroup*)Control.GetArgUserData(1,BranchGroupMetaTableName);
   Attr        = Control.GetArgUInt(2);
+  AsBuffer    = Control.GetArgBoolOpt(3,false);
 
   Control.Commit();
 
@@ -934,8 +939,6 @@ static int         BranchGroupGetVAttrBuffer
     Control.Commit();
    }
 
-  Control.PushNewTable();
-
   if (Attr == P3D_ATTR_TEXCOORD0)
    {
     AttrItemCount = 2;
@@ -947,6 +950,23 @@ static int         BranchGroupGetVAttrBuffer
 
   TotalAttrCount = BranchGroup->Instance->Instance->GetVAttrCount(BranchGroup->Index,Attr);
 
+  if (AsBuffer)
+   {
+    AttrBuffer = (float*)P3DPlugLuaPushBuffer(&Control,P3D_FLOAT,TotalAttrCount,AttrItemCount);
+
+    Control.Commit();
+
+    if (TotalAttrCount > 0)
+     {
+      BranchGroup->Instance->Instance->FillVAttrBuffer
+       (AttrBuffer,BranchGroup->Index,Attr);
+     }
+
+    return(1);
+   }
+
+  Control.PushNewTable();
+
   if (TotalAttrCount > 0)
    {
     AttrBuffer = (float*)malloc(sizeof(float) * TotalAttrCount * AttrItemCount);
@@ -1187,6 +1207,112 @@ static int         BranchGroupGetVAttrIndexBuffer
   return(1);
  }
 
+/* Group:GetCornerIndexBuffer(Total,Attr1,Base1[,Attr2,Base2...]) returns   */
+/* buffer with one element per primitive corner, element components are the */
+/* indices of Attr1,Attr2,... in non-indexed vertex attribute buffers        */
+static int         BranchGroupGetCornerIndexBuffer
+                                      (lua_State          *State)
+ {
+  P3DPlugLUAControl                    Control(State);
+  NGPLUABranchGroup                   *BranchGroup;
+  bool                                 Total;
+  unsigned int                         AttrCount;
+  unsigned int                         Attrs[P3D_ATTR_BINORMAL + 1];
+  unsigned int                         Bases[P3D_ATTR_BINORMAL + 1];
+  unsigned int                         BranchCount;
+  unsigned int                         BranchVertexCount;
+  unsigned int                        *IndexBuffer;
+  unsigned int                        *CornerBuffer;
+
+  BranchGroup = (NGPLUABranchGroup*)Control.GetArgUserData(1,BranchGroupMetaTableName);
+  Total       = Control.GetArgBoolOpt(2,true);
+
+  Control.Commit();
+
+  AttrCount = lua_gettop(State) > 2 ? (lua_gettop(State) - 1) / 2 : 0;
+
+  if ((AttrCount == 0) || (AttrCount > StaticArraySize(Attrs)))
+   {
+    Control.RaiseError("invalid number of vertex attributes");
+    Control.Commit();
+   }
+
+  for (unsigned int AttrIndex = 0; AttrIndex < AttrCount; AttrIndex++)
+   {
+    Attrs[AttrIndex] = Control.GetArgUInt(3 + AttrIndex * 2);
+    Bases[AttrIndex] = Control.GetArgUInt(4 + AttrIndex * 2);
+
+    Control.Commit();
+
+    if (Attrs[AttrIndex] > P3D_ATTR_BINORMAL)
+     {
+      Control.RaiseError(ErrorMessageInvalidVAttrType);
+      Control.Commit();
+     }
+   }
+
+  if (Total)
+   {
+    BranchCount = BranchGroup->Instance->Instance->GetBranchCount
+                   (BranchGroup->Index);
+   }
+  else
+   {
+    BranchCount = 1;
+   }
+
+  BranchVertexCount = CalcVAttrVertexCount(BranchGroup->Instance->Template,
+                                           BranchGroup->Index);
+
+  CornerBuffer = (unsigned int*)P3DPlugLuaPushBuffer
+                  (&Control,P3D_UNSIGNED_INT,BranchVertexCount * BranchCount,AttrCount);
+
+  Control.Commit();
+
+  if ((BranchVertexCount > 0) && (BranchCount > 0))
+   {
+    IndexBuffer = (unsigned int*)malloc(sizeof(unsigned int) * BranchVertexCount);
+
+    if (IndexBuffer != NULL)
+     {
+      for (unsigned int AttrIndex = 0; AttrIndex < AttrCount; AttrIndex++)
+       {
+        unsigned int                   Base;
+        unsigned int                   BranchAttrCount;
+        unsigned int                  *Ptr;
+
+        Base            = Bases[AttrIndex];
+        BranchAttrCount = BranchGroup->Instance->Template->GetVAttrCount
+                           (BranchGroup->Index,Attrs[AttrIndex]);
+        Ptr             = CornerBuffer + AttrIndex;
+
+        for (unsigned int BranchIndex = 0; BranchIndex < BranchCount; BranchIndex++)
+         {
+          BranchGroup->Instance->Template->FillVAttrIndexBuffer
+           (IndexBuffer,BranchGroup->Index,Attrs[AttrIndex],P3D_UNSIGNED_INT,Base);
+
+          for (unsigned int VertexIndex = 0; VertexIndex < BranchVertexCount; VertexIndex++)
+           {
+            *Ptr = IndexBuffer[VertexIndex]; Ptr += AttrCount;
+           }
+
+          Base += BranchAttrCount;
+         }
+       }
+
+      free(IndexBuffer);
+     }
+    else
+     {
+      Control.RaiseError(ErrorMessageOutOfMemory);
+     }
+   }
+
+  Control.Commit();
+
+  return(1);
+ }
+
 static int         BranchGroupGetVAttrCountI
                                       (lua_State          *State)
  {
@@ -1260,45 +1386,18 @@ static int         BranchGroupGetVAttrBufferI
     Control.Commit();
    }
 
-  Control.PushNewTable();
-
   TotalAttrCount = BranchGroup->Instance->Instance->GetVAttrCountI(BranchGroup->Index);
 
-  if (TotalAttrCount > 0)
-   {
-    AttrBuffer = (float*)malloc(sizeof(float) * TotalAttrCount * AttrItemCount);
+  AttrBuffer = (float*)P3DPlugLuaPushBuffer(&Control,P3D_FLOAT,TotalAttrCount,AttrItemCount);
 
-    if (AttrBuffer != NULL)
-     {
-      float                           *Ptr;
-
-      VAttrBuffers.AddAttr(Attr,AttrBuffer,0,sizeof(float) * AttrItemCount);
-
-      BranchGroup->Instance->Instance->FillVAttrBuffersI
-       (&VAttrBuffers,BranchGroup->Index);
-
-      Ptr = AttrBuffer;
-
-      for (unsigned int AttrIndex = 0; AttrIndex < TotalAttrCount; AttrIndex++)
-       {
-        Control.PushNewTable();
-        Control.SetTableFloat(1,*Ptr); ++Ptr;
-        Control.SetTableFloat(2,*Ptr); ++Ptr;
-
-        if (AttrItemCount == 3)
-         {
-          Control.SetTableFloat(3,*Ptr); ++Ptr;
-         }
+  Control.Commit();
 
-        Control.SetTable(-2,AttrIndex + 1);
-       }
+  if (TotalAttrCount > 0)
+   {
+    VAttrBuffers.AddAttr(Attr,AttrBuffer,0,sizeof(float) * AttrItemCount);
 
-      free(AttrBuffer);
-     }
-    else
-     {
-      Control.RaiseError(ErrorMessageOutOfMemory);
-     }
+    BranchGroup->Instance->Instance->FillVAttrBuffersI
+     (&VAttrBuffers,BranchGroup->Index);
    }
 
   Control.Commit();
@@ -1366,8 +1465,6 @@ static int         BranchGroupGetIndexBuffer
 
   Control.Commit();
 
-  Control.PushNewTable();
-
   if (Total)
    {
     BranchCount = BranchGroup->Instance->Instance->GetBranchCount
@@ -1381,45 +1478,25 @@ static int         BranchGroupGetIndexBuffer
   BranchIndexCount = BranchGroup->Instance->Template->GetIndexCount
                       (BranchGroup->Index,P3D_TRIANGLE_LIST);
 
-  if ((BranchIndexCount > 0) && (BranchCount > 0))
-   {
-    IndexBuffer = (unsigned int*)malloc(sizeof(unsigned int) * BranchIndexCount);
-
-    if (IndexBuffer != NULL)
-     {
-      unsigned int                     BranchVertexCount;
-      unsigned int                     IndexCounter;
-
-      BranchVertexCount = BranchGroup->Instance->Template->GetVAttrCountI
-                           (BranchGroup->Index);
-
-      IndexCounter = 1;
+  IndexBuffer = (unsigned int*)P3DPlugLuaPushBuffer
+                 (&Control,P3D_UNSIGNED_INT,BranchIndexCount * BranchCount,1);
 
-      for (unsigned int BranchIndex = 0; BranchIndex < BranchCount; BranchIndex++)
-       {
-        unsigned int                  *Ptr;
-
-        BranchGroup->Instance->Template->FillIndexBuffer
-         (IndexBuffer,BranchGroup->Index,P3D_TRIANGLE_LIST,P3D_UNSIGNED_INT,Base);
-
-        Ptr = IndexBuffer;
-
-        for (unsigned int Index = 0; Index < BranchIndexCount; Index++)
-         {
-          Control.SetTableUInt(IndexCounter,*Ptr);
+  Control.Commit();
 
-          Ptr++;
-          IndexCounter++;
-         }
+  if ((BranchIndexCount > 0) && (BranchCount > 0))
+   {
+    unsigned int                       BranchVertexCount;
 
-        Base += BranchVertexCount;
-       }
+    BranchVertexCount = BranchGroup->Instance->Template->GetVAttrCountI
+                         (BranchGroup->Index);
 
-      free(IndexBuffer);
-     }
-    else
+    for (unsigned int BranchIndex = 0; BranchIndex < BranchCount; BranchIndex++)
      {
-      Control.RaiseError(ErrorMessageOutOfMemory);
+      BranchGroup->Instance->Template->FillIndexBuffer
+       (IndexBuffer,BranchGroup->Index,P3D_TRIANGLE_LIST,P3D_UNSIGNED_INT,Base);
+
+      IndexBuffer += BranchIndexCount;
+      Base        += BranchVertexCount;
      }
    }
 
@@ -1447,6 +1524,7 @@ static luaL_reg   BranchGroupMethods[] =
   { "GetPrimitiveCount"   , BranchGroupGetPrimitiveCount    },
   { "GetPrimitiveType"    , BranchGroupGetPrimitiveType     },
   { "GetVAttrIndexBuffer" , BranchGroupGetVAttrIndexBuffer  },
+  { "GetCornerIndexBuffer", BranchGroupGetCornerIndexBuffer },
   { "GetVAttrCountI"      , BranchGroupGetVAttrCountI       },
   { "GetVAttrBufferI"     , BranchGroupGetVAttrBufferI      },
   { "GetIndexCount"       , BranchGroupGetIndexCount        },
@@ -1532,6 +1610,8 @@ extern void        P3DPlugLuaRegisterHLI
 
   Control.Commit();
 
+  P3DPlugLuaRegisterBuffer(State);
+
   lua_register(State,"NGPPlantInstance",PlantInstanceCtor);
  }
 
@@ -26,6 +26,8 @@
 
 #include <stdexcept>
 
+#include <wx/stopwatch.h>
+
 #include <ngput/p3dglext.h>
 
 #include <ngpcore/p3dmodel.h>
@@ -48,6 +50,11 @@ static void       *P3DMallocEx        (size_t              Size)
   return(Result);
  }
 
+static const GLvoid *BufferOffset     (unsigned int        Offset)
+ {
+  return((const char*)0 + Offset);
+ }
+
 static void        UpdateBillboardsInfo
                                       (float              *PosBuffer,
                                        const float        *CenterPosBuffer,
@@ -125,12 +132,12 @@ static void        UpdateBillboardsInfo
                                        unsigned int        GroupIndex,
                                        unsigned int        BranchCount,
                                        bool                Hidden,
-                                       bool                UseColorArray)
+                                       bool                UseColorArray,
+                                       bool                UseCPUBillboards)
  {
   const P3DMaterialDef                *MaterialDef;
   unsigned int                         BranchVAttrCount;
   unsigned int                         BranchIndexCount;
-  unsigned int                         TotalVAttrCount;
 
   PosBuffer       = 0;
   NormalBuffer    = 0;
@@ -140,8 +147,21 @@ static void        UpdateBillboardsInfo
   CenterPosBuffer = 0;
   ColorBuffer     = 0;
 
+  BillboardCornerBuffer = 0;
+
+  TotalVAttrCount = 0;
   TotalIndexCount = 0;
 
+  VertexBufferObject = 0;
+  IndexBufferObject  = 0;
+  VertexStride       = 0;
+  NormalOffset       = 0;
+  TexCoordOffset     = 0;
+  BiNormalOffset     = 0;
+  ColorOffset        = 0;
+  CornerOffset       = 0;
+  BufferSize         = 0;
+
   this->BranchCount = BranchCount;
 
   MaterialDef = Template->GetMaterial(GroupIndex);
@@ -177,26 +197,30 @@ static void        UpdateBillboardsInfo
     MaterialData.NormalMapHandle = P3DTexHandleNULL;
    }
 
-  MaterialData.ShaderHandle =
-   P3DApp::GetApp()->GetShaderManager()->GenShader
-    (MaterialData.DiffuseTexHandle != P3DTexHandleNULL,
-     MaterialData.NormalMapHandle != P3DTexHandleNULL,
-     MaterialData.TwoSided);
-
-  MaterialData.BiNormalLocation = -1;
+  ShaderBillboards = false;
 
-  if (MaterialData.ShaderHandle != P3DShaderHandleNULL)
+  if ((MaterialData.BillboardMode != P3D_BILLBOARD_MODE_NONE) && (!UseCPUBillboards))
    {
-    GLhandleARB    ProgHandle;
+    CreateShader(MaterialData.BillboardMode);
 
-    ProgHandle = P3DApp::GetApp()->GetShaderManager()->GetProgramHandle
-                  (MaterialData.ShaderHandle);
+    ShaderBillboards = (MaterialData.BillboardCornerLocation   != -1) &&
+                       (MaterialData.BillboardHalfSizeLocation != -1);
 
-    if (ProgHandle != 0)
+    /* shaders are disabled or not supported - fall back to CPU billboards */
+    if (!ShaderBillboards)
      {
-      MaterialData.BiNormalLocation = glGetAttribLocationARB(ProgHandle,"ngp_BiNormal");
+      if (MaterialData.ShaderHandle != P3DShaderHandleNULL)
+       {
+        P3DApp::GetApp()->GetShaderManager()->FreeShader(MaterialData.ShaderHandle);
+       }
+
+      CreateShader(P3D_BILLBOARD_MODE_NONE);
      }
    }
+  else
+   {
+    CreateShader(P3D_BILLBOARD_MODE_NONE);
+   }
 
   MaterialData.Hidden = Hidden;
 
@@ -241,6 +265,24 @@ static void        UpdateBillboardsInfo
       Template->GetBillboardSize(&BillboardWidth,&BillboardHeight,GroupIndex);
      }
 
+    if (ShaderBillboards)
+     {
+      float       *Corner;
+
+      BillboardCornerBuffer = (float*)P3DMallocEx(sizeof(float) * 2 * TotalVAttrCount);
+
+      Corner = BillboardCornerBuffer;
+
+      /* same vertex order as in UpdateBillboardsInfo */
+      for (unsigned int BranchIndex = 0; BranchIndex < BranchCount; BranchIndex++)
+       {
+        *Corner++ = -1.0f; *Corner++ = -1.0f;
+        *Corner++ =  1.0f; *Corner++ = -1.0f;
+        *Corner++ = -1.0f; *Corner++ =  1.0f;
+        *Corner++ =  1.0f; *Corner++ =  1.0f;
+       }
+     }
+
     if (UseColorArray)
      {
       ColorBuffer = (float*)P3DMallocEx(sizeof(float) * 3 * TotalVAttrCount);
@@ -269,6 +311,7 @@ static void        UpdateBillboardsInfo
   catch (...)
    {
     free(ColorBuffer);
+    free(BillboardCornerBuffer);
     free(CenterPosBuffer);
     free(IndexBuffer);
     free(TexCoordBuffer);
@@ -284,6 +327,16 @@ static void        UpdateBillboardsInfo
                    P3DBranchGroupObject::~P3DBranchGroupObject
                                       ()
  {
+  if (VertexBufferObject != 0)
+   {
+    glDeleteBuffersARB(1,&VertexBufferObject);
+   }
+
+  if (IndexBufferObject != 0)
+   {
+    glDeleteBuffersARB(1,&IndexBufferObject);
+   }
+
   if (MaterialData.ShaderHandle != P3DShaderHandleNULL)
    {
     P3DApp::GetApp()->GetShaderManager()->FreeShader(MaterialData.ShaderHandle);
@@ -300,6 +353,7 @@ static void        UpdateBillboardsInfo
    }
 
   free(ColorBuffer);
+  free(BillboardCornerBuffer);
   free(CenterPosBuffer);
   free(IndexBuffer);
   free(TexCoordBuffer);
@@ -308,6 +362,177 @@ static void        UpdateBillboardsInfo
   free(PosBuffer);
  }
 
+void               P3DBranchGroupObject::CreateShader
+                                      (unsigned int        ShaderBillboardMode)
+ {
+  MaterialData.ShaderHandle =
+   P3DApp::GetApp()->GetShaderManager()->GenShader
+    (MaterialData.DiffuseTexHandle != P3DTexHandleNULL,
+     MaterialData.NormalMapHandle != P3DTexHandleNULL,
+     MaterialData.TwoSided,
+     ShaderBillboardMode);
+
+  MaterialData.BiNormalLocation          = -1;
+  MaterialData.BillboardCornerLocation   = -1;
+  MaterialData.BillboardHalfSizeLocation = -1;
+
+  if (MaterialData.ShaderHandle != P3DShaderHandleNULL)
+   {
+    GLhandleARB    ProgHandle;
+
+    ProgHandle = P3DApp::GetApp()->GetShaderManager()->GetProgramHandle
+                  (MaterialData.ShaderHandle);
+
+    if (ProgHandle != 0)
+     {
+      MaterialData.BiNormalLocation = glGetAttribLocationARB(ProgHandle,"ngp_BiNormal");
+
+      if (ShaderBillboardMode != P3D_BILLBOARD_MODE_NONE)
+       {
+        MaterialData.BillboardCornerLocation   = glGetAttribLocationARB(ProgHandle,"ngp_BillboardCorner");
+        MaterialData.BillboardHalfSizeLocation = glGetUniformLocationARB(ProgHandle,"ngp_BillboardHalfSize");
+       }
+     }
+   }
+ }
+
+bool               P3DBranchGroupObject::CreateBuffers
+                                      ()
+ {
+  unsigned int     VertexSize;
+  float           *VertexData;
+  const float     *Positions;
+  unsigned int     VertexDataSize;
+  unsigned int     IndexDataSize;
+
+  if (PosBuffer == 0) return(false);
+  if (!GLEW_ARB_vertex_buffer_object) return(false);
+
+  /* CPU billboards are rewritten on every camera change */
+  if ((MaterialData.BillboardMode != P3D_BILLBOARD_MODE_NONE) &&
+      (!ShaderBillboards)) return(false);
+
+  /* interleaved layout: position, [normal], texcoord, [binormal], */
+  /* [color], [billboard corner]                                   */
+
+  VertexSize = 3;
+
+  if (MaterialData.BillboardMode == P3D_BILLBOARD_MODE_NONE)
+   {
+    NormalOffset = VertexSize; VertexSize += 3;
+   }
+
+  TexCoordOffset = VertexSize; VertexSize += 2;
+
+  if (BiNormalBuffer != 0)
+   {
+    BiNormalOffset = VertexSize; VertexSize += 3;
+   }
+
+  if (ColorBuffer != 0)
+   {
+    ColorOffset = VertexSize; VertexSize += 3;
+   }
+
+  if (ShaderBillboards)
+   {
+    CornerOffset = VertexSize; VertexSize += 2;
+   }
+
+  VertexDataSize = sizeof(float) * VertexSize * TotalVAttrCount;
+  IndexDataSize  = sizeof(unsigned int) * TotalIndexCount;
+
+  VertexData = (float*)malloc(VertexDataSize);
+
+  if (VertexData == 0) return(false);
+
+  Positions = ShaderBillboards ? CenterPosBuffer : PosBuffer;
+
+  for (unsigned int VAttrIndex = 0; VAttrIndex < TotalVAttrCount; VAttrIndex++)
+   {
+    float         *Vertex = &VertexData[VAttrIndex * VertexSize];
+
+    Vertex[0] = Positions[VAttrIndex * 3];
+    Vertex[1] = Positions[VAttrIndex * 3 + 1];
+    Vertex[2] = Positions[VAttrIndex * 3 + 2];
+
+    if (MaterialData.BillboardMode == P3D_BILLBOARD_MODE_NONE)
+     {
+      Vertex[NormalOffset]     = NormalBuffer[VAttrIndex * 3];
+      Vertex[NormalOffset + 1] = NormalBuffer[VAttrIndex * 3 + 1];
+      Vertex[NormalOffset + 2] = NormalBuffer[VAttrIndex * 3 + 2];
+     }
+
+    Vertex[TexCoordOffset]     = TexCoordBuffer[VAttrIndex * 2];
+    Vertex[TexCoordOffset + 1] = TexCoordBuffer[VAttrIndex * 2 + 1];
+
+    if (BiNormalBuffer != 0)
+     {
+      Vertex[BiNormalOffset]     = BiNormalBuffer[VAttrIndex * 3];
+      Vertex[BiNormalOffset + 1] = BiNormalBuffer[VAttrIndex * 3 + 1];
+      Vertex[BiNormalOffset + 2] = BiNormalBuffer[VAttrIndex * 3 + 2];
+     }
+
+    if (ColorBuffer != 0)
+     {
+      Vertex[ColorOffset]     = ColorBuffer[VAttrIndex * 3];
+      Vertex[ColorOffset + 1] = ColorBuffer[VAttrIndex * 3 + 1];
+      Vertex[ColorOffset + 2] = ColorBuffer[VAttrIndex * 3 + 2];
+     }
+
+    if (ShaderBillboards)
+     {
+      Vertex[CornerOffset]     = BillboardCornerBuffer[VAttrIndex * 2];
+      Vertex[CornerOffset + 1] = BillboardCornerBuffer[VAttrIndex * 2 + 1];
+     }
+   }
+
+  /* reset error flag to detect out of memory condition below */
+  glGetError();
+
+  glGenBuffersARB(1,&VertexBufferObject);
+  glBindBufferARB(GL_ARRAY_BUFFER_ARB,VertexBufferObject);
+  glBufferDataARB(GL_ARRAY_BUFFER_ARB,VertexDataSize,VertexData,GL_STATIC_DRAW_ARB);
+  glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+
+  glGenBuffersARB(1,&IndexBufferObject);
+  glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,IndexBufferObject);
+  glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,IndexDataSize,IndexBuffer,GL_STATIC_DRAW_ARB);
+  glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
+
+  free(VertexData);
+
+  if (glGetError() != GL_NO_ERROR)
+   {
+    glDeleteBuffersARB(1,&VertexBufferObject);
+    glDeleteBuffersARB(1,&IndexBufferObject);
+
+    VertexBufferObject = 0;
+    IndexBufferObject  = 0;
+
+    return(false);
+   }
+
+  VertexStride    = sizeof(float) * VertexSize;
+  NormalOffset   *= sizeof(float);
+  TexCoordOffset *= sizeof(float);
+  BiNormalOffset *= sizeof(float);
+  ColorOffset    *= sizeof(float);
+  CornerOffset   *= sizeof(float);
+  BufferSize      = VertexDataSize + IndexDataSize;
+
+  /* PosBuffer and CenterPosBuffer are still used for selection */
+
+  free(BillboardCornerBuffer); BillboardCornerBuffer = 0;
+  free(ColorBuffer);           ColorBuffer           = 0;
+  free(IndexBuffer);           IndexBuffer           = 0;
+  free(TexCoordBuffer);        TexCoordBuffer        = 0;
+  free(BiNormalBuffer);        BiNormalBuffer        = 0;
+  free(NormalBuffer);          NormalBuffer          = 0;
+
+  return(true);
+ }
+
 float              P3DBranchGroupObject::CalcAlphaTestValue
                                       (float               LODLevel) const
  {
@@ -358,6 +583,12 @@ float              P3DBranchGroupObject::CalcAlphaTestValue
   return(AlphaTestValue);
  }
 
+bool               P3DBranchGroupObject::HaveColorArray
+                                      () const
+ {
+  return((ColorBuffer != 0) || (ColorOffset != 0));
+ }
+
 void               P3DBranchGroupObject::Render
                                       (bool                Selected) const
  {
@@ -385,7 +616,7 @@ void               P3DBranchGroupObject::RenderGroup
 
   /* material setup */
 
-  if (ColorBuffer == 0)
+  if (!HaveColorArray())
    {
     glColor3f(MaterialData.R,MaterialData.G,MaterialData.B);
    }
@@ -457,37 +688,82 @@ void               P3DBranchGroupObject::RenderGroup
 
   /* verts setup */
 
-  glVertexPointer(3,GL_FLOAT,0,PosBuffer);
+  const GLvoid    *Positions;
+  const GLvoid    *Normals;
+  const GLvoid    *TexCoords;
+  const GLvoid    *BiNormals;
+  const GLvoid    *Colors;
+  const GLvoid    *Corners;
+  const GLvoid    *Indices;
+  GLsizei          Stride;
+
+  if (VertexBufferObject != 0)
+   {
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB,VertexBufferObject);
+    glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,IndexBufferObject);
+
+    Stride    = VertexStride;
+    Positions = BufferOffset(0);
+    Normals   = BufferOffset(NormalOffset);
+    TexCoords = BufferOffset(TexCoordOffset);
+    BiNormals = BufferOffset(BiNormalOffset);
+    Colors    = BufferOffset(ColorOffset);
+    Corners   = BufferOffset(CornerOffset);
+    Indices   = BufferOffset(0);
+   }
+  else
+   {
+    Stride    = 0;
+    Positions = ShaderBillboards ? CenterPosBuffer : PosBuffer;
+    Normals   = NormalBuffer;
+    TexCoords = TexCoordBuffer;
+    BiNormals = BiNormalBuffer;
+    Colors    = ColorBuffer;
+    Corners   = BillboardCornerBuffer;
+    Indices   = IndexBuffer;
+   }
+
+  glVertexPointer(3,GL_FLOAT,Stride,Positions);
   glEnableClientState(GL_VERTEX_ARRAY);
 
-  if (MaterialData.BillboardMode == P3D_BILLBOARD_MODE_NONE)
+  if (ShaderBillboards)
    {
-    glNormalPointer(GL_FLOAT,0,NormalBuffer);
+    glEnableVertexAttribArrayARB(MaterialData.BillboardCornerLocation);
+    glVertexAttribPointerARB(MaterialData.BillboardCornerLocation,2,GL_FLOAT,GL_FALSE,Stride,Corners);
+
+    glUniform2fARB(MaterialData.BillboardHalfSizeLocation,
+                   BillboardWidth  * 0.5f,
+                   BillboardHeight * 0.5f);
+   }
+
+  if      (MaterialData.BillboardMode == P3D_BILLBOARD_MODE_NONE)
+   {
+    glNormalPointer(GL_FLOAT,Stride,Normals);
     glEnableClientState(GL_NORMAL_ARRAY);
    }
-  else
+  else if (!ShaderBillboards)
    {
     glNormal3fv(BillboardNormal);
    }
 
-  glTexCoordPointer(2,GL_FLOAT,0,TexCoordBuffer);
+  glTexCoordPointer(2,GL_FLOAT,Stride,TexCoords);
   glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 
   if (MaterialData.BiNormalLocation != -1)
    {
     glEnableVertexAttribArrayARB(MaterialData.BiNormalLocation);
-    glVertexAttribPointerARB(MaterialData.BiNormalLocation,3,GL_FLOAT,0,GL_FALSE,BiNormalBuffer);
+    glVertexAttribPointerARB(MaterialData.BiNormalLocation,3,GL_FLOAT,GL_FALSE,Stride,BiNormals);
    }
 
-  if (ColorBuffer != 0)
+  if (HaveColorArray())
    {
-    glColorPointer(3,GL_FLOAT,0,ColorBuffer);
+    glColorPointer(3,GL_FLOAT,Stride,Colors);
     glEnableClientState(GL_COLOR_ARRAY);
    }
 
-  glDrawElements(GL_TRIANGLES,TotalIndexCount,GL_UNSIGNED_INT,IndexBuffer);
+  glDrawElements(GL_TRIANGLES,TotalIndexCount,GL_UNSIGNED_INT,Indices);
 
-  if (ColorBuffer != 0)
+  if (HaveColorArray())
    {
     glDisableClientState(GL_COLOR_ARRAY);
    }
@@ -497,6 +773,11 @@ void               P3DBranchGroupObject::RenderGroup
     glDisableVertexAttribArrayARB(MaterialData.BiNormalLocation);
    }
 
+  if (ShaderBillboards)
+   {
+    glDisableVertexAttribArrayARB(MaterialData.BillboardCornerLocation);
+   }
+
   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 
   if (MaterialData.BillboardMode == P3D_BILLBOARD_MODE_NONE)
@@ -506,6 +787,12 @@ void               P3DBranchGroupObject::RenderGroup
 
   glDisableClientState(GL_VERTEX_ARRAY);
 
+  if (VertexBufferObject != 0)
+   {
+    glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+   }
+
   if (ProgHandle != 0)
    {
     glUseProgramObjectARB(0);
@@ -531,6 +818,19 @@ void               P3DBranchGroupObject::RenderSelection
  {
   if (PosBuffer == 0) return;
 
+  if (ShaderBillboards)
+   {
+    float          Normal[3];
+
+    UpdateBillboardsInfo(PosBuffer,
+                         CenterPosBuffer,
+                         Normal,
+                         MaterialData.BillboardMode,
+                         BillboardWidth,
+                         BillboardHeight,
+                         BranchCount);
+   }
+
   /* material setup */
 
   glDisable(GL_COLOR_MATERIAL);
@@ -550,20 +850,50 @@ void               P3DBranchGroupObject::RenderSelection
 
   /* verts setup */
 
-  glVertexPointer(3,GL_FLOAT,0,PosBuffer);
+  const GLvoid    *Indices;
+
+  /* expanded billboards are available in PosBuffer only */
+  if ((VertexBufferObject != 0) && (!ShaderBillboards))
+   {
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB,VertexBufferObject);
+    glVertexPointer(3,GL_FLOAT,VertexStride,BufferOffset(0));
+   }
+  else
+   {
+    glVertexPointer(3,GL_FLOAT,0,PosBuffer);
+   }
+
   glEnableClientState(GL_VERTEX_ARRAY);
 
+  if (IndexBufferObject != 0)
+   {
+    glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,IndexBufferObject);
+
+    Indices = BufferOffset(0);
+   }
+  else
+   {
+    Indices = IndexBuffer;
+   }
+
   glPolygonOffset(-1.0f,-1.0f);
   glEnable(GL_POLYGON_OFFSET_LINE);
   glPolygonMode(GL_FRONT_AND_BACK,GL_LINE);
   glDepthFunc(GL_LEQUAL);
-  glDrawElements(GL_TRIANGLES,TotalIndexCount,GL_UNSIGNED_INT,IndexBuffer);
+  glDrawElements(GL_TRIANGLES,TotalIndexCount,GL_UNSIGNED_INT,Indices);
   glDepthFunc(GL_LESS);
   glPolygonMode(GL_FRONT_AND_BACK,GL_FILL);
   glDisable(GL_POLYGON_OFFSET_LINE);
   glPolygonOffset(0.0f,0.0f);
 
   glDisableClientState(GL_VERTEX_ARRAY);
+
+  if (VertexBufferObject != 0)
+   {
+    glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+   }
+
   glEnable(GL_LIGHTING);
  }
 
@@ -572,6 +902,7 @@ void               P3DBranchGroupObject::InvalidateCamera
  {
   if (PosBuffer == 0) return;
   if (MaterialData.BillboardMode == P3D_BILLBOARD_MODE_NONE) return;
+  if (ShaderBillboards) return;
 
   UpdateBillboardsInfo(PosBuffer,
                        CenterPosBuffer,
@@ -596,7 +927,8 @@ unsigned int       P3DBranchGroupObject::GetTriangleCount
 
                    P3DPlantObject::P3DPlantObject
                                       (const P3DPlantModel*PlantModel,
-                                       bool                UseColorArray)
+                                       bool                UseColorArray,
+                                       bool                UseCPUBillboards)
  {
   P3DHLIPlantTemplate                  Template(PlantModel);
   P3DHLIPlantInstance                 *Instance;
@@ -612,6 +944,8 @@ unsigned int       P3DBranchGroupObject::GetTriangleCount
   CameraModified = false;
   TotalVertexCount   = 0;
   TotalTriangleCount = 0;
+  TotalBufferSize    = 0;
+  BufferUploadTime   = 0.0f;
 
   Template.SetDummiesEnabled(P3DApp::GetApp()->IsDummyVisible());
 
@@ -675,7 +1009,8 @@ unsigned int       P3DBranchGroupObject::GetTriangleCount
                                   GroupIndex,
                                   BranchCounts[GroupIndex],
                                   Hidden,
-                                  UseColorArray);
+                                  UseColorArray,
+                                  UseCPUBillboards);
 
       TotalVertexCount   += Groups[GroupIndex]->GetVertexCount();
       TotalTriangleCount += Groups[GroupIndex]->GetTriangleCount();
@@ -718,7 +1053,8 @@ unsigned int       P3DBranchGroupObject::GetTriangleCount
 
       for (GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
        {
-        if (Groups[GroupIndex]->MaterialData.BillboardMode != P3D_BILLBOARD_MODE_NONE)
+        if ((Groups[GroupIndex]->MaterialData.BillboardMode != P3D_BILLBOARD_MODE_NONE) &&
+            (!Groups[GroupIndex]->ShaderBillboards))
          {
           UpdateBillboardsInfo
            (Groups[GroupIndex]->PosBuffer,
@@ -730,6 +1066,18 @@ unsigned int       P3DBranchGroupObject::GetTriangleCount
             Groups[GroupIndex]->BranchCount);
          }
        }
+
+      wxStopWatch                  UploadTimer;
+
+      for (GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
+       {
+        if (Groups[GroupIndex]->CreateBuffers())
+         {
+          TotalBufferSize += Groups[GroupIndex]->BufferSize;
+         }
+       }
+
+      BufferUploadTime = (float)UploadTimer.Time();
      }
     catch (...)
      {
@@ -763,7 +1111,7 @@ unsigned int       P3DBranchGroupObject::GetTriangleCount
 
   double TimeUsed = ((double)(EndTime - StartTime)) / CLOCKS_PER_SEC;
 
-  printf("gen. time: %.04f\n",TimeUsed);
+  printf("gen. time: %.04f (VBO upload: %u bytes, %.01f ms)\n",TimeUsed,TotalBufferSize,BufferUploadTime);
   #endif
  }
 
@@ -869,3 +1217,15 @@ unsigned int       P3DPlantObject::GetTotalTriangleCount
   return(TotalTriangleCount);
  }
 
+unsigned int       P3DPlantObject::GetTotalBufferSize
+                                      () const
+ {
+  return(TotalBufferSize);
+ }
+
+float              P3DPlantObject::GetBufferUploadTime
+                                      () const
+ {
+  return(BufferUploadTime);
+ }
+
@@ -39,6 +39,8 @@ typedef struct
   float            AlphaFadeOut;
 
   GLint            BiNormalLocation;
+  GLint            BillboardCornerLocation;
+  GLint            BillboardHalfSizeLocation;
 
   bool             Hidden;
  } P3DMaterialData;
@@ -55,7 +57,8 @@ class P3DBranchGroupObject
                                        unsigned int        GroupIndex,
                                        unsigned int        BranchCount,
                                        bool                Hidden,
-                                       bool                UseColorArray);
+                                       bool                UseColorArray,
+                                       bool                UseCPUBillboards);
 
                   ~P3DBranchGroupObject
                                       ();
@@ -72,6 +75,13 @@ class P3DBranchGroupObject
 
   float            CalcAlphaTestValue (float               LODLevel) const;
 
+  void             CreateShader       (unsigned int        ShaderBillboardMode);
+  /* uploads geometry to interleaved VBO/IBO, client copies of attributes */
+  /* not needed anymore are released                                     */
+  bool             CreateBuffers      ();
+
+  bool             HaveColorArray     () const;
+
   void             RenderGroup        () const;
   void             RenderSelection    () const;
 
@@ -80,10 +90,12 @@ class P3DBranchGroupObject
   float           *BiNormalBuffer;
   float           *TexCoordBuffer;
   float           *CenterPosBuffer;
+  float           *BillboardCornerBuffer;
   float           *ColorBuffer;
 
   unsigned int    *IndexBuffer;
 
+  unsigned int     TotalVAttrCount;
   unsigned int     TotalIndexCount;
   unsigned int     BranchCount;
 
@@ -93,12 +105,26 @@ class P3DBranchGroupObject
   float            BillboardHeight;
   float            BillboardNormal[3];
 
+  /* billboards are expanded in vertex shader, PosBuffer is used */
+  /* for selection highlighting only                             */
+  bool             ShaderBillboards;
+
   bool             LODVisRangeEnabled;
   float            LODVisRangeMinLOD;
   float            LODVisRangeMaxLOD;
 
   unsigned int     VertexCount;
   unsigned int     TriangleCount;
+
+  GLuint           VertexBufferObject;
+  GLuint           IndexBufferObject;
+  unsigned int     VertexStride;
+  unsigned int     NormalOffset;
+  unsigned int     TexCoordOffset;
+  unsigned int     BiNormalOffset;
+  unsigned int     ColorOffset;
+  unsigned int     CornerOffset;
+  unsigned int     BufferSize;
  };
 
 class P3DPlantObject
@@ -106,7 +132,8 @@ class P3DPlantObject
   public           :
 
                    P3DPlantObject     (const P3DPlantModel*PlantModel,
-                                       bool                UseColorArray);
+                                       bool                UseColorArray,
+                                       bool                UseCPUBillboards);
                   ~P3DPlantObject     ();
 
   void             InvalidateCamera   ();
@@ -121,6 +148,11 @@ class P3DPlantObject
   unsigned int     GetTotalTriangleCount
                                       () const;
 
+  /* size of geometry uploaded to VBOs (in bytes) and time spent on upload */
+  /* (in milliseconds), zero if VBOs are not used                         */
+  unsigned int     GetTotalBufferSize () const;
+  float            GetBufferUploadTime() const;
+
   private          :
 
   unsigned int                         GroupCount;
@@ -130,6 +162,8 @@ class P3DPlantObject
 
   unsigned int                         TotalVertexCount;
   unsigned int                         TotalTriangleCount;
+  unsigned int                         TotalBufferSize;
+  float                                BufferUploadTime;
  };
 
 #endif
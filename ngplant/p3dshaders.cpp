@@ -22,6 +22,8 @@
 
 #include <ngput/p3dglext.h>
 
+#include <ngpcore/p3ddefs.h>
+
 #include <p3dlog.h>
 
 #include <shaders/default_vs.h>
@@ -40,24 +42,27 @@
  {
  }
 
-#define ShaderSrcDefineCount     3
+#define ShaderSrcDefineCount     4
 #define ShaderSrcHeaderLineCount  (ShaderSrcDefineCount + 1)
 
 static const char ShaderSrcEmptyLine[]            = "\n";
 static const char ShaderSrcDefineHaveDiffuseTex[] = "#define HAVE_DIFFUSE_TEX\n";
 static const char ShaderSrcDefineHaveNormalMap[]  = "#define HAVE_NORMAL_MAP\n";
 static const char ShaderSrcDefineTwoSided[]       = "#define TWO_SIDED\n";
+static const char ShaderSrcDefineBillboardSph[]   = "#define BILLBOARD\n";
+static const char ShaderSrcDefineBillboardCyl[]   = "#define BILLBOARD\n#define BILLBOARD_CYLINDRICAL\n";
 static const char ShaderSrcLineNumberSetup[]      = "#line 1\n";
 
 P3DShaderHandle    P3DShaderManager::GenShader
                                       (bool                HaveDiffuseTex,
                                        bool                HaveNormalMap,
-                                       bool                TwoSided)
+                                       bool                TwoSided,
+                                       unsigned int        BillboardMode)
  {
   P3DShaderHandle                      Handle;
   P3DShaderManagerEntry               *Entry;
 
-  Handle = FindByProps(HaveDiffuseTex,HaveNormalMap,TwoSided);
+  Handle = FindByProps(HaveDiffuseTex,HaveNormalMap,TwoSided,BillboardMode);
 
   if (Handle == P3DShaderHandleNULL)
    {
@@ -71,6 +76,7 @@ P3DShaderHandle    P3DShaderManager::GenShader
     Entry->HaveDiffuseTex = HaveDiffuseTex;
     Entry->HaveNormalMap  = HaveNormalMap;
     Entry->TwoSided       = TwoSided;
+    Entry->BillboardMode  = BillboardMode;
    }
   else
    {
@@ -207,7 +213,21 @@ static void        InitShaderHeader   (const GLcharARB    *Strings[],
                                        ShaderSrcEmptyLine;
   Strings[2] = Entry->TwoSided ? ShaderSrcDefineTwoSided :
                                  ShaderSrcEmptyLine;
-  Strings[3] = ShaderSrcLineNumberSetup;
+
+  if      (Entry->BillboardMode == P3D_BILLBOARD_MODE_SPHERICAL)
+   {
+    Strings[3] = ShaderSrcDefineBillboardSph;
+   }
+  else if (Entry->BillboardMode == P3D_BILLBOARD_MODE_CYLINDRICAL)
+   {
+    Strings[3] = ShaderSrcDefineBillboardCyl;
+   }
+  else
+   {
+    Strings[3] = ShaderSrcEmptyLine;
+   }
+
+  Strings[4] = ShaderSrcLineNumberSetup;
  }
 
 GLhandleARB        P3DShaderManager::GetProgramHandle
@@ -374,7 +394,8 @@ P3DShaderHandle    P3DShaderManager::GetUnusedSlot
 P3DShaderHandle    P3DShaderManager::FindByProps
                                       (bool                HaveDiffuseTex,
                                        bool                HaveNormalMap,
-                                       bool                TwoSided) const
+                                       bool                TwoSided,
+                                       unsigned int        BillboardMode) const
  {
   P3DShaderHandle                      Handle;
 
@@ -384,7 +405,8 @@ P3DShaderHandle    P3DShaderManager::FindByProps
      {
       if ((ShaderSet[Handle].HaveDiffuseTex == HaveDiffuseTex) &&
           (ShaderSet[Handle].HaveNormalMap  == HaveNormalMap)  &&
-          (ShaderSet[Handle].TwoSided       == TwoSided))
+          (ShaderSet[Handle].TwoSided       == TwoSided)       &&
+          (ShaderSet[Handle].BillboardMode  == BillboardMode))
        {
         return(Handle + 1);
        }
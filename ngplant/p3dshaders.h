@@ -38,6 +38,7 @@ typedef struct
   bool             HaveDiffuseTex;
   bool             HaveNormalMap;
   bool             TwoSided;
+  unsigned int     BillboardMode;
  } P3DShaderManagerEntry;
 
 class P3DShaderManager
@@ -47,9 +48,12 @@ class P3DShaderManager
                    P3DShaderManager   ();
                   ~P3DShaderManager   ();
 
+  /* BillboardMode other than P3D_BILLBOARD_MODE_NONE generates shader */
+  /* which expands billboards from center position and corner attribute */
   P3DShaderHandle  GenShader          (bool                HaveDiffuseTex,
                                        bool                HaveNormalMap,
-                                       bool                TwoSided);
+                                       bool                TwoSided,
+                                       unsigned int        BillboardMode);
   void             FreeShader         (P3DShaderHandle     ShaderHandle);
 
   GLhandleARB      GetProgramHandle   (P3DShaderHandle     ShaderHandle) const;
@@ -61,7 +65,8 @@ class P3DShaderManager
   P3DShaderHandle  GetUnusedSlot      ();
   P3DShaderHandle  FindByProps        (bool                HaveDiffuseTex,
                                        bool                HaveNormalMap,
-                                       bool                TwoSided) const;
+                                       bool                TwoSided,
+                                       unsigned int        BillboardMode) const;
 
   bool             ShadersEnabled;
 
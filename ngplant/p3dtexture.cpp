@@ -19,6 +19,8 @@
 ***************************************************************************/
 
 #include <vector>
+#include <map>
+#include <algorithm>
 
 #include <wx/wx.h>
 #include <wx/filename.h>
@@ -26,6 +28,8 @@
 
 #include <ngput/p3dglext.h>
 #include <ngput/p3dimagetga.h>
+#include <ngput/p3dospath.h>
+#include <ngput/p3dthread.h>
 #include <p3dimagewx.h>
 
 #include <p3dtexture.h>
@@ -48,6 +52,7 @@
                    P3DTexManagerGL::~P3DTexManagerGL
                                       ()
  {
+  ClearPreloaded();
  }
 
 void               P3DTexManagerGL::SetCanvas
@@ -61,145 +66,110 @@ P3DTexHandle       P3DTexManagerGL::LoadFromFile
                                        wxString           &ErrorMessage)
  {
   P3DTexHandle                         Handle;
-  P3DTexManagerGLEntry                *Entry;
-  unsigned int                         TextureChannelCount;
 
   Handle = FindByFileName(FileName);
 
   if (Handle == P3DTexHandleNULL)
    {
-    P3DImageData                       ImageData;
-    P3DImageData                       TempImageData;
-    wxString                           FileExt = wxFileName(wxString(FileName,wxConvUTF8)).GetExt();
-
-    if (!ImageFmtHandler.LoadImageData(&ImageData,FileName,FileExt.mb_str()))
-     {
-      ErrorMessage = wxT("Texture image load failed");
+    P3DTexImage                       *TexImage;
 
-      return(P3DTexHandleNULL);
-     }
+    glCanvas->SetCurrent();
 
-    std::string GenericName = P3DApp::GetApp()->GetTexFS()->System2Generic(FileName);
+    std::map<std::string,P3DTexImage*>::iterator Iter = Preloaded.find(FileName);
 
-    if (GenericName.length() == 0)
+    if (Iter != Preloaded.end())
      {
-      ErrorMessage = wxT("Texture image file located outside texture search path(s).\nPlease setup texture search path(s) in \"Preferences\" dialog.");
+      TexImage = Iter->second;
 
-      return(P3DTexHandleNULL);
+      Preloaded.erase(Iter);
      }
-
-    TextureChannelCount = ImageData.GetChannelCount();
-
-    if      (TextureChannelCount == 3)
+    else
      {
-      if (!P3DImageData::Copy(&TempImageData,&ImageData))
+      TexImage = new P3DTexImage();
+
+      if (!TexImage->Load(&ImageFmtHandler,FileName,P3DTexImage::GetGLMaxSize()))
        {
-        ErrorMessage = wxT("Out of memory");
+        delete TexImage;
 
-        return(P3DTexHandleNULL);
+        TexImage = 0;
        }
      }
-    else if (TextureChannelCount == 4)
+
+    if (TexImage == 0)
      {
-      if (!P3DImageData::RemoveAlpha(&TempImageData,&ImageData))
-       {
-        ErrorMessage = wxT("Out of memory");
+      ErrorMessage = wxT("Texture image load failed (image must be RGB or RGBA)");
 
-        return(P3DTexHandleNULL);
-       }
+      return(P3DTexHandleNULL);
+     }
 
-      /* draw alpha grid */
+    std::string GenericName = P3DApp::GetApp()->GetTexFS()->System2Generic(FileName);
 
-      for (unsigned int Y = 0; Y < ImageData.GetHeight(); Y++)
-       {
-        for (unsigned int X = 0; X < ImageData.GetWidth(); X++)
-         {
-          unsigned char                Pixel[4];
+    if (GenericName.length() == 0)
+     {
+      delete TexImage;
 
-          ImageData.GetPixel(X,Y,Pixel);
+      ErrorMessage = wxT("Texture image file located outside texture search path(s).\nPlease setup texture search path(s) in \"Preferences\" dialog.");
 
-          if (Pixel[3] == 0)
-           {
-            if ((((X / 8) + (Y / 8)) & 0x01) == 1)
-             {
-              Pixel[0] = 0xCF;
-              Pixel[1] = 0xCF;
-              Pixel[2] = 0xCF;
-             }
-            else
-             {
-              Pixel[0] = 0x80;
-              Pixel[1] = 0x80;
-              Pixel[2] = 0x80;
-             }
-
-            TempImageData.PutPixel(X,Y,Pixel);
-           }
-         }
-       }
+      return(P3DTexHandleNULL);
      }
-    else
-     {
-      ErrorMessage = wxT("Texture must be RGB or RGBA");
 
+    Handle = CreateEntry(TexImage,FileName,GenericName.c_str(),ErrorMessage);
+
+    if (Handle == P3DTexHandleNULL)
+     {
       return(P3DTexHandleNULL);
      }
+   }
 
-    Handle = GetUnusedSlot();
+  TextureSet[Handle - 1].RefCount++;
 
-    Entry  = &TextureSet[Handle - 1];
+  return(Handle);
+ }
 
-    wxImage Image(TempImageData.GetWidth(),
-                  TempImageData.GetHeight(),
-                  (unsigned char*)(TempImageData.GetData()),
-                  TRUE);
+P3DTexHandle       P3DTexManagerGL::LoadFromMemory
+                                      (const char         *GenericName,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       wxString           &ErrorMessage)
+ {
+  P3DTexHandle                         Handle;
 
-/*    TempImageData.DetachData(); */
+  Handle = FindMemoryTexture(GenericName);
 
-    Entry->Bitmap      = new wxBitmap(Image.Scale(64,64).Mirror(false));
-    Entry->FileName    = FileName;
-    Entry->GenericName = GenericName;
+  if (Handle == P3DTexHandleNULL)
+   {
+    P3DTexImage                       *TexImage;
+    P3DPathName                        PathName(GenericName);
 
     glCanvas->SetCurrent();
 
-    glGenTextures(1,&Entry->GLHandle);
-
-    glBindTexture(GL_TEXTURE_2D,Entry->GLHandle);
-    glPixelStorei(GL_UNPACK_ALIGNMENT,1);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+    TexImage = new P3DTexImage();
 
-    if (TextureChannelCount == 3)
+    if (!TexImage->LoadMem(&ImageFmtHandler,Data,Size,
+                           PathName.GetExtension().c_str(),
+                           P3DTexImage::GetGLMaxSize()))
      {
-      gluBuild2DMipmaps(GL_TEXTURE_2D,
-                        TextureChannelCount,
-                        ImageData.GetWidth(),
-                        ImageData.GetHeight(),
-                        GL_RGB,
-                        GL_UNSIGNED_BYTE,
-                        ImageData.GetData());
+      delete TexImage;
+
+      ErrorMessage = wxT("Texture image load failed (image must be RGB or RGBA)");
+
+      return(P3DTexHandleNULL);
      }
-    else
+
+    Handle = CreateEntry(TexImage,"",GenericName,ErrorMessage);
+
+    if (Handle == P3DTexHandleNULL)
      {
-      gluBuild2DMipmaps(GL_TEXTURE_2D,
-                        TextureChannelCount,
-                        ImageData.GetWidth(),
-                        ImageData.GetHeight(),
-                        GL_RGBA,
-                        GL_UNSIGNED_BYTE,
-                        ImageData.GetData());
+      return(P3DTexHandleNULL);
      }
 
-    glBindTexture(GL_TEXTURE_2D,0);
-   }
-  else
-   {
-    Entry  = &TextureSet[Handle - 1];
+    /* texture has no file, so it can be written out (when model */
+    /* is saved or exported) from the original contents only    */
+    TextureSet[Handle - 1].SourceData.assign((const char*)Data,
+                                             (const char*)Data + Size);
    }
 
-  Entry->RefCount++;
+  TextureSet[Handle - 1].RefCount++;
 
   return(Handle);
  }
@@ -221,6 +191,73 @@ P3DTexHandle       P3DTexManagerGL::GetHandleByGenericName
   return(TexHandle);
  }
 
+P3DTexHandle       P3DTexManagerGL::GetMemoryTextureHandle
+                                      (const char         *GenericName)
+ {
+  P3DTexHandle     TexHandle;
+
+  TexHandle = FindMemoryTexture(GenericName);
+
+  if (TexHandle != P3DTexHandleNULL)
+   {
+    TextureSet[TexHandle - 1].RefCount++;
+   }
+
+  return(TexHandle);
+ }
+
+void               P3DTexManagerGL::PreloadFiles
+                                      (const std::vector<std::string>
+                                                          &FileNames)
+ {
+  P3DTexPrepQueue                      Queue(&ImageFmtHandler);
+  std::vector<std::string>             QueuedNames;
+
+  for (unsigned int Index = 0; Index < FileNames.size(); Index++)
+   {
+    const std::string                 &FileName = FileNames[Index];
+
+    if ((FindByFileName(FileName.c_str()) == P3DTexHandleNULL) &&
+        (Preloaded.find(FileName) == Preloaded.end()) &&
+        (std::find(QueuedNames.begin(),QueuedNames.end(),FileName) == QueuedNames.end()))
+     {
+      Queue.Add(FileName.c_str(),0);
+
+      QueuedNames.push_back(FileName);
+     }
+   }
+
+  if (Queue.GetCount() == 0)
+   {
+    return;
+   }
+
+  glCanvas->SetCurrent();
+
+  Queue.Run(P3DThread::GetCPUCount(),P3DTexImage::GetGLMaxSize());
+
+  for (unsigned int Index = 0; Index < Queue.GetCount(); Index++)
+   {
+    if (Queue.GetImage(Index) != 0)
+     {
+      Preloaded[QueuedNames[Index]] = Queue.DetachImage(Index);
+     }
+   }
+ }
+
+void               P3DTexManagerGL::ClearPreloaded
+                                      ()
+ {
+  for (std::map<std::string,P3DTexImage*>::iterator Iter = Preloaded.begin();
+       Iter != Preloaded.end();
+       ++Iter)
+   {
+    delete Iter->second;
+   }
+
+  Preloaded.clear();
+ }
+
 void               P3DTexManagerGL::IncRefCount
                                       (P3DTexHandle        TexHandle)
  {
@@ -263,6 +300,8 @@ void               P3DTexManagerGL::FreeTexture
     glDeleteTextures(1,&Entry->GLHandle);
 
     delete Entry->Bitmap;
+
+    std::vector<char>().swap(Entry->SourceData);
    }
  }
 
@@ -346,6 +385,29 @@ const char        *P3DTexManagerGL::GetTexFileName
    }
  }
 
+const void        *P3DTexManagerGL::GetTexSourceData
+                                      (P3DTexHandle        TexHandle,
+                                       unsigned int       *Size) const
+ {
+  if ((TexHandle < 1) || (TexHandle > TextureSet.size()))
+   {
+    return(0);
+   }
+
+  const P3DTexManagerGLEntry *Entry = &TextureSet[TexHandle - 1];
+
+  if ((Entry->RefCount > 0) && (!Entry->SourceData.empty()))
+   {
+    *Size = Entry->SourceData.size();
+
+    return(&Entry->SourceData[0]);
+   }
+  else
+   {
+    return(0);
+   }
+ }
+
 const P3DImageFmtHandler
                   *P3DTexManagerGL::GetFmtHandler
                                       () const
@@ -353,6 +415,98 @@ const P3DImageFmtHandler
   return(&ImageFmtHandler);
  }
 
+/* takes ownership of TexImage, returns handle with zero reference count */
+P3DTexHandle       P3DTexManagerGL::CreateEntry
+                                      (P3DTexImage        *TexImage,
+                                       const char         *FileName,
+                                       const char         *GenericName,
+                                       wxString           &ErrorMessage)
+ {
+  P3DTexHandle                         Handle;
+  P3DTexManagerGLEntry                *Entry;
+  unsigned int                         TextureChannelCount;
+  const P3DImageData                  *ImageData;
+  P3DImageData                         TempImageData;
+
+  ImageData           = TexImage->GetSourceImage();
+  TextureChannelCount = ImageData->GetChannelCount();
+
+  if (TextureChannelCount == 3)
+   {
+    if (!P3DImageData::Copy(&TempImageData,ImageData))
+     {
+      delete TexImage;
+
+      ErrorMessage = wxT("Out of memory");
+
+      return(P3DTexHandleNULL);
+     }
+   }
+  else
+   {
+    if (!P3DImageData::RemoveAlpha(&TempImageData,ImageData))
+     {
+      delete TexImage;
+
+      ErrorMessage = wxT("Out of memory");
+
+      return(P3DTexHandleNULL);
+     }
+
+    /* draw alpha grid */
+
+    for (unsigned int Y = 0; Y < ImageData->GetHeight(); Y++)
+     {
+      for (unsigned int X = 0; X < ImageData->GetWidth(); X++)
+       {
+        unsigned char                Pixel[4];
+
+        ImageData->GetPixel(X,Y,Pixel);
+
+        if (Pixel[3] == 0)
+         {
+          if ((((X / 8) + (Y / 8)) & 0x01) == 1)
+           {
+            Pixel[0] = 0xCF;
+            Pixel[1] = 0xCF;
+            Pixel[2] = 0xCF;
+           }
+          else
+           {
+            Pixel[0] = 0x80;
+            Pixel[1] = 0x80;
+            Pixel[2] = 0x80;
+           }
+
+          TempImageData.PutPixel(X,Y,Pixel);
+         }
+       }
+     }
+   }
+
+  Handle = GetUnusedSlot();
+
+  Entry  = &TextureSet[Handle - 1];
+
+  wxImage Image(TempImageData.GetWidth(),
+                TempImageData.GetHeight(),
+                (unsigned char*)(TempImageData.GetData()),
+                TRUE);
+
+/*    TempImageData.DetachData(); */
+
+  Entry->Bitmap      = new wxBitmap(Image.Scale(64,64).Mirror(false));
+  Entry->FileName    = FileName;
+  Entry->GenericName = GenericName;
+
+  /* mipmap chain is already built, only upload is left */
+  Entry->GLHandle    = TexImage->CreateGLTexture();
+
+  delete TexImage;
+
+  return(Handle);
+ }
+
 P3DTexHandle       P3DTexManagerGL::GetUnusedSlot
                                       ()
  {
@@ -415,3 +569,22 @@ P3DTexHandle       P3DTexManagerGL::FindByGenericName
   return(P3DTexHandleNULL);
  }
 
+P3DTexHandle       P3DTexManagerGL::FindMemoryTexture
+                                      (const char         *GenericName) const
+ {
+  P3DTexHandle                         Handle;
+
+  for (Handle = 0; Handle < TextureSet.size(); Handle++)
+   {
+    if ((TextureSet[Handle].RefCount > 0) && (TextureSet[Handle].FileName.empty()))
+     {
+      if (TextureSet[Handle].GenericName == GenericName)
+       {
+        return(Handle + 1);
+       }
+     }
+   }
+
+  return(P3DTexHandleNULL);
+ }
+
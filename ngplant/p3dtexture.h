@@ -23,6 +23,7 @@
 
 #include <vector>
 #include <string>
+#include <map>
 
 #include <wx/wx.h>
 #include <ngput/p3dglext.h>
@@ -30,6 +31,7 @@
 
 #include <ngput/p3dglext.h>
 #include <ngput/p3dimage.h>
+#include <ngput/p3dtexprep.h>
 
 typedef unsigned int     P3DTexHandle;
 
@@ -42,6 +44,8 @@ typedef struct
   wxBitmap        *Bitmap;
   std::string      FileName;
   std::string      GenericName;
+  /* image file contents, kept for textures loaded from memory only */
+  std::vector<char> SourceData;
  } P3DTexManagerGLEntry;
 
 class P3DTexManagerGL
@@ -57,6 +61,22 @@ class P3DTexManagerGL
                                        wxString           &ErrorMessage);
   P3DTexHandle     GetHandleByGenericName
                                       (const char         *GenericName);
+  /* decodes image file contents (archive entry, for example), texture */
+  /* is registered under GenericName and has no file name             */
+  P3DTexHandle     LoadFromMemory     (const char         *GenericName,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       wxString           &ErrorMessage);
+  /* returns texture loaded by LoadFromMemory, increasing its reference */
+  /* count, or P3DTexHandleNULL                                        */
+  P3DTexHandle     GetMemoryTextureHandle
+                                      (const char         *GenericName);
+
+  /* decodes files in parallel, LoadFromFile picks decoded images up */
+  void             PreloadFiles       (const std::vector<std::string>
+                                                          &FileNames);
+  /* releases preloaded images not requested by LoadFromFile */
+  void             ClearPreloaded     ();
 
   void             IncRefCount        (P3DTexHandle        TexHandle);
   void             FreeTexture        (P3DTexHandle        TexHandle);
@@ -65,6 +85,10 @@ class P3DTexManagerGL
   const wxBitmap  *GetBitmap          (P3DTexHandle        TexHandle) const;
   const char      *GetGenericName     (P3DTexHandle        TexHandle) const;
   const char      *GetTexFileName     (P3DTexHandle        TexHandle) const;
+  /* returns image file contents of texture loaded by LoadFromMemory, */
+  /* or 0 for textures loaded from file                                */
+  const void      *GetTexSourceData   (P3DTexHandle        TexHandle,
+                                       unsigned int       *Size) const;
 
   const P3DImageFmtHandler
                   *GetFmtHandler      () const;
@@ -72,13 +96,19 @@ class P3DTexManagerGL
   private          :
 
   P3DTexHandle     GetUnusedSlot      ();
+  P3DTexHandle     CreateEntry        (P3DTexImage        *TexImage,
+                                       const char         *FileName,
+                                       const char         *GenericName,
+                                       wxString           &ErrorMessage);
   P3DTexHandle     FindByFileName     (const char         *FileName) const;
   P3DTexHandle     FindByGenericName  (const char         *GenericName) const;
+  P3DTexHandle     FindMemoryTexture  (const char         *GenericName) const;
 
   wxGLCanvas                          *glCanvas;
   P3DImageFmtHandlerComposite          ImageFmtHandler;
 
   std::vector<P3DTexManagerGLEntry>    TextureSet;
+  std::map<std::string,P3DTexImage*>   Preloaded;
  };
 
 #endif
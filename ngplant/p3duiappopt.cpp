@@ -58,6 +58,7 @@ enum
   ID_CURVE_CTRL_WIDTH,
   ID_CURVE_CTRL_HEIGHT,
   ID_USE_COLOR_ARRAY,
+  ID_USE_CPU_BILLBOARDS,
 
   ID_CROSSSECT_RES_LEVEL0,
   ID_CROSSSECT_RES_LEVEL1,
@@ -418,6 +419,13 @@ void               P3DAppOptDialog::CreateMiscPage
 
   GridSizer->Add(UseColorArrayCheckBox,0,wxALL | wxALIGN_LEFT,1);
 
+  GridSizer->Add(new wxStaticText(MiscPanel,wxID_ANY,wxT("Expand billboards on CPU")),0,wxALL | wxALIGN_CENTER_VERTICAL,1);
+
+  wxCheckBox *UseCPUBillboardsCheckBox = new wxCheckBox(MiscPanel,ID_USE_CPU_BILLBOARDS,wxT(""));
+  UseCPUBillboardsCheckBox->SetValue(RenderQuirksPrefs.UseCPUBillboards);
+
+  GridSizer->Add(UseCPUBillboardsCheckBox,0,wxALL | wxALIGN_LEFT,1);
+
   TopSizer->Add(GridSizer,1,wxGROW | wxALL,5);
 
   MiscPanel->SetSizer(TopSizer);
@@ -585,6 +593,13 @@ bool               P3DAppOptDialog::TransferDataToWindow
     UseColorArrayCheckBox->SetValue(RenderQuirksPrefs.UseColorArray);
    }
 
+  wxCheckBox *UseCPUBillboardsCheckBox = (wxCheckBox*)FindWindow(ID_USE_CPU_BILLBOARDS);
+
+  if (UseCPUBillboardsCheckBox != 0)
+   {
+    UseCPUBillboardsCheckBox->SetValue(RenderQuirksPrefs.UseCPUBillboards);
+   }
+
   wxSpinSliderCtrl* SpinSlider = (wxSpinSliderCtrl*)FindWindow(ID_CROSSSECT_RES_LEVEL0);
 
   if (SpinSlider != 0)
@@ -811,6 +826,13 @@ bool               P3DAppOptDialog::TransferDataFromWindow
     RenderQuirksPrefs.UseColorArray = UseColorArrayCheckBox->GetValue();
    }
 
+  wxCheckBox *UseCPUBillboardsCheckBox = (wxCheckBox*)FindWindow(ID_USE_CPU_BILLBOARDS);
+
+  if (UseCPUBillboardsCheckBox != 0)
+   {
+    RenderQuirksPrefs.UseCPUBillboards = UseCPUBillboardsCheckBox->GetValue();
+   }
+
   wxSpinSliderCtrl* SpinSlider = (wxSpinSliderCtrl*)FindWindow(ID_CROSSSECT_RES_LEVEL0);
 
   if (SpinSlider != 0)
@@ -38,11 +38,23 @@
 
 #include "zipstore.h"
 
+#if defined(WITH_ZLIB)
+ #include <zlib.h>
+
+ #include <ngput/p3dthread.h>
+
+ #if defined(_WIN32)
+  #if defined(GetMessage)
+   #undef GetMessage
+  #endif
+ #endif
+#endif
+
 namespace ZS {
 
 #define ZS_ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
 
-#define ZS_ZIP_VER_MAJOR (1)
+#define ZS_ZIP_VER_MAJOR (2)
 #define ZS_ZIP_VER_MINOR (0)
 
 #define ZS_CENTRAL_FILE_HEADER_SIGNATURE (0x02014b50)
@@ -57,16 +69,17 @@ namespace ZS {
 #define ZS_VERSION_MADE_BY_OS_DOS      (0)
 #define ZS_VERSION_MADE_BY_SPEC        (ZS_ZIP_VER_MAJOR * 10 + ZS_ZIP_VER_MINOR)
 #define ZS_VERSION_MADE_BY             ((ZS_VERSION_MADE_BY_OS_DOS << 8) + ZS_VERSION_MADE_BY_SPEC)
-#define ZS_VERSION_NEEDED_TO_EXTRACT   (ZS_VERSION_MADE_BY_SPEC)
 
-#define ZS_VERSION_NEEDED_TO_EXTRACT     (ZS_VERSION_MADE_BY_SPEC)
+#define ZS_VERSION_NEEDED_TO_EXTRACT_STORED   (10)
+#define ZS_VERSION_NEEDED_TO_EXTRACT_DEFLATED (20)
 
 #define ZS_GPFLAG_NOT_ENCRYPTED        (0x0000)
 #define ZS_GPFLAG_ENCRYPTED            (0x0001)
 
 #define ZS_COMPRESSION_METHOD_STORED   (0x0000)
+#define ZS_COMPRESSION_METHOD_DEFLATED (0x0008)
 
-#define ZS_LOCAL_FILE_HEADER_CRC32_OFFSET (14)
+#define ZS_LOCAL_FILE_HEADER_VERSION_OFFSET (4)
 
 #define ZS_CRC32_UNDEFINED             (0)
 #define ZS_COMPRESSED_SIZE_UNDEFINED   (0)
@@ -82,6 +95,16 @@ namespace ZS {
 #define ZS_DOS_BASE_YEAR               (1980)
 #define ZS_TIMET_BASE_YEAR             (1900)
 
+// data is deflated in chunks, each chunk is compressed independently
+// using last ZS_DEFLATE_DICT_SIZE bytes of previous chunk as dictionary
+#define ZS_DEFLATE_CHUNK_SIZE          (128 * 1024)
+#define ZS_DEFLATE_DICT_SIZE           (32 * 1024)
+// entry is stored if first ZS_DEFLATE_PROBE_SIZE bytes can't be
+// deflated by at least 1/ZS_DEFLATE_PROBE_MIN_GAIN of their size
+#define ZS_DEFLATE_PROBE_SIZE          (16 * 1024)
+#define ZS_DEFLATE_PROBE_MIN_GAIN      (8)
+#define ZS_INFLATE_BUFFER_SIZE         (16 * 1024)
+
 #if defined(_MSC_VER)
  #define strdup _strdup
 #endif
@@ -153,6 +176,32 @@ DosDateTime2TimeT                     (time_t             *time,
    }
  }
 
+static unsigned int
+GetVersionNeededToExtract             (unsigned int        method)
+ {
+  if (method == ZS_COMPRESSION_METHOD_DEFLATED)
+   {
+    return ZS_VERSION_NEEDED_TO_EXTRACT_DEFLATED;
+   }
+  else
+   {
+    return ZS_VERSION_NEEDED_TO_EXTRACT_STORED;
+   }
+ }
+
+static bool
+IsCompressionMethodSupported          (unsigned int        method)
+ {
+  #if defined(WITH_ZLIB)
+  if (method == ZS_COMPRESSION_METHOD_DEFLATED)
+   {
+    return true;
+   }
+  #endif
+
+  return method == ZS_COMPRESSION_METHOD_STORED;
+ }
+
 static const char *ErrorMessages[] =
  {
   "I/O error",
@@ -163,7 +212,9 @@ static const char *ErrorMessages[] =
   "broken zip file (bad local file header header signature)",
   "trying to seek beyond the end of archive",
   "trying to seek beyond the end of file",
-  "invalid datetime"
+  "invalid datetime",
+  "compression error",
+  "broken zip file (unable to decompress data)"
  };
 
 static const char  UnknownErrorMessage[] = "undefined error";
@@ -202,13 +253,17 @@ Reader::DirEntry::DirEntry            (unsigned int   crc32,
                                        size_t         size,
                                        const char    *name,
                                        time_t         dateTime,
-                                       size_t         localHeaderOffset)
+                                       size_t         localHeaderOffset,
+                                       unsigned int   method,
+                                       size_t         compressedSize)
  {
   this->crc32             = crc32;
   this->size              = size;
   this->name              = name;
   this->dateTime          = dateTime;
   this->localHeaderOffset = localHeaderOffset;
+  this->method            = method;
+  this->compressedSize    = compressedSize;
 
   next = 0;
  }
@@ -218,12 +273,125 @@ Reader::DirEntry::~DirEntry           ()
   free(const_cast<char*>(name));
  }
 
+#if defined(WITH_ZLIB)
+struct Reader::File::Inflater
+ {
+                   Inflater                (InStream      &_in,
+                                            size_t         compressedSize,
+                                            const void    *compressedData);
+                  ~Inflater                ();
+
+  void             Read                    (void          *dest,
+                                            size_t         size);
+
+  InStream        &in;
+  size_t           compressedSizeLeft;
+  z_stream         stream;
+  unsigned char    buffer[ZS_INFLATE_BUFFER_SIZE];
+ };
+
+Reader::File::Inflater::Inflater      (InStream           &_in,
+                                       size_t              compressedSize,
+                                       const void         *compressedData)
+ : in(_in),compressedSizeLeft(compressedSize)
+ {
+  memset(&stream,0,sizeof(stream));
+
+  // inflate directly from stream memory if it is available
+  if (compressedData != 0)
+   {
+    stream.next_in  = (Bytef*)compressedData;
+    stream.avail_in = compressedSize;
+
+    compressedSizeLeft = 0;
+   }
+
+  int result = inflateInit2(&stream,-MAX_WBITS);
+
+  if      (result == Z_MEM_ERROR)
+   {
+    throw std::bad_alloc();
+   }
+  else if (result != Z_OK)
+   {
+    throw Error(Error::DECOMPRESSION_ERROR);
+   }
+ }
+
+Reader::File::Inflater::~Inflater     ()
+ {
+  inflateEnd(&stream);
+ }
+
+void
+Reader::File::Inflater::Read          (void               *dest,
+                                       size_t              size)
+ {
+  stream.next_out  = (Bytef*)dest;
+  stream.avail_out = size;
+
+  while (stream.avail_out > 0)
+   {
+    // when input is exhausted zlib may still hold pending output,
+    // so inflate is called anyway and Z_BUF_ERROR reports truncation
+    if ((stream.avail_in == 0) && (compressedSizeLeft > 0))
+     {
+      size_t sizeToRead = compressedSizeLeft < sizeof(buffer) ?
+                           compressedSizeLeft : sizeof(buffer);
+
+      // never read beyond entry data, input stream is shared
+      in.Read(buffer,sizeToRead);
+
+      compressedSizeLeft -= sizeToRead;
+
+      stream.next_in  = buffer;
+      stream.avail_in = sizeToRead;
+     }
+
+    int result = inflate(&stream,Z_NO_FLUSH);
+
+    if      (result == Z_MEM_ERROR)
+     {
+      throw std::bad_alloc();
+     }
+    else if (result == Z_STREAM_END)
+     {
+      if (stream.avail_out > 0)
+       {
+        throw Error(Error::DECOMPRESSION_ERROR);
+       }
+     }
+    else if (result != Z_OK)
+     {
+      throw Error(Error::DECOMPRESSION_ERROR);
+     }
+   }
+ }
+#endif
+
 Reader::File::File                    (InStream                &_in,
-                                       const Reader::DirEntry  &entry)
- : in(_in),name(entry.name),dateTime(entry.dateTime),offset(0),size(entry.size)
+                                       const Reader::DirEntry  &entry,
+                                       size_t                   _dataOffset)
+ : in(_in),name(entry.name),dateTime(entry.dateTime),offset(0),size(entry.size),
+   method(entry.method),compressedSize(entry.compressedSize),
+   dataOffset(_dataOffset),inflater(0)
  {
  }
 
+Reader::File::File                    (const File              &other)
+ : in(other.in),name(other.name),dateTime(other.dateTime),offset(other.offset),
+   size(other.size),method(other.method),compressedSize(other.compressedSize),
+   dataOffset(other.dataOffset),inflater(0)
+ {
+ }
+
+Reader::File::~File                   ()
+ {
+  #if defined(WITH_ZLIB)
+  delete inflater;
+  #endif
+ }
+
 const char*
 Reader::File::GetName                 () const
  {
@@ -253,15 +421,61 @@ Reader::File::Read                    (void          *dest,
     throw Error(Error::NO_MORE_DATA);
    }
 
+  #if defined(WITH_ZLIB)
+  if (method == ZS_COMPRESSION_METHOD_DEFLATED)
+   {
+    if (inflater == 0)
+     {
+      inflater = new Inflater(in,compressedSize,GetCompressedData());
+     }
+
+    inflater->Read(dest,size);
+
+    return;
+   }
+  #endif
+
   in.Read(dest,size);
  }
 
+const void*
+Reader::File::GetData                 () const
+ {
+  if (method != ZS_COMPRESSION_METHOD_STORED)
+   {
+    return 0;
+   }
+
+  return GetCompressedData();
+ }
+
+const void*
+Reader::File::GetCompressedData       () const
+ {
+  const unsigned char *data = (const unsigned char*)in.GetData();
+
+  if (data == 0)
+   {
+    return 0;
+   }
+
+  unsigned long streamSize = in.GetSize();
+
+  if ((dataOffset > streamSize) || (compressedSize > streamSize - dataOffset))
+   {
+    throw Error(Error::NO_MORE_DATA);
+   }
+
+  return data + dataOffset;
+ }
+
 Reader::Reader                        (InStream      &_in)
  : in(_in)
  {
   ECDRecord   ecdRecord;
 
-  firstDirEntry = 0;
+  firstDirEntry  = 0;
+  currDataOffset = 0;
 
   ReadECDRecord(&ecdRecord);
 
@@ -325,7 +539,7 @@ Reader::GetFile                       () const
     throw Error(Error::NO_MORE_FILES);
    }
 
-  return File(in,*currDirEntry);
+  return File(in,*currDirEntry,currDataOffset);
  }
 
 void
@@ -346,6 +560,8 @@ Reader::SeekToFile                    (const DirEntry          *entry)
   unsigned int extraLen = ReadWord();
 
   SkipBytes(nameLen + extraLen);
+
+  currDataOffset = in.GetPos();
  }
 
 unsigned long
@@ -472,7 +688,8 @@ Reader::LoadDirEntry                  ()
   unsigned int dosTime   = MemReadWord(&headerData[12]);
   unsigned int dosDate   = MemReadWord(&headerData[14]);
   unsigned int crc32     = MemReadLongWord(&headerData[16]);
-  unsigned long size     = MemReadLongWord(&headerData[20]);
+  unsigned long compressedSize = MemReadLongWord(&headerData[20]);
+  unsigned long size     = MemReadLongWord(&headerData[24]);
   unsigned long nameLen  = MemReadWord(&headerData[28]);
   unsigned long extraFieldLen  = MemReadWord(&headerData[30]);
   unsigned long fileCommentLen = MemReadWord(&headerData[32]);
@@ -488,7 +705,7 @@ Reader::LoadDirEntry                  ()
     throw Error(Error::ENCRYPTION_NOT_SUPPORTED);
    }
 
-  if (method != ZS_COMPRESSION_METHOD_STORED)
+  if (!IsCompressionMethodSupported(method))
    {
     throw Error(Error::COMPRESSION_NOT_SUPPORTED);
    }
@@ -512,7 +729,8 @@ Reader::LoadDirEntry                  ()
 
     DosDateTime2TimeT(&dateTime,dosDate,dosTime);
 
-    return new DirEntry(crc32,size,name,dateTime,localHeaderOffset);
+    return new DirEntry(crc32,size,name,dateTime,localHeaderOffset,
+                        method,compressedSize);
    }
   catch (...)
    {
@@ -584,6 +802,415 @@ Reader::MemReadLongWord               (const unsigned char     *mem)
   return MemReadWord(mem) | (MemReadWord(&mem[2]) << 16);
  }
 
+#if defined(WITH_ZLIB)
+namespace {
+
+struct DeflateJob
+ {
+  unsigned char   *input;      // dictionary followed by chunk data
+  size_t           dictSize;
+  size_t           dataSize;
+  unsigned char   *output;
+  size_t           outputSize;
+  unsigned int     crc32;       // of chunk data, computed by job too
+  int              level;
+  bool             last;
+  bool             ok;
+  bool             started;
+  P3DThread        thread;
+ };
+
+void
+FreeDeflateJob                        (DeflateJob         *job)
+ {
+  free(job->input);
+  free(job->output);
+
+  delete job;
+ }
+
+// compressed chunks are byte-aligned (sync flush), so they can be
+// concatenated into single raw deflate stream
+void
+DeflateChunk                          (DeflateJob         *job)
+ {
+  z_stream stream;
+
+  memset(&stream,0,sizeof(stream));
+
+  job->ok = false;
+
+  CRC32 crc32;
+
+  crc32.Update(job->input + job->dictSize,job->dataSize);
+
+  job->crc32 = crc32.GetCRC32();
+
+  if (deflateInit2(&stream,job->level,Z_DEFLATED,-MAX_WBITS,8,Z_DEFAULT_STRATEGY) != Z_OK)
+   {
+    return;
+   }
+
+  size_t outputCapacity = deflateBound(&stream,job->dataSize) + 16;
+
+  job->output = (unsigned char*)malloc(outputCapacity);
+
+  if (job->output != 0 &&
+      (job->dictSize == 0 ||
+       deflateSetDictionary(&stream,job->input,job->dictSize) == Z_OK))
+   {
+    stream.next_in   = job->input + job->dictSize;
+    stream.avail_in  = job->dataSize;
+    stream.next_out  = job->output;
+    stream.avail_out = outputCapacity;
+
+    int result = deflate(&stream,job->last ? Z_FINISH : Z_SYNC_FLUSH);
+
+    if (job->last)
+     {
+      job->ok = result == Z_STREAM_END;
+     }
+    else
+     {
+      job->ok = result == Z_OK && stream.avail_in == 0 && stream.avail_out > 0;
+     }
+
+    job->outputSize = outputCapacity - stream.avail_out;
+   }
+
+  deflateEnd(&stream);
+ }
+
+void
+DeflateChunkThreadProc                (void               *arg)
+ {
+  DeflateChunk((DeflateJob*)arg);
+ }
+
+bool
+IsWorthDeflating                      (const unsigned char*data,
+                                       size_t              size)
+ {
+  if (size > ZS_DEFLATE_PROBE_SIZE)
+   {
+    size = ZS_DEFLATE_PROBE_SIZE;
+   }
+
+  if (size == 0)
+   {
+    return false;
+   }
+
+  z_stream      stream;
+  unsigned char output[ZS_DEFLATE_PROBE_SIZE];
+
+  memset(&stream,0,sizeof(stream));
+
+  if (deflateInit2(&stream,Z_BEST_SPEED,Z_DEFLATED,-MAX_WBITS,8,Z_DEFAULT_STRATEGY) != Z_OK)
+   {
+    return false;
+   }
+
+  stream.next_in   = (Bytef*)data;
+  stream.avail_in  = size;
+  stream.next_out  = output;
+  stream.avail_out = size - size / ZS_DEFLATE_PROBE_MIN_GAIN;
+
+  // output buffer is too small for incompressible data
+  int result = deflate(&stream,Z_FINISH);
+
+  deflateEnd(&stream);
+
+  return result == Z_STREAM_END;
+ }
+
+}
+
+struct Writer::Deflater
+ {
+                   Deflater                (OutStream     &_out,
+                                            int            level,
+                                            unsigned int   threadCount);
+                  ~Deflater                ();
+
+  void             Write                   (const void    *data,
+                                            size_t         size);
+  // returns compression method used for current entry
+  unsigned int     Finish                  (size_t        *compressedSize,
+                                            unsigned int  *crc32);
+
+  private          :
+
+                   Deflater                (const Deflater&);
+  Deflater        &operator =              (const Deflater&);
+
+  enum { METHOD_UNDEFINED = 0xFFFF };
+
+  void             FlushChunk              (bool           last);
+  void             SubmitJob               (DeflateJob    *job);
+  void             CompleteOldestJob       ();
+  void             CancelJobs              ();
+
+  OutStream       &out;
+  int              level;
+  unsigned int     maxPendingJobs;
+
+  unsigned int     method;
+  size_t           compressedSize;
+  // stored entries are checksummed as they are written, deflated
+  // ones - by deflate jobs, chunk CRCs are combined in order
+  CRC32            storedCRC32;
+  unsigned int     deflatedCRC32;
+
+  unsigned char   *chunk;
+  size_t           chunkSize;
+  unsigned char   *dict;
+  size_t           dictSize;
+
+  DeflateJob     **pendingJobs;
+  unsigned int     pendingJobCount;
+ };
+
+Writer::Deflater::Deflater            (OutStream          &_out,
+                                       int                 level,
+                                       unsigned int        threadCount)
+ : out(_out),method(METHOD_UNDEFINED),compressedSize(0),deflatedCRC32(0),
+   chunkSize(0),dictSize(0),pendingJobCount(0)
+ {
+  this->level    = level;
+  maxPendingJobs = threadCount > 0 ? threadCount : 1;
+
+  chunk       = (unsigned char*)malloc(ZS_DEFLATE_CHUNK_SIZE);
+  dict        = (unsigned char*)malloc(ZS_DEFLATE_DICT_SIZE);
+  pendingJobs = (DeflateJob**)malloc(maxPendingJobs * sizeof(DeflateJob*));
+
+  if (chunk == 0 || dict == 0 || pendingJobs == 0)
+   {
+    free(pendingJobs);
+    free(dict);
+    free(chunk);
+
+    throw std::bad_alloc();
+   }
+ }
+
+Writer::Deflater::~Deflater           ()
+ {
+  CancelJobs();
+
+  free(pendingJobs);
+  free(dict);
+  free(chunk);
+ }
+
+void
+Writer::Deflater::Write               (const void         *data,
+                                       size_t              size)
+ {
+  if (method == ZS_COMPRESSION_METHOD_STORED)
+   {
+    out.Write(data,size);
+
+    storedCRC32.Update(data,size);
+
+    compressedSize += size;
+
+    return;
+   }
+
+  const unsigned char *src = (const unsigned char*)data;
+
+  while (size > 0)
+   {
+    size_t sizeToCopy = ZS_DEFLATE_CHUNK_SIZE - chunkSize;
+
+    if (sizeToCopy > size)
+     {
+      sizeToCopy = size;
+     }
+
+    memcpy(&chunk[chunkSize],src,sizeToCopy);
+
+    chunkSize += sizeToCopy;
+    src       += sizeToCopy;
+    size      -= sizeToCopy;
+
+    if (chunkSize == ZS_DEFLATE_CHUNK_SIZE)
+     {
+      FlushChunk(false);
+
+      if (method == ZS_COMPRESSION_METHOD_STORED)
+       {
+        Write(src,size);
+
+        return;
+       }
+     }
+   }
+ }
+
+unsigned int
+Writer::Deflater::Finish              (size_t             *compressedSize,
+                                       unsigned int       *crc32)
+ {
+  FlushChunk(true);
+
+  while (pendingJobCount > 0)
+   {
+    CompleteOldestJob();
+   }
+
+  unsigned int result = method;
+
+  *compressedSize = this->compressedSize;
+  *crc32          = method == ZS_COMPRESSION_METHOD_STORED ?
+                     storedCRC32.GetCRC32() : deflatedCRC32;
+
+  method               = METHOD_UNDEFINED;
+  this->compressedSize = 0;
+  deflatedCRC32        = 0;
+  dictSize             = 0;
+
+  storedCRC32.Reset();
+
+  return result;
+ }
+
+void
+Writer::Deflater::FlushChunk          (bool                last)
+ {
+  if (method == METHOD_UNDEFINED)
+   {
+    method = IsWorthDeflating(chunk,chunkSize) ? ZS_COMPRESSION_METHOD_DEFLATED :
+                                                 ZS_COMPRESSION_METHOD_STORED;
+   }
+
+  if (method == ZS_COMPRESSION_METHOD_STORED)
+   {
+    out.Write(chunk,chunkSize);
+
+    storedCRC32.Update(chunk,chunkSize);
+
+    compressedSize += chunkSize;
+    chunkSize       = 0;
+
+    return;
+   }
+
+  DeflateJob *job = new DeflateJob();
+
+  job->input    = (unsigned char*)malloc(dictSize + chunkSize + 1);
+  job->dictSize = dictSize;
+  job->dataSize = chunkSize;
+  job->output   = 0;
+  job->level    = level;
+  job->last     = last;
+  job->ok       = false;
+  job->started  = false;
+
+  if (job->input == 0)
+   {
+    delete job;
+
+    throw std::bad_alloc();
+   }
+
+  memcpy(job->input,dict,dictSize);
+  memcpy(&job->input[dictSize],chunk,chunkSize);
+
+  // only last chunk may be shorter than dictionary
+  dictSize = chunkSize < ZS_DEFLATE_DICT_SIZE ? chunkSize : ZS_DEFLATE_DICT_SIZE;
+
+  memcpy(dict,&chunk[chunkSize - dictSize],dictSize);
+
+  chunkSize = 0;
+
+  SubmitJob(job);
+ }
+
+void
+Writer::Deflater::SubmitJob           (DeflateJob         *job)
+ {
+  if (pendingJobCount == maxPendingJobs)
+   {
+    try
+     {
+      CompleteOldestJob();
+     }
+    catch (...)
+     {
+      FreeDeflateJob(job);
+
+      throw;
+     }
+   }
+
+  if (maxPendingJobs > 1)
+   {
+    job->started = job->thread.Start(DeflateChunkThreadProc,job);
+   }
+
+  if (!job->started)
+   {
+    DeflateChunk(job);
+   }
+
+  pendingJobs[pendingJobCount++] = job;
+ }
+
+void
+Writer::Deflater::CompleteOldestJob   ()
+ {
+  DeflateJob *job = pendingJobs[0];
+
+  pendingJobCount--;
+
+  memmove(&pendingJobs[0],&pendingJobs[1],pendingJobCount * sizeof(DeflateJob*));
+
+  if (job->started)
+   {
+    job->thread.Join();
+   }
+
+  try
+   {
+    if (!job->ok)
+     {
+      throw Error(Error::COMPRESSION_ERROR);
+     }
+
+    out.Write(job->output,job->outputSize);
+
+    compressedSize += job->outputSize;
+    deflatedCRC32   = CRC32::Combine(deflatedCRC32,job->crc32,job->dataSize);
+   }
+  catch (...)
+   {
+    FreeDeflateJob(job);
+
+    throw;
+   }
+
+  FreeDeflateJob(job);
+ }
+
+void
+Writer::Deflater::CancelJobs          ()
+ {
+  for (unsigned int jobIndex = 0; jobIndex < pendingJobCount; jobIndex++)
+   {
+    if (pendingJobs[jobIndex]->started)
+     {
+      pendingJobs[jobIndex]->thread.Join();
+     }
+
+    FreeDeflateJob(pendingJobs[jobIndex]);
+   }
+
+  pendingJobCount = 0;
+ }
+#endif
+
 Writer::Entry::Entry                  (const char         *name,
                                        unsigned int        dosDate,
                                        unsigned int        dosTime,
@@ -601,9 +1228,11 @@ Writer::Entry::Entry                  (const char         *name,
 
   this->localHeaderOffset = localHeaderOffset;
 
-  size  = 0;
-  crc32 = 0;
-  next  = 0;
+  size           = 0;
+  compressedSize = 0;
+  method         = ZS_COMPRESSION_METHOD_STORED;
+  crc32          = 0;
+  next           = 0;
  }
 
 Writer::Entry::~Entry                 ()
@@ -611,13 +1240,28 @@ Writer::Entry::~Entry                 ()
   free(const_cast<char*>(name));
  }
 
-Writer::Writer                        (OutStream          &_out)
- : out(_out),centralDirectoryOffset(0),first(0),last(0)
+Writer::Writer                        (OutStream          &_out,
+                                       int                 compressionLevel,
+                                       unsigned int        threadCount)
+ : out(_out),deflater(0),centralDirectoryOffset(0),first(0),last(0)
  {
+  #if defined(WITH_ZLIB)
+  if (compressionLevel != NO_COMPRESSION)
+   {
+    deflater = new Deflater(out,compressionLevel,threadCount);
+   }
+  #else
+  (void)compressionLevel;
+  (void)threadCount;
+  #endif
  }
 
 Writer::~Writer                       ()
  {
+  #if defined(WITH_ZLIB)
+  delete deflater;
+  #endif
+
   FreeEntries();
  }
 
@@ -639,18 +1283,37 @@ Writer::EndFile                       (void)
  {
   if (last == 0) return;
 
-  last->crc32 = crc32.GetCRC32();
+  #if defined(WITH_ZLIB)
+  if (deflater != 0)
+   {
+    last->method = deflater->Finish(&last->compressedSize,&last->crc32);
+   }
+  else
+  #endif
+   {
+    last->compressedSize = last->size;
+    last->crc32          = crc32.GetCRC32();
+   }
 
-  UpdateSizeAndCRCInLocalFileHeader(last);
+  UpdateLocalFileHeader(last);
  }
 
 void
 Writer::WriteData                     (const void         *data,
                                        size_t              size)
  {
-  WriteBytes(data,size);
+  #if defined(WITH_ZLIB)
+  if (deflater != 0)
+   {
+    deflater->Write(data,size);
+   }
+  else
+  #endif
+   {
+    WriteBytes(data,size);
 
-  crc32.Update(data,size);
+    crc32.Update(data,size);
+   }
 
   last->size += size;
  }
@@ -708,8 +1371,9 @@ Writer::WriteLocalFileHeader          (const char    *name,
  {
   size_t       nameLength  = strlen(name);
 
+  // version, method, CRC32 and sizes are updated at the end of file
   WriteLongWord(ZS_LOCAL_FILE_HEADER_SIGNATURE);
-  WriteWord(ZS_VERSION_NEEDED_TO_EXTRACT);
+  WriteWord(ZS_VERSION_NEEDED_TO_EXTRACT_STORED);
   WriteWord(ZS_GPFLAG_NOT_ENCRYPTED);
   WriteWord(ZS_COMPRESSION_METHOD_STORED);
   WriteWord(dosTime);
@@ -724,14 +1388,19 @@ Writer::WriteLocalFileHeader          (const char    *name,
  }
 
 void
-Writer::UpdateSizeAndCRCInLocalFileHeader  (Entry         *entry)
+Writer::UpdateLocalFileHeader              (Entry         *entry)
  {
   long currentPos = out.GetPos();
 
-  out.Seek(entry->localHeaderOffset + ZS_LOCAL_FILE_HEADER_CRC32_OFFSET);
+  out.Seek(entry->localHeaderOffset + ZS_LOCAL_FILE_HEADER_VERSION_OFFSET);
 
+  WriteWord(GetVersionNeededToExtract(entry->method));
+  WriteWord(ZS_GPFLAG_NOT_ENCRYPTED);
+  WriteWord(entry->method);
+  WriteWord(entry->dosTime);
+  WriteWord(entry->dosDate);
   WriteLongWord(entry->crc32);
-  WriteLongWord(entry->size);
+  WriteLongWord(entry->compressedSize);
   WriteLongWord(entry->size);
 
   out.Seek(currentPos);
@@ -757,13 +1426,13 @@ Writer::WriteCentralDirectoryHeader        (Entry         *entry)
 
   WriteLongWord(ZS_CENTRAL_FILE_HEADER_SIGNATURE);
   WriteWord(ZS_VERSION_MADE_BY);
-  WriteWord(ZS_VERSION_NEEDED_TO_EXTRACT);
+  WriteWord(GetVersionNeededToExtract(entry->method));
   WriteWord(ZS_GPFLAG_NOT_ENCRYPTED);
-  WriteWord(ZS_COMPRESSION_METHOD_STORED);
+  WriteWord(entry->method);
   WriteWord(entry->dosTime);
   WriteWord(entry->dosDate);
   WriteLongWord(entry->crc32);
-  WriteLongWord(entry->size);
+  WriteLongWord(entry->compressedSize);
   WriteLongWord(entry->size);
   WriteWord(nameLength);
   WriteWord(ZS_EMPTY_EXTRA_FIELD_LENGTH);
@@ -902,6 +1571,44 @@ unsigned int CRC32::table[256] =
   0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
  };
 
+unsigned int CRC32::sliceTable[8][256];
+unsigned int CRC32::x2nTable[32];
+
+// table[] is initialized statically, so it is safe to derive other
+// tables from it during dynamic initialization
+bool CRC32::tablesReady = CRC32::InitTables();
+
+bool
+CRC32::InitTables                     ()
+ {
+  for (unsigned int n = 0; n < 256; n++)
+   {
+    sliceTable[0][n] = table[n];
+   }
+
+  for (unsigned int k = 1; k < 8; k++)
+   {
+    for (unsigned int n = 0; n < 256; n++)
+     {
+      unsigned int prev = sliceTable[k - 1][n];
+
+      sliceTable[k][n] = (prev >> 8) ^ table[prev & 0xFF];
+     }
+   }
+
+  // polynomials are stored bit-reflected, so x^0 is 0x80000000
+  unsigned int p = 1U << 30; // x^1
+
+  x2nTable[0] = p;
+
+  for (unsigned int k = 1; k < 32; k++)
+   {
+    x2nTable[k] = p = MultModP(p,p);
+   }
+
+  return true;
+ }
+
 CRC32::CRC32                          ()
  {
   Reset();
@@ -918,11 +1625,32 @@ CRC32::Update                         (const void         *data,
                                        size_t              size)
  {
   const unsigned char *p = (const unsigned char*)data;
+  unsigned int         c = crc;
 
-  for (size_t i = 0; i < size; i++)
+  // slice-by-8: eight bytes per step, bytes are assembled explicitly,
+  // so neither alignment nor byte order matters
+  while (size >= 8)
    {
-    crc = (crc >> 8) ^ table[(crc & 0xFF) ^ (*p++)];
+    c ^= (unsigned int)p[0]         | ((unsigned int)p[1] << 8) |
+         ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24);
+
+    c = sliceTable[7][c & 0xFF]         ^ sliceTable[6][(c >> 8) & 0xFF] ^
+        sliceTable[5][(c >> 16) & 0xFF] ^ sliceTable[4][c >> 24]         ^
+        sliceTable[3][p[4]]             ^ sliceTable[2][p[5]]            ^
+        sliceTable[1][p[6]]             ^ sliceTable[0][p[7]];
+
+    p    += 8;
+    size -= 8;
    }
+
+  while (size > 0)
+   {
+    c = (c >> 8) ^ table[(c & 0xFF) ^ (*p++)];
+
+    size--;
+   }
+
+  crc = c;
  }
 
 unsigned int
@@ -931,6 +1659,56 @@ CRC32::GetCRC32                       () const
   return ~crc;
  }
 
+// multiplies polynomials a and b modulo CRC polynomial
+unsigned int
+CRC32::MultModP                       (unsigned int        a,
+                                       unsigned int        b)
+ {
+  unsigned int m = 1U << 31;
+  unsigned int p = 0;
+
+  while (true)
+   {
+    if (a & m)
+     {
+      p ^= b;
+
+      if ((a & (m - 1)) == 0)
+       {
+        break;
+       }
+     }
+
+    m >>= 1;
+    b   = b & 1 ? (b >> 1) ^ POLYNOMIAL : b >> 1;
+   }
+
+  return p;
+ }
+
+unsigned int
+CRC32::Combine                        (unsigned int        crc1,
+                                       unsigned int        crc2,
+                                       size_t              size2)
+ {
+  // crc1 is shifted by size2 zero bytes (multiplied by x^(8 * size2))
+  unsigned int shift = 1U << 31; // x^0
+  unsigned int k     = 3;        // x^(2^3) is one byte shift
+
+  while (size2 > 0)
+   {
+    if (size2 & 1)
+     {
+      shift = MultModP(x2nTable[k & 31],shift);
+     }
+
+    size2 >>= 1;
+    k++;
+   }
+
+  return MultModP(shift,crc1) ^ crc2;
+ }
+
 /*
 void
 CRC32::DumpTable                      ()
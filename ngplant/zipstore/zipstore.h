@@ -51,7 +51,7 @@ class Error
     IO_ERROR, END_OF_CENTRAL_DIR_RECORD_NOT_FOUND, ENCRYPTION_NOT_SUPPORTED,
     COMPRESSION_NOT_SUPPORTED, BAD_CENTRAL_DIRECTORY_SIGNATURE,
     BAD_LOCAL_FILE_HEADER_SIGNATURE, NO_MORE_FILES, NO_MORE_DATA,
-    INVALID_DATETIME
+    INVALID_DATETIME, COMPRESSION_ERROR, DECOMPRESSION_ERROR
    };
 
   private          :
@@ -74,6 +74,11 @@ class InStream
   virtual unsigned long      GetSize  () const = 0;
   virtual unsigned long      GetPos   () const = 0;
   virtual void               Seek     (unsigned long       pos) = 0;
+
+  // streams which have whole contents in memory (memory-mapped files,
+  // for example) return pointer to it, so entries can be accessed
+  // in place
+  virtual const void        *GetData  () const { return 0; }
  };
 
 class OutStream
@@ -101,15 +106,34 @@ class CRC32
 
   unsigned int     GetCRC32           () const;
 
+  // returns CRC32 of two concatenated blocks, crc1 and crc2 are
+  // CRC32 values of first and second block, size2 is size of second
+  // block. Blocks may be checksummed independently (in parallel, for
+  // example) and merged later.
+  static
+  unsigned int     Combine            (unsigned int        crc1,
+                                       unsigned int        crc2,
+                                       size_t              size2);
+
 //static void      DumpTable          ();
 
   private          :
 
+  static
+  unsigned int     MultModP           (unsigned int        a,
+                                       unsigned int        b);
+  static bool      InitTables         ();
+
   unsigned int     crc;
 
   enum { POLYNOMIAL = 0xedb88320U };
 
   static unsigned int                  table[256];
+  // sliceTable[k][n] is CRC of byte n followed by k zero bytes
+  static unsigned int                  sliceTable[8][256];
+  // x2nTable[k] is x^(2^k) modulo polynomial
+  static unsigned int                  x2nTable[32];
+  static bool                          tablesReady;
  };
 
 class Reader
@@ -126,7 +150,12 @@ class Reader
     public         :
 
                    File                    (InStream      &_in,
-                                            const DirEntry&entry);
+                                            const DirEntry&entry,
+                                            size_t         _dataOffset);
+                   // decompression state is not copied, so files must
+                   // be copied before first Read only
+                   File                    (const File    &other);
+                  ~File                    ();
 
     const char    *GetName                 () const;
     size_t         GetSize                 () const;
@@ -135,13 +164,28 @@ class Reader
     void           Read                    (void          *dest,
                                             size_t         size);
 
+    // returns pointer to file data inside stream memory if stream
+    // provides it (see InStream::GetData) and file is stored without
+    // compression, 0 otherwise. Pointer is valid while stream is.
+    const void    *GetData                 () const;
+
     private        :
 
+    File          &operator =              (const File    &);
+
+    const void    *GetCompressedData       () const;
+
+    struct Inflater;
+
     InStream      &in;
     const char    *name;
     time_t         dateTime;
     size_t         offset;
     size_t         size;
+    unsigned int   method;
+    size_t         compressedSize;
+    size_t         dataOffset;
+    Inflater      *inflater;
    };
 
   bool             IsEOF                   () const;
@@ -157,12 +201,16 @@ class Reader
                                             size_t         size,
                                             const char    *name,
                                             time_t         dateTime,
-                                            size_t         localHeaderOffset);
+                                            size_t         localHeaderOffset,
+                                            unsigned int   method,
+                                            size_t         compressedSize);
 
                        ~DirEntry           ();
 
     unsigned int        crc32;
     size_t              size;
+    unsigned int        method;
+    size_t              compressedSize;
     const char         *name;
     time_t              dateTime;
     size_t              localHeaderOffset;
@@ -203,13 +251,29 @@ class Reader
   InStream        &in;
   DirEntry        *firstDirEntry;
   DirEntry        *currDirEntry;
+  size_t           currDataOffset;
  };
 
+// Entries are deflated if zipstore is compiled with zlib (WITH_ZLIB)
+// and compressionLevel is not NO_COMPRESSION, otherwise stored. Each
+// entry is probed first, so already compressed data (JPEG, PNG) is
+// stored as is. Deflated data is split into chunks which are
+// compressed by up to threadCount threads in parallel.
 class Writer
  {
   public           :
 
-                   Writer                  (OutStream     &_out);
+  enum
+   {
+    NO_COMPRESSION      = 0,
+    BEST_SPEED          = 1,
+    BEST_COMPRESSION    = 9,
+    DEFAULT_COMPRESSION = -1
+   };
+
+                   Writer                  (OutStream     &_out,
+                                            int            compressionLevel = NO_COMPRESSION,
+                                            unsigned int   threadCount = 1);
                   ~Writer                  ();
 
   void             BeginFile               (const char    *name,
@@ -231,6 +295,8 @@ class Writer
     const char    *name;
     size_t         localHeaderOffset;
     size_t         size;
+    size_t         compressedSize;
+    unsigned int   method;
     unsigned int   dosDate;
     unsigned int   dosTime;
     unsigned int   crc32;
@@ -238,6 +304,11 @@ class Writer
     struct Entry  *next;
    };
 
+  struct Deflater;
+
+                   Writer                  (const Writer  &);
+  Writer          &operator =              (const Writer  &);
+
   void             EndFile                 (void);
 
   Entry           *AddNewEntry             (const char    *name,
@@ -254,8 +325,7 @@ class Writer
                                            (Entry         *entry);
   void             WriteEndOfCentralDirectoryRecord
                                            ();
-  void             UpdateSizeAndCRCInLocalFileHeader
-                                           (Entry         *entry);
+  void             UpdateLocalFileHeader   (Entry         *entry);
 
   void             WriteByte               (unsigned int   v);
   void             WriteWord               (unsigned int   v);
@@ -267,6 +337,7 @@ class Writer
 
   OutStream       &out;
   CRC32            crc32;
+  Deflater        *deflater;
 
   size_t           centralDirectoryOffset;
   size_t           centralDirectorySize;
@@ -0,0 +1,196 @@
+/***************************************************************************
+
+ Copyright (C) 2006  Sergey Prokhorchuk
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***************************************************************************/
+
+#include <stdio.h>
+
+#include <string>
+#include <deque>
+
+#include <ngpcore/p3ddefs.h>
+
+#include <ngput/p3dimage.h>
+#include <ngput/p3dimagetga.h>
+
+#ifdef WITH_LIBPNG
+ #include <ngput/p3dimagepng.h>
+#endif
+
+#include <ngput/p3dospath.h>
+
+#include "ngpimgsaver.h"
+
+static bool        SaveImageFile      (const char         *FileName,
+                                       const P3DImageData *Image,
+                                       int                 PNGCompressionLevel P3D_UNUSED_ATTR)
+ {
+  if (NGPImageSaver::GetFormatByFileName(FileName) == NGP_IMAGE_FORMAT_PNG)
+   {
+    #ifdef WITH_LIBPNG
+    return(P3DImageFmtHandlerPNG::SaveAsPNG(FileName,Image,PNGCompressionLevel));
+    #else
+    return(false);
+    #endif
+   }
+  else
+   {
+    return(P3DImageFmtHandlerTGA::SaveAsTGA(FileName,(P3DImageData*)Image));
+   }
+ }
+
+                   NGPImageSaver::NGPImageSaver
+                                      (unsigned int        MaxPending,
+                                       int                 PNGCompressionLevel)
+ {
+  this->MaxPending          = MaxPending > 0 ? MaxPending : 1;
+  this->PNGCompressionLevel = PNGCompressionLevel;
+
+  FailedCount = 0;
+ }
+
+                   NGPImageSaver::~NGPImageSaver
+                                      ()
+ {
+  Flush();
+ }
+
+void               NGPImageSaver::WorkerProc
+                                      (void               *Arg)
+ {
+  Request                             *Req;
+
+  Req = (Request*)Arg;
+
+  if (Req->FlipVertical)
+   {
+    Req->Image->FlipVertical();
+   }
+
+  Req->Result = SaveImageFile(Req->FileName.c_str(),Req->Image,Req->PNGCompressionLevel);
+ }
+
+void               NGPImageSaver::Save
+                                      (const char         *FileName,
+                                       P3DImageData       *Image,
+                                       bool                FlipVertical)
+ {
+  Request                             *Req;
+
+  while (Pending.size() >= MaxPending)
+   {
+    Finish(Pending.front());
+
+    Pending.pop_front();
+   }
+
+  Req = new Request();
+
+  Req->FileName            = FileName;
+  Req->Image               = Image;
+  Req->FlipVertical        = FlipVertical;
+  Req->PNGCompressionLevel = PNGCompressionLevel;
+  Req->Result              = false;
+  Req->Started             = Req->Thread.Start(WorkerProc,Req);
+
+  /* save synchronously if thread can not be created */
+  if (!Req->Started)
+   {
+    WorkerProc(Req);
+   }
+
+  Pending.push_back(Req);
+ }
+
+void               NGPImageSaver::Finish
+                                      (Request            *Req)
+ {
+  if (Req->Started)
+   {
+    Req->Thread.Join();
+   }
+
+  if (!Req->Result)
+   {
+    fprintf(stderr,"error: unable to save image (%s)\n",Req->FileName.c_str());
+
+    FailedCount++;
+   }
+
+  delete Req->Image;
+  delete Req;
+ }
+
+bool               NGPImageSaver::SaveNow
+                                      (const char         *FileName,
+                                       const P3DImageData *Image) const
+ {
+  return(SaveImageFile(FileName,Image,PNGCompressionLevel));
+ }
+
+unsigned int       NGPImageSaver::Flush
+                                      ()
+ {
+  unsigned int                         Result;
+
+  while (!Pending.empty())
+   {
+    Finish(Pending.front());
+
+    Pending.pop_front();
+   }
+
+  Result      = FailedCount;
+  FailedCount = 0;
+
+  return(Result);
+ }
+
+unsigned int       NGPImageSaver::GetFormatByFileName
+                                      (const char         *FileName)
+ {
+  std::string                          Ext;
+
+  Ext = P3DPathName(FileName).GetExtension();
+
+  for (unsigned int Index = 0; Index < Ext.size(); Index++)
+   {
+    if ((Ext[Index] >= 'A') && (Ext[Index] <= 'Z'))
+     {
+      Ext[Index] = Ext[Index] - 'A' + 'a';
+     }
+   }
+
+  return(Ext == "png" ? NGP_IMAGE_FORMAT_PNG : NGP_IMAGE_FORMAT_TGA);
+ }
+
+bool               NGPImageSaver::IsFormatSupported
+                                      (unsigned int        Format)
+ {
+  if (Format == NGP_IMAGE_FORMAT_PNG)
+   {
+    #ifdef WITH_LIBPNG
+    return(true);
+    #else
+    return(false);
+    #endif
+   }
+
+  return(true);
+ }
+
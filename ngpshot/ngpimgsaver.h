@@ -0,0 +1,94 @@
+/***************************************************************************
+
+ Copyright (C) 2006  Sergey Prokhorchuk
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***************************************************************************/
+
+#ifndef __NGPIMGSAVER_H__
+#define __NGPIMGSAVER_H__
+
+#include <string>
+#include <deque>
+
+#include <ngput/p3dimage.h>
+#include <ngput/p3dthread.h>
+
+#define NGP_IMAGE_FORMAT_TGA     (0)
+#define NGP_IMAGE_FORMAT_PNG     (1)
+
+/* matches P3D_PNG_COMPRESSION_DEFAULT, available without libpng too */
+#define NGP_PNG_COMPRESSION_DEFAULT (-1)
+
+/* Encodes and writes images on background threads, so rendering of the */
+/* next image overlaps with saving of previous ones. Not more than      */
+/* MaxPending images are kept in memory, Save blocks until the oldest  */
+/* one is written if limit is reached.                                  */
+class NGPImageSaver
+ {
+  public           :
+
+                   NGPImageSaver      (unsigned int        MaxPending,
+                                       int                 PNGCompressionLevel);
+                  ~NGPImageSaver      ();
+
+  /* takes ownership of Image. Format is selected by file extension. */
+  /* If FlipVertical is true, image rows are in GL (bottom-up) order */
+  void             Save               (const char         *FileName,
+                                       P3DImageData       *Image,
+                                       bool                FlipVertical);
+
+  /* saves image immediately, Image rows must be top-down */
+  bool             SaveNow            (const char         *FileName,
+                                       const P3DImageData *Image) const;
+
+  /* waits for all pending images, returns number of images which */
+  /* failed to save since previous call                           */
+  unsigned int     Flush              ();
+
+  static
+  unsigned int     GetFormatByFileName(const char         *FileName);
+  static
+  bool             IsFormatSupported  (unsigned int        Format);
+
+  private          :
+
+                   NGPImageSaver      (const NGPImageSaver&);
+  NGPImageSaver   &operator =         (const NGPImageSaver&);
+
+  typedef struct
+   {
+    std::string    FileName;
+    P3DImageData  *Image;
+    bool           FlipVertical;
+    int            PNGCompressionLevel;
+    bool           Result;
+    P3DThread      Thread;
+    bool           Started;
+   } Request;
+
+  static void      WorkerProc         (void               *Arg);
+
+  void             Finish             (Request            *Req);
+
+  unsigned int                         MaxPending;
+  int                                  PNGCompressionLevel;
+  std::deque<Request*>                 Pending;
+  unsigned int                         FailedCount;
+ };
+
+#endif
+
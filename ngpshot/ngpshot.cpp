@@ -25,6 +25,8 @@
 #include <new>
 #include <string>
 #include <map>
+#include <vector>
+#include <algorithm>
 
 #include <ngput/p3dglext.h>
 
@@ -49,20 +51,47 @@
 #include <ngput/p3dospath.h>
 
 #include <ngput/p3dglmemcntx.h>
+#include <ngput/p3dthread.h>
 
 #include <p3dshaders.h>
 #include "ngptexman.h"
+#include "ngpsoftrast.h"
+#include "ngpimgsaver.h"
+
+#include <shaders/normal_vs.h>
+#include <shaders/normal_fs.h>
 
 typedef struct
  {
   float            c[3];
  } NGPShotColor3f;
 
+typedef struct
+ {
+  std::string      ModelFileName;
+  std::string      ImageFileName;
+  unsigned int     ImageSize;
+  NGPShotColor3f   BGColor;
+  bool             HasAlpha;
+  float            XAngle;
+  float            YAngle;
+  float            LOD;
+  unsigned int     LineNumber;
+ } NGPShotJob;
+
 enum
  {
   GLOffScreenTargetAuto   ,
   GLOffScreenTargetPixmap ,
-  GLOffScreenTargetPBuffer
+  GLOffScreenTargetPBuffer,
+  GLOffScreenTargetSoftware
+ };
+
+enum
+ {
+  ImpostorLayoutNone      ,
+  ImpostorLayoutHemisphere,
+  ImpostorLayoutOctahedron
  };
 
 class NGPShotGLContextWrapper
@@ -153,74 +182,84 @@ class NGPShotGLContextWrapper
   #endif
  };
 
-static char       *LoadFileContent    (const char         *FileName)
+static char       *LoadStreamContent  (FILE               *SrcFile,
+                                       const char         *FileName)
  {
-  FILE                                *SrcFile;
   char                                 Buffer[256];
   char                                *Block;
   size_t                               BlockSize;
+  size_t                               ReadSize;
+  size_t                               NewBlockSize;
+  bool                                 Ok;
 
   Block     = 0;
   BlockSize = 0;
-  SrcFile   = fopen(FileName,"rb");
+  Ok        = true;
 
-  if (SrcFile != NULL)
+  do
    {
-    size_t                             ReadSize;
-    size_t                             NewBlockSize;
-    bool                               Ok;
+    ReadSize = fread(Buffer,1,sizeof(Buffer),SrcFile);
 
-    Ok = true;
+    NewBlockSize = BlockSize + ReadSize + (Block == 0 ? 1 : 0);
 
-    do
-     {
-      ReadSize = fread(Buffer,1,sizeof(Buffer),SrcFile);
-
-      NewBlockSize = BlockSize + ReadSize + (Block == 0 ? 1 : 0);
+    void *NewBlock = realloc(Block,NewBlockSize);
 
-      void *NewBlock = realloc(Block,NewBlockSize);
+    if (NewBlock != 0)
+     {
+      Block = (char*)NewBlock;
 
-      if (NewBlock != 0)
+      if (BlockSize == 0)
        {
-        Block = (char*)NewBlock;
-
-        if (BlockSize == 0)
-         {
-          memcpy(Block,Buffer,ReadSize);
-         }
-        else
-         {
-          memcpy(&Block[BlockSize - 1],Buffer,ReadSize);
-         }
-
-        BlockSize = NewBlockSize;
-
-        Block[NewBlockSize - 1] = 0;
+        memcpy(Block,Buffer,ReadSize);
        }
       else
        {
-        Ok = false;
-
-        fprintf(stderr,"error: out of memory\n");
+        memcpy(&Block[BlockSize - 1],Buffer,ReadSize);
        }
-     } while ((ReadSize == sizeof(Buffer)) && (Ok));
 
-    if (Ok)
+      BlockSize = NewBlockSize;
+
+      Block[NewBlockSize - 1] = 0;
+     }
+    else
      {
-      if (ferror(SrcFile))
-       {
-        fprintf(stderr,"error: file read error (%s)\n",FileName);
+      Ok = false;
 
-        Ok = false;
-       }
+      fprintf(stderr,"error: out of memory\n");
      }
+   } while ((ReadSize == sizeof(Buffer)) && (Ok));
 
-    if (!Ok)
+  if (Ok)
+   {
+    if (ferror(SrcFile))
      {
-      free(Block);
+      fprintf(stderr,"error: file read error (%s)\n",FileName);
 
-      Block = 0;
+      Ok = false;
      }
+   }
+
+  if (!Ok)
+   {
+    free(Block);
+
+    Block = 0;
+   }
+
+  return(Block);
+ }
+
+static char       *LoadFileContent    (const char         *FileName)
+ {
+  FILE                                *SrcFile;
+  char                                *Block;
+
+  Block   = 0;
+  SrcFile = fopen(FileName,"rb");
+
+  if (SrcFile != NULL)
+   {
+    Block = LoadStreamContent(SrcFile,FileName);
 
     fclose(SrcFile);
    }
@@ -236,19 +275,17 @@ static char       *LoadFileContent    (const char         *FileName)
 static void        UpdateBillboardsInfo
                                       (float              *PosBuffer,
                                        float              *BillboardNormal,
+                                       const float        *ModelViewMatrix,
                                        unsigned int        BillboardMode,
                                        float               BillboardWidth,
                                        float               BillboardHeight,
                                        unsigned int        BranchCount)
  {
-  GLfloat                              ModelViewMatrix[16];
   float                                HalfWidth;
   float                                HalfHeight;
   float                                Up[3];
   float                                Right[3];
 
-  glGetFloatv(GL_MODELVIEW_MATRIX,ModelViewMatrix);
-
   HalfWidth  = BillboardWidth  * 0.5f;
   HalfHeight = BillboardHeight * 0.5f;
 
@@ -300,6 +337,149 @@ static void        UpdateBillboardsInfo
    }
  }
 
+typedef struct
+ {
+  unsigned int     IndexCount;
+  float           *PosBuffer;
+  float           *NormalBuffer;
+  float           *BiNormalBuffer;
+  float           *TexCoordBuffer;
+  unsigned int    *IndexBuffer;
+ } NGPShotGroupGeometry;
+
+static bool        IsGroupVisible     (P3DHLIPlantTemplate*PlantTemplate,
+                                       P3DHLIPlantInstance*PlantInstance,
+                                       unsigned int        GroupIndex,
+                                       float               LOD)
+ {
+  if (PlantInstance->GetBranchCount(GroupIndex) == 0)
+   {
+    return(false);
+   }
+
+  if (PlantTemplate->IsLODVisRangeEnabled(GroupIndex))
+   {
+    float          MinLOD,MaxLOD;
+
+    PlantTemplate->GetLODVisRange(&MinLOD,&MaxLOD,GroupIndex);
+
+    if ((LOD < MinLOD) || (LOD > MaxLOD))
+     {
+      return(false);
+     }
+   }
+
+  return(true);
+ }
+
+static void        FreeGroupGeometry  (NGPShotGroupGeometry
+                                                          *Geometry)
+ {
+  delete[] Geometry->IndexBuffer;
+  delete[] Geometry->TexCoordBuffer;
+  delete[] Geometry->BiNormalBuffer;
+  delete[] Geometry->NormalBuffer;
+  delete[] Geometry->PosBuffer;
+ }
+
+/* fills group geometry, billboards are expanded using ModelViewMatrix */
+static bool        CreateGroupGeometry(NGPShotGroupGeometry
+                                                          *Geometry,
+                                       P3DHLIPlantTemplate*PlantTemplate,
+                                       P3DHLIPlantInstance*PlantInstance,
+                                       unsigned int        GroupIndex,
+                                       bool                NeedBiNormals,
+                                       const float        *ModelViewMatrix,
+                                       float              *BillboardNormal)
+ {
+  const P3DMaterialDef                *MaterialDef;
+  unsigned int                         BranchIndex;
+  unsigned int                         BranchCount;
+  unsigned int                         BranchVAttrCount;
+  unsigned int                         BranchIndexCount;
+  unsigned int                         TotalVAttrCount;
+
+  MaterialDef = PlantTemplate->GetMaterial(GroupIndex);
+  BranchCount = PlantInstance->GetBranchCount(GroupIndex);
+
+  BranchVAttrCount = PlantTemplate->GetVAttrCountI(GroupIndex);
+  BranchIndexCount = PlantTemplate->GetIndexCount(GroupIndex,P3D_TRIANGLE_LIST);
+
+  TotalVAttrCount      = BranchVAttrCount * BranchCount;
+  Geometry->IndexCount = BranchIndexCount * BranchCount;
+
+  Geometry->PosBuffer      = new(std::nothrow) float[3 * TotalVAttrCount];
+  Geometry->NormalBuffer   = new(std::nothrow) float[3 * TotalVAttrCount];
+  Geometry->TexCoordBuffer = new(std::nothrow) float[2 * TotalVAttrCount];
+  Geometry->IndexBuffer    = new(std::nothrow) unsigned int[Geometry->IndexCount];
+  Geometry->BiNormalBuffer = 0;
+
+  if (NeedBiNormals)
+   {
+    Geometry->BiNormalBuffer = new(std::nothrow) float[3 * TotalVAttrCount];
+   }
+
+  if ((Geometry->PosBuffer == 0) || (Geometry->NormalBuffer == 0) ||
+      (Geometry->TexCoordBuffer == 0) || (Geometry->IndexBuffer == 0) ||
+      ((NeedBiNormals) && (Geometry->BiNormalBuffer == 0)))
+   {
+    fprintf(stderr,"error: out of memory\n");
+
+    FreeGroupGeometry(Geometry);
+
+    return(false);
+   }
+
+  P3DHLIVAttrBuffers                   VAttrBuffers;
+
+  if (MaterialDef->IsBillboard())
+   {
+    VAttrBuffers.AddAttr(P3D_ATTR_BILLBOARD_POS,Geometry->PosBuffer,0,sizeof(float) * 3);
+   }
+  else
+   {
+    VAttrBuffers.AddAttr(P3D_ATTR_VERTEX,Geometry->PosBuffer,0,sizeof(float) * 3);
+   }
+
+  VAttrBuffers.AddAttr(P3D_ATTR_NORMAL,Geometry->NormalBuffer,0,sizeof(float) * 3);
+  VAttrBuffers.AddAttr(P3D_ATTR_TEXCOORD0,Geometry->TexCoordBuffer,0,sizeof(float) * 2);
+
+  if (Geometry->BiNormalBuffer != 0)
+   {
+    VAttrBuffers.AddAttr(P3D_ATTR_BINORMAL,Geometry->BiNormalBuffer,0,sizeof(float) * 3);
+   }
+
+  PlantInstance->FillVAttrBuffersI(&VAttrBuffers,GroupIndex);
+
+  if (MaterialDef->IsBillboard())
+   {
+    float          BillboardWidth;
+    float          BillboardHeight;
+
+    PlantTemplate->GetBillboardSize(&BillboardWidth,&BillboardHeight,GroupIndex);
+
+    UpdateBillboardsInfo(Geometry->PosBuffer,
+                         BillboardNormal,
+                         ModelViewMatrix,
+                         MaterialDef->GetBillboardMode(),
+                         BillboardWidth,
+                         BillboardHeight,
+                         BranchCount);
+   }
+
+  for (BranchIndex = 0; BranchIndex < BranchCount; BranchIndex++)
+   {
+    PlantTemplate->FillIndexBuffer
+     (&Geometry->IndexBuffer[BranchIndex * BranchIndexCount],
+       GroupIndex,
+       P3D_TRIANGLE_LIST,
+       P3D_UNSIGNED_INT,
+       BranchVAttrCount * BranchIndex);
+   }
+
+  return(true);
+ }
+
 static void        RenderBranchGroup  (P3DHLIPlantTemplate*PlantTemplate,
                                        P3DHLIPlantInstance*PlantInstance,
                                        unsigned int        GroupIndex,
@@ -307,35 +487,19 @@ static void        RenderBranchGroup  (P3DHLIPlantTemplate*PlantTemplate,
                                        NGPTexManager      *TexManager,
                                        P3DShaderLoader    *ShaderLoader)
  {
-  unsigned int                         BranchIndex;
-  unsigned int                         BranchCount;
   const P3DMaterialDef                *MaterialDef;
   GLuint                               DiffuseTexHandle;
   GLuint                               NormalTexHandle;
   float                                BillboardNormal[3];
   GLint                                BiNormalLocation;
 
-  BranchCount = PlantInstance->GetBranchCount(GroupIndex);
-
-  if (BranchCount == 0)
+  if (!IsGroupVisible(PlantTemplate,PlantInstance,GroupIndex,LOD))
    {
     return;
    }
 
   MaterialDef = PlantTemplate->GetMaterial(GroupIndex);
 
-  if (PlantTemplate->IsLODVisRangeEnabled(GroupIndex))
-   {
-    float          MinLOD,MaxLOD;
-
-    PlantTemplate->GetLODVisRange(&MinLOD,&MaxLOD,GroupIndex);
-
-    if ((LOD < MinLOD) || (LOD > MaxLOD))
-     {
-      return;
-     }
-   }
-
   float            R,G,B;
 
   MaterialDef->GetColor(&R,&G,&B);
@@ -439,84 +603,20 @@ static void        RenderBranchGroup  (P3DHLIPlantTemplate*PlantTemplate,
      }
    }
 
-  unsigned int     BranchVAttrCount;
-  unsigned int     BranchIndexCount;
-  unsigned int     TotalVAttrCount;
-  unsigned int     TotalIndexCount;
-
-  BranchVAttrCount = PlantTemplate->GetVAttrCountI(GroupIndex);
-  BranchIndexCount = PlantTemplate->GetIndexCount(GroupIndex,P3D_TRIANGLE_LIST);
-
-  TotalVAttrCount = BranchVAttrCount * BranchCount;
-  TotalIndexCount = BranchIndexCount * BranchCount;
-
-  float           *PosBuffer      = 0;
-  float           *NormalBuffer   = 0;
-  float           *BiNormalBuffer = 0;
-  float           *TexCoordBuffer = 0;
-  unsigned int    *IndexBuffer    = 0;
-
-  PosBuffer      = new(std::nothrow) float[3 * TotalVAttrCount];
-  NormalBuffer   = new(std::nothrow) float[3 * TotalVAttrCount];
-  TexCoordBuffer = new(std::nothrow) float[2 * TotalVAttrCount];
-  IndexBuffer    = new(std::nothrow) unsigned int[TotalIndexCount];
+  GLfloat                              ModelViewMatrix[16];
+  NGPShotGroupGeometry                 Geometry;
 
-  if (BiNormalLocation != -1)
-   {
-    BiNormalBuffer = new(std::nothrow) float[3 * TotalVAttrCount];
-   }
+  glGetFloatv(GL_MODELVIEW_MATRIX,ModelViewMatrix);
 
-  if ((PosBuffer != 0) && (NormalBuffer != 0) &&
-      (TexCoordBuffer != 0) && (IndexBuffer != 0) &&
-      ((BiNormalLocation == -1) || (BiNormalBuffer != 0)))
+  if (CreateGroupGeometry(&Geometry,
+                          PlantTemplate,
+                          PlantInstance,
+                          GroupIndex,
+                          BiNormalLocation != -1,
+                          ModelViewMatrix,
+                          BillboardNormal))
    {
-    P3DHLIVAttrBuffers                 VAttrBuffers;
-
-    if (MaterialDef->IsBillboard())
-     {
-      VAttrBuffers.AddAttr(P3D_ATTR_BILLBOARD_POS,PosBuffer,0,sizeof(float) * 3);
-     }
-    else
-     {
-      VAttrBuffers.AddAttr(P3D_ATTR_VERTEX,PosBuffer,0,sizeof(float) * 3);
-     }
-
-    VAttrBuffers.AddAttr(P3D_ATTR_NORMAL,NormalBuffer,0,sizeof(float) * 3);
-    VAttrBuffers.AddAttr(P3D_ATTR_TEXCOORD0,TexCoordBuffer,0,sizeof(float) * 2);
-
-    if (BiNormalBuffer != 0)
-     {
-      VAttrBuffers.AddAttr(P3D_ATTR_BINORMAL,BiNormalBuffer,0,sizeof(float) * 3);
-     }
-
-    PlantInstance->FillVAttrBuffersI(&VAttrBuffers,GroupIndex);
-
-    if (MaterialDef->IsBillboard())
-     {
-      float        BillboardWidth;
-      float        BillboardHeight;
-
-      PlantTemplate->GetBillboardSize(&BillboardWidth,&BillboardHeight,GroupIndex);
-
-      UpdateBillboardsInfo(PosBuffer,
-                           BillboardNormal,
-                           MaterialDef->GetBillboardMode(),
-                           BillboardWidth,
-                           BillboardHeight,
-                           BranchCount);
-     }
-
-    for (BranchIndex = 0; BranchIndex < BranchCount; BranchIndex++)
-     {
-      PlantTemplate->FillIndexBuffer
-       (&IndexBuffer[BranchIndex * BranchIndexCount],
-         GroupIndex,
-         P3D_TRIANGLE_LIST,
-         P3D_UNSIGNED_INT,
-         BranchVAttrCount * BranchIndex);
-     }
-
-    glVertexPointer(3,GL_FLOAT,0,PosBuffer);
+    glVertexPointer(3,GL_FLOAT,0,Geometry.PosBuffer);
     glEnableClientState(GL_VERTEX_ARRAY);
 
     if (MaterialDef->IsBillboard())
@@ -525,23 +625,23 @@ static void        RenderBranchGroup  (P3DHLIPlantTemplate*PlantTemplate,
      }
     else
      {
-      glNormalPointer(GL_FLOAT,0,NormalBuffer);
+      glNormalPointer(GL_FLOAT,0,Geometry.NormalBuffer);
       glEnableClientState(GL_NORMAL_ARRAY);
      }
 
     if ((DiffuseTexHandle != 0) || (NormalTexHandle != 0))
      {
       glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-      glTexCoordPointer(2,GL_FLOAT,0,TexCoordBuffer);
+      glTexCoordPointer(2,GL_FLOAT,0,Geometry.TexCoordBuffer);
      }
 
     if (BiNormalLocation != -1)
      {
       glEnableVertexAttribArrayARB(BiNormalLocation);
-      glVertexAttribPointerARB(BiNormalLocation,3,GL_FLOAT,0,GL_FALSE,BiNormalBuffer);
+      glVertexAttribPointerARB(BiNormalLocation,3,GL_FLOAT,0,GL_FALSE,Geometry.BiNormalBuffer);
      }
 
-    glDrawElements(GL_TRIANGLES,TotalIndexCount,GL_UNSIGNED_INT,IndexBuffer);
+    glDrawElements(GL_TRIANGLES,Geometry.IndexCount,GL_UNSIGNED_INT,Geometry.IndexBuffer);
 
     if (BiNormalLocation != -1)
      {
@@ -551,10 +651,8 @@ static void        RenderBranchGroup  (P3DHLIPlantTemplate*PlantTemplate,
     glDisableClientState(GL_TEXTURE_COORD_ARRAY);
     glDisableClientState(GL_NORMAL_ARRAY);
     glDisableClientState(GL_VERTEX_ARRAY);
-   }
-  else
-   {
-    fprintf(stderr,"error: out of memory\n");
+
+    FreeGroupGeometry(&Geometry);
    }
 
   if (ShaderLoader != 0)
@@ -565,53 +663,59 @@ static void        RenderBranchGroup  (P3DHLIPlantTemplate*PlantTemplate,
     glUseProgramObjectARB(0);
     #endif
    }
-
-  delete[] IndexBuffer;
-  delete[] TexCoordBuffer;
-  delete[] BiNormalBuffer;
-  delete[] NormalBuffer;
-  delete[] PosBuffer;
  }
 
-static void        Render             (P3DHLIPlantTemplate*PlantTemplate,
-                                       P3DHLIPlantInstance*PlantInstance,
-                                       const NGPShotColor3f
-                                                          *BGColor,
-                                       bool                HasAlpha,
-                                       float               XAngle,
-                                       float               YAngle,
-                                       float               LOD,
-                                       NGPTexManager      *TexManager,
-                                       const char         *VertexProgSrc,
-                                       const char         *FragmentProgSrc)
+static void        GetViewVolume      (float              *OrthoSize,
+                                       float              *SizeZ,
+                                       P3DVector3f        *Center,
+                                       P3DHLIPlantInstance*PlantInstance)
  {
   P3DVector3f                          BBoxMin;
   P3DVector3f                          BBoxMax;
   float                                SizeX;
   float                                SizeY;
-  float                                SizeZ;
-  float                                OrthoSize;
-  P3DShaderLoader                      ShaderLoader(VertexProgSrc,FragmentProgSrc);
 
   PlantInstance->GetBoundingBox(BBoxMin.v,BBoxMax.v);
 
-  SizeX = BBoxMax.X() - BBoxMin.X();
-  SizeY = BBoxMax.Y() - BBoxMin.Y();
-  SizeZ = BBoxMax.Z() - BBoxMin.Z();
+  SizeX  = BBoxMax.X() - BBoxMin.X();
+  SizeY  = BBoxMax.Y() - BBoxMin.Y();
+  *SizeZ = BBoxMax.Z() - BBoxMin.Z();
 
   if (SizeX > SizeY)
    {
-    OrthoSize = SizeX * 0.5f;
+    *OrthoSize = SizeX * 0.5f;
    }
   else
    {
-    OrthoSize = SizeY * 0.5f;
+    *OrthoSize = SizeY * 0.5f;
    }
 
-  P3DVector3f                          Center(BBoxMin);
+  Center->Set((BBoxMin.X() + BBoxMax.X()) * 0.5f,
+              (BBoxMin.Y() + BBoxMax.Y()) * 0.5f,
+              (BBoxMin.Z() + BBoxMax.Z()) * 0.5f);
+ }
+
+static void        Render             (P3DHLIPlantTemplate*PlantTemplate,
+                                       P3DHLIPlantInstance*PlantInstance,
+                                       unsigned int        Width,
+                                       unsigned int        Height,
+                                       const NGPShotColor3f
+                                                          *BGColor,
+                                       bool                HasAlpha,
+                                       float               XAngle,
+                                       float               YAngle,
+                                       float               LOD,
+                                       NGPTexManager      *TexManager,
+                                       P3DShaderLoader    *ShaderLoader)
+ {
+  float                                SizeZ;
+  float                                OrthoSize;
+  P3DVector3f                          Center;
+
+  GetViewVolume(&OrthoSize,&SizeZ,&Center,PlantInstance);
 
-  Center += BBoxMax;
-  Center *= 0.5f;
+  /* off-screen buffer may be larger than image in batch mode */
+  glViewport(0,0,Width,Height);
 
   glCullFace(GL_BACK);
   glEnable(GL_CULL_FACE);
@@ -655,7 +759,7 @@ static void        Render             (P3DHLIPlantTemplate*PlantTemplate,
                       GroupIndex,
                       LOD,
                       TexManager,
-                      ((VertexProgSrc == 0) && (FragmentProgSrc == 0)) ? 0 : &ShaderLoader);
+                      ShaderLoader);
    }
 
   glFinish();
@@ -665,102 +769,848 @@ static void        Render             (P3DHLIPlantTemplate*PlantTemplate,
   #endif
  }
 
-static bool        SaveImage          (const char         *FileName,
-                                       unsigned int        Width,
-                                       unsigned int        Height,
-                                       bool                HasAlpha)
+static void        RenderBranchGroupSoft
+                                      (P3DHLIPlantTemplate*PlantTemplate,
+                                       P3DHLIPlantInstance*PlantInstance,
+                                       unsigned int        GroupIndex,
+                                       float               LOD,
+                                       const float        *ModelViewMatrix,
+                                       NGPTexManager      *TexManager,
+                                       NGPSoftRasterizer  *Rasterizer)
  {
-  bool                                 Result;
-  P3DImageData                         Image;
+  const P3DMaterialDef                *MaterialDef;
+  const P3DImageData                  *DiffuseTexture;
+  float                                BillboardNormal[3];
+  NGPShotGroupGeometry                 Geometry;
 
-  if (HasAlpha)
-   {
-    Result = Image.Create(Width,Height,4,P3D_BYTE);
-   }
-  else
+  if (!IsGroupVisible(PlantTemplate,PlantInstance,GroupIndex,LOD))
    {
-    Result = Image.Create(Width,Height,3,P3D_BYTE);
+    return;
    }
 
-  if (Result)
-   {
-    glReadBuffer(GL_FRONT);
+  MaterialDef = PlantTemplate->GetMaterial(GroupIndex);
 
-    if (HasAlpha)
-     {
-      glReadPixels(0,0,Width,Height,GL_RGBA,GL_UNSIGNED_BYTE,Image.GetData());
-     }
-    else
-     {
-      glReadPixels(0,0,Width,Height,GL_RGB,GL_UNSIGNED_BYTE,Image.GetData());
-     }
+  float            R,G,B;
+
+  MaterialDef->GetColor(&R,&G,&B);
+
+  Rasterizer->SetColor(R,G,B);
+  Rasterizer->SetCullFace(!MaterialDef->IsDoubleSided());
+  Rasterizer->SetAlphaTest(MaterialDef->IsTransparent());
 
-    Image.FlipVertical();
+  DiffuseTexture = 0;
 
-    Result = P3DImageFmtHandlerTGA::SaveAsTGA(FileName,&Image);
+  if (MaterialDef->GetTexName(P3D_TEX_DIFFUSE) != 0)
+   {
+    DiffuseTexture = TexManager->LoadImage
+                      (MaterialDef->GetTexName(P3D_TEX_DIFFUSE));
 
-    if (!Result)
+    if (DiffuseTexture == 0)
      {
-      fprintf(stderr,"error: unable to save image\n");
+      fprintf(stderr,"warning: unable to load texture %s\n",
+              MaterialDef->GetTexName(P3D_TEX_DIFFUSE));
      }
    }
-  else
+
+  Rasterizer->SetTexture(DiffuseTexture);
+
+  if (CreateGroupGeometry(&Geometry,
+                          PlantTemplate,
+                          PlantInstance,
+                          GroupIndex,
+                          false,
+                          ModelViewMatrix,
+                          BillboardNormal))
    {
-    fprintf(stderr,"error: unable to create image\n");
+    Rasterizer->DrawTriangles(Geometry.PosBuffer,
+                              DiffuseTexture != 0 ? Geometry.TexCoordBuffer : 0,
+                              Geometry.IndexBuffer,
+                              Geometry.IndexCount);
+
+    FreeGroupGeometry(&Geometry);
    }
+ }
 
-  return(Result);
+/* glOrtho(-Size,Size,-Size,Size,Near,Far) */
+static void        MakeOrthoMatrix    (float              *Matrix,
+                                       float               Size,
+                                       float               Near,
+                                       float               Far)
+ {
+  P3DMatrix4x4f::MakeIdentity(Matrix);
+
+  Matrix[0]  =  1.0f / Size;
+  Matrix[5]  =  1.0f / Size;
+  Matrix[10] = -2.0f / (Far - Near);
+  Matrix[14] = -(Far + Near) / (Far - Near);
  }
 
-static bool        MakeShot           (const char         *ModelFileName,
-                                       const char         *ImageFileName,
-                                       const char         *TexPath,
-                                       unsigned int        Width,
-                                       unsigned int        Height,
-                                       const NGPShotColor3f
-                                                          *BGColor,
-                                       bool                HasAlpha,
+/* same view setup as Render uses */
+static void        GetShotMatrices    (float              *Projection,
+                                       float              *ModelView,
+                                       P3DHLIPlantInstance*PlantInstance,
                                        float               XAngle,
-                                       float               YAngle,
-                                       float               LOD,
-                                       const char         *VertexProgSrc,
-                                       const char         *FragmentProgSrc)
+                                       float               YAngle)
+ {
+  float                                SizeZ;
+  float                                OrthoSize;
+  P3DVector3f                          Center;
+  float                                Rotation[16];
+  float                                Temp[16];
+  P3DQuaternionf                       Orientation;
+
+  GetViewVolume(&OrthoSize,&SizeZ,&Center,PlantInstance);
+
+  MakeOrthoMatrix(Projection,OrthoSize,1.0f,2.0f + SizeZ);
+
+  P3DMatrix4x4f::MakeTranslation(ModelView,0.0f,0.0f,-SizeZ * 0.5f - 1.0f);
+
+  Orientation.FromAxisAndAngle(1.0f,0.0f,0.0f,P3DMATH_DEG2RAD(XAngle));
+  Orientation.ToMatrix(Rotation);
+  P3DMatrix4x4f::MultMatrix(Temp,ModelView,Rotation);
+
+  Orientation.FromAxisAndAngle(0.0f,1.0f,0.0f,P3DMATH_DEG2RAD(-YAngle));
+  Orientation.ToMatrix(Rotation);
+  P3DMatrix4x4f::MultMatrix(ModelView,Temp,Rotation);
+
+  P3DMatrix4x4f::Translate(Temp,ModelView,-Center.X(),-Center.Y(),0.0f);
+
+  memcpy(ModelView,Temp,sizeof(Temp));
+ }
+
+/* software counterpart of Render */
+static void        RenderSoft         (P3DHLIPlantTemplate*PlantTemplate,
+                                       P3DHLIPlantInstance*PlantInstance,
+                                       const NGPShotColor3f
+                                                          *BGColor,
+                                       bool                HasAlpha,
+                                       const float        *Projection,
+                                       const float        *ModelView,
+                                       float               LOD,
+                                       NGPTexManager      *TexManager,
+                                       NGPSoftRasterizer  *Rasterizer)
+ {
+  float                                Matrix[16];
+
+  if (HasAlpha)
+   {
+    Rasterizer->Clear(0.0f,0.0f,0.0f,0.0f);
+   }
+  else
+   {
+    Rasterizer->Clear(BGColor->c[0],BGColor->c[1],BGColor->c[2],1.0f);
+   }
+
+  P3DMatrix4x4f::MultMatrix(Matrix,Projection,ModelView);
+
+  Rasterizer->SetMatrix(Matrix);
+
+  unsigned int GroupIndex;
+  unsigned int GroupCount;
+
+  GroupCount = PlantTemplate->GetGroupCount();
+
+  for (GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
+   {
+    RenderBranchGroupSoft(PlantTemplate,
+                          PlantInstance,
+                          GroupIndex,
+                          LOD,
+                          ModelView,
+                          TexManager,
+                          Rasterizer);
+   }
+
+  Rasterizer->Finish();
+ }
+
+/* image is flipped, encoded and written by ImageSaver threads */
+static bool        SaveImage          (const char         *FileName,
+                                       unsigned int        Width,
+                                       unsigned int        Height,
+                                       bool                HasAlpha,
+                                       NGPImageSaver      *ImageSaver)
+ {
+  bool                                 Result;
+  P3DImageData                        *Image;
+
+  Image = new P3DImageData();
+
+  if (HasAlpha)
+   {
+    Result = Image->Create(Width,Height,4,P3D_BYTE);
+   }
+  else
+   {
+    Result = Image->Create(Width,Height,3,P3D_BYTE);
+   }
+
+  if (Result)
+   {
+    glReadBuffer(GL_FRONT);
+
+    if (HasAlpha)
+     {
+      glReadPixels(0,0,Width,Height,GL_RGBA,GL_UNSIGNED_BYTE,Image->GetData());
+     }
+    else
+     {
+      glReadPixels(0,0,Width,Height,GL_RGB,GL_UNSIGNED_BYTE,Image->GetData());
+     }
+
+    ImageSaver->Save(FileName,Image,true);
+   }
+  else
+   {
+    fprintf(stderr,"error: unable to create image\n");
+
+    delete Image;
+   }
+
+  return(Result);
+ }
+
+static P3DHLIPlantTemplate
+                  *LoadPlantTemplate  (const char         *ModelFileName)
  {
-  bool                                 Result;
   P3DInputStringStreamFile             SourceStream;
   P3DHLIPlantTemplate                 *PlantTemplate;
-  P3DHLIPlantInstance                 *PlantInstance;
 
-  std::string   ModelPath = P3DPathName::DirName(ModelFileName);
-  NGPTexManager TexManager(ModelPath.c_str(),TexPath);
+  PlantTemplate = 0;
+
+  try
+   {
+    SourceStream.Open(ModelFileName);
+
+    PlantTemplate = new P3DHLIPlantTemplate(&SourceStream);
+
+    SourceStream.Close();
+   }
+  catch (const P3DException &Exception)
+   {
+    fprintf(stderr,"error: %s (%s)\n",Exception.GetMessage(),ModelFileName);
+
+    delete PlantTemplate;
+
+    PlantTemplate = 0;
+   }
+
+  return(PlantTemplate);
+ }
+
+/* decodes all textures used by template in parallel */
+static void        PreloadTextures    (NGPTexManager      *TexManager,
+                                       P3DHLIPlantTemplate*PlantTemplate,
+                                       bool                Software,
+                                       unsigned int        ThreadCount)
+ {
+  std::vector<std::string>             TexNames;
+  const P3DMaterialDef                *MaterialDef;
+
+  for (unsigned int GroupIndex = 0; GroupIndex < PlantTemplate->GetGroupCount(); GroupIndex++)
+   {
+    MaterialDef = PlantTemplate->GetMaterial(GroupIndex);
+
+    if (MaterialDef->GetTexName(P3D_TEX_DIFFUSE) != 0)
+     {
+      TexNames.push_back(MaterialDef->GetTexName(P3D_TEX_DIFFUSE));
+     }
+
+    /* software renderer does not use normal maps */
+    if ((!Software) && (MaterialDef->GetTexName(P3D_TEX_NORMAL_MAP) != 0))
+     {
+      TexNames.push_back(MaterialDef->GetTexName(P3D_TEX_NORMAL_MAP));
+     }
+   }
+
+  if (Software)
+   {
+    TexManager->PreloadImages(TexNames,ThreadCount);
+   }
+  else
+   {
+    TexManager->PreloadTextures(TexNames,ThreadCount);
+   }
+ }
+
+static bool        MakeShot           (P3DHLIPlantTemplate*PlantTemplate,
+                                       P3DHLIPlantInstance*PlantInstance,
+                                       const char         *ImageFileName,
+                                       unsigned int        Width,
+                                       unsigned int        Height,
+                                       const NGPShotColor3f
+                                                          *BGColor,
+                                       bool                HasAlpha,
+                                       float               XAngle,
+                                       float               YAngle,
+                                       float               LOD,
+                                       NGPTexManager      *TexManager,
+                                       P3DShaderLoader    *ShaderLoader,
+                                       NGPSoftRasterizer  *SoftRasterizer,
+                                       NGPImageSaver      *ImageSaver)
+ {
+  bool                                 Result;
+
+  try
+   {
+    if (SoftRasterizer != 0)
+     {
+      P3DImageData                    *Image;
+      float                            Projection[16];
+      float                            ModelView[16];
+
+      Result = SoftRasterizer->Create(Width,Height);
+
+      if (Result)
+       {
+        GetShotMatrices(Projection,ModelView,PlantInstance,XAngle,YAngle);
+
+        RenderSoft( PlantTemplate,
+                    PlantInstance,
+                    BGColor,
+                    HasAlpha,
+                    Projection,
+                    ModelView,
+                    LOD,
+                    TexManager,
+                    SoftRasterizer);
+
+       }
+
+      Image = new P3DImageData();
+
+      if (Result)
+       {
+        Result = SoftRasterizer->GetImage(Image,HasAlpha);
+       }
+
+      if (Result)
+       {
+        ImageSaver->Save(ImageFileName,Image,false);
+       }
+      else
+       {
+        fprintf(stderr,"error: out of memory\n");
+
+        delete Image;
+       }
+     }
+    else
+     {
+      Render( PlantTemplate,
+              PlantInstance,
+              Width,
+              Height,
+              BGColor,
+              HasAlpha,
+              XAngle,
+              YAngle,
+              LOD,
+              TexManager,
+              ShaderLoader);
+
+      Result = SaveImage(ImageFileName,Width,Height,HasAlpha,ImageSaver);
+     }
+   }
+  catch (const P3DException &Exception)
+   {
+    fprintf(stderr,"error: %s\n",Exception.GetMessage());
+
+    Result = false;
+   }
+
+  return(Result);
+ }
+
+/* view direction (from plant center towards camera) for impostor grid cell */
+static void        GetImpostorViewDir (P3DVector3f        *Dir,
+                                       unsigned int        Layout,
+                                       unsigned int        GridSize,
+                                       unsigned int        Col,
+                                       unsigned int        Row)
+ {
+  float                                U;
+  float                                V;
+  float                                X;
+  float                                Z;
+
+  U = ((Col + 0.5f) / GridSize) * 2.0f - 1.0f;
+  V = ((Row + 0.5f) / GridSize) * 2.0f - 1.0f;
+
+  if (Layout == ImpostorLayoutHemisphere)
+   {
+    X = (U + V) * 0.5f;
+    Z = (U - V) * 0.5f;
+   }
+  else
+   {
+    X = U;
+    Z = V;
+   }
+
+  Dir->Set(X,1.0f - fabs(X) - fabs(Z),Z);
+
+  /* lower half of octahedron is folded over the corners */
+  if (Dir->Y() < 0.0f)
+   {
+    Dir->Set(X >= 0.0f ? 1.0f - fabs(Z) : fabs(Z) - 1.0f,
+             Dir->Y(),
+             Z >= 0.0f ? 1.0f - fabs(X) : fabs(X) - 1.0f);
+   }
+
+  Dir->Normalize();
+ }
+
+static void        GetImpostorViewBasis
+                                      (P3DVector3f        *Right,
+                                       P3DVector3f        *Up,
+                                       const P3DVector3f  *Dir)
+ {
+  P3DVector3f                          WorldUp;
+
+  if (fabs(Dir->Y()) > 0.999f)
+   {
+    WorldUp.Set(0.0f,0.0f,-1.0f);
+   }
+  else
+   {
+    WorldUp.Set(0.0f,1.0f,0.0f);
+   }
+
+  P3DVector3f::CrossProduct(Right->v,WorldUp.v,Dir->v);
+  Right->Normalize();
+  P3DVector3f::CrossProduct(Up->v,Dir->v,Right->v);
+ }
+
+/* bounding sphere shared by all impostor views, so every frame has the same scale */
+static void        GetImpostorVolume  (P3DVector3f        *Center,
+                                       float              *Radius,
+                                       P3DHLIPlantTemplate*PlantTemplate,
+                                       P3DHLIPlantInstance*PlantInstance)
+ {
+  P3DVector3f                          BBoxMin;
+  P3DVector3f                          BBoxMax;
+  P3DVector3f                          Diagonal;
+  float                                BillboardExtent;
+  unsigned int                         GroupIndex;
+  unsigned int                         GroupCount;
+
+  PlantInstance->GetBoundingBox(BBoxMin.v,BBoxMax.v);
+
+  Center->Set((BBoxMin.X() + BBoxMax.X()) * 0.5f,
+              (BBoxMin.Y() + BBoxMax.Y()) * 0.5f,
+              (BBoxMin.Z() + BBoxMax.Z()) * 0.5f);
+
+  Diagonal.Set(BBoxMax.X() - BBoxMin.X(),
+               BBoxMax.Y() - BBoxMin.Y(),
+               BBoxMax.Z() - BBoxMin.Z());
+
+  *Radius = P3DMath::Sqrtf(P3DVector3f::ScalarProduct(Diagonal.v,Diagonal.v)) * 0.5f;
+
+  /* billboards may stick out of bounding box */
+  BillboardExtent = 0.0f;
+  GroupCount      = PlantTemplate->GetGroupCount();
+
+  for (GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
+   {
+    if (PlantTemplate->GetMaterial(GroupIndex)->IsBillboard())
+     {
+      float        Width;
+      float        Height;
+      float        Extent;
+
+      PlantTemplate->GetBillboardSize(&Width,&Height,GroupIndex);
+
+      Extent = P3DMath::Sqrtf(Width * Width + Height * Height) * 0.5f;
+
+      if (Extent > BillboardExtent)
+       {
+        BillboardExtent = Extent;
+       }
+     }
+   }
+
+  *Radius += BillboardExtent;
+
+  if ((*Radius) <= 0.0f)
+   {
+    *Radius = 1.0f;
+   }
+ }
+
+static void        GetImpostorMatrices(float              *Projection,
+                                       float              *ModelView,
+                                       const P3DVector3f  *Dir,
+                                       const P3DVector3f  *Center,
+                                       float               Radius)
+ {
+  P3DVector3f                          Right;
+  P3DVector3f                          Up;
+  float                                Distance;
+
+  GetImpostorViewBasis(&Right,&Up,Dir);
+
+  /* same 1.0 margin before and behind the model as in Render */
+  Distance = Radius + 1.0f;
+
+  MakeOrthoMatrix(Projection,Radius,1.0f,2.0f * Radius + 2.0f);
+
+  ModelView[0]  = Right.X();
+  ModelView[1]  = Up.X();
+  ModelView[2]  = Dir->X();
+  ModelView[3]  = 0.0f;
+  ModelView[4]  = Right.Y();
+  ModelView[5]  = Up.Y();
+  ModelView[6]  = Dir->Y();
+  ModelView[7]  = 0.0f;
+  ModelView[8]  = Right.Z();
+  ModelView[9]  = Up.Z();
+  ModelView[10] = Dir->Z();
+  ModelView[11] = 0.0f;
+  ModelView[12] = -P3DVector3f::ScalarProduct(Right.v,Center->v);
+  ModelView[13] = -P3DVector3f::ScalarProduct(Up.v,Center->v);
+  ModelView[14] = -P3DVector3f::ScalarProduct(Dir->v,Center->v) - Distance;
+  ModelView[15] = 1.0f;
+ }
+
+static void        RenderImpostorView (P3DHLIPlantTemplate*PlantTemplate,
+                                       P3DHLIPlantInstance*PlantInstance,
+                                       unsigned int        FrameSize,
+                                       const float        *Projection,
+                                       const float        *ModelView,
+                                       float               LOD,
+                                       NGPTexManager      *TexManager,
+                                       P3DShaderLoader    *ShaderLoader)
+ {
+  glViewport(0,0,FrameSize,FrameSize);
+
+  glCullFace(GL_BACK);
+  glEnable(GL_CULL_FACE);
+  glEnable(GL_DEPTH_TEST);
+
+  glClearColor(0.0f,0.0f,0.0f,0.0f);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+  glMatrixMode(GL_PROJECTION);
+  glLoadMatrixf(Projection);
+
+  glMatrixMode(GL_MODELVIEW);
+  glLoadMatrixf(ModelView);
+
+  glDisable(GL_TEXTURE_2D);
+
+  unsigned int GroupIndex;
+  unsigned int GroupCount;
+
+  GroupCount = PlantTemplate->GetGroupCount();
+
+  for (GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
+   {
+    RenderBranchGroup(PlantTemplate,
+                      PlantInstance,
+                      GroupIndex,
+                      LOD,
+                      TexManager,
+                      ShaderLoader);
+   }
+
+  glFinish();
+
+  #ifndef _WIN32
+  glXWaitX();
+  #endif
+ }
+
+static bool        ReadImpostorFrame  (P3DImageData       *Frame,
+                                       unsigned int        FrameSize)
+ {
+  if (!Frame->Create(FrameSize,FrameSize,4,P3D_BYTE))
+   {
+    return(false);
+   }
+
+  glReadBuffer(GL_FRONT);
+  glReadPixels(0,0,FrameSize,FrameSize,GL_RGBA,GL_UNSIGNED_BYTE,Frame->GetData());
+
+  Frame->FlipVertical();
+
+  return(true);
+ }
+
+/* Frame rows are top-down, cell (0,0) is the top-left one */
+static void        CopyImpostorFrame  (P3DImageData       *Atlas,
+                                       const P3DImageData *Frame,
+                                       unsigned int        Col,
+                                       unsigned int        Row)
+ {
+  unsigned int                         FrameRowSize;
+  unsigned int                         AtlasRowSize;
+  unsigned char                       *Target;
+  const unsigned char                 *Source;
+
+  FrameRowSize = Frame->GetWidth() * Frame->GetChannelCount();
+  AtlasRowSize = Atlas->GetWidth() * Atlas->GetChannelCount();
+
+  Target = (unsigned char*)Atlas->GetData() +
+            Row * Frame->GetHeight() * AtlasRowSize + Col * FrameRowSize;
+  Source = (const unsigned char*)Frame->GetConstData();
+
+  for (unsigned int Y = 0; Y < Frame->GetHeight(); Y++)
+   {
+    memcpy(Target,Source,FrameRowSize);
+
+    Target += AtlasRowSize;
+    Source += FrameRowSize;
+   }
+ }
+
+static void        WriteJSONString    (FILE               *TargetFile,
+                                       const char         *Str)
+ {
+  fputc('"',TargetFile);
+
+  for (; *Str != 0; Str++)
+   {
+    if      ((*Str == '"') || (*Str == '\\'))
+     {
+      fputc('\\',TargetFile);
+      fputc(*Str,TargetFile);
+     }
+    else if (((unsigned char)*Str) < 0x20)
+     {
+      fprintf(TargetFile,"\\u%04x",(unsigned int)((unsigned char)*Str));
+     }
+    else
+     {
+      fputc(*Str,TargetFile);
+     }
+   }
+
+  fputc('"',TargetFile);
+ }
+
+/* <imagefile> with extension replaced by .json */
+static std::string GetImpostorInfoFileName
+                                      (const char         *ImageFileName)
+ {
+  std::string                          FileName(ImageFileName);
+  std::string                          Extension;
+
+  Extension = P3DPathName(ImageFileName).GetExtension();
+
+  if (!Extension.empty())
+   {
+    FileName.erase(FileName.size() - Extension.size() - 1);
+   }
+
+  return(FileName + ".json");
+ }
+
+static bool        SaveImpostorInfo   (const char         *FileName,
+                                       const char         *ImageFileName,
+                                       const char         *NormalFileName,
+                                       unsigned int        FrameSize,
+                                       unsigned int        Layout,
+                                       unsigned int        GridSize,
+                                       const P3DVector3f  *Center,
+                                       float               Radius)
+ {
+  FILE                                *TargetFile;
+  P3DVector3f                          Dir;
+  P3DVector3f                          Right;
+  P3DVector3f                          Up;
+
+  TargetFile = fopen(FileName,"wt");
+
+  if (TargetFile == NULL)
+   {
+    fprintf(stderr,"error: unable to create file %s\n",FileName);
+
+    return(false);
+   }
+
+  fprintf(TargetFile,"{\n");
+  fprintf(TargetFile,"  \"layout\": \"%s\",\n",Layout == ImpostorLayoutHemisphere ? "hemisphere" : "octahedron");
+  fprintf(TargetFile,"  \"grid\": %u,\n",GridSize);
+  fprintf(TargetFile,"  \"frameSize\": %u,\n",FrameSize);
+  fprintf(TargetFile,"  \"width\": %u,\n",GridSize * FrameSize);
+  fprintf(TargetFile,"  \"height\": %u,\n",GridSize * FrameSize);
+  fprintf(TargetFile,"  \"colorMap\": ");
+  WriteJSONString(TargetFile,P3DPathName::BaseName(ImageFileName).c_str());
+  fprintf(TargetFile,",\n");
+
+  if (NormalFileName != 0)
+   {
+    fprintf(TargetFile,"  \"normalMap\": ");
+    WriteJSONString(TargetFile,P3DPathName::BaseName(NormalFileName).c_str());
+    fprintf(TargetFile,",\n");
+   }
+
+  fprintf(TargetFile,"  \"center\": [%g, %g, %g],\n",Center->X(),Center->Y(),Center->Z());
+  fprintf(TargetFile,"  \"radius\": %g,\n",Radius);
+  fprintf(TargetFile,"  \"frames\": [\n");
+
+  for (unsigned int Row = 0; Row < GridSize; Row++)
+   {
+    for (unsigned int Col = 0; Col < GridSize; Col++)
+     {
+      GetImpostorViewDir(&Dir,Layout,GridSize,Col,Row);
+      GetImpostorViewBasis(&Right,&Up,&Dir);
+
+      fprintf(TargetFile,"    { \"index\": %u, \"dir\": [%.6f, %.6f, %.6f], \"up\": [%.6f, %.6f, %.6f], \"rect\": [%u, %u, %u, %u] }%s\n",
+              Row * GridSize + Col,
+              Dir.X(),Dir.Y(),Dir.Z(),
+              Up.X(),Up.Y(),Up.Z(),
+              Col * FrameSize,Row * FrameSize,FrameSize,FrameSize,
+              (Row + 1 < GridSize) || (Col + 1 < GridSize) ? "," : "");
+     }
+   }
+
+  fprintf(TargetFile,"  ]\n");
+  fprintf(TargetFile,"}\n");
+
+  if (fclose(TargetFile) != 0)
+   {
+    fprintf(stderr,"error: unable to write file %s\n",FileName);
+
+    return(false);
+   }
+
+  return(true);
+ }
+
+/* renders GridSize x GridSize views of the plant into one atlas */
+static bool        MakeImpostorAtlas  (P3DHLIPlantTemplate*PlantTemplate,
+                                       P3DHLIPlantInstance*PlantInstance,
+                                       const char         *ImageFileName,
+                                       const char         *NormalFileName,
+                                       unsigned int        FrameSize,
+                                       unsigned int        Layout,
+                                       unsigned int        GridSize,
+                                       float               LOD,
+                                       NGPTexManager      *TexManager,
+                                       P3DShaderLoader    *ShaderLoader,
+                                       P3DShaderLoader    *NormalShaderLoader,
+                                       NGPSoftRasterizer  *SoftRasterizer,
+                                       const NGPImageSaver*ImageSaver)
+ {
+  bool                                 Result;
+  P3DImageData                         ColorAtlas;
+  P3DImageData                         NormalAtlas;
+  P3DImageData                         Frame;
+  P3DVector3f                          Center;
+  float                                Radius;
+  P3DVector3f                          Dir;
+  float                                Projection[16];
+  float                                ModelView[16];
+
+  try
+   {
+    Result = ColorAtlas.Create(GridSize * FrameSize,GridSize * FrameSize,4,P3D_BYTE);
+
+    if ((Result) && (NormalFileName != 0))
+     {
+      Result = NormalAtlas.Create(GridSize * FrameSize,GridSize * FrameSize,4,P3D_BYTE);
+     }
+
+    if ((Result) && (SoftRasterizer != 0))
+     {
+      Result = SoftRasterizer->Create(FrameSize,FrameSize);
+     }
+
+    GetImpostorVolume(&Center,&Radius,PlantTemplate,PlantInstance);
+
+    for (unsigned int Row = 0; (Row < GridSize) && (Result); Row++)
+     {
+      for (unsigned int Col = 0; (Col < GridSize) && (Result); Col++)
+       {
+        GetImpostorViewDir(&Dir,Layout,GridSize,Col,Row);
+        GetImpostorMatrices(Projection,ModelView,&Dir,&Center,Radius);
+
+        if (SoftRasterizer != 0)
+         {
+          RenderSoft( PlantTemplate,
+                      PlantInstance,
+                      0,
+                      true,
+                      Projection,
+                      ModelView,
+                      LOD,
+                      TexManager,
+                      SoftRasterizer);
+
+          Result = SoftRasterizer->GetImage(&Frame,true);
+         }
+        else
+         {
+          RenderImpostorView(PlantTemplate,
+                             PlantInstance,
+                             FrameSize,
+                             Projection,
+                             ModelView,
+                             LOD,
+                             TexManager,
+                             ShaderLoader);
+
+          Result = ReadImpostorFrame(&Frame,FrameSize);
+         }
 
-  Result = true;
+        if (Result)
+         {
+          CopyImpostorFrame(&ColorAtlas,&Frame,Col,Row);
+         }
 
-  PlantTemplate = 0;
-  PlantInstance = 0;
+        if ((Result) && (NormalFileName != 0))
+         {
+          RenderImpostorView(PlantTemplate,
+                             PlantInstance,
+                             FrameSize,
+                             Projection,
+                             ModelView,
+                             LOD,
+                             TexManager,
+                             NormalShaderLoader);
 
-  try
-   {
-    SourceStream.Open(ModelFileName);
+          Result = ReadImpostorFrame(&Frame,FrameSize);
 
-    PlantTemplate = new P3DHLIPlantTemplate(&SourceStream);
+          if (Result)
+           {
+            CopyImpostorFrame(&NormalAtlas,&Frame,Col,Row);
+           }
+         }
+       }
+     }
 
-    SourceStream.Close();
+    if (Result)
+     {
+      Result = ImageSaver->SaveNow(ImageFileName,&ColorAtlas);
 
-    PlantInstance = PlantTemplate->CreateInstance();
+      if ((Result) && (NormalFileName != 0))
+       {
+        Result = ImageSaver->SaveNow(NormalFileName,&NormalAtlas);
+       }
 
-    Render( PlantTemplate,
-            PlantInstance,
-            BGColor,
-            HasAlpha,
-            XAngle,
-            YAngle,
-            LOD,
-           &TexManager,
-            VertexProgSrc,
-            FragmentProgSrc);
+      if (!Result)
+       {
+        fprintf(stderr,"error: unable to save image\n");
+       }
+     }
+    else
+     {
+      fprintf(stderr,"error: out of memory\n");
+     }
 
-    Result = SaveImage(ImageFileName,Width,Height,HasAlpha);
+    if (Result)
+     {
+      Result = SaveImpostorInfo(GetImpostorInfoFileName(ImageFileName).c_str(),
+                                ImageFileName,
+                                NormalFileName,
+                                FrameSize,
+                                Layout,
+                                GridSize,
+                                &Center,
+                                Radius);
+     }
    }
   catch (const P3DException &Exception)
    {
@@ -769,15 +1619,13 @@ static bool        MakeShot           (const char         *ModelFileName,
     Result = false;
    }
 
-  delete PlantInstance;
-  delete PlantTemplate;
-
   return(Result);
  }
 
 static void        ShowHelpMessage    ()
  {
   printf("Usage: ngpshot [options] modelfile imagefile\n");
+  printf("       ngpshot [options] -B <jobfile>\n");
   printf("Options:\n");
   printf("  -h            Display this information\n");
   printf("  -t <path>     Use <path> for texture search (current dir by default)\n");
@@ -791,6 +1639,24 @@ static void        ShowHelpMessage    ()
   printf("  -o auto       Use pbuffer or pixmap offscreen rendering method (autodetect)\n");
   printf("  -o pixmap     Use pixmap for offscreen rendering (auto by default)\n");
   printf("  -o pbuffer    Use pbuffer for offscreen rendering (auto by default)\n");
+  printf("  -o soft       Use built-in software renderer (no OpenGL/X11 required)\n");
+  printf("  -j <count>    Use <count> threads for software rendering and texture loading\n");
+  printf("                (CPU count by default)\n");
+  printf("  -B <jobfile>  Render all jobs listed in <jobfile> (\"-\" for stdin)\n");
+  printf("  -I hemi       Render impostor atlas of hemisphere views into imagefile\n");
+  printf("  -I octa       Render impostor atlas of full sphere (octahedral) views\n");
+  printf("  -g <count>    Use <count>x<count> views in impostor atlas (8 by default)\n");
+  printf("  -N <file>     Also render impostor normal map atlas into <file>\n");
+  printf("  -z <level>    Use zlib compression <level> (0-9) for PNG images\n");
+  printf("Job file contains one job per line:\n");
+  printf("  modelfile imagefile [-s <size>] [-x <degrees>] [-y <degrees>] [-l <LOD>] [-b <RRGGBB>]\n");
+  printf("Empty lines and lines starting with '#' are ignored. Options not given\n");
+  printf("for a job default to command line values. File names containing spaces\n");
+  printf("must be enclosed in double quotes.\n");
+  printf("Impostor atlas consists of <size>x<size> frames, view directions and\n");
+  printf("frame rectangles are written to imagefile with .json extension.\n");
+  printf("Images are saved in PNG format if file name ends with .png, in TGA\n");
+  printf("format otherwise.\n");
  }
 
 static bool        ParseColorString   (NGPShotColor3f     *Color,
@@ -839,6 +1705,78 @@ static bool        ParseColorString   (NGPShotColor3f     *Color,
   return(Result);
  }
 
+static bool        ParseImageSize     (unsigned int       *ImageSize,
+                                       const char         *SizeStr)
+ {
+  if (sscanf(SizeStr,"%u",ImageSize) == 1)
+   {
+    if ((*ImageSize) > 0)
+     {
+      return(true);
+     }
+    else
+     {
+      fprintf(stderr,"error: image size must be greater than zero\n");
+     }
+   }
+  else
+   {
+    fprintf(stderr,"error: invalid image size (%s)\n",SizeStr);
+   }
+
+  return(false);
+ }
+
+static bool        ParseAngle         (float              *Angle,
+                                       const char         *AngleStr)
+ {
+  if (sscanf(AngleStr,"%f",Angle) != 1)
+   {
+    fprintf(stderr,"error: invalid degrees value(%s)\n",AngleStr);
+
+    return(false);
+   }
+
+  return(true);
+ }
+
+static bool        ParseLOD           (float              *LOD,
+                                       const char         *LODStr)
+ {
+  if (sscanf(LODStr,"%f",LOD) != 1)
+   {
+    fprintf(stderr,"error: invalid LOD value(%s)\n",LODStr);
+
+    return(false);
+   }
+  else
+   {
+    if (((*LOD) < 0.0f) || ((*LOD) > 1.0f))
+     {
+      fprintf(stderr,"error: LOD value must be in [0.0 - 1.0] range\n");
+
+      return(false);
+     }
+   }
+
+  return(true);
+ }
+
+static bool        CheckImageFormat   (const char         *FileName)
+ {
+  if (NGPImageSaver::IsFormatSupported
+       (NGPImageSaver::GetFormatByFileName(FileName)))
+   {
+    return(true);
+   }
+  else
+   {
+    fprintf(stderr,"error: image format is not supported in this build (%s)\n",FileName);
+
+    return(false);
+   }
+ }
+
 static bool        ParseArgs          (char              **ModelFileName,
                                        char              **ImageFileName,
                                        char              **TexPath,
@@ -851,6 +1789,12 @@ static bool        ParseArgs          (char              **ModelFileName,
                                        char              **VertexProgFileName,
                                        char              **FragmentProgFileName,
                                        unsigned int       *OffScreenTarget,
+                                       unsigned int       *ThreadCount,
+                                       char              **JobFileName,
+                                       unsigned int       *ImpostorLayout,
+                                       unsigned int       *ImpostorGridSize,
+                                       char              **NormalFileName,
+                                       int                *PNGCompressionLevel,
                                        bool               *ShowHelp,
                                        unsigned int        ArgCount,
                                        char               *ArgValues[])
@@ -862,278 +1806,748 @@ static bool        ParseArgs          (char              **ModelFileName,
 
   Result = true;
 
-  *ModelFileName = 0;
-  *ImageFileName = 0;
-  *TexPath       = 0;
-  *ImageSize     = 256;
-  BGColor->c[0]  = 0.0f;
-  BGColor->c[1]  = 0.0f;
-  BGColor->c[2]  = 0.0f;
-  *NeedAlpha     = true;
-  *XAngle        = 0.0f;
-  *YAngle        = 0.0f;
-  *LOD           = 1.0f;
-  *VertexProgFileName   = 0;
-  *FragmentProgFileName = 0;
-  *OffScreenTarget      = GLOffScreenTargetAuto;
-  *ShowHelp             = false;
+  *ModelFileName = 0;
+  *ImageFileName = 0;
+  *TexPath       = 0;
+  *ImageSize     = 256;
+  BGColor->c[0]  = 0.0f;
+  BGColor->c[1]  = 0.0f;
+  BGColor->c[2]  = 0.0f;
+  *NeedAlpha     = true;
+  *XAngle        = 0.0f;
+  *YAngle        = 0.0f;
+  *LOD           = 1.0f;
+  *VertexProgFileName   = 0;
+  *FragmentProgFileName = 0;
+  *OffScreenTarget      = GLOffScreenTargetAuto;
+  *ThreadCount          = P3DThread::GetCPUCount();
+  *JobFileName          = 0;
+  *ImpostorLayout       = ImpostorLayoutNone;
+  *ImpostorGridSize     = 8;
+  *NormalFileName       = 0;
+  *PNGCompressionLevel  = NGP_PNG_COMPRESSION_DEFAULT;
+  *ShowHelp             = false;
+
+  ArgIndex = 1;
+
+  while ((ArgIndex < ArgCount) && (Result))
+   {
+    ArgStr    = ArgValues[ArgIndex];
+    ArgStrLen = strlen(ArgStr);
+
+    if (ArgStrLen > 0)
+     {
+      if (ArgStr[0] == '-')
+       {
+        if      (strcmp(ArgStr,"-h") == 0)
+         {
+          *ShowHelp = true;
+         }
+        else if (strcmp(ArgStr,"-t") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            *TexPath = ArgValues[ArgIndex];
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: texture search path required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-s") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            Result = ParseImageSize(ImageSize,ArgValues[ArgIndex]);
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: image size required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-x") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            Result = ParseAngle(XAngle,ArgValues[ArgIndex]);
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: angle required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-y") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            Result = ParseAngle(YAngle,ArgValues[ArgIndex]);
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: angle required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-l") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            Result = ParseLOD(LOD,ArgValues[ArgIndex]);
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: angle required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-b") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            *NeedAlpha = false;
+
+            Result = ParseColorString(BGColor,ArgValues[ArgIndex]);
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: color value required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-vs") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            *VertexProgFileName = ArgValues[ArgIndex];
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: vertex program file name required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-fs") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            *FragmentProgFileName = ArgValues[ArgIndex];
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: fragment program file name required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-o") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            if      (strcmp(ArgValues[ArgIndex],"auto") == 0)
+             {
+              *OffScreenTarget = GLOffScreenTargetAuto;
+             }
+            else if (strcmp(ArgValues[ArgIndex],"pixmap") == 0)
+             {
+              *OffScreenTarget = GLOffScreenTargetPixmap;
+             }
+            else if (strcmp(ArgValues[ArgIndex],"pbuffer") == 0)
+             {
+              *OffScreenTarget = GLOffScreenTargetPBuffer;
+             }
+            else if (strcmp(ArgValues[ArgIndex],"soft") == 0)
+             {
+              *OffScreenTarget = GLOffScreenTargetSoftware;
+             }
+            else
+             {
+              Result = false;
+
+              fprintf(stderr,"error: invalid off-screen target  (must be one of: auto, pixmap, pbuffer or soft)\n");
+             }
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: off-screen target required (auto, pixmap, pbuffer or soft)\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-j") == 0)
+         {
+          ArgIndex++;
 
-  ArgIndex = 1;
+          if (ArgIndex < ArgCount)
+           {
+            if ((sscanf(ArgValues[ArgIndex],"%u",ThreadCount) != 1) ||
+                ((*ThreadCount) == 0))
+             {
+              Result = false;
 
-  while ((ArgIndex < ArgCount) && (Result))
-   {
-    ArgStr    = ArgValues[ArgIndex];
-    ArgStrLen = strlen(ArgStr);
+              fprintf(stderr,"error: invalid thread count (%s)\n",ArgValues[ArgIndex]);
+             }
+           }
+          else
+           {
+            Result = false;
 
-    if (ArgStrLen > 0)
-     {
-      if (ArgStr[0] == '-')
-       {
-        if      (strcmp(ArgStr,"-h") == 0)
-         {
-          *ShowHelp = true;
+            fprintf(stderr,"error: thread count required\n");
+           }
          }
-        else if (strcmp(ArgStr,"-t") == 0)
+        else if (strcmp(ArgStr,"-B") == 0)
          {
           ArgIndex++;
 
           if (ArgIndex < ArgCount)
            {
-            *TexPath = ArgValues[ArgIndex];
+            *JobFileName = ArgValues[ArgIndex];
            }
           else
            {
             Result = false;
 
-            fprintf(stderr,"error: texture search path required\n");
+            fprintf(stderr,"error: job list file name required\n");
            }
          }
-        else if (strcmp(ArgStr,"-s") == 0)
+        else if (strcmp(ArgStr,"-I") == 0)
          {
           ArgIndex++;
 
           if (ArgIndex < ArgCount)
            {
-            if (sscanf(ArgValues[ArgIndex],"%u",ImageSize) == 1)
+            if      (strcmp(ArgValues[ArgIndex],"hemi") == 0)
              {
-              if ((*ImageSize) > 0)
-               {
-               }
-              else
-               {
-                Result = false;
-
-                fprintf(stderr,"error: image size must be greater than zero\n");
-               }
+              *ImpostorLayout = ImpostorLayoutHemisphere;
+             }
+            else if (strcmp(ArgValues[ArgIndex],"octa") == 0)
+             {
+              *ImpostorLayout = ImpostorLayoutOctahedron;
              }
             else
              {
               Result = false;
 
-              fprintf(stderr,"error: invalid image size (%s)\n",ArgValues[ArgIndex]);
+              fprintf(stderr,"error: invalid impostor layout (must be one of: hemi or octa)\n");
              }
            }
           else
            {
             Result = false;
 
-            fprintf(stderr,"error: image size required\n");
+            fprintf(stderr,"error: impostor layout required (hemi or octa)\n");
            }
          }
-        else if (strcmp(ArgStr,"-x") == 0)
+        else if (strcmp(ArgStr,"-g") == 0)
          {
           ArgIndex++;
 
           if (ArgIndex < ArgCount)
            {
-            if (sscanf(ArgValues[ArgIndex],"%f",XAngle) != 1)
+            if ((sscanf(ArgValues[ArgIndex],"%u",ImpostorGridSize) != 1) ||
+                ((*ImpostorGridSize) == 0))
              {
               Result = false;
 
-              fprintf(stderr,"error: invalid degrees value(%s)\n",ArgValues[ArgIndex]);
+              fprintf(stderr,"error: invalid impostor view count (%s)\n",ArgValues[ArgIndex]);
              }
            }
           else
            {
             Result = false;
 
-            fprintf(stderr,"error: angle required\n");
+            fprintf(stderr,"error: impostor view count required\n");
            }
          }
-        else if (strcmp(ArgStr,"-y") == 0)
+        else if (strcmp(ArgStr,"-N") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            *NormalFileName = ArgValues[ArgIndex];
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: normal map file name required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-z") == 0)
          {
           ArgIndex++;
 
           if (ArgIndex < ArgCount)
            {
-            if (sscanf(ArgValues[ArgIndex],"%f",YAngle) != 1)
+            if ((sscanf(ArgValues[ArgIndex],"%d",PNGCompressionLevel) != 1) ||
+                ((*PNGCompressionLevel) < 0) ||
+                ((*PNGCompressionLevel) > 9))
              {
               Result = false;
 
-              fprintf(stderr,"error: invalid degrees value(%s)\n",ArgValues[ArgIndex]);
+              fprintf(stderr,"error: invalid PNG compression level (%s)\n",ArgValues[ArgIndex]);
              }
            }
           else
            {
             Result = false;
 
-            fprintf(stderr,"error: angle required\n");
+            fprintf(stderr,"error: PNG compression level required\n");
            }
          }
-        else if (strcmp(ArgStr,"-l") == 0)
+        else
          {
-          ArgIndex++;
+          Result = false;
+
+          fprintf(stderr,"error: invalid option \"%s\"\n",ArgStr);
+         }
+       }
+      else
+       {
+        if      ((*JobFileName) != 0)
+         {
+          Result = false;
+
+          fprintf(stderr,"error: model and image file names are taken from job list in batch mode\n");
+         }
+        else if ((*ModelFileName) == 0)
+         {
+          *ModelFileName = ArgStr;
+         }
+        else if ((*ImageFileName) == 0)
+         {
+          *ImageFileName = ArgStr;
+         }
+        else
+         {
+          Result = false;
+
+          fprintf(stderr,"error: extra argument passed\n");
+         }
+       }
+     }
+
+    ArgIndex++;
+   }
+
+  if ((!(*ShowHelp)) && (Result) && ((*OffScreenTarget) == GLOffScreenTargetSoftware))
+   {
+    if (((*VertexProgFileName) != 0) || ((*FragmentProgFileName) != 0))
+     {
+      Result = false;
+
+      fprintf(stderr,"error: vertex and fragment programs are not supported by software renderer\n");
+     }
+    else if ((*NormalFileName) != 0)
+     {
+      Result = false;
+
+      fprintf(stderr,"error: normal maps are not supported by software renderer\n");
+     }
+   }
+
+  if ((!(*ShowHelp)) && (Result))
+   {
+    if ((*ImpostorLayout) == ImpostorLayoutNone)
+     {
+      if ((*NormalFileName) != 0)
+       {
+        Result = false;
+
+        fprintf(stderr,"error: normal maps are supported in impostor mode only\n");
+       }
+     }
+    else
+     {
+      if      ((*JobFileName) != 0)
+       {
+        Result = false;
+
+        fprintf(stderr,"error: impostor mode is not supported in batch mode\n");
+       }
+      /* TGA image dimensions are 16-bit */
+      else if ((*ImpostorGridSize) > 0xFFFF / (*ImageSize))
+       {
+        Result = false;
+
+        fprintf(stderr,"error: impostor atlas is too large\n");
+       }
+     }
+   }
+
+  if ((!(*ShowHelp)) && ((*JobFileName) == 0))
+   {
+    if      ((*ModelFileName) == 0)
+     {
+      Result = false;
+
+      fprintf(stderr,"error: model file name required\n");
+     }
+    else if ((*ImageFileName) == 0)
+     {
+      Result = false;
+
+      fprintf(stderr,"error: image file name required\n");
+     }
+    else
+     {
+      Result = CheckImageFormat(*ImageFileName);
+     }
+
+    if ((Result) && ((*NormalFileName) != 0))
+     {
+      Result = CheckImageFormat(*NormalFileName);
+     }
+   }
+
+  return(Result);
+ }
+
+/* splits Line in place, returns false on unbalanced quotes */
+static bool        SplitJobLine       (std::vector<char*> *Tokens,
+                                       char               *Line)
+ {
+  char                                *Src;
+  char                                *Dst;
+
+  Src = Line;
+
+  while (*Src != 0)
+   {
+    while ((*Src == ' ') || (*Src == '\t'))
+     {
+      Src++;
+     }
+
+    if (*Src == 0)
+     {
+      break;
+     }
+
+    Dst = Src;
+
+    Tokens->push_back(Dst);
+
+    if (*Src == '"')
+     {
+      Src++;
+
+      while ((*Src != 0) && (*Src != '"'))
+       {
+        *Dst++ = *Src++;
+       }
+
+      if (*Src == 0)
+       {
+        return(false);
+       }
+
+      Src++;
+     }
+    else
+     {
+      while ((*Src != 0) && (*Src != ' ') && (*Src != '\t'))
+       {
+        *Dst++ = *Src++;
+       }
+     }
+
+    if (*Src != 0)
+     {
+      Src++;
+     }
+
+    *Dst = 0;
+   }
+
+  return(true);
+ }
+
+static bool        ParseJobLine       (NGPShotJob         *Job,
+                                       char               *Line)
+ {
+  std::vector<char*>                   Tokens;
+  unsigned int                         TokenIndex;
+  bool                                 Result;
+
+  if (!SplitJobLine(&Tokens,Line))
+   {
+    fprintf(stderr,"error: unbalanced quotes\n");
+
+    return(false);
+   }
+
+  if (Tokens.size() < 2)
+   {
+    fprintf(stderr,"error: model and image file names required\n");
+
+    return(false);
+   }
+
+  Job->ModelFileName = Tokens[0];
+  Job->ImageFileName = Tokens[1];
+
+  Result     = CheckImageFormat(Tokens[1]);
+  TokenIndex = 2;
+
+  while ((TokenIndex < Tokens.size()) && (Result))
+   {
+    const char    *Option;
+    const char    *Value;
+
+    Option = Tokens[TokenIndex++];
+
+    if (TokenIndex < Tokens.size())
+     {
+      Value = Tokens[TokenIndex++];
+
+      if      (strcmp(Option,"-s") == 0)
+       {
+        Result = ParseImageSize(&Job->ImageSize,Value);
+       }
+      else if (strcmp(Option,"-x") == 0)
+       {
+        Result = ParseAngle(&Job->XAngle,Value);
+       }
+      else if (strcmp(Option,"-y") == 0)
+       {
+        Result = ParseAngle(&Job->YAngle,Value);
+       }
+      else if (strcmp(Option,"-l") == 0)
+       {
+        Result = ParseLOD(&Job->LOD,Value);
+       }
+      else if (strcmp(Option,"-b") == 0)
+       {
+        Job->HasAlpha = false;
+
+        Result = ParseColorString(&Job->BGColor,Value);
+       }
+      else
+       {
+        Result = false;
+
+        fprintf(stderr,"error: invalid job option \"%s\"\n",Option);
+       }
+     }
+    else
+     {
+      Result = false;
+
+      fprintf(stderr,"error: value required for job option \"%s\"\n",Option);
+     }
+   }
+
+  return(Result);
+ }
+
+static bool        LoadJobList        (std::vector<NGPShotJob>
+                                                          *Jobs,
+                                       const char         *JobFileName,
+                                       const NGPShotJob   *Defaults)
+ {
+  char                                *Content;
+  char                                *Line;
+  char                                *LineEnd;
+  unsigned int                         LineNumber;
+  bool                                 Result;
+
+  if (strcmp(JobFileName,"-") == 0)
+   {
+    Content = LoadStreamContent(stdin,"stdin");
+   }
+  else
+   {
+    Content = LoadFileContent(JobFileName);
+   }
+
+  if (Content == 0)
+   {
+    return(false);
+   }
+
+  Result     = true;
+  Line       = Content;
+  LineNumber = 0;
+
+  while ((Line != 0) && (Result))
+   {
+    LineNumber++;
+
+    LineEnd = strchr(Line,'\n');
 
-          if (ArgIndex < ArgCount)
-           {
-            if (sscanf(ArgValues[ArgIndex],"%f",LOD) != 1)
-             {
-              Result = false;
+    if (LineEnd != 0)
+     {
+      *LineEnd = 0;
+     }
 
-              fprintf(stderr,"error: invalid LOD value(%s)\n",ArgValues[ArgIndex]);
-             }
-            else
-             {
-              if (((*LOD) < 0.0f) || ((*LOD) > 1.0f))
-               {
-                Result = false;
+    size_t         LineLength = strlen(Line);
 
-                fprintf(stderr,"error: LOD value must be in [0.0 - 1.0] range\n");
-               }
-             }
-           }
-          else
-           {
-            Result = false;
+    if ((LineLength > 0) && (Line[LineLength - 1] == '\r'))
+     {
+      Line[LineLength - 1] = 0;
+     }
 
-            fprintf(stderr,"error: angle required\n");
-           }
-         }
-        else if (strcmp(ArgStr,"-b") == 0)
-         {
-          ArgIndex++;
+    Line += strspn(Line," \t");
 
-          if (ArgIndex < ArgCount)
-           {
-            *NeedAlpha = false;
+    if ((*Line != 0) && (*Line != '#'))
+     {
+      NGPShotJob                       Job(*Defaults);
 
-            Result = ParseColorString(BGColor,ArgValues[ArgIndex]);
-           }
-          else
-           {
-            Result = false;
+      Job.LineNumber = LineNumber;
 
-            fprintf(stderr,"error: color value required\n");
-           }
-         }
-        else if (strcmp(ArgStr,"-vs") == 0)
-         {
-          ArgIndex++;
+      if (ParseJobLine(&Job,Line))
+       {
+        Jobs->push_back(Job);
+       }
+      else
+       {
+        fprintf(stderr,"error: invalid job at %s:%u\n",JobFileName,LineNumber);
 
-          if (ArgIndex < ArgCount)
-           {
-            *VertexProgFileName = ArgValues[ArgIndex];
-           }
-          else
-           {
-            Result = false;
+        Result = false;
+       }
+     }
 
-            fprintf(stderr,"error: vertex program file name required\n");
-           }
-         }
-        else if (strcmp(ArgStr,"-fs") == 0)
-         {
-          ArgIndex++;
+    Line = LineEnd != 0 ? LineEnd + 1 : 0;
+   }
 
-          if (ArgIndex < ArgCount)
-           {
-            *FragmentProgFileName = ArgValues[ArgIndex];
-           }
-          else
-           {
-            Result = false;
+  free(Content);
 
-            fprintf(stderr,"error: fragment program file name required\n");
-           }
-         }
-        else if (strcmp(ArgStr,"-o") == 0)
-         {
-          ArgIndex++;
+  return(Result);
+ }
 
-          if (ArgIndex < ArgCount)
-           {
-            if      (strcmp(ArgValues[ArgIndex],"auto") == 0)
-             {
-              *OffScreenTarget = GLOffScreenTargetAuto;
-             }
-            else if (strcmp(ArgValues[ArgIndex],"pixmap") == 0)
-             {
-              *OffScreenTarget = GLOffScreenTargetPixmap;
-             }
-            else if (strcmp(ArgValues[ArgIndex],"pbuffer") == 0)
-             {
-              *OffScreenTarget = GLOffScreenTargetPBuffer;
-             }
-            else
-             {
-              Result = false;
+static bool        CompareJobsByModel (const NGPShotJob   &Job1,
+                                       const NGPShotJob   &Job2)
+ {
+  return(Job1.ModelFileName < Job2.ModelFileName);
+ }
 
-              fprintf(stderr,"error: invalid off-screen target  (must be one of: auto, pixmap or pbuffer)\n");
-             }
-           }
-          else
-           {
-            Result = false;
+/* Jobs must be grouped by model file name. GL context, shaders and  */
+/* textures are shared by all jobs, each model is parsed only once.  */
+static bool        RunJobList         (const std::vector<NGPShotJob>
+                                                          &Jobs,
+                                       const char         *TexPath,
+                                       P3DShaderLoader    *ShaderLoader,
+                                       NGPSoftRasterizer  *SoftRasterizer,
+                                       NGPImageSaver      *ImageSaver,
+                                       unsigned int        ThreadCount)
+ {
+  NGPTexManager                        TexManager(".",TexPath);
+  P3DHLIPlantTemplate                 *PlantTemplate;
+  P3DHLIPlantInstance                 *PlantInstance;
+  unsigned int                         FailedCount;
+  std::string                          CurrModelFileName;
 
-            fprintf(stderr,"error: off-screen target required (auto, pixmap or pbuffer)\n");
-           }
-         }
-        else
-         {
-          Result = false;
+  PlantTemplate = 0;
+  PlantInstance = 0;
+  FailedCount   = 0;
 
-          fprintf(stderr,"error: invalid option \"%s\"\n",ArgStr);
-         }
-       }
-      else
+  for (unsigned int JobIndex = 0; JobIndex < Jobs.size(); JobIndex++)
+   {
+    const NGPShotJob                  &Job = Jobs[JobIndex];
+    bool                               Ok;
+
+    if ((JobIndex == 0) || (Job.ModelFileName != CurrModelFileName))
+     {
+      delete PlantInstance;
+      delete PlantTemplate;
+
+      PlantInstance     = 0;
+      CurrModelFileName = Job.ModelFileName;
+      PlantTemplate     = LoadPlantTemplate(CurrModelFileName.c_str());
+
+      if (PlantTemplate != 0)
        {
-        if      ((*ModelFileName) == 0)
+        try
          {
-          *ModelFileName = ArgStr;
+          PlantInstance = PlantTemplate->CreateInstance();
          }
-        else if ((*ImageFileName) == 0)
+        catch (const P3DException &Exception)
          {
-          *ImageFileName = ArgStr;
+          fprintf(stderr,"error: %s\n",Exception.GetMessage());
          }
-        else
-         {
-          Result = false;
 
-          fprintf(stderr,"error: extra argument passed\n");
-         }
+        TexManager.SetModelPath
+         (P3DPathName::DirName(CurrModelFileName.c_str()).c_str());
+
+        PreloadTextures(&TexManager,PlantTemplate,SoftRasterizer != 0,ThreadCount);
        }
      }
 
-    ArgIndex++;
-   }
-
-  if (!(*ShowHelp))
-   {
-    if      ((*ModelFileName) == 0)
+    if (PlantInstance != 0)
      {
-      Result = false;
-
-      fprintf(stderr,"error: model file name required\n");
+      Ok = MakeShot( PlantTemplate,
+                     PlantInstance,
+                     Job.ImageFileName.c_str(),
+                     Job.ImageSize,
+                     Job.ImageSize,
+                    &Job.BGColor,
+                     Job.HasAlpha,
+                     Job.XAngle,
+                     Job.YAngle,
+                     Job.LOD,
+                    &TexManager,
+                     ShaderLoader,
+                     SoftRasterizer,
+                     ImageSaver);
      }
-    else if ((*ImageFileName) == 0)
+    else
      {
-      Result = false;
+      Ok = false;
+     }
 
-      fprintf(stderr,"error: image file name required\n");
+    if (!Ok)
+     {
+      fprintf(stderr,"error: job at line %u (%s) failed\n",
+              Job.LineNumber,
+              Job.ImageFileName.c_str());
+
+      FailedCount++;
      }
    }
 
-  return(Result);
+  delete PlantInstance;
+  delete PlantTemplate;
+
+  /* images are saved in background, errors are reported by file name */
+  FailedCount += ImageSaver->Flush();
+
+  if (FailedCount > 0)
+   {
+    fprintf(stderr,"error: %u of %u jobs failed\n",
+            FailedCount,
+            (unsigned int)Jobs.size());
+   }
+
+  return(FailedCount == 0);
  }
 
 int                main               (int                 argc,
@@ -1153,9 +2567,16 @@ int                main               (int                 argc,
   char                                *VertexProgFileName;
   char                                *FragmentProgFileName;
   unsigned int                         OffScreenTarget;
+  unsigned int                         ThreadCount;
+  char                                *JobFileName;
+  unsigned int                         ImpostorLayout;
+  unsigned int                         ImpostorGridSize;
+  char                                *NormalFileName;
+  int                                  PNGCompressionLevel;
   bool                                 ShowHelp;
   char                                *VertexProgramSrc;
   char                                *FragmentProgramSrc;
+  std::vector<NGPShotJob>              Jobs;
 
   Result = ParseArgs(&ModelFileName,
                      &ImageFileName,
@@ -1169,9 +2590,58 @@ int                main               (int                 argc,
                      &VertexProgFileName,
                      &FragmentProgFileName,
                      &OffScreenTarget,
+                     &ThreadCount,
+                     &JobFileName,
+                     &ImpostorLayout,
+                     &ImpostorGridSize,
+                     &NormalFileName,
+                     &PNGCompressionLevel,
                      &ShowHelp,
                       argc,argv);
 
+  if ((Result) && (!ShowHelp) && (JobFileName != 0))
+   {
+    NGPShotJob                         Defaults;
+
+    Defaults.ImageSize  = ImageSize;
+    Defaults.BGColor    = BGColor;
+    Defaults.HasAlpha   = NeedAlpha;
+    Defaults.XAngle     = XAngle;
+    Defaults.YAngle     = YAngle;
+    Defaults.LOD        = LOD;
+    Defaults.LineNumber = 0;
+
+    Result = LoadJobList(&Jobs,JobFileName,&Defaults);
+
+    if (Result)
+     {
+      std::stable_sort(Jobs.begin(),Jobs.end(),CompareJobsByModel);
+
+      /* single off-screen buffer big enough for every job */
+      ImageSize = 1;
+      NeedAlpha = false;
+
+      for (unsigned int JobIndex = 0; JobIndex < Jobs.size(); JobIndex++)
+       {
+        if (Jobs[JobIndex].ImageSize > ImageSize)
+         {
+          ImageSize = Jobs[JobIndex].ImageSize;
+         }
+
+        if (Jobs[JobIndex].HasAlpha)
+         {
+          NeedAlpha = true;
+         }
+       }
+     }
+   }
+
+  /* impostor atlases are always rendered with transparent background */
+  if (ImpostorLayout != ImpostorLayoutNone)
+   {
+    NeedAlpha = true;
+   }
+
   if (Result)
    {
     if (ShowHelp)
@@ -1180,41 +2650,47 @@ int                main               (int                 argc,
      }
     else
      {
-      Result = GLMemoryContext.CreateBaseContext();
-
-      if (Result)
+      if (OffScreenTarget != GLOffScreenTargetSoftware)
        {
-        if (GLMemoryContext.IsPBufferSupported())
-         {
-          if (OffScreenTarget == GLOffScreenTargetAuto)
-           {
-            OffScreenTarget = GLOffScreenTargetPBuffer;
-           }
-         }
-        else
+        Result = GLMemoryContext.CreateBaseContext();
+
+        if (Result)
          {
-          if      (OffScreenTarget == GLOffScreenTargetAuto)
+          if (GLMemoryContext.IsPBufferSupported())
            {
-            OffScreenTarget = GLOffScreenTargetPixmap;
+            if (OffScreenTarget == GLOffScreenTargetAuto)
+             {
+              OffScreenTarget = GLOffScreenTargetPBuffer;
+             }
            }
-          else if (OffScreenTarget == GLOffScreenTargetPBuffer)
+          else
            {
-            Result = false;
+            if      (OffScreenTarget == GLOffScreenTargetAuto)
+             {
+              OffScreenTarget = GLOffScreenTargetPixmap;
+             }
+            else if (OffScreenTarget == GLOffScreenTargetPBuffer)
+             {
+              Result = false;
+             }
            }
          }
-       }
 
-      if (Result)
-       {
-        Result = GLMemoryContext.Create(ImageSize,ImageSize,NeedAlpha,OffScreenTarget == GLOffScreenTargetPBuffer);
+        if (Result)
+         {
+          Result = GLMemoryContext.Create(ImageSize,ImageSize,NeedAlpha,OffScreenTarget == GLOffScreenTargetPBuffer);
+         }
+
+        if (Result)
+         {
+          GLMemoryContext.MakeCurrent();
+
+          P3DGLExtInit();
+         }
        }
 
       if (Result)
        {
-        GLMemoryContext.MakeCurrent();
-
-        P3DGLExtInit();
-
         VertexProgramSrc   = 0;
         FragmentProgramSrc = 0;
 
@@ -1258,6 +2734,18 @@ int                main               (int                 argc,
            }
          }
 
+        if (NormalFileName != 0)
+         {
+          if ((!GLEW_ARB_shader_objects) ||
+              (!GLEW_ARB_vertex_shader)  ||
+              (!GLEW_ARB_fragment_shader))
+           {
+            fprintf(stderr,"error: hardware/driver lacks GLSL support - unable to render normal maps\n");
+
+            Result = false;
+           }
+         }
+
         if (Result)
          {
           std::string                    TexPath;
@@ -1271,18 +2759,110 @@ int                main               (int                 argc,
             TexPath = P3DPathInfo::GetCurrentDir();
            }
 
-          Result = MakeShot( ModelFileName,
-                             ImageFileName,
-                             TexPath.c_str(),
-                             ImageSize,
-                             ImageSize,
-                            &BGColor,
-                             NeedAlpha,
-                             XAngle,
-                             YAngle,
-                             LOD,
-                             VertexProgramSrc,
-                             FragmentProgramSrc);
+          P3DShaderLoader                ShaderLoader(VertexProgramSrc,FragmentProgramSrc);
+          P3DShaderLoader               *ShaderLoaderPtr;
+          P3DShaderLoader                NormalShaderLoader(NGPShotNormalVertexShaderSrc,
+                                                            NGPShotNormalFragmentShaderSrc);
+          NGPSoftRasterizer              SoftRasterizer(ThreadCount);
+          NGPSoftRasterizer             *SoftRasterizerPtr;
+          NGPImageSaver                  ImageSaver(ThreadCount,PNGCompressionLevel);
+
+          if ((VertexProgramSrc == 0) && (FragmentProgramSrc == 0))
+           {
+            ShaderLoaderPtr = 0;
+           }
+          else
+           {
+            ShaderLoaderPtr = &ShaderLoader;
+           }
+
+          if (OffScreenTarget == GLOffScreenTargetSoftware)
+           {
+            SoftRasterizerPtr = &SoftRasterizer;
+           }
+          else
+           {
+            SoftRasterizerPtr = 0;
+           }
+
+          if (JobFileName != 0)
+           {
+            Result = RunJobList(Jobs,TexPath.c_str(),ShaderLoaderPtr,SoftRasterizerPtr,&ImageSaver,ThreadCount);
+           }
+          else
+           {
+            P3DHLIPlantTemplate         *PlantTemplate;
+            P3DHLIPlantInstance         *PlantInstance;
+
+            std::string   ModelPath = P3DPathName::DirName(ModelFileName);
+            NGPTexManager TexManager(ModelPath.c_str(),TexPath.c_str());
+
+            PlantInstance = 0;
+            PlantTemplate = LoadPlantTemplate(ModelFileName);
+
+            if (PlantTemplate != 0)
+             {
+              try
+               {
+                PlantInstance = PlantTemplate->CreateInstance();
+               }
+              catch (const P3DException &Exception)
+               {
+                fprintf(stderr,"error: %s\n",Exception.GetMessage());
+               }
+             }
+
+            if (PlantInstance != 0)
+             {
+              PreloadTextures(&TexManager,PlantTemplate,SoftRasterizerPtr != 0,ThreadCount);
+             }
+
+            if      (PlantInstance == 0)
+             {
+              Result = false;
+             }
+            else if (ImpostorLayout != ImpostorLayoutNone)
+             {
+              Result = MakeImpostorAtlas(PlantTemplate,
+                                         PlantInstance,
+                                         ImageFileName,
+                                         NormalFileName,
+                                         ImageSize,
+                                         ImpostorLayout,
+                                         ImpostorGridSize,
+                                         LOD,
+                                        &TexManager,
+                                         ShaderLoaderPtr,
+                                        &NormalShaderLoader,
+                                         SoftRasterizerPtr,
+                                        &ImageSaver);
+             }
+            else
+             {
+              Result = MakeShot( PlantTemplate,
+                                 PlantInstance,
+                                 ImageFileName,
+                                 ImageSize,
+                                 ImageSize,
+                                &BGColor,
+                                 NeedAlpha,
+                                 XAngle,
+                                 YAngle,
+                                 LOD,
+                                &TexManager,
+                                 ShaderLoaderPtr,
+                                 SoftRasterizerPtr,
+                                &ImageSaver);
+
+              if (ImageSaver.Flush() > 0)
+               {
+                Result = false;
+               }
+             }
+
+            delete PlantInstance;
+            delete PlantTemplate;
+           }
          }
 
         free(FragmentProgramSrc);
@@ -0,0 +1,660 @@
+/***************************************************************************
+
+ Copyright (C) 2006  Sergey Prokhorchuk
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***************************************************************************/
+
+
+#include <math.h>
+#include <string.h>
+
+#include <new>
+#include <algorithm>
+
+#include <ngpcore/p3ddefs.h>
+
+#include <ngput/p3dthread.h>
+
+#include "ngpsoftrast.h"
+
+#define NGP_SOFT_SUBPIXEL_ONE    (1 << NGP_SOFT_SUBPIXEL_BITS)
+#define NGP_SOFT_SUBPIXEL_HALF   (1 << (NGP_SOFT_SUBPIXEL_BITS - 1))
+/* keeps edge function products well inside 64-bit range */
+#define NGP_SOFT_MAX_COORD       (16384.0f)
+
+static P3Dint64    FloorDiv           (P3Dint64            Value,
+                                       P3Dint64            Divisor)
+ {
+  if (Value >= 0)
+   {
+    return(Value / Divisor);
+   }
+  else
+   {
+    return(-((-Value + Divisor - 1) / Divisor));
+   }
+ }
+
+static P3Dint64    ToFixed            (float               Value)
+ {
+  if      (Value < -NGP_SOFT_MAX_COORD)
+   {
+    Value = -NGP_SOFT_MAX_COORD;
+   }
+  else if (Value > NGP_SOFT_MAX_COORD)
+   {
+    Value = NGP_SOFT_MAX_COORD;
+   }
+
+  return((P3Dint64)floorf(Value * NGP_SOFT_SUBPIXEL_ONE + 0.5f));
+ }
+
+static unsigned char
+                   ToByte             (float               Value)
+ {
+  if      (Value <= 0.0f)
+   {
+    return(0);
+   }
+  else if (Value >= 1.0f)
+   {
+    return(255);
+   }
+  else
+   {
+    return((unsigned char)(Value * 255.0f + 0.5f));
+   }
+ }
+
+static void        SampleTexture      (float              *Texel,
+                                       const P3DImageData *Texture,
+                                       float               U,
+                                       float               V)
+ {
+  const unsigned char                 *Data;
+  unsigned int                         TexWidth;
+  unsigned int                         TexHeight;
+  unsigned int                         ChannelCount;
+  float                                S,T;
+  float                                FracS,FracT;
+  int                                  S0,T0,S1,T1;
+
+  Data         = (const unsigned char*)Texture->GetConstData();
+  TexWidth     = Texture->GetWidth();
+  TexHeight    = Texture->GetHeight();
+  ChannelCount = Texture->GetChannelCount();
+
+  S = U * TexWidth  - 0.5f;
+  T = V * TexHeight - 0.5f;
+
+  S0 = (int)floorf(S);
+  T0 = (int)floorf(T);
+
+  FracS = S - S0;
+  FracT = T - T0;
+
+  /* GL_REPEAT wrapping */
+  S0 %= (int)TexWidth;
+  T0 %= (int)TexHeight;
+
+  if (S0 < 0)
+   {
+    S0 += TexWidth;
+   }
+
+  if (T0 < 0)
+   {
+    T0 += TexHeight;
+   }
+
+  S1 = S0 + 1 < (int)TexWidth  ? S0 + 1 : 0;
+  T1 = T0 + 1 < (int)TexHeight ? T0 + 1 : 0;
+
+  const unsigned char *P00 = &Data[(T0 * TexWidth + S0) * ChannelCount];
+  const unsigned char *P10 = &Data[(T0 * TexWidth + S1) * ChannelCount];
+  const unsigned char *P01 = &Data[(T1 * TexWidth + S0) * ChannelCount];
+  const unsigned char *P11 = &Data[(T1 * TexWidth + S1) * ChannelCount];
+
+  float W00 = (1.0f - FracS) * (1.0f - FracT);
+  float W10 = FracS * (1.0f - FracT);
+  float W01 = (1.0f - FracS) * FracT;
+  float W11 = FracS * FracT;
+
+  for (unsigned int Channel = 0; Channel < ChannelCount; Channel++)
+   {
+    Texel[Channel] = (W00 * P00[Channel] + W10 * P10[Channel] +
+                      W01 * P01[Channel] + W11 * P11[Channel]) * (1.0f / 255.0f);
+   }
+
+  if (ChannelCount < 4)
+   {
+    Texel[3] = 1.0f;
+   }
+ }
+
+                   NGPSoftRasterizer::NGPSoftRasterizer
+                                      (unsigned int        ThreadCount)
+ {
+  this->ThreadCount = ThreadCount > 0 ? ThreadCount : 1;
+
+  Width       = 0;
+  Height      = 0;
+  TileCountX  = 0;
+  TileCountY  = 0;
+  ColorBuffer = 0;
+  DepthBuffer = 0;
+  NextTile    = 0;
+
+  for (unsigned int Index = 0; Index < 16; Index++)
+   {
+    Matrix[Index] = (Index % 5) == 0 ? 1.0f : 0.0f;
+   }
+
+  State.Color[0]  = State.Color[1] = State.Color[2] = 1.0f;
+  State.Texture   = 0;
+  State.AlphaTest = false;
+  StateChanged    = true;
+  CullFace        = false;
+ }
+
+                   NGPSoftRasterizer::~NGPSoftRasterizer
+                                      ()
+ {
+  delete[] DepthBuffer;
+  delete[] ColorBuffer;
+ }
+
+bool               NGPSoftRasterizer::Create
+                                      (unsigned int        Width,
+                                       unsigned int        Height)
+ {
+  if ((ColorBuffer != 0) && (this->Width == Width) && (this->Height == Height))
+   {
+    return(true);
+   }
+
+  delete[] DepthBuffer;
+  delete[] ColorBuffer;
+
+  ColorBuffer = new(std::nothrow) unsigned char[Width * Height * 4];
+  DepthBuffer = new(std::nothrow) float[Width * Height];
+
+  if ((ColorBuffer == 0) || (DepthBuffer == 0))
+   {
+    delete[] DepthBuffer;
+    delete[] ColorBuffer;
+
+    ColorBuffer = 0;
+    DepthBuffer = 0;
+
+    return(false);
+   }
+
+  this->Width  = Width;
+  this->Height = Height;
+
+  TileCountX = (Width  + NGP_SOFT_TILE_SIZE - 1) / NGP_SOFT_TILE_SIZE;
+  TileCountY = (Height + NGP_SOFT_TILE_SIZE - 1) / NGP_SOFT_TILE_SIZE;
+
+  Bins.clear();
+  Bins.resize(TileCountX * TileCountY);
+
+  return(true);
+ }
+
+void               NGPSoftRasterizer::Clear
+                                      (float               R,
+                                       float               G,
+                                       float               B,
+                                       float               A)
+ {
+  unsigned char                        Color[4];
+  unsigned int                         PixelCount;
+
+  Color[0] = ToByte(R);
+  Color[1] = ToByte(G);
+  Color[2] = ToByte(B);
+  Color[3] = ToByte(A);
+
+  PixelCount = Width * Height;
+
+  for (unsigned int PixelIndex = 0; PixelIndex < PixelCount; PixelIndex++)
+   {
+    memcpy(&ColorBuffer[PixelIndex * 4],Color,4);
+
+    DepthBuffer[PixelIndex] = 1.0f;
+   }
+ }
+
+void               NGPSoftRasterizer::SetMatrix
+                                      (const float        *Matrix)
+ {
+  memcpy(this->Matrix,Matrix,sizeof(this->Matrix));
+ }
+
+void               NGPSoftRasterizer::SetColor
+                                      (float               R,
+                                       float               G,
+                                       float               B)
+ {
+  State.Color[0] = R;
+  State.Color[1] = G;
+  State.Color[2] = B;
+
+  StateChanged = true;
+ }
+
+void               NGPSoftRasterizer::SetTexture
+                                      (const P3DImageData *Texture)
+ {
+  State.Texture = Texture;
+
+  StateChanged = true;
+ }
+
+void               NGPSoftRasterizer::SetCullFace
+                                      (bool                Enable)
+ {
+  CullFace = Enable;
+ }
+
+void               NGPSoftRasterizer::SetAlphaTest
+                                      (bool                Enable)
+ {
+  State.AlphaTest = Enable;
+
+  StateChanged = true;
+ }
+
+void               NGPSoftRasterizer::SetupTriangle
+                                      (const float        *Pos0,
+                                       const float        *Pos1,
+                                       const float        *Pos2,
+                                       const float        *TexCoord0,
+                                       const float        *TexCoord1,
+                                       const float        *TexCoord2)
+ {
+  const float                         *Pos[3];
+  const float                         *TexCoord[3];
+  NGPSoftTriangle                      Triangle;
+  P3Dint64                             MinX,MinY,MaxX,MaxY;
+
+  Pos[0] = Pos0; Pos[1] = Pos1; Pos[2] = Pos2;
+  TexCoord[0] = TexCoord0; TexCoord[1] = TexCoord1; TexCoord[2] = TexCoord2;
+
+  for (unsigned int Index = 0; Index < 3; Index++)
+   {
+    const float   *P = Pos[Index];
+    float          ClipX,ClipY,ClipZ,ClipW;
+
+    ClipX = Matrix[0] * P[0] + Matrix[4] * P[1] + Matrix[8]  * P[2] + Matrix[12];
+    ClipY = Matrix[1] * P[0] + Matrix[5] * P[1] + Matrix[9]  * P[2] + Matrix[13];
+    ClipZ = Matrix[2] * P[0] + Matrix[6] * P[1] + Matrix[10] * P[2] + Matrix[14];
+    ClipW = Matrix[3] * P[0] + Matrix[7] * P[1] + Matrix[11] * P[2] + Matrix[15];
+
+    /* no near plane clipping - triangles crossing w = 0 are dropped */
+    if (ClipW <= 0.0f)
+     {
+      return;
+     }
+
+    float InvW = 1.0f / ClipW;
+
+    Triangle.X[Index]    = ToFixed((ClipX * InvW + 1.0f) * 0.5f * Width);
+    Triangle.Y[Index]    = ToFixed((ClipY * InvW + 1.0f) * 0.5f * Height);
+    Triangle.Z[Index]    = (ClipZ * InvW + 1.0f) * 0.5f;
+    Triangle.InvW[Index] = InvW;
+
+    if (TexCoord[Index] != 0)
+     {
+      Triangle.U[Index] = TexCoord[Index][0] * InvW;
+      Triangle.V[Index] = TexCoord[Index][1] * InvW;
+     }
+    else
+     {
+      Triangle.U[Index] = Triangle.V[Index] = 0.0f;
+     }
+   }
+
+  Triangle.Area = (Triangle.X[1] - Triangle.X[0]) * (Triangle.Y[2] - Triangle.Y[0]) -
+                  (Triangle.Y[1] - Triangle.Y[0]) * (Triangle.X[2] - Triangle.X[0]);
+
+  if (Triangle.Area == 0)
+   {
+    return;
+   }
+
+  /* counter-clockwise triangles are front-facing */
+  if (Triangle.Area < 0)
+   {
+    if (CullFace)
+     {
+      return;
+     }
+
+    std::swap(Triangle.X[1],Triangle.X[2]);
+    std::swap(Triangle.Y[1],Triangle.Y[2]);
+    std::swap(Triangle.Z[1],Triangle.Z[2]);
+    std::swap(Triangle.InvW[1],Triangle.InvW[2]);
+    std::swap(Triangle.U[1],Triangle.U[2]);
+    std::swap(Triangle.V[1],Triangle.V[2]);
+
+    Triangle.Area = -Triangle.Area;
+   }
+
+  Triangle.InvArea = 1.0f / (float)Triangle.Area;
+
+  MinX = MaxX = Triangle.X[0];
+  MinY = MaxY = Triangle.Y[0];
+
+  for (unsigned int Index = 1; Index < 3; Index++)
+   {
+    if (Triangle.X[Index] < MinX) MinX = Triangle.X[Index];
+    if (Triangle.X[Index] > MaxX) MaxX = Triangle.X[Index];
+    if (Triangle.Y[Index] < MinY) MinY = Triangle.Y[Index];
+    if (Triangle.Y[Index] > MaxY) MaxY = Triangle.Y[Index];
+   }
+
+  /* pixels whose centers may be covered */
+  MinX = FloorDiv(MinX - NGP_SOFT_SUBPIXEL_HALF,NGP_SOFT_SUBPIXEL_ONE);
+  MinY = FloorDiv(MinY - NGP_SOFT_SUBPIXEL_HALF,NGP_SOFT_SUBPIXEL_ONE);
+  MaxX = FloorDiv(MaxX - NGP_SOFT_SUBPIXEL_HALF,NGP_SOFT_SUBPIXEL_ONE) + 1;
+  MaxY = FloorDiv(MaxY - NGP_SOFT_SUBPIXEL_HALF,NGP_SOFT_SUBPIXEL_ONE) + 1;
+
+  if (MinX < 0) MinX = 0;
+  if (MinY < 0) MinY = 0;
+  if (MaxX > (P3Dint64)Width  - 1) MaxX = (P3Dint64)Width  - 1;
+  if (MaxY > (P3Dint64)Height - 1) MaxY = (P3Dint64)Height - 1;
+
+  if ((MinX > MaxX) || (MinY > MaxY))
+   {
+    return;
+   }
+
+  Triangle.MinX = (int)MinX;
+  Triangle.MinY = (int)MinY;
+  Triangle.MaxX = (int)MaxX;
+  Triangle.MaxY = (int)MaxY;
+
+  if (StateChanged)
+   {
+    States.push_back(State);
+
+    StateChanged = false;
+   }
+
+  Triangle.StateIndex = States.size() - 1;
+
+  unsigned int     TriangleIndex = Triangles.size();
+
+  Triangles.push_back(Triangle);
+
+  for (int TileY  = Triangle.MinY / NGP_SOFT_TILE_SIZE;
+           TileY <= Triangle.MaxY / NGP_SOFT_TILE_SIZE;
+           TileY++)
+   {
+    for (int TileX  = Triangle.MinX / NGP_SOFT_TILE_SIZE;
+             TileX <= Triangle.MaxX / NGP_SOFT_TILE_SIZE;
+             TileX++)
+     {
+      Bins[TileY * TileCountX + TileX].push_back(TriangleIndex);
+     }
+   }
+ }
+
+void               NGPSoftRasterizer::DrawTriangles
+                                      (const float        *PosBuffer,
+                                       const float        *TexCoordBuffer,
+                                       const unsigned int *IndexBuffer,
+                                       unsigned int        IndexCount)
+ {
+  for (unsigned int Index = 0; Index + 2 < IndexCount; Index += 3)
+   {
+    unsigned int I0 = IndexBuffer[Index];
+    unsigned int I1 = IndexBuffer[Index + 1];
+    unsigned int I2 = IndexBuffer[Index + 2];
+
+    SetupTriangle(&PosBuffer[I0 * 3],
+                  &PosBuffer[I1 * 3],
+                  &PosBuffer[I2 * 3],
+                  TexCoordBuffer != 0 ? &TexCoordBuffer[I0 * 2] : 0,
+                  TexCoordBuffer != 0 ? &TexCoordBuffer[I1 * 2] : 0,
+                  TexCoordBuffer != 0 ? &TexCoordBuffer[I2 * 2] : 0);
+   }
+ }
+
+void               NGPSoftRasterizer::RasterizeTile
+                                      (unsigned int        TileIndex)
+ {
+  const std::vector<unsigned int>     &Bin = Bins[TileIndex];
+  int                                  TileMinX;
+  int                                  TileMinY;
+
+  TileMinX = (TileIndex % TileCountX) * NGP_SOFT_TILE_SIZE;
+  TileMinY = (TileIndex / TileCountX) * NGP_SOFT_TILE_SIZE;
+
+  for (unsigned int BinIndex = 0; BinIndex < Bin.size(); BinIndex++)
+   {
+    const NGPSoftTriangle             &Triangle = Triangles[Bin[BinIndex]];
+    const NGPSoftDrawState            &DrawState = States[Triangle.StateIndex];
+    int                                MinX,MinY,MaxX,MaxY;
+    P3Dint64                           StepX[3];
+    P3Dint64                           StepY[3];
+    P3Dint64                           RowEdge[3];
+    P3Dint64                           Bias[3];
+
+    MinX = Triangle.MinX > TileMinX ? Triangle.MinX : TileMinX;
+    MinY = Triangle.MinY > TileMinY ? Triangle.MinY : TileMinY;
+    MaxX = Triangle.MaxX < TileMinX + NGP_SOFT_TILE_SIZE - 1 ?
+            Triangle.MaxX : TileMinX + NGP_SOFT_TILE_SIZE - 1;
+    MaxY = Triangle.MaxY < TileMinY + NGP_SOFT_TILE_SIZE - 1 ?
+            Triangle.MaxY : TileMinY + NGP_SOFT_TILE_SIZE - 1;
+
+    /* edge I is opposite to vertex I, edge values are barycentric weights */
+    for (unsigned int Edge = 0; Edge < 3; Edge++)
+     {
+      unsigned int A = (Edge + 1) % 3;
+      unsigned int B = (Edge + 2) % 3;
+      P3Dint64     DX = Triangle.X[B] - Triangle.X[A];
+      P3Dint64     DY = Triangle.Y[B] - Triangle.Y[A];
+      P3Dint64     PX = (P3Dint64)MinX * NGP_SOFT_SUBPIXEL_ONE + NGP_SOFT_SUBPIXEL_HALF;
+      P3Dint64     PY = (P3Dint64)MinY * NGP_SOFT_SUBPIXEL_ONE + NGP_SOFT_SUBPIXEL_HALF;
+
+      StepX[Edge]   = -DY * NGP_SOFT_SUBPIXEL_ONE;
+      StepY[Edge]   =  DX * NGP_SOFT_SUBPIXEL_ONE;
+      RowEdge[Edge] =  DX * (PY - Triangle.Y[A]) - DY * (PX - Triangle.X[A]);
+
+      /* top-left fill rule */
+      Bias[Edge] = ((DY < 0) || ((DY == 0) && (DX < 0))) ? 0 : -1;
+     }
+
+    for (int Y = MinY; Y <= MaxY; Y++)
+     {
+      P3Dint64     E0 = RowEdge[0];
+      P3Dint64     E1 = RowEdge[1];
+      P3Dint64     E2 = RowEdge[2];
+      unsigned int PixelIndex = Y * Width + MinX;
+
+      for (int X = MinX; X <= MaxX; X++, PixelIndex++)
+       {
+        if (((E0 + Bias[0]) | (E1 + Bias[1]) | (E2 + Bias[2])) >= 0)
+         {
+          float    L0 = (float)E0 * Triangle.InvArea;
+          float    L1 = (float)E1 * Triangle.InvArea;
+          float    L2 = (float)E2 * Triangle.InvArea;
+          float    Z;
+
+          Z = L0 * Triangle.Z[0] + L1 * Triangle.Z[1] + L2 * Triangle.Z[2];
+
+          if ((Z >= 0.0f) && (Z <= 1.0f) && (Z < DepthBuffer[PixelIndex]))
+           {
+            float  Color[4];
+
+            Color[0] = DrawState.Color[0];
+            Color[1] = DrawState.Color[1];
+            Color[2] = DrawState.Color[2];
+            Color[3] = 1.0f;
+
+            if (DrawState.Texture != 0)
+             {
+              float Texel[4];
+              float Q;
+
+              Q = L0 * Triangle.InvW[0] + L1 * Triangle.InvW[1] + L2 * Triangle.InvW[2];
+
+              SampleTexture(Texel,
+                            DrawState.Texture,
+                            (L0 * Triangle.U[0] + L1 * Triangle.U[1] + L2 * Triangle.U[2]) / Q,
+                            (L0 * Triangle.V[0] + L1 * Triangle.V[1] + L2 * Triangle.V[2]) / Q);
+
+              Color[0] *= Texel[0];
+              Color[1] *= Texel[1];
+              Color[2] *= Texel[2];
+              Color[3]  = Texel[3];
+             }
+
+            if ((!DrawState.AlphaTest) || (Color[3] > 0.5f))
+             {
+              unsigned char *Pixel = &ColorBuffer[PixelIndex * 4];
+
+              Pixel[0] = ToByte(Color[0]);
+              Pixel[1] = ToByte(Color[1]);
+              Pixel[2] = ToByte(Color[2]);
+              Pixel[3] = ToByte(Color[3]);
+
+              DepthBuffer[PixelIndex] = Z;
+             }
+           }
+         }
+
+        E0 += StepX[0];
+        E1 += StepX[1];
+        E2 += StepX[2];
+       }
+
+      RowEdge[0] += StepY[0];
+      RowEdge[1] += StepY[1];
+      RowEdge[2] += StepY[2];
+     }
+   }
+ }
+
+void               NGPSoftRasterizer::WorkerProc
+                                      (void               *Arg)
+ {
+  NGPSoftRasterizer                   *Rasterizer;
+  unsigned int                         TileCount;
+  unsigned int                         TileIndex;
+
+  Rasterizer = (NGPSoftRasterizer*)Arg;
+  TileCount  = Rasterizer->TileCountX * Rasterizer->TileCountY;
+
+  while (true)
+   {
+    Rasterizer->TileLock.Lock();
+
+    TileIndex = Rasterizer->NextTile++;
+
+    Rasterizer->TileLock.Unlock();
+
+    if (TileIndex >= TileCount)
+     {
+      break;
+     }
+
+    Rasterizer->RasterizeTile(TileIndex);
+   }
+ }
+
+void               NGPSoftRasterizer::Finish
+                                      ()
+ {
+  std::vector<P3DThread*>              Threads;
+  unsigned int                         TileCount;
+  unsigned int                         WorkerCount;
+
+  TileCount   = TileCountX * TileCountY;
+  WorkerCount = ThreadCount < TileCount ? ThreadCount : TileCount;
+  NextTile    = 0;
+
+  /* calling thread is a worker too */
+  for (unsigned int Index = 1; Index < WorkerCount; Index++)
+   {
+    P3DThread     *Thread = new P3DThread();
+
+    if (Thread->Start(WorkerProc,this))
+     {
+      Threads.push_back(Thread);
+     }
+    else
+     {
+      delete Thread;
+     }
+   }
+
+  WorkerProc(this);
+
+  for (unsigned int Index = 0; Index < Threads.size(); Index++)
+   {
+    Threads[Index]->Join();
+
+    delete Threads[Index];
+   }
+
+  for (unsigned int Index = 0; Index < TileCount; Index++)
+   {
+    Bins[Index].clear();
+   }
+
+  Triangles.clear();
+  States.clear();
+
+  StateChanged = true;
+ }
+
+bool               NGPSoftRasterizer::GetImage
+                                      (P3DImageData       *Image,
+                                       bool                HasAlpha) const
+ {
+  unsigned int                         ChannelCount;
+  unsigned char                       *Target;
+
+  ChannelCount = HasAlpha ? 4 : 3;
+
+  if (!Image->Create(Width,Height,ChannelCount,P3D_BYTE))
+   {
+    return(false);
+   }
+
+  Target = (unsigned char*)Image->GetData();
+
+  for (unsigned int Y = 0; Y < Height; Y++)
+   {
+    const unsigned char *Source = &ColorBuffer[(Height - 1 - Y) * Width * 4];
+
+    for (unsigned int X = 0; X < Width; X++)
+     {
+      memcpy(Target,Source,ChannelCount);
+
+      Target += ChannelCount;
+      Source += 4;
+     }
+   }
+
+  return(true);
+ }
+
@@ -0,0 +1,140 @@
+/***************************************************************************
+
+ Copyright (C) 2006  Sergey Prokhorchuk
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***************************************************************************/
+
+
+#ifndef __NGPSOFTRAST_H__
+#define __NGPSOFTRAST_H__
+
+#include <vector>
+
+#include <ngpcore/p3dtypes.h>
+
+#include <ngput/p3dimage.h>
+#include <ngput/p3dthread.h>
+
+#define NGP_SOFT_TILE_SIZE       (64)
+#define NGP_SOFT_SUBPIXEL_BITS   (8)
+
+typedef struct
+ {
+  float            Color[3];
+  const P3DImageData
+                  *Texture;
+  bool             AlphaTest;
+ } NGPSoftDrawState;
+
+typedef struct
+ {
+  P3Dint64         X[3];  /* window coords, NGP_SOFT_SUBPIXEL_BITS fraction */
+  P3Dint64         Y[3];
+  P3Dint64         Area;  /* doubled area, always > 0 */
+  float            InvArea;
+  float            Z[3];
+  float            InvW[3];
+  float            U[3];  /* divided by w */
+  float            V[3];
+  int              MinX,MinY,MaxX,MaxY;
+  unsigned int     StateIndex;
+ } NGPSoftTriangle;
+
+/* Tile-based multithreaded rasterizer which mimics ngpshot fixed-function */
+/* OpenGL setup: unlit, color modulated by diffuse texture (bilinear,      */
+/* repeat), alpha test, back-face culling and depth test.                  */
+/* Triangles are binned into tiles by Draw* calls and rasterized by Finish */
+class NGPSoftRasterizer
+ {
+  public           :
+
+                   NGPSoftRasterizer  (unsigned int        ThreadCount);
+                  ~NGPSoftRasterizer  ();
+
+  bool             Create             (unsigned int        Width,
+                                       unsigned int        Height);
+
+  void             Clear              (float               R,
+                                       float               G,
+                                       float               B,
+                                       float               A);
+
+  /* column-major projection * modelview matrix */
+  void             SetMatrix          (const float        *Matrix);
+  void             SetColor           (float               R,
+                                       float               G,
+                                       float               B);
+  /* 3 or 4 channel P3D_BYTE image, must be valid until Finish() */
+  void             SetTexture         (const P3DImageData *Texture);
+  void             SetCullFace        (bool                Enable);
+  void             SetAlphaTest       (bool                Enable);
+
+  void             DrawTriangles      (const float        *PosBuffer,
+                                       const float        *TexCoordBuffer,
+                                       const unsigned int *IndexBuffer,
+                                       unsigned int        IndexCount);
+
+  void             Finish             ();
+
+  /* image rows are stored from top to bottom */
+  bool             GetImage           (P3DImageData       *Image,
+                                       bool                HasAlpha) const;
+
+  private          :
+
+                   NGPSoftRasterizer  (const NGPSoftRasterizer
+                                                          &);
+  NGPSoftRasterizer
+                  &operator =         (const NGPSoftRasterizer
+                                                          &);
+
+  void             SetupTriangle      (const float        *Pos0,
+                                       const float        *Pos1,
+                                       const float        *Pos2,
+                                       const float        *TexCoord0,
+                                       const float        *TexCoord1,
+                                       const float        *TexCoord2);
+
+  void             RasterizeTile      (unsigned int        TileIndex);
+
+  static void      WorkerProc         (void               *Arg);
+
+  unsigned int                         ThreadCount;
+  unsigned int                         Width;
+  unsigned int                         Height;
+  unsigned int                         TileCountX;
+  unsigned int                         TileCountY;
+
+  unsigned char                       *ColorBuffer;
+  float                               *DepthBuffer;
+
+  float                                Matrix[16];
+  NGPSoftDrawState                     State;
+  bool                                 StateChanged;
+  bool                                 CullFace;
+
+  std::vector<NGPSoftDrawState>        States;
+  std::vector<NGPSoftTriangle>         Triangles;
+  std::vector<std::vector<unsigned int> >
+                                       Bins;
+
+  unsigned int                         NextTile;
+  P3DMutex                             TileLock;
+ };
+
+#endif
+
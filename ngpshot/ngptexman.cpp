@@ -19,7 +19,9 @@
 ***************************************************************************/
 
 #include <string>
+#include <vector>
 #include <map>
+#include <algorithm>
 
 #include <ngpcore/p3dmodel.h>
 
@@ -71,90 +73,265 @@
       glDeleteTextures(1,&Handle);
      }
    }
+
+  for (std::map<std::string,P3DImageData*>::iterator Iter = Images.begin();
+       Iter != Images.end();
+       ++Iter)
+   {
+    delete Iter->second;
+   }
+ }
+
+void               NGPTexManager::SetModelPath
+                                      (const char         *ModelPath)
+ {
+  this->ModelPath = P3DPathName::JoinPaths(ModelPath,P3D_LOCAL_TEXTURES_PATH);
  }
 
-bool               NGPTexManager::TryLoadTexture
-                                      (P3DImageData       *ImageData,
-                                       const std::string  &Path,
-                                       const std::string  &Name) const
+GLuint             NGPTexManager::FindOrLoadTexture
+                                      (const std::string  &FileName)
  {
-  std::string FullPathStr = Path + "/" + Name;
+  std::map<std::string,GLuint>::iterator Iter = Handles.find(FileName);
+
+  if (Iter != Handles.end())
+   {
+    return(Iter->second);
+   }
+  else
+   {
+    P3DTexImage                        Image;
+    GLuint                             Handle;
+
+    if (!Image.Load(&ImageFmtHandler,FileName.c_str(),P3DTexImage::GetGLMaxSize()))
+     {
+      return(0);
+     }
 
-  P3DPathName FullPathName(FullPathStr.c_str());
+    Handle = Image.CreateGLTexture();
 
-  std::string Ext = FullPathName.GetExtension();
+    if (Handle != 0)
+     {
+      Handles[FileName] = Handle;
+     }
 
-  return ImageFmtHandler.LoadImageData
-          (ImageData,FullPathName.c_str(),Ext.c_str());
+    return(Handle);
+   }
  }
 
 GLuint             NGPTexManager::LoadTexture
                                       (const char         *TexName)
  {
-  std::map<std::string,GLuint>::iterator Iter = Handles.find(TexName);
+  std::string      CacheKey = ModelPath + '\n' + TexName;
 
-  if (Iter != Handles.end())
+  std::map<std::string,GLuint>::iterator Iter = NameCache.find(CacheKey);
+
+  if (Iter != NameCache.end())
    {
     return(Iter->second);
    }
   else
    {
-    P3DImageData                       ImageData;
     std::string                        TexNameStr(TexName);
     GLuint                             Handle;
 
-    if      (TryLoadTexture(&ImageData,ModelPath,TexNameStr))
-     {
-     }
-    else if (TryLoadTexture(&ImageData,TexPath,TexNameStr))
+    Handle = FindOrLoadTexture(ModelPath + "/" + TexNameStr);
+
+    if (Handle == 0)
      {
+      Handle = FindOrLoadTexture(TexPath + "/" + TexNameStr);
      }
-    else
+
+    /* failed lookups are cached too to avoid probing files again */
+    NameCache[CacheKey] = Handle;
+
+    return(Handle);
+   }
+ }
+
+const P3DImageData
+                  *NGPTexManager::FindOrLoadImage
+                                      (const std::string  &FileName)
+ {
+  std::map<std::string,P3DImageData*>::iterator Iter = Images.find(FileName);
+
+  if (Iter != Images.end())
+   {
+    return(Iter->second);
+   }
+  else
+   {
+    P3DTexImage                        Image;
+    P3DImageData                      *ImageData;
+
+    if (!Image.Load(&ImageFmtHandler,FileName.c_str(),0))
      {
       return(0);
      }
 
-    glGenTextures(1,&Handle);
+    ImageData = Image.DetachSourceImage();
+
+    Images[FileName] = ImageData;
+
+    return(ImageData);
+   }
+ }
+
+const P3DImageData
+                  *NGPTexManager::LoadImage
+                                      (const char         *TexName)
+ {
+  std::string      CacheKey = ModelPath + '\n' + TexName;
+
+  std::map<std::string,const P3DImageData*>::iterator Iter = ImageNameCache.find(CacheKey);
+
+  if (Iter != ImageNameCache.end())
+   {
+    return(Iter->second);
+   }
+  else
+   {
+    std::string                        TexNameStr(TexName);
+    const P3DImageData                *ImageData;
 
-    glBindTexture(GL_TEXTURE_2D,Handle);
-    glPixelStorei(GL_UNPACK_ALIGNMENT,1);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+    ImageData = FindOrLoadImage(ModelPath + "/" + TexNameStr);
 
-    if      (ImageData.GetChannelCount() == 3)
+    if (ImageData == 0)
      {
-      gluBuild2DMipmaps(GL_TEXTURE_2D,
-                        3,
-                        ImageData.GetWidth(),
-                        ImageData.GetHeight(),
-                        GL_RGB,
-                        GL_UNSIGNED_BYTE,
-                        ImageData.GetData());
+      ImageData = FindOrLoadImage(TexPath + "/" + TexNameStr);
      }
-    else if (ImageData.GetChannelCount() == 4)
+
+    ImageNameCache[CacheKey] = ImageData;
+
+    return(ImageData);
+   }
+ }
+
+void               NGPTexManager::PreloadTextures
+                                      (const std::vector<std::string>
+                                                          &TexNames,
+                                       unsigned int        ThreadCount)
+ {
+  P3DTexPrepQueue                      Queue(&ImageFmtHandler);
+  std::vector<std::string>             CacheKeys;
+
+  for (unsigned int Index = 0; Index < TexNames.size(); Index++)
+   {
+    std::string    CacheKey = ModelPath + '\n' + TexNames[Index];
+    std::string    FileName = ModelPath + "/" + TexNames[Index];
+
+    if ((NameCache.find(CacheKey) == NameCache.end()) &&
+        (std::find(CacheKeys.begin(),CacheKeys.end(),CacheKey) == CacheKeys.end()))
      {
-      gluBuild2DMipmaps(GL_TEXTURE_2D,
-                        4,
-                        ImageData.GetWidth(),
-                        ImageData.GetHeight(),
-                        GL_RGBA,
-                        GL_UNSIGNED_BYTE,
-                        ImageData.GetData());
+      std::map<std::string,GLuint>::iterator Iter = Handles.find(FileName);
+
+      if (Iter != Handles.end())
+       {
+        NameCache[CacheKey] = Iter->second;
+       }
+      else
+       {
+        Queue.Add(FileName.c_str(),(TexPath + "/" + TexNames[Index]).c_str());
+
+        CacheKeys.push_back(CacheKey);
+       }
      }
-    else
+   }
+
+  if (Queue.GetCount() == 0)
+   {
+    return;
+   }
+
+  Queue.Run(ThreadCount,P3DTexImage::GetGLMaxSize());
+
+  for (unsigned int Index = 0; Index < Queue.GetCount(); Index++)
+   {
+    const char    *FileName = Queue.GetFileName(Index);
+    GLuint         Handle   = 0;
+
+    if (FileName != 0)
      {
-      glDeleteTextures(1,&Handle);
+      std::map<std::string,GLuint>::iterator Iter = Handles.find(FileName);
+
+      if (Iter != Handles.end())
+       {
+        Handle = Iter->second;
+       }
+      else
+       {
+        Handle = Queue.GetImage(Index)->CreateGLTexture();
+
+        if (Handle != 0)
+         {
+          Handles[FileName] = Handle;
+         }
+       }
+     }
 
-      return(0);
+    NameCache[CacheKeys[Index]] = Handle;
+   }
+ }
+
+void               NGPTexManager::PreloadImages
+                                      (const std::vector<std::string>
+                                                          &TexNames,
+                                       unsigned int        ThreadCount)
+ {
+  P3DTexPrepQueue                      Queue(&ImageFmtHandler);
+  std::vector<std::string>             CacheKeys;
+
+  for (unsigned int Index = 0; Index < TexNames.size(); Index++)
+   {
+    std::string    CacheKey = ModelPath + '\n' + TexNames[Index];
+    std::string    FileName = ModelPath + "/" + TexNames[Index];
+
+    if ((ImageNameCache.find(CacheKey) == ImageNameCache.end()) &&
+        (std::find(CacheKeys.begin(),CacheKeys.end(),CacheKey) == CacheKeys.end()))
+     {
+      std::map<std::string,P3DImageData*>::iterator Iter = Images.find(FileName);
+
+      if (Iter != Images.end())
+       {
+        ImageNameCache[CacheKey] = Iter->second;
+       }
+      else
+       {
+        Queue.Add(FileName.c_str(),(TexPath + "/" + TexNames[Index]).c_str());
+
+        CacheKeys.push_back(CacheKey);
+       }
      }
+   }
+
+  if (Queue.GetCount() == 0)
+   {
+    return;
+   }
 
-    glBindTexture(GL_TEXTURE_2D,0);
+  Queue.Run(ThreadCount,0);
 
-    Handles[TexName] = Handle;
+  for (unsigned int Index = 0; Index < Queue.GetCount(); Index++)
+   {
+    const char         *FileName  = Queue.GetFileName(Index);
+    const P3DImageData *ImageData = 0;
 
-    return(Handle);
+    if (FileName != 0)
+     {
+      std::map<std::string,P3DImageData*>::iterator Iter = Images.find(FileName);
+
+      if (Iter != Images.end())
+       {
+        ImageData = Iter->second;
+       }
+      else
+       {
+        Images[FileName] = Queue.GetImage(Index)->DetachSourceImage();
+
+        ImageData = Images[FileName];
+       }
+     }
+
+    ImageNameCache[CacheKeys[Index]] = ImageData;
    }
  }
 
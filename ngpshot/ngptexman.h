@@ -22,10 +22,12 @@
 #define __NGPVIEWTEXMAN_H__
 
 #include <string>
+#include <vector>
 #include <map>
 
 #include <ngput/p3dglext.h>
 #include <ngput/p3dimage.h>
+#include <ngput/p3dtexprep.h>
 
 class NGPTexManager
  {
@@ -36,14 +38,35 @@ class NGPTexManager
                   ~NGPTexManager      ();
 
   GLuint           LoadTexture        (const char         *TexName);
+  /* CPU-side image for software rendering, no GL calls are made */
+  const P3DImageData
+                  *LoadImage          (const char         *TexName);
+
+  /* decode textures on ThreadCount threads, so that following   */
+  /* LoadTexture/LoadImage calls for the same names return at once */
+  void             PreloadTextures    (const std::vector<std::string>
+                                                          &TexNames,
+                                       unsigned int        ThreadCount);
+  void             PreloadImages      (const std::vector<std::string>
+                                                          &TexNames,
+                                       unsigned int        ThreadCount);
+
+  /* switch to another model directory, loaded textures are kept */
+  void             SetModelPath       (const char         *ModelPath);
 
   private          :
 
-  bool             TryLoadTexture     (P3DImageData       *ImageData,
-                                       const std::string  &Path,
-                                       const std::string  &Name) const;
+  GLuint           FindOrLoadTexture  (const std::string  &FileName);
+  const P3DImageData
+                  *FindOrLoadImage    (const std::string  &FileName);
 
+  /* handles by full texture file name */
   std::map<std::string,GLuint>         Handles;
+  /* handles by (model path, texture name) pair */
+  std::map<std::string,GLuint>         NameCache;
+  std::map<std::string,P3DImageData*>  Images;
+  std::map<std::string,const P3DImageData*>
+                                       ImageNameCache;
   P3DImageFmtHandlerComposite          ImageFmtHandler;
   std::string                          ModelPath;
   std::string                          TexPath;
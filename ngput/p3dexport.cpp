@@ -0,0 +1,1801 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include <string>
+#include <vector>
+#include <new>
+
+#include <ngpcore/p3dcompat.h>
+#include <ngpcore/p3dexcept.h>
+#include <ngpcore/p3dhli.h>
+
+#include <ngput/p3dospath.h>
+#include <ngput/p3dgeomcache.h>
+#include <ngput/p3dexport.h>
+
+#define P3DExportWriteBufferSize (64 * 1024)
+#define P3DExportMaxNumberLength (64)
+#define P3DExportMaxLineLength   (256)
+#define P3DExportMaxUInt64Digits (20)
+#define P3DExportRoundingBias    (4503599627370496.0)
+
+/* Buffered sequential file writer. Blocks larger than internal buffer */
+/* are written directly.                                               */
+class P3DExportFileWriter
+ {
+  public           :
+
+                   P3DExportFileWriter()
+   {
+    File   = 0;
+    Buffer = 0;
+    Used   = 0;
+    Ok     = false;
+   }
+
+                  ~P3DExportFileWriter()
+   {
+    if (File != 0)
+     {
+      fclose(File);
+     }
+
+    free(Buffer);
+   }
+
+  bool             Open               (const char         *FileName)
+   {
+    Buffer = (char*)malloc(P3DExportWriteBufferSize);
+
+    if (Buffer == 0)
+     {
+      return(false);
+     }
+
+    File = fopen(FileName,"wb");
+    Ok   = File != 0;
+
+    /* data is already buffered here, so stdio buffer would only add */
+    /* its allocation and one more copy                               */
+    if (Ok)
+     {
+      setvbuf(File,0,_IONBF,0);
+     }
+
+    return(Ok);
+   }
+
+  bool             Close              ()
+   {
+    Flush();
+
+    if (File != 0)
+     {
+      if (fclose(File) != 0)
+       {
+        Ok = false;
+       }
+
+      File = 0;
+     }
+
+    return(Ok);
+   }
+
+  bool             IsOk               () const
+   {
+    return(Ok);
+   }
+
+  void             Write              (const void         *Data,
+                                       unsigned int        Size)
+   {
+    if (Used + Size > P3DExportWriteBufferSize)
+     {
+      Flush();
+
+      if (Size > P3DExportWriteBufferSize)
+       {
+        if (Ok)
+         {
+          Ok = fwrite(Data,1,Size,File) == Size;
+         }
+
+        return;
+       }
+     }
+
+    memcpy(&Buffer[Used],Data,Size);
+
+    Used += Size;
+   }
+
+  void             WriteString        (const char         *Str)
+   {
+    Write(Str,strlen(Str));
+   }
+
+  void             WriteChar          (char                Char)
+   {
+    if (Used == P3DExportWriteBufferSize)
+     {
+      Flush();
+     }
+
+    Buffer[Used++] = Char;
+   }
+
+  /* returns pointer to at least Size bytes of free buffer space */
+  char            *Reserve            (unsigned int        Size)
+   {
+    if (Used + Size > P3DExportWriteBufferSize)
+     {
+      Flush();
+     }
+
+    return(&Buffer[Used]);
+   }
+
+  void             Commit             (unsigned int        Size)
+   {
+    Used += Size;
+   }
+
+  private          :
+
+  void             Flush              ()
+   {
+    if ((Used > 0) && (Ok))
+     {
+      Ok = fwrite(Buffer,1,Used,File) == Used;
+     }
+
+    Used = 0;
+   }
+
+  FILE                                *File;
+  char                                *Buffer;
+  unsigned int                         Used;
+  bool                                 Ok;
+ };
+
+static const char P3DExportDigitPairs[] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+static const char P3DExportDigitTriples[] =
+  "000001002003004005006007008009010011012013014015016017018019"
+  "020021022023024025026027028029030031032033034035036037038039"
+  "040041042043044045046047048049050051052053054055056057058059"
+  "060061062063064065066067068069070071072073074075076077078079"
+  "080081082083084085086087088089090091092093094095096097098099"
+  "100101102103104105106107108109110111112113114115116117118119"
+  "120121122123124125126127128129130131132133134135136137138139"
+  "140141142143144145146147148149150151152153154155156157158159"
+  "160161162163164165166167168169170171172173174175176177178179"
+  "180181182183184185186187188189190191192193194195196197198199"
+  "200201202203204205206207208209210211212213214215216217218219"
+  "220221222223224225226227228229230231232233234235236237238239"
+  "240241242243244245246247248249250251252253254255256257258259"
+  "260261262263264265266267268269270271272273274275276277278279"
+  "280281282283284285286287288289290291292293294295296297298299"
+  "300301302303304305306307308309310311312313314315316317318319"
+  "320321322323324325326327328329330331332333334335336337338339"
+  "340341342343344345346347348349350351352353354355356357358359"
+  "360361362363364365366367368369370371372373374375376377378379"
+  "380381382383384385386387388389390391392393394395396397398399"
+  "400401402403404405406407408409410411412413414415416417418419"
+  "420421422423424425426427428429430431432433434435436437438439"
+  "440441442443444445446447448449450451452453454455456457458459"
+  "460461462463464465466467468469470471472473474475476477478479"
+  "480481482483484485486487488489490491492493494495496497498499"
+  "500501502503504505506507508509510511512513514515516517518519"
+  "520521522523524525526527528529530531532533534535536537538539"
+  "540541542543544545546547548549550551552553554555556557558559"
+  "560561562563564565566567568569570571572573574575576577578579"
+  "580581582583584585586587588589590591592593594595596597598599"
+  "600601602603604605606607608609610611612613614615616617618619"
+  "620621622623624625626627628629630631632633634635636637638639"
+  "640641642643644645646647648649650651652653654655656657658659"
+  "660661662663664665666667668669670671672673674675676677678679"
+  "680681682683684685686687688689690691692693694695696697698699"
+  "700701702703704705706707708709710711712713714715716717718719"
+  "720721722723724725726727728729730731732733734735736737738739"
+  "740741742743744745746747748749750751752753754755756757758759"
+  "760761762763764765766767768769770771772773774775776777778779"
+  "780781782783784785786787788789790791792793794795796797798799"
+  "800801802803804805806807808809810811812813814815816817818819"
+  "820821822823824825826827828829830831832833834835836837838839"
+  "840841842843844845846847848849850851852853854855856857858859"
+  "860861862863864865866867868869870871872873874875876877878879"
+  "880881882883884885886887888889890891892893894895896897898899"
+  "900901902903904905906907908909910911912913914915916917918919"
+  "920921922923924925926927928929930931932933934935936937938939"
+  "940941942943944945946947948949950951952953954955956957958959"
+  "960961962963964965966967968969970971972973974975976977978979"
+  "980981982983984985986987988989990991992993994995996997998999";
+
+static void        FormatDigitPair    (char               *Dest,
+                                       unsigned int        Value)
+ {
+  Dest[0] = P3DExportDigitPairs[Value * 2];
+  Dest[1] = P3DExportDigitPairs[Value * 2 + 1];
+ }
+
+/* digit count is found first, so digits can be produced in pairs from */
+/* the end directly into destination                                    */
+static unsigned int FormatUInt        (char               *Dest,
+                                       P3Duint64           Value)
+ {
+  unsigned int                         DigitCount;
+  P3Duint64                            Limit;
+  char                                *Ptr;
+
+  DigitCount = 1;
+  Limit      = 10;
+
+  while ((Value >= Limit) && (DigitCount < P3DExportMaxUInt64Digits))
+   {
+    DigitCount++;
+
+    Limit *= 10;
+   }
+
+  Ptr = &Dest[DigitCount];
+
+  while (Value >= 100)
+   {
+    Ptr -= 2;
+
+    FormatDigitPair(Ptr,(unsigned int)(Value % 100));
+
+    Value /= 100;
+   }
+
+  if (Value >= 10)
+   {
+    FormatDigitPair(Dest,(unsigned int)Value);
+   }
+  else
+   {
+    Dest[0] = (char)('0' + (unsigned int)Value);
+   }
+
+  return(DigitCount);
+ }
+
+/* snprintf's output depends on current LC_NUMERIC locale, so decimal */
+/* separator is fixed after formatting                                */
+static unsigned int FormatFloatPrintf (char               *Dest,
+                                       const char         *Format,
+                                       double              Value)
+ {
+  int                                  Length;
+
+  Length = snprintf(Dest,P3DExportMaxNumberLength,Format,Value);
+
+  if ((Length < 0) || (Length >= P3DExportMaxNumberLength))
+   {
+    Dest[0] = '0';
+
+    return(1);
+   }
+
+  for (int Index = 0; Index < Length; Index++)
+   {
+    if (Dest[Index] == ',')
+     {
+      Dest[Index] = '.';
+     }
+   }
+
+  return((unsigned int)Length);
+ }
+
+/* the same output as "%f" (6 digits after decimal point), but locale */
+/* independent and much faster. Float multiplied by 10^6 fits double  */
+/* mantissa exactly, so ties can be rounded to even as printf does    */
+static unsigned int FormatFloatFixed  (char               *Dest,
+                                       float               Value)
+ {
+  double                               Product;
+  P3Duint64                            Scaled;
+  P3Duint64                            Integer;
+  unsigned int                         Fraction;
+  unsigned int                         Length;
+  P3Duint32                            Bits;
+
+  if (Value != Value)
+   {
+    Value = 0.0f;
+   }
+
+  Product = fabs((double)Value) * 1000000.0;
+
+  if (Product >= 1.0e18)
+   {
+    return(FormatFloatPrintf(Dest,"%f",Value));
+   }
+
+  /* sign bit is checked to print -0.0 as "-0.000000". Sign and short */
+  /* integer part are handled without branches since vertex data has  */
+  /* no predictable pattern                                           */
+  memcpy(&Bits,&Value,sizeof(Bits));
+
+  Dest[0] = '-';
+  Length  = Bits >> 31;
+
+  #if defined(FLT_EVAL_METHOD) && (FLT_EVAL_METHOD == 0)
+  /* adding and subtracting 2^52 rounds to integer with ties to even, */
+  /* larger products have no fraction bits at all                     */
+  if (Product < P3DExportRoundingBias)
+   {
+    Product = (Product + P3DExportRoundingBias) - P3DExportRoundingBias;
+   }
+
+  Scaled = (P3Duint64)Product;
+  #else
+  {
+   double                              Remainder;
+
+   Scaled    = (P3Duint64)Product;
+   Remainder = Product - (double)Scaled;
+
+   /* evaluated without branches - rounding direction is unpredictable */
+   Scaled += (unsigned int)(Remainder > 0.5) |
+             ((unsigned int)(Remainder == 0.5) & (unsigned int)(Scaled & 1));
+  }
+  #endif
+
+  Integer  = Scaled / 1000000;
+  Fraction = (unsigned int)(Scaled - Integer * 1000000);
+
+  if (Integer < 100)
+   {
+    unsigned int                       Short;
+
+    Short = (unsigned int)(Integer < 10);
+
+    Dest[Length]     = P3DExportDigitPairs[Integer * 2 + Short];
+    Dest[Length + 1] = P3DExportDigitPairs[Integer * 2 + 1];
+
+    Length += 2 - Short;
+   }
+  else
+   {
+    Length += FormatUInt(&Dest[Length],Integer);
+   }
+
+  Dest[Length++] = '.';
+
+  memcpy(&Dest[Length],&P3DExportDigitTriples[(Fraction / 1000) * 3],3);
+  memcpy(&Dest[Length + 3],&P3DExportDigitTriples[(Fraction % 1000) * 3],3);
+
+  return(Length + 6);
+ }
+
+static void        WriteFloat         (P3DExportFileWriter*Writer,
+                                       float               Value)
+ {
+  Writer->Commit(FormatFloatFixed(Writer->Reserve(P3DExportMaxNumberLength),Value));
+ }
+
+static void        WriteUInt          (P3DExportFileWriter*Writer,
+                                       unsigned int        Value)
+ {
+  Writer->Commit(FormatUInt(Writer->Reserve(P3DExportMaxNumberLength),Value));
+ }
+
+static unsigned int GetGroupVAttrCount(const P3DCachedPlantGeometry
+                                                          *Geometry,
+                                       unsigned int        GroupIndex)
+ {
+  return(Geometry->GetVAttrCountI(GroupIndex) * Geometry->GetBranchCount(GroupIndex));
+ }
+
+static unsigned int GetGroupIndexCount(const P3DCachedPlantGeometry
+                                                          *Geometry,
+                                       unsigned int        GroupIndex)
+ {
+  return(Geometry->GetIndexCount(GroupIndex) * Geometry->GetBranchCount(GroupIndex));
+ }
+
+static std::string ReplaceFileExt     (const char         *FileName,
+                                       const char         *NewExt)
+ {
+  std::string                          Result(FileName);
+  std::string::size_type               DotPos;
+  std::string::size_type               SepPos;
+
+  DotPos = Result.rfind('.');
+  SepPos = Result.find_last_of("/\\");
+
+  if ((DotPos != std::string::npos) &&
+      ((SepPos == std::string::npos) || (DotPos > SepPos)))
+   {
+    Result.erase(DotPos);
+   }
+
+  Result += NewExt;
+
+  return(Result);
+ }
+
+                   P3DExportOptions::P3DExportOptions
+                                      ()
+ {
+  Scale           = 1.0f;
+  ExportNormals   = true;
+  ExportTexCoords = true;
+  Instancing      = P3D_EXPORT_INSTANCING_SCALED;
+ }
+
+                   P3DPlantExporter::P3DPlantExporter
+                                      ()
+ {
+ }
+
+void               P3DPlantExporter::SetOptions
+                                      (const P3DExportOptions
+                                                          *Options)
+ {
+  this->Options = *Options;
+ }
+
+const
+P3DExportOptions  *P3DPlantExporter::GetOptions
+                                      () const
+ {
+  return(&Options);
+ }
+
+const char        *P3DPlantExporter::GetErrorMessage
+                                      () const
+ {
+  return(ErrorMessage.c_str());
+ }
+
+void               P3DPlantExporter::SetErrorMessage
+                                      (const char         *Message,
+                                       const char         *FileName)
+ {
+  ErrorMessage = Message;
+
+  if (FileName != 0)
+   {
+    ErrorMessage += " (";
+    ErrorMessage += FileName;
+    ErrorMessage += ")";
+   }
+ }
+
+bool               P3DPlantExporter::IsInstancedGroup
+                                      (const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance,
+                                       unsigned int        GroupIndex) const
+ {
+  if ((Instance == 0) || (Options.Instancing == P3D_EXPORT_INSTANCING_NONE))
+   {
+    return(false);
+   }
+
+  if (!Template->IsCloneable(GroupIndex,Options.Instancing == P3D_EXPORT_INSTANCING_SCALED))
+   {
+    return(false);
+   }
+
+  /* single branch is cheaper to store as plain geometry */
+  return(Instance->GetBranchCount(GroupIndex) > 1);
+ }
+
+bool               P3DPlantExporter::Export
+                                      (const char         *FileName,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance,
+                                       const P3DCachedPlantGeometry
+                                                          *Geometry)
+ {
+  P3DCachedPlantGeometry              *OwnedGeometry;
+  unsigned int                         AttrMask;
+  bool                                 Result;
+
+  ErrorMessage.clear();
+
+  OwnedGeometry = 0;
+
+  try
+   {
+    if (Geometry == 0)
+     {
+      /* tangents, binormals and bounding box are not exported, */
+      /* so they are not generated                               */
+      AttrMask = 1 << P3D_ATTR_VERTEX;
+
+      if (Options.ExportNormals)
+       {
+        AttrMask |= 1 << P3D_ATTR_NORMAL;
+       }
+
+      if (Options.ExportTexCoords)
+       {
+        AttrMask |= 1 << P3D_ATTR_TEXCOORD0;
+       }
+
+      OwnedGeometry = P3DCachedPlantGeometry::Generate(Template,Instance,AttrMask,false);
+      Geometry      = OwnedGeometry;
+     }
+
+    Result = ExportGeometry(FileName,Template,Instance,Geometry);
+   }
+  catch (const P3DException &Exception)
+   {
+    SetErrorMessage(Exception.GetMessage());
+
+    Result = false;
+   }
+  catch (const std::bad_alloc &)
+   {
+    SetErrorMessage("out of memory");
+
+    Result = false;
+   }
+
+  delete OwnedGeometry;
+
+  return(Result);
+ }
+
+/* OBJ */
+
+/* each line is formatted directly into reserved writer buffer space */
+static void        WriteOBJVectors    (P3DExportFileWriter*Writer,
+                                       const char         *Prefix,
+                                       const float        *Values,
+                                       unsigned int        Count,
+                                       unsigned int        ComponentCount,
+                                       float               Scale)
+ {
+  unsigned int                         PrefixLength;
+
+  PrefixLength = strlen(Prefix);
+
+  for (unsigned int Index = 0; Index < Count; Index++)
+   {
+    char                              *Line;
+    unsigned int                       Length;
+
+    Line = Writer->Reserve(P3DExportMaxLineLength);
+
+    for (Length = 0; Length < PrefixLength; Length++)
+     {
+      Line[Length] = Prefix[Length];
+     }
+
+    for (unsigned int Component = 0; Component < ComponentCount; Component++)
+     {
+      Line[Length++] = ' ';
+
+      Length += FormatFloatFixed(&Line[Length],*Values++ * Scale);
+     }
+
+    Line[Length++] = '\n';
+
+    Writer->Commit(Length);
+   }
+ }
+
+static void        WriteOBJFaces      (P3DExportFileWriter*Writer,
+                                       const unsigned int *Indices,
+                                       unsigned int        IndexCount,
+                                       bool                HasTexCoords,
+                                       bool                HasNormals)
+ {
+  for (unsigned int Index = 0; Index + 2 < IndexCount; Index += 3)
+   {
+    char                              *Line;
+    unsigned int                       Length;
+
+    Line = Writer->Reserve(P3DExportMaxLineLength);
+
+    Line[0] = 'f';
+
+    Length = 1;
+
+    /* all attributes share the same index, so its text is copied */
+    for (unsigned int Corner = 0; Corner < 3; Corner++)
+     {
+      const char                      *IndexText;
+      unsigned int                     IndexLength;
+
+      Line[Length++] = ' ';
+
+      IndexText   = &Line[Length];
+      IndexLength = FormatUInt(&Line[Length],Indices[Index + Corner]);
+
+      Length += IndexLength;
+
+      if (HasTexCoords)
+       {
+        Line[Length++] = '/';
+
+        for (unsigned int Digit = 0; Digit < IndexLength; Digit++)
+         {
+          Line[Length++] = IndexText[Digit];
+         }
+       }
+
+      if (HasNormals)
+       {
+        Line[Length++] = '/';
+
+        if (!HasTexCoords)
+         {
+          Line[Length++] = '/';
+         }
+
+        for (unsigned int Digit = 0; Digit < IndexLength; Digit++)
+         {
+          Line[Length++] = IndexText[Digit];
+         }
+       }
+     }
+
+    Line[Length++] = '\n';
+
+    Writer->Commit(Length);
+   }
+ }
+
+static bool        ExportMTL          (const char         *FileName,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DCachedPlantGeometry
+                                                          *Geometry)
+ {
+  P3DExportFileWriter                  Writer;
+
+  if (!Writer.Open(FileName))
+   {
+    return(false);
+   }
+
+  for (unsigned int GroupIndex = 0; GroupIndex < Template->GetGroupCount(); GroupIndex++)
+   {
+    const P3DMaterialDef              *MaterialDef;
+    float                              R,G,B;
+
+    if (GetGroupVAttrCount(Geometry,GroupIndex) == 0)
+     {
+      continue;
+     }
+
+    MaterialDef = Template->GetMaterial(GroupIndex);
+
+    MaterialDef->GetColor(&R,&G,&B);
+
+    Writer.WriteString("newmtl pmat");
+    WriteUInt(&Writer,GroupIndex + 1);
+    Writer.WriteString("\nKd ");
+    WriteFloat(&Writer,R);
+    Writer.WriteChar(' ');
+    WriteFloat(&Writer,G);
+    Writer.WriteChar(' ');
+    WriteFloat(&Writer,B);
+    Writer.WriteString("\nNs 1\n");
+
+    if (MaterialDef->GetTexName(P3D_TEX_DIFFUSE) != 0)
+     {
+      Writer.WriteString("map_Kd ");
+      Writer.WriteString(MaterialDef->GetTexName(P3D_TEX_DIFFUSE));
+      Writer.WriteChar('\n');
+     }
+
+    if (MaterialDef->GetTexName(P3D_TEX_NORMAL_MAP) != 0)
+     {
+      Writer.WriteString("map_bump ");
+      Writer.WriteString(MaterialDef->GetTexName(P3D_TEX_NORMAL_MAP));
+      Writer.WriteChar('\n');
+     }
+   }
+
+  return(Writer.Close());
+ }
+
+bool               P3DPlantExporterOBJ::ExportGeometry
+                                      (const char         *FileName,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance P3D_UNUSED_ATTR,
+                                       const P3DCachedPlantGeometry
+                                                          *Geometry)
+ {
+  P3DExportFileWriter                  Writer;
+  std::string                          MTLFileName;
+  std::vector<unsigned int>            IndexBuffer;
+  unsigned int                         VertexBase;
+
+  MTLFileName = ReplaceFileExt(FileName,".mtl");
+
+  if (!ExportMTL(MTLFileName.c_str(),Template,Geometry))
+   {
+    SetErrorMessage("unable to write file",MTLFileName.c_str());
+
+    return(false);
+   }
+
+  if (!Writer.Open(FileName))
+   {
+    SetErrorMessage("unable to create file",FileName);
+
+    return(false);
+   }
+
+  Writer.WriteString("o plant\nmtllib ");
+  Writer.WriteString(P3DPathName::BaseName(MTLFileName.c_str()).c_str());
+  Writer.WriteChar('\n');
+
+  VertexBase = 1;
+
+  for (unsigned int GroupIndex = 0; GroupIndex < Template->GetGroupCount(); GroupIndex++)
+   {
+    unsigned int                       VAttrCount;
+    unsigned int                       IndexCount;
+
+    VAttrCount = GetGroupVAttrCount(Geometry,GroupIndex);
+    IndexCount = GetGroupIndexCount(Geometry,GroupIndex);
+
+    if (VAttrCount == 0)
+     {
+      continue;
+     }
+
+    Writer.WriteString("g bgroup");
+    WriteUInt(&Writer,GroupIndex + 1);
+    Writer.WriteString("\nusemtl pmat");
+    WriteUInt(&Writer,GroupIndex + 1);
+    Writer.WriteChar('\n');
+
+    WriteOBJVectors(&Writer,"v",
+                    Geometry->GetVAttrBufferI(GroupIndex,P3D_ATTR_VERTEX),
+                    VAttrCount,3,Options.Scale);
+
+    if (Options.ExportNormals)
+     {
+      WriteOBJVectors(&Writer,"vn",
+                      Geometry->GetVAttrBufferI(GroupIndex,P3D_ATTR_NORMAL),
+                      VAttrCount,3,1.0f);
+     }
+
+    if (Options.ExportTexCoords)
+     {
+      WriteOBJVectors(&Writer,"vt",
+                      Geometry->GetVAttrBufferI(GroupIndex,P3D_ATTR_TEXCOORD0),
+                      VAttrCount,2,1.0f);
+     }
+
+    if (IndexCount > 0)
+     {
+      IndexBuffer.resize(IndexCount);
+
+      Geometry->FillIndexBuffer(&IndexBuffer[0],GroupIndex,P3D_UNSIGNED_INT,VertexBase);
+
+      WriteOBJFaces(&Writer,&IndexBuffer[0],IndexCount,
+                    Options.ExportTexCoords,Options.ExportNormals);
+     }
+
+    VertexBase += VAttrCount;
+   }
+
+  if (!Writer.Close())
+   {
+    SetErrorMessage("unable to write file",FileName);
+
+    return(false);
+   }
+
+  return(true);
+ }
+
+/* glTF */
+
+#define P3DGLTFMagic             (0x46546C67)
+#define P3DGLTFVersion           (2)
+#define P3DGLTFChunkJSON         (0x4E4F534A)
+#define P3DGLTFChunkBIN          (0x004E4942)
+
+#define P3DGLTFArrayBuffer        (34962)
+#define P3DGLTFElementArrayBuffer (34963)
+
+#define P3DGLTFUnsignedShort     (5123)
+#define P3DGLTFUnsignedInt       (5125)
+#define P3DGLTFFloat             (5126)
+
+#define P3DGLTFConvBufferSize    (16384)
+
+#define P3DGLTFNoAccessor        (0xFFFFFFFF)
+
+#define P3DGLTFMaxBinSize        (0x7FFFFFFF)
+
+/* each accessor has its own buffer view with the same index */
+typedef struct
+ {
+  unsigned int     Offset;
+  unsigned int     Length;
+  unsigned int     Target;
+  unsigned int     ComponentType;
+  unsigned int     Count;
+  const char      *Type;
+  bool             HasBounds;
+  float            Min[3];
+  float            Max[3];
+ } P3DGLTFAccessorInfo;
+
+typedef struct
+ {
+  unsigned int     GroupIndex;
+  unsigned int     VAttrCount;
+  unsigned int     IndexCount;
+  unsigned int     InstanceCount; /* 0 if group geometry is not instanced */
+  bool             ShortIndices;
+  const float     *Positions;
+  const float     *Normals;
+  const float     *TexCoords;
+  const float     *Translations;
+  const float     *Rotations;
+  const float     *Scales;        /* NULL if all instances are unscaled  */
+  unsigned int     PosAccessor;
+  unsigned int     NormalAccessor;
+  unsigned int     TexCoordAccessor;
+  unsigned int     IndexAccessor;
+  unsigned int     TranslationAccessor;
+  unsigned int     RotationAccessor;
+  unsigned int     ScaleAccessor;
+ } P3DGLTFMeshInfo;
+
+/* clone geometry and per-branch transforms of instanced group */
+typedef struct
+ {
+  std::vector<float>                   Positions;
+  std::vector<float>                   Normals;
+  std::vector<float>                   TexCoords;
+  std::vector<float>                   Translations;
+  std::vector<float>                   Rotations;
+  std::vector<float>                   Scales;
+ } P3DGLTFCloneData;
+
+class P3DGLTFJSONWriter
+ {
+  public           :
+
+  void             Append             (const char         *Str)
+   {
+    Text += Str;
+   }
+
+  void             AppendUInt         (unsigned int        Value)
+   {
+    char                               Buffer[P3DExportMaxNumberLength];
+
+    Text.append(Buffer,FormatUInt(Buffer,Value));
+   }
+
+  void             AppendFloat        (float               Value)
+   {
+    char                               Buffer[P3DExportMaxNumberLength];
+
+    if (Value != Value)
+     {
+      Value = 0.0f;
+     }
+
+    Text.append(Buffer,FormatFloatPrintf(Buffer,"%.9g",Value));
+   }
+
+  void             AppendString       (const char         *Str)
+   {
+    Text += '"';
+
+    for (; *Str != 0; Str++)
+     {
+      unsigned char                    Char = (unsigned char)*Str;
+
+      if      ((Char == '"') || (Char == '\\'))
+       {
+        Text += '\\';
+        Text += (char)Char;
+       }
+      else if (Char < 0x20)
+       {
+        char                           Buffer[8];
+
+        snprintf(Buffer,sizeof(Buffer),"\\u%04x",Char);
+
+        Text += Buffer;
+       }
+      else
+       {
+        Text += (char)Char;
+       }
+     }
+
+    Text += '"';
+   }
+
+  /* texture names are relative paths, so only characters not allowed */
+  /* in URI are escaped                                                */
+  void             AppendURI          (const char         *Str)
+   {
+    static const char                  HexDigits[] = "0123456789ABCDEF";
+    std::string                        URI;
+
+    for (; *Str != 0; Str++)
+     {
+      unsigned char                    Char = (unsigned char)*Str;
+
+      if (((Char >= 'a') && (Char <= 'z')) ||
+          ((Char >= 'A') && (Char <= 'Z')) ||
+          ((Char >= '0') && (Char <= '9')) ||
+          (strchr("-._~/",Char) != 0))
+       {
+        URI += (char)Char;
+       }
+      else if (Char == '\\')
+       {
+        URI += '/';
+       }
+      else
+       {
+        URI += '%';
+        URI += HexDigits[Char >> 4];
+        URI += HexDigits[Char & 0x0F];
+       }
+     }
+
+    AppendString(URI.c_str());
+   }
+
+  void             AppendFloatArray   (const float        *Values,
+                                       unsigned int        Count)
+   {
+    Text += '[';
+
+    for (unsigned int Index = 0; Index < Count; Index++)
+     {
+      if (Index > 0)
+       {
+        Text += ',';
+       }
+
+      AppendFloat(Values[Index]);
+     }
+
+    Text += ']';
+   }
+
+  const std::string &GetText          () const
+   {
+    return(Text);
+   }
+
+  private          :
+
+  std::string                          Text;
+ };
+
+static void        WriteUInt32LE      (P3DExportFileWriter*Writer,
+                                       P3Duint32           Value)
+ {
+  unsigned char                        Bytes[4];
+
+  Bytes[0] = (unsigned char)(Value & 0xFF);
+  Bytes[1] = (unsigned char)((Value >> 8) & 0xFF);
+  Bytes[2] = (unsigned char)((Value >> 16) & 0xFF);
+  Bytes[3] = (unsigned char)((Value >> 24) & 0xFF);
+
+  Writer->Write(Bytes,sizeof(Bytes));
+ }
+
+/* writes array of 2 or 4-byte values in little-endian byte order */
+static void        WriteLE            (P3DExportFileWriter*Writer,
+                                       const void         *Data,
+                                       unsigned int        Count,
+                                       unsigned int        ValueSize)
+ {
+  #if defined(P3D_BIG_ENDIAN)
+  const unsigned char                 *Source = (const unsigned char*)Data;
+
+  for (unsigned int Index = 0; Index < Count; Index++)
+   {
+    unsigned char                     *Target;
+
+    Target = (unsigned char*)Writer->Reserve(ValueSize);
+
+    for (unsigned int Byte = 0; Byte < ValueSize; Byte++)
+     {
+      Target[Byte] = Source[ValueSize - Byte - 1];
+     }
+
+    Writer->Commit(ValueSize);
+
+    Source += ValueSize;
+   }
+  #else
+  Writer->Write(Data,Count * ValueSize);
+  #endif
+ }
+
+static void        WritePadding       (P3DExportFileWriter*Writer,
+                                       unsigned int        Size,
+                                       char                Value)
+ {
+  while ((Size % 4) != 0)
+   {
+    Writer->WriteChar(Value);
+
+    Size++;
+   }
+ }
+
+static unsigned int AlignSize         (unsigned int        Size)
+ {
+  return((Size + 3) & ~3U);
+ }
+
+static void        CalcBoundingBox    (P3DGLTFAccessorInfo*Accessor,
+                                       const float        *Positions,
+                                       float               Scale)
+ {
+  Accessor->HasBounds = true;
+
+  for (unsigned int Component = 0; Component < 3; Component++)
+   {
+    Accessor->Min[Component] = Positions[Component] * Scale;
+    Accessor->Max[Component] = Positions[Component] * Scale;
+   }
+
+  for (unsigned int Index = 1; Index < Accessor->Count; Index++)
+   {
+    Positions += 3;
+
+    for (unsigned int Component = 0; Component < 3; Component++)
+     {
+      float                            Value = Positions[Component] * Scale;
+
+      if      (Value < Accessor->Min[Component])
+       {
+        Accessor->Min[Component] = Value;
+       }
+      else if (Value > Accessor->Max[Component])
+       {
+        Accessor->Max[Component] = Value;
+       }
+     }
+   }
+ }
+
+/* allocate accessor data inside BIN chunk, Target == 0 means data */
+/* not used as vertex attribute or index data                       */
+static unsigned int AddAccessor       (std::vector<P3DGLTFAccessorInfo>
+                                                          *Accessors,
+                                       P3Duint64          *BinSize,
+                                       unsigned int        Target,
+                                       unsigned int        ComponentType,
+                                       unsigned int        ComponentCount,
+                                       unsigned int        Count,
+                                       const char         *Type)
+ {
+  P3DGLTFAccessorInfo                  Accessor;
+  P3Duint64                            Length;
+
+  Length = (P3Duint64)Count * ComponentCount *
+            (ComponentType == P3DGLTFUnsignedShort ? sizeof(P3Duint16) : sizeof(P3Duint32));
+
+  if ((*BinSize) + Length + 3 > P3DGLTFMaxBinSize)
+   {
+    throw P3DExceptionGeneric("generated geometry is too large for glTF export");
+   }
+
+  Accessor.Offset        = (unsigned int)(*BinSize);
+  Accessor.Length        = (unsigned int)Length;
+  Accessor.Target        = Target;
+  Accessor.ComponentType = ComponentType;
+  Accessor.Count         = Count;
+  Accessor.Type          = Type;
+  Accessor.HasBounds     = false;
+
+  *BinSize += AlignSize(Accessor.Length);
+
+  Accessors->push_back(Accessor);
+
+  return(Accessors->size() - 1);
+ }
+
+static void        AppendBufferView   (P3DGLTFJSONWriter  *JSON,
+                                       const P3DGLTFAccessorInfo
+                                                          *Accessor)
+ {
+  JSON->Append("{\"buffer\":0,\"byteOffset\":");
+  JSON->AppendUInt(Accessor->Offset);
+  JSON->Append(",\"byteLength\":");
+  JSON->AppendUInt(Accessor->Length);
+
+  if (Accessor->Target != 0)
+   {
+    JSON->Append(",\"target\":");
+    JSON->AppendUInt(Accessor->Target);
+   }
+
+  JSON->Append("}");
+ }
+
+static void        AppendAccessor     (P3DGLTFJSONWriter  *JSON,
+                                       const P3DGLTFAccessorInfo
+                                                          *Accessor,
+                                       unsigned int        AccessorIndex)
+ {
+  JSON->Append("{\"bufferView\":");
+  JSON->AppendUInt(AccessorIndex);
+  JSON->Append(",\"componentType\":");
+  JSON->AppendUInt(Accessor->ComponentType);
+  JSON->Append(",\"count\":");
+  JSON->AppendUInt(Accessor->Count);
+  JSON->Append(",\"type\":\"");
+  JSON->Append(Accessor->Type);
+  JSON->Append("\"");
+
+  if (Accessor->HasBounds)
+   {
+    JSON->Append(",\"min\":");
+    JSON->AppendFloatArray(Accessor->Min,3);
+    JSON->Append(",\"max\":");
+    JSON->AppendFloatArray(Accessor->Max,3);
+   }
+
+  JSON->Append("}");
+ }
+
+static unsigned int GetTextureIndex   (std::vector<std::string>
+                                                          *TexNames,
+                                       const char         *TexName)
+ {
+  for (unsigned int Index = 0; Index < TexNames->size(); Index++)
+   {
+    if ((*TexNames)[Index] == TexName)
+     {
+      return(Index);
+     }
+   }
+
+  TexNames->push_back(TexName);
+
+  return(TexNames->size() - 1);
+ }
+
+static void        AppendMaterial     (P3DGLTFJSONWriter  *JSON,
+                                       std::vector<std::string>
+                                                          *TexNames,
+                                       const P3DMaterialDef
+                                                          *MaterialDef,
+                                       unsigned int        GroupIndex)
+ {
+  float                                Color[4];
+  char                                 Name[32];
+
+  MaterialDef->GetColor(&Color[0],&Color[1],&Color[2]);
+
+  Color[3] = 1.0f;
+
+  snprintf(Name,sizeof(Name),"pmat%u",GroupIndex + 1);
+
+  JSON->Append("{\"name\":");
+  JSON->AppendString(Name);
+  JSON->Append(",\"pbrMetallicRoughness\":{\"baseColorFactor\":[");
+
+  for (unsigned int Index = 0; Index < 4; Index++)
+   {
+    if (Index > 0)
+     {
+      JSON->Append(",");
+     }
+
+    JSON->AppendFloat(Color[Index]);
+   }
+
+  JSON->Append("],\"metallicFactor\":0,\"roughnessFactor\":1");
+
+  if (MaterialDef->GetTexName(P3D_TEX_DIFFUSE) != 0)
+   {
+    JSON->Append(",\"baseColorTexture\":{\"index\":");
+    JSON->AppendUInt(GetTextureIndex(TexNames,MaterialDef->GetTexName(P3D_TEX_DIFFUSE)));
+    JSON->Append("}");
+   }
+
+  JSON->Append("}");
+
+  if (MaterialDef->GetTexName(P3D_TEX_NORMAL_MAP) != 0)
+   {
+    JSON->Append(",\"normalTexture\":{\"index\":");
+    JSON->AppendUInt(GetTextureIndex(TexNames,MaterialDef->GetTexName(P3D_TEX_NORMAL_MAP)));
+    JSON->Append("}");
+   }
+
+  /* ngPlant renders transparent materials using alpha test */
+  if (MaterialDef->IsTransparent())
+   {
+    JSON->Append(",\"alphaMode\":\"MASK\",\"alphaCutoff\":0.5");
+   }
+
+  if (MaterialDef->IsDoubleSided())
+   {
+    JSON->Append(",\"doubleSided\":true");
+   }
+
+  JSON->Append("}");
+ }
+
+static void        WriteGLTFPositions (P3DExportFileWriter*Writer,
+                                       const float        *Positions,
+                                       unsigned int        Count,
+                                       float               Scale)
+ {
+  float                                Buffer[P3DGLTFConvBufferSize];
+  unsigned int                         ValueCount;
+
+  ValueCount = Count * 3;
+
+  if (Scale == 1.0f)
+   {
+    WriteLE(Writer,Positions,ValueCount,sizeof(float));
+
+    return;
+   }
+
+  while (ValueCount > 0)
+   {
+    unsigned int                       ChunkSize;
+
+    ChunkSize = ValueCount < P3DGLTFConvBufferSize ? ValueCount : P3DGLTFConvBufferSize;
+
+    for (unsigned int Index = 0; Index < ChunkSize; Index++)
+     {
+      Buffer[Index] = Positions[Index] * Scale;
+     }
+
+    WriteLE(Writer,Buffer,ChunkSize,sizeof(float));
+
+    Positions  += ChunkSize;
+    ValueCount -= ChunkSize;
+   }
+ }
+
+/* glTF uses upper-left texture origin */
+static void        WriteGLTFTexCoords (P3DExportFileWriter*Writer,
+                                       const float        *TexCoords,
+                                       unsigned int        Count)
+ {
+  float                                Buffer[P3DGLTFConvBufferSize];
+  unsigned int                         ValueCount;
+
+  ValueCount = Count * 2;
+
+  while (ValueCount > 0)
+   {
+    unsigned int                       ChunkSize;
+
+    ChunkSize = ValueCount < P3DGLTFConvBufferSize ? ValueCount : P3DGLTFConvBufferSize;
+
+    for (unsigned int Index = 0; Index < ChunkSize; Index += 2)
+     {
+      Buffer[Index]     = TexCoords[Index];
+      Buffer[Index + 1] = 1.0f - TexCoords[Index + 1];
+     }
+
+    WriteLE(Writer,Buffer,ChunkSize,sizeof(float));
+
+    TexCoords  += ChunkSize;
+    ValueCount -= ChunkSize;
+   }
+ }
+
+static void        PrepareCloneData   (P3DGLTFMeshInfo    *MeshInfo,
+                                       P3DGLTFCloneData   *CloneData,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance,
+                                       const P3DExportOptions
+                                                          *Options)
+ {
+  P3DHLIVAttrBuffers                   VAttrBuffers;
+  std::vector<float>                   Scales;
+  bool                                 Scaled;
+
+  CloneData->Positions.resize(MeshInfo->VAttrCount * 3);
+
+  VAttrBuffers.AddAttr(P3D_ATTR_VERTEX,&CloneData->Positions[0],0,sizeof(float) * 3);
+
+  if (Options->ExportNormals)
+   {
+    CloneData->Normals.resize(MeshInfo->VAttrCount * 3);
+
+    VAttrBuffers.AddAttr(P3D_ATTR_NORMAL,&CloneData->Normals[0],0,sizeof(float) * 3);
+   }
+
+  if (Options->ExportTexCoords)
+   {
+    CloneData->TexCoords.resize(MeshInfo->VAttrCount * 2);
+
+    VAttrBuffers.AddAttr(P3D_ATTR_TEXCOORD0,&CloneData->TexCoords[0],0,sizeof(float) * 2);
+   }
+
+  Template->FillCloneVAttrBuffersI(&VAttrBuffers,MeshInfo->GroupIndex);
+
+  CloneData->Translations.resize(MeshInfo->InstanceCount * 3);
+  CloneData->Rotations.resize(MeshInfo->InstanceCount * 4);
+  Scales.resize(MeshInfo->InstanceCount);
+
+  Instance->FillCloneTransformBuffer(&CloneData->Translations[0],
+                                     &CloneData->Rotations[0],
+                                     &Scales[0],
+                                      MeshInfo->GroupIndex);
+
+  Scaled = false;
+
+  for (unsigned int Index = 0; (Index < Scales.size()) && (!Scaled); Index++)
+   {
+    Scaled = Scales[Index] != 1.0f;
+   }
+
+  if (Scaled)
+   {
+    CloneData->Scales.resize(MeshInfo->InstanceCount * 3);
+
+    for (unsigned int Index = 0; Index < Scales.size(); Index++)
+     {
+      CloneData->Scales[Index * 3]     = Scales[Index];
+      CloneData->Scales[Index * 3 + 1] = Scales[Index];
+      CloneData->Scales[Index * 3 + 2] = Scales[Index];
+     }
+   }
+
+  MeshInfo->Positions    = &CloneData->Positions[0];
+  MeshInfo->Normals      = Options->ExportNormals ? &CloneData->Normals[0] : 0;
+  MeshInfo->TexCoords    = Options->ExportTexCoords ? &CloneData->TexCoords[0] : 0;
+  MeshInfo->Translations = &CloneData->Translations[0];
+  MeshInfo->Rotations    = &CloneData->Rotations[0];
+  MeshInfo->Scales       = Scaled ? &CloneData->Scales[0] : 0;
+ }
+
+static void        WriteGLTFIndices   (P3DExportFileWriter*Writer,
+                                       const P3DGLTFMeshInfo
+                                                          *MeshInfo,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DCachedPlantGeometry
+                                                          *Geometry)
+ {
+  unsigned int                         ElementType;
+  unsigned int                         ElementSize;
+  std::vector<P3Duint32>               Indices;
+
+  ElementType = MeshInfo->ShortIndices ? P3D_UNSIGNED_SHORT : P3D_UNSIGNED_INT;
+  ElementSize = MeshInfo->ShortIndices ? sizeof(P3Duint16) : sizeof(P3Duint32);
+
+  /* P3Duint32 buffer is large enough for 16-bit indices too */
+  Indices.resize(MeshInfo->IndexCount);
+
+  if (MeshInfo->InstanceCount > 0)
+   {
+    Template->FillIndexBuffer(&Indices[0],MeshInfo->GroupIndex,P3D_TRIANGLE_LIST,ElementType);
+   }
+  else
+   {
+    Geometry->FillIndexBuffer(&Indices[0],MeshInfo->GroupIndex,ElementType);
+   }
+
+  WriteLE(Writer,&Indices[0],MeshInfo->IndexCount,ElementSize);
+  WritePadding(Writer,MeshInfo->IndexCount * ElementSize,0);
+ }
+
+bool               P3DPlantExporterGLTF::ExportGeometry
+                                      (const char         *FileName,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance,
+                                       const P3DCachedPlantGeometry
+                                                          *Geometry)
+ {
+  std::vector<P3DGLTFMeshInfo>         Meshes;
+  std::vector<P3DGLTFCloneData>        Clones;
+  std::vector<P3DGLTFAccessorInfo>     Accessors;
+  std::vector<std::string>             TexNames;
+  P3DGLTFJSONWriter                    JSON;
+  P3DExportFileWriter                  Writer;
+  P3Duint64                            BinSize;
+  unsigned int                         JSONSize;
+  unsigned int                         TotalSize;
+  unsigned int                         MeshIndex;
+  bool                                 HasInstancing;
+
+  BinSize       = 0;
+  HasInstancing = false;
+
+  /* clone data must not be reallocated - meshes keep pointers to it */
+  Clones.reserve(Template->GetGroupCount());
+
+  for (unsigned int GroupIndex = 0; GroupIndex < Template->GetGroupCount(); GroupIndex++)
+   {
+    P3DGLTFMeshInfo                    MeshInfo;
+
+    MeshInfo.GroupIndex = GroupIndex;
+
+    if (IsInstancedGroup(Template,Instance,GroupIndex))
+     {
+      MeshInfo.VAttrCount    = Template->GetVAttrCountI(GroupIndex);
+      MeshInfo.IndexCount    = Template->GetIndexCount(GroupIndex,P3D_TRIANGLE_LIST);
+      MeshInfo.InstanceCount = Instance->GetBranchCount(GroupIndex);
+     }
+    else
+     {
+      MeshInfo.VAttrCount    = GetGroupVAttrCount(Geometry,GroupIndex);
+      MeshInfo.IndexCount    = GetGroupIndexCount(Geometry,GroupIndex);
+      MeshInfo.InstanceCount = 0;
+     }
+
+    if ((MeshInfo.VAttrCount == 0) || (MeshInfo.IndexCount == 0))
+     {
+      continue;
+     }
+
+    if (MeshInfo.InstanceCount > 0)
+     {
+      Clones.push_back(P3DGLTFCloneData());
+
+      PrepareCloneData(&MeshInfo,&Clones.back(),Template,Instance,&Options);
+
+      HasInstancing = true;
+     }
+    else
+     {
+      MeshInfo.Positions    = Geometry->GetVAttrBufferI(GroupIndex,P3D_ATTR_VERTEX);
+      MeshInfo.Normals      = Options.ExportNormals ?
+                               Geometry->GetVAttrBufferI(GroupIndex,P3D_ATTR_NORMAL) : 0;
+      MeshInfo.TexCoords    = Options.ExportTexCoords ?
+                               Geometry->GetVAttrBufferI(GroupIndex,P3D_ATTR_TEXCOORD0) : 0;
+      MeshInfo.Translations = 0;
+      MeshInfo.Rotations    = 0;
+      MeshInfo.Scales       = 0;
+     }
+
+    MeshInfo.ShortIndices = MeshInfo.VAttrCount <= 0x10000;
+
+    MeshInfo.PosAccessor = AddAccessor(&Accessors,&BinSize,P3DGLTFArrayBuffer,
+                                       P3DGLTFFloat,3,MeshInfo.VAttrCount,"VEC3");
+
+    CalcBoundingBox(&Accessors.back(),MeshInfo.Positions,Options.Scale);
+
+    MeshInfo.NormalAccessor   = P3DGLTFNoAccessor;
+    MeshInfo.TexCoordAccessor = P3DGLTFNoAccessor;
+
+    if (Options.ExportNormals)
+     {
+      MeshInfo.NormalAccessor = AddAccessor(&Accessors,&BinSize,P3DGLTFArrayBuffer,
+                                            P3DGLTFFloat,3,MeshInfo.VAttrCount,"VEC3");
+     }
+
+    if (Options.ExportTexCoords)
+     {
+      MeshInfo.TexCoordAccessor = AddAccessor(&Accessors,&BinSize,P3DGLTFArrayBuffer,
+                                              P3DGLTFFloat,2,MeshInfo.VAttrCount,"VEC2");
+     }
+
+    MeshInfo.IndexAccessor = AddAccessor(&Accessors,&BinSize,P3DGLTFElementArrayBuffer,
+                                         MeshInfo.ShortIndices ? P3DGLTFUnsignedShort : P3DGLTFUnsignedInt,
+                                         1,MeshInfo.IndexCount,"SCALAR");
+
+    MeshInfo.TranslationAccessor = P3DGLTFNoAccessor;
+    MeshInfo.RotationAccessor    = P3DGLTFNoAccessor;
+    MeshInfo.ScaleAccessor       = P3DGLTFNoAccessor;
+
+    if (MeshInfo.InstanceCount > 0)
+     {
+      MeshInfo.TranslationAccessor = AddAccessor(&Accessors,&BinSize,0,
+                                                 P3DGLTFFloat,3,MeshInfo.InstanceCount,"VEC3");
+      MeshInfo.RotationAccessor    = AddAccessor(&Accessors,&BinSize,0,
+                                                 P3DGLTFFloat,4,MeshInfo.InstanceCount,"VEC4");
+
+      if (MeshInfo.Scales != 0)
+       {
+        MeshInfo.ScaleAccessor = AddAccessor(&Accessors,&BinSize,0,
+                                             P3DGLTFFloat,3,MeshInfo.InstanceCount,"VEC3");
+       }
+     }
+
+    Meshes.push_back(MeshInfo);
+   }
+
+  JSON.Append("{\"asset\":{\"version\":\"2.0\",\"generator\":\"ngPlant\"}");
+
+  if (HasInstancing)
+   {
+    JSON.Append(",\"extensionsUsed\":[\"EXT_mesh_gpu_instancing\"],\"extensionsRequired\":[\"EXT_mesh_gpu_instancing\"]");
+   }
+
+  JSON.Append(",\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"name\":\"plant\"");
+
+  if (!Meshes.empty())
+   {
+    JSON.Append(",\"children\":[");
+
+    for (MeshIndex = 0; MeshIndex < Meshes.size(); MeshIndex++)
+     {
+      if (MeshIndex > 0)
+       {
+        JSON.Append(",");
+       }
+
+      JSON.AppendUInt(MeshIndex + 1);
+     }
+
+    JSON.Append("]");
+   }
+
+  JSON.Append("}");
+
+  for (MeshIndex = 0; MeshIndex < Meshes.size(); MeshIndex++)
+   {
+    const P3DGLTFMeshInfo             &MeshInfo = Meshes[MeshIndex];
+    const char                        *GroupName;
+
+    GroupName = Template->GetGroupName(MeshInfo.GroupIndex);
+
+    JSON.Append(",{\"name\":");
+    JSON.AppendString(GroupName != 0 ? GroupName : "");
+    JSON.Append(",\"mesh\":");
+    JSON.AppendUInt(MeshIndex);
+
+    if (MeshInfo.InstanceCount > 0)
+     {
+      JSON.Append(",\"extensions\":{\"EXT_mesh_gpu_instancing\":{\"attributes\":{\"TRANSLATION\":");
+      JSON.AppendUInt(MeshInfo.TranslationAccessor);
+      JSON.Append(",\"ROTATION\":");
+      JSON.AppendUInt(MeshInfo.RotationAccessor);
+
+      if (MeshInfo.ScaleAccessor != P3DGLTFNoAccessor)
+       {
+        JSON.Append(",\"SCALE\":");
+        JSON.AppendUInt(MeshInfo.ScaleAccessor);
+       }
+
+      JSON.Append("}}}");
+     }
+
+    JSON.Append("}");
+   }
+
+  JSON.Append("]");
+
+  if (!Meshes.empty())
+   {
+    JSON.Append(",\"meshes\":[");
+
+    for (MeshIndex = 0; MeshIndex < Meshes.size(); MeshIndex++)
+     {
+      const P3DGLTFMeshInfo           &MeshInfo = Meshes[MeshIndex];
+      const char                      *GroupName;
+
+      GroupName = Template->GetGroupName(MeshInfo.GroupIndex);
+
+      if (MeshIndex > 0)
+       {
+        JSON.Append(",");
+       }
+
+      JSON.Append("{\"name\":");
+      JSON.AppendString(GroupName != 0 ? GroupName : "");
+      JSON.Append(",\"primitives\":[{\"attributes\":{\"POSITION\":");
+      JSON.AppendUInt(MeshInfo.PosAccessor);
+
+      if (MeshInfo.NormalAccessor != P3DGLTFNoAccessor)
+       {
+        JSON.Append(",\"NORMAL\":");
+        JSON.AppendUInt(MeshInfo.NormalAccessor);
+       }
+
+      if (MeshInfo.TexCoordAccessor != P3DGLTFNoAccessor)
+       {
+        JSON.Append(",\"TEXCOORD_0\":");
+        JSON.AppendUInt(MeshInfo.TexCoordAccessor);
+       }
+
+      JSON.Append("},\"indices\":");
+      JSON.AppendUInt(MeshInfo.IndexAccessor);
+      JSON.Append(",\"material\":");
+      JSON.AppendUInt(MeshIndex);
+      JSON.Append("}]}");
+     }
+
+    JSON.Append("],\"materials\":[");
+
+    for (MeshIndex = 0; MeshIndex < Meshes.size(); MeshIndex++)
+     {
+      if (MeshIndex > 0)
+       {
+        JSON.Append(",");
+       }
+
+      AppendMaterial(&JSON,&TexNames,
+                     Template->GetMaterial(Meshes[MeshIndex].GroupIndex),
+                     Meshes[MeshIndex].GroupIndex);
+     }
+
+    JSON.Append("]");
+
+    if (!TexNames.empty())
+     {
+      JSON.Append(",\"textures\":[");
+
+      for (unsigned int TexIndex = 0; TexIndex < TexNames.size(); TexIndex++)
+       {
+        JSON.Append(TexIndex > 0 ? ",{\"source\":" : "{\"source\":");
+        JSON.AppendUInt(TexIndex);
+        JSON.Append("}");
+       }
+
+      JSON.Append("],\"images\":[");
+
+      for (unsigned int TexIndex = 0; TexIndex < TexNames.size(); TexIndex++)
+       {
+        JSON.Append(TexIndex > 0 ? ",{\"uri\":" : "{\"uri\":");
+        JSON.AppendURI(TexNames[TexIndex].c_str());
+        JSON.Append("}");
+       }
+
+      JSON.Append("]");
+     }
+
+    JSON.Append(",\"accessors\":[");
+
+    for (unsigned int AccessorIndex = 0; AccessorIndex < Accessors.size(); AccessorIndex++)
+     {
+      if (AccessorIndex > 0)
+       {
+        JSON.Append(",");
+       }
+
+      AppendAccessor(&JSON,&Accessors[AccessorIndex],AccessorIndex);
+     }
+
+    JSON.Append("],\"bufferViews\":[");
+
+    for (unsigned int AccessorIndex = 0; AccessorIndex < Accessors.size(); AccessorIndex++)
+     {
+      if (AccessorIndex > 0)
+       {
+        JSON.Append(",");
+       }
+
+      AppendBufferView(&JSON,&Accessors[AccessorIndex]);
+     }
+
+    JSON.Append("],\"buffers\":[{\"byteLength\":");
+    JSON.AppendUInt((unsigned int)BinSize);
+    JSON.Append("}]");
+   }
+
+  JSON.Append("}");
+
+  if (!Writer.Open(FileName))
+   {
+    SetErrorMessage("unable to create file",FileName);
+
+    return(false);
+   }
+
+  JSONSize  = AlignSize(JSON.GetText().size());
+  TotalSize = 12 + 8 + JSONSize;
+
+  if (BinSize > 0)
+   {
+    TotalSize += 8 + (unsigned int)BinSize;
+   }
+
+  WriteUInt32LE(&Writer,P3DGLTFMagic);
+  WriteUInt32LE(&Writer,P3DGLTFVersion);
+  WriteUInt32LE(&Writer,TotalSize);
+
+  WriteUInt32LE(&Writer,JSONSize);
+  WriteUInt32LE(&Writer,P3DGLTFChunkJSON);
+  Writer.Write(JSON.GetText().data(),JSON.GetText().size());
+  WritePadding(&Writer,JSON.GetText().size(),' ');
+
+  if (BinSize > 0)
+   {
+    WriteUInt32LE(&Writer,(P3Duint32)BinSize);
+    WriteUInt32LE(&Writer,P3DGLTFChunkBIN);
+
+    /* data is written in the same order as accessors were allocated */
+    for (MeshIndex = 0; MeshIndex < Meshes.size(); MeshIndex++)
+     {
+      const P3DGLTFMeshInfo           &MeshInfo = Meshes[MeshIndex];
+
+      WriteGLTFPositions(&Writer,MeshInfo.Positions,MeshInfo.VAttrCount,Options.Scale);
+
+      if (Options.ExportNormals)
+       {
+        WriteLE(&Writer,MeshInfo.Normals,MeshInfo.VAttrCount * 3,sizeof(float));
+       }
+
+      if (Options.ExportTexCoords)
+       {
+        WriteGLTFTexCoords(&Writer,MeshInfo.TexCoords,MeshInfo.VAttrCount);
+       }
+
+      WriteGLTFIndices(&Writer,&MeshInfo,Template,Geometry);
+
+      if (MeshInfo.InstanceCount > 0)
+       {
+        WriteGLTFPositions(&Writer,MeshInfo.Translations,MeshInfo.InstanceCount,Options.Scale);
+        WriteLE(&Writer,MeshInfo.Rotations,MeshInfo.InstanceCount * 4,sizeof(float));
+
+        if (MeshInfo.Scales != 0)
+         {
+          WriteLE(&Writer,MeshInfo.Scales,MeshInfo.InstanceCount * 3,sizeof(float));
+         }
+       }
+     }
+   }
+
+  if (!Writer.Close())
+   {
+    SetErrorMessage("unable to write file",FileName);
+
+    return(false);
+   }
+
+  return(true);
+ }
+
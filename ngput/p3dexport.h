@@ -0,0 +1,150 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#ifndef __P3DEXPORT_H__
+#define __P3DEXPORT_H__
+
+#include <stdio.h>
+
+#include <string>
+
+#include <ngpcore/p3dhli.h>
+
+#include <ngput/p3dgeomcache.h>
+
+/* Instancing modes. Exporters which support instancing write cloneable */
+/* groups as single mesh plus per-branch transforms. RIGID mode is used  */
+/* only for groups which are cloneable without scaling, SCALED mode also */
+/* covers groups where each branch has its own uniform scale factor.     */
+
+#define P3D_EXPORT_INSTANCING_NONE   (0)
+#define P3D_EXPORT_INSTANCING_RIGID  (1)
+#define P3D_EXPORT_INSTANCING_SCALED (2)
+
+class P3DExportOptions
+ {
+  public           :
+
+                   P3DExportOptions   ();
+
+  float                                Scale;
+  bool                                 ExportNormals;
+  bool                                 ExportTexCoords;
+  unsigned int                         Instancing;
+ };
+
+/* Exporters write geometry of all non-empty branch groups. Geometry is */
+/* taken from P3DCachedPlantGeometry, so it can come from geometry      */
+/* cache. If Geometry is NULL, it is generated using Instance.          */
+/* Instance is also required for instanced export, without it all       */
+/* groups are exported as plain geometry.                               */
+
+class P3DPlantExporter
+ {
+  public           :
+
+                   P3DPlantExporter   ();
+  virtual         ~P3DPlantExporter   () {};
+
+  void             SetOptions         (const P3DExportOptions
+                                                          *Options);
+  const
+  P3DExportOptions*GetOptions         () const;
+
+  bool             Export             (const char         *FileName,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance,
+                                       const P3DCachedPlantGeometry
+                                                          *Geometry = 0);
+
+  const char      *GetErrorMessage    () const;
+
+  protected        :
+
+  virtual bool     ExportGeometry     (const char         *FileName,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance,
+                                       const P3DCachedPlantGeometry
+                                                          *Geometry) = 0;
+
+  void             SetErrorMessage    (const char         *Message,
+                                       const char         *FileName = 0);
+
+  bool             IsInstancedGroup   (const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance,
+                                       unsigned int        GroupIndex) const;
+
+  P3DExportOptions                     Options;
+  std::string                          ErrorMessage;
+ };
+
+/* Wavefront OBJ, materials are written into .mtl file with the same base */
+/* name. All groups are written in indexed mode with triangle faces.      */
+/* OBJ has no instancing support, so instancing mode is ignored.          */
+
+class P3DPlantExporterOBJ : public P3DPlantExporter
+ {
+  protected        :
+
+  virtual bool     ExportGeometry     (const char         *FileName,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance,
+                                       const P3DCachedPlantGeometry
+                                                          *Geometry);
+ };
+
+/* Binary glTF 2.0 (.glb). Each non-empty group is exported as separate */
+/* mesh, textures are referenced by their names as external images.     */
+/* Instanced groups use EXT_mesh_gpu_instancing extension.              */
+
+class P3DPlantExporterGLTF : public P3DPlantExporter
+ {
+  protected        :
+
+  virtual bool     ExportGeometry     (const char         *FileName,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance,
+                                       const P3DCachedPlantGeometry
+                                                          *Geometry);
+ };
+
+#endif
+
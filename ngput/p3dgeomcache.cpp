@@ -0,0 +1,1053 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#ifdef _WIN32
+ #include <windows.h>
+ #include <sys/types.h>
+ #include <sys/utime.h>
+ #include <process.h>
+#else
+ #include <sys/types.h>
+ #include <sys/stat.h>
+ #include <dirent.h>
+ #include <unistd.h>
+ #include <utime.h>
+#endif
+
+#include <ngpcore/p3dcompat.h>
+#include <ngpcore/p3dhli.h>
+#include <ngpcore/p3dhash.h>
+#include <ngpcore/p3diostreamadd.h>
+
+#include <ngput/p3dospath.h>
+#include <ngput/p3dgeomcache.h>
+
+#define P3DGeomCacheFormatVersion (1)
+#define P3DGeomCacheBlockSize     (16 * 1024) /* in floats */
+
+static const char  P3DGeomCacheMagic[4]     = { 'N', 'G', 'G', 'C' };
+static const char  P3DGeomCacheFilePrefix[] = "ngp-";
+static const char  P3DGeomCacheFileSuffix[] = ".geom";
+
+typedef struct
+ {
+  char             Magic[4];
+  P3Duint32        Version;
+  P3Duint32        KeyLo;
+  P3Duint32        KeyHi;
+  P3Duint32        DataSize;
+  P3Duint32        GroupCount;
+  float            BBoxMin[3];
+  float            BBoxMax[3];
+ } P3DGeomCacheHeader;
+
+typedef struct
+ {
+  P3Duint32        BranchCount;
+  P3Duint32        VAttrCountI;
+  P3Duint32        IndexCount;
+  P3Duint32        IndexOffset;
+  P3Duint32        AttrOffsets[P3D_MAX_ATTRS]; /* 0 - attribute not stored */
+ } P3DGeomCacheGroupHeader;
+
+static unsigned int GetAttrComponentCount
+                                      (unsigned int        Attr)
+ {
+  return(Attr == P3D_ATTR_TEXCOORD0 ? 2 : 3);
+ }
+
+                   P3DCachedPlantGeometry::P3DCachedPlantGeometry
+                                      ()
+ {
+  OwnedData = 0;
+  Data      = 0;
+  DataSize  = 0;
+  FromCache = false;
+ }
+
+                   P3DCachedPlantGeometry::~P3DCachedPlantGeometry
+                                      ()
+ {
+  free(OwnedData);
+ }
+
+bool               P3DCachedPlantGeometry::Attach
+                                      (const void         *Data,
+                                       unsigned int        DataSize,
+                                       P3Duint64           Key)
+ {
+  const P3DGeomCacheHeader            *Header;
+  const P3DGeomCacheGroupHeader       *GroupHeader;
+  unsigned int                         GroupIndex;
+  unsigned int                         AttrIndex;
+  unsigned int                         HeadersSize;
+  P3Duint64                            VAttrCount;
+  P3Duint64                            IndexCount;
+
+  if ((Data == 0) || (DataSize < sizeof(P3DGeomCacheHeader)))
+   {
+    return(false);
+   }
+
+  Header = (const P3DGeomCacheHeader*)Data;
+
+  if ((memcmp(Header->Magic,P3DGeomCacheMagic,sizeof(P3DGeomCacheMagic)) != 0) ||
+      (Header->Version  != P3DGeomCacheFormatVersion) ||
+      (Header->KeyLo    != (P3Duint32)(Key & 0xFFFFFFFF)) ||
+      (Header->KeyHi    != (P3Duint32)(Key >> 32)) ||
+      (Header->DataSize != DataSize))
+   {
+    return(false);
+   }
+
+  /* checked before multiplication, so headers size can not overflow */
+  if (Header->GroupCount > (DataSize - sizeof(P3DGeomCacheHeader)) /
+                            sizeof(P3DGeomCacheGroupHeader))
+   {
+    return(false);
+   }
+
+  HeadersSize = sizeof(P3DGeomCacheHeader) +
+                Header->GroupCount * sizeof(P3DGeomCacheGroupHeader);
+
+  GroupHeader = (const P3DGeomCacheGroupHeader*)(Header + 1);
+
+  for (GroupIndex = 0; GroupIndex < Header->GroupCount; GroupIndex++)
+   {
+    VAttrCount = (P3Duint64)GroupHeader->VAttrCountI * GroupHeader->BranchCount;
+    IndexCount = (P3Duint64)GroupHeader->IndexCount  * GroupHeader->BranchCount;
+
+    for (AttrIndex = 0; AttrIndex < P3D_MAX_ATTRS; AttrIndex++)
+     {
+      if (GroupHeader->AttrOffsets[AttrIndex] != 0)
+       {
+        if ((GroupHeader->AttrOffsets[AttrIndex] % 4 != 0) ||
+            (GroupHeader->AttrOffsets[AttrIndex] < HeadersSize) ||
+            (GroupHeader->AttrOffsets[AttrIndex] +
+              VAttrCount * GetAttrComponentCount(AttrIndex) * sizeof(float) > DataSize))
+         {
+          return(false);
+         }
+       }
+     }
+
+    if ((GroupHeader->IndexOffset % 4 != 0) ||
+        (GroupHeader->IndexOffset < HeadersSize) ||
+        (GroupHeader->IndexOffset + IndexCount * sizeof(P3Duint32) > DataSize))
+     {
+      return(false);
+     }
+
+    GroupHeader++;
+   }
+
+  this->Data     = (const char*)Data;
+  this->DataSize = DataSize;
+
+  return(true);
+ }
+
+const void        *P3DCachedPlantGeometry::GetGroupHeader
+                                      (unsigned int        GroupIndex) const
+ {
+  if (GroupIndex >= GetGroupCount())
+   {
+    throw P3DExceptionGeneric("group index out of range");
+   }
+
+  return(&(((const P3DGeomCacheGroupHeader*)(Data + sizeof(P3DGeomCacheHeader)))[GroupIndex]));
+ }
+
+unsigned int       P3DCachedPlantGeometry::GetGroupCount
+                                      () const
+ {
+  return(((const P3DGeomCacheHeader*)Data)->GroupCount);
+ }
+
+unsigned int       P3DCachedPlantGeometry::GetBranchCount
+                                      (unsigned int        GroupIndex) const
+ {
+  return(((const P3DGeomCacheGroupHeader*)GetGroupHeader(GroupIndex))->BranchCount);
+ }
+
+void               P3DCachedPlantGeometry::GetBoundingBox
+                                      (float              *Min,
+                                       float              *Max) const
+ {
+  const P3DGeomCacheHeader            *Header;
+
+  Header = (const P3DGeomCacheHeader*)Data;
+
+  Min[0] = Header->BBoxMin[0]; Min[1] = Header->BBoxMin[1]; Min[2] = Header->BBoxMin[2];
+  Max[0] = Header->BBoxMax[0]; Max[1] = Header->BBoxMax[1]; Max[2] = Header->BBoxMax[2];
+ }
+
+unsigned int       P3DCachedPlantGeometry::GetVAttrCountI
+                                      (unsigned int        GroupIndex) const
+ {
+  return(((const P3DGeomCacheGroupHeader*)GetGroupHeader(GroupIndex))->VAttrCountI);
+ }
+
+unsigned int       P3DCachedPlantGeometry::GetIndexCount
+                                      (unsigned int        GroupIndex) const
+ {
+  return(((const P3DGeomCacheGroupHeader*)GetGroupHeader(GroupIndex))->IndexCount);
+ }
+
+bool               P3DCachedPlantGeometry::HasAttr
+                                      (unsigned int        GroupIndex,
+                                       unsigned int        Attr) const
+ {
+  if (Attr >= P3D_MAX_ATTRS)
+   {
+    return(false);
+   }
+
+  return(((const P3DGeomCacheGroupHeader*)GetGroupHeader(GroupIndex))->AttrOffsets[Attr] != 0);
+ }
+
+const float       *P3DCachedPlantGeometry::GetVAttrBufferI
+                                      (unsigned int        GroupIndex,
+                                       unsigned int        Attr) const
+ {
+  if (!HasAttr(GroupIndex,Attr))
+   {
+    throw P3DExceptionGeneric("attribute is not available in cached geometry");
+   }
+
+  return((const float*)(Data + ((const P3DGeomCacheGroupHeader*)GetGroupHeader(GroupIndex))->AttrOffsets[Attr]));
+ }
+
+void               P3DCachedPlantGeometry::FillVAttrBuffersI
+                                      (const P3DHLIVAttrBuffers
+                                                          *VAttrBuffers,
+                                       unsigned int        GroupIndex) const
+ {
+  const P3DGeomCacheGroupHeader       *GroupHeader;
+  unsigned int                         AttrIndex;
+  unsigned int                         VAttrIndex;
+  unsigned int                         VAttrCount;
+  unsigned int                         ValueSize;
+  unsigned int                         Stride;
+  const char                          *Source;
+  char                                *Target;
+
+  GroupHeader = (const P3DGeomCacheGroupHeader*)GetGroupHeader(GroupIndex);
+  VAttrCount  = GroupHeader->VAttrCountI * GroupHeader->BranchCount;
+
+  for (AttrIndex = 0; AttrIndex < P3D_MAX_ATTRS; AttrIndex++)
+   {
+    if (VAttrBuffers->HasAttr(AttrIndex))
+     {
+      Source    = (const char*)GetVAttrBufferI(GroupIndex,AttrIndex);
+      Target    = &((char*)VAttrBuffers->GetAttrBuffer(AttrIndex))[VAttrBuffers->GetAttrOffset(AttrIndex)];
+      ValueSize = GetAttrComponentCount(AttrIndex) * sizeof(float);
+      Stride    = VAttrBuffers->GetAttrStride(AttrIndex);
+
+      if (Stride == ValueSize)
+       {
+        memcpy(Target,Source,VAttrCount * ValueSize);
+       }
+      else
+       {
+        for (VAttrIndex = 0; VAttrIndex < VAttrCount; VAttrIndex++)
+         {
+          memcpy(Target,Source,ValueSize);
+
+          Target += Stride;
+          Source += ValueSize;
+         }
+       }
+     }
+   }
+ }
+
+void               P3DCachedPlantGeometry::FillIndexBuffer
+                                      (void               *IndexBuffer,
+                                       unsigned int        GroupIndex,
+                                       unsigned int        ElementType,
+                                       unsigned int        IndexBase) const
+ {
+  const P3DGeomCacheGroupHeader       *GroupHeader;
+  const P3Duint32                     *Source;
+  unsigned int                         Index;
+  unsigned int                         IndexCount;
+
+  GroupHeader = (const P3DGeomCacheGroupHeader*)GetGroupHeader(GroupIndex);
+  Source      = (const P3Duint32*)(Data + GroupHeader->IndexOffset);
+  IndexCount  = GroupHeader->IndexCount * GroupHeader->BranchCount;
+
+  if      (ElementType == P3D_UNSIGNED_INT)
+   {
+    unsigned int *Target = (unsigned int*)IndexBuffer;
+
+    if (IndexBase == 0)
+     {
+      memcpy(Target,Source,IndexCount * sizeof(P3Duint32));
+     }
+    else
+     {
+      for (Index = 0; Index < IndexCount; Index++)
+       {
+        Target[Index] = Source[Index] + IndexBase;
+       }
+     }
+   }
+  else if (ElementType == P3D_UNSIGNED_SHORT)
+   {
+    unsigned short *Target = (unsigned short*)IndexBuffer;
+
+    for (Index = 0; Index < IndexCount; Index++)
+     {
+      Target[Index] = (unsigned short)(Source[Index] + IndexBase);
+     }
+   }
+  else
+   {
+    throw P3DExceptionGeneric("unsupported index element type");
+   }
+ }
+
+bool               P3DCachedPlantGeometry::IsFromCache
+                                      () const
+ {
+  return(FromCache);
+ }
+
+typedef struct
+ {
+  const float     *Values;
+  unsigned int     Size;
+ } P3DGeomCacheValueChunk;
+
+/* collects vertex attributes of all groups during single plant traversal, */
+/* so branch counts do not have to be calculated by a separate traversal.   */
+/* Values are stored in fixed size blocks, which, unlike growing arrays,    */
+/* stay below malloc's mmap threshold and do not need to be zeroed/moved   */
+class P3DGeomCacheCollector : public P3DHLIBranchVisitor
+ {
+  public           :
+
+                   P3DGeomCacheCollector
+                                      (unsigned int        GroupCount)
+   : BranchCounts(GroupCount,0),
+     AttrEnabled(GroupCount * P3D_MAX_ATTRS,false),
+     Chunks(GroupCount * P3D_MAX_ATTRS)
+   {
+    Block     = 0;
+    BlockUsed = 0;
+   }
+
+                  ~P3DGeomCacheCollector
+                                      ()
+   {
+    for (unsigned int BlockIndex = 0; BlockIndex < Blocks.size(); BlockIndex++)
+     {
+      delete[] Blocks[BlockIndex];
+     }
+   }
+
+  void             EnableAttr         (unsigned int        GroupIndex,
+                                       unsigned int        Attr)
+   {
+    AttrEnabled[GroupIndex * P3D_MAX_ATTRS + Attr] = true;
+   }
+
+  bool             IsAttrEnabled      (unsigned int        GroupIndex,
+                                       unsigned int        Attr) const
+   {
+    return(AttrEnabled[GroupIndex * P3D_MAX_ATTRS + Attr]);
+   }
+
+  unsigned int     GetBranchCount     (unsigned int        GroupIndex) const
+   {
+    return(BranchCounts[GroupIndex]);
+   }
+
+  /* copies values of all branches in traversal order */
+  void             CopyValues         (float              *Dest,
+                                       unsigned int        GroupIndex,
+                                       unsigned int        Attr) const
+   {
+    const std::vector<P3DGeomCacheValueChunk>
+                                      &AttrChunks = Chunks[GroupIndex * P3D_MAX_ATTRS + Attr];
+
+    for (unsigned int ChunkIndex = 0; ChunkIndex < AttrChunks.size(); ChunkIndex++)
+     {
+      memcpy(Dest,AttrChunks[ChunkIndex].Values,AttrChunks[ChunkIndex].Size * sizeof(float));
+
+      Dest += AttrChunks[ChunkIndex].Size;
+     }
+   }
+
+  virtual void     VisitBranch        (unsigned int        GroupIndex,
+                                       const P3DStemModelInstance
+                                                          *Instance)
+   {
+    unsigned int                       VAttrCount;
+
+    BranchCounts[GroupIndex]++;
+
+    VAttrCount = Instance->GetVAttrCountI();
+
+    for (unsigned int AttrIndex = 0; AttrIndex < P3D_MAX_ATTRS; AttrIndex++)
+     {
+      if (IsAttrEnabled(GroupIndex,AttrIndex))
+       {
+        P3DGeomCacheValueChunk         Chunk;
+        float                         *Values;
+        unsigned int                   ComponentCount;
+
+        ComponentCount = GetAttrComponentCount(AttrIndex);
+        Chunk.Size     = VAttrCount * ComponentCount;
+        Values         = Allocate(Chunk.Size);
+        Chunk.Values   = Values;
+
+        Instance->FillVAttrBufferI(Values,AttrIndex);
+
+        Chunks[GroupIndex * P3D_MAX_ATTRS + AttrIndex].push_back(Chunk);
+       }
+     }
+   }
+
+  private          :
+
+  float           *Allocate           (unsigned int        Size)
+   {
+    float                             *Result;
+
+    if (Size > P3DGeomCacheBlockSize)
+     {
+      Result = new float[Size];
+
+      Blocks.push_back(Result);
+     }
+    else
+     {
+      if ((Block == 0) || (BlockUsed + Size > P3DGeomCacheBlockSize))
+       {
+        Block = new float[P3DGeomCacheBlockSize];
+
+        Blocks.push_back(Block);
+
+        BlockUsed = 0;
+       }
+
+      Result     = &Block[BlockUsed];
+      BlockUsed += Size;
+     }
+
+    return(Result);
+   }
+
+                   P3DGeomCacheCollector
+                                      (const P3DGeomCacheCollector
+                                                          &);
+  void             operator =         (const P3DGeomCacheCollector
+                                                          &);
+
+  std::vector<unsigned int>            BranchCounts;
+  std::vector<bool>                    AttrEnabled;
+  std::vector<std::vector<P3DGeomCacheValueChunk> >
+                                       Chunks;
+  std::vector<float*>                  Blocks;
+  float                               *Block;
+  unsigned int                         BlockUsed;
+ };
+
+static char       *GenerateGeometry   (unsigned int       *DataSize,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance,
+                                       P3Duint64           Key,
+                                       unsigned int        AttrMask,
+                                       bool                CalcBBox)
+ {
+  unsigned int                         GroupIndex;
+  unsigned int                         GroupCount;
+  unsigned int                         AttrIndex;
+  unsigned int                         BranchIndex;
+  P3Duint64                            Offset;
+  std::vector<P3DGeomCacheGroupHeader> GroupHeaders;
+  P3DGeomCacheHeader                  *Header;
+  char                                *Data;
+
+  GroupCount = Template->GetGroupCount();
+  Data       = 0;
+
+  P3DGeomCacheCollector                Collector(GroupCount);
+
+  for (GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
+   {
+    bool                               Billboard;
+
+    Billboard = Template->GetMaterial(GroupIndex)->IsBillboard();
+
+    for (AttrIndex = 0; AttrIndex < P3D_MAX_ATTRS; AttrIndex++)
+     {
+      if (((AttrMask & (1 << AttrIndex)) != 0) &&
+          ((AttrIndex != P3D_ATTR_BILLBOARD_POS) || (Billboard)))
+       {
+        Collector.EnableAttr(GroupIndex,AttrIndex);
+       }
+     }
+   }
+
+  if (GroupCount > 0)
+   {
+    Instance->VisitBranches(&Collector);
+   }
+
+  try
+   {
+    GroupHeaders.resize(GroupCount + 1);
+
+    Offset = sizeof(P3DGeomCacheHeader) + GroupCount * sizeof(P3DGeomCacheGroupHeader);
+
+    for (GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
+     {
+      P3DGeomCacheGroupHeader         &GroupHeader = GroupHeaders[GroupIndex];
+
+      GroupHeader.BranchCount = Collector.GetBranchCount(GroupIndex);
+      GroupHeader.VAttrCountI = Template->GetVAttrCountI(GroupIndex);
+      GroupHeader.IndexCount  = Template->GetIndexCount(GroupIndex,P3D_TRIANGLE_LIST);
+
+      for (AttrIndex = 0; AttrIndex < P3D_MAX_ATTRS; AttrIndex++)
+       {
+        if (Collector.IsAttrEnabled(GroupIndex,AttrIndex))
+         {
+          GroupHeader.AttrOffsets[AttrIndex] = (P3Duint32)Offset;
+
+          Offset += (P3Duint64)GroupHeader.VAttrCountI * GroupHeader.BranchCount *
+                     GetAttrComponentCount(AttrIndex) * sizeof(float);
+         }
+        else
+         {
+          GroupHeader.AttrOffsets[AttrIndex] = 0;
+         }
+       }
+
+      GroupHeader.IndexOffset = (P3Duint32)Offset;
+
+      Offset += (P3Duint64)GroupHeader.IndexCount * GroupHeader.BranchCount * sizeof(P3Duint32);
+     }
+
+    if (Offset > 0xFFFFFFFFULL)
+     {
+      throw P3DExceptionGeneric("generated geometry is too large");
+     }
+
+    Data = (char*)malloc((size_t)Offset);
+
+    if (Data == 0)
+     {
+      throw P3DExceptionGeneric("out of memory");
+     }
+
+    *DataSize = (unsigned int)Offset;
+
+    Header = (P3DGeomCacheHeader*)Data;
+
+    memcpy(Header->Magic,P3DGeomCacheMagic,sizeof(P3DGeomCacheMagic));
+
+    Header->Version    = P3DGeomCacheFormatVersion;
+    Header->KeyLo      = (P3Duint32)(Key & 0xFFFFFFFF);
+    Header->KeyHi      = (P3Duint32)(Key >> 32);
+    Header->DataSize   = *DataSize;
+    Header->GroupCount = GroupCount;
+
+    if (CalcBBox)
+     {
+      Instance->GetBoundingBox(Header->BBoxMin,Header->BBoxMax);
+     }
+    else
+     {
+      memset(Header->BBoxMin,0,sizeof(Header->BBoxMin));
+      memset(Header->BBoxMax,0,sizeof(Header->BBoxMax));
+     }
+
+    if (GroupCount > 0)
+     {
+      memcpy(Header + 1,&GroupHeaders[0],GroupCount * sizeof(P3DGeomCacheGroupHeader));
+     }
+
+    for (GroupIndex = 0; GroupIndex < GroupCount; GroupIndex++)
+     {
+      const P3DGeomCacheGroupHeader   &GroupHeader = GroupHeaders[GroupIndex];
+      P3Duint32                       *IndexBuffer;
+
+      for (AttrIndex = 0; AttrIndex < P3D_MAX_ATTRS; AttrIndex++)
+       {
+        if (Collector.IsAttrEnabled(GroupIndex,AttrIndex))
+         {
+          Collector.CopyValues((float*)(Data + GroupHeader.AttrOffsets[AttrIndex]),
+                               GroupIndex,
+                               AttrIndex);
+         }
+       }
+
+      IndexBuffer = (P3Duint32*)(Data + GroupHeader.IndexOffset);
+
+      /* all branches of a group share the same topology, so indices */
+      /* of the first one are offset for the rest                    */
+      if (GroupHeader.BranchCount > 0)
+       {
+        Template->FillIndexBuffer(IndexBuffer,
+                                  GroupIndex,
+                                  P3D_TRIANGLE_LIST,
+                                  P3D_UNSIGNED_INT,
+                                  0);
+       }
+
+      for (BranchIndex = 1; BranchIndex < GroupHeader.BranchCount; BranchIndex++)
+       {
+        P3Duint32                     *Target;
+        P3Duint32                      IndexBase;
+
+        Target    = &IndexBuffer[BranchIndex * GroupHeader.IndexCount];
+        IndexBase = BranchIndex * GroupHeader.VAttrCountI;
+
+        for (unsigned int Index = 0; Index < GroupHeader.IndexCount; Index++)
+         {
+          Target[Index] = IndexBuffer[Index] + IndexBase;
+         }
+       }
+     }
+   }
+  catch (...)
+   {
+    free(Data);
+
+    throw;
+   }
+
+  return(Data);
+ }
+
+P3DCachedPlantGeometry
+                  *P3DCachedPlantGeometry::Generate
+                                      (const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance,
+                                       unsigned int        AttrMask,
+                                       bool                CalcBBox)
+ {
+  P3DCachedPlantGeometry              *Result;
+  unsigned int                         DataSize;
+
+  Result = new P3DCachedPlantGeometry();
+
+  try
+   {
+    Result->OwnedData = GenerateGeometry(&DataSize,Template,Instance,0,AttrMask,CalcBBox);
+
+    Result->Attach(Result->OwnedData,DataSize,0);
+   }
+  catch (...)
+   {
+    delete Result;
+
+    throw;
+   }
+
+  return(Result);
+ }
+
+                   P3DGeometryCache::P3DGeometryCache
+                                      (const char         *CacheDir,
+                                       P3Duint64           MaxSize)
+                   : CacheDir(CacheDir)
+ {
+  this->MaxSize = MaxSize;
+
+  ResetStats();
+ }
+
+void               P3DGeometryCache::SetMaxSize
+                                      (P3Duint64           MaxSize)
+ {
+  this->MaxSize = MaxSize;
+ }
+
+P3Duint64          P3DGeometryCache::GetMaxSize
+                                      () const
+ {
+  return(MaxSize);
+ }
+
+unsigned int       P3DGeometryCache::GetHitCount
+                                      () const
+ {
+  return(HitCount);
+ }
+
+unsigned int       P3DGeometryCache::GetMissCount
+                                      () const
+ {
+  return(MissCount);
+ }
+
+unsigned int       P3DGeometryCache::GetEvictionCount
+                                      () const
+ {
+  return(EvictionCount);
+ }
+
+unsigned int       P3DGeometryCache::GetWriteErrorCount
+                                      () const
+ {
+  return(WriteErrorCount);
+ }
+
+void               P3DGeometryCache::ResetStats
+                                      ()
+ {
+  HitCount        = 0;
+  MissCount       = 0;
+  EvictionCount   = 0;
+  WriteErrorCount = 0;
+ }
+
+P3Duint64          P3DGeometryCache::CalcKey
+                                      (const P3DHLIPlantTemplate
+                                                          *Template,
+                                       unsigned int        BaseSeed)
+ {
+  P3DHash                              Key;
+
+  if (BaseSeed == 0)
+   {
+    BaseSeed = Template->GetModel()->GetBaseSeed();
+   }
+
+  Key.AddUInt64(Template->GetModel()->ComputeHash());
+  Key.AddUInt(BaseSeed);
+  Key.AddBool(Template->IsDummiesEnabled());
+  Key.AddUInt(P3DGeomCacheFormatVersion);
+
+  return(Key.GetValue());
+ }
+
+std::string        P3DGeometryCache::GetEntryFileName
+                                      (P3Duint64           Key) const
+ {
+  char                                 NameBuffer[64];
+
+  snprintf(NameBuffer,sizeof(NameBuffer),"%s%08x%08x%s",
+           P3DGeomCacheFilePrefix,
+           (unsigned int)(Key >> 32),
+           (unsigned int)(Key & 0xFFFFFFFF),
+           P3DGeomCacheFileSuffix);
+
+  return(P3DPathName::JoinPaths(CacheDir.c_str(),NameBuffer));
+ }
+
+P3DCachedPlantGeometry
+                  *P3DGeometryCache::GetGeometry
+                                      (const P3DHLIPlantTemplate
+                                                          *Template,
+                                       unsigned int        BaseSeed)
+ {
+  P3DCachedPlantGeometry              *Result;
+  P3Duint64                            Key;
+  std::string                          FileName;
+
+  Key      = CalcKey(Template,BaseSeed);
+  FileName = GetEntryFileName(Key);
+  Result   = new P3DCachedPlantGeometry();
+
+  try
+   {
+    Result->Mapping.Open(FileName.c_str());
+   }
+  catch (P3DExceptionIO &)
+   {
+   }
+
+  if (Result->Attach(Result->Mapping.GetData(),Result->Mapping.GetSize(),Key))
+   {
+    Result->FromCache = true;
+
+    HitCount++;
+
+    /* update modification time to keep LRU order */
+    utime(FileName.c_str(),NULL);
+
+    return(Result);
+   }
+
+  Result->Mapping.Close();
+
+  MissCount++;
+
+  try
+   {
+    P3DHLIPlantInstance               *Instance;
+    unsigned int                       DataSize;
+
+    Instance = Template->CreateInstance(BaseSeed);
+
+    try
+     {
+      Result->OwnedData = GenerateGeometry(&DataSize,Template,Instance,Key,P3D_GEOM_ALL_ATTRS,true);
+     }
+    catch (...)
+     {
+      delete Instance;
+
+      throw;
+     }
+
+    delete Instance;
+
+    Result->Attach(Result->OwnedData,DataSize,Key);
+
+    if (StoreEntry(Key,Result->OwnedData,DataSize))
+     {
+      Evict(FileName);
+     }
+    else
+     {
+      WriteErrorCount++;
+     }
+   }
+  catch (...)
+   {
+    delete Result;
+
+    throw;
+   }
+
+  return(Result);
+ }
+
+bool               P3DGeometryCache::StoreEntry
+                                      (P3Duint64           Key,
+                                       const char         *Data,
+                                       unsigned int        DataSize)
+ {
+  std::string                          FileName;
+  std::string                          TempFileName;
+  char                                 Suffix[32];
+  FILE                                *Target;
+  bool                                 Result;
+
+  FileName = GetEntryFileName(Key);
+
+  #ifdef _WIN32
+  snprintf(Suffix,sizeof(Suffix),".%d.tmp",(int)_getpid());
+  #else
+  snprintf(Suffix,sizeof(Suffix),".%d.tmp",(int)getpid());
+  #endif
+
+  /* write to temporary file first, so concurrent readers never see */
+  /* partially written entries                                       */
+  TempFileName = FileName + Suffix;
+
+  Target = fopen(TempFileName.c_str(),"wb");
+
+  if (Target == NULL)
+   {
+    return(false);
+   }
+
+  Result = fwrite(Data,1,DataSize,Target) == DataSize;
+
+  if (fclose(Target) != 0)
+   {
+    Result = false;
+   }
+
+  if (Result)
+   {
+    #ifdef _WIN32
+    Result = MoveFileExA(TempFileName.c_str(),FileName.c_str(),MOVEFILE_REPLACE_EXISTING) != 0;
+    #else
+    Result = rename(TempFileName.c_str(),FileName.c_str()) == 0;
+    #endif
+   }
+
+  if (!Result)
+   {
+    remove(TempFileName.c_str());
+   }
+
+  return(Result);
+ }
+
+typedef struct
+ {
+  std::string      FileName;
+  P3Duint64        Size;
+  P3Duint64        Time;
+ } P3DGeomCacheEntryInfo;
+
+static bool        IsOlderEntry       (const P3DGeomCacheEntryInfo
+                                                          &Entry1,
+                                       const P3DGeomCacheEntryInfo
+                                                          &Entry2)
+ {
+  return(Entry1.Time < Entry2.Time);
+ }
+
+static bool        IsCacheEntryName   (const char         *Name)
+ {
+  size_t                               NameLen;
+  size_t                               PrefixLen;
+  size_t                               SuffixLen;
+
+  NameLen   = strlen(Name);
+  PrefixLen = sizeof(P3DGeomCacheFilePrefix) - 1;
+  SuffixLen = sizeof(P3DGeomCacheFileSuffix) - 1;
+
+  return((NameLen > PrefixLen + SuffixLen) &&
+         (memcmp(Name,P3DGeomCacheFilePrefix,PrefixLen) == 0) &&
+         (strcmp(&Name[NameLen - SuffixLen],P3DGeomCacheFileSuffix) == 0));
+ }
+
+static void        ListCacheEntries   (std::vector<P3DGeomCacheEntryInfo>
+                                                          &Entries,
+                                       const std::string  &CacheDir)
+ {
+  P3DGeomCacheEntryInfo                Entry;
+
+  #ifdef _WIN32
+  WIN32_FIND_DATAA                     FindData;
+  HANDLE                               FindHandle;
+  std::string                          Pattern;
+
+  Pattern = P3DPathName::JoinPaths(CacheDir.c_str(),"*");
+
+  FindHandle = FindFirstFileA(Pattern.c_str(),&FindData);
+
+  if (FindHandle == INVALID_HANDLE_VALUE)
+   {
+    return;
+   }
+
+  do
+   {
+    if (IsCacheEntryName(FindData.cFileName))
+     {
+      Entry.FileName = P3DPathName::JoinPaths(CacheDir.c_str(),FindData.cFileName);
+      Entry.Size     = ((P3Duint64)FindData.nFileSizeHigh << 32) | FindData.nFileSizeLow;
+      Entry.Time     = ((P3Duint64)FindData.ftLastWriteTime.dwHighDateTime << 32) |
+                        FindData.ftLastWriteTime.dwLowDateTime;
+
+      Entries.push_back(Entry);
+     }
+   } while (FindNextFileA(FindHandle,&FindData));
+
+  FindClose(FindHandle);
+  #else
+  DIR                                 *Dir;
+  struct dirent                       *DirEntry;
+  struct stat                          FileStat;
+
+  Dir = opendir(CacheDir.c_str());
+
+  if (Dir == NULL)
+   {
+    return;
+   }
+
+  while ((DirEntry = readdir(Dir)) != NULL)
+   {
+    if (IsCacheEntryName(DirEntry->d_name))
+     {
+      Entry.FileName = P3DPathName::JoinPaths(CacheDir.c_str(),DirEntry->d_name);
+
+      if (stat(Entry.FileName.c_str(),&FileStat) == 0)
+       {
+        Entry.Size = (P3Duint64)FileStat.st_size;
+        Entry.Time = (P3Duint64)FileStat.st_mtime;
+
+        Entries.push_back(Entry);
+       }
+     }
+   }
+
+  closedir(Dir);
+  #endif
+ }
+
+void               P3DGeometryCache::Evict
+                                      (const std::string  &KeepFileName)
+ {
+  std::vector<P3DGeomCacheEntryInfo>   Entries;
+  P3Duint64                            TotalSize;
+  unsigned int                         Index;
+
+  if (MaxSize == 0)
+   {
+    return; /* unlimited */
+   }
+
+  ListCacheEntries(Entries,CacheDir);
+
+  TotalSize = 0;
+
+  for (Index = 0; Index < Entries.size(); Index++)
+   {
+    TotalSize += Entries[Index].Size;
+   }
+
+  if (TotalSize <= MaxSize)
+   {
+    return;
+   }
+
+  std::sort(Entries.begin(),Entries.end(),IsOlderEntry);
+
+  for (Index = 0; (Index < Entries.size()) && (TotalSize > MaxSize); Index++)
+   {
+    if (Entries[Index].FileName != KeepFileName)
+     {
+      if (remove(Entries[Index].FileName.c_str()) == 0)
+       {
+        TotalSize -= Entries[Index].Size;
+
+        EvictionCount++;
+       }
+     }
+   }
+ }
+
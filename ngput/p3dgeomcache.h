@@ -0,0 +1,169 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#ifndef __P3DGEOMCACHE_H__
+#define __P3DGEOMCACHE_H__
+
+#include <string>
+
+#include <ngpcore/p3dtypes.h>
+#include <ngpcore/p3dhli.h>
+#include <ngpcore/p3diostreamadd.h>
+
+#define P3D_GEOM_ALL_ATTRS ((1 << P3D_MAX_ATTRS) - 1)
+
+/* Generated plant geometry, either mapped from cache file or generated  */
+/* in memory. Vertex attributes are stored in indexed mode for all       */
+/* branches of each group, index buffers are stored as triangle lists.   */
+
+class P3DCachedPlantGeometry
+ {
+  public           :
+
+                  ~P3DCachedPlantGeometry
+                                      ();
+
+  unsigned int     GetGroupCount      () const;
+  unsigned int     GetBranchCount     (unsigned int        GroupIndex) const;
+  void             GetBoundingBox     (float              *Min,
+                                       float              *Max) const;
+
+  /* per-branch counts, the same as in P3DHLIPlantTemplate */
+  unsigned int     GetVAttrCountI     (unsigned int        GroupIndex) const;
+  unsigned int     GetIndexCount      (unsigned int        GroupIndex) const;
+
+  bool             HasAttr            (unsigned int        GroupIndex,
+                                       unsigned int        Attr) const;
+
+  /* direct access to tightly packed attribute values of all branches */
+  const float     *GetVAttrBufferI    (unsigned int        GroupIndex,
+                                       unsigned int        Attr) const;
+
+  /* fill attribute values of all branches in group */
+  void             FillVAttrBuffersI  (const P3DHLIVAttrBuffers
+                                                          *VAttrBuffers,
+                                       unsigned int        GroupIndex) const;
+
+  /* fill triangle list indices of all branches in group */
+  void             FillIndexBuffer    (void               *IndexBuffer,
+                                       unsigned int        GroupIndex,
+                                       unsigned int        ElementType,
+                                       unsigned int        IndexBase = 0) const;
+
+  bool             IsFromCache        () const;
+
+  /* generate geometry in memory without using cache. Only attributes  */
+  /* with (1 << Attr) bit set in AttrMask are generated, bounding box   */
+  /* is left zeroed unless CalcBBox is true                             */
+  static
+  P3DCachedPlantGeometry
+                  *Generate           (const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance,
+                                       unsigned int        AttrMask = P3D_GEOM_ALL_ATTRS,
+                                       bool                CalcBBox = true);
+
+  private          :
+
+  friend class P3DGeometryCache;
+
+                   P3DCachedPlantGeometry
+                                      ();
+
+  bool             Attach             (const void         *Data,
+                                       unsigned int        DataSize,
+                                       P3Duint64           Key);
+
+  const void      *GetGroupHeader     (unsigned int        GroupIndex) const;
+
+  P3DInputStringStreamMMap             Mapping;
+  char                                *OwnedData;
+  const char                          *Data;
+  unsigned int                         DataSize;
+  bool                                 FromCache;
+ };
+
+/* Persistent on-disk cache of generated geometry. Each entry is stored  */
+/* in separate file inside cache directory, file name is derived from    */
+/* model content hash, seed and dummies flag. When total size of cache   */
+/* files exceeds the limit, least recently used entries are removed.     */
+
+class P3DGeometryCache
+ {
+  public           :
+
+                   P3DGeometryCache   (const char         *CacheDir,
+                                       P3Duint64           MaxSize);
+
+  /* return cached geometry or generate it (and store in cache) */
+  /* BaseSeed == 0 means "use model base seed" like in          */
+  /* P3DHLIPlantTemplate::CreateInstance                        */
+  P3DCachedPlantGeometry
+                  *GetGeometry        (const P3DHLIPlantTemplate
+                                                          *Template,
+                                       unsigned int        BaseSeed = 0);
+
+  void             SetMaxSize         (P3Duint64           MaxSize);
+  P3Duint64        GetMaxSize         () const;
+
+  unsigned int     GetHitCount        () const;
+  unsigned int     GetMissCount       () const;
+  unsigned int     GetEvictionCount   () const;
+  unsigned int     GetWriteErrorCount () const;
+
+  void             ResetStats         ();
+
+  static
+  P3Duint64        CalcKey            (const P3DHLIPlantTemplate
+                                                          *Template,
+                                       unsigned int        BaseSeed);
+
+  private          :
+
+  std::string      GetEntryFileName   (P3Duint64           Key) const;
+
+  bool             StoreEntry         (P3Duint64           Key,
+                                       const char         *Data,
+                                       unsigned int        DataSize);
+
+  void             Evict              (const std::string  &KeepFileName);
+
+  std::string                          CacheDir;
+  P3Duint64                            MaxSize;
+  unsigned int                         HitCount;
+  unsigned int                         MissCount;
+  unsigned int                         EvictionCount;
+  unsigned int                         WriteErrorCount;
+ };
+
+#endif
+
@@ -278,10 +278,11 @@ bool               P3DImageData::Copy (P3DImageData       *TargetImage,
 void               P3DImageData::FlipVertical
                                       ()
  {
-  unsigned int                         X;
   unsigned int                         Y;
-  P3DByte                              TopPixel[4];
-  P3DByte                              BotPixel[4];
+  unsigned int                         RowSize;
+  P3DByte                             *TempRow;
+  P3DByte                             *TopRow;
+  P3DByte                             *BotRow;
 
   if (Data == 0)
    {
@@ -293,16 +294,34 @@ void               P3DImageData::FlipVertical
     return;
    }
 
+  RowSize = Width * ChannelCount;
+  TempRow = (P3DByte*)malloc(RowSize);
+
+  if (TempRow == 0)
+   {
+    return;
+   }
+
   for (Y = 0; (Y < Height / 2); Y++)
    {
-    for (X = 0; X < Width; X++)
-     {
-      GetPixel(X,Y,TopPixel);
-      GetPixel(X,Height - Y - 1,BotPixel);
-      PutPixel(X,Y,BotPixel);
-      PutPixel(X,Height - Y - 1,TopPixel);
-     }
+    TopRow = (P3DByte*)Data + Y * RowSize;
+    BotRow = (P3DByte*)Data + (Height - Y - 1) * RowSize;
+
+    memcpy(TempRow,TopRow,RowSize);
+    memcpy(TopRow,BotRow,RowSize);
+    memcpy(BotRow,TempRow,RowSize);
    }
+
+  free(TempRow);
+ }
+
+bool               P3DImageFmtHandler::LoadImageDataMem
+                                      (P3DImageData       *ImageData P3D_UNUSED_ATTR,
+                                       const void         *Data P3D_UNUSED_ATTR,
+                                       unsigned int        Size P3D_UNUSED_ATTR,
+                                       const char         *FileExt P3D_UNUSED_ATTR) const
+ {
+  return(false);
  }
 
                    P3DImageFmtHandlerComposite::P3DImageFmtHandlerComposite
@@ -379,3 +398,25 @@ bool               P3DImageFmtHandlerComposite::LoadImageData
   return(false);
  }
 
+bool               P3DImageFmtHandlerComposite::LoadImageDataMem
+                                      (P3DImageData       *ImageData,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       const char         *FileExt) const
+ {
+  for (unsigned int HandlerIndex = 0; HandlerIndex < Handlers.size(); HandlerIndex++)
+   {
+    for (unsigned int FormatIndex = 0;
+         FormatIndex < Handlers[HandlerIndex]->FormatCount();
+         FormatIndex++)
+     {
+      if (strcmp(Handlers[HandlerIndex]->FormatExt(FormatIndex),FileExt) == 0)
+       {
+        return(Handlers[HandlerIndex]->LoadImageDataMem(ImageData,Data,Size,FileExt));
+       }
+     }
+   }
+
+  return(false);
+ }
+
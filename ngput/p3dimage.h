@@ -104,6 +104,14 @@ class P3DImageFmtHandler
   bool             LoadImageData      (P3DImageData       *ImageData,
                                        const char         *FileName,
                                        const char         *FileExt) const = 0;
+
+  /* decodes image from in-memory file contents, Data must stay valid */
+  /* during the call only; default implementation fails               */
+  virtual
+  bool             LoadImageDataMem   (P3DImageData       *ImageData,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       const char         *FileExt) const;
  };
 
 class P3DImageFmtHandlerComposite : public P3DImageFmtHandler
@@ -128,6 +136,12 @@ class P3DImageFmtHandlerComposite : public P3DImageFmtHandler
                                        const char         *FileName,
                                        const char         *FileExt) const;
 
+  virtual
+  bool             LoadImageDataMem   (P3DImageData       *ImageData,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       const char         *FileExt) const;
+
   private          :
 
   std::vector<P3DImageFmtHandler*>     Handlers;
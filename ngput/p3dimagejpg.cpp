@@ -72,25 +72,57 @@ typedef struct
 static void        JpegErrorHandlerFunc
                                       (j_common_ptr        HandlerData)
  {
-  longjmp(((JpegErrorHandlerStruct*)HandlerData)->SetJmpBuffer,1);
+  longjmp(((JpegErrorHandlerStruct*)HandlerData->err)->SetJmpBuffer,1);
  }
 
-bool               P3DImageFmtHandlerJPG::LoadImageData
-                                      (P3DImageData       *ImageData,
-                                       const char         *FileName,
-                                       const char         *FileExt P3D_UNUSED_ATTR) const
+static void        JpegMemInitSource  (j_decompress_ptr    JpegInfo P3D_UNUSED_ATTR)
  {
-  bool                                 Result;
-  FILE                                *Source;
-  struct jpeg_decompress_struct        JpegInfo;
-  JpegErrorHandlerStruct               JpegErrorHandler;
+ }
 
-  Source = fopen(FileName,"rb");
+static boolean     JpegMemFillInputBuffer
+                                      (j_decompress_ptr    JpegInfo)
+ {
+  static const JOCTET                  EOIMarker[2] = { 0xFF, JPEG_EOI };
 
-  if (Source == NULL)
+  /* data is exhausted - insert fake EOI marker like jpeg_stdio_src does */
+
+  JpegInfo->src->next_input_byte = EOIMarker;
+  JpegInfo->src->bytes_in_buffer = sizeof(EOIMarker);
+
+  return(TRUE);
+ }
+
+static void        JpegMemSkipInputData
+                                      (j_decompress_ptr    JpegInfo,
+                                       long                Count)
+ {
+  if (Count > 0)
    {
-    return(false);
+    if ((size_t)Count > JpegInfo->src->bytes_in_buffer)
+     {
+      JpegMemFillInputBuffer(JpegInfo);
+     }
+    else
+     {
+      JpegInfo->src->next_input_byte += Count;
+      JpegInfo->src->bytes_in_buffer -= Count;
+     }
    }
+ }
+
+static void        JpegMemTermSource  (j_decompress_ptr    JpegInfo P3D_UNUSED_ATTR)
+ {
+ }
+
+/* reads image either from Source or from MemSource (if Source is NULL) */
+static bool        LoadJPG            (P3DImageData       *ImageData,
+                                       FILE               *Source,
+                                       struct jpeg_source_mgr
+                                                          *MemSource)
+ {
+  bool                                 Result;
+  struct jpeg_decompress_struct        JpegInfo;
+  JpegErrorHandlerStruct               JpegErrorHandler;
 
   JpegInfo.err = jpeg_std_error(&JpegErrorHandler.Base);
   JpegErrorHandler.Base.error_exit = JpegErrorHandlerFunc;
@@ -99,13 +131,20 @@ bool               P3DImageFmtHandlerJPG::LoadImageData
    {
     jpeg_destroy_decompress(&JpegInfo);
 
-    fclose(Source);
-
     return(false);
    }
 
   jpeg_create_decompress(&JpegInfo);
-  jpeg_stdio_src(&JpegInfo,Source);
+
+  if (Source != NULL)
+   {
+    jpeg_stdio_src(&JpegInfo,Source);
+   }
+  else
+   {
+    JpegInfo.src = MemSource;
+   }
+
   jpeg_read_header(&JpegInfo,TRUE);
 
   Result = true;
@@ -146,8 +185,47 @@ bool               P3DImageFmtHandlerJPG::LoadImageData
 
   jpeg_destroy_decompress(&JpegInfo);
 
+  return(Result);
+ }
+
+bool               P3DImageFmtHandlerJPG::LoadImageData
+                                      (P3DImageData       *ImageData,
+                                       const char         *FileName,
+                                       const char         *FileExt P3D_UNUSED_ATTR) const
+ {
+  bool                                 Result;
+  FILE                                *Source;
+
+  Source = fopen(FileName,"rb");
+
+  if (Source == NULL)
+   {
+    return(false);
+   }
+
+  Result = LoadJPG(ImageData,Source,NULL);
+
   fclose(Source);
 
   return(Result);
  }
 
+bool               P3DImageFmtHandlerJPG::LoadImageDataMem
+                                      (P3DImageData       *ImageData,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       const char         *FileExt P3D_UNUSED_ATTR) const
+ {
+  struct jpeg_source_mgr               MemSource;
+
+  MemSource.next_input_byte   = (const JOCTET*)Data;
+  MemSource.bytes_in_buffer   = Size;
+  MemSource.init_source       = JpegMemInitSource;
+  MemSource.fill_input_buffer = JpegMemFillInputBuffer;
+  MemSource.skip_input_data   = JpegMemSkipInputData;
+  MemSource.resync_to_restart = jpeg_resync_to_restart;
+  MemSource.term_source       = JpegMemTermSource;
+
+  return(LoadJPG(ImageData,NULL,&MemSource));
+ }
+
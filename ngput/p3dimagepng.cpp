@@ -31,6 +31,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <png.h>
 
@@ -55,38 +56,44 @@ const char        *P3DImageFmtHandlerPNG::FormatExt
   return(P3DImageFmtPNGExt);
  }
 
-bool               P3DImageFmtHandlerPNG::LoadImageData
-                                      (P3DImageData       *ImageData,
-                                       const char         *FileName,
-                                       const char         *FileExt P3D_UNUSED_ATTR) const
+typedef struct
  {
-  bool                                 Result;
-  FILE                                *Source;
-  unsigned char                        Sig[PNG_SIGNATURE_SIZE];
-  png_structp                          PngStruct;
-  png_infop                            PngInfo;
+  const png_byte            *Data;
+  png_size_t                 Size;
+  png_size_t                 Offset;
+ } PngMemSourceStruct;
+
+static void        PngMemReadFunc     (png_structp         PngStruct,
+                                       png_bytep           Data,
+                                       png_size_t          Length)
+ {
+  PngMemSourceStruct                  *MemSource;
 
-  Source = fopen(FileName,"rb");
+  MemSource = (PngMemSourceStruct*)png_get_io_ptr(PngStruct);
 
-  if (Source == NULL)
+  if (Length > MemSource->Size - MemSource->Offset)
    {
-    return(false);
+    png_error(PngStruct,"unexpected end of data");
    }
 
-  Result = false;
+  memcpy(Data,MemSource->Data + MemSource->Offset,Length);
 
-  if (fread(Sig,1,sizeof(Sig),Source) == sizeof(Sig))
-   {
-    Result = png_check_sig(Sig,sizeof(Sig));
-   }
+  MemSource->Offset += Length;
+ }
+
+/* reads image after signature, either from Source or from MemSource */
+static bool        LoadPNG            (P3DImageData       *ImageData,
+                                       FILE               *Source,
+                                       PngMemSourceStruct *MemSource)
+ {
+  bool                                 Result;
+  png_structp                          PngStruct;
+  png_infop                            PngInfo;
 
   PngStruct = NULL;
   PngInfo   = NULL;
 
-  if (Result)
-   {
-    Result = (PngStruct = png_create_read_struct(PNG_LIBPNG_VER_STRING,NULL,NULL,NULL)) != NULL;
-   }
+  Result = (PngStruct = png_create_read_struct(PNG_LIBPNG_VER_STRING,NULL,NULL,NULL)) != NULL;
 
   if (Result)
    {
@@ -98,7 +105,6 @@ bool               P3DImageFmtHandlerPNG::LoadImageData
     if (setjmp(png_jmpbuf(PngStruct)))
      {
       png_destroy_read_struct(&PngStruct,&PngInfo,NULL);
-      fclose(Source);
 
       return(false);
      }
@@ -106,8 +112,16 @@ bool               P3DImageFmtHandlerPNG::LoadImageData
 
   if (Result)
    {
-    png_init_io(PngStruct,Source);
-    png_set_sig_bytes(PngStruct,sizeof(Sig));
+    if (Source != NULL)
+     {
+      png_init_io(PngStruct,Source);
+     }
+    else
+     {
+      png_set_read_fn(PngStruct,MemSource,PngMemReadFunc);
+     }
+
+    png_set_sig_bytes(PngStruct,PNG_SIGNATURE_SIZE);
 
     png_read_png(PngStruct,PngInfo,
                  PNG_TRANSFORM_STRIP_16 |
@@ -167,8 +181,171 @@ bool               P3DImageFmtHandlerPNG::LoadImageData
     png_destroy_read_struct(&PngStruct,&PngInfo,NULL);
    }
 
+  return(Result);
+ }
+
+bool               P3DImageFmtHandlerPNG::LoadImageData
+                                      (P3DImageData       *ImageData,
+                                       const char         *FileName,
+                                       const char         *FileExt P3D_UNUSED_ATTR) const
+ {
+  bool                                 Result;
+  FILE                                *Source;
+  unsigned char                        Sig[PNG_SIGNATURE_SIZE];
+
+  Source = fopen(FileName,"rb");
+
+  if (Source == NULL)
+   {
+    return(false);
+   }
+
+  Result = false;
+
+  if (fread(Sig,1,sizeof(Sig),Source) == sizeof(Sig))
+   {
+    Result = png_check_sig(Sig,sizeof(Sig));
+   }
+
+  if (Result)
+   {
+    Result = LoadPNG(ImageData,Source,NULL);
+   }
+
   fclose(Source);
 
   return(Result);
  }
 
+bool               P3DImageFmtHandlerPNG::LoadImageDataMem
+                                      (P3DImageData       *ImageData,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       const char         *FileExt P3D_UNUSED_ATTR) const
+ {
+  PngMemSourceStruct                   MemSource;
+
+  if (Size < PNG_SIGNATURE_SIZE)
+   {
+    return(false);
+   }
+
+  if (!png_check_sig((png_bytep)Data,PNG_SIGNATURE_SIZE))
+   {
+    return(false);
+   }
+
+  MemSource.Data   = (const png_byte*)Data;
+  MemSource.Size   = Size;
+  MemSource.Offset = PNG_SIGNATURE_SIZE;
+
+  return(LoadPNG(ImageData,NULL,&MemSource));
+ }
+
+bool               P3DImageFmtHandlerPNG::SaveAsPNG
+                                      (const char         *FileName,
+                                       const P3DImageData *ImageData,
+                                       int                 CompressionLevel)
+ {
+  bool                                 Result;
+  FILE                                *Target;
+  png_structp                          PngStruct;
+  png_infop                            PngInfo;
+  int                                  ColorType;
+  unsigned int                         RowSize;
+  const P3DByte                       *Data;
+
+  if      (ImageData->GetChannelCount() == 1)
+   {
+    ColorType = PNG_COLOR_TYPE_GRAY;
+   }
+  else if (ImageData->GetChannelCount() == 3)
+   {
+    ColorType = PNG_COLOR_TYPE_RGB;
+   }
+  else if (ImageData->GetChannelCount() == 4)
+   {
+    ColorType = PNG_COLOR_TYPE_RGB_ALPHA;
+   }
+  else
+   {
+    return(false);
+   }
+
+  if (ImageData->GetChannelType() != P3D_BYTE)
+   {
+    return(false);
+   }
+
+  Target = fopen(FileName,"wb");
+
+  if (Target == NULL)
+   {
+    return(false);
+   }
+
+  PngStruct = NULL;
+  PngInfo   = NULL;
+
+  Result = (PngStruct = png_create_write_struct(PNG_LIBPNG_VER_STRING,NULL,NULL,NULL)) != NULL;
+
+  if (Result)
+   {
+    Result = (PngInfo = png_create_info_struct(PngStruct)) != NULL;
+   }
+
+  if (Result)
+   {
+    if (setjmp(png_jmpbuf(PngStruct)))
+     {
+      png_destroy_write_struct(&PngStruct,&PngInfo);
+      fclose(Target);
+
+      return(false);
+     }
+   }
+
+  if (Result)
+   {
+    png_init_io(PngStruct,Target);
+
+    if (CompressionLevel != P3D_PNG_COMPRESSION_DEFAULT)
+     {
+      png_set_compression_level(PngStruct,CompressionLevel);
+     }
+
+    png_set_IHDR(PngStruct,PngInfo,
+                 ImageData->GetWidth(),
+                 ImageData->GetHeight(),
+                 8,
+                 ColorType,
+                 PNG_INTERLACE_NONE,
+                 PNG_COMPRESSION_TYPE_DEFAULT,
+                 PNG_FILTER_TYPE_DEFAULT);
+
+    png_write_info(PngStruct,PngInfo);
+
+    RowSize = ImageData->GetWidth() * ImageData->GetChannelCount();
+    Data    = (const P3DByte*)ImageData->GetConstData();
+
+    for (unsigned int Y = 0; Y < ImageData->GetHeight(); Y++)
+     {
+      png_write_row(PngStruct,(png_bytep)(Data + Y * RowSize));
+     }
+
+    png_write_end(PngStruct,PngInfo);
+   }
+
+  if (PngStruct != NULL)
+   {
+    png_destroy_write_struct(&PngStruct,&PngInfo);
+   }
+
+  if (fclose(Target) != 0)
+   {
+    Result = false;
+   }
+
+  return(Result);
+ }
+
@@ -36,6 +36,8 @@
 
 #include <ngput/p3dimage.h>
 
+#define P3D_PNG_COMPRESSION_DEFAULT (-1)
+
 class P3DImageFmtHandlerPNG : public P3DImageFmtHandler
  {
   public           :
@@ -50,6 +52,18 @@ class P3DImageFmtHandlerPNG : public P3DImageFmtHandler
   bool             LoadImageData      (P3DImageData       *ImageData,
                                        const char         *FileName,
                                        const char         *FileExt) const;
+
+  virtual
+  bool             LoadImageDataMem   (P3DImageData       *ImageData,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       const char         *FileExt) const;
+
+  /* CompressionLevel is zlib level (0-9) or P3D_PNG_COMPRESSION_DEFAULT, */
+  /* first image row is written as top one (as SaveAsTGA does)           */
+  static bool      SaveAsPNG          (const char         *FileName,
+                                       const P3DImageData *ImageData,
+                                       int                 CompressionLevel = P3D_PNG_COMPRESSION_DEFAULT);
  };
 
 #endif
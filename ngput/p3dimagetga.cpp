@@ -51,10 +51,91 @@ const char        *P3DImageFmtHandlerTGA::FormatExt
   return(P3DImageFmtTGAExt);
  }
 
+class P3DTGASource
+ {
+  public           :
+
+                   P3DTGASource       () {}
+  virtual         ~P3DTGASource       () {}
+
+  virtual bool     Read               (void               *Data,
+                                       unsigned int        Size) = 0;
+ };
+
+class P3DTGASourceFile : public P3DTGASource
+ {
+  public           :
+
+                   P3DTGASourceFile   (FILE               *Source);
+
+  virtual bool     Read               (void               *Data,
+                                       unsigned int        Size);
+
+  private          :
+
+  FILE            *Source;
+ };
+
+                   P3DTGASourceFile::P3DTGASourceFile
+                                      (FILE               *Source)
+ {
+  this->Source = Source;
+ }
+
+bool               P3DTGASourceFile::Read
+                                      (void               *Data,
+                                       unsigned int        Size)
+ {
+  return(fread(Data,1,Size,Source) == Size);
+ }
+
+class P3DTGASourceMem : public P3DTGASource
+ {
+  public           :
+
+                   P3DTGASourceMem    (const void         *Data,
+                                       unsigned int        Size);
+
+  virtual bool     Read               (void               *Data,
+                                       unsigned int        Size);
+
+  private          :
+
+  const P3DByte   *Data;
+  unsigned int     Size;
+  unsigned int     Offset;
+ };
+
+                   P3DTGASourceMem::P3DTGASourceMem
+                                      (const void         *Data,
+                                       unsigned int        Size)
+ {
+  this->Data = (const P3DByte*)Data;
+  this->Size = Size;
+
+  Offset = 0;
+ }
+
+bool               P3DTGASourceMem::Read
+                                      (void               *Data,
+                                       unsigned int        Size)
+ {
+  if (Size > this->Size - Offset)
+   {
+    return(false);
+   }
+
+  memcpy(Data,this->Data + Offset,Size);
+
+  Offset += Size;
+
+  return(true);
+ }
+
 bool               ReadByte           (P3DByte            *Value,
-                                       FILE               *Source)
+                                       P3DTGASource       *Source)
  {
-  if (fread(Value,sizeof(*Value),1,Source) == 1)
+  if (Source->Read(Value,sizeof(*Value)))
    {
     return(true);
    }
@@ -65,9 +146,9 @@ bool               ReadByte           (P3DByte            *Value,
  }
 
 bool               ReadUint16         (P3Duint16          *Value,
-                                       FILE               *Source)
+                                       P3DTGASource       *Source)
  {
-  if (fread(Value,sizeof(*Value),1,Source) == 1)
+  if (Source->Read(Value,sizeof(*Value)))
    {
     #ifdef P3D_BIG_ENDIAN
      {
@@ -84,9 +165,9 @@ bool               ReadUint16         (P3Duint16          *Value,
 
 bool               ReadBlock          (void               *Data,
                                        unsigned int        Size,
-                                       FILE               *Source)
+                                       P3DTGASource       *Source)
  {
-  if (fread(Data,1,Size,Source) == Size)
+  if (Source->Read(Data,Size))
    {
     return(true);
    }
@@ -110,19 +191,19 @@ class P3DTGADataReaderRaw : public P3DTGADataReader
  {
   public           :
 
-                   P3DTGADataReaderRaw(FILE               *Source,
+                   P3DTGADataReaderRaw(P3DTGASource       *Source,
                                        unsigned int        ChannelCount);
 
   virtual bool     ReadPixel          (P3DByte            *PixelData);
 
   private          :
 
-  FILE            *Source;
+  P3DTGASource    *Source;
   unsigned int     ChannelCount;
  };
 
                    P3DTGADataReaderRaw::P3DTGADataReaderRaw
-                                      (FILE               *Source,
+                                      (P3DTGASource       *Source,
                                        unsigned int        ChannelCount)
  {
   this->Source       = Source;
@@ -179,14 +260,14 @@ class P3DTGADataReaderRLE : public P3DTGADataReader
  {
   public           :
 
-                   P3DTGADataReaderRLE(FILE               *Source,
+                   P3DTGADataReaderRLE(P3DTGASource       *Source,
                                        unsigned int        ChannelCount);
 
   virtual bool     ReadPixel          (P3DByte            *PixelData);
 
   private          :
 
-  FILE                               *Source;
+  P3DTGASource                       *Source;
   unsigned int                        ChannelCount;
   P3DByte                             PixelValue[4];
   P3DByte                             RepCount;
@@ -195,7 +276,7 @@ class P3DTGADataReaderRLE : public P3DTGADataReader
  };
 
                    P3DTGADataReaderRLE::P3DTGADataReaderRLE
-                                      (FILE               *Source,
+                                      (P3DTGASource       *Source,
                                        unsigned int        ChannelCount)
                    : DataReaderRaw(Source,ChannelCount)
  {
@@ -262,13 +343,10 @@ bool               P3DTGADataReaderRLE::ReadPixel
   return(Result);
  }
 
-bool               P3DImageFmtHandlerTGA::LoadImageData
-                                      (P3DImageData       *ImageData,
-                                       const char         *FileName,
-                                       const char         *FileExt) const
+static bool        LoadTGA            (P3DImageData       *ImageData,
+                                       P3DTGASource       *Source)
  {
   bool                                 Result;
-  FILE                                *Source;
   P3DByte                              TGAIDLength;
   P3DByte                              TGAColorMapType;
   P3DByte                              TGAImageType;
@@ -286,18 +364,6 @@ bool               P3DImageFmtHandlerTGA::LoadImageData
   P3DByte                              Pixel[4];
   bool                                 RLECompressed;
 
-  if (strcmp(FileExt,P3DImageFmtTGAExt) != 0)
-   {
-    return(false);
-   }
-
-  Source = fopen(FileName,"rb");
-
-  if (Source == NULL)
-   {
-    return(false);
-   }
-
   Result = ReadByte(&TGAIDLength,Source);
 
   if (Result)
@@ -469,11 +535,54 @@ bool               P3DImageFmtHandlerTGA::LoadImageData
      }
    }
 
+  return(Result);
+ }
+
+bool               P3DImageFmtHandlerTGA::LoadImageData
+                                      (P3DImageData       *ImageData,
+                                       const char         *FileName,
+                                       const char         *FileExt) const
+ {
+  bool                                 Result;
+  FILE                                *Source;
+
+  if (strcmp(FileExt,P3DImageFmtTGAExt) != 0)
+   {
+    return(false);
+   }
+
+  Source = fopen(FileName,"rb");
+
+  if (Source == NULL)
+   {
+    return(false);
+   }
+
+  P3DTGASourceFile                     FileSource(Source);
+
+  Result = LoadTGA(ImageData,&FileSource);
+
   fclose(Source);
 
   return(Result);
  }
 
+bool               P3DImageFmtHandlerTGA::LoadImageDataMem
+                                      (P3DImageData       *ImageData,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       const char         *FileExt) const
+ {
+  if (strcmp(FileExt,P3DImageFmtTGAExt) != 0)
+   {
+    return(false);
+   }
+
+  P3DTGASourceMem                      MemSource(Data,Size);
+
+  return(LoadTGA(ImageData,&MemSource));
+ }
+
 bool               WriteByte          (FILE               *Target,
                                        P3DByte             Value)
  {
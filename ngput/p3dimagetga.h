@@ -51,6 +51,12 @@ class P3DImageFmtHandlerTGA : public P3DImageFmtHandler
                                        const char         *FileName,
                                        const char         *FileExt) const;
 
+  virtual
+  bool             LoadImageDataMem   (P3DImageData       *ImageData,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       const char         *FileExt) const;
+
   static bool      SaveAsTGA          (const char         *FileName,
                                        P3DImageData       *ImageData);
  };
@@ -0,0 +1,1024 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#include <stdio.h>
+#include <math.h>
+
+#include <ngput/p3dthread.h>
+#include <ngput/p3dtexcomp.h>
+
+#define BlockPixelCount    (16)
+
+#define DDSHeaderSize      (124)
+#define DDSPixelFormatSize (32)
+
+#define DDSD_CAPS          (0x00000001)
+#define DDSD_HEIGHT        (0x00000002)
+#define DDSD_WIDTH         (0x00000004)
+#define DDSD_PIXELFORMAT   (0x00001000)
+#define DDSD_MIPMAPCOUNT   (0x00020000)
+#define DDSD_LINEARSIZE    (0x00080000)
+
+#define DDPF_ALPHAPIXELS   (0x00000001)
+#define DDPF_FOURCC        (0x00000004)
+
+#define DDSCAPS_COMPLEX    (0x00000008)
+#define DDSCAPS_TEXTURE    (0x00001000)
+#define DDSCAPS_MIPMAP     (0x00400000)
+
+#define KTXEndianness      (0x04030201)
+
+#define GL_RGB_                            (0x1907)
+#define GL_RGBA_                           (0x1908)
+#define GL_COMPRESSED_RGB_S3TC_DXT1_EXT_   (0x83F0)
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT_  (0x83F1)
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT_  (0x83F3)
+
+static const P3DByte KTXIdentifier[12] =
+ {
+  0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+ };
+
+static P3Duint32   MakeFourCC         (char                C0,
+                                       char                C1,
+                                       char                C2,
+                                       char                C3)
+ {
+  return(((P3Duint32)(P3DByte)C0)         |
+         ((P3Duint32)(P3DByte)C1 << 8)    |
+         ((P3Duint32)(P3DByte)C2 << 16)   |
+         ((P3Duint32)(P3DByte)C3 << 24));
+ }
+
+static void        AppendUint32       (std::vector<P3DByte>
+                                                          *Target,
+                                       P3Duint32           Value)
+ {
+  Target->push_back((P3DByte)(Value & 0xFF));
+  Target->push_back((P3DByte)((Value >> 8) & 0xFF));
+  Target->push_back((P3DByte)((Value >> 16) & 0xFF));
+  Target->push_back((P3DByte)((Value >> 24) & 0xFF));
+ }
+
+static unsigned int GetBlockSize      (unsigned int        Format)
+ {
+  return(Format == P3D_TEXCOMP_BC3 ? 16 : 8);
+ }
+
+static int         ClampColor         (float               Value)
+ {
+  if      (Value < 0.0f)
+   {
+    return(0);
+   }
+  else if (Value > 255.0f)
+   {
+    return(255);
+   }
+  else
+   {
+    return((int)(Value + 0.5f));
+   }
+ }
+
+static P3Duint16   PackColor565       (const float         Color[3])
+ {
+  int                                  R,G,B;
+
+  R = (ClampColor(Color[0]) * 31 + 127) / 255;
+  G = (ClampColor(Color[1]) * 63 + 127) / 255;
+  B = (ClampColor(Color[2]) * 31 + 127) / 255;
+
+  return((P3Duint16)((R << 11) | (G << 5) | B));
+ }
+
+static void        UnpackColor565     (int                 Color[3],
+                                       P3Duint16           Packed)
+ {
+  int                                  R,G,B;
+
+  R = (Packed >> 11) & 0x1F;
+  G = (Packed >> 5)  & 0x3F;
+  B = Packed         & 0x1F;
+
+  Color[0] = (R << 3) | (R >> 2);
+  Color[1] = (G << 2) | (G >> 4);
+  Color[2] = (B << 3) | (B >> 2);
+ }
+
+/* palette is built the same way as decoders do: four colors if */
+/* Color0 > Color1, three colors and transparent black otherwise */
+static unsigned int MakeColorPalette  (int                 Palette[4][3],
+                                       P3Duint16           Color0,
+                                       P3Duint16           Color1)
+ {
+  UnpackColor565(Palette[0],Color0);
+  UnpackColor565(Palette[1],Color1);
+
+  for (unsigned int Channel = 0; Channel < 3; Channel++)
+   {
+    if (Color0 > Color1)
+     {
+      Palette[2][Channel] = (2 * Palette[0][Channel] + Palette[1][Channel]) / 3;
+      Palette[3][Channel] = (Palette[0][Channel] + 2 * Palette[1][Channel]) / 3;
+     }
+    else
+     {
+      Palette[2][Channel] = (Palette[0][Channel] + Palette[1][Channel]) / 2;
+      Palette[3][Channel] = 0;
+     }
+   }
+
+  return(Color0 > Color1 ? 4 : 3);
+ }
+
+/* inactive pixels get transparent index 3, returns squared error */
+static unsigned int AssignColorIndices(const P3DByte       Pixels[BlockPixelCount][4],
+                                       const bool          Active[BlockPixelCount],
+                                       P3Duint16           Color0,
+                                       P3Duint16           Color1,
+                                       unsigned int        Indices[BlockPixelCount])
+ {
+  int                                  Palette[4][3];
+  unsigned int                         EntryCount;
+  unsigned int                         TotalError;
+
+  EntryCount = MakeColorPalette(Palette,Color0,Color1);
+  TotalError = 0;
+
+  for (unsigned int PixelIndex = 0; PixelIndex < BlockPixelCount; PixelIndex++)
+   {
+    if (Active[PixelIndex])
+     {
+      unsigned int BestError = 0;
+
+      for (unsigned int Entry = 0; Entry < EntryCount; Entry++)
+       {
+        unsigned int Error = 0;
+
+        for (unsigned int Channel = 0; Channel < 3; Channel++)
+         {
+          int Delta = Palette[Entry][Channel] - (int)Pixels[PixelIndex][Channel];
+
+          Error += Delta * Delta;
+         }
+
+        if ((Entry == 0) || (Error < BestError))
+         {
+          BestError          = Error;
+          Indices[PixelIndex] = Entry;
+         }
+       }
+
+      TotalError += BestError;
+     }
+    else
+     {
+      Indices[PixelIndex] = 3;
+     }
+   }
+
+  return(TotalError);
+ }
+
+/* in four-color mode Color0 must be greater than Color1, in punch-through */
+/* (three colors plus transparent) mode - not greater                      */
+static void        OrderEndpoints     (P3Duint16          *Color0,
+                                       P3Duint16          *Color1,
+                                       bool                PunchThrough)
+ {
+  if (PunchThrough ? (*Color0 > *Color1) : (*Color0 < *Color1))
+   {
+    P3Duint16      Temp;
+
+    Temp    = *Color0;
+    *Color0 = *Color1;
+    *Color1 = Temp;
+   }
+ }
+
+/* least squares fit of endpoints for given palette indices */
+static bool        RefineEndpoints    (P3Duint16          *Color0,
+                                       P3Duint16          *Color1,
+                                       const P3DByte       Pixels[BlockPixelCount][4],
+                                       const bool          Active[BlockPixelCount],
+                                       const unsigned int  Indices[BlockPixelCount],
+                                       bool                FourColorMode)
+ {
+  static const float FourColorWeights[4]  = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+  static const float ThreeColorWeights[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+  const float                         *Weights;
+  float                                AA,BB,AB;
+  float                                AX[3],BX[3];
+  float                                Det;
+  float                                Endpoint0[3];
+  float                                Endpoint1[3];
+
+  Weights = FourColorMode ? FourColorWeights : ThreeColorWeights;
+
+  AA = BB = AB = 0.0f;
+
+  AX[0] = AX[1] = AX[2] = 0.0f;
+  BX[0] = BX[1] = BX[2] = 0.0f;
+
+  for (unsigned int PixelIndex = 0; PixelIndex < BlockPixelCount; PixelIndex++)
+   {
+    if ((Active[PixelIndex]) && ((FourColorMode) || (Indices[PixelIndex] != 3)))
+     {
+      float A = Weights[Indices[PixelIndex]];
+      float B = 1.0f - A;
+
+      AA += A * A;
+      BB += B * B;
+      AB += A * B;
+
+      for (unsigned int Channel = 0; Channel < 3; Channel++)
+       {
+        AX[Channel] += A * Pixels[PixelIndex][Channel];
+        BX[Channel] += B * Pixels[PixelIndex][Channel];
+       }
+     }
+   }
+
+  Det = AA * BB - AB * AB;
+
+  if (fabsf(Det) < 1e-6f)
+   {
+    return(false);
+   }
+
+  for (unsigned int Channel = 0; Channel < 3; Channel++)
+   {
+    Endpoint0[Channel] = (AX[Channel] * BB - BX[Channel] * AB) / Det;
+    Endpoint1[Channel] = (BX[Channel] * AA - AX[Channel] * AB) / Det;
+   }
+
+  *Color0 = PackColor565(Endpoint0);
+  *Color1 = PackColor565(Endpoint1);
+
+  return(true);
+ }
+
+/* endpoints are placed along principal axis of block colors, then */
+/* refined using least squares fit                                  */
+static void        EncodeColorBlock   (P3DByte            *Target,
+                                       const P3DByte       Pixels[BlockPixelCount][4],
+                                       bool                PunchThrough)
+ {
+  bool                                 Active[BlockPixelCount];
+  unsigned int                         ActiveCount;
+  float                                Mean[3];
+  float                                Cov[6];
+  float                                Axis[3];
+  float                                MinProj,MaxProj;
+  float                                Endpoint0[3];
+  float                                Endpoint1[3];
+  P3Duint16                            Color0,Color1;
+  unsigned int                         Indices[BlockPixelCount];
+  unsigned int                         Error;
+  P3Duint32                            IndexBits;
+
+  ActiveCount = 0;
+
+  Mean[0] = Mean[1] = Mean[2] = 0.0f;
+
+  for (unsigned int PixelIndex = 0; PixelIndex < BlockPixelCount; PixelIndex++)
+   {
+    Active[PixelIndex] = (!PunchThrough) || (Pixels[PixelIndex][3] >= 128);
+
+    if (Active[PixelIndex])
+     {
+      Mean[0] += Pixels[PixelIndex][0];
+      Mean[1] += Pixels[PixelIndex][1];
+      Mean[2] += Pixels[PixelIndex][2];
+
+      ActiveCount++;
+     }
+   }
+
+  if (ActiveCount == 0)
+   {
+    /* fully transparent block */
+
+    Target[0] = Target[1] = Target[2] = Target[3] = 0x00;
+    Target[4] = Target[5] = Target[6] = Target[7] = 0xFF;
+
+    return;
+   }
+
+  Mean[0] /= ActiveCount;
+  Mean[1] /= ActiveCount;
+  Mean[2] /= ActiveCount;
+
+  for (unsigned int Index = 0; Index < 6; Index++)
+   {
+    Cov[Index] = 0.0f;
+   }
+
+  for (unsigned int PixelIndex = 0; PixelIndex < BlockPixelCount; PixelIndex++)
+   {
+    if (Active[PixelIndex])
+     {
+      float R = Pixels[PixelIndex][0] - Mean[0];
+      float G = Pixels[PixelIndex][1] - Mean[1];
+      float B = Pixels[PixelIndex][2] - Mean[2];
+
+      Cov[0] += R * R;
+      Cov[1] += R * G;
+      Cov[2] += R * B;
+      Cov[3] += G * G;
+      Cov[4] += G * B;
+      Cov[5] += B * B;
+     }
+   }
+
+  /* power iteration, starting from covariance column of the channel */
+  /* with largest variance                                           */
+
+  unsigned int StartChannel = 0;
+
+  if (Cov[3] > Cov[0]) StartChannel = 1;
+  if (Cov[5] > (StartChannel == 0 ? Cov[0] : Cov[3])) StartChannel = 2;
+
+  if      (StartChannel == 0)
+   {
+    Axis[0] = Cov[0];
+    Axis[1] = Cov[1];
+    Axis[2] = Cov[2];
+   }
+  else if (StartChannel == 1)
+   {
+    Axis[0] = Cov[1];
+    Axis[1] = Cov[3];
+    Axis[2] = Cov[4];
+   }
+  else
+   {
+    Axis[0] = Cov[2];
+    Axis[1] = Cov[4];
+    Axis[2] = Cov[5];
+   }
+
+  for (unsigned int Iteration = 0; Iteration < 8; Iteration++)
+   {
+    float X = Cov[0] * Axis[0] + Cov[1] * Axis[1] + Cov[2] * Axis[2];
+    float Y = Cov[1] * Axis[0] + Cov[3] * Axis[1] + Cov[4] * Axis[2];
+    float Z = Cov[2] * Axis[0] + Cov[4] * Axis[1] + Cov[5] * Axis[2];
+    float Norm = fabsf(X);
+
+    if (fabsf(Y) > Norm) Norm = fabsf(Y);
+    if (fabsf(Z) > Norm) Norm = fabsf(Z);
+
+    if (Norm < 1e-6f)
+     {
+      break;
+     }
+
+    Axis[0] = X / Norm;
+    Axis[1] = Y / Norm;
+    Axis[2] = Z / Norm;
+   }
+
+  float AxisLengthSqr = Axis[0] * Axis[0] + Axis[1] * Axis[1] + Axis[2] * Axis[2];
+
+  MinProj = MaxProj = 0.0f;
+
+  /* for single-colored blocks both endpoints are equal to mean */
+  for (unsigned int PixelIndex = 0; PixelIndex < BlockPixelCount; PixelIndex++)
+   {
+    if ((Active[PixelIndex]) && (AxisLengthSqr > 1e-6f))
+     {
+      float Proj = ((Pixels[PixelIndex][0] - Mean[0]) * Axis[0] +
+                    (Pixels[PixelIndex][1] - Mean[1]) * Axis[1] +
+                    (Pixels[PixelIndex][2] - Mean[2]) * Axis[2]) / AxisLengthSqr;
+
+      if (Proj < MinProj) MinProj = Proj;
+      if (Proj > MaxProj) MaxProj = Proj;
+     }
+   }
+
+  /* inset endpoints a bit, extremes are rarely hit exactly */
+  float Inset = (MaxProj - MinProj) / 16.0f;
+
+  MinProj += Inset;
+  MaxProj -= Inset;
+
+  for (unsigned int Channel = 0; Channel < 3; Channel++)
+   {
+    Endpoint0[Channel] = Mean[Channel] + Axis[Channel] * MaxProj;
+    Endpoint1[Channel] = Mean[Channel] + Axis[Channel] * MinProj;
+   }
+
+  Color0 = PackColor565(Endpoint0);
+  Color1 = PackColor565(Endpoint1);
+
+  OrderEndpoints(&Color0,&Color1,PunchThrough);
+
+  Error = AssignColorIndices(Pixels,Active,Color0,Color1,Indices);
+
+  for (unsigned int Iteration = 0; (Iteration < 2) && (Error > 0); Iteration++)
+   {
+    P3Duint16      NewColor0 = Color0;
+    P3Duint16      NewColor1 = Color1;
+    unsigned int   NewIndices[BlockPixelCount];
+    unsigned int   NewError;
+
+    if (!RefineEndpoints(&NewColor0,&NewColor1,Pixels,Active,Indices,Color0 > Color1))
+     {
+      break;
+     }
+
+    OrderEndpoints(&NewColor0,&NewColor1,PunchThrough);
+
+    NewError = AssignColorIndices(Pixels,Active,NewColor0,NewColor1,NewIndices);
+
+    if (NewError >= Error)
+     {
+      break;
+     }
+
+    Color0 = NewColor0;
+    Color1 = NewColor1;
+    Error  = NewError;
+
+    for (unsigned int PixelIndex = 0; PixelIndex < BlockPixelCount; PixelIndex++)
+     {
+      Indices[PixelIndex] = NewIndices[PixelIndex];
+     }
+   }
+
+  IndexBits = 0;
+
+  for (unsigned int PixelIndex = 0; PixelIndex < BlockPixelCount; PixelIndex++)
+   {
+    IndexBits |= (P3Duint32)Indices[PixelIndex] << (PixelIndex * 2);
+   }
+
+  Target[0] = (P3DByte)(Color0 & 0xFF);
+  Target[1] = (P3DByte)(Color0 >> 8);
+  Target[2] = (P3DByte)(Color1 & 0xFF);
+  Target[3] = (P3DByte)(Color1 >> 8);
+  Target[4] = (P3DByte)(IndexBits & 0xFF);
+  Target[5] = (P3DByte)((IndexBits >> 8) & 0xFF);
+  Target[6] = (P3DByte)((IndexBits >> 16) & 0xFF);
+  Target[7] = (P3DByte)((IndexBits >> 24) & 0xFF);
+ }
+
+/* eight-value mode if Alpha0 > Alpha1, six values plus 0 and 255 otherwise */
+static unsigned int AssignAlphaIndices(const P3DByte       Pixels[BlockPixelCount][4],
+                                       int                 Alpha0,
+                                       int                 Alpha1,
+                                       unsigned int        Indices[BlockPixelCount])
+ {
+  int                                  Palette[8];
+  unsigned int                         TotalError;
+
+  Palette[0] = Alpha0;
+  Palette[1] = Alpha1;
+
+  if (Alpha0 > Alpha1)
+   {
+    for (int Entry = 2; Entry < 8; Entry++)
+     {
+      Palette[Entry] = ((8 - Entry) * Alpha0 + (Entry - 1) * Alpha1) / 7;
+     }
+   }
+  else
+   {
+    for (int Entry = 2; Entry < 6; Entry++)
+     {
+      Palette[Entry] = ((6 - Entry) * Alpha0 + (Entry - 1) * Alpha1) / 5;
+     }
+
+    Palette[6] = 0;
+    Palette[7] = 255;
+   }
+
+  TotalError = 0;
+
+  for (unsigned int PixelIndex = 0; PixelIndex < BlockPixelCount; PixelIndex++)
+   {
+    unsigned int BestError = 0;
+
+    for (unsigned int Entry = 0; Entry < 8; Entry++)
+     {
+      int          Delta = Palette[Entry] - (int)Pixels[PixelIndex][3];
+      unsigned int Error = Delta * Delta;
+
+      if ((Entry == 0) || (Error < BestError))
+       {
+        BestError           = Error;
+        Indices[PixelIndex] = Entry;
+       }
+     }
+
+    TotalError += BestError;
+   }
+
+  return(TotalError);
+ }
+
+static void        EncodeAlphaBlock   (P3DByte            *Target,
+                                       const P3DByte       Pixels[BlockPixelCount][4])
+ {
+  int                                  MinAlpha,MaxAlpha;
+  int                                  MinInnerAlpha,MaxInnerAlpha;
+  int                                  Alpha0,Alpha1;
+  unsigned int                         Indices[BlockPixelCount];
+  unsigned int                         InnerIndices[BlockPixelCount];
+  unsigned int                         Error;
+
+  MinAlpha = MinInnerAlpha = 255;
+  MaxAlpha = MaxInnerAlpha = 0;
+
+  for (unsigned int PixelIndex = 0; PixelIndex < BlockPixelCount; PixelIndex++)
+   {
+    int Alpha = Pixels[PixelIndex][3];
+
+    if (Alpha < MinAlpha) MinAlpha = Alpha;
+    if (Alpha > MaxAlpha) MaxAlpha = Alpha;
+
+    if ((Alpha != 0) && (Alpha != 255))
+     {
+      if (Alpha < MinInnerAlpha) MinInnerAlpha = Alpha;
+      if (Alpha > MaxInnerAlpha) MaxInnerAlpha = Alpha;
+     }
+   }
+
+  if (MinInnerAlpha > MaxInnerAlpha)
+   {
+    MinInnerAlpha = MaxInnerAlpha = 0;
+   }
+
+  /* eight-value mode covers [min,max] range, six-value mode is better */
+  /* for blocks having exact 0 and 255 together with partial alpha     */
+
+  Alpha0 = MaxAlpha;
+  Alpha1 = MinAlpha;
+
+  Error = AssignAlphaIndices(Pixels,Alpha0,Alpha1,Indices);
+
+  if (Error > 0)
+   {
+    if (AssignAlphaIndices(Pixels,MinInnerAlpha,MaxInnerAlpha,InnerIndices) < Error)
+     {
+      Alpha0 = MinInnerAlpha;
+      Alpha1 = MaxInnerAlpha;
+
+      for (unsigned int PixelIndex = 0; PixelIndex < BlockPixelCount; PixelIndex++)
+       {
+        Indices[PixelIndex] = InnerIndices[PixelIndex];
+       }
+     }
+   }
+
+  Target[0] = (P3DByte)Alpha0;
+  Target[1] = (P3DByte)Alpha1;
+
+  for (unsigned int Half = 0; Half < 2; Half++)
+   {
+    P3Duint32      IndexBits = 0;
+
+    for (unsigned int PixelIndex = 0; PixelIndex < 8; PixelIndex++)
+     {
+      IndexBits |= (P3Duint32)Indices[Half * 8 + PixelIndex] << (PixelIndex * 3);
+     }
+
+    Target[2 + Half * 3] = (P3DByte)(IndexBits & 0xFF);
+    Target[3 + Half * 3] = (P3DByte)((IndexBits >> 8) & 0xFF);
+    Target[4 + Half * 3] = (P3DByte)((IndexBits >> 16) & 0xFF);
+   }
+ }
+
+                   P3DCompressedTexture::P3DCompressedTexture
+                                      ()
+ {
+  Format  = P3D_TEXCOMP_BC1;
+  Image   = 0;
+  NextJob = 0;
+ }
+
+bool               P3DCompressedTexture::Create
+                                      (const P3DTexImage  *Image,
+                                       unsigned int        Format,
+                                       unsigned int        ThreadCount)
+ {
+  std::vector<P3DThread*>              Threads;
+  unsigned int                         BlockSize;
+
+  Levels.clear();
+
+  if (Image->GetLevelCount() == 0)
+   {
+    return(false);
+   }
+
+  this->Format = Format;
+  this->Image  = Image;
+
+  BlockSize = GetBlockSize(Format);
+
+  Levels.resize(Image->GetLevelCount());
+
+  for (unsigned int LevelIndex = 0; LevelIndex < Levels.size(); LevelIndex++)
+   {
+    const P3DImageData                *Source = Image->GetLevel(LevelIndex);
+    unsigned int                       BlockCountX;
+    unsigned int                       BlockCountY;
+
+    BlockCountX = (Source->GetWidth()  + 3) / 4;
+    BlockCountY = (Source->GetHeight() + 3) / 4;
+
+    Levels[LevelIndex].Width  = Source->GetWidth();
+    Levels[LevelIndex].Height = Source->GetHeight();
+
+    Levels[LevelIndex].Data.resize(BlockCountX * BlockCountY * BlockSize);
+
+    for (unsigned int BlockRow = 0; BlockRow < BlockCountY; BlockRow++)
+     {
+      Job          BlockRowJob;
+
+      BlockRowJob.LevelIndex = LevelIndex;
+      BlockRowJob.BlockRow   = BlockRow;
+
+      Jobs.push_back(BlockRowJob);
+     }
+   }
+
+  NextJob = 0;
+
+  if (ThreadCount > Jobs.size())
+   {
+    ThreadCount = Jobs.size();
+   }
+
+  /* calling thread is a worker too */
+  for (unsigned int Index = 1; Index < ThreadCount; Index++)
+   {
+    P3DThread     *Thread = new P3DThread();
+
+    if (Thread->Start(WorkerProc,this))
+     {
+      Threads.push_back(Thread);
+     }
+    else
+     {
+      delete Thread;
+     }
+   }
+
+  ProcessJobs();
+
+  for (unsigned int Index = 0; Index < Threads.size(); Index++)
+   {
+    Threads[Index]->Join();
+
+    delete Threads[Index];
+   }
+
+  Jobs.clear();
+
+  this->Image = 0;
+
+  return(true);
+ }
+
+void               P3DCompressedTexture::WorkerProc
+                                      (void               *Arg)
+ {
+  ((P3DCompressedTexture*)Arg)->ProcessJobs();
+ }
+
+void               P3DCompressedTexture::ProcessJobs
+                                      ()
+ {
+  unsigned int                         Index;
+
+  while (true)
+   {
+    Mutex.Lock();
+
+    Index = NextJob;
+
+    if (NextJob < Jobs.size())
+     {
+      NextJob++;
+     }
+
+    Mutex.Unlock();
+
+    if (Index >= Jobs.size())
+     {
+      return;
+     }
+
+    CompressBlockRow(Jobs[Index]);
+   }
+ }
+
+void               P3DCompressedTexture::CompressBlockRow
+                                      (const Job          &BlockRowJob)
+ {
+  const P3DImageData                  *Source;
+  const P3DByte                       *SourceData;
+  unsigned int                         Width;
+  unsigned int                         Height;
+  unsigned int                         ChannelCount;
+  unsigned int                         BlockCountX;
+  unsigned int                         BlockSize;
+  P3DByte                             *Target;
+  P3DByte                              Pixels[BlockPixelCount][4];
+
+  Source       = Image->GetLevel(BlockRowJob.LevelIndex);
+  SourceData   = (const P3DByte*)Source->GetConstData();
+  Width        = Source->GetWidth();
+  Height       = Source->GetHeight();
+  ChannelCount = Source->GetChannelCount();
+  BlockCountX  = (Width + 3) / 4;
+  BlockSize    = GetBlockSize(Format);
+  Target       = &Levels[BlockRowJob.LevelIndex].Data[BlockRowJob.BlockRow * BlockCountX * BlockSize];
+
+  for (unsigned int BlockX = 0; BlockX < BlockCountX; BlockX++)
+   {
+    /* levels smaller than block are padded by edge pixels */
+    for (unsigned int PixelY = 0; PixelY < 4; PixelY++)
+     {
+      unsigned int Y = BlockRowJob.BlockRow * 4 + PixelY;
+
+      if (Y >= Height)
+       {
+        Y = Height - 1;
+       }
+
+      for (unsigned int PixelX = 0; PixelX < 4; PixelX++)
+       {
+        unsigned int X = BlockX * 4 + PixelX;
+
+        if (X >= Width)
+         {
+          X = Width - 1;
+         }
+
+        const P3DByte *Pixel = &SourceData[(Y * Width + X) * ChannelCount];
+        P3DByte       *BlockPixel = Pixels[PixelY * 4 + PixelX];
+
+        BlockPixel[0] = Pixel[0];
+        BlockPixel[1] = Pixel[1];
+        BlockPixel[2] = Pixel[2];
+        BlockPixel[3] = ChannelCount == 4 ? Pixel[3] : 255;
+       }
+     }
+
+    if      (Format == P3D_TEXCOMP_BC3)
+     {
+      EncodeAlphaBlock(Target,Pixels);
+      EncodeColorBlock(Target + 8,Pixels,false);
+     }
+    else
+     {
+      EncodeColorBlock(Target,Pixels,Format == P3D_TEXCOMP_BC1A);
+     }
+
+    Target += BlockSize;
+   }
+ }
+
+unsigned int       P3DCompressedTexture::GetFormat
+                                      () const
+ {
+  return(Format);
+ }
+
+unsigned int       P3DCompressedTexture::GetLevelCount
+                                      () const
+ {
+  return(Levels.size());
+ }
+
+unsigned int       P3DCompressedTexture::GetLevelWidth
+                                      (unsigned int        Level) const
+ {
+  return(Levels[Level].Width);
+ }
+
+unsigned int       P3DCompressedTexture::GetLevelHeight
+                                      (unsigned int        Level) const
+ {
+  return(Levels[Level].Height);
+ }
+
+unsigned int       P3DCompressedTexture::GetLevelSize
+                                      (unsigned int        Level) const
+ {
+  return(Levels[Level].Data.size());
+ }
+
+const P3DByte     *P3DCompressedTexture::GetLevelData
+                                      (unsigned int        Level) const
+ {
+  return(&Levels[Level].Data[0]);
+ }
+
+void               P3DCompressedTexture::MakeDDS
+                                      (std::vector<P3DByte>
+                                                          *Target) const
+ {
+  P3Duint32                            Flags;
+  P3Duint32                            Caps;
+
+  Flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_LINEARSIZE;
+  Caps  = DDSCAPS_TEXTURE;
+
+  if (Levels.size() > 1)
+   {
+    Flags |= DDSD_MIPMAPCOUNT;
+    Caps  |= DDSCAPS_COMPLEX | DDSCAPS_MIPMAP;
+   }
+
+  AppendUint32(Target,MakeFourCC('D','D','S',' '));
+
+  AppendUint32(Target,DDSHeaderSize);
+  AppendUint32(Target,Flags);
+  AppendUint32(Target,Levels[0].Height);
+  AppendUint32(Target,Levels[0].Width);
+  AppendUint32(Target,Levels[0].Data.size()); /* linear size */
+  AppendUint32(Target,0);                     /* depth */
+  AppendUint32(Target,Levels.size());
+
+  for (unsigned int Index = 0; Index < 11; Index++)
+   {
+    AppendUint32(Target,0);                   /* reserved */
+   }
+
+  AppendUint32(Target,DDSPixelFormatSize);
+  AppendUint32(Target,Format == P3D_TEXCOMP_BC1 ? DDPF_FOURCC : DDPF_FOURCC | DDPF_ALPHAPIXELS);
+  AppendUint32(Target,Format == P3D_TEXCOMP_BC3 ? MakeFourCC('D','X','T','5') : MakeFourCC('D','X','T','1'));
+
+  for (unsigned int Index = 0; Index < 5; Index++)
+   {
+    AppendUint32(Target,0);                   /* bit count and masks */
+   }
+
+  AppendUint32(Target,Caps);
+
+  for (unsigned int Index = 0; Index < 4; Index++)
+   {
+    AppendUint32(Target,0);                   /* caps2-4 and reserved */
+   }
+
+  for (unsigned int Level = 0; Level < Levels.size(); Level++)
+   {
+    Target->insert(Target->end(),Levels[Level].Data.begin(),Levels[Level].Data.end());
+   }
+ }
+
+void               P3DCompressedTexture::MakeKTX
+                                      (std::vector<P3DByte>
+                                                          *Target) const
+ {
+  P3Duint32                            InternalFormat;
+
+  if      (Format == P3D_TEXCOMP_BC3)
+   {
+    InternalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT_;
+   }
+  else if (Format == P3D_TEXCOMP_BC1A)
+   {
+    InternalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT_;
+   }
+  else
+   {
+    InternalFormat = GL_COMPRESSED_RGB_S3TC_DXT1_EXT_;
+   }
+
+  Target->insert(Target->end(),KTXIdentifier,KTXIdentifier + sizeof(KTXIdentifier));
+
+  AppendUint32(Target,KTXEndianness);
+  AppendUint32(Target,0);                     /* glType */
+  AppendUint32(Target,1);                     /* glTypeSize */
+  AppendUint32(Target,0);                     /* glFormat */
+  AppendUint32(Target,InternalFormat);
+  AppendUint32(Target,Format == P3D_TEXCOMP_BC1 ? GL_RGB_ : GL_RGBA_);
+  AppendUint32(Target,Levels[0].Width);
+  AppendUint32(Target,Levels[0].Height);
+  AppendUint32(Target,0);                     /* pixelDepth */
+  AppendUint32(Target,0);                     /* numberOfArrayElements */
+  AppendUint32(Target,1);                     /* numberOfFaces */
+  AppendUint32(Target,Levels.size());
+  AppendUint32(Target,0);                     /* bytesOfKeyValueData */
+
+  /* block sizes are multiple of 4, so no mip padding is needed */
+  for (unsigned int Level = 0; Level < Levels.size(); Level++)
+   {
+    AppendUint32(Target,Levels[Level].Data.size());
+
+    Target->insert(Target->end(),Levels[Level].Data.begin(),Levels[Level].Data.end());
+   }
+ }
+
+bool               P3DCompressedTexture::Save
+                                      (const char         *FileName,
+                                       unsigned int        Container) const
+ {
+  std::vector<P3DByte>                 Buffer;
+  FILE                                *Target;
+  bool                                 Result;
+
+  if (Levels.empty())
+   {
+    return(false);
+   }
+
+  if (Container == P3D_TEXCOMP_CONTAINER_KTX)
+   {
+    MakeKTX(&Buffer);
+   }
+  else
+   {
+    MakeDDS(&Buffer);
+   }
+
+  Target = fopen(FileName,"wb");
+
+  if (Target == NULL)
+   {
+    return(false);
+   }
+
+  Result = fwrite(&Buffer[0],1,Buffer.size(),Target) == Buffer.size();
+
+  if (fclose(Target) != 0)
+   {
+    Result = false;
+   }
+
+  return(Result);
+ }
+
+unsigned int       P3DCompressedTexture::SelectFormat
+                                      (const P3DImageData *Image)
+ {
+  const P3DByte                       *Data;
+  unsigned int                         PixelCount;
+  bool                                 HasAlpha;
+
+  if (Image->GetChannelCount() != 4)
+   {
+    return(P3D_TEXCOMP_BC1);
+   }
+
+  Data       = (const P3DByte*)Image->GetConstData();
+  PixelCount = Image->GetWidth() * Image->GetHeight();
+  HasAlpha   = false;
+
+  for (unsigned int PixelIndex = 0; PixelIndex < PixelCount; PixelIndex++)
+   {
+    P3DByte        Alpha = Data[PixelIndex * 4 + 3];
+
+    if      (Alpha == 0)
+     {
+      HasAlpha = true;
+     }
+    else if (Alpha != 255)
+     {
+      return(P3D_TEXCOMP_BC3);
+     }
+   }
+
+  return(HasAlpha ? P3D_TEXCOMP_BC1A : P3D_TEXCOMP_BC1);
+ }
+
+const char        *P3DCompressedTexture::GetContainerExt
+                                      (unsigned int        Container)
+ {
+  return(Container == P3D_TEXCOMP_CONTAINER_KTX ? "ktx" : "dds");
+ }
+
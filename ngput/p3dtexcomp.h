@@ -0,0 +1,131 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#ifndef __P3DTEXCOMP_H__
+#define __P3DTEXCOMP_H__
+
+#include <vector>
+
+#include <ngpcore/p3dtypes.h>
+
+#include <ngput/p3dimage.h>
+#include <ngput/p3dtexprep.h>
+
+/* Block compression formats. BC1A is BC1 with 1-bit alpha (pixels with */
+/* alpha below 128 become fully transparent).                            */
+
+#define P3D_TEXCOMP_BC1              (0)
+#define P3D_TEXCOMP_BC1A             (1)
+#define P3D_TEXCOMP_BC3              (2)
+
+#define P3D_TEXCOMP_CONTAINER_DDS    (0)
+#define P3D_TEXCOMP_CONTAINER_KTX    (1)
+
+/* Block-compressed texture with mipmap chain. Rows are stored in the */
+/* same order as in source image (i.e. as they are passed to GL), so  */
+/* texture coordinates need no changes when texture is used with GL.  */
+
+class P3DCompressedTexture
+ {
+  public           :
+
+                   P3DCompressedTexture
+                                      ();
+
+  /* compresses all levels of Image, blocks are distributed among */
+  /* ThreadCount threads                                          */
+  bool             Create             (const P3DTexImage  *Image,
+                                       unsigned int        Format,
+                                       unsigned int        ThreadCount);
+
+  unsigned int     GetFormat          () const;
+  unsigned int     GetLevelCount      () const;
+  unsigned int     GetLevelWidth      (unsigned int        Level) const;
+  unsigned int     GetLevelHeight     (unsigned int        Level) const;
+  unsigned int     GetLevelSize       (unsigned int        Level) const;
+  const P3DByte   *GetLevelData       (unsigned int        Level) const;
+
+  /* appends complete container file to Target */
+  void             MakeDDS            (std::vector<P3DByte>
+                                                          *Target) const;
+  void             MakeKTX            (std::vector<P3DByte>
+                                                          *Target) const;
+
+  bool             Save               (const char         *FileName,
+                                       unsigned int        Container) const;
+
+  /* BC1 for opaque images, BC1A if alpha is either 0 or 255, */
+  /* BC3 otherwise                                            */
+  static
+  unsigned int     SelectFormat       (const P3DImageData *Image);
+
+  static
+  const char      *GetContainerExt    (unsigned int        Container);
+
+  private          :
+
+                   P3DCompressedTexture
+                                      (const P3DCompressedTexture
+                                                          &);
+  P3DCompressedTexture
+                  &operator =         (const P3DCompressedTexture
+                                                          &);
+
+  typedef struct
+   {
+    unsigned int   Width;
+    unsigned int   Height;
+    std::vector<P3DByte>
+                   Data;
+   } Level;
+
+  typedef struct
+   {
+    unsigned int   LevelIndex;
+    unsigned int   BlockRow;
+   } Job;
+
+  static void      WorkerProc         (void               *Arg);
+
+  void             ProcessJobs        ();
+  void             CompressBlockRow   (const Job          &BlockRowJob);
+
+  unsigned int                         Format;
+  std::vector<Level>                   Levels;
+
+  const P3DTexImage                   *Image;
+  std::vector<Job>                     Jobs;
+  unsigned int                         NextJob;
+  P3DMutex                             Mutex;
+ };
+
+#endif
+
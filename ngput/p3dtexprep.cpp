@@ -0,0 +1,559 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#include <ngpcore/p3ddefs.h>
+
+#include <ngput/p3dospath.h>
+#include <ngput/p3dtexprep.h>
+
+/* same rounding as used by GLU: 3 * 2^N and above goes up */
+static unsigned int NearestPowerOfTwo (unsigned int        Value)
+ {
+  unsigned int                         Result;
+
+  Result = 1;
+
+  while (Value > 1)
+   {
+    if (Value == 3)
+     {
+      return(Result * 4);
+     }
+
+    Value  >>= 1;
+    Result <<= 1;
+   }
+
+  return(Result);
+ }
+
+/* bilinear resampling, used for non power of two images only, so */
+/* scale factor is always in [2/3,4/3] range                      */
+static bool        ResampleImage      (P3DImageData       *TargetImage,
+                                       const P3DImageData *SourceImage,
+                                       unsigned int        Width,
+                                       unsigned int        Height)
+ {
+  unsigned int                         ChannelCount;
+  unsigned int                         SourceWidth;
+  unsigned int                         SourceHeight;
+  const P3DByte                       *Source;
+  P3DByte                             *Target;
+  float                                ScaleX;
+  float                                ScaleY;
+
+  ChannelCount = SourceImage->GetChannelCount();
+  SourceWidth  = SourceImage->GetWidth();
+  SourceHeight = SourceImage->GetHeight();
+
+  if (!TargetImage->Create(Width,Height,ChannelCount,P3D_BYTE))
+   {
+    return(false);
+   }
+
+  Source = (const P3DByte*)SourceImage->GetConstData();
+  Target = (P3DByte*)TargetImage->GetData();
+
+  ScaleX = (float)SourceWidth  / (float)Width;
+  ScaleY = (float)SourceHeight / (float)Height;
+
+  for (unsigned int Y = 0; Y < Height; Y++)
+   {
+    float          SY;
+    unsigned int   Y0;
+    unsigned int   Y1;
+    float          FY;
+
+    SY = (Y + 0.5f) * ScaleY - 0.5f;
+
+    if (SY < 0.0f)
+     {
+      SY = 0.0f;
+     }
+
+    Y0 = (unsigned int)SY;
+    Y1 = Y0 + 1 < SourceHeight ? Y0 + 1 : Y0;
+    FY = SY - Y0;
+
+    const P3DByte *Row0 = Source + Y0 * SourceWidth * ChannelCount;
+    const P3DByte *Row1 = Source + Y1 * SourceWidth * ChannelCount;
+
+    for (unsigned int X = 0; X < Width; X++)
+     {
+      float        SX;
+      unsigned int X0;
+      unsigned int X1;
+      float        FX;
+
+      SX = (X + 0.5f) * ScaleX - 0.5f;
+
+      if (SX < 0.0f)
+       {
+        SX = 0.0f;
+       }
+
+      X0 = (unsigned int)SX;
+      X1 = X0 + 1 < SourceWidth ? X0 + 1 : X0;
+      FX = SX - X0;
+
+      for (unsigned int Channel = 0; Channel < ChannelCount; Channel++)
+       {
+        float      Top;
+        float      Bottom;
+
+        Top    = Row0[X0 * ChannelCount + Channel] * (1.0f - FX) +
+                 Row0[X1 * ChannelCount + Channel] * FX;
+        Bottom = Row1[X0 * ChannelCount + Channel] * (1.0f - FX) +
+                 Row1[X1 * ChannelCount + Channel] * FX;
+
+        *Target++ = (P3DByte)(Top * (1.0f - FY) + Bottom * FY + 0.5f);
+       }
+     }
+   }
+
+  return(true);
+ }
+
+/* 2x2 box filter, source dimensions must be powers of two */
+static bool        DownsampleImage    (P3DImageData       *TargetImage,
+                                       const P3DImageData *SourceImage)
+ {
+  unsigned int                         ChannelCount;
+  unsigned int                         SourceRowSize;
+  unsigned int                         Width;
+  unsigned int                         Height;
+  unsigned int                         StepX;
+  unsigned int                         StepY;
+  const P3DByte                       *Source;
+  P3DByte                             *Target;
+
+  ChannelCount  = SourceImage->GetChannelCount();
+  SourceRowSize = SourceImage->GetWidth() * ChannelCount;
+
+  /* 1-pixel wide or high images are filtered in one direction only */
+  StepX = SourceImage->GetWidth()  > 1 ? ChannelCount  : 0;
+  StepY = SourceImage->GetHeight() > 1 ? SourceRowSize : 0;
+
+  Width  = SourceImage->GetWidth()  > 1 ? SourceImage->GetWidth()  / 2 : 1;
+  Height = SourceImage->GetHeight() > 1 ? SourceImage->GetHeight() / 2 : 1;
+
+  if (!TargetImage->Create(Width,Height,ChannelCount,P3D_BYTE))
+   {
+    return(false);
+   }
+
+  Source = (const P3DByte*)SourceImage->GetConstData();
+  Target = (P3DByte*)TargetImage->GetData();
+
+  for (unsigned int Y = 0; Y < Height; Y++)
+   {
+    const P3DByte *Row0 = Source + Y * 2 * StepY;
+    const P3DByte *Row1 = Row0 + StepY;
+
+    for (unsigned int X = 0; X < Width; X++)
+     {
+      for (unsigned int Channel = 0; Channel < ChannelCount; Channel++)
+       {
+        Target[Channel] = (P3DByte)((Row0[Channel] + Row0[Channel + StepX] +
+                                     Row1[Channel] + Row1[Channel + StepX] + 2) >> 2);
+       }
+
+      Target += ChannelCount;
+      Row0   += StepX * 2;
+      Row1   += StepX * 2;
+     }
+   }
+
+  return(true);
+ }
+
+                   P3DTexImage::P3DTexImage
+                                      ()
+ {
+  SourceImage = 0;
+ }
+
+                   P3DTexImage::~P3DTexImage
+                                      ()
+ {
+  Clear();
+ }
+
+void               P3DTexImage::Clear ()
+ {
+  for (unsigned int Level = 0; Level < Levels.size(); Level++)
+   {
+    if (Levels[Level] != SourceImage)
+     {
+      delete Levels[Level];
+     }
+   }
+
+  Levels.clear();
+
+  delete SourceImage;
+
+  SourceImage = 0;
+ }
+
+bool               P3DTexImage::Load  (const P3DImageFmtHandler
+                                                          *FmtHandler,
+                                       const char         *FileName,
+                                       unsigned int        MaxSize)
+ {
+  Clear();
+
+  SourceImage = new P3DImageData();
+
+  P3DPathName      PathName(FileName);
+  std::string      FileExt = PathName.GetExtension();
+
+  if (!FmtHandler->LoadImageData(SourceImage,FileName,FileExt.c_str()))
+   {
+    Clear();
+
+    return(false);
+   }
+
+  return(BuildLevels(MaxSize));
+ }
+
+bool               P3DTexImage::LoadMem
+                                      (const P3DImageFmtHandler
+                                                          *FmtHandler,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       const char         *FileExt,
+                                       unsigned int        MaxSize)
+ {
+  Clear();
+
+  SourceImage = new P3DImageData();
+
+  if (!FmtHandler->LoadImageDataMem(SourceImage,Data,Size,FileExt))
+   {
+    Clear();
+
+    return(false);
+   }
+
+  return(BuildLevels(MaxSize));
+ }
+
+bool               P3DTexImage::BuildLevels
+                                      (unsigned int        MaxSize)
+ {
+  P3DImageData                        *Level;
+  unsigned int                         Width;
+  unsigned int                         Height;
+
+  if ((SourceImage->GetChannelType() != P3D_BYTE) ||
+      ((SourceImage->GetChannelCount() != 3) &&
+       (SourceImage->GetChannelCount() != 4)))
+   {
+    Clear();
+
+    return(false);
+   }
+
+  if (MaxSize == 0)
+   {
+    return(true);
+   }
+
+  Width  = NearestPowerOfTwo(SourceImage->GetWidth());
+  Height = NearestPowerOfTwo(SourceImage->GetHeight());
+
+  if ((Width == SourceImage->GetWidth()) && (Height == SourceImage->GetHeight()))
+   {
+    Level = SourceImage;
+   }
+  else
+   {
+    Level = new P3DImageData();
+
+    if (!ResampleImage(Level,SourceImage,Width,Height))
+     {
+      delete Level;
+
+      Clear();
+
+      return(false);
+     }
+   }
+
+  Levels.push_back(Level);
+
+  while ((Level->GetWidth() > 1) || (Level->GetHeight() > 1))
+   {
+    Level = new P3DImageData();
+
+    if (!DownsampleImage(Level,Levels.back()))
+     {
+      delete Level;
+
+      Clear();
+
+      return(false);
+     }
+
+    /* levels larger than MaxSize are dropped */
+    if ((Levels.back()->GetWidth() > MaxSize) || (Levels.back()->GetHeight() > MaxSize))
+     {
+      if (Levels.back() != SourceImage)
+       {
+        delete Levels.back();
+       }
+
+      Levels.back() = Level;
+     }
+    else
+     {
+      Levels.push_back(Level);
+     }
+   }
+
+  return(true);
+ }
+
+const P3DImageData*P3DTexImage::GetSourceImage
+                                      () const
+ {
+  return(SourceImage);
+ }
+
+P3DImageData      *P3DTexImage::DetachSourceImage
+                                      ()
+ {
+  P3DImageData                        *Result;
+
+  Result = SourceImage;
+
+  for (unsigned int Level = 0; Level < Levels.size(); Level++)
+   {
+    if (Levels[Level] != SourceImage)
+     {
+      delete Levels[Level];
+     }
+   }
+
+  Levels.clear();
+
+  SourceImage = 0;
+
+  return(Result);
+ }
+
+unsigned int       P3DTexImage::GetLevelCount
+                                      () const
+ {
+  return(Levels.size());
+ }
+
+const P3DImageData*P3DTexImage::GetLevel
+                                      (unsigned int        Level) const
+ {
+  return(Levels[Level]);
+ }
+
+                   P3DTexPrepQueue::P3DTexPrepQueue
+                                      (const P3DImageFmtHandler
+                                                          *FmtHandler)
+ {
+  this->FmtHandler = FmtHandler;
+
+  NextRequest = 0;
+  MaxSize     = 0;
+ }
+
+                   P3DTexPrepQueue::~P3DTexPrepQueue
+                                      ()
+ {
+  for (unsigned int Index = 0; Index < Requests.size(); Index++)
+   {
+    delete Requests[Index].Image;
+   }
+ }
+
+unsigned int       P3DTexPrepQueue::Add
+                                      (const char         *FileName,
+                                       const char         *AltFileName)
+ {
+  Request                              NewRequest;
+
+  NewRequest.FileName       = FileName;
+  NewRequest.HasAltFileName = AltFileName != 0;
+  NewRequest.Loaded         = false;
+  NewRequest.AltFileLoaded  = false;
+  NewRequest.Image          = 0;
+
+  if (AltFileName != 0)
+   {
+    NewRequest.AltFileName = AltFileName;
+   }
+
+  Requests.push_back(NewRequest);
+
+  return(Requests.size() - 1);
+ }
+
+void               P3DTexPrepQueue::WorkerProc
+                                      (void               *Arg)
+ {
+  ((P3DTexPrepQueue*)Arg)->ProcessRequests();
+ }
+
+void               P3DTexPrepQueue::ProcessRequests
+                                      ()
+ {
+  unsigned int                         Index;
+
+  while (true)
+   {
+    Mutex.Lock();
+
+    Index = NextRequest;
+
+    if (NextRequest < Requests.size())
+     {
+      NextRequest++;
+     }
+
+    Mutex.Unlock();
+
+    if (Index >= Requests.size())
+     {
+      return;
+     }
+
+    Request       *Req   = &Requests[Index];
+    P3DTexImage   *Image = new P3DTexImage();
+
+    if      (Image->Load(FmtHandler,Req->FileName.c_str(),MaxSize))
+     {
+      Req->Image  = Image;
+      Req->Loaded = true;
+     }
+    else if ((Req->HasAltFileName) &&
+             (Image->Load(FmtHandler,Req->AltFileName.c_str(),MaxSize)))
+     {
+      Req->Image         = Image;
+      Req->Loaded        = true;
+      Req->AltFileLoaded = true;
+     }
+    else
+     {
+      delete Image;
+     }
+   }
+ }
+
+void               P3DTexPrepQueue::Run
+                                      (unsigned int        ThreadCount,
+                                       unsigned int        MaxSize)
+ {
+  std::vector<P3DThread*>              Threads;
+
+  this->MaxSize = MaxSize;
+
+  NextRequest = 0;
+
+  if (ThreadCount > Requests.size())
+   {
+    ThreadCount = Requests.size();
+   }
+
+  /* calling thread is a worker too */
+  for (unsigned int Index = 1; Index < ThreadCount; Index++)
+   {
+    P3DThread     *Thread = new P3DThread();
+
+    if (Thread->Start(WorkerProc,this))
+     {
+      Threads.push_back(Thread);
+     }
+    else
+     {
+      delete Thread;
+     }
+   }
+
+  ProcessRequests();
+
+  for (unsigned int Index = 0; Index < Threads.size(); Index++)
+   {
+    Threads[Index]->Join();
+
+    delete Threads[Index];
+   }
+ }
+
+unsigned int       P3DTexPrepQueue::GetCount
+                                      () const
+ {
+  return(Requests.size());
+ }
+
+const char        *P3DTexPrepQueue::GetFileName
+                                      (unsigned int        Index) const
+ {
+  if (!Requests[Index].Loaded)
+   {
+    return(0);
+   }
+  else if (Requests[Index].AltFileLoaded)
+   {
+    return(Requests[Index].AltFileName.c_str());
+   }
+  else
+   {
+    return(Requests[Index].FileName.c_str());
+   }
+ }
+
+P3DTexImage       *P3DTexPrepQueue::GetImage
+                                      (unsigned int        Index) const
+ {
+  return(Requests[Index].Image);
+ }
+
+P3DTexImage       *P3DTexPrepQueue::DetachImage
+                                      (unsigned int        Index)
+ {
+  P3DTexImage                         *Image;
+
+  Image = Requests[Index].Image;
+
+  Requests[Index].Image = 0;
+
+  return(Image);
+ }
+
@@ -0,0 +1,151 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#ifndef __P3DTEXPREP_H__
+#define __P3DTEXPREP_H__
+
+#include <string>
+#include <vector>
+
+#include <ngput/p3dimage.h>
+#include <ngput/p3dthread.h>
+
+/* Decoded texture image with CPU-generated mipmap chain */
+class P3DTexImage
+ {
+  public           :
+
+                   P3DTexImage        ();
+                  ~P3DTexImage        ();
+
+  /* Loads RGB or RGBA image. If MaxSize is not zero, image is scaled to */
+  /* nearest power of two size (as gluBuild2DMipmaps does), and mipmap   */
+  /* chain with base level not larger than MaxSize is generated.         */
+  bool             Load               (const P3DImageFmtHandler
+                                                          *FmtHandler,
+                                       const char         *FileName,
+                                       unsigned int        MaxSize);
+  /* same as Load, but decodes in-memory file contents, FileExt */
+  /* selects image format                                       */
+  bool             LoadMem            (const P3DImageFmtHandler
+                                                          *FmtHandler,
+                                       const void         *Data,
+                                       unsigned int        Size,
+                                       const char         *FileExt,
+                                       unsigned int        MaxSize);
+
+  /* image as it was loaded from file */
+  const P3DImageData
+                  *GetSourceImage     () const;
+  /* caller takes ownership, mipmap chain is released */
+  P3DImageData    *DetachSourceImage  ();
+
+  unsigned int     GetLevelCount      () const;
+  const P3DImageData
+                  *GetLevel           (unsigned int        Level) const;
+
+  /* creates texture object and uploads all mipmap levels, must be */
+  /* called from thread owning GL context                          */
+  unsigned int     CreateGLTexture    () const;
+
+  static
+  unsigned int     GetGLMaxSize       ();
+
+  private          :
+
+                   P3DTexImage        (const P3DTexImage  &);
+  P3DTexImage     &operator =         (const P3DTexImage  &);
+
+  void             Clear              ();
+  bool             BuildLevels        (unsigned int        MaxSize);
+
+  P3DImageData                        *SourceImage;
+  /* Levels[0] may be the same object as SourceImage */
+  std::vector<P3DImageData*>           Levels;
+ };
+
+/* Loads set of textures using several threads. Only Add and Run */
+/* must be called from thread owning GL context.                 */
+class P3DTexPrepQueue
+ {
+  public           :
+
+                   P3DTexPrepQueue    (const P3DImageFmtHandler
+                                                          *FmtHandler);
+                  ~P3DTexPrepQueue    ();
+
+  /* AltFileName (may be 0) is tried if FileName can not be loaded */
+  unsigned int     Add                (const char         *FileName,
+                                       const char         *AltFileName);
+
+  /* blocks until all requests are processed, see P3DTexImage::Load */
+  /* for MaxSize meaning                                            */
+  void             Run                (unsigned int        ThreadCount,
+                                       unsigned int        MaxSize);
+
+  unsigned int     GetCount           () const;
+
+  /* returns name of file image was loaded from, or 0 on failure */
+  const char      *GetFileName        (unsigned int        Index) const;
+  P3DTexImage     *GetImage           (unsigned int        Index) const;
+  /* caller takes ownership */
+  P3DTexImage     *DetachImage        (unsigned int        Index);
+
+  private          :
+
+                   P3DTexPrepQueue    (const P3DTexPrepQueue
+                                                          &);
+  P3DTexPrepQueue &operator =         (const P3DTexPrepQueue
+                                                          &);
+
+  typedef struct
+   {
+    std::string    FileName;
+    std::string    AltFileName;
+    bool           HasAltFileName;
+    bool           Loaded;
+    bool           AltFileLoaded;
+    P3DTexImage   *Image;
+   } Request;
+
+  static void      WorkerProc         (void               *Arg);
+
+  void             ProcessRequests    ();
+
+  const P3DImageFmtHandler            *FmtHandler;
+  std::vector<Request>                 Requests;
+  unsigned int                         NextRequest;
+  unsigned int                         MaxSize;
+  P3DMutex                             Mutex;
+ };
+
+#endif
+
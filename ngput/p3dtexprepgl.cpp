@@ -0,0 +1,90 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#include <ngput/p3dglext.h>
+#include <ngput/p3dtexprep.h>
+
+/* GL part of P3DTexImage is kept separately, so tools which do not */
+/* link with GL still can use CPU texture preparation              */
+
+unsigned int       P3DTexImage::CreateGLTexture
+                                      () const
+ {
+  GLuint                               Handle;
+  GLenum                               Format;
+
+  if (Levels.empty())
+   {
+    return(0);
+   }
+
+  Format = Levels[0]->GetChannelCount() == 3 ? GL_RGB : GL_RGBA;
+
+  glGenTextures(1,&Handle);
+
+  glBindTexture(GL_TEXTURE_2D,Handle);
+  glPixelStorei(GL_UNPACK_ALIGNMENT,1);
+  glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
+  glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
+  glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+
+  for (unsigned int Level = 0; Level < Levels.size(); Level++)
+   {
+    glTexImage2D(GL_TEXTURE_2D,
+                 Level,
+                 Format,
+                 Levels[Level]->GetWidth(),
+                 Levels[Level]->GetHeight(),
+                 0,
+                 Format,
+                 GL_UNSIGNED_BYTE,
+                 Levels[Level]->GetConstData());
+   }
+
+  glBindTexture(GL_TEXTURE_2D,0);
+
+  return(Handle);
+ }
+
+unsigned int       P3DTexImage::GetGLMaxSize
+                                      ()
+ {
+  GLint                                MaxSize;
+
+  MaxSize = 0;
+
+  glGetIntegerv(GL_MAX_TEXTURE_SIZE,&MaxSize);
+
+  /* be conservative if GL has no opinion */
+  return(MaxSize > 0 ? (unsigned int)MaxSize : 256);
+ }
+
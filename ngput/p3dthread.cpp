@@ -0,0 +1,167 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#if !defined(_WIN32)
+ #include <unistd.h>
+#endif
+
+#include <ngput/p3dthread.h>
+
+                   P3DThread::P3DThread
+                                      ()
+ {
+  Func    = 0;
+  Arg     = 0;
+  Running = false;
+ }
+
+#ifdef _WIN32
+DWORD WINAPI       P3DThread::ThreadProc
+                                      (LPVOID              Param)
+ {
+  P3DThread                           *Thread;
+
+  Thread = (P3DThread*)Param;
+
+  Thread->Func(Thread->Arg);
+
+  return(0);
+ }
+#else
+void              *P3DThread::ThreadProc
+                                      (void               *Param)
+ {
+  P3DThread                           *Thread;
+
+  Thread = (P3DThread*)Param;
+
+  Thread->Func(Thread->Arg);
+
+  return(0);
+ }
+#endif
+
+bool               P3DThread::Start   (P3DThreadFunc       Func,
+                                       void               *Arg)
+ {
+  if (Running)
+   {
+    return(false);
+   }
+
+  this->Func = Func;
+  this->Arg  = Arg;
+
+  #ifdef _WIN32
+  Handle = CreateThread(NULL,0,ThreadProc,this,0,NULL);
+
+  Running = Handle != NULL;
+  #else
+  Running = pthread_create(&Handle,NULL,ThreadProc,this) == 0;
+  #endif
+
+  return(Running);
+ }
+
+void               P3DThread::Join    ()
+ {
+  if (Running)
+   {
+    #ifdef _WIN32
+    WaitForSingleObject(Handle,INFINITE);
+    CloseHandle(Handle);
+    #else
+    pthread_join(Handle,NULL);
+    #endif
+
+    Running = false;
+   }
+ }
+
+unsigned int       P3DThread::GetCPUCount
+                                      ()
+ {
+  long                                 Count;
+
+  #ifdef _WIN32
+  SYSTEM_INFO                          SystemInfo;
+
+  GetSystemInfo(&SystemInfo);
+
+  Count = SystemInfo.dwNumberOfProcessors;
+  #else
+  Count = sysconf(_SC_NPROCESSORS_ONLN);
+  #endif
+
+  if (Count < 1)
+   {
+    Count = 1;
+   }
+
+  return((unsigned int)Count);
+ }
+
+                   P3DMutex::P3DMutex ()
+ {
+  #ifdef _WIN32
+  InitializeCriticalSection(&Section);
+  #else
+  pthread_mutex_init(&Mutex,NULL);
+  #endif
+ }
+
+                   P3DMutex::~P3DMutex()
+ {
+  #ifdef _WIN32
+  DeleteCriticalSection(&Section);
+  #else
+  pthread_mutex_destroy(&Mutex);
+  #endif
+ }
+
+void               P3DMutex::Lock     ()
+ {
+  #ifdef _WIN32
+  EnterCriticalSection(&Section);
+  #else
+  pthread_mutex_lock(&Mutex);
+  #endif
+ }
+
+void               P3DMutex::Unlock   ()
+ {
+  #ifdef _WIN32
+  LeaveCriticalSection(&Section);
+  #else
+  pthread_mutex_unlock(&Mutex);
+  #endif
+ }
+
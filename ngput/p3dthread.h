@@ -0,0 +1,106 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#ifndef __P3DTHREAD_H__
+#define __P3DTHREAD_H__
+
+#ifdef _WIN32
+ #define WIN32_LEAN_AND_MEAN 1
+ #include <windows.h>
+#else
+ #include <pthread.h>
+#endif
+
+typedef void     (*P3DThreadFunc)     (void               *Arg);
+
+/* Minimal portable thread wrapper. Thread must be joined before */
+/* wrapper destruction.                                           */
+class P3DThread
+ {
+  public           :
+
+                   P3DThread          ();
+
+  bool             Start              (P3DThreadFunc       Func,
+                                       void               *Arg);
+  void             Join               ();
+
+  static
+  unsigned int     GetCPUCount        ();
+
+  private          :
+
+                   P3DThread          (const P3DThread    &);
+  P3DThread       &operator =         (const P3DThread    &);
+
+  #ifdef _WIN32
+  static
+  DWORD WINAPI     ThreadProc         (LPVOID              Param);
+  #else
+  static
+  void            *ThreadProc         (void               *Param);
+  #endif
+
+  P3DThreadFunc                        Func;
+  void                                *Arg;
+  bool                                 Running;
+
+  #ifdef _WIN32
+  HANDLE                               Handle;
+  #else
+  pthread_t                            Handle;
+  #endif
+ };
+
+class P3DMutex
+ {
+  public           :
+
+                   P3DMutex           ();
+                  ~P3DMutex           ();
+
+  void             Lock               ();
+  void             Unlock             ();
+
+  private          :
+
+                   P3DMutex           (const P3DMutex     &);
+  P3DMutex        &operator =         (const P3DMutex     &);
+
+  #ifdef _WIN32
+  CRITICAL_SECTION                     Section;
+  #else
+  pthread_mutex_t                      Mutex;
+  #endif
+ };
+
+#endif
+
@@ -0,0 +1,857 @@
+/***************************************************************************
+
+ Copyright (C) 2007  Sergey Prokhorchuk
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***************************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <vector>
+
+#include <ngpcore/p3dmath.h>
+#include <ngpcore/p3dhli.h>
+
+#include "ngpforest.h"
+
+#define NGPForestVertexSize      (8) /* floats per vertex   */
+#define NGPForestInstanceSize    (8) /* floats per instance */
+
+#define NGPForestOffsetScaleAttr (6)
+#define NGPForestRotationAttr    (7)
+
+/* angle between neighbouring plants rotations (golden angle) */
+#define NGPForestPlantRotStep    (2.39996323f)
+
+static const char ShaderSrcCommon[] =
+ "attribute vec4 InstanceOffsetScale;\n"
+ "attribute vec4 InstanceRotation;\n"
+ "varying vec2 TexCoord;\n"
+ "vec3 RotateVector(vec4 q,vec3 v)\n"
+ " {\n"
+ "  vec3 t = 2.0 * cross(q.xyz,v);\n"
+ "  return(v + q.w * t + cross(q.xyz,t));\n"
+ " }\n"
+ "vec3 InstanceTransform(vec3 v)\n"
+ " {\n"
+ "  return(InstanceOffsetScale.xyz + RotateVector(InstanceRotation,v * InstanceOffsetScale.w));\n"
+ " }\n"
+ "vec4 LightColor(float NdotL)\n"
+ " {\n"
+ "  return(vec4(gl_Color.rgb * (gl_LightModel.ambient.rgb +\n"
+ "                              gl_LightSource[0].ambient.rgb +\n"
+ "                              gl_LightSource[0].diffuse.rgb * max(NdotL,0.0)),\n"
+ "              gl_Color.a));\n"
+ " }\n"
+ "void CalcLighting(vec4 EyePos,vec3 Normal)\n"
+ " {\n"
+ "  float NdotL = dot(Normal,normalize(gl_LightSource[0].position.xyz - EyePos.xyz));\n"
+ "  gl_FrontColor = LightColor(NdotL);\n"
+ "  gl_BackColor  = LightColor(-NdotL);\n"
+ "  TexCoord      = gl_MultiTexCoord0.xy;\n"
+ " }\n";
+
+static const char ShaderSrcMeshVertex[] =
+ "void main()\n"
+ " {\n"
+ "  vec4 EyePos = gl_ModelViewMatrix * vec4(InstanceTransform(gl_Vertex.xyz),1.0);\n"
+ "  vec3 Normal = normalize(gl_NormalMatrix * RotateVector(InstanceRotation,gl_Normal));\n"
+ "  gl_Position = gl_ProjectionMatrix * EyePos;\n"
+ "  CalcLighting(EyePos,Normal);\n"
+ " }\n";
+
+/* corner of billboard (-1/+1 for x and y) is stored in normal */
+static const char ShaderSrcBillboardVertex[] =
+ "uniform vec2  HalfSize;\n"
+ "uniform float Cylindrical;\n"
+ "void main()\n"
+ " {\n"
+ "  vec3 Right = vec3(gl_ModelViewMatrix[0][0],gl_ModelViewMatrix[1][0],gl_ModelViewMatrix[2][0]);\n"
+ "  vec3 Up    = vec3(gl_ModelViewMatrix[0][1],gl_ModelViewMatrix[1][1],gl_ModelViewMatrix[2][1]);\n"
+ "  if (Cylindrical > 0.5) Up.xz = vec2(0.0,0.0);\n"
+ "  vec3 Pos = InstanceTransform(gl_Vertex.xyz) +\n"
+ "             Right * (gl_Normal.x * HalfSize.x) +\n"
+ "             Up    * (gl_Normal.y * HalfSize.y);\n"
+ "  vec4 EyePos = gl_ModelViewMatrix * vec4(Pos,1.0);\n"
+ "  gl_Position = gl_ProjectionMatrix * EyePos;\n"
+ "  CalcLighting(EyePos,vec3(0.0,0.0,1.0));\n"
+ " }\n";
+
+static const char ShaderSrcFragment[] =
+ "uniform sampler2D DiffuseTexture;\n"
+ "uniform float     HaveTexture;\n"
+ "varying vec2 TexCoord;\n"
+ "void main()\n"
+ " {\n"
+ "  vec4 Result = gl_Color;\n"
+ "  if (HaveTexture > 0.5) Result *= texture2D(DiffuseTexture,TexCoord);\n"
+ "  gl_FragColor = Result;\n"
+ " }\n";
+
+static void        DumpInfoLog        (GLhandleARB         Handle)
+ {
+  GLint                                LogSize;
+  GLcharARB                           *Log;
+
+  glGetObjectParameterivARB(Handle,GL_OBJECT_INFO_LOG_LENGTH_ARB,&LogSize);
+
+  if (LogSize > 1)
+   {
+    Log = (GLcharARB*)malloc(LogSize);
+
+    if (Log != NULL)
+     {
+      glGetInfoLogARB(Handle,LogSize,NULL,Log);
+
+      fprintf(stderr,"shader log:\n%s\n",Log);
+
+      free(Log);
+     }
+   }
+ }
+
+static bool        AttachShader       (GLhandleARB         ProgHandle,
+                                       GLenum              ShaderType,
+                                       GLsizei             SrcStringsCount,
+                                       const GLcharARB   **SrcStrings)
+ {
+  GLhandleARB                          ShaderHandle;
+  GLint                                CompileStatus;
+
+  ShaderHandle = glCreateShaderObjectARB(ShaderType);
+
+  if (ShaderHandle == 0)
+   {
+    fprintf(stderr,"error: unable to create GLSL shader object\n");
+
+    return(false);
+   }
+
+  glShaderSourceARB(ShaderHandle,SrcStringsCount,SrcStrings,NULL);
+  glCompileShaderARB(ShaderHandle);
+  glGetObjectParameterivARB(ShaderHandle,GL_OBJECT_COMPILE_STATUS_ARB,&CompileStatus);
+
+  if (CompileStatus == 0)
+   {
+    DumpInfoLog(ShaderHandle);
+
+    glDeleteObjectARB(ShaderHandle);
+
+    return(false);
+   }
+
+  glAttachObjectARB(ProgHandle,ShaderHandle);
+  glDeleteObjectARB(ShaderHandle);
+
+  return(true);
+ }
+
+static GLhandleARB CreateProgram      (const char         *VertexSrc)
+ {
+  GLhandleARB                          ProgHandle;
+  const GLcharARB                     *VertexSrcStrings[2];
+  const GLcharARB                     *FragmentSrcStrings[1];
+  GLint                                LinkStatus;
+
+  ProgHandle = glCreateProgramObjectARB();
+
+  if (ProgHandle == 0)
+   {
+    fprintf(stderr,"error: unable to create GLSL program object\n");
+
+    return(0);
+   }
+
+  VertexSrcStrings[0]   = ShaderSrcCommon;
+  VertexSrcStrings[1]   = VertexSrc;
+  FragmentSrcStrings[0] = ShaderSrcFragment;
+
+  if ((!AttachShader(ProgHandle,GL_VERTEX_SHADER_ARB,2,VertexSrcStrings)) ||
+      (!AttachShader(ProgHandle,GL_FRAGMENT_SHADER_ARB,1,FragmentSrcStrings)))
+   {
+    glDeleteObjectARB(ProgHandle);
+
+    return(0);
+   }
+
+  glBindAttribLocationARB(ProgHandle,NGPForestOffsetScaleAttr,"InstanceOffsetScale");
+  glBindAttribLocationARB(ProgHandle,NGPForestRotationAttr,"InstanceRotation");
+
+  glLinkProgramARB(ProgHandle);
+  glGetObjectParameterivARB(ProgHandle,GL_OBJECT_LINK_STATUS_ARB,&LinkStatus);
+
+  if (LinkStatus == 0)
+   {
+    DumpInfoLog(ProgHandle);
+
+    glDeleteObjectARB(ProgHandle);
+
+    return(0);
+   }
+
+  glUseProgramObjectARB(ProgHandle);
+  glUniform1iARB(glGetUniformLocationARB(ProgHandle,"DiffuseTexture"),0);
+  glUseProgramObjectARB(0);
+
+  return(ProgHandle);
+ }
+
+/* Result = Parent * Child, where transform is offset + scale + rotation */
+static void        CombineTransforms  (float              *Result,
+                                       const float        *Parent,
+                                       const float        *Child)
+ {
+  Result[0] = Child[0] * Parent[3];
+  Result[1] = Child[1] * Parent[3];
+  Result[2] = Child[2] * Parent[3];
+
+  P3DQuaternionf::RotateVector(Result,&Parent[4]);
+
+  Result[0] += Parent[0];
+  Result[1] += Parent[1];
+  Result[2] += Parent[2];
+  Result[3]  = Parent[3] * Child[3];
+
+  P3DQuaternionf::CrossProduct(&Result[4],&Parent[4],&Child[4]);
+ }
+
+                   NGPViewForest::NGPViewForest
+                                      ()
+ {
+  MeshProgram      = 0;
+  BillboardProgram = 0;
+
+  MeshHaveTexLocation          = -1;
+  BillboardHaveTexLocation     = -1;
+  BillboardHalfSizeLocation    = -1;
+  BillboardCylindricalLocation = -1;
+
+  BBoxMin[0] = BBoxMin[1] = BBoxMin[2] = 0.0f;
+  BBoxMax[0] = BBoxMax[1] = BBoxMax[2] = 0.0f;
+
+  DrawCallCount = 0;
+  TriangleCount = 0;
+ }
+
+                   NGPViewForest::~NGPViewForest
+                                      ()
+ {
+  for (unsigned int BatchIndex = 0; BatchIndex < Batches.size(); BatchIndex++)
+   {
+    glDeleteBuffersARB(1,&Batches[BatchIndex].VertexBuffer);
+    glDeleteBuffersARB(1,&Batches[BatchIndex].IndexBuffer);
+    glDeleteBuffersARB(1,&Batches[BatchIndex].InstanceBuffer);
+   }
+
+  if (MeshProgram != 0)
+   {
+    glDeleteObjectARB(MeshProgram);
+   }
+
+  if (BillboardProgram != 0)
+   {
+    glDeleteObjectARB(BillboardProgram);
+   }
+ }
+
+bool               NGPViewForest::IsSupported
+                                      ()
+ {
+  return(GLEW_ARB_vertex_buffer_object &&
+         GLEW_ARB_shader_objects       &&
+         GLEW_ARB_vertex_shader        &&
+         GLEW_ARB_fragment_shader      &&
+         GLEW_ARB_instanced_arrays);
+ }
+
+bool               NGPViewForest::CreatePrograms
+                                      ()
+ {
+  MeshProgram      = CreateProgram(ShaderSrcMeshVertex);
+  BillboardProgram = CreateProgram(ShaderSrcBillboardVertex);
+
+  if ((MeshProgram == 0) || (BillboardProgram == 0))
+   {
+    return(false);
+   }
+
+  MeshHaveTexLocation          = glGetUniformLocationARB(MeshProgram,"HaveTexture");
+  BillboardHaveTexLocation     = glGetUniformLocationARB(BillboardProgram,"HaveTexture");
+  BillboardHalfSizeLocation    = glGetUniformLocationARB(BillboardProgram,"HalfSize");
+  BillboardCylindricalLocation = glGetUniformLocationARB(BillboardProgram,"Cylindrical");
+
+  return(true);
+ }
+
+void               NGPViewForest::AddBatch
+                                      (const float        *Vertices,
+                                       unsigned int        VertexCount,
+                                       const unsigned int *Indices,
+                                       unsigned int        IndexCount,
+                                       const float        *Instances,
+                                       unsigned int        InstanceCount,
+                                       const NGPForestBatch
+                                                          *Material)
+ {
+  NGPForestBatch                       Batch;
+
+  if ((VertexCount == 0) || (IndexCount == 0) || (InstanceCount == 0))
+   {
+    return;
+   }
+
+  Batch = *Material;
+
+  Batch.IndexCount    = IndexCount;
+  Batch.InstanceCount = InstanceCount;
+
+  glGenBuffersARB(1,&Batch.VertexBuffer);
+  glBindBufferARB(GL_ARRAY_BUFFER_ARB,Batch.VertexBuffer);
+  glBufferDataARB(GL_ARRAY_BUFFER_ARB,
+                  VertexCount * NGPForestVertexSize * sizeof(float),
+                  Vertices,
+                  GL_STATIC_DRAW_ARB);
+
+  glGenBuffersARB(1,&Batch.InstanceBuffer);
+  glBindBufferARB(GL_ARRAY_BUFFER_ARB,Batch.InstanceBuffer);
+  glBufferDataARB(GL_ARRAY_BUFFER_ARB,
+                  InstanceCount * NGPForestInstanceSize * sizeof(float),
+                  Instances,
+                  GL_STATIC_DRAW_ARB);
+
+  glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+
+  glGenBuffersARB(1,&Batch.IndexBuffer);
+  glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,Batch.IndexBuffer);
+  glBufferDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB,
+                  IndexCount * sizeof(unsigned int),
+                  Indices,
+                  GL_STATIC_DRAW_ARB);
+  glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
+
+  Batches.push_back(Batch);
+ }
+
+static void        GetGroupMaterial   (NGPForestBatch     *Material,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       unsigned int        GroupIndex,
+                                       NGPTexManager      *TexManager)
+ {
+  const P3DMaterialDef                *MaterialDef;
+  const char                          *TexName;
+
+  MaterialDef = Template->GetMaterial(GroupIndex);
+
+  MaterialDef->GetColor(&Material->R,&Material->G,&Material->B);
+
+  TexName = MaterialDef->GetTexName(P3D_TEX_DIFFUSE);
+
+  Material->TexHandle = TexName != 0 ? TexManager->LoadTexture(TexName) : 0;
+
+  if ((TexName != 0) && (Material->TexHandle == 0))
+   {
+    fprintf(stderr,"warning: unable to load texture \"%s\" - texture will not be used\n",TexName);
+   }
+
+  Material->DoubleSided   = MaterialDef->IsDoubleSided();
+  Material->Transparent   = MaterialDef->IsTransparent();
+  Material->Billboard     = MaterialDef->IsBillboard();
+  Material->BillboardMode = MaterialDef->GetBillboardMode();
+
+  if (Material->Billboard)
+   {
+    Template->GetBillboardSize(&Material->BillboardWidth,
+                               &Material->BillboardHeight,
+                                GroupIndex);
+   }
+  else
+   {
+    Material->BillboardWidth  = 0.0f;
+    Material->BillboardHeight = 0.0f;
+   }
+ }
+
+/* fill interleaved vertex buffer, baked (Instance != 0) or clone geometry */
+static void        GetGroupVertices   (std::vector<float> *Vertices,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       const P3DHLIPlantInstance
+                                                          *Instance,
+                                       unsigned int        GroupIndex,
+                                       bool                Billboard)
+ {
+  P3DHLIVAttrBuffers                   VAttrBuffers;
+  unsigned int                         VertexCount;
+
+  if (Instance != 0)
+   {
+    VertexCount = Instance->GetVAttrCountI(GroupIndex);
+   }
+  else
+   {
+    VertexCount = Template->GetVAttrCountI(GroupIndex);
+   }
+
+  Vertices->assign(VertexCount * NGPForestVertexSize,0.0f);
+
+  if (VertexCount == 0)
+   {
+    return;
+   }
+
+  if (Billboard)
+   {
+    VAttrBuffers.AddAttr(P3D_ATTR_BILLBOARD_POS,&(*Vertices)[0],0,NGPForestVertexSize * sizeof(float));
+   }
+  else
+   {
+    VAttrBuffers.AddAttr(P3D_ATTR_VERTEX,&(*Vertices)[0],0,NGPForestVertexSize * sizeof(float));
+    VAttrBuffers.AddAttr(P3D_ATTR_NORMAL,&(*Vertices)[0],3 * sizeof(float),NGPForestVertexSize * sizeof(float));
+   }
+
+  VAttrBuffers.AddAttr(P3D_ATTR_TEXCOORD0,&(*Vertices)[0],6 * sizeof(float),NGPForestVertexSize * sizeof(float));
+
+  if (Instance != 0)
+   {
+    Instance->FillVAttrBuffersI(&VAttrBuffers,GroupIndex);
+   }
+  else
+   {
+    Template->FillCloneVAttrBuffersI(&VAttrBuffers,GroupIndex);
+   }
+
+  if (Billboard)
+   {
+    /* billboard vertices go in lower-left, lower-right, upper-left, */
+    /* upper-right order                                              */
+    for (unsigned int Index = 0; Index < VertexCount; Index++)
+     {
+      (*Vertices)[Index * NGPForestVertexSize + 3] = (Index & 1) ? 1.0f : -1.0f;
+      (*Vertices)[Index * NGPForestVertexSize + 4] = (Index & 2) ? 1.0f : -1.0f;
+     }
+   }
+ }
+
+static void        GetGroupIndices    (std::vector<unsigned int>
+                                                          *Indices,
+                                       const P3DHLIPlantTemplate
+                                                          *Template,
+                                       unsigned int        GroupIndex,
+                                       unsigned int        BranchCount,
+                                       bool                Billboard)
+ {
+  unsigned int                         BranchIndexCount;
+  unsigned int                         BranchAttrCount;
+
+  if (Billboard)
+   {
+    static const unsigned int          QuadIndices[] = { 2, 0, 1, 2, 1, 3 };
+
+    Indices->resize(BranchCount * 6);
+
+    for (unsigned int BranchIndex = 0; BranchIndex < BranchCount; BranchIndex++)
+     {
+      for (unsigned int Index = 0; Index < 6; Index++)
+       {
+        (*Indices)[BranchIndex * 6 + Index] = BranchIndex * 4 + QuadIndices[Index];
+       }
+     }
+
+    return;
+   }
+
+  BranchIndexCount = Template->GetIndexCount(GroupIndex,P3D_TRIANGLE_LIST);
+  BranchAttrCount  = Template->GetVAttrCountI(GroupIndex);
+
+  Indices->resize(BranchIndexCount * BranchCount);
+
+  if (Indices->empty())
+   {
+    return;
+   }
+
+  for (unsigned int BranchIndex = 0; BranchIndex < BranchCount; BranchIndex++)
+   {
+    Template->FillIndexBuffer(&(*Indices)[BranchIndex * BranchIndexCount],
+                              GroupIndex,
+                              P3D_TRIANGLE_LIST,
+                              P3D_UNSIGNED_INT,
+                              BranchAttrCount * BranchIndex);
+   }
+ }
+
+bool               NGPViewForest::Create
+                                      (const P3DHLIPlantTemplate
+                                                          *Template,
+                                       unsigned int        PlantCount,
+                                       unsigned int        VariantCount,
+                                       NGPTexManager      *TexManager)
+ {
+  std::vector<P3DHLIPlantInstance*>    Variants;
+  std::vector<float>                   PlantTransforms;
+  std::vector<float>                   Vertices;
+  std::vector<unsigned int>            Indices;
+  std::vector<float>                   Instances;
+  float                                VariantMin[3];
+  float                                VariantMax[3];
+  float                                Spacing;
+  float                                Radius;
+  unsigned int                         GridSize;
+
+  if (!CreatePrograms())
+   {
+    return(false);
+   }
+
+  if (PlantCount == 0)
+   {
+    PlantCount = 1;
+   }
+
+  if      (VariantCount == 0)
+   {
+    VariantCount = 1;
+   }
+  else if (VariantCount > PlantCount)
+   {
+    VariantCount = PlantCount;
+   }
+
+  /* variant 0 uses model base seed */
+  for (unsigned int VariantIndex = 0; VariantIndex < VariantCount; VariantIndex++)
+   {
+    Variants.push_back(Template->CreateInstance(VariantIndex * 7919));
+   }
+
+  Radius = 0.0f;
+
+  for (unsigned int VariantIndex = 0; VariantIndex < VariantCount; VariantIndex++)
+   {
+    Variants[VariantIndex]->GetBoundingBox(VariantMin,VariantMax);
+
+    for (unsigned int Axis = 0; Axis < 3; Axis += 2)
+     {
+      if (fabsf(VariantMin[Axis]) > Radius) Radius = fabsf(VariantMin[Axis]);
+      if (fabsf(VariantMax[Axis]) > Radius) Radius = fabsf(VariantMax[Axis]);
+     }
+
+    if (VariantIndex == 0)
+     {
+      BBoxMin[1] = VariantMin[1];
+      BBoxMax[1] = VariantMax[1];
+     }
+    else
+     {
+      if (VariantMin[1] < BBoxMin[1]) BBoxMin[1] = VariantMin[1];
+      if (VariantMax[1] > BBoxMax[1]) BBoxMax[1] = VariantMax[1];
+     }
+   }
+
+  Spacing = Radius > 0.0f ? Radius * 2.0f : 1.0f;
+
+  GridSize = (unsigned int)ceilf(sqrtf((float)PlantCount));
+
+  /* each plant is rotated around Y axis to hide repeating variants */
+  PlantTransforms.resize(PlantCount * NGPForestInstanceSize);
+
+  for (unsigned int PlantIndex = 0; PlantIndex < PlantCount; PlantIndex++)
+   {
+    float                             *Transform;
+    P3DQuaternionf                     Rotation;
+
+    Transform = &PlantTransforms[PlantIndex * NGPForestInstanceSize];
+
+    Transform[0] = ((PlantIndex % GridSize) - (GridSize - 1) * 0.5f) * Spacing;
+    Transform[1] = 0.0f;
+    Transform[2] = ((PlantIndex / GridSize) - (GridSize - 1) * 0.5f) * Spacing;
+    Transform[3] = 1.0f;
+
+    Rotation.FromAxisAndAngle(0.0f,1.0f,0.0f,PlantIndex * NGPForestPlantRotStep);
+
+    Transform[4] = Rotation.q[0];
+    Transform[5] = Rotation.q[1];
+    Transform[6] = Rotation.q[2];
+    Transform[7] = Rotation.q[3];
+   }
+
+  BBoxMax[0] = BBoxMax[2] = (GridSize - 1) * 0.5f * Spacing + Radius;
+  BBoxMin[0] = BBoxMin[2] = -BBoxMax[0];
+
+  for (unsigned int GroupIndex = 0; GroupIndex < Template->GetGroupCount(); GroupIndex++)
+   {
+    NGPForestBatch                     Material;
+
+    GetGroupMaterial(&Material,Template,GroupIndex,TexManager);
+
+    if ((!Material.Billboard) && (Template->IsCloneable(GroupIndex,true)))
+     {
+      std::vector<float>               Offsets;
+      std::vector<float>               Rotations;
+      std::vector<float>               Scales;
+
+      Instances.clear();
+
+      for (unsigned int VariantIndex = 0; VariantIndex < VariantCount; VariantIndex++)
+       {
+        unsigned int                   BranchCount;
+
+        BranchCount = Variants[VariantIndex]->GetBranchCount(GroupIndex);
+
+        if (BranchCount == 0)
+         {
+          continue;
+         }
+
+        Offsets.resize(BranchCount * 3);
+        Rotations.resize(BranchCount * 4);
+        Scales.resize(BranchCount);
+
+        Variants[VariantIndex]->FillCloneTransformBuffer(&Offsets[0],&Rotations[0],&Scales[0],GroupIndex);
+
+        for (unsigned int PlantIndex = VariantIndex; PlantIndex < PlantCount; PlantIndex += VariantCount)
+         {
+          for (unsigned int BranchIndex = 0; BranchIndex < BranchCount; BranchIndex++)
+           {
+            float                      BranchTransform[NGPForestInstanceSize];
+            float                      Transform[NGPForestInstanceSize];
+
+            BranchTransform[0] = Offsets[BranchIndex * 3];
+            BranchTransform[1] = Offsets[BranchIndex * 3 + 1];
+            BranchTransform[2] = Offsets[BranchIndex * 3 + 2];
+            BranchTransform[3] = Scales[BranchIndex];
+            BranchTransform[4] = Rotations[BranchIndex * 4];
+            BranchTransform[5] = Rotations[BranchIndex * 4 + 1];
+            BranchTransform[6] = Rotations[BranchIndex * 4 + 2];
+            BranchTransform[7] = Rotations[BranchIndex * 4 + 3];
+
+            CombineTransforms(Transform,
+                              &PlantTransforms[PlantIndex * NGPForestInstanceSize],
+                              BranchTransform);
+
+            Instances.insert(Instances.end(),Transform,Transform + NGPForestInstanceSize);
+           }
+         }
+       }
+
+      GetGroupVertices(&Vertices,Template,0,GroupIndex,false);
+      GetGroupIndices(&Indices,Template,GroupIndex,1,false);
+
+      if ((!Vertices.empty()) && (!Indices.empty()) && (!Instances.empty()))
+       {
+        AddBatch(&Vertices[0],Vertices.size() / NGPForestVertexSize,
+                 &Indices[0],Indices.size(),
+                 &Instances[0],Instances.size() / NGPForestInstanceSize,
+                 &Material);
+       }
+     }
+    else
+     {
+      for (unsigned int VariantIndex = 0; VariantIndex < VariantCount; VariantIndex++)
+       {
+        Instances.clear();
+
+        for (unsigned int PlantIndex = VariantIndex; PlantIndex < PlantCount; PlantIndex += VariantCount)
+         {
+          Instances.insert(Instances.end(),
+                           &PlantTransforms[PlantIndex * NGPForestInstanceSize],
+                           &PlantTransforms[PlantIndex * NGPForestInstanceSize] + NGPForestInstanceSize);
+         }
+
+        GetGroupVertices(&Vertices,Template,Variants[VariantIndex],GroupIndex,Material.Billboard);
+        GetGroupIndices(&Indices,Template,GroupIndex,
+                        Variants[VariantIndex]->GetBranchCount(GroupIndex),
+                        Material.Billboard);
+
+        if ((!Vertices.empty()) && (!Indices.empty()))
+         {
+          AddBatch(&Vertices[0],Vertices.size() / NGPForestVertexSize,
+                   &Indices[0],Indices.size(),
+                   &Instances[0],Instances.size() / NGPForestInstanceSize,
+                   &Material);
+         }
+       }
+     }
+   }
+
+  for (unsigned int VariantIndex = 0; VariantIndex < VariantCount; VariantIndex++)
+   {
+    delete Variants[VariantIndex];
+   }
+
+  return(true);
+ }
+
+static void        PrepareMaterialState
+                                      (const NGPForestBatch
+                                                          *Batch)
+ {
+  if (Batch->TexHandle == 0)
+   {
+    glDisable(GL_TEXTURE_2D);
+   }
+  else
+   {
+    glBindTexture(GL_TEXTURE_2D,Batch->TexHandle);
+    glEnable(GL_TEXTURE_2D);
+   }
+
+  if ((Batch->DoubleSided) || (Batch->Billboard))
+   {
+    glDisable(GL_CULL_FACE);
+   }
+  else
+   {
+    glEnable(GL_CULL_FACE);
+   }
+
+  /* back faces of double-sided batches use color lit with inverted normal */
+  if (Batch->DoubleSided)
+   {
+    glEnable(GL_VERTEX_PROGRAM_TWO_SIDE_ARB);
+   }
+  else
+   {
+    glDisable(GL_VERTEX_PROGRAM_TWO_SIDE_ARB);
+   }
+
+  if (Batch->Transparent)
+   {
+    glAlphaFunc(GL_GREATER,0.5f);
+    glEnable(GL_ALPHA_TEST);
+   }
+  else
+   {
+    glDisable(GL_ALPHA_TEST);
+   }
+
+  glColor3f(Batch->R,Batch->G,Batch->B);
+ }
+
+void               NGPViewForest::Render
+                                      ()
+ {
+  GLhandleARB                          CurrProgram;
+
+  DrawCallCount = 0;
+  TriangleCount = 0;
+
+  glEnableClientState(GL_VERTEX_ARRAY);
+  glEnableClientState(GL_NORMAL_ARRAY);
+  glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+  glEnableVertexAttribArrayARB(NGPForestOffsetScaleAttr);
+  glEnableVertexAttribArrayARB(NGPForestRotationAttr);
+  glVertexAttribDivisorARB(NGPForestOffsetScaleAttr,1);
+  glVertexAttribDivisorARB(NGPForestRotationAttr,1);
+
+  CurrProgram = 0;
+
+  for (unsigned int BatchIndex = 0; BatchIndex < Batches.size(); BatchIndex++)
+   {
+    const NGPForestBatch              *Batch = &Batches[BatchIndex];
+    GLhandleARB                        Program;
+
+    Program = Batch->Billboard ? BillboardProgram : MeshProgram;
+
+    if (Program != CurrProgram)
+     {
+      glUseProgramObjectARB(Program);
+
+      CurrProgram = Program;
+     }
+
+    if (Batch->Billboard)
+     {
+      glUniform1fARB(BillboardHaveTexLocation,Batch->TexHandle != 0 ? 1.0f : 0.0f);
+      glUniform2fARB(BillboardHalfSizeLocation,
+                     Batch->BillboardWidth * 0.5f,
+                     Batch->BillboardHeight * 0.5f);
+      glUniform1fARB(BillboardCylindricalLocation,
+                     Batch->BillboardMode == P3D_BILLBOARD_MODE_CYLINDRICAL ? 1.0f : 0.0f);
+     }
+    else
+     {
+      glUniform1fARB(MeshHaveTexLocation,Batch->TexHandle != 0 ? 1.0f : 0.0f);
+     }
+
+    PrepareMaterialState(Batch);
+
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB,Batch->VertexBuffer);
+    glVertexPointer(3,GL_FLOAT,NGPForestVertexSize * sizeof(float),(const GLvoid*)0);
+    glNormalPointer(GL_FLOAT,NGPForestVertexSize * sizeof(float),(const GLvoid*)(3 * sizeof(float)));
+    glTexCoordPointer(2,GL_FLOAT,NGPForestVertexSize * sizeof(float),(const GLvoid*)(6 * sizeof(float)));
+
+    glBindBufferARB(GL_ARRAY_BUFFER_ARB,Batch->InstanceBuffer);
+    glVertexAttribPointerARB(NGPForestOffsetScaleAttr,4,GL_FLOAT,GL_FALSE,
+                             NGPForestInstanceSize * sizeof(float),(const GLvoid*)0);
+    glVertexAttribPointerARB(NGPForestRotationAttr,4,GL_FLOAT,GL_FALSE,
+                             NGPForestInstanceSize * sizeof(float),(const GLvoid*)(4 * sizeof(float)));
+
+    glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,Batch->IndexBuffer);
+
+    glDrawElementsInstancedARB(GL_TRIANGLES,Batch->IndexCount,GL_UNSIGNED_INT,0,Batch->InstanceCount);
+
+    DrawCallCount++;
+    TriangleCount += Batch->IndexCount / 3 * Batch->InstanceCount;
+   }
+
+  glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB,0);
+  glBindBufferARB(GL_ARRAY_BUFFER_ARB,0);
+
+  glUseProgramObjectARB(0);
+  glDisable(GL_VERTEX_PROGRAM_TWO_SIDE_ARB);
+
+  glVertexAttribDivisorARB(NGPForestOffsetScaleAttr,0);
+  glVertexAttribDivisorARB(NGPForestRotationAttr,0);
+  glDisableVertexAttribArrayARB(NGPForestOffsetScaleAttr);
+  glDisableVertexAttribArrayARB(NGPForestRotationAttr);
+  glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+  glDisableClientState(GL_NORMAL_ARRAY);
+  glDisableClientState(GL_VERTEX_ARRAY);
+ }
+
+void               NGPViewForest::GetBoundingBox
+                                      (float              *Min,
+                                       float              *Max) const
+ {
+  for (unsigned int Index = 0; Index < 3; Index++)
+   {
+    Min[Index] = BBoxMin[Index];
+    Max[Index] = BBoxMax[Index];
+   }
+ }
+
+unsigned int       NGPViewForest::GetDrawCallCount
+                                      () const
+ {
+  return(DrawCallCount);
+ }
+
+unsigned int       NGPViewForest::GetTriangleCount
+                                      () const
+ {
+  return(TriangleCount);
+ }
+
+unsigned int       NGPViewForest::GetBatchCount
+                                      () const
+ {
+  return(Batches.size());
+ }
+
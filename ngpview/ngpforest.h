@@ -0,0 +1,112 @@
+/***************************************************************************
+
+ Copyright (C) 2007  Sergey Prokhorchuk
+
+ This program is free software; you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation; either version 2 of the License, or
+ (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program; if not, write to the Free Software
+ Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+
+***************************************************************************/
+
+
+#ifndef __NGPFOREST_H__
+#define __NGPFOREST_H__
+
+#include <ngput/p3dglext.h>
+
+#include <vector>
+
+#include <ngpcore/p3dhli.h>
+
+#include "ngptexman.h"
+
+/* Forest rendering mode. All geometry is stored in static VBOs and drawn */
+/* using hardware instancing: each batch is one mesh drawn once per       */
+/* instance transform (offset, uniform scale and rotation quaternion).    */
+/* Cloneable groups share single clone mesh for all branches of all      */
+/* plants, other groups use baked geometry of each plant variant drawn    */
+/* once per plant. Billboards are expanded in vertex shader.              */
+
+typedef struct
+ {
+  GLuint           VertexBuffer;   /* interleaved position, normal, texcoord */
+  GLuint           IndexBuffer;
+  GLuint           InstanceBuffer; /* offset + scale, rotation              */
+  unsigned int     IndexCount;
+  unsigned int     InstanceCount;
+
+  float            R,G,B;
+  GLuint           TexHandle;
+  bool             DoubleSided;
+  bool             Transparent;
+  bool             Billboard;
+  unsigned int     BillboardMode;
+  float            BillboardWidth;
+  float            BillboardHeight;
+ } NGPForestBatch;
+
+class NGPViewForest
+ {
+  public           :
+
+                   NGPViewForest      ();
+                  ~NGPViewForest      ();
+
+  static bool      IsSupported        ();
+
+  /* PlantCount plants are placed on square grid, VariantCount different */
+  /* seeded instances of the template are used for them                 */
+  bool             Create             (const P3DHLIPlantTemplate
+                                                          *Template,
+                                       unsigned int        PlantCount,
+                                       unsigned int        VariantCount,
+                                       NGPTexManager      *TexManager);
+
+  void             Render             ();
+
+  void             GetBoundingBox     (float              *Min,
+                                       float              *Max) const;
+
+  /* statistics of the last Render call */
+  unsigned int     GetDrawCallCount   () const;
+  unsigned int     GetTriangleCount   () const;
+  unsigned int     GetBatchCount      () const;
+
+  private          :
+
+  bool             CreatePrograms     ();
+
+  void             AddBatch           (const float        *Vertices,
+                                       unsigned int        VertexCount,
+                                       const unsigned int *Indices,
+                                       unsigned int        IndexCount,
+                                       const float        *Instances,
+                                       unsigned int        InstanceCount,
+                                       const NGPForestBatch
+                                                          *Material);
+
+  std::vector<NGPForestBatch>          Batches;
+  GLhandleARB                          MeshProgram;
+  GLhandleARB                          BillboardProgram;
+  GLint                                MeshHaveTexLocation;
+  GLint                                BillboardHaveTexLocation;
+  GLint                                BillboardHalfSizeLocation;
+  GLint                                BillboardCylindricalLocation;
+  float                                BBoxMin[3];
+  float                                BBoxMax[3];
+  unsigned int                         DrawCallCount;
+  unsigned int                         TriangleCount;
+ };
+
+#endif
+
@@ -19,7 +19,9 @@
 ***************************************************************************/
 
 #include <string>
+#include <vector>
 #include <map>
+#include <algorithm>
 
 #include <ngpcore/p3dmodel.h>
 
@@ -73,21 +75,6 @@
    }
  }
 
-bool               NGPTexManager::TryLoadTexture
-                                      (P3DImageData       *ImageData,
-                                       const std::string  &Path,
-                                       const std::string  &Name) const
- {
-  std::string FullPathStr = Path + "/" + Name;
-
-  P3DPathName FullPathName(FullPathStr.c_str());
-
-  std::string Ext = FullPathName.GetExtension();
-
-  return ImageFmtHandler.LoadImageData
-          (ImageData,FullPathName.c_str(),Ext.c_str());
- }
-
 GLuint             NGPTexManager::LoadTexture
                                       (const char         *TexName)
  {
@@ -99,14 +86,17 @@ GLuint             NGPTexManager::LoadTexture
    }
   else
    {
-    P3DImageData                       ImageData;
+    P3DTexImage                        Image;
     std::string                        TexNameStr(TexName);
+    unsigned int                       MaxSize;
     GLuint                             Handle;
 
-    if      (TryLoadTexture(&ImageData,ModelPath,TexNameStr))
+    MaxSize = P3DTexImage::GetGLMaxSize();
+
+    if      (Image.Load(&ImageFmtHandler,(ModelPath + "/" + TexNameStr).c_str(),MaxSize))
      {
      }
-    else if (TryLoadTexture(&ImageData,TexPath,TexNameStr))
+    else if (Image.Load(&ImageFmtHandler,(TexPath + "/" + TexNameStr).c_str(),MaxSize))
      {
      }
     else
@@ -114,47 +104,57 @@ GLuint             NGPTexManager::LoadTexture
       return(0);
      }
 
-    glGenTextures(1,&Handle);
-
-    glBindTexture(GL_TEXTURE_2D,Handle);
-    glPixelStorei(GL_UNPACK_ALIGNMENT,1);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_S,GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_WRAP_T,GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MAG_FILTER,GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D,GL_TEXTURE_MIN_FILTER,GL_LINEAR);
+    Handle = Image.CreateGLTexture();
 
-    if      (ImageData.GetChannelCount() == 3)
-     {
-      gluBuild2DMipmaps(GL_TEXTURE_2D,
-                        3,
-                        ImageData.GetWidth(),
-                        ImageData.GetHeight(),
-                        GL_RGB,
-                        GL_UNSIGNED_BYTE,
-                        ImageData.GetData());
-     }
-    else if (ImageData.GetChannelCount() == 4)
+    if (Handle != 0)
      {
-      gluBuild2DMipmaps(GL_TEXTURE_2D,
-                        4,
-                        ImageData.GetWidth(),
-                        ImageData.GetHeight(),
-                        GL_RGBA,
-                        GL_UNSIGNED_BYTE,
-                        ImageData.GetData());
+      Handles[TexName] = Handle;
      }
-    else
+
+    return(Handle);
+   }
+ }
+
+void               NGPTexManager::PreloadTextures
+                                      (const std::vector<std::string>
+                                                          &TexNames,
+                                       unsigned int        ThreadCount)
+ {
+  P3DTexPrepQueue                      Queue(&ImageFmtHandler);
+  std::vector<std::string>             QueuedNames;
+
+  for (unsigned int Index = 0; Index < TexNames.size(); Index++)
+   {
+    if ((Handles.find(TexNames[Index]) == Handles.end()) &&
+        (std::find(QueuedNames.begin(),QueuedNames.end(),TexNames[Index]) == QueuedNames.end()))
      {
-      glDeleteTextures(1,&Handle);
+      Queue.Add((ModelPath + "/" + TexNames[Index]).c_str(),
+                (TexPath + "/" + TexNames[Index]).c_str());
 
-      return(0);
+      QueuedNames.push_back(TexNames[Index]);
      }
+   }
 
-    glBindTexture(GL_TEXTURE_2D,0);
+  if (Queue.GetCount() == 0)
+   {
+    return;
+   }
 
-    Handles[TexName] = Handle;
+  Queue.Run(ThreadCount,P3DTexImage::GetGLMaxSize());
 
-    return(Handle);
+  for (unsigned int Index = 0; Index < Queue.GetCount(); Index++)
+   {
+    if (Queue.GetImage(Index) != 0)
+     {
+      GLuint       Handle;
+
+      Handle = Queue.GetImage(Index)->CreateGLTexture();
+
+      if (Handle != 0)
+       {
+        Handles[QueuedNames[Index]] = Handle;
+       }
+     }
    }
  }
 
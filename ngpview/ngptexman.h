@@ -22,10 +22,12 @@
 #define __NGPVIEWTEXMAN_H__
 
 #include <string>
+#include <vector>
 #include <map>
 
 #include <ngput/p3dglext.h>
 #include <ngput/p3dimage.h>
+#include <ngput/p3dtexprep.h>
 
 class NGPTexManager
  {
@@ -37,11 +39,13 @@ class NGPTexManager
 
   GLuint           LoadTexture        (const char         *TexName);
 
-  private          :
+  /* decode textures on ThreadCount threads and upload them, so that */
+  /* following LoadTexture calls for the same names return at once   */
+  void             PreloadTextures    (const std::vector<std::string>
+                                                          &TexNames,
+                                       unsigned int        ThreadCount);
 
-  bool             TryLoadTexture     (P3DImageData       *ImageData,
-                                       const std::string  &Path,
-                                       const std::string  &Name) const;
+  private          :
 
   std::map<std::string,GLuint>         Handles;
   P3DImageFmtHandlerComposite          ImageFmtHandler;
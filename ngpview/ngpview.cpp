@@ -37,17 +37,33 @@
 #include <ngpcore/p3dhli.h>
 
 #include <ngput/p3dospath.h>
+#include <ngput/p3dthread.h>
 
 #include "ngptexman.h"
 #include "ngpviewdata.h"
+#include "ngpforest.h"
 
 static NGPViewMeshData      *PlantMesh = 0;
+static NGPViewForest        *Forest = 0;
+static float                 SceneBBoxMin[3] = { 0.0f, 0.0f, 0.0f };
+static float                 SceneBBoxMax[3] = { 0.0f, 0.0f, 0.0f };
+static float                 ViewDistance = 10.0f;
+static float                 ViewFarPlane = 50.0f;
 static float                 RotAngle = 0.0f;
 static float                 StartAngle = 0.0f;
 static int                   AnimationStartTime = 0;
 static bool                  AnimationRunning = false;
 
+static int                   StatsStartTime = 0;
+static unsigned int          StatsFrameCount = 0;
+static unsigned int          DrawCallCount = 0;
+static unsigned int          TriangleCount = 0;
+
 const float AnimationSpeed = 15.0; /* degrees per second */
+const float ForestTiltAngle = 30.0; /* degrees */
+const int   StatsInterval = 1000; /* milliseconds */
+
+#define NGPVIEW_DEFAULT_VARIANT_COUNT (4)
 
 static void        PrepareMaterialState
                                       (const NGPViewSubMeshData
@@ -200,6 +216,9 @@ static void        RenderBillboards   (const NGPViewSubMeshData
    }
 
   glEnd();
+
+  DrawCallCount++;
+  TriangleCount += Count * 2;
  }
 
 static void        RenderSubMesh      (const NGPViewSubMeshData
@@ -228,10 +247,34 @@ static void        RenderSubMesh      (const NGPViewSubMeshData
                  SubMesh->IndexCount,
                  GL_UNSIGNED_INT,
                  SubMesh->IndexBuffer);
+
+  DrawCallCount++;
+  TriangleCount += SubMesh->IndexCount / 3;
  }
 
 static GLfloat     Light0Position[] = { 0.0f, 0.0f, 0.0f, 1.0f };
 
+static void        UpdateStats        ()
+ {
+  int                                  CurrTime;
+
+  StatsFrameCount++;
+
+  CurrTime = glutGet(GLUT_ELAPSED_TIME);
+
+  if (CurrTime - StatsStartTime >= StatsInterval)
+   {
+    printf("%u frames, %.2f ms/frame, %u draw calls, %u triangles\n",
+           StatsFrameCount,
+           (float)(CurrTime - StatsStartTime) / StatsFrameCount,
+           DrawCallCount,
+           TriangleCount);
+
+    StatsStartTime  = CurrTime;
+    StatsFrameCount = 0;
+   }
+ }
+
 static void        RenderScene        ()
  {
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -239,10 +282,31 @@ static void        RenderScene        ()
   glMatrixMode(GL_MODELVIEW);
   glLoadIdentity();
   glLightfv(GL_LIGHT0,GL_POSITION,Light0Position);
-  glTranslatef(0.0f,(PlantMesh->BBoxMin[1] - PlantMesh->BBoxMax[1]) * 0.5f,-10.0f);
+
+  if (Forest != 0)
+   {
+    glTranslatef(0.0f,0.0f,-ViewDistance);
+    glRotatef(ForestTiltAngle,1.0f,0.0f,0.0f);
+    glTranslatef(0.0f,-(SceneBBoxMin[1] + SceneBBoxMax[1]) * 0.5f,0.0f);
+   }
+  else
+   {
+    glTranslatef(0.0f,(SceneBBoxMin[1] - SceneBBoxMax[1]) * 0.5f,-ViewDistance);
+   }
+
   glRotatef(RotAngle,0.0f,1.0f,0.0f);
 
-  if (PlantMesh != 0)
+  DrawCallCount = 0;
+  TriangleCount = 0;
+
+  if      (Forest != 0)
+   {
+    Forest->Render();
+
+    DrawCallCount = Forest->GetDrawCallCount();
+    TriangleCount = Forest->GetTriangleCount();
+   }
+  else if (PlantMesh != 0)
    {
     unsigned int                       SubMeshIndex;
     unsigned int                       SubMeshCount;
@@ -264,6 +328,8 @@ static void        RenderScene        ()
 
   glFlush();
   glutSwapBuffers();
+
+  UpdateStats();
  }
 
 static void        GetBranchGroupMaterial
@@ -455,6 +521,27 @@ static bool        GetBranchGroupData (NGPViewSubMeshData *SubMeshData,
    }
  }
 
+/* decodes diffuse textures of all branch groups in parallel */
+static void        PreloadTextures    (NGPTexManager      *TextureManager,
+                                       const P3DHLIPlantTemplate
+                                                          *PlantTemplate)
+ {
+  std::vector<std::string>             TexNames;
+  const char                          *TexName;
+
+  for (unsigned int GroupIndex = 0; GroupIndex < PlantTemplate->GetGroupCount(); GroupIndex++)
+   {
+    TexName = PlantTemplate->GetMaterial(GroupIndex)->GetTexName(P3D_TEX_DIFFUSE);
+
+    if (TexName != 0)
+     {
+      TexNames.push_back(TexName);
+     }
+   }
+
+  TextureManager->PreloadTextures(TexNames,P3DThread::GetCPUCount());
+ }
+
 static bool        LoadModel          (NGPViewMeshData   **MeshData,
                                        const char         *SourceFileName,
                                        NGPTexManager      *TextureManager)
@@ -474,6 +561,8 @@ static bool        LoadModel          (NGPViewMeshData   **MeshData,
 
     SourceStream.Close();
 
+    PreloadTextures(TextureManager,&PlantTemplate);
+
     P3DHLIPlantInstance                 *PlantInstance;
 
     PlantInstance = PlantTemplate.CreateInstance();
@@ -514,6 +603,82 @@ static bool        LoadModel          (NGPViewMeshData   **MeshData,
   return(Result);
  }
 
+static bool        LoadForest         (NGPViewForest     **ForestData,
+                                       const char         *SourceFileName,
+                                       unsigned int        PlantCount,
+                                       unsigned int        VariantCount,
+                                       NGPTexManager      *TextureManager)
+ {
+  bool                                 Result;
+  P3DInputStringStreamFile             SourceStream;
+
+  Result = true;
+
+  try
+   {
+    SourceStream.Open(SourceFileName);
+
+    P3DHLIPlantTemplate                  PlantTemplate(&SourceStream);
+
+    SourceStream.Close();
+
+    PreloadTextures(TextureManager,&PlantTemplate);
+
+    *ForestData = new NGPViewForest();
+
+    Result = (*ForestData)->Create(&PlantTemplate,PlantCount,VariantCount,TextureManager);
+
+    if (Result)
+     {
+      printf("forest: %u plants, %u batches\n",PlantCount,(*ForestData)->GetBatchCount());
+     }
+    else
+     {
+      fprintf(stderr,"error: unable to create forest shaders\n");
+     }
+   }
+  catch (const P3DException &Exc)
+   {
+    Result = false;
+
+    fprintf(stderr,"error: %s\n",Exc.GetMessage());
+   }
+
+  return(Result);
+ }
+
+/* place camera far enough to see whole scene bounding box */
+static void        UpdateSceneView    ()
+ {
+  float                                Radius;
+
+  Radius = 0.0f;
+
+  for (unsigned int Axis = 0; Axis < 3; Axis++)
+   {
+    float                              Size;
+
+    Size    = SceneBBoxMax[Axis] - SceneBBoxMin[Axis];
+    Radius += Size * Size;
+   }
+
+  Radius = P3DMath::Sqrtf(Radius) * 0.5f;
+
+  ViewDistance = Radius + 1.0f;
+
+  if (ViewDistance < 10.0f)
+   {
+    ViewDistance = 10.0f;
+   }
+
+  ViewFarPlane = ViewDistance + Radius + 1.0f;
+
+  if (ViewFarPlane < 50.0f)
+   {
+    ViewFarPlane = 50.0f;
+   }
+ }
+
 static GLfloat     Light0Ambient[]  = { 0.0f, 0.0f, 0.0f, 1.0f };
 static GLfloat     Light0Diffuse[]  = { 1.0f, 1.0f, 1.0f, 1.0f };
 static GLfloat     Light0Specular[] = { 0.2f, 0.2f, 0.2f, 1.0f };
@@ -544,7 +709,7 @@ static void        GLInit             ()
 
   glMatrixMode(GL_PROJECTION);
   glLoadIdentity();
-  glOrtho(-25.0f,25.0f,-25.0f,25.0f,1.0f,50.0f);
+  glOrtho(-25.0f,25.0f,-25.0f,25.0f,1.0f,ViewFarPlane);
  }
 
 static void        ReshapeFunc        (int                 width,
@@ -555,14 +720,14 @@ static void        ReshapeFunc        (int                 width,
   glMatrixMode(GL_PROJECTION);
   glLoadIdentity();
 
-  if (PlantMesh != 0)
+  if ((PlantMesh != 0) || (Forest != 0))
    {
     float                              BBoxSize[3];
     float                              MaxValue;
 
-    BBoxSize[0] = (PlantMesh->BBoxMax[0] - PlantMesh->BBoxMin[0]) / 2.0f;
-    BBoxSize[1] = (PlantMesh->BBoxMax[1] - PlantMesh->BBoxMin[1]) / 2.0f;
-    BBoxSize[2] = (PlantMesh->BBoxMax[2] - PlantMesh->BBoxMin[2]) / 2.0f;
+    BBoxSize[0] = (SceneBBoxMax[0] - SceneBBoxMin[0]) / 2.0f;
+    BBoxSize[1] = (SceneBBoxMax[1] - SceneBBoxMin[1]) / 2.0f;
+    BBoxSize[2] = (SceneBBoxMax[2] - SceneBBoxMin[2]) / 2.0f;
 
     if (BBoxSize[0] > BBoxSize[1])
      {
@@ -596,7 +761,7 @@ static void        ReshapeFunc        (int                 width,
               -MaxValue,
                MaxValue,
                1.0f,
-               50.0f);
+               ViewFarPlane);
      }
     else
      {
@@ -605,12 +770,12 @@ static void        ReshapeFunc        (int                 width,
               -MaxValue * ((float)height / width),
                MaxValue * ((float)height / width),
                1.0f,
-               50.0f);
+               ViewFarPlane);
      }
    }
   else
    {
-    glOrtho(-25.0f,25.0f,-25.0f,25.0f,1.0f,50.0f);
+    glOrtho(-25.0f,25.0f,-25.0f,25.0f,1.0f,ViewFarPlane);
    }
  }
 
@@ -650,6 +815,8 @@ static void        KeyboardFunc       (unsigned char       key,
 
 static bool        ParseArgs          (char              **ModelFileName,
                                        char              **TexPath,
+                                       unsigned int       *ForestSize,
+                                       unsigned int       *VariantCount,
                                        bool               *ShowHelp,
                                        unsigned int        ArgCount,
                                        char               *ArgValues[])
@@ -663,6 +830,8 @@ static bool        ParseArgs          (char              **ModelFileName,
 
   *ModelFileName = 0;
   *TexPath       = 0;
+  *ForestSize    = 0;
+  *VariantCount  = NGPVIEW_DEFAULT_VARIANT_COUNT;
   *ShowHelp      = false;
 
   ArgIndex = 1;
@@ -695,6 +864,48 @@ static bool        ParseArgs          (char              **ModelFileName,
             fprintf(stderr,"error: texture search path required\n");
            }
          }
+        else if (strcmp(ArgStr,"-f") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            if ((sscanf(ArgValues[ArgIndex],"%u",ForestSize) != 1) ||
+                (*ForestSize == 0))
+             {
+              Result = false;
+
+              fprintf(stderr,"error: invalid forest size\n");
+             }
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: forest size required\n");
+           }
+         }
+        else if (strcmp(ArgStr,"-n") == 0)
+         {
+          ArgIndex++;
+
+          if (ArgIndex < ArgCount)
+           {
+            if ((sscanf(ArgValues[ArgIndex],"%u",VariantCount) != 1) ||
+                (*VariantCount == 0))
+             {
+              Result = false;
+
+              fprintf(stderr,"error: invalid variant count\n");
+             }
+           }
+          else
+           {
+            Result = false;
+
+            fprintf(stderr,"error: variant count required\n");
+           }
+         }
         else
          {
           Result = false;
@@ -739,6 +950,9 @@ static void        ShowHelpMessage    ()
   printf("Options:\n");
   printf("  -h            Display this information\n");
   printf("  -t <path>     Use <path> for texture search (current dir by default)\n");
+  printf("  -f <count>    Render forest of <count> plants using instanced VBOs\n");
+  printf("  -n <count>    Use <count> seed variants in forest mode (default: %u)\n",
+         NGPVIEW_DEFAULT_VARIANT_COUNT);
   printf("\nUse 'ESC' or 'q' key to exit\n");
   printf("Use 'a' key to start/stop animation\n\n");
  }
@@ -748,13 +962,16 @@ int                main               (int                 argc,
  {
   char                                *ModelFileName;
   char                                *TexPathOpt;
+  unsigned int                         ForestSize;
+  unsigned int                         VariantCount;
   bool                                 ShowHelp;
+  bool                                 Loaded;
 
   glutInitWindowSize(640,480);
   glutInitDisplayMode(GLUT_RGB | GLUT_DOUBLE | GLUT_DEPTH);
   glutInit(&argc,argv);
 
-  if (ParseArgs(&ModelFileName,&TexPathOpt,&ShowHelp,argc,argv))
+  if (ParseArgs(&ModelFileName,&TexPathOpt,&ForestSize,&VariantCount,&ShowHelp,argc,argv))
    {
     if (ShowHelp)
      {
@@ -780,8 +997,46 @@ int                main               (int                 argc,
 
     glutCreateWindow("ngpview");
 
-    if (LoadModel(&PlantMesh,ModelFileName,&TextureManager))
+    P3DGLExtInit();
+
+    if (ForestSize > 0)
      {
+      if (NGPViewForest::IsSupported())
+       {
+        Loaded = LoadForest(&Forest,ModelFileName,ForestSize,VariantCount,&TextureManager);
+
+        if (Loaded)
+         {
+          Forest->GetBoundingBox(SceneBBoxMin,SceneBBoxMax);
+         }
+       }
+      else
+       {
+        Loaded = false;
+
+        fprintf(stderr,"error: forest mode requires VBO, GLSL and instanced arrays support\n");
+       }
+     }
+    else
+     {
+      Loaded = LoadModel(&PlantMesh,ModelFileName,&TextureManager);
+
+      if (PlantMesh != 0)
+       {
+        for (unsigned int Axis = 0; Axis < 3; Axis++)
+         {
+          SceneBBoxMin[Axis] = PlantMesh->BBoxMin[Axis];
+          SceneBBoxMax[Axis] = PlantMesh->BBoxMax[Axis];
+         }
+       }
+     }
+
+    if (Loaded)
+     {
+      UpdateSceneView();
+
+      StatsStartTime = glutGet(GLUT_ELAPSED_TIME);
+
       GLInit();
 
       glutReshapeFunc(ReshapeFunc);
@@ -795,6 +1050,11 @@ int                main               (int                 argc,
      {
       delete PlantMesh;
      }
+
+    if (Forest != 0)
+     {
+      delete Forest;
+     }
    }
 
   return(0);
@@ -96,7 +96,50 @@ local function CreateMaterialsMapping(JoinMaterials)
  return Mapping
 end
 
-local function ExportOBJFile(OBJFileName,MTLFileName,MaterialsMapping,ApplyScaling,ScalingFactor)
+local FaceFormats =
+ {
+  [3] = "f %1$u/%2$u/%3$u %4$u/%5$u/%6$u %7$u/%8$u/%9$u\n",
+  [4] = "f %1$u/%2$u/%3$u %4$u/%5$u/%6$u %7$u/%8$u/%9$u %10$u/%11$u/%12$u\n"
+ }
+
+-- Splits single branch primitives into runs of the same primitive type.
+-- Each run is { first corner (0-based), corner count, corners per face }
+
+local function PrimitiveRuns(Group)
+ local Runs        = {}
+ local CornerIndex = 0
+
+ for PrimitiveIndex = 1,Group:GetPrimitiveCount(false) do
+  local FaceSize = Group:GetPrimitiveType(PrimitiveIndex,false) == NGP_QUAD and 4 or 3
+  local LastRun  = Runs[table.getn(Runs)]
+
+  if LastRun and LastRun[3] == FaceSize then
+   LastRun[2] = LastRun[2] + FaceSize
+  else
+   table.insert(Runs,{ CornerIndex,FaceSize,FaceSize })
+  end
+
+  CornerIndex = CornerIndex + FaceSize
+ end
+
+ return Runs,CornerIndex
+end
+
+local function WriteFaces(OBJFile,Group,Buffer)
+ local Runs,BranchCornerCount = PrimitiveRuns(Group)
+
+ if table.getn(Runs) == 1 then
+  Buffer:WriteFormatted(OBJFile,FaceFormats[Runs[1][3]],1,Buffer:GetElementCount(),Runs[1][3])
+ elseif table.getn(Runs) > 1 then
+  for BranchBase = 1,Buffer:GetElementCount(),BranchCornerCount do
+   for i,Run in ipairs(Runs) do
+    Buffer:WriteFormatted(OBJFile,FaceFormats[Run[3]],BranchBase + Run[1],Run[2],Run[3])
+   end
+  end
+ end
+end
+
+local function ExportOBJFile(OBJFileName,MTLFileName,MaterialsMapping,ApplyScaling,ScalingFactor,IndexedTriangles)
  local OBJFile = io.open(OBJFileName,"w")
 
  OBJFile:write("o plant\n")
@@ -118,66 +161,67 @@ local function ExportOBJFile(OBJFileName,MTLFileName,MaterialsMapping,ApplyScali
    OBJFile:write("usemap off\n")
   end
 
-  local Buffer = Group:GetVAttrBuffer(NGP_ATTR_VERTEX)
-
-  local VertexIndexStep = table.getn(Buffer)
+  if IndexedTriangles then
+   local VertexCount = Group:GetVAttrCountI(true)
+   local Buffer      = Group:GetVAttrBufferI(NGP_ATTR_VERTEX)
 
-  if ApplyScaling then
-   for i,v in ipairs(Buffer) do
-    OBJFile:write(string.format("v %f %f %f\n",v[1] * ScalingFactor,v[2] * ScalingFactor,v[3] * ScalingFactor))
+   if ApplyScaling then
+    Buffer:Scale(ScalingFactor)
    end
+
+   Buffer:WriteFormatted(OBJFile,"v %f %f %f\n")
+
+   Buffer = Group:GetVAttrBufferI(NGP_ATTR_NORMAL)
+
+   Buffer:WriteFormatted(OBJFile,"vn %f %f %f\n")
+
+   Buffer = Group:GetVAttrBufferI(NGP_ATTR_TEXCOORD0)
+
+   Buffer:WriteFormatted(OBJFile,"vt %f %f\n")
+
+   Buffer = Group:GetIndexBuffer(NGP_TRIANGLE_LIST,true,VertexIndexOffset)
+
+   Buffer:WriteFormatted(OBJFile,"f %1$u/%1$u/%1$u %2$u/%2$u/%2$u %3$u/%3$u/%3$u\n",
+                         1,Buffer:GetElementCount(),3)
+
+   Buffer = nil
+
+   VertexIndexOffset = VertexIndexOffset + VertexCount
   else
-   for i,v in ipairs(Buffer) do
-    OBJFile:write(string.format("v %f %f %f\n",v[1],v[2],v[3]))
+   local Buffer = Group:GetVAttrBuffer(NGP_ATTR_VERTEX,true)
+
+   local VertexIndexStep = Buffer:GetElementCount()
+
+   if ApplyScaling then
+    Buffer:Scale(ScalingFactor)
    end
-  end
 
-  Buffer = Group:GetVAttrBuffer(NGP_ATTR_NORMAL)
+   Buffer:WriteFormatted(OBJFile,"v %f %f %f\n")
 
-  local NormalIndexStep = table.getn(Buffer)
+   Buffer = Group:GetVAttrBuffer(NGP_ATTR_NORMAL,true)
 
-  for i,v in ipairs(Buffer) do
-   OBJFile:write(string.format("vn %f %f %f\n",v[1],v[2],v[3]))
-  end
+   local NormalIndexStep = Buffer:GetElementCount()
 
-  Buffer = Group:GetVAttrBuffer(NGP_ATTR_TEXCOORD0)
+   Buffer:WriteFormatted(OBJFile,"vn %f %f %f\n")
 
-  local TexCoordIndexStep = table.getn(Buffer)
+   Buffer = Group:GetVAttrBuffer(NGP_ATTR_TEXCOORD0,true)
 
-  for i,v in ipairs(Buffer) do
-   OBJFile:write(string.format("vt %f %f\n",v[1],v[2]))
-  end
+   local TexCoordIndexStep = Buffer:GetElementCount()
 
-  Buffer = nil
-
-  local VertexIndexBuffer   = Group:GetVAttrIndexBuffer(NGP_ATTR_VERTEX,true,VertexIndexOffset)
-  local NormalIndexBuffer   = Group:GetVAttrIndexBuffer(NGP_ATTR_NORMAL,true,NormalIndexOffset)
-  local TexCoordIndexBuffer = Group:GetVAttrIndexBuffer(NGP_ATTR_TEXCOORD0,true,TexCoordIndexOffset)
-
-  local PrimitiveCount = table.getn(VertexIndexBuffer)
-
-  for PrimitiveIndex = 1,PrimitiveCount do
-   local vi = VertexIndexBuffer[PrimitiveIndex]
-   local ni = NormalIndexBuffer[PrimitiveIndex]
-   local ti = TexCoordIndexBuffer[PrimitiveIndex]
-
-   if Group:GetPrimitiveType(PrimitiveIndex) == NGP_QUAD then
-    OBJFile:write(string.format("f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n",
-                                 vi[1],ti[1],ni[1],
-                                 vi[2],ti[2],ni[2],
-                                 vi[3],ti[3],ni[3],
-                                 vi[4],ti[4],ni[4]))
-   else
-    OBJFile:write(string.format("f %u/%u/%u %u/%u/%u %u/%u/%u\n",
-                                 vi[1],ti[1],ni[1],
-                                 vi[2],ti[2],ni[2],
-                                 vi[3],ti[3],ni[3]))
-   end
-  end
+   Buffer:WriteFormatted(OBJFile,"vt %f %f\n")
+
+   Buffer = Group:GetCornerIndexBuffer(true,NGP_ATTR_VERTEX,VertexIndexOffset,
+                                            NGP_ATTR_TEXCOORD0,TexCoordIndexOffset,
+                                            NGP_ATTR_NORMAL,NormalIndexOffset)
 
-  VertexIndexOffset   = VertexIndexOffset   + VertexIndexStep
-  NormalIndexOffset   = NormalIndexOffset   + NormalIndexStep
-  TexCoordIndexOffset = TexCoordIndexOffset + TexCoordIndexStep
+   WriteFaces(OBJFile,Group,Buffer)
+
+   Buffer = nil
+
+   VertexIndexOffset   = VertexIndexOffset   + VertexIndexStep
+   NormalIndexOffset   = NormalIndexOffset   + NormalIndexStep
+   TexCoordIndexOffset = TexCoordIndexOffset + TexCoordIndexStep
+  end
 
  end
 
@@ -272,6 +316,13 @@ DialogDescription =
    name    = "ScaledHeight",
    type    = "number",
    default = OriginalHeight
+  },
+  {
+   label   = "Write indexed triangles",
+   name    = "IndexedTriangles",
+   type    = "choice",
+   choices = { "No","Yes" },
+   default = 0
   }
  }
 
@@ -284,8 +335,9 @@ if Params then
  local JoinMaterials           = Params.JoinSimilarMaterials == "Yes"
  local CreateSelfContainedDir  = Params.CreateSelfContainedDir == "Yes"
 
- local ApplyScaling  = Params.ApplyScaling
- local ScalingFactor = Params.ScaledHeight / OriginalHeight
+ local ApplyScaling     = Params.ApplyScaling
+ local ScalingFactor    = Params.ScaledHeight / OriginalHeight
+ local IndexedTriangles = Params.IndexedTriangles == "Yes"
 
  if CreateSelfContainedDir then
   local DirName = ShowDirSelectDialog("Choose directory")
@@ -301,7 +353,7 @@ if Params then
 
     local MaterialsMapping = CreateMaterialsMapping(JoinMaterials)
 
-    ExportOBJFile(FullOBJFileName,MTLFileName,MaterialsMapping,ApplyScaling,ScalingFactor)
+    ExportOBJFile(FullOBJFileName,MTLFileName,MaterialsMapping,ApplyScaling,ScalingFactor,IndexedTriangles)
     ExportMTLFile(FullMTLFileName,MaterialsMapping,DirName)
    end
   end
@@ -313,7 +365,7 @@ if Params then
 
    local MaterialsMapping = CreateMaterialsMapping(JoinMaterials)
 
-   ExportOBJFile(FullOBJFileName,FullMTLFileName,MaterialsMapping)
+   ExportOBJFile(FullOBJFileName,FullMTLFileName,MaterialsMapping,nil,nil,IndexedTriangles)
    ExportMTLFile(FullMTLFileName,MaterialsMapping)
   end
  end
@@ -34,9 +34,11 @@
 #include <ngpcore/p3dhli.h>
 
 #include <ngppyplantinstance.h>
+#include <ngppyplanttemplate.h>
 #include <ngppybranchgroup.h>
 #include <ngppymaterialdef.h>
 #include <ngppymodelmetainfo.h>
+#include <ngppyarray.h>
 
 static PyMethodDef ModuleMethods[] =
  {
@@ -51,6 +53,9 @@ PyMODINIT_FUNC     init_ngp            (void)
  {
   PyObject        *ModuleObject;
 
+  /* generation methods release GIL, so make sure it exists */
+  PyEval_InitThreads();
+
   PlantInstanceType.tp_new = PyType_GenericNew;
 
   if (PyType_Ready(&PlantInstanceType) < 0)
@@ -58,6 +63,13 @@ PyMODINIT_FUNC     init_ngp            (void)
     return;
    }
 
+  PlantTemplateType.tp_new = PyType_GenericNew;
+
+  if (PyType_Ready(&PlantTemplateType) < 0)
+   {
+    return;
+   }
+
   BranchGroupType.tp_new = PyType_GenericNew;
 
   if (PyType_Ready(&BranchGroupType) < 0)
@@ -79,17 +91,26 @@ PyMODINIT_FUNC     init_ngp            (void)
     return;
    }
 
+  if (PyType_Ready(&ArrayType) < 0)
+   {
+    return;
+   }
+
   ModuleObject = Py_InitModule3("_ngp",ModuleMethods,"ngPlant library python extension module");
 
   Py_INCREF(&PlantInstanceType);
+  Py_INCREF(&PlantTemplateType);
   Py_INCREF(&BranchGroupType);
   Py_INCREF(&MaterialDefType);
   Py_INCREF(&ModelMetaInfoType);
+  Py_INCREF(&ArrayType);
 
   PyModule_AddObject(ModuleObject,"PlantInstance",(PyObject*)&PlantInstanceType);
+  PyModule_AddObject(ModuleObject,"PlantTemplate",(PyObject*)&PlantTemplateType);
   PyModule_AddObject(ModuleObject,"BranchGroup",(PyObject*)&BranchGroupType);
   PyModule_AddObject(ModuleObject,"MaterialDef",(PyObject*)&MaterialDefType);
   PyModule_AddObject(ModuleObject,"ModelMetaInfo",(PyObject*)&ModelMetaInfoType);
+  PyModule_AddObject(ModuleObject,"Array",(PyObject*)&ArrayType);
 
   PyModule_AddIntConstant(ModuleObject,"ATTR_VERTEX",(long)P3D_ATTR_VERTEX);
   PyModule_AddIntConstant(ModuleObject,"ATTR_NORMAL",(long)P3D_ATTR_NORMAL);
@@ -0,0 +1,425 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#include <Python.h>
+
+#include <ngppyarray.h>
+
+static Py_ssize_t  ArrayGetItemCount  (ArrayObject        *self)
+ {
+  if (self->NDim == 1)
+   {
+    return(self->Shape[0]);
+   }
+  else
+   {
+    return(self->Shape[0] * self->Shape[1]);
+   }
+ }
+
+static PyObject   *ArrayGetScalar     (ArrayObject        *self,
+                                       Py_ssize_t          Index)
+ {
+  if (self->Format[0] == 'f')
+   {
+    return(Py_BuildValue("f",((float*)self->Data)[Index]));
+   }
+  else
+   {
+    return(Py_BuildValue("l",(long)((unsigned int*)self->Data)[Index]));
+   }
+ }
+
+static void        ArrayDealloc       (ArrayObject        *self)
+ {
+  PyMem_Free(self->Data);
+
+  self->ob_type->tp_free((PyObject*)self);
+ }
+
+ArrayObject       *ArrayCreate        (char                Format,
+                                       unsigned int        RowCount,
+                                       unsigned int        ColCount)
+ {
+  ArrayObject                         *self;
+  size_t                               ItemCount;
+
+  self = PyObject_New(ArrayObject,&ArrayType);
+
+  if (self == NULL)
+   {
+    return(NULL);
+   }
+
+  self->Format[0] = Format;
+  self->Format[1] = 0;
+
+  if (ColCount == 0)
+   {
+    self->NDim       = 1;
+    self->Shape[0]   = RowCount;
+    self->Shape[1]   = 1;
+    self->Strides[0] = 4;
+    self->Strides[1] = 4;
+
+    ItemCount = RowCount;
+   }
+  else
+   {
+    self->NDim       = 2;
+    self->Shape[0]   = RowCount;
+    self->Shape[1]   = ColCount;
+    self->Strides[0] = 4 * ColCount;
+    self->Strides[1] = 4;
+
+    ItemCount = (size_t)RowCount * ColCount;
+   }
+
+  /* always allocate at least one item to get non-NULL pointer */
+  self->Data = PyMem_Malloc(ItemCount > 0 ? ItemCount * 4 : 4);
+
+  if (self->Data == NULL)
+   {
+    Py_DECREF(self);
+
+    PyErr_NoMemory();
+
+    return(NULL);
+   }
+
+  return(self);
+ }
+
+static Py_ssize_t  ArrayLength        (ArrayObject        *self)
+ {
+  return(self->Shape[0]);
+ }
+
+static PyObject   *ArrayItem          (ArrayObject        *self,
+                                       Py_ssize_t          Index)
+ {
+  PyObject                            *Result;
+
+  if ((Index < 0) || (Index >= self->Shape[0]))
+   {
+    PyErr_SetString(PyExc_IndexError,"array index out of range");
+
+    return(NULL);
+   }
+
+  if (self->NDim == 1)
+   {
+    return(ArrayGetScalar(self,Index));
+   }
+
+  Result = PyTuple_New(self->Shape[1]);
+
+  if (Result != NULL)
+   {
+    for (Py_ssize_t ItemIndex = 0; ItemIndex < self->Shape[1]; ItemIndex++)
+     {
+      PyObject *Item;
+
+      Item = ArrayGetScalar(self,Index * self->Shape[1] + ItemIndex);
+
+      if (Item == NULL)
+       {
+        Py_DECREF(Result);
+
+        return(NULL);
+       }
+
+      PyTuple_SET_ITEM(Result,ItemIndex,Item);
+     }
+   }
+
+  return(Result);
+ }
+
+static Py_ssize_t  ArrayGetReadBuffer (ArrayObject        *self,
+                                       Py_ssize_t          Segment,
+                                       void              **Ptr)
+ {
+  if (Segment != 0)
+   {
+    PyErr_SetString(PyExc_SystemError,"accessing non-existent array segment");
+
+    return(-1);
+   }
+
+  *Ptr = self->Data;
+
+  return(ArrayGetItemCount(self) * 4);
+ }
+
+static Py_ssize_t  ArrayGetSegCount   (ArrayObject        *self,
+                                       Py_ssize_t         *Length)
+ {
+  if (Length != NULL)
+   {
+    *Length = ArrayGetItemCount(self) * 4;
+   }
+
+  return(1);
+ }
+
+static int         ArrayGetBuffer     (ArrayObject        *self,
+                                       Py_buffer          *View,
+                                       int                 Flags)
+ {
+  if (PyBuffer_FillInfo(View,(PyObject*)self,self->Data,
+                        ArrayGetItemCount(self) * 4,0,Flags) != 0)
+   {
+    return(-1);
+   }
+
+  View->itemsize = 4;
+  View->format   = (Flags & PyBUF_FORMAT) ? self->Format : NULL;
+
+  if ((Flags & PyBUF_ND) == PyBUF_ND)
+   {
+    View->ndim  = self->NDim;
+    View->shape = self->Shape;
+   }
+
+  if ((Flags & PyBUF_STRIDES) == PyBUF_STRIDES)
+   {
+    View->strides = self->Strides;
+   }
+
+  return(0);
+ }
+
+static PyObject   *ArrayGetShape      (ArrayObject        *self,
+                                       void               *closure)
+ {
+  if (self->NDim == 1)
+   {
+    return(Py_BuildValue("(n)",self->Shape[0]));
+   }
+  else
+   {
+    return(Py_BuildValue("(nn)",self->Shape[0],self->Shape[1]));
+   }
+ }
+
+static PyObject   *ArrayGetTypeCode   (ArrayObject        *self,
+                                       void               *closure)
+ {
+  return(Py_BuildValue("s",self->Format));
+ }
+
+static int         IsNativeFormat     (const char         *Format,
+                                       char                Required)
+ {
+  if (Format == NULL)
+   {
+    return(0);
+   }
+
+  #ifdef WORDS_BIGENDIAN
+  if ((*Format == '@') || (*Format == '=') || (*Format == '>') || (*Format == '!'))
+  #else
+  if ((*Format == '@') || (*Format == '=') || (*Format == '<'))
+  #endif
+   {
+    Format++;
+   }
+
+  if (Format[0] == 0 || Format[1] != 0)
+   {
+    return(0);
+   }
+
+  if (Required == 'f')
+   {
+    return(Format[0] == 'f');
+   }
+  else
+   {
+    return((Format[0] == 'I') || (Format[0] == 'i') ||
+           (Format[0] == 'L') || (Format[0] == 'l'));
+   }
+ }
+
+void              *ArrayTargetAcquire (PyObject           *Target,
+                                       char                Format,
+                                       unsigned int        ItemCount,
+                                       Py_buffer          *View)
+ {
+  if (PyObject_CheckBuffer(Target))
+   {
+    if (PyObject_GetBuffer(Target,View,PyBUF_WRITABLE | PyBUF_FORMAT | PyBUF_C_CONTIGUOUS) != 0)
+     {
+      return(NULL);
+     }
+
+    if ((View->itemsize != 4) || (!IsNativeFormat(View->format,Format)))
+     {
+      PyBuffer_Release(View);
+
+      PyErr_SetString(PyExc_TypeError,Format == 'f' ? "target buffer must contain 32-bit floats"
+                                                    : "target buffer must contain 32-bit integers");
+
+      return(NULL);
+     }
+   }
+  else
+   {
+    void                              *Ptr;
+    Py_ssize_t                         Length;
+
+    /* old-style buffer (array.array for example) - item format can't be checked */
+
+    if (PyObject_AsWriteBuffer(Target,&Ptr,&Length) != 0)
+     {
+      return(NULL);
+     }
+
+    View->buf = Ptr;
+    View->len = Length;
+    View->obj = NULL;
+   }
+
+  if (View->len < (Py_ssize_t)ItemCount * 4)
+   {
+    ArrayTargetRelease(View);
+
+    PyErr_SetString(PyExc_ValueError,"target buffer is too small");
+
+    return(NULL);
+   }
+
+  return(View->buf);
+ }
+
+void               ArrayTargetRelease (Py_buffer          *View)
+ {
+  if (View->obj != NULL)
+   {
+    PyBuffer_Release(View);
+   }
+ }
+
+bool               ArrayTargetIsLocked(const Py_buffer    *View)
+ {
+  return(View->obj != NULL);
+ }
+
+static PySequenceMethods ArraySequenceMethods =
+ {
+  (lenfunc)ArrayLength,             /*sq_length*/
+  0,                                /*sq_concat*/
+  0,                                /*sq_repeat*/
+  (ssizeargfunc)ArrayItem,          /*sq_item*/
+  0,                                /*sq_slice*/
+  0,                                /*sq_ass_item*/
+  0,                                /*sq_ass_slice*/
+  0,                                /*sq_contains*/
+  0,                                /*sq_inplace_concat*/
+  0                                 /*sq_inplace_repeat*/
+ };
+
+static PyBufferProcs ArrayBufferProcs =
+ {
+  (readbufferproc)ArrayGetReadBuffer,  /*bf_getreadbuffer*/
+  (writebufferproc)ArrayGetReadBuffer, /*bf_getwritebuffer*/
+  (segcountproc)ArrayGetSegCount,      /*bf_getsegcount*/
+  0,                                   /*bf_getcharbuffer*/
+  (getbufferproc)ArrayGetBuffer,       /*bf_getbuffer*/
+  0                                    /*bf_releasebuffer*/
+ };
+
+static PyGetSetDef ArrayGetSeters[] =
+ {
+  {
+   "Shape",
+   (getter)ArrayGetShape,
+   NULL,
+   "Array dimensions",
+   NULL
+  },
+  {
+   "TypeCode",
+   (getter)ArrayGetTypeCode,
+   NULL,
+   "Item type ('f' - float, 'I' - unsigned int)",
+   NULL
+  },
+  {
+   NULL
+  }
+ };
+
+PyTypeObject ArrayType =
+ {
+  PyObject_HEAD_INIT(NULL)
+  0,                                /*ob_size*/
+  "_ngp.Array",                     /*tp_name*/
+  sizeof(ArrayObject),              /*tp_basicsize*/
+  0,                                /*tp_itemsize*/
+  (destructor)ArrayDealloc,         /*tp_dealloc*/
+  0,                                /*tp_print*/
+  0,                                /*tp_getattr*/
+  0,                                /*tp_setattr*/
+  0,                                /*tp_compare*/
+  0,                                /*tp_repr*/
+  0,                                /*tp_as_number*/
+  &ArraySequenceMethods,            /*tp_as_sequence*/
+  0,                                /*tp_as_mapping*/
+  0,                                /*tp_hash*/
+  0,                                /*tp_call*/
+  0,                                /*tp_str*/
+  0,                                /*tp_getattro*/
+  0,                                /*tp_setattro*/
+  &ArrayBufferProcs,                /*tp_as_buffer*/
+  Py_TPFLAGS_DEFAULT |
+  Py_TPFLAGS_HAVE_NEWBUFFER,        /*tp_flags*/
+  "Array objects",                  /*tp_doc*/
+  0,                                /*tp_traverse*/
+  0,                                /*tp_clear*/
+  0,                                /*tp_richcompare*/
+  0,                                /*tp_weaklistoffset*/
+  0,                                /*tp_iter*/
+  0,                                /*tp_iternext*/
+  0,                                /*tp_methods*/
+  0,                                /*tp_members*/
+  ArrayGetSeters,                   /*tp_getset*/
+  0,                                /*tp_base*/
+  0,                                /*tp_dict*/
+  0,                                /*tp_descr_get*/
+  0,                                /*tp_descr_set*/
+  0,                                /*tp_dictoffset*/
+  0,                                /*tp_init*/
+  0,                                /*tp_alloc*/
+  0                                 /*tp_new*/
+ };
+
@@ -0,0 +1,74 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#ifndef __NGPPYARRAY_H__
+#define __NGPPYARRAY_H__
+
+#include <Python.h>
+
+/* Array object owns flat buffer of 32-bit items ('f' - float,         */
+/* 'I' - unsigned int) and exposes it through buffer protocol, so it   */
+/* can be wrapped by memoryview or numpy.asarray without copying. It   */
+/* also behaves like read-only sequence of rows (tuples for 2D arrays) */
+
+typedef struct
+ {
+  PyObject_HEAD
+  void                                *Data;
+  int                                  NDim;
+  Py_ssize_t                           Shape[2];
+  Py_ssize_t                           Strides[2];
+  char                                 Format[2];
+ } ArrayObject;
+
+extern PyTypeObject ArrayType;
+
+/* ColCount == 0 creates one-dimensional array */
+extern ArrayObject*ArrayCreate        (char                Format,
+                                       unsigned int        RowCount,
+                                       unsigned int        ColCount);
+
+/* Return writable memory of Target object which must hold at least   */
+/* ItemCount items of given format. View must be released with        */
+/* ArrayTargetRelease if non-NULL pointer was returned                */
+extern void       *ArrayTargetAcquire (PyObject           *Target,
+                                       char                Format,
+                                       unsigned int        ItemCount,
+                                       Py_buffer          *View);
+
+extern void        ArrayTargetRelease (Py_buffer          *View);
+
+/* Old-style buffers are not locked while acquired, so they must be */
+/* filled without releasing GIL                                     */
+extern bool        ArrayTargetIsLocked(const Py_buffer    *View);
+
+#endif
+
@@ -35,6 +35,8 @@
 
 #include <ngppyplantinstance.h>
 #include <ngppymaterialdef.h>
+#include <ngppyarray.h>
+#include <ngppygil.h>
 #include <ngppybranchgroup.h>
 
 static void        BranchGroupDealloc(BranchGroupObject   *self)
@@ -517,13 +519,17 @@ static PyObject    *BranchGroupGetVAttrBufferImpl
       return(PyErr_NoMemory());
      }
 
-    if (CloneMode)
-     {
-      BranchGroup->PlantInstance->Template->FillCloneVAttrBuffer(Buffer,BranchGroup->GroupIndex,Attr);
-     }
-    else
      {
-      BranchGroup->PlantInstance->Instance->FillVAttrBuffer(Buffer,BranchGroup->GroupIndex,Attr);
+      GILReleaser                        NoGIL;
+
+      if (CloneMode)
+       {
+        BranchGroup->PlantInstance->Template->FillCloneVAttrBuffer(Buffer,BranchGroup->GroupIndex,Attr);
+       }
+      else
+       {
+        BranchGroup->PlantInstance->Instance->FillVAttrBuffer(Buffer,BranchGroup->GroupIndex,Attr);
+       }
      }
 
     Result = CreateListFromFloatBuffer(Buffer,AttrItemCount,TotalAttrCount);
@@ -944,15 +950,19 @@ static PyObject    *BranchGroupGetVAttrBufferIImpl
 
     VAttrBuffers.AddAttr(Attr,Buffer,0,sizeof(float) * AttrItemCount);
 
-    if (CloneMode)
      {
-      BranchGroup->PlantInstance->Template->FillCloneVAttrBuffersI
-       (&VAttrBuffers,BranchGroup->GroupIndex);
-     }
-    else
-     {
-      BranchGroup->PlantInstance->Instance->FillVAttrBuffersI
-       (&VAttrBuffers,BranchGroup->GroupIndex);
+      GILReleaser                        NoGIL;
+
+      if (CloneMode)
+       {
+        BranchGroup->PlantInstance->Template->FillCloneVAttrBuffersI
+         (&VAttrBuffers,BranchGroup->GroupIndex);
+       }
+      else
+       {
+        BranchGroup->PlantInstance->Instance->FillVAttrBuffersI
+         (&VAttrBuffers,BranchGroup->GroupIndex);
+       }
      }
 
     Result = CreateListFromFloatBuffer(Buffer,AttrItemCount,TotalAttrCount);
@@ -1041,8 +1051,12 @@ static PyObject    *BranchGroupGetCloneTransformBuffer
       return(PyErr_NoMemory());
      }
 
-    BranchGroup->PlantInstance->Instance->FillCloneTransformBuffer
-     (OffsetBuffer,OrientationBuffer,ScaleBuffer,BranchGroup->GroupIndex);
+     {
+      GILReleaser                        NoGIL;
+
+      BranchGroup->PlantInstance->Instance->FillCloneTransformBuffer
+       (OffsetBuffer,OrientationBuffer,ScaleBuffer,BranchGroup->GroupIndex);
+     }
 
     OffsetList      = CreateListFromFloatBuffer(OffsetBuffer,3,BranchCount);
     OrientationList = CreateListFromFloatBuffer(OrientationBuffer,4,BranchCount);
@@ -1292,6 +1306,519 @@ static PyObject    *BranchGroupGetIndexBuffer
   return(Result);
  }
 
+enum
+ {
+  ArrayKindVAttr,
+  ArrayKindCloneVAttr,
+  ArrayKindVAttrIndex,
+  ArrayKindVAttrI,
+  ArrayKindCloneVAttrI,
+  ArrayKindIndex
+ };
+
+static unsigned int GetAttrItemCount  (unsigned int        Attr,
+                                       bool                Indexed)
+ {
+  if      ((Attr == P3D_ATTR_VERTEX)  ||
+           (Attr == P3D_ATTR_NORMAL)  ||
+           (Attr == P3D_ATTR_TANGENT) ||
+           (Attr == P3D_ATTR_BINORMAL))
+   {
+    return(3);
+   }
+  else if (Attr == P3D_ATTR_TEXCOORD0)
+   {
+    return(2);
+   }
+  else if ((Attr == P3D_ATTR_BILLBOARD_POS) && (Indexed))
+   {
+    return(3);
+   }
+  else
+   {
+    return(0);
+   }
+ }
+
+static unsigned int CalcBranchVAttrIndexCount
+                                      (const P3DHLIPlantTemplate
+                                                          *Template,
+                                       unsigned int        GroupIndex)
+ {
+  unsigned int                         PrimitiveCount;
+  unsigned int                         IndexCount;
+
+  PrimitiveCount = Template->GetPrimitiveCount(GroupIndex);
+  IndexCount     = 0;
+
+  for (unsigned int PrimitiveIndex = 0; PrimitiveIndex < PrimitiveCount; PrimitiveIndex++)
+   {
+    if (Template->GetPrimitiveType(GroupIndex,PrimitiveIndex) == P3D_QUAD)
+     {
+      IndexCount += 4;
+     }
+    else
+     {
+      IndexCount += 3;
+     }
+   }
+
+  return(IndexCount);
+ }
+
+/* Calculates array dimensions (ColCount == 0 for flat index arrays) */
+/* and sets python exception if request is invalid                   */
+static bool        GetArrayShape      (BranchGroupObject  *BranchGroup,
+                                       unsigned int        Kind,
+                                       unsigned int        Param,
+                                       bool                All,
+                                       unsigned int       *RowCount,
+                                       unsigned int       *ColCount,
+                                       char               *Format)
+ {
+  const P3DHLIPlantTemplate           *Template;
+  const P3DHLIPlantInstance           *Instance;
+  unsigned int                         GroupIndex;
+  unsigned int                         ReqBranchCount;
+
+  Template   = BranchGroup->PlantInstance->Template;
+  Instance   = BranchGroup->PlantInstance->Instance;
+  GroupIndex = BranchGroup->GroupIndex;
+
+  if (((Kind == ArrayKindCloneVAttr) || (Kind == ArrayKindCloneVAttrI)) &&
+      (!Template->IsCloneable(GroupIndex,true)))
+   {
+    PyErr_SetString(PyExc_RuntimeError,"trying to get clone attributes for non-cloneable group");
+
+    return(false);
+   }
+
+  if ((Kind == ArrayKindVAttrIndex) || (Kind == ArrayKindIndex))
+   {
+    *ColCount = 0;
+    *Format   = 'I';
+
+    if (Kind == ArrayKindIndex)
+     {
+      if (Param != P3D_TRIANGLE_LIST)
+       {
+        PyErr_SetString(PyExc_RuntimeError,"invalid primitive type");
+
+        return(false);
+       }
+     }
+    else if (GetAttrItemCount(Param,false) == 0)
+     {
+      PyErr_SetString(PyExc_RuntimeError,"invalid attribute");
+
+      return(false);
+     }
+
+    ReqBranchCount = All ? Instance->GetBranchCount(GroupIndex) : 1;
+
+    if (Kind == ArrayKindIndex)
+     {
+      *RowCount = Template->GetIndexCount(GroupIndex,Param) * ReqBranchCount;
+     }
+    else
+     {
+      *RowCount = CalcBranchVAttrIndexCount(Template,GroupIndex) * ReqBranchCount;
+     }
+   }
+  else
+   {
+    bool                               Indexed;
+
+    Indexed   = (Kind == ArrayKindVAttrI) || (Kind == ArrayKindCloneVAttrI);
+    *ColCount = GetAttrItemCount(Param,Indexed);
+    *Format   = 'f';
+
+    if (*ColCount == 0)
+     {
+      PyErr_SetString(PyExc_RuntimeError,"invalid attribute");
+
+      return(false);
+     }
+
+    switch (Kind)
+     {
+      case (ArrayKindVAttr)       :
+       {
+        *RowCount = Instance->GetVAttrCount(GroupIndex,Param);
+       } break;
+
+      case (ArrayKindCloneVAttr)  :
+       {
+        *RowCount = Template->GetVAttrCount(GroupIndex,Param);
+       } break;
+
+      case (ArrayKindVAttrI)      :
+       {
+        *RowCount = Instance->GetVAttrCountI(GroupIndex);
+       } break;
+
+      default                     :
+       {
+        *RowCount = Template->GetVAttrCountI(GroupIndex);
+       }
+     }
+   }
+
+  return(true);
+ }
+
+static void        FillArray          (BranchGroupObject  *BranchGroup,
+                                       unsigned int        Kind,
+                                       unsigned int        Param,
+                                       bool                All,
+                                       unsigned int        IndexBase,
+                                       void               *Target)
+ {
+  const P3DHLIPlantTemplate           *Template;
+  const P3DHLIPlantInstance           *Instance;
+  unsigned int                         GroupIndex;
+
+  Template   = BranchGroup->PlantInstance->Template;
+  Instance   = BranchGroup->PlantInstance->Instance;
+  GroupIndex = BranchGroup->GroupIndex;
+
+  switch (Kind)
+   {
+    case (ArrayKindVAttr)       :
+     {
+      Instance->FillVAttrBuffer(Target,GroupIndex,Param);
+     } break;
+
+    case (ArrayKindCloneVAttr)  :
+     {
+      Template->FillCloneVAttrBuffer(Target,GroupIndex,Param);
+     } break;
+
+    case (ArrayKindVAttrI)      :
+    case (ArrayKindCloneVAttrI) :
+     {
+      P3DHLIVAttrBuffers       VAttrBuffers;
+
+      VAttrBuffers.AddAttr(Param,Target,0,sizeof(float) * GetAttrItemCount(Param,true));
+
+      if (Kind == ArrayKindVAttrI)
+       {
+        Instance->FillVAttrBuffersI(&VAttrBuffers,GroupIndex);
+       }
+      else
+       {
+        Template->FillCloneVAttrBuffersI(&VAttrBuffers,GroupIndex);
+       }
+     } break;
+
+    case (ArrayKindVAttrIndex)  :
+    case (ArrayKindIndex)       :
+     {
+      unsigned int            *Ptr;
+      unsigned int             BranchIndexCount;
+      unsigned int             BranchVAttrCount;
+      unsigned int             ReqBranchCount;
+
+      Ptr            = (unsigned int*)Target;
+      ReqBranchCount = All ? Instance->GetBranchCount(GroupIndex) : 1;
+
+      if (Kind == ArrayKindIndex)
+       {
+        BranchIndexCount = Template->GetIndexCount(GroupIndex,Param);
+        BranchVAttrCount = Template->GetVAttrCountI(GroupIndex);
+       }
+      else
+       {
+        BranchIndexCount = CalcBranchVAttrIndexCount(Template,GroupIndex);
+        BranchVAttrCount = Template->GetVAttrCount(GroupIndex,Param);
+       }
+
+      for (unsigned int BranchIndex = 0; BranchIndex < ReqBranchCount; BranchIndex++)
+       {
+        if (Kind == ArrayKindIndex)
+         {
+          Template->FillIndexBuffer(Ptr,GroupIndex,Param,P3D_UNSIGNED_INT,IndexBase);
+         }
+        else
+         {
+          Template->FillVAttrIndexBuffer(Ptr,GroupIndex,Param,P3D_UNSIGNED_INT,IndexBase);
+         }
+
+        Ptr       += BranchIndexCount;
+        IndexBase += BranchVAttrCount;
+       }
+     } break;
+   }
+ }
+
+static bool        ParseArrayArgs     (PyObject           *args,
+                                       unsigned int        Kind,
+                                       unsigned int       *Param,
+                                       PyObject          **Target,
+                                       bool               *All,
+                                       unsigned int       *IndexBase)
+ {
+  int                                  AllFlag;
+
+  AllFlag    = 1;
+  *IndexBase = 0;
+
+  if ((Kind == ArrayKindVAttrIndex) || (Kind == ArrayKindIndex))
+   {
+    if (Target != NULL)
+     {
+      if (!PyArg_ParseTuple(args,"IO|iI",Param,Target,&AllFlag,IndexBase))
+       {
+        return(false);
+       }
+     }
+    else
+     {
+      if (!PyArg_ParseTuple(args,"I|iI",Param,&AllFlag,IndexBase))
+       {
+        return(false);
+       }
+     }
+   }
+  else
+   {
+    if (Target != NULL)
+     {
+      if (!PyArg_ParseTuple(args,"IO",Param,Target))
+       {
+        return(false);
+       }
+     }
+    else
+     {
+      if (!PyArg_ParseTuple(args,"I",Param))
+       {
+        return(false);
+       }
+     }
+   }
+
+  *All = AllFlag != 0;
+
+  return(true);
+ }
+
+static PyObject    *BranchGroupGetArrayImpl
+                                      (PyObject           *self,
+                                       PyObject           *args,
+                                       unsigned int        Kind)
+ {
+  BranchGroupObject                   *BranchGroup;
+  ArrayObject                         *Result;
+  unsigned int                         Param;
+  bool                                 All;
+  unsigned int                         IndexBase;
+  unsigned int                         RowCount;
+  unsigned int                         ColCount;
+  char                                 Format;
+
+  Result      = NULL;
+  BranchGroup = (BranchGroupObject*)self;
+
+  if (!PlantInstanceCheck(BranchGroup->PlantInstance))
+   {
+    return(NULL);
+   }
+
+  if (!ParseArrayArgs(args,Kind,&Param,NULL,&All,&IndexBase))
+   {
+    return(NULL);
+   }
+
+  try
+   {
+    if (!GetArrayShape(BranchGroup,Kind,Param,All,&RowCount,&ColCount,&Format))
+     {
+      return(NULL);
+     }
+
+    Result = ArrayCreate(Format,RowCount,ColCount);
+
+    if (Result == NULL)
+     {
+      return(NULL);
+     }
+
+     {
+      GILReleaser                        NoGIL;
+
+      FillArray(BranchGroup,Kind,Param,All,IndexBase,Result->Data);
+     }
+   }
+  catch (P3DException       &Error)
+   {
+    PyErr_SetString(PyExc_RuntimeError,Error.GetMessage());
+
+    Py_XDECREF(Result);
+
+    return(NULL);
+   }
+
+  return((PyObject*)Result);
+ }
+
+static PyObject    *BranchGroupFillArrayImpl
+                                      (PyObject           *self,
+                                       PyObject           *args,
+                                       unsigned int        Kind)
+ {
+  BranchGroupObject                   *BranchGroup;
+  PyObject                            *Target;
+  Py_buffer                            View;
+  void                                *Buffer;
+  unsigned int                         Param;
+  bool                                 All;
+  unsigned int                         IndexBase;
+  unsigned int                         RowCount;
+  unsigned int                         ColCount;
+  char                                 Format;
+
+  Buffer      = NULL;
+  BranchGroup = (BranchGroupObject*)self;
+
+  if (!PlantInstanceCheck(BranchGroup->PlantInstance))
+   {
+    return(NULL);
+   }
+
+  if (!ParseArrayArgs(args,Kind,&Param,&Target,&All,&IndexBase))
+   {
+    return(NULL);
+   }
+
+  try
+   {
+    if (!GetArrayShape(BranchGroup,Kind,Param,All,&RowCount,&ColCount,&Format))
+     {
+      return(NULL);
+     }
+
+    Buffer = ArrayTargetAcquire(Target,Format,ColCount == 0 ? RowCount : RowCount * ColCount,&View);
+
+    if (Buffer == NULL)
+     {
+      return(NULL);
+     }
+
+    if (ArrayTargetIsLocked(&View))
+     {
+      GILReleaser                        NoGIL;
+
+      FillArray(BranchGroup,Kind,Param,All,IndexBase,Buffer);
+     }
+    else
+     {
+      /* GIL is kept, so other threads can't resize or free the target */
+
+      FillArray(BranchGroup,Kind,Param,All,IndexBase,Buffer);
+     }
+
+    ArrayTargetRelease(&View);
+   }
+  catch (P3DException       &Error)
+   {
+    PyErr_SetString(PyExc_RuntimeError,Error.GetMessage());
+
+    if (Buffer != NULL)
+     {
+      ArrayTargetRelease(&View);
+     }
+
+    return(NULL);
+   }
+
+  return(Py_BuildValue("l",(long)RowCount));
+ }
+
+static PyObject    *BranchGroupGetVAttrArray
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  return BranchGroupGetArrayImpl(self,args,ArrayKindVAttr);
+ }
+
+static PyObject    *BranchGroupGetCloneVAttrArray
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  return BranchGroupGetArrayImpl(self,args,ArrayKindCloneVAttr);
+ }
+
+static PyObject    *BranchGroupGetVAttrIndexArray
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  return BranchGroupGetArrayImpl(self,args,ArrayKindVAttrIndex);
+ }
+
+static PyObject    *BranchGroupGetVAttrArrayI
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  return BranchGroupGetArrayImpl(self,args,ArrayKindVAttrI);
+ }
+
+static PyObject    *BranchGroupGetCloneVAttrArrayI
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  return BranchGroupGetArrayImpl(self,args,ArrayKindCloneVAttrI);
+ }
+
+static PyObject    *BranchGroupGetIndexArray
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  return BranchGroupGetArrayImpl(self,args,ArrayKindIndex);
+ }
+
+static PyObject    *BranchGroupFillVAttrBuffer
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  return BranchGroupFillArrayImpl(self,args,ArrayKindVAttr);
+ }
+
+static PyObject    *BranchGroupFillCloneVAttrBuffer
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  return BranchGroupFillArrayImpl(self,args,ArrayKindCloneVAttr);
+ }
+
+static PyObject    *BranchGroupFillVAttrIndexBuffer
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  return BranchGroupFillArrayImpl(self,args,ArrayKindVAttrIndex);
+ }
+
+static PyObject    *BranchGroupFillVAttrBufferI
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  return BranchGroupFillArrayImpl(self,args,ArrayKindVAttrI);
+ }
+
+static PyObject    *BranchGroupFillCloneVAttrBufferI
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  return BranchGroupFillArrayImpl(self,args,ArrayKindCloneVAttrI);
+ }
+
+static PyObject    *BranchGroupFillIndexBuffer
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  return BranchGroupFillArrayImpl(self,args,ArrayKindIndex);
+ }
+
 static PyMethodDef BranchGroupMethods[] =
  {
   {
@@ -1414,6 +1941,78 @@ static PyMethodDef BranchGroupMethods[] =
    METH_VARARGS,
    "Return branch group index buffer"
   },
+  {
+   "GetVAttrArray",
+   (PyCFunction)BranchGroupGetVAttrArray,
+   METH_VARARGS,
+   "Return attributes as Array object (buffer protocol, no per-item python objects)"
+  },
+  {
+   "GetCloneVAttrArray",
+   (PyCFunction)BranchGroupGetCloneVAttrArray,
+   METH_VARARGS,
+   "Return attributes for cloneable branch group as Array object"
+  },
+  {
+   "GetVAttrIndexArray",
+   (PyCFunction)BranchGroupGetVAttrIndexArray,
+   METH_VARARGS,
+   "Return flat array of indices as Array object"
+  },
+  {
+   "GetVAttrArrayI",
+   (PyCFunction)BranchGroupGetVAttrArrayI,
+   METH_VARARGS,
+   "Return attributes as Array object (indexed mode)"
+  },
+  {
+   "GetCloneVAttrArrayI",
+   (PyCFunction)BranchGroupGetCloneVAttrArrayI,
+   METH_VARARGS,
+   "Return attributes for cloneable group as Array object (indexed mode)"
+  },
+  {
+   "GetIndexArray",
+   (PyCFunction)BranchGroupGetIndexArray,
+   METH_VARARGS,
+   "Return branch group index buffer as Array object"
+  },
+  {
+   "FillVAttrBuffer",
+   (PyCFunction)BranchGroupFillVAttrBuffer,
+   METH_VARARGS,
+   "Fill writable buffer object with attributes, return attribute count"
+  },
+  {
+   "FillCloneVAttrBuffer",
+   (PyCFunction)BranchGroupFillCloneVAttrBuffer,
+   METH_VARARGS,
+   "Fill writable buffer object with attributes for cloneable branch group"
+  },
+  {
+   "FillVAttrIndexBuffer",
+   (PyCFunction)BranchGroupFillVAttrIndexBuffer,
+   METH_VARARGS,
+   "Fill writable buffer object with flat array of indices"
+  },
+  {
+   "FillVAttrBufferI",
+   (PyCFunction)BranchGroupFillVAttrBufferI,
+   METH_VARARGS,
+   "Fill writable buffer object with attributes (indexed mode)"
+  },
+  {
+   "FillCloneVAttrBufferI",
+   (PyCFunction)BranchGroupFillCloneVAttrBufferI,
+   METH_VARARGS,
+   "Fill writable buffer object with attributes for cloneable group (indexed mode)"
+  },
+  {
+   "FillIndexBuffer",
+   (PyCFunction)BranchGroupFillIndexBuffer,
+   METH_VARARGS,
+   "Fill writable buffer object with branch group indices"
+  },
   { NULL }
  };
 
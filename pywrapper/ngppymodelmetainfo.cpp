@@ -252,3 +252,22 @@ PyTypeObject ModelMetaInfoType =
   ModelMetaInfoNew                  /*tp_new*/
  };
 
+PyObject          *ModelMetaInfoCreate(const P3DModelMetaInfo
+                                                          *MetaInfoLow)
+ {
+  ModelMetaInfoObject                 *MetaInfo;
+
+  MetaInfo = PyObject_New(ModelMetaInfoObject,&ModelMetaInfoType);
+
+  if (MetaInfo != NULL)
+   {
+    MetaInfo->Author       = Py_BuildValue("z",MetaInfoLow->GetAuthor());
+    MetaInfo->AuthorURL    = Py_BuildValue("z",MetaInfoLow->GetAuthorURL());
+    MetaInfo->LicenseName  = Py_BuildValue("z",MetaInfoLow->GetLicenseName());
+    MetaInfo->LicenseURL   = Py_BuildValue("z",MetaInfoLow->GetLicenseURL());
+    MetaInfo->PlantInfoURL = Py_BuildValue("z",MetaInfoLow->GetPlantInfoURL());
+   }
+
+  return((PyObject*)MetaInfo);
+ }
+
@@ -46,5 +46,10 @@ typedef struct
 
 extern PyTypeObject ModelMetaInfoType;
 
+class P3DModelMetaInfo;
+
+extern PyObject   *ModelMetaInfoCreate(const P3DModelMetaInfo
+                                                          *MetaInfo);
+
 #endif
 
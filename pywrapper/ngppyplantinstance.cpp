@@ -32,12 +32,21 @@
 #include <ngppyplantinstance.h>
 #include <ngppybranchgroup.h>
 #include <ngppymodelmetainfo.h>
+#include <ngppygil.h>
 
 static void        PlantInstanceDealloc
                                       (PlantInstanceObject*self)
  {
   delete self->Instance;
-  delete self->Template;
+
+  if (self->TemplateObject != NULL)
+   {
+    Py_DECREF(self->TemplateObject);
+   }
+  else
+   {
+    delete self->Template;
+   }
 
   self->ob_type->tp_free((PyObject*)self);
  }
@@ -52,8 +61,9 @@ static PyObject   *PlantInstanceNew   (PyTypeObject       *type,
 
   if (self != NULL)
    {
-    self->Template = NULL;
-    self->Instance = NULL;
+    self->Template       = NULL;
+    self->Instance       = NULL;
+    self->TemplateObject = NULL;
    }
 
   return((PyObject*)self);
@@ -140,8 +150,6 @@ static PyObject    *PlantInstanceGetMetaInfo
                                        PyObject           *args)
  {
   PlantInstanceObject                 *InstanceObject;
-  ModelMetaInfoObject                 *MetaInfo;
-  const P3DModelMetaInfo              *MetaInfoLow;
 
   InstanceObject = (PlantInstanceObject*)self;
 
@@ -150,19 +158,7 @@ static PyObject    *PlantInstanceGetMetaInfo
     return(NULL);
    }
 
-  MetaInfoLow = InstanceObject->Template->GetMetaInfo();
-  MetaInfo    = PyObject_New(ModelMetaInfoObject,&ModelMetaInfoType);
-
-  if (MetaInfo != NULL)
-   {
-    MetaInfo->Author       = Py_BuildValue("z",MetaInfoLow->GetAuthor());
-    MetaInfo->AuthorURL    = Py_BuildValue("z",MetaInfoLow->GetAuthorURL());
-    MetaInfo->LicenseName  = Py_BuildValue("z",MetaInfoLow->GetLicenseName());
-    MetaInfo->LicenseURL   = Py_BuildValue("z",MetaInfoLow->GetLicenseURL());
-    MetaInfo->PlantInfoURL = Py_BuildValue("z",MetaInfoLow->GetPlantInfoURL());
-   }
-
-  return((PyObject*)MetaInfo);
+  return(ModelMetaInfoCreate(InstanceObject->Template->GetMetaInfo()));
  }
 
 static PyObject    *PlantInstanceGetGroupCount
@@ -236,7 +232,11 @@ static PyObject    *PlantInstanceGetBoundingBox
     return(NULL);
    }
 
-  InstanceObject->Instance->GetBoundingBox(Min,Max);
+   {
+    GILReleaser                        NoGIL;
+
+    InstanceObject->Instance->GetBoundingBox(Min,Max);
+   }
 
   return(Py_BuildValue("((fff)(fff))",Min[0],Min[1],Min[2],Max[0],Max[1],Max[2]));
  }
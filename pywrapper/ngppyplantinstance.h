@@ -40,6 +40,7 @@ typedef struct
   PyObject_HEAD
   P3DHLIPlantTemplate                 *Template;
   P3DHLIPlantInstance                 *Instance;
+  PyObject                            *TemplateObject; /* template owner if shared, NULL otherwise */
  } PlantInstanceObject;
 
 extern PyTypeObject                    PlantInstanceType;
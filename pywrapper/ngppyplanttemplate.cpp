@@ -0,0 +1,285 @@
+/***************************************************************************
+
+ Copyright (c) 2007 Sergey Prokhorchuk.
+ All rights reserved.
+
+ Redistribution and use in source and binary forms, with or without
+ modification, are permitted provided that the following conditions
+ are met:
+ 1. Redistributions of source code must retain the above copyright
+    notice, this list of conditions and the following disclaimer.
+ 2. Redistributions in binary form must reproduce the above copyright
+    notice, this list of conditions and the following disclaimer in the
+    documentation and/or other materials provided with the distribution.
+ 3. Neither the name of the author nor the names of contributors
+    may be used to endorse or promote products derived from this software
+    without specific prior written permission.
+
+ THIS SOFTWARE IS PROVIDED BY THE AUTHOR AND CONTRIBUTORS ``AS IS'' AND
+ ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ ARE DISCLAIMED.  IN NO EVENT SHALL THE AUTHOR OR CONTRIBUTORS BE LIABLE
+ FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS
+ OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY
+ OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+ SUCH DAMAGE.
+
+***************************************************************************/
+
+#include <ngppyplanttemplate.h>
+#include <ngppyplantinstance.h>
+#include <ngppymodelmetainfo.h>
+
+static void        PlantTemplateDealloc
+                                      (PlantTemplateObject*self)
+ {
+  delete self->Template;
+
+  self->ob_type->tp_free((PyObject*)self);
+ }
+
+static PyObject   *PlantTemplateNew   (PyTypeObject       *type,
+                                       PyObject           *args,
+                                       PyObject           *kwds)
+ {
+  PlantTemplateObject                 *self;
+
+  self = (PlantTemplateObject*)type->tp_alloc(type,0);
+
+  if (self != NULL)
+   {
+    self->Template = NULL;
+   }
+
+  return((PyObject*)self);
+ }
+
+static int         PlantTemplateInit  (PlantTemplateObject*self,
+                                       PyObject           *args,
+                                       PyObject           *kwds)
+ {
+  char                                *FileName;
+  int                                  EnableDummies;
+
+  EnableDummies = 0;
+
+  if (!PyArg_ParseTuple(args,"s|i",&FileName,&EnableDummies))
+   {
+    return(-1);
+   }
+
+  if (self->Template != NULL)
+   {
+    PyErr_SetString(PyExc_RuntimeError,"object is already initialized");
+
+    return(-1);
+   }
+
+  /* Model parsing switches process-wide numeric locale, so it is done */
+  /* with GIL held                                                     */
+
+  try
+   {
+    P3DInputStringStreamFile           SourceStream;
+
+    SourceStream.Open(FileName);
+
+    self->Template = new P3DHLIPlantTemplate(&SourceStream);
+
+    if (EnableDummies)
+     {
+      self->Template->SetDummiesEnabled(true);
+     }
+
+    SourceStream.Close();
+   }
+  catch (P3DException       &Error)
+   {
+    delete self->Template;
+
+    self->Template = NULL;
+
+    PyErr_SetString(PyExc_RuntimeError,Error.GetMessage());
+
+    return(-1);
+   }
+  catch (...)
+   {
+    delete self->Template;
+
+    self->Template = NULL;
+
+    PyErr_SetString(PyExc_RuntimeError,"undefined error");
+
+    return(-1);
+   }
+
+  return(0);
+ }
+
+static int         PlantTemplateCheck (PlantTemplateObject*TemplateObject)
+ {
+  if (TemplateObject->Template == NULL)
+   {
+    PyErr_SetString(PyExc_RuntimeError,"object is not initialized");
+
+    return(0);
+   }
+  else
+   {
+    return(1);
+   }
+ }
+
+static PyObject    *PlantTemplateCreateInstance
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  PlantTemplateObject                 *TemplateObject;
+  PlantInstanceObject                 *InstanceObject;
+  unsigned int                         Seed;
+
+  TemplateObject = (PlantTemplateObject*)self;
+
+  if (!PlantTemplateCheck(TemplateObject))
+   {
+    return(NULL);
+   }
+
+  Seed = 0;
+
+  if (!PyArg_ParseTuple(args,"|I",&Seed))
+   {
+    return(NULL);
+   }
+
+  InstanceObject = PyObject_New(PlantInstanceObject,&PlantInstanceType);
+
+  if (InstanceObject == NULL)
+   {
+    return(NULL);
+   }
+
+  Py_INCREF(self);
+
+  InstanceObject->Template       = TemplateObject->Template;
+  InstanceObject->TemplateObject = self;
+  InstanceObject->Instance       = NULL;
+
+  try
+   {
+    InstanceObject->Instance = TemplateObject->Template->CreateInstance(Seed);
+   }
+  catch (...)
+   {
+    Py_DECREF(InstanceObject);
+
+    PyErr_SetString(PyExc_RuntimeError,"unable to create plant instance");
+
+    return(NULL);
+   }
+
+  return((PyObject*)InstanceObject);
+ }
+
+static PyObject    *PlantTemplateGetMetaInfo
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  PlantTemplateObject                 *TemplateObject;
+
+  TemplateObject = (PlantTemplateObject*)self;
+
+  if (!PlantTemplateCheck(TemplateObject))
+   {
+    return(NULL);
+   }
+
+  return(ModelMetaInfoCreate(TemplateObject->Template->GetMetaInfo()));
+ }
+
+static PyObject    *PlantTemplateGetGroupCount
+                                      (PyObject           *self,
+                                       PyObject           *args)
+ {
+  PlantTemplateObject                 *TemplateObject;
+
+  TemplateObject = (PlantTemplateObject*)self;
+
+  if (!PlantTemplateCheck(TemplateObject))
+   {
+    return(NULL);
+   }
+
+  return(Py_BuildValue("l",(long int)TemplateObject->Template->GetGroupCount()));
+ }
+
+static PyMethodDef PlantTemplateMethods[] =
+ {
+  {
+   "CreateInstance",
+   (PyCFunction)PlantTemplateCreateInstance,
+   METH_VARARGS,
+   "Create plant instance with given seed (0 - use model seed)"
+  },
+  {
+   "GetMetaInfo",
+   (PyCFunction)PlantTemplateGetMetaInfo,
+   METH_NOARGS,
+   "Return plant model meta information"
+  },
+  {
+   "GetGroupCount",
+   (PyCFunction)PlantTemplateGetGroupCount,
+   METH_NOARGS,
+   "Return plant branch group count"
+  },
+  { NULL }
+ };
+
+PyTypeObject PlantTemplateType =
+ {
+  PyObject_HEAD_INIT(NULL)
+  0,                                /*ob_size*/
+  "_ngp.PlantTemplate",             /*tp_name*/
+  sizeof(PlantTemplateObject),      /*tp_basicsize*/
+  0,                                /*tp_itemsize*/
+  (destructor)PlantTemplateDealloc, /*tp_dealloc*/
+  0,                                /*tp_print*/
+  0,                                /*tp_getattr*/
+  0,                                /*tp_setattr*/
+  0,                                /*tp_compare*/
+  0,                                /*tp_repr*/
+  0,                                /*tp_as_number*/
+  0,                                /*tp_as_sequence*/
+  0,                                /*tp_as_mapping*/
+  0,                                /*tp_hash*/
+  0,                                /*tp_call*/
+  0,                                /*tp_str*/
+  0,                                /*tp_getattro*/
+  0,                                /*tp_setattro*/
+  0,                                /*tp_as_buffer*/
+  Py_TPFLAGS_DEFAULT,               /*tp_flags*/
+  "PlantTemplate objects",          /*tp_doc*/
+  0,                                /*tp_traverse */
+  0,                                /*tp_clear*/
+  0,                                /*tp_richcompare*/
+  0,                                /*tp_weaklistoffset*/
+  0,                                /*tp_iter*/
+  0,                                /*tp_iternext*/
+  PlantTemplateMethods,             /*tp_methods*/
+  0,                                /*tp_members*/
+  0,                                /*tp_getset*/
+  0,                                /*tp_base*/
+  0,                                /*tp_dict*/
+  0,                                /*tp_descr_get*/
+  0,                                /*tp_descr_set */
+  0,                                /*tp_dictoffset */
+  (initproc)PlantTemplateInit,      /*tp_init */
+  0,                                /*tp_alloc */
+  PlantTemplateNew                  /*tp_new */
+ };
+
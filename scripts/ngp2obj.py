@@ -3,6 +3,7 @@
 import sys
 import getopt
 import os.path
+import array
 import _ngp
 
 ScriptVersion = '0.9.2'
@@ -50,6 +51,20 @@ TargetOBJFileName = Args[1]
 BaseName,ExtName  = os.path.splitext(TargetOBJFileName)
 TargetMTLFileName = BaseName + '.mtl'
 
+def WriteVAttrs(OBJFile,Group,Attr,Format):
+    Count = Group.GetVAttrCount(Attr,1)
+
+    if Count == 0:
+        return 0
+
+    Buffer = array.array('f',[0.0]) * (Count * Format.count('%f'))
+
+    Group.FillVAttrBuffer(Attr,Buffer)
+
+    OBJFile.write((Format * Count) % tuple(Buffer))
+
+    return Count
+
 Instance = _ngp.PlantInstance(SourceFileName)
 
 OBJFile = open(TargetOBJFileName,'wt')
@@ -72,52 +87,37 @@ for GroupIndex in xrange(Instance.GetGroupCount()):
     else:
         OBJFile.write('usemap %s\n' % (os.path.join(TexturePathPrefix,Material.TexNames[_ngp.TEX_DIFFUSE])))
 
-    Buffer = Group.GetVAttrBuffer(_ngp.ATTR_VERTEX)
-
-    VertexIndexStep = len(Buffer)
-
-    for (x,y,z) in Buffer:
-        OBJFile.write('v %f %f %f\n' % (x,y,z))
-
-    Buffer = Group.GetVAttrBuffer(_ngp.ATTR_NORMAL)
+    VertexIndexStep   = WriteVAttrs(OBJFile,Group,_ngp.ATTR_VERTEX,'v %f %f %f\n')
+    NormalIndexStep   = WriteVAttrs(OBJFile,Group,_ngp.ATTR_NORMAL,'vn %f %f %f\n')
+    TexCoordIndexStep = WriteVAttrs(OBJFile,Group,_ngp.ATTR_TEXCOORD0,'vt %f %f\n')
 
-    NormalIndexStep = len(Buffer)
+    VertexIndexBuffer   = Group.GetVAttrIndexArray(_ngp.ATTR_VERTEX,1,VertexIndexOffset)
+    NormalIndexBuffer   = Group.GetVAttrIndexArray(_ngp.ATTR_NORMAL,1,NormalIndexOffset)
+    TexCoordIndexBuffer = Group.GetVAttrIndexArray(_ngp.ATTR_TEXCOORD0,1,TexCoordIndexOffset)
 
-    for (x,y,z) in Buffer:
-        OBJFile.write('vn %f %f %f\n' % (x,y,z))
+    # face format is the same for all branches in group, so whole group
+    # is written with single formatting operation
 
-    Buffer = Group.GetVAttrBuffer(_ngp.ATTR_TEXCOORD0)
-
-    TexCoordIndexStep = len(Buffer)
-
-    for (u,v) in Buffer:
-        OBJFile.write('vt %f %f\n' % (u,v))
-
-    del Buffer
-
-    VertexIndexBuffer   = Group.GetVAttrIndexBuffer(_ngp.ATTR_VERTEX,1,VertexIndexOffset)
-    NormalIndexBuffer   = Group.GetVAttrIndexBuffer(_ngp.ATTR_NORMAL,1,NormalIndexOffset)
-    TexCoordIndexBuffer = Group.GetVAttrIndexBuffer(_ngp.ATTR_TEXCOORD0,1,TexCoordIndexOffset)
-
-    for PrimitiveIndex in xrange(len(VertexIndexBuffer)):
-        vi = VertexIndexBuffer[PrimitiveIndex]
-        ni = NormalIndexBuffer[PrimitiveIndex]
-        ti = TexCoordIndexBuffer[PrimitiveIndex]
+    FaceFormat = ''
 
+    for PrimitiveIndex in xrange(Group.GetPrimitiveCount(0)):
         if   Group.GetPrimitiveType(PrimitiveIndex) == _ngp.QUAD:
-            OBJFile.write('f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n' %\
-                          (vi[0],ti[0],ni[0],
-                           vi[1],ti[1],ni[1],
-                           vi[2],ti[2],ni[2],
-                           vi[3],ti[3],ni[3]))
+            FaceFormat += 'f %u/%u/%u %u/%u/%u %u/%u/%u %u/%u/%u\n'
         elif Group.GetPrimitiveType(PrimitiveIndex) == _ngp.TRIANGLE:
-            OBJFile.write('f %u/%u/%u %u/%u/%u %u/%u/%u\n' %\
-                          (vi[0],ti[0],ni[0],
-                           vi[1],ti[1],ni[1],
-                           vi[2],ti[2],ni[2]))
+            FaceFormat += 'f %u/%u/%u %u/%u/%u %u/%u/%u\n'
         else:
             raise RuntimeError,'unknown primitive type'
 
+    FaceIndices = [0] * (len(VertexIndexBuffer) * 3)
+
+    FaceIndices[0::3] = VertexIndexBuffer
+    FaceIndices[1::3] = TexCoordIndexBuffer
+    FaceIndices[2::3] = NormalIndexBuffer
+
+    OBJFile.write((FaceFormat * Group.GetBranchCount()) % tuple(FaceIndices))
+
+    del VertexIndexBuffer,NormalIndexBuffer,TexCoordIndexBuffer,FaceIndices
+
     VertexIndexOffset   += VertexIndexStep
     NormalIndexOffset   += NormalIndexStep
     TexCoordIndexOffset += TexCoordIndexStep
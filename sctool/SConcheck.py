@@ -479,3 +479,91 @@ def AppendLibJpegConf(Env):
         Env.Append(LIBPATH=Env['LIBJPEG_LIBPATH'])
         Env.Append(CPPDEFINES=[('WITH_LIBJPEG',1)])
 
+
+P3DCheckZLibUsabilitySrc = """
+#include <zlib.h>
+
+int main (int argc,char *argv[])
+ {
+  z_stream strm;
+
+  strm.zalloc = Z_NULL;
+  strm.zfree  = Z_NULL;
+  strm.opaque = Z_NULL;
+
+  deflateInit(&strm,Z_DEFAULT_COMPRESSION);
+  deflateEnd(&strm);
+
+  return(0);
+ }
+"""
+
+def ConfigureZLib(Context):
+    Context.Message('Checking zlib presence and usability ... ')
+
+    lastLIBS       = GetEnvKeyList(Context.env,'LIBS')
+    lastLIBPATH    = GetEnvKeyList(Context.env,'LIBPATH')
+    lastCPPPATH    = GetEnvKeyList(Context.env,'CPPPATH')
+    lastCPPDEFINES = GetEnvKeyList(Context.env,'CPPDEFINES')
+
+    if EnvKeyHasValue(Context.env,'ZLIB_INC')     or\
+       EnvKeyHasValue(Context.env,'ZLIB_DEFINES') or\
+       EnvKeyHasValue(Context.env,'ZLIB_LIBPATH') or\
+       EnvKeyHasValue(Context.env,'ZLIB_LIBS'):
+        ZLIB_INC     = EnvGetValAsList(Context.env,'ZLIB_INC')
+        ZLIB_CPPDEFS = EnvGetValAsList(Context.env,'ZLIB_DEFINES')
+        ZLIB_LIBPATH = EnvGetValAsList(Context.env,'ZLIB_LIBPATH')
+        ZLIB_LIBS    = EnvGetValAsList(Context.env,'ZLIB_LIBS')
+
+        Context.env.Append(CPPPATH=ZLIB_INC)
+        Context.env.Append(CPPDEFINES=ZLIB_CPPDEFS)
+        Context.env.Append(LIBPATH=ZLIB_LIBPATH)
+        Context.env.Append(LIBS=ZLIB_LIBS)
+    else:
+        try:
+            if EnvKeyHasValue(Context.env,'ZLIB_CONFIG'):
+                Context.env.ParseConfig(Context.env['ZLIB_CONFIG'])
+            else:
+                Context.env.ParseConfig('pkg-config zlib --cflags --libs 2>/dev/null')
+
+            ZLIB_INC = SubtractLists(GetEnvKeyList(Context.env,'CPPPATH'),lastCPPPATH)
+            ZLIB_CPPDEFS = SubtractLists(GetEnvKeyList(Context.env,'CPPDEFINES'),lastCPPDEFINES)
+            ZLIB_LIBS = SubtractLists(GetEnvKeyList(Context.env,'LIBS'),lastLIBS)
+            ZLIB_LIBPATH = SubtractLists(GetEnvKeyList(Context.env,'LIBPATH'),lastLIBPATH)
+        except:
+            ZLIB_INC     = []
+            ZLIB_CPPDEFS = []
+            ZLIB_LIBS    = ['z']
+            ZLIB_LIBPATH = []
+
+            Context.env.Append(LIBS=ZLIB_LIBS)
+
+    Ret = Context.TryLink(P3DCheckZLibUsabilitySrc,".c")
+
+    Context.Result(Ret)
+
+    Context.env.Replace(LIBS=lastLIBS)
+    Context.env.Replace(LIBPATH=lastLIBPATH)
+    Context.env.Replace(CPPPATH=lastCPPPATH)
+    Context.env.Replace(CPPDEFINES=lastCPPDEFINES)
+
+    if Ret:
+        Context.env.Append(HAVE_ZLIB=True)
+        Context.env.Replace(WITH_ZLIB=True)
+        Context.env['ZLIB_CPPPATH'] = ZLIB_INC
+        Context.env['ZLIB_CPPDEFINES'] = ZLIB_CPPDEFS
+        Context.env['ZLIB_LIBS'] = ZLIB_LIBS
+        Context.env['ZLIB_LIBPATH'] = ZLIB_LIBPATH
+    else:
+        Context.env.Append(HAVE_ZLIB=False)
+        Context.env.Replace(WITH_ZLIB=False)
+
+    return Ret
+
+def AppendZLibConf(Env):
+    if Env['WITH_ZLIB']:
+        Env.Append(CPPPATH=Env['ZLIB_CPPPATH'])
+        Env.Append(CPPDEFINES=Env['ZLIB_CPPDEFINES'])
+        Env.Append(LIBS=Env['ZLIB_LIBS'])
+        Env.Append(LIBPATH=Env['ZLIB_LIBPATH'])
+        Env.Append(CPPDEFINES=[('WITH_ZLIB',1)])
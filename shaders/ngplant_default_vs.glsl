@@ -1,3 +1,37 @@
+#ifdef BILLBOARD
+
+attribute vec2 ngp_BillboardCorner;
+uniform   vec2 ngp_BillboardHalfSize;
+
+vec4     BillboardVertex ()
+ {
+  vec3   Right;
+  vec3   Up;
+
+  Right = vec3(gl_ModelViewMatrix[0][0],gl_ModelViewMatrix[1][0],gl_ModelViewMatrix[2][0]);
+
+  #ifdef BILLBOARD_CYLINDRICAL
+  Up    = vec3(0.0,gl_ModelViewMatrix[1][1],0.0);
+  #else
+  Up    = vec3(gl_ModelViewMatrix[0][1],gl_ModelViewMatrix[1][1],gl_ModelViewMatrix[2][1]);
+  #endif
+
+  return(vec4(gl_Vertex.xyz +
+               Right * (ngp_BillboardCorner.x * ngp_BillboardHalfSize.x) +
+               Up    * (ngp_BillboardCorner.y * ngp_BillboardHalfSize.y),
+              gl_Vertex.w));
+ }
+
+#define NGP_POSITION  (gl_ModelViewProjectionMatrix * BillboardVertex())
+#define NGP_NORMAL_ES vec3(0.0,0.0,1.0)
+
+#else
+
+#define NGP_POSITION  ftransform()
+#define NGP_NORMAL_ES (gl_NormalMatrix * gl_Normal)
+
+#endif
+
 #ifdef HAVE_NORMAL_MAP
 
 attribute vec3 ngp_BiNormal;
@@ -11,10 +45,10 @@ void     main     ()
   vec3   BiNormal;
   vec3   Tangent;
 
-  gl_Position    = ftransform();
+  gl_Position    = NGP_POSITION;
   gl_TexCoord[0] = gl_MultiTexCoord0;
 
-  Normal   = gl_NormalMatrix * gl_Normal;
+  Normal   = NGP_NORMAL_ES;
   BiNormal = gl_NormalMatrix * ngp_BiNormal;
   Tangent  = cross(BiNormal,Normal);
 
@@ -40,13 +74,13 @@ void     main     ()
   vec3   NormalES;
   float  LdotN;
 
-  gl_Position = ftransform();
+  gl_Position = NGP_POSITION;
 
   #ifdef HAVE_DIFFUSE_TEX
   gl_TexCoord[0] = gl_MultiTexCoord0;
   #endif
 
-  NormalES = gl_NormalMatrix * gl_Normal;
+  NormalES = NGP_NORMAL_ES;
 
   LdotN = dot(vec3(gl_LightSource[0].position),NormalES);
 
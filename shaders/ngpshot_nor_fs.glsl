@@ -1,3 +1,7 @@
+#ifdef HAVE_DIFFUSE_TEX
+uniform sampler2D  DiffuseTexSampler;
+#endif
+
 #ifdef HAVE_NORMAL_MAP
 
 uniform sampler2D  NormalMapSampler;
@@ -34,6 +38,10 @@ void     main     ()
 
   gl_FragColor += 1.0;
   gl_FragColor *= 0.5;
+
+  #ifdef HAVE_DIFFUSE_TEX
+  gl_FragColor.a = texture2D(DiffuseTexSampler,gl_TexCoord[0].st).a;
+  #endif
  }
 
 #else /* do not HAVE_NORMAL_MAP */
@@ -57,6 +65,10 @@ void     main     ()
   FragmentNormal *= 0.5;
 
   gl_FragColor  = vec4(FragmentNormal,1.0);
+
+  #ifdef HAVE_DIFFUSE_TEX
+  gl_FragColor.a = texture2D(DiffuseTexSampler,gl_TexCoord[0].st).a;
+  #endif
  }
 
 #endif
@@ -26,6 +26,10 @@ void     main     ()
   gl_Position = ftransform();
 
   NormalES = gl_NormalMatrix * gl_Normal;
+
+  #ifdef HAVE_DIFFUSE_TEX
+  gl_TexCoord[0] = gl_MultiTexCoord0;
+  #endif
  }
 
 #endif